@@ -30,6 +30,7 @@
 #include <unistd.h>
 #include <zlib.h>
 
+#include <algorithm>
 #include <fstream>
 #include <memory>
 
@@ -50,6 +51,7 @@
 #include <android-base/properties.h>
 #include <android-base/strings.h>
 #include <android-base/stringprintf.h>
+#include <android-base/unique_fd.h>
 
 using namespace android;
 using hardware::hidl_vec;
@@ -920,21 +922,81 @@ static bool preferSdkCategories() {
     return setPreferSdkProperty(tags);
 }
 
+// Moves the trace stream to stdout through a pipe with splice(), so that the trace pages don't
+// have to be copied through this process. Returns true once the stream has ended. Returns false
+// if the trace or stdout can't be spliced, after forwarding whatever was already moved, so that
+// the caller can read the rest of the stream instead.
+static bool spliceTrace(int traceFD)
+{
+    int pipeFDs[2];
+    if (pipe2(pipeFDs, O_CLOEXEC) != 0) {
+        return false;
+    }
+    android::base::unique_fd pipeRead(pipeFDs[0]);
+    android::base::unique_fd pipeWrite(pipeFDs[1]);
+
+    constexpr size_t kSpliceSize = 64 * 1024;
+    bool spliced = false;
+    while (!g_traceAborted) {
+        ssize_t bytes_in = splice(traceFD, nullptr, pipeWrite.get(), nullptr, kSpliceSize,
+                                  SPLICE_F_MOVE);
+        if (bytes_in <= 0) {
+            if (!spliced && bytes_in < 0 && errno == EINVAL) {
+                return false;
+            }
+            if (!g_traceAborted) {
+                fprintf(stderr, "splice returned %zd bytes err %d (%s)\n",
+                        bytes_in, errno, strerror(errno));
+            }
+            break;
+        }
+        while (bytes_in > 0) {
+            ssize_t bytes_out = splice(pipeRead.get(), nullptr, STDOUT_FILENO, nullptr, bytes_in,
+                                       SPLICE_F_MOVE);
+            if (bytes_out < 0 && !spliced && errno == EINVAL) {
+                // stdout can't be spliced into, like a terminal. Copy what was already moved
+                // into the pipe, and let the caller read the rest.
+                char trace_data[4096];
+                while (bytes_in > 0) {
+                    ssize_t bytes_read = read(pipeRead.get(), trace_data,
+                                              std::min<size_t>(bytes_in, sizeof(trace_data)));
+                    if (bytes_read <= 0 ||
+                        !android::base::WriteFully(STDOUT_FILENO, trace_data, bytes_read)) {
+                        break;
+                    }
+                    bytes_in -= bytes_read;
+                }
+                return false;
+            }
+            if (bytes_out <= 0) {
+                fprintf(stderr, "error writing trace: %s (%d)\n", strerror(errno), errno);
+                return true;
+            }
+            bytes_in -= bytes_out;
+        }
+        spliced = true;
+    }
+    return true;
+}
+
 // Read data from the tracing pipe and forward to stdout
 static void streamTrace()
 {
-    char trace_data[4096];
-    int traceFD = open((g_traceFolder + k_traceStreamPath).c_str(), O_RDWR);
+    char trace_data[64 * 1024];
+    android::base::unique_fd traceFD(open((g_traceFolder + k_traceStreamPath).c_str(), O_RDWR));
     if (traceFD == -1) {
         fprintf(stderr, "error opening %s: %s (%d)\n", k_traceStreamPath,
                 strerror(errno), errno);
         return;
     }
+    fflush(stdout);
+    if (spliceTrace(traceFD.get())) {
+        return;
+    }
     while (!g_traceAborted) {
-        ssize_t bytes_read = read(traceFD, trace_data, 4096);
+        ssize_t bytes_read = read(traceFD.get(), trace_data, sizeof(trace_data));
         if (bytes_read > 0) {
-            write(STDOUT_FILENO, trace_data, bytes_read);
-            fflush(stdout);
+            android::base::WriteFully(STDOUT_FILENO, trace_data, bytes_read);
         } else {
             if (!g_traceAborted) {
                 fprintf(stderr, "read returned %zd bytes err %d (%s)\n",
@@ -846,9 +846,17 @@ static const std::set<std::string> PROBLEMATIC_FILE_EXTENSIONS = {
       ".shb", ".sys", ".vb",  ".vbe", ".vbs", ".vxd", ".wsc", ".wsf", ".wsh"
 };
 
+// List of file extensions of entries that are already compressed, like the visible windows zip
+// or compressed board and ANR files. They're stored as they are, as deflating them again takes
+// most of the zip writer's time for them and barely reduces their size.
+static const std::set<std::string> COMPRESSED_FILE_EXTENSIONS = {
+      ".br", ".bz2", ".gz", ".lz4", ".xz", ".zip", ".zst"
+};
+
 status_t Dumpstate::AddZipEntryFromFd(const std::string& entry_name, int fd,
                                       std::chrono::milliseconds timeout = 0ms) {
     std::string valid_name = entry_name;
+    size_t flags = ZipWriter::kCompress | ZipWriter::kDefaultCompression;
 
     // Rename extension if necessary.
     size_t idx = entry_name.rfind('.');
@@ -859,11 +867,13 @@ status_t Dumpstate::AddZipEntryFromFd(const std::string& entry_name, int fd,
             valid_name = entry_name + ".renamed";
             MYLOGI("Renaming entry %s to %s\n", entry_name.c_str(), valid_name.c_str());
         }
+        if (COMPRESSED_FILE_EXTENSIONS.count(extension) != 0) {
+            flags = 0;
+        }
     }
 
     // Logging statement  below is useful to time how long each entry takes, but it's too verbose.
     // MYLOGD("Adding zip entry %s\n", entry_name.c_str());
-    size_t flags = ZipWriter::kCompress | ZipWriter::kDefaultCompression;
     int32_t err = zip_writer_->StartEntryWithTime(valid_name.c_str(), flags,
                                                   get_mtime(fd, ds.now_));
     if (err != 0) {
@@ -886,7 +896,9 @@ status_t Dumpstate::AddZipEntryFromFd(const std::string& entry_name, int fd,
     auto end = start + timeout;
     struct pollfd pfd = {fd, POLLIN};
 
-    std::vector<uint8_t> buffer(65536);
+    // Reading in larger chunks saves read() and WriteBytes() calls for the large entries, like
+    // dumpsys and dumpstate_board output, that make up most of a bugreport.
+    std::vector<uint8_t> buffer(256 * 1024);
     while (1) {
         if (timeout.count() > 0) {
             // lambda to recalculate the timeout.
@@ -1667,16 +1679,20 @@ Dumpstate::RunStatus Dumpstate::dumpstate() {
         dump_netstats_report;
     if (ds.dump_pool_) {
         // Pool was shutdown in DumpstateDefaultAfterCritical method in order to
-        // drop root user. Restarts it.
-        ds.dump_pool_->start(/* thread_counts = */3);
+        // drop root user. Restarts it. The tasks mostly wait on other processes, so use
+        // as many threads as the pool allows.
+        ds.dump_pool_->start(/* thread_counts = */4);
 
+        // The pool runs tasks in the order in which they are enqueued. The board dump can take
+        // up to its timeout in the dumpstate HAL, so start it first rather than have it wait for
+        // a free thread behind the shorter tasks.
+        dump_board = ds.dump_pool_->enqueueTaskWithFd(
+            DUMP_BOARD_TASK, &Dumpstate::DumpstateBoard, &ds, _1);
         dump_hals = ds.dump_pool_->enqueueTaskWithFd(DUMP_HALS_TASK, &DumpHals, _1);
         dump_incident_report = ds.dump_pool_->enqueueTask(
             DUMP_INCIDENT_REPORT_TASK, &DumpIncidentReport);
         dump_netstats_report = ds.dump_pool_->enqueueTask(
             DUMP_NETSTATS_PROTO_TASK, &DumpNetstatsProto);
-        dump_board = ds.dump_pool_->enqueueTaskWithFd(
-            DUMP_BOARD_TASK, &Dumpstate::DumpstateBoard, &ds, _1);
         dump_checkins = ds.dump_pool_->enqueueTaskWithFd(DUMP_CHECKINS_TASK, &DumpCheckins, _1);
     }
 
@@ -15,8 +15,11 @@
  */
 
 #include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
 #include <iomanip>
+#include <mutex>
 #include <thread>
 
 #include <android-base/file.h>
@@ -39,6 +42,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
 #include <sys/poll.h>
 #include <sys/socket.h>
 #include <sys/time.h>
@@ -66,16 +70,19 @@ static void usage() {
         "         To dump all services.\n"
         "or:\n"
         "       dumpsys [-t TIMEOUT] [--priority LEVEL] [--clients] [--dump] [--pid] [--thread] "
-        "[--help | "
+        "[--latency] [--parallel N] [--help | "
         "-l | --skip SERVICES "
         "| SERVICE [ARGS]]\n"
         "         --help: shows this help\n"
         "         -l: only list services, do not dump them\n"
+        "         --latency: dump binder transaction latency histograms instead of usual dump\n"
         "         -t TIMEOUT_SEC: TIMEOUT to use in seconds instead of default 10 seconds\n"
         "         -T TIMEOUT_MS: TIMEOUT to use in milliseconds instead of default 10 seconds\n"
         "         --clients: dump client PIDs instead of usual dump\n"
         "         --dump: ask the service to dump itself (this is the default)\n"
         "         --pid: dump PID instead of usual dump\n"
+        "         --parallel N: dump up to N services at the same time. Their output is still\n"
+        "               in the order of the services\n"
         "         --proto: filter services that support dumping data in proto format. Dumps\n"
         "               will be in proto format.\n"
         "         --priority LEVEL: filter services based on specified priority\n"
@@ -135,13 +142,15 @@ int Dumpsys::main(int argc, char* const argv[]) {
     bool asProto = false;
     int dumpTypeFlags = 0;
     int timeoutArgMs = 10000;
+    int parallelism = 1;
     int priorityFlags = IServiceManager::DUMP_FLAG_PRIORITY_ALL;
     static struct option longOptions[] = {
         {"help", no_argument, 0, 0},           {"clients", no_argument, 0, 0},
         {"dump", no_argument, 0, 0},           {"pid", no_argument, 0, 0},
         {"priority", required_argument, 0, 0}, {"proto", no_argument, 0, 0},
         {"skip", no_argument, 0, 0},           {"stability", no_argument, 0, 0},
-        {"thread", no_argument, 0, 0},         {0, 0, 0, 0}};
+        {"thread", no_argument, 0, 0},         {"latency", no_argument, 0, 0},
+        {"parallel", required_argument, 0, 0}, {0, 0, 0, 0}};
 
     // Must reset optind, otherwise subsequent calls will fail (wouldn't happen on main.cpp, but
     // happens on test cases).
@@ -182,6 +191,15 @@ int Dumpsys::main(int argc, char* const argv[]) {
                 dumpTypeFlags |= TYPE_THREAD;
             } else if (!strcmp(longOptions[optionIndex].name, "clients")) {
                 dumpTypeFlags |= TYPE_CLIENTS;
+            } else if (!strcmp(longOptions[optionIndex].name, "latency")) {
+                dumpTypeFlags |= TYPE_LATENCY;
+            } else if (!strcmp(longOptions[optionIndex].name, "parallel")) {
+                char* endptr;
+                parallelism = strtol(optarg, &endptr, 10);
+                if (*endptr != '\0' || parallelism <= 0) {
+                    fprintf(stderr, "Error: invalid parallel dump count: '%s'\n", optarg);
+                    return -1;
+                }
             }
             break;
 
@@ -271,37 +289,117 @@ int Dumpsys::main(int argc, char* const argv[]) {
         return 0;
     }
 
+    const std::chrono::milliseconds timeout(timeoutArgMs);
+    if (parallelism > 1 && N > 1) {
+        dumpServicesInParallel(STDOUT_FILENO, services, skippedServices, dumpTypeFlags, args,
+                               priorityFlags, timeout, asProto, static_cast<size_t>(parallelism));
+        return 0;
+    }
+
     for (size_t i = 0; i < N; i++) {
         const String16& serviceName = services[i];
         if (IsSkipped(skippedServices, serviceName)) continue;
 
-        if (startDumpThread(dumpTypeFlags, serviceName, args) == OK) {
-            bool addSeparator = (N > 1);
-            if (addSeparator) {
-                writeDumpHeader(STDOUT_FILENO, serviceName, priorityFlags);
-            }
-            std::chrono::duration<double> elapsedDuration;
-            size_t bytesWritten = 0;
-            status_t status =
-                writeDump(STDOUT_FILENO, serviceName, std::chrono::milliseconds(timeoutArgMs),
-                          asProto, elapsedDuration, bytesWritten);
-
-            if (status == TIMED_OUT) {
-                std::cout << std::endl
-                     << "*** SERVICE '" << serviceName << "' DUMP TIMEOUT (" << timeoutArgMs
-                     << "ms) EXPIRED ***" << std::endl
-                     << std::endl;
-            }
+        dumpService(STDOUT_FILENO, dumpTypeFlags, serviceName, args, priorityFlags,
+                    /* addSeparator = */ N > 1, timeout, asProto);
+    }
+
+    return 0;
+}
+
+void Dumpsys::dumpService(int fd, int dumpTypeFlags, const String16& serviceName,
+                          const Vector<String16>& args, int priorityFlags, bool addSeparator,
+                          std::chrono::milliseconds timeout, bool asProto) {
+    if (startDumpThread(dumpTypeFlags, serviceName, args) != OK) {
+        return;
+    }
+
+    if (addSeparator) {
+        writeDumpHeader(fd, serviceName, priorityFlags);
+    }
+    std::chrono::duration<double> elapsedDuration;
+    size_t bytesWritten = 0;
+    status_t status = writeDump(fd, serviceName, timeout, asProto, elapsedDuration, bytesWritten);
+
+    if (status == TIMED_OUT) {
+        WriteStringToFd(StringPrintf("\n*** SERVICE '%s' DUMP TIMEOUT (%llums) EXPIRED ***\n\n",
+                                     String8(serviceName).c_str(), timeout.count()),
+                        fd);
+    }
 
-            if (addSeparator) {
-                writeDumpFooter(STDOUT_FILENO, serviceName, elapsedDuration);
+    if (addSeparator) {
+        writeDumpFooter(fd, serviceName, elapsedDuration);
+    }
+    bool dumpComplete = (status == OK);
+    stopDumpThread(dumpComplete);
+}
+
+void Dumpsys::dumpServicesInParallel(int fd, const Vector<String16>& services,
+                                     const Vector<String16>& skippedServices, int dumpTypeFlags,
+                                     const Vector<String16>& args, int priorityFlags,
+                                     std::chrono::milliseconds timeout, bool asProto,
+                                     size_t parallelism) const {
+    const size_t N = services.size();
+
+    // Each service is dumped into its own memory file, which is copied to fd once the services
+    // before it were, so that the output is the same as when dumping them one at a time.
+    std::vector<unique_fd> outputs(N);
+    std::vector<bool> finished(N, false);
+    std::mutex lock;
+    std::condition_variable finishedCondition;
+    std::atomic<size_t> nextService = 0;
+
+    auto dumpNext = [&]() {
+        // The dump threads of a Dumpsys are one at a time, so each worker has its own.
+        Dumpsys dumpsys(sm_);
+        for (size_t i = nextService++; i < N; i = nextService++) {
+            unique_fd output;
+            if (!IsSkipped(skippedServices, services[i])) {
+                output.reset(memfd_create("dumpsys", MFD_CLOEXEC));
+                if (output.ok()) {
+                    dumpsys.dumpService(output.get(), dumpTypeFlags, services[i], args,
+                                        priorityFlags, /* addSeparator = */ true, timeout,
+                                        asProto);
+                } else {
+                    std::cerr << "Failed to create buffer to dump service " << services[i]
+                              << ": " << strerror(errno) << std::endl;
+                }
             }
-            bool dumpComplete = (status == OK);
-            stopDumpThread(dumpComplete);
+
+            std::lock_guard guard(lock);
+            outputs[i] = std::move(output);
+            finished[i] = true;
+            finishedCondition.notify_all();
         }
+    };
+
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < std::min(parallelism, N); i++) {
+        workers.emplace_back(dumpNext);
     }
 
-    return 0;
+    for (size_t i = 0; i < N; i++) {
+        unique_fd output;
+        {
+            std::unique_lock guard(lock);
+            finishedCondition.wait(guard, [&]() { return finished[i]; });
+            output = std::move(outputs[i]);
+        }
+        if (!output.ok()) continue;
+
+        std::string dump;
+        if (lseek(output.get(), 0, SEEK_SET) != 0 ||
+            !android::base::ReadFdToString(output.get(), &dump)) {
+            std::cerr << "Failed to read buffered dump of service " << services[i] << ": "
+                      << strerror(errno) << std::endl;
+            continue;
+        }
+        WriteStringToFd(dump, fd);
+    }
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
 }
 
 Vector<String16> Dumpsys::listServices(int priorityFilterFlags, bool filterByProto) const {
@@ -406,6 +504,16 @@ static status_t dumpClientsToFd(const sp<IBinder>& service, const unique_fd& fd)
     return OK;
 }
 
+static status_t dumpLatencyToFd(const sp<IBinder>& service, const unique_fd& fd) {
+    Parcel data;
+    Parcel reply;
+    status_t status = data.writeFileDescriptor(fd.get());
+    if (status != OK) {
+        return status;
+    }
+    return service->transact(IBinder::DUMP_LATENCY_TRANSACTION, data, &reply);
+}
+
 static void reportDumpError(const String16& serviceName, status_t error, const char* context) {
     if (error == OK) return;
 
@@ -450,6 +558,10 @@ status_t Dumpsys::startDumpThread(int dumpTypeFlags, const String16& serviceName
             status_t err = dumpClientsToFd(service, remote_end);
             reportDumpError(serviceName, err, "dumping clients info");
         }
+        if (dumpTypeFlags & TYPE_LATENCY) {
+            status_t err = dumpLatencyToFd(service, remote_end);
+            reportDumpError(serviceName, err, "dumping latency info");
+        }
 
         // other types always act as a header, this is usually longer
         if (dumpTypeFlags & TYPE_DUMP) {
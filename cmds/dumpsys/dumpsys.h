@@ -57,6 +57,7 @@ class Dumpsys {
         TYPE_STABILITY = 0x4,  // dump stability information of server
         TYPE_THREAD = 0x8,     // dump thread usage of server only
         TYPE_CLIENTS = 0x10,   // dump pid of clients
+        TYPE_LATENCY = 0x20,   // dump transaction latency histograms of server
     };
 
     /**
@@ -126,6 +127,24 @@ class Dumpsys {
     }
 
   private:
+    /**
+     * Dumps a service to a file descriptor, as dumpsys does for each service it's asked for.
+     * @param addSeparator write a section header and footer around the dump
+     */
+    void dumpService(int fd, int dumpTypeFlags, const String16& serviceName,
+                     const Vector<String16>& args, int priorityFlags, bool addSeparator,
+                     std::chrono::milliseconds timeout, bool asProto);
+
+    /**
+     * Dumps the services that aren't skipped to a file descriptor, up to {@code parallelism}
+     * of them at the same time, keeping the order of {@code services} in the output.
+     */
+    void dumpServicesInParallel(int fd, const Vector<String16>& services,
+                                const Vector<String16>& skippedServices, int dumpTypeFlags,
+                                const Vector<String16>& args, int priorityFlags,
+                                std::chrono::milliseconds timeout, bool asProto,
+                                size_t parallelism) const;
+
     android::IServiceManager* sm_;
     std::thread activeThread_;
     mutable android::base::unique_fd redirectFd_;
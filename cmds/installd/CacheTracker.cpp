@@ -18,6 +18,8 @@
 
 #include "CacheTracker.h"
 
+#include <algorithm>
+
 #include <fts.h>
 #include <sys/xattr.h>
 #include <utils/Trace.h>
@@ -33,6 +35,23 @@ using android::base::StringPrintf;
 namespace android {
 namespace installd {
 
+/**
+ * Orders items so that the ones to purge first are last: the oldest, then the
+ * deepest, then files before directories.
+ */
+static bool comparePurgeOrder(const std::shared_ptr<CacheItem>& left,
+        const std::shared_ptr<CacheItem>& right) {
+    // TODO: sort dotfiles last
+    // TODO: sort code_cache last
+    if (left->modified != right->modified) {
+        return (left->modified > right->modified);
+    }
+    if (left->level != right->level) {
+        return (left->level < right->level);
+    }
+    return left->directory && !right->directory;
+}
+
 CacheTracker::CacheTracker(userid_t userId, appid_t appId, const std::string& uuid)
       : cacheUsed(0),
         cacheQuota(0),
@@ -171,22 +190,21 @@ void CacheTracker::loadItems() {
     }
     ATRACE_END();
 
-    ATRACE_BEGIN("sortItems");
-    auto cmp = [](std::shared_ptr<CacheItem> left, std::shared_ptr<CacheItem> right) {
-        // TODO: sort dotfiles last
-        // TODO: sort code_cache last
-        if (left->modified != right->modified) {
-            return (left->modified > right->modified);
-        }
-        if (left->level != right->level) {
-            return (left->level < right->level);
-        }
-        return left->directory;
-    };
-    std::stable_sort(items.begin(), items.end(), cmp);
+    // Only the items that end up being purged need to be ordered, and freeing
+    // usually stops long before all of them are, so keep them as a heap
+    // rather than sorting everything up front.
+    ATRACE_BEGIN("heapifyItems");
+    std::make_heap(items.begin(), items.end(), comparePurgeOrder);
     ATRACE_END();
 }
 
+std::shared_ptr<CacheItem> CacheTracker::takeNextItem() {
+    std::pop_heap(items.begin(), items.end(), comparePurgeOrder);
+    auto item = items.back();
+    items.pop_back();
+    return item;
+}
+
 void CacheTracker::ensureItems() {
     if (mItemsLoaded) {
         return;
@@ -56,6 +56,13 @@ public:
     int64_t cacheUsed;
     int64_t cacheQuota;
 
+    /**
+     * Removes and returns the item that should be purged next. There must be
+     * at least one item left.
+     */
+    std::shared_ptr<CacheItem> takeNextItem();
+
+    /** Items not yet purged, in no particular order. */
     std::vector<std::shared_ptr<CacheItem>> items;
 
 private:
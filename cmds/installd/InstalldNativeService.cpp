@@ -36,6 +36,7 @@
 #include <sys/xattr.h>
 #include <unistd.h>
 #include <algorithm>
+#include <atomic>
 #include <filesystem>
 #include <fstream>
 #include <functional>
@@ -114,6 +115,9 @@ static constexpr const char* CODE_CACHE_DIR_POSTFIX = "/code_cache";
 
 static constexpr const char* kFuseProp = "persist.sys.fuse";
 
+// Number of threads, including the binder thread, that createAppDataBatched() uses.
+static constexpr size_t kCreateAppDataThreads = 4;
+
 /**
  * Property to control if app data isolation is enabled.
  */
@@ -995,14 +999,30 @@ binder::Status InstalldNativeService::createAppDataBatched(
     }
 
     // Locking is performed depeer in the callstack.
-
-    std::vector<android::os::CreateAppDataResult> results;
-    for (const auto &arg : args) {
-        android::os::CreateAppDataResult result;
-        createAppData(arg, &result);
-        results.push_back(result);
+    ScopedTrace tracer("createAppDataBatched");
+
+    // Packages only hold their own package lock and a shared lock of their user, so a batch,
+    // like the one for all packages of a new user, is spread over a few threads. Each thread
+    // takes the next package that hasn't been started, as some packages take much longer to
+    // restorecon than others.
+    std::vector<android::os::CreateAppDataResult> results(args.size());
+    std::atomic<size_t> nextArg = 0;
+    auto createNext = [&]() {
+        for (size_t i = nextArg++; i < args.size(); i = nextArg++) {
+            createAppData(args[i], &results[i]);
+        }
+    };
+    std::vector<std::thread> threads;
+    const size_t threadCount = std::min(kCreateAppDataThreads, args.size());
+    for (size_t i = 1; i < threadCount; i++) {
+        threads.emplace_back(createNext);
+    }
+    createNext();
+    for (auto& thread : threads) {
+        thread.join();
     }
-    *_aidl_return = results;
+
+    *_aidl_return = std::move(results);
     return ok();
 }
 
@@ -2249,8 +2269,7 @@ binder::Status InstalldNativeService::freeCache(const std::optional<std::string>
                 active = nullptr;
                 continue;
             } else {
-                auto item = active->items.back();
-                active->items.pop_back();
+                auto item = active->takeNextItem();
 
                 LOG(DEBUG) << "Purging " << item->toString() << " from " << active->toString();
                 if (!noop) {
@@ -29,6 +29,7 @@
 #include <unistd.h>
 
 #include <array>
+#include <condition_variable>
 #include <iomanip>
 #include <mutex>
 #include <unordered_set>
@@ -39,6 +40,7 @@
 #include <android-base/properties.h>
 #include <android-base/stringprintf.h>
 #include <android-base/strings.h>
+#include <android-base/thread_annotations.h>
 #include <android-base/unique_fd.h>
 #include <async_safe/log.h>
 #include <cutils/fs.h>
@@ -87,6 +89,18 @@ constexpr int kShortTimeoutMs = 60000; // 1 minute.
 // aborted before that watchdog would take down the system server.
 constexpr int kLongTimeoutMs = 570000; // 9.5 minutes.
 
+// Priority of a dex2oat job when the number of concurrent jobs is limited. Jobs of a lower
+// value run first.
+enum class Dex2oatPriority : size_t {
+    // An install or any other compilation that the user is waiting for.
+    kForeground = 0,
+    // Compilation before boot completes.
+    kBoot = 1,
+    // The idle background dexopt job.
+    kBackground = 2,
+};
+constexpr size_t kDex2oatPriorityCount = 3;
+
 class DexOptStatus {
  public:
     // Check if dexopt is cancelled and fork if it is not cancelled.
@@ -107,11 +121,46 @@ class DexOptStatus {
         return pid;
     }
 
+    // Like check_cancellation_and_fork, but when dalvik.vm.dex2oat-max-concurrent-jobs is set,
+    // first waits until fewer jobs than that are running and no job of a higher priority is
+    // waiting. Installd has several binder threads, and without a limit OTA and post-boot dexopt
+    // can run more dex2oat processes than there are cores. The job holds its slot until
+    // check_if_killed_and_remove_dexopt_pid is called for the returned pid.
+    pid_t wait_for_job_slot_and_fork(Dex2oatPriority priority, /* out */ bool *cancelled) {
+        const uint32_t max_jobs = ::android::base::GetUintProperty<uint32_t>(
+                "dalvik.vm.dex2oat-max-concurrent-jobs", 0);
+        std::unique_lock<std::mutex> lock(dexopt_lock_);
+        android::base::ScopedLockAssertion assume_locked(dexopt_lock_);
+        const size_t lane = static_cast<size_t>(priority);
+        waiting_jobs_[lane]++;
+        while (!dexopt_blocked_ && !can_start_job(lane, max_jobs)) {
+            job_slot_available_.wait(lock);
+        }
+        waiting_jobs_[lane]--;
+        // Let a job of a lower priority check whether it can run now.
+        job_slot_available_.notify_all();
+
+        if (dexopt_blocked_) {
+            *cancelled = true;
+            return -1;
+        }
+        pid_t pid = fork();
+        *cancelled = false;
+        if (pid > 0) { // parent
+            dexopt_pids_.insert(pid);
+            job_pids_.insert(pid);
+        }
+        return pid;
+    }
+
     // Returns true if pid was killed (is in killed list). It could have finished if killing
     // happened after the process is finished.
     bool check_if_killed_and_remove_dexopt_pid(pid_t pid) {
         std::lock_guard<std::mutex> lock(dexopt_lock_);
         dexopt_pids_.erase(pid);
+        if (job_pids_.erase(pid) == 1) {
+            job_slot_available_.notify_all();
+        }
         if (dexopt_killed_pids_.erase(pid) == 1) {
             return true;
         }
@@ -131,6 +180,8 @@ class DexOptStatus {
         if (!block) {
             return;
         }
+        // Cancel the jobs waiting for a slot.
+        job_slot_available_.notify_all();
         // Blocked, also kill currently running tasks
         for (auto pid : dexopt_pids_) {
             LOG(INFO) << "control_dexopt_blocking kill pid:" << pid;
@@ -141,6 +192,18 @@ class DexOptStatus {
     }
 
  private:
+    bool can_start_job(size_t lane, uint32_t max_jobs) REQUIRES(dexopt_lock_) {
+        if (max_jobs != 0 && job_pids_.size() >= max_jobs) {
+            return false;
+        }
+        for (size_t i = 0; i < lane; i++) {
+            if (waiting_jobs_[i] != 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
     std::mutex dexopt_lock_;
     // when true, dexopt is blocked and will not run.
     bool dexopt_blocked_ GUARDED_BY(dexopt_lock_) = false;
@@ -149,6 +212,11 @@ class DexOptStatus {
     std::unordered_set<pid_t> dexopt_pids_ GUARDED_BY(dexopt_lock_);
     // PIDs of child processes killed by cancellation.
     std::unordered_set<pid_t> dexopt_killed_pids_ GUARDED_BY(dexopt_lock_);
+    // PIDs of child processes started by wait_for_job_slot_and_fork, each holding a job slot.
+    std::unordered_set<pid_t> job_pids_ GUARDED_BY(dexopt_lock_);
+    // Number of jobs waiting for a slot, per priority.
+    std::array<size_t, kDex2oatPriorityCount> waiting_jobs_ GUARDED_BY(dexopt_lock_) = {};
+    std::condition_variable job_slot_available_;
 };
 
 android::base::NoDestructor<DexOptStatus> dexopt_status_;
@@ -1968,8 +2036,11 @@ int dexopt(const char* dex_path, uid_t uid, const char* pkgname, const char* ins
                       enable_hidden_api_checks, generate_compact_dex, compile_without_image,
                       background_job_compile, compilation_reason);
 
+    const Dex2oatPriority priority = background_job_compile ? Dex2oatPriority::kBackground
+            : boot_complete ? Dex2oatPriority::kForeground
+                            : Dex2oatPriority::kBoot;
     bool cancelled = false;
-    pid_t pid = dexopt_status_->check_cancellation_and_fork(&cancelled);
+    pid_t pid = dexopt_status_->wait_for_job_slot_and_fork(priority, &cancelled);
     if (cancelled) {
         *completed = false;
         reference_profile.DisableCleanup();
@@ -2213,6 +2284,61 @@ bool reconcile_secondary_dex_file(const std::string& dex_path,
     }
 }
 
+// Identifies the contents of a secondary dex file without reading it. The inode changes when the
+// file is replaced, and the mtime when it is modified in place. The ctime is included as, unlike
+// the mtime, apps cannot set it back after modifying the file. Fields have fixed sizes, as this is
+// sent over a pipe.
+struct SecondaryDexIdentity {
+    uint64_t dev;
+    uint64_t ino;
+    int64_t size;
+    int64_t mtime_ns;
+    int64_t ctime_ns;
+
+    bool operator==(const SecondaryDexIdentity&) const = default;
+};
+
+// What the child hashing a secondary dex file sends first, once it opened the file, whether or not
+// it could stat it. The parent reads a frame of this size before the hash, so that it never
+// mistakes a part of the hash for the identity.
+struct SecondaryDexIdentityFrame {
+    uint64_t has_identity;
+    SecondaryDexIdentity identity;
+};
+
+// Hashes of recently hashed secondary dex files. Background dexopt and reconcile ask for the hashes
+// of the same, mostly unchanged, files on every pass.
+class SecondaryDexHashCache {
+ public:
+    bool find(const SecondaryDexIdentity& identity, std::vector<uint8_t>* out_hash) {
+        std::lock_guard<std::mutex> lock(lock_);
+        for (const auto& [cached_identity, hash] : entries_) {
+            if (cached_identity == identity) {
+                *out_hash = hash;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void add(const SecondaryDexIdentity& identity, const std::vector<uint8_t>& hash) {
+        std::lock_guard<std::mutex> lock(lock_);
+        if (entries_.size() >= kMaxEntries) {
+            entries_.erase(entries_.begin());
+        }
+        entries_.emplace_back(identity, hash);
+    }
+
+ private:
+    static constexpr size_t kMaxEntries = 256;
+
+    std::mutex lock_;
+    // Oldest first.
+    std::vector<std::pair<SecondaryDexIdentity, std::vector<uint8_t>>> entries_ GUARDED_BY(lock_);
+};
+
+static android::base::NoDestructor<SecondaryDexHashCache> secondary_dex_hash_cache_;
+
 // Compute and return the hash (SHA-256) of the secondary dex file at dex_path.
 // Returns true if all parameters are valid and the hash successfully computed and stored in
 // out_secondary_dex_hash.
@@ -2232,9 +2358,11 @@ bool hash_secondary_dex_file(const std::string& dex_path, const std::string& pkg
         return false;
     }
 
-    // Pipe to get the hash result back from our child process.
+    // Pipe to get the file identity and then the hash result back from our child process, and
+    // pipe to tell the child whether the hash of that identity is already known.
     unique_fd pipe_read, pipe_write;
-    if (!Pipe(&pipe_read, &pipe_write)) {
+    unique_fd reply_read, reply_write;
+    if (!Pipe(&pipe_read, &pipe_write) || !Pipe(&reply_read, &reply_write)) {
         PLOG(ERROR) << "Failed to create pipe";
         return false;
     }
@@ -2246,6 +2374,7 @@ bool hash_secondary_dex_file(const std::string& dex_path, const std::string& pkg
         // child -- drop privileges before continuing
         drop_capabilities(uid);
         pipe_read.reset();
+        reply_write.reset();
 
         if (!validate_secondary_dex_path(pkgname, dex_path, volume_uuid_cstr, uid, storage_flag)) {
             async_safe_format_log(ANDROID_LOG_ERROR, LOG_TAG,
@@ -2265,6 +2394,31 @@ bool hash_secondary_dex_file(const std::string& dex_path, const std::string& pkg
             _exit(DexoptReturnCodes::kHashOpenPath);
         }
 
+        SecondaryDexIdentityFrame frame = {};
+        struct stat st;
+        if (fstat(fd, &st) == 0) {
+            frame.has_identity = 1;
+            frame.identity = {
+                    .dev = static_cast<uint64_t>(st.st_dev),
+                    .ino = static_cast<uint64_t>(st.st_ino),
+                    .size = static_cast<int64_t>(st.st_size),
+                    .mtime_ns = st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec,
+                    .ctime_ns = st.st_ctim.tv_sec * 1000000000LL + st.st_ctim.tv_nsec,
+            };
+        }
+        if (!WriteFully(pipe_write, &frame, sizeof(frame))) {
+            _exit(DexoptReturnCodes::kHashWrite);
+        }
+        if (frame.has_identity) {
+            uint8_t cached = 0;
+            if (!ReadFully(reply_read, &cached, sizeof(cached))) {
+                _exit(DexoptReturnCodes::kHashWrite);
+            }
+            if (cached) {
+                _exit(0);
+            }
+        }
+
         SHA256_CTX ctx;
         SHA256_Init(&ctx);
 
@@ -2293,12 +2447,37 @@ bool hash_secondary_dex_file(const std::string& dex_path, const std::string& pkg
 
     // parent
     pipe_write.reset();
+    reply_read.reset();
+
+    // The child only sends the frame if the file could be opened.
+    SecondaryDexIdentityFrame frame = {};
+    const bool has_identity =
+            ReadFully(pipe_read, &frame, sizeof(frame)) && frame.has_identity != 0;
+    const SecondaryDexIdentity& identity = frame.identity;
+    if (has_identity) {
+        const uint8_t cached = secondary_dex_hash_cache_->find(identity, out_secondary_dex_hash);
+        WriteFully(reply_write, &cached, sizeof(cached));
+        if (cached) {
+            if (wait_child_with_timeout(pid, kShortTimeoutMs) != 0) {
+                out_secondary_dex_hash->clear();
+                return false;
+            }
+            return true;
+        }
+    }
+    reply_write.reset();
 
     out_secondary_dex_hash->resize(SHA256_DIGEST_LENGTH);
     if (!ReadFully(pipe_read, out_secondary_dex_hash->data(), out_secondary_dex_hash->size())) {
         out_secondary_dex_hash->clear();
     }
-    return wait_child_with_timeout(pid, kShortTimeoutMs) == 0;
+    if (wait_child_with_timeout(pid, kShortTimeoutMs) != 0) {
+        return false;
+    }
+    if (has_identity && !out_secondary_dex_hash->empty()) {
+        secondary_dex_hash_cache_->add(identity, *out_secondary_dex_hash);
+    }
+    return true;
 }
 
 // Helper for move_ab, so that we can have common failure-case cleanup.
@@ -14,8 +14,10 @@
  * limitations under the License.
  */
 
+#include <chrono>
 #include <sstream>
 #include <string>
+#include <thread>
 
 #include <fcntl.h>
 #include <pwd.h>
@@ -465,6 +467,80 @@ TEST_F(ServiceTest, HashSecondaryDex_WrongApp) {
         dexPath, "com.wrong", 10000, testUuid, FLAG_STORAGE_CE, &result));
 }
 
+static void writeSecondaryDex(const std::string& path, const std::string& content) {
+    // Owned by the app, like the secondary dex files of the tests above.
+    unique_fd fd(create(path, 10000, 20000, 0700));
+    EXPECT_EQ(::ftruncate(fd.get(), 0), 0);
+    EXPECT_TRUE(android::base::WriteStringToFd(content, fd.get()));
+}
+
+static std::vector<uint8_t> hashSecondaryDex(InstalldNativeService* service,
+                                             const std::optional<std::string>& uuid,
+                                             const std::string& path) {
+    std::vector<uint8_t> result;
+    EXPECT_BINDER_SUCCESS(service->hashSecondaryDexFile(get_full_path(path), "com.example", 10000,
+                                                        uuid, FLAG_STORAGE_CE, &result));
+    EXPECT_EQ(result.size(), 32U);
+    return result;
+}
+
+TEST_F(ServiceTest, HashSecondaryDex_ModifiedInPlace) {
+    LOG(INFO) << "HashSecondaryDex_ModifiedInPlace";
+
+    mkdir("user/0/com.example", 10000, 10000, 0700);
+    mkdir("user/0/com.example/foo", 10000, 10000, 0700);
+    writeSecondaryDex("user/0/com.example/foo/expected", "bbbb");
+    const auto expected = hashSecondaryDex(service, testUuid, "user/0/com.example/foo/expected");
+
+    writeSecondaryDex("user/0/com.example/foo/file", "aaaa");
+    const auto original = hashSecondaryDex(service, testUuid, "user/0/com.example/foo/file");
+    EXPECT_NE(original, expected);
+    struct stat st;
+    ASSERT_EQ(::stat(get_full_path("user/0/com.example/foo/file").c_str(), &st), 0);
+
+    // File timestamps have the granularity of a scheduler tick, so let the ctime move on.
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    // Rewrite the file with as many bytes, and set its mtime back, as an app can. Its ctime still
+    // changes, so the cached hash is not used.
+    writeSecondaryDex("user/0/com.example/foo/file", "bbbb");
+    const struct timespec times[] = {st.st_atim, st.st_mtim};
+    ASSERT_EQ(::utimensat(AT_FDCWD, get_full_path("user/0/com.example/foo/file").c_str(), times, 0),
+              0);
+    EXPECT_EQ(hashSecondaryDex(service, testUuid, "user/0/com.example/foo/file"), expected);
+}
+
+TEST_F(ServiceTest, HashSecondaryDex_Replaced) {
+    LOG(INFO) << "HashSecondaryDex_Replaced";
+
+    mkdir("user/0/com.example", 10000, 10000, 0700);
+    mkdir("user/0/com.example/foo", 10000, 10000, 0700);
+    writeSecondaryDex("user/0/com.example/foo/expected", "bbbb");
+    const auto expected = hashSecondaryDex(service, testUuid, "user/0/com.example/foo/expected");
+
+    writeSecondaryDex("user/0/com.example/foo/file", "aaaa");
+    EXPECT_NE(hashSecondaryDex(service, testUuid, "user/0/com.example/foo/file"), expected);
+
+    // A new file, which is a new inode, takes the place of the hashed one.
+    writeSecondaryDex("user/0/com.example/foo/new", "bbbb");
+    ASSERT_EQ(::rename(get_full_path("user/0/com.example/foo/new").c_str(),
+                       get_full_path("user/0/com.example/foo/file").c_str()),
+              0);
+    EXPECT_EQ(hashSecondaryDex(service, testUuid, "user/0/com.example/foo/file"), expected);
+}
+
+TEST_F(ServiceTest, HashSecondaryDex_Unchanged) {
+    LOG(INFO) << "HashSecondaryDex_Unchanged";
+
+    mkdir("user/0/com.example", 10000, 10000, 0700);
+    mkdir("user/0/com.example/foo", 10000, 10000, 0700);
+    writeSecondaryDex("user/0/com.example/foo/file", "aaaa");
+
+    // The second hash may come from the cache, and must be the same.
+    const auto first = hashSecondaryDex(service, testUuid, "user/0/com.example/foo/file");
+    EXPECT_EQ(hashSecondaryDex(service, testUuid, "user/0/com.example/foo/file"), first);
+}
+
 TEST_F(ServiceTest, CalculateOat) {
     char buf[PKG_PATH_MAX];
 
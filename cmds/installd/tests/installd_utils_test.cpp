@@ -15,12 +15,14 @@
  */
 
 #include <errno.h>
+#include <ftw.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 
 #include <android-base/logging.h>
 #include <android-base/scopeguard.h>
+#include <android-base/stringprintf.h>
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
@@ -49,6 +51,7 @@ namespace android {
 namespace installd {
 
 using ::testing::UnorderedElementsAre;
+using android::base::StringPrintf;
 
 class UtilsTest : public testing::Test {
 protected:
@@ -681,6 +684,42 @@ TEST_F(UtilsTest, TestForEachSubdir) {
     EXPECT_THAT(result, UnorderedElementsAre("com.foo", "com.bar"));
 }
 
+static int64_t gExpectedTreeSize = 0;
+
+static int addNodeSize(const char*, const struct stat* st, int, struct FTW*) {
+    gExpectedTreeSize += st->st_blocks * 512;
+    return 0;
+}
+
+TEST_F(UtilsTest, TestCalculateTreeSize) {
+    auto deleter = [&]() {
+        delete_dir_contents_and_dir("/data/local/tmp/user/0", true /* ignore_if_missing */);
+    };
+    auto scope_guard = android::base::make_scope_guard(deleter);
+
+    // More top level directories than calculate_tree_size() walks in parallel, some of them
+    // nested, and a file at the top level.
+    for (int i = 0; i < 8; i++) {
+        system(StringPrintf("mkdir -p /data/local/tmp/user/0/dir%d/nested", i).c_str());
+        system(StringPrintf("dd if=/dev/zero of=/data/local/tmp/user/0/dir%d/nested/file "
+                            "bs=4096 count=%d 2>/dev/null", i, i + 1).c_str());
+    }
+    system("dd if=/dev/zero of=/data/local/tmp/user/0/file bs=4096 count=3 2>/dev/null");
+
+    gExpectedTreeSize = 0;
+    ASSERT_EQ(0, nftw("/data/local/tmp/user/0", addNodeSize, 16, FTW_PHYS));
+
+    int64_t size = 0;
+    ASSERT_EQ(0, calculate_tree_size("/data/local/tmp/user/0", &size));
+    EXPECT_EQ(gExpectedTreeSize, size);
+
+    // The size is added to the given one.
+    ASSERT_EQ(0, calculate_tree_size("/data/local/tmp/user/0", &size));
+    EXPECT_EQ(2 * gExpectedTreeSize, size);
+
+    EXPECT_EQ(-1, calculate_tree_size("/data/local/tmp/user/0/missing", &size));
+}
+
 TEST_F(UtilsTest, TestSdkSandboxDataPaths) {
     // Ce data paths
     EXPECT_EQ("/data/misc_ce/0/sdksandbox",
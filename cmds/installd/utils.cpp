@@ -30,8 +30,18 @@
 #include <unistd.h>
 #include <uuid/uuid.h>
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
 #include <android-base/file.h>
 #include <android-base/logging.h>
+#include <android-base/no_destructor.h>
 #include <android-base/stringprintf.h>
 #include <android-base/strings.h>
 #include <android-base/unique_fd.h>
@@ -464,11 +474,23 @@ int set_quota_project_id(const std::string& path, long project_id, bool set_inhe
     return 0;
 }
 
-int calculate_tree_size(const std::string& path, int64_t* size,
-        int32_t include_gid, int32_t exclude_gid, bool exclude_apps) {
+// Number of threads, including the calling one, that calculate_tree_size() splits the top level
+// directories of a tree across. Large trees like media or app caches are mostly bound by the
+// latency of reading directories and inodes, which overlaps well across a few threads.
+static constexpr size_t kTreeSizeThreads = 4;
+
+/**
+ * Adds the size of the nodes under the given path that match the filters to size. When
+ * subdirs is not null, the directories directly under path that are on the same device are
+ * counted but not descended into, and are appended to subdirs instead. When count_root is
+ * false, the node at path itself is not considered, as it was counted by the walk that found it.
+ */
+static int measure_tree(const std::string& path, int64_t* size, int32_t include_gid,
+        int32_t exclude_gid, bool exclude_apps, bool count_root,
+        std::vector<std::string>* subdirs) {
     FTS *fts;
     FTSENT *p;
-    int64_t matchedSize = 0;
+    dev_t root_dev = 0;
     char *argv[] = { (char*) path.c_str(), nullptr };
     if (!(fts = fts_open(argv, FTS_PHYSICAL | FTS_NOCHDIR | FTS_XDEV, nullptr))) {
         if (errno != ENOENT) {
@@ -477,6 +499,10 @@ int calculate_tree_size(const std::string& path, int64_t* size,
         return -1;
     }
     while ((p = fts_read(fts)) != nullptr) {
+        if (p->fts_level == FTS_ROOTLEVEL) {
+            root_dev = p->fts_statp->st_dev;
+            if (!count_root) continue;
+        }
         switch (p->fts_info) {
         case FTS_D:
         case FTS_DEFAULT:
@@ -494,17 +520,132 @@ int calculate_tree_size(const std::string& path, int64_t* size,
                 fts_set(fts, p, FTS_SKIP);
                 break;
             }
+            if (subdirs != nullptr && p->fts_info == FTS_D && p->fts_level == FTS_ROOTLEVEL + 1
+                    && p->fts_statp->st_dev == root_dev) {
+                subdirs->emplace_back(p->fts_path);
+                fts_set(fts, p, FTS_SKIP);
+            }
             if (include_gid != -1 && gid != include_gid) {
                 break;
             }
             if (exclude_gid != -1 && gid == exclude_gid) {
                 break;
             }
-            matchedSize += (p->fts_statp->st_blocks * 512);
+            *size += (p->fts_statp->st_blocks * 512);
             break;
         }
     }
     fts_close(fts);
+    return 0;
+}
+
+/**
+ * Threads that calculate_tree_size() hands walks to. They are started on first use and kept,
+ * rather than started for every call.
+ */
+class TreeSizeWorkers {
+public:
+    explicit TreeSizeWorkers(size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            std::thread(&TreeSizeWorkers::run, this).detach();
+        }
+    }
+
+    void post(std::function<void()> job) {
+        {
+            std::lock_guard<std::mutex> lock(mLock);
+            mJobs.push_back(std::move(job));
+        }
+        mJobAvailable.notify_one();
+    }
+
+private:
+    void run() {
+        while (true) {
+            std::function<void()> job;
+            {
+                std::unique_lock<std::mutex> lock(mLock);
+                mJobAvailable.wait(lock, [this] { return !mJobs.empty(); });
+                job = std::move(mJobs.front());
+                mJobs.pop_front();
+            }
+            job();
+        }
+    }
+
+    std::mutex mLock;
+    std::condition_variable mJobAvailable;
+    std::deque<std::function<void()>> mJobs;
+};
+
+static TreeSizeWorkers& tree_size_workers() {
+    static android::base::NoDestructor<TreeSizeWorkers> workers(kTreeSizeThreads - 1);
+    return *workers;
+}
+
+/**
+ * The top level directories of a calculate_tree_size() call, shared with the workers. A worker
+ * may only get to it after the call returned, once every directory was claimed.
+ */
+struct TreeSizeWalk {
+    std::vector<std::string> subdirs;
+    int32_t include_gid;
+    int32_t exclude_gid;
+    bool exclude_apps;
+    std::atomic<size_t> next_subdir = 0;
+
+    std::mutex lock;
+    std::condition_variable walkers_done;
+    // Guarded by lock.
+    size_t active_walkers = 0;
+    int64_t size = 0;
+};
+
+// Measures the unclaimed top level directories of the walk, one at a time, so that a single large
+// directory doesn't leave the other threads idle on the rest.
+static void measure_subdirs(TreeSizeWalk* walk) {
+    {
+        std::lock_guard<std::mutex> lock(walk->lock);
+        walk->active_walkers++;
+    }
+    int64_t measured = 0;
+    for (size_t i = walk->next_subdir++; i < walk->subdirs.size(); i = walk->next_subdir++) {
+        measure_tree(walk->subdirs[i], &measured, walk->include_gid, walk->exclude_gid,
+                walk->exclude_apps, /*count_root=*/false, nullptr);
+    }
+    {
+        std::lock_guard<std::mutex> lock(walk->lock);
+        walk->active_walkers--;
+        walk->size += measured;
+    }
+    walk->walkers_done.notify_all();
+}
+
+int calculate_tree_size(const std::string& path, int64_t* size,
+        int32_t include_gid, int32_t exclude_gid, bool exclude_apps) {
+    int64_t matchedSize = 0;
+    auto walk = std::make_shared<TreeSizeWalk>();
+    if (measure_tree(path, &matchedSize, include_gid, exclude_gid, exclude_apps,
+            /*count_root=*/true, &walk->subdirs) != 0) {
+        return -1;
+    }
+    walk->include_gid = include_gid;
+    walk->exclude_gid = exclude_gid;
+    walk->exclude_apps = exclude_apps;
+
+    // Walk the top level directories in parallel, with the calling thread taking part.
+    const size_t threadCount = std::min(kTreeSizeThreads, walk->subdirs.size());
+    for (size_t i = 1; i < threadCount; i++) {
+        tree_size_workers().post([walk]() { measure_subdirs(walk.get()); });
+    }
+    measure_subdirs(walk.get());
+    {
+        // Every directory is claimed, so only wait for the walks that are still measuring one.
+        std::unique_lock<std::mutex> lock(walk->lock);
+        walk->walkers_done.wait(lock, [&walk]() { return walk->active_walkers == 0; });
+        matchedSize += walk->size;
+    }
+
 #if MEASURE_DEBUG
     if ((include_gid == -1) && (exclude_gid == -1)) {
         LOG(DEBUG) << "Measured " << path << " size " << matchedSize;
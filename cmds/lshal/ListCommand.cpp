@@ -19,6 +19,7 @@
 #include <getopt.h>
 
 #include <algorithm>
+#include <atomic>
 #include <fstream>
 #include <functional>
 #include <iomanip>
@@ -26,6 +27,7 @@
 #include <map>
 #include <regex>
 #include <sstream>
+#include <thread>
 
 #include <android-base/file.h>
 #include <android-base/hex.h>
@@ -54,6 +56,9 @@ using ::android::hidl::manager::V1_0::IServiceManager;
 namespace android {
 namespace lshal {
 
+// Number of threads, including the calling one, that fetch the information of binderized HALs.
+static constexpr size_t kFetchBinderizedThreads = 8;
+
 vintf::SchemaType toSchemaType(Partition p) {
     return (p == Partition::SYSTEM) ? vintf::SchemaType::FRAMEWORK : vintf::SchemaType::DEVICE;
 }
@@ -211,6 +216,7 @@ bool ListCommand::getPidInfo(
 }
 
 const BinderPidInfo* ListCommand::getPidInfoCached(pid_t serverPid) {
+    std::lock_guard<std::mutex> lock(mCachedPidInfosLock);
     auto pair = mCachedPidInfos.insert({serverPid, BinderPidInfo{}});
     if (pair.second /* did insertion take place? */) {
         if (!getPidInfo(serverPid, &pair.first->second)) {
@@ -619,16 +625,43 @@ Status ListCommand::fetchBinderized(const sp<IServiceManager> &manager) {
         return DUMP_BINDERIZED_ERROR;
     }
 
-    Status status = OK;
     std::map<std::string, TableEntry> allTableEntries;
+    std::vector<TableEntry*> entriesToFetch;
     for (const auto& fqInstanceName : *fqInstanceNames) {
         // create entry and default assign all fields.
-        TableEntry& entry = allTableEntries[fqInstanceName];
+        auto [it, inserted] = allTableEntries.try_emplace(fqInstanceName);
+        if (!inserted) continue;
+        TableEntry& entry = it->second;
         entry.interfaceName = fqInstanceName;
         entry.transport = mode;
         entry.serviceStatus = ServiceStatus::NON_RESPONSIVE;
+        entriesToFetch.push_back(&entry);
+    }
 
-        status |= fetchBinderizedEntry(manager, &entry);
+    // Each entry takes several IPCs to the HAL, each of which can take up to the IPC timeout for
+    // a HAL that doesn't respond, so fetch several entries at the same time. The warnings of each
+    // entry are printed afterwards, in the same order as when fetching them one at a time.
+    std::vector<Status> statuses(entriesToFetch.size(), OK);
+    std::vector<std::ostringstream> warnings(entriesToFetch.size());
+    std::atomic<size_t> nextEntry = 0;
+    auto fetchNext = [&]() {
+        for (size_t i = nextEntry++; i < entriesToFetch.size(); i = nextEntry++) {
+            statuses[i] = fetchBinderizedEntry(manager, entriesToFetch[i], warnings[i]);
+        }
+    };
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < std::min(kFetchBinderizedThreads, entriesToFetch.size()); i++) {
+        threads.emplace_back(fetchNext);
+    }
+    fetchNext();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    Status status = OK;
+    for (size_t i = 0; i < entriesToFetch.size(); i++) {
+        err() << warnings[i].str();
+        status |= statuses[i];
     }
 
     for (auto& pair : allTableEntries) {
@@ -638,10 +671,10 @@ Status ListCommand::fetchBinderized(const sp<IServiceManager> &manager) {
 }
 
 Status ListCommand::fetchBinderizedEntry(const sp<IServiceManager> &manager,
-                                         TableEntry *entry) {
+                                         TableEntry *entry, std::ostream &warnings) {
     Status status = OK;
     const auto handleError = [&](Status additionalError, const std::string& msg) {
-        err() << "Warning: Skipping \"" << entry->interfaceName << "\": " << msg << std::endl;
+        warnings << "Warning: Skipping \"" << entry->interfaceName << "\": " << msg << std::endl;
         status |= DUMP_BINDERIZED_ERROR | additionalError;
     };
 
@@ -20,6 +20,7 @@
 #include <stdint.h>
 
 #include <fstream>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -99,8 +100,10 @@ protected:
     Status fetchManifestHals();
     Status fetchLazyHals();
 
+    // Fills in entry, and writes the reasons for skipping any of its information to warnings.
+    // Called on several threads at the same time for different entries.
     Status fetchBinderizedEntry(const sp<::android::hidl::manager::V1_0::IServiceManager> &manager,
-                                TableEntry *entry);
+                                TableEntry *entry, std::ostream &warnings);
 
     // Get relevant information for a PID by parsing files under
     // /dev/binderfs/binder_logs or /d/binder.
@@ -186,6 +189,7 @@ protected:
     std::map<pid_t, std::string> mCmdlines;
 
     // Cache for getPidInfo.
+    std::mutex mCachedPidInfosLock;
     std::map<pid_t, BinderPidInfo> mCachedPidInfos;
 
     // Cache for getPartition.
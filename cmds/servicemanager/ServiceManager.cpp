@@ -16,9 +16,11 @@
 
 #include "ServiceManager.h"
 
+#include <android-base/file.h>
 #include <android-base/logging.h>
 #include <android-base/properties.h>
 #include <android-base/scopeguard.h>
+#include <android-base/stringprintf.h>
 #include <android-base/strings.h>
 #include <binder/BpBinder.h>
 #include <binder/IPCThreadState.h>
@@ -26,6 +28,7 @@
 #include <binder/Stability.h>
 #include <cutils/android_filesystem_config.h>
 #include <cutils/multiuser.h>
+#include <algorithm>
 #include <thread>
 
 #if !defined(VENDORSERVICEMANAGER) && !defined(__ANDROID_RECOVERY__)
@@ -380,6 +383,15 @@ ServiceManager::ServiceManager(std::unique_ptr<Access>&& access) : mAccess(std::
 ServiceManager::~ServiceManager() {
     // this should only happen in tests
 
+    if (mNotificationThread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(mNotificationLock);
+            mStopNotificationThread = true;
+        }
+        mNotificationCondition.notify_one();
+        mNotificationThread.join();
+    }
+
     for (const auto& [name, callbacks] : mNameToRegistrationCallback) {
         CHECK(!callbacks.empty()) << name;
         for (const auto& callback : callbacks) {
@@ -582,10 +594,7 @@ Status ServiceManager::addService(const std::string& name, const sp<IBinder>& bi
         CHECK(handleServiceClientCallback(2 /* sm + transaction */, name, false));
         mNameToService[name].guaranteeClient = true;
 
-        for (const sp<IServiceCallback>& cb : it->second) {
-            // permission checked in registerForNotifications
-            cb->onRegistration(name, binder);
-        }
+        notifyRegistration(name, binder, it->second);
     }
 
     return Status::ok();
@@ -615,6 +624,7 @@ Status ServiceManager::listServices(int32_t dumpPriority, std::vector<std::strin
             outList->push_back(name);
         }
     }
+    std::sort(outList->begin(), outList->end());
 
     return Status::ok();
 }
@@ -666,7 +676,7 @@ Status ServiceManager::registerForNotifications(
 
         // never null if an entry exists
         CHECK(binder != nullptr) << name;
-        callback->onRegistration(name, binder);
+        notifyRegistration(name, binder, {callback});
     }
 
     return Status::ok();
@@ -966,6 +976,102 @@ ssize_t ServiceManager::Service::getNodeStrongRefCount() {
     return ProcessState::self()->getStrongRefCountForNode(bpBinder);
 }
 
+void ServiceManager::startNotificationThread() {
+    CHECK(!mNotificationThread.joinable()) << "Notification thread already started";
+    mNotificationThread = std::thread([this] { runNotificationThread(); });
+}
+
+void ServiceManager::notifyRegistration(const std::string& name, const sp<IBinder>& binder,
+                                        std::vector<sp<IServiceCallback>> callbacks) {
+    RegistrationNotification notification{
+            .name = name,
+            .binder = binder,
+            .callbacks = std::move(callbacks),
+            .queuedAt = std::chrono::steady_clock::now(),
+    };
+
+    if (!mNotificationThread.joinable()) {
+        sendRegistrationNotification(notification);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mNotificationLock);
+        mPendingNotifications.push_back(std::move(notification));
+        mNotificationStats.maxPending =
+                std::max(mNotificationStats.maxPending, mPendingNotifications.size());
+    }
+    mNotificationCondition.notify_one();
+}
+
+void ServiceManager::sendRegistrationNotification(const RegistrationNotification& notification) {
+    size_t failed = 0;
+    for (const sp<IServiceCallback>& cb : notification.callbacks) {
+        // permission checked in registerForNotifications
+        if (!cb->onRegistration(notification.name, notification.binder).isOk()) failed++;
+    }
+    std::chrono::nanoseconds latency = std::chrono::steady_clock::now() - notification.queuedAt;
+
+    std::lock_guard<std::mutex> lock(mNotificationLock);
+    mNotificationStats.notifications++;
+    mNotificationStats.callbacks += notification.callbacks.size();
+    mNotificationStats.failedCallbacks += failed;
+    mNotificationStats.totalLatency += latency;
+    mNotificationStats.maxLatency = std::max(mNotificationStats.maxLatency, latency);
+}
+
+void ServiceManager::runNotificationThread() {
+    std::unique_lock<std::mutex> lock(mNotificationLock);
+    while (true) {
+        mNotificationCondition.wait(lock, [this] {
+            return mStopNotificationThread || !mPendingNotifications.empty();
+        });
+        // notifications queued before shutdown are still sent
+        if (mPendingNotifications.empty()) return;
+
+        std::deque<RegistrationNotification> batch;
+        batch.swap(mPendingNotifications);
+        mNotificationStats.batches++;
+
+        lock.unlock();
+        for (const RegistrationNotification& notification : batch) {
+            sendRegistrationNotification(notification);
+        }
+        lock.lock();
+    }
+}
+
+status_t ServiceManager::dump(int fd, const Vector<String16>& /*args*/) {
+    if (!mAccess->canList(mAccess->getCallingContext())) {
+        return PERMISSION_DENIED;
+    }
+
+    NotificationStats stats;
+    size_t pending;
+    {
+        std::lock_guard<std::mutex> lock(mNotificationLock);
+        stats = mNotificationStats;
+        pending = mPendingNotifications.size();
+    }
+
+    using std::chrono::duration_cast;
+    using std::chrono::microseconds;
+    microseconds average(0);
+    if (stats.notifications > 0) {
+        average = duration_cast<microseconds>(stats.totalLatency) / stats.notifications;
+    }
+    std::string out = base::StringPrintf(
+            "Registration notifications (%s):\n"
+            "  sent: %zu to %zu callbacks (%zu failed) in %zu batches\n"
+            "  pending: %zu (max %zu)\n"
+            "  latency: average %lldus, max %lldus\n",
+            mNotificationThread.joinable() ? "notification thread" : "inline",
+            stats.notifications, stats.callbacks, stats.failedCallbacks, stats.batches, pending,
+            stats.maxPending, static_cast<long long>(average.count()),
+            static_cast<long long>(duration_cast<microseconds>(stats.maxLatency).count()));
+    return base::WriteStringToFd(out, fd) ? OK : -errno;
+}
+
 void ServiceManager::handleClientCallbacks() {
     for (const auto& [name, service] : mNameToService) {
         handleServiceClientCallback(1 /* sm has one refcount */, name, true);
@@ -1161,6 +1267,8 @@ Status ServiceManager::getServiceDebugInfo(std::vector<ServiceDebugInfo>* outRet
 
         outReturn->push_back(std::move(info));
     }
+    std::sort(outReturn->begin(), outReturn->end(),
+              [](const ServiceDebugInfo& a, const ServiceDebugInfo& b) { return a.name < b.name; });
 
     return Status::ok();
 }
@@ -24,6 +24,13 @@
 #include "perfetto/public/te_category_macros.h"
 #endif // !defined(VENDORSERVICEMANAGER) && !defined(__ANDROID_RECOVERY__)
 
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
 #include "Access.h"
 
 namespace android {
@@ -70,6 +77,16 @@ public:
     void binderDied(const wp<IBinder>& who) override;
     void handleClientCallbacks();
 
+    // Prints statistics about registration notifications.
+    status_t dump(int fd, const Vector<String16>& args) override;
+
+    /**
+     * From now on, send onRegistration callbacks from a thread of their own instead of from the
+     * thread calling addService, so that sending one oneway transaction per waiting client does
+     * not hold up other requests. Callbacks are still sent in the order they are queued.
+     */
+    void startNotificationThread();
+
     /**
      *  This API is added for debug purposes. It clears members which hold service and callback
      * information.
@@ -94,9 +111,11 @@ private:
         ~Service();
     };
 
-    using ServiceCallbackMap = std::map<std::string, std::vector<sp<IServiceCallback>>>;
-    using ClientCallbackMap = std::map<std::string, std::vector<sp<IClientCallback>>>;
-    using ServiceMap = std::map<std::string, Service>;
+    // Hashed, since every call looks up by name and there can be hundreds of
+    // services. Anything returning lists of names sorts them itself.
+    using ServiceCallbackMap = std::unordered_map<std::string, std::vector<sp<IServiceCallback>>>;
+    using ClientCallbackMap = std::unordered_map<std::string, std::vector<sp<IClientCallback>>>;
+    using ServiceMap = std::unordered_map<std::string, Service>;
 
     // removes a callback from mNameToRegistrationCallback, removing it if the vector is empty
     // this updates iterator to the next location
@@ -113,6 +132,28 @@ private:
     // this updates the iterator to the next location
     void removeClientCallback(const wp<IBinder>& who, ClientCallbackMap::iterator* it);
 
+    struct RegistrationNotification {
+        std::string name;
+        sp<IBinder> binder;
+        std::vector<sp<IServiceCallback>> callbacks;
+        std::chrono::steady_clock::time_point queuedAt;
+    };
+    struct NotificationStats {
+        size_t notifications = 0;
+        size_t callbacks = 0;
+        size_t failedCallbacks = 0;
+        size_t batches = 0;
+        size_t maxPending = 0;
+        std::chrono::nanoseconds totalLatency{0};
+        std::chrono::nanoseconds maxLatency{0};
+    };
+
+    // Sends onRegistration to each of the callbacks, through the notification thread if it runs
+    void notifyRegistration(const std::string& name, const sp<IBinder>& binder,
+                            std::vector<sp<IServiceCallback>> callbacks);
+    void sendRegistrationNotification(const RegistrationNotification& notification);
+    void runNotificationThread();
+
     os::Service tryGetService(const std::string& name, bool startIfNotFound);
     sp<IBinder> tryGetBinder(const std::string& name, bool startIfNotFound);
     binder::Status canAddService(const Access::CallingContext& ctx, const std::string& name,
@@ -125,6 +166,16 @@ private:
     ClientCallbackMap mNameToClientCallback;
 
     std::unique_ptr<Access> mAccess;
+
+    std::mutex mNotificationLock;
+    std::condition_variable mNotificationCondition;
+    // Notifications waiting for the notification thread, and statistics on all of them. The
+    // thread takes every pending notification at once, so that a burst of registrations at boot
+    // is sent as one batch.
+    std::deque<RegistrationNotification> mPendingNotifications;
+    NotificationStats mNotificationStats;
+    bool mStopNotificationThread = false;
+    std::thread mNotificationThread;
 };
 
 }  // namespace android
@@ -24,6 +24,10 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
 #include "Access.h"
 #include "ServiceManager.h"
 
@@ -564,3 +568,54 @@ TEST(ServiceNotifications, GetMultipleNotification) {
     EXPECT_THAT(cb->registrations, ElementsAre("asdfasdf", "asdfasdf"));
     EXPECT_THAT(cb->registrations, ElementsAre("asdfasdf", "asdfasdf"));
 }
+
+TEST(ServiceNotifications, GetNotificationsFromNotificationThread) {
+    class WaitingCallback : public BnServiceCallback {
+        Status onRegistration(const std::string& name, const sp<IBinder>& binder) override {
+            std::lock_guard<std::mutex> lock(mLock);
+            EXPECT_NE(std::this_thread::get_id(), mTestThread);
+            registrations.push_back(name);
+            binders.push_back(binder);
+            mCondition.notify_all();
+            return Status::ok();
+        }
+
+        android::status_t linkToDeath(const sp<DeathRecipient>&, void*, uint32_t) override {
+            // let SM linkToDeath
+            return android::OK;
+        }
+
+        std::mutex mLock;
+        std::condition_variable mCondition;
+        std::thread::id mTestThread = std::this_thread::get_id();
+
+    public:
+        bool waitFor(size_t count) {
+            std::unique_lock<std::mutex> lock(mLock);
+            return mCondition.wait_for(lock, std::chrono::seconds(5),
+                                       [&] { return registrations.size() >= count; });
+        }
+
+        std::vector<std::string> registrations;
+        std::vector<sp<IBinder>> binders;
+    };
+
+    auto sm = getPermissiveServiceManager();
+    sm->startNotificationThread();
+
+    sp<WaitingCallback> cb = sp<WaitingCallback>::make();
+
+    sp<IBinder> binder1 = getBinder();
+    sp<IBinder> binder2 = getBinder();
+
+    EXPECT_TRUE(sm->addService("asdfasdf", binder1,
+        false /*allowIsolated*/, IServiceManager::DUMP_FLAG_PRIORITY_DEFAULT).isOk());
+    EXPECT_TRUE(sm->registerForNotifications("asdfasdf", cb).isOk());
+    EXPECT_TRUE(sm->addService("asdfasdf", binder2,
+        false /*allowIsolated*/, IServiceManager::DUMP_FLAG_PRIORITY_DEFAULT).isOk());
+
+    // notifications arrive in order
+    ASSERT_TRUE(cb->waitFor(2));
+    EXPECT_THAT(cb->registrations, ElementsAre("asdfasdf", "asdfasdf"));
+    EXPECT_THAT(cb->binders, ElementsAre(binder1, binder2));
+}
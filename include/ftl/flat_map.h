@@ -0,0 +1,272 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <ftl/initializer_list.h>
+#include <ftl/optional.h>
+#include <ftl/small_vector.h>
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace android::ftl {
+
+// Associative container with unique keys kept in sorted order. Like ftl::SmallMap, key-value pairs
+// are stored in contiguous storage, which is allocated statically until the size exceeds N. Unlike
+// ftl::SmallMap, lookup is a binary search instead of a linear scan. The linear scan is faster for
+// a handful of mappings, so FlatMap is the better fit only for maps that usually hold more than 16
+// or so (see flat_map_benchmark.cpp). Insertion and removal shift the subsequent mappings, so both
+// K and V must be move-assignable. Iteration is in ascending order of keys.
+//
+// The API mirrors ftl::SmallMap, so that one can be swapped for the other. Keys must not be
+// modified through iterators.
+//
+// FlatMap<K, V, 0> unconditionally allocates on the heap.
+//
+// Example usage:
+//
+//   ftl::FlatMap<int, std::string, 3> map;
+//   assert(map.empty());
+//   assert(!map.dynamic());
+//
+//   map = ftl::init::map<int, std::string>(123, "abc")(-1)(42, 3u, '?');
+//   assert(map.size() == 3u);
+//   assert(!map.dynamic());
+//
+//   assert(map.contains(123));
+//   assert(map.get(42).transform([](const std::string& s) { return s.size(); }) == 3u);
+//   assert(map.begin()->first == -1);
+//
+//   map.emplace_or_replace(0, "vanilla", 2u, 3u);
+//   assert(map.dynamic());
+//
+//   assert(map == FlatMap(ftl::init::map(-1, ""sv)(0, "nil"sv)(42, "???"sv)(123, "abc"sv)));
+//
+template <typename K, typename V, std::size_t N, typename Compare = std::less<K>>
+class FlatMap final {
+  using Map = SmallVector<std::pair<K, V>, N>;
+
+  template <typename, typename, std::size_t, typename>
+  friend class FlatMap;
+
+ public:
+  using key_type = K;
+  using mapped_type = V;
+  using key_compare = Compare;
+
+  using value_type = typename Map::value_type;
+  using size_type = typename Map::size_type;
+  using difference_type = typename Map::difference_type;
+
+  using reference = typename Map::reference;
+  using iterator = typename Map::iterator;
+
+  using const_reference = typename Map::const_reference;
+  using const_iterator = typename Map::const_iterator;
+
+  // Creates an empty map.
+  FlatMap() = default;
+
+  // Constructs at most N key-value pairs in place by forwarding per-pair constructor arguments,
+  // with the same syntax as ftl::SmallMap. If a key is listed more than once, its first mapping
+  // is kept.
+  //
+  //   ftl::FlatMap map = ftl::init::map(2, 'c')(0, 'a')(1, 'b');
+  //   static_assert(std::is_same_v<decltype(map), ftl::FlatMap<int, char, 3>>);
+  //
+  template <typename U, std::size_t... Sizes, typename... Types>
+  FlatMap(InitializerList<U, std::index_sequence<Sizes...>, Types...>&& list)
+      : map_(std::move(list)) {
+    sort_and_deduplicate();
+  }
+
+  // Copies or moves key-value pairs from a convertible map.
+  template <typename Q, typename W, std::size_t M>
+  FlatMap(FlatMap<Q, W, M, Compare> other) : map_(std::move(other.map_)) {}
+
+  static constexpr size_type static_capacity() { return N; }
+
+  size_type max_size() const { return map_.max_size(); }
+  size_type size() const { return map_.size(); }
+  bool empty() const { return map_.empty(); }
+
+  // Returns whether the map is backed by static or dynamic storage.
+  bool dynamic() const {
+    if constexpr (static_capacity() > 0) {
+      return map_.dynamic();
+    } else {
+      return true;
+    }
+  }
+
+  iterator begin() { return map_.begin(); }
+  const_iterator begin() const { return cbegin(); }
+  const_iterator cbegin() const { return map_.cbegin(); }
+
+  iterator end() { return map_.end(); }
+  const_iterator end() const { return cend(); }
+  const_iterator cend() const { return map_.cend(); }
+
+  // Returns whether a mapping exists for the given key.
+  bool contains(const key_type& key) const { return find(key) != end(); }
+
+  // Returns a reference to the value for the given key, or std::nullopt if the key was not found.
+  auto get(const key_type& key) const -> Optional<std::reference_wrapper<const mapped_type>> {
+    if (const auto it = find(key); it != end()) {
+      return std::cref(it->second);
+    }
+    return {};
+  }
+
+  auto get(const key_type& key) -> Optional<std::reference_wrapper<mapped_type>> {
+    if (const auto it = find(key); it != end()) {
+      return std::ref(it->second);
+    }
+    return {};
+  }
+
+  // Returns an iterator to an existing mapping for the given key, or the end() iterator otherwise.
+  const_iterator find(const key_type& key) const { return const_cast<FlatMap&>(*this).find(key); }
+
+  iterator find(const key_type& key) {
+    const auto it = lower_bound(key);
+    return it != end() && !Compare{}(key, it->first) ? it : end();
+  }
+
+  // Inserts a mapping unless it exists. Returns an iterator to the inserted or existing mapping,
+  // and whether the mapping was inserted.
+  //
+  // On emplace, all iterators are invalidated.
+  //
+  template <typename... Args>
+  std::pair<iterator, bool> try_emplace(const key_type& key, Args&&... args) {
+    const auto it = lower_bound(key);
+    if (it != end() && !Compare{}(key, it->first)) {
+      return {it, false};
+    }
+
+    const auto index = std::distance(begin(), it);
+    map_.emplace_back(std::piecewise_construct, std::forward_as_tuple(key),
+                      std::forward_as_tuple(std::forward<Args>(args)...));
+
+    // Shift the new mapping from the back into its sorted position.
+    const auto position = std::next(begin(), index);
+    std::rotate(position, std::prev(end()), end());
+    return {position, true};
+  }
+
+  // Replaces a mapping if it exists, and returns an iterator to it. Returns the end() iterator
+  // otherwise.
+  //
+  // The arguments may directly or indirectly refer to the mapping being replaced.
+  //
+  // Iterators to the replaced mapping point to its replacement, and others remain valid.
+  //
+  template <typename... Args>
+  iterator try_replace(const key_type& key, Args&&... args) {
+    const auto it = find(key);
+    if (it == end()) return it;
+    map_.replace(it, std::piecewise_construct, std::forward_as_tuple(key),
+                 std::forward_as_tuple(std::forward<Args>(args)...));
+    return it;
+  }
+
+  // In-place counterpart of std::map's insert_or_assign. Returns true on emplace, or false on
+  // replace.
+  //
+  // On emplace, all iterators are invalidated. On replace, iterators to the replaced mapping point
+  // to its replacement, and others remain valid.
+  //
+  template <typename... Args>
+  std::pair<iterator, bool> emplace_or_replace(const key_type& key, Args&&... args) {
+    const auto [it, ok] = try_emplace(key, std::forward<Args>(args)...);
+    if (ok) return {it, ok};
+    map_.replace(it, std::piecewise_construct, std::forward_as_tuple(key),
+                 std::forward_as_tuple(std::forward<Args>(args)...));
+    return {it, ok};
+  }
+
+  // Removes a mapping if it exists, and returns whether it did.
+  //
+  // Iterators to the erased mapping and those after it are invalidated.
+  //
+  bool erase(const key_type& key) {
+    const auto it = find(key);
+    if (it == end()) return false;
+    std::rotate(it, std::next(it), end());
+    map_.pop_back();
+    return true;
+  }
+
+  // Removes all mappings.
+  //
+  // All iterators are invalidated.
+  //
+  void clear() { map_.clear(); }
+
+ private:
+  iterator lower_bound(const key_type& key) {
+    return std::lower_bound(begin(), end(), key,
+                            [](const auto& pair, const key_type& k) {
+                              return Compare{}(pair.first, k);
+                            });
+  }
+
+  void sort_and_deduplicate() {
+    std::stable_sort(begin(), end(), [](const auto& lhs, const auto& rhs) {
+      return Compare{}(lhs.first, rhs.first);
+    });
+
+    const auto last = std::unique(begin(), end(), [](const auto& lhs, const auto& rhs) {
+      return !Compare{}(lhs.first, rhs.first);
+    });
+
+    for (auto count = std::distance(last, end()); count > 0; --count) {
+      map_.pop_back();
+    }
+  }
+
+  Map map_;
+};
+
+// Deduction guide for in-place constructor.
+template <typename K, typename V, typename E, std::size_t... Sizes, typename... Types>
+FlatMap(InitializerList<KeyValue<K, V, E>, std::index_sequence<Sizes...>, Types...>&&)
+    -> FlatMap<K, V, sizeof...(Sizes)>;
+
+// Returns whether the key-value pairs of two maps are equal.
+template <typename K, typename V, std::size_t N, typename Q, typename W, std::size_t M, typename C>
+bool operator==(const FlatMap<K, V, N, C>& lhs, const FlatMap<Q, W, M, C>& rhs) {
+  if (lhs.size() != rhs.size()) return false;
+
+  // Both maps are sorted by the same order, so compare pairwise.
+  return std::equal(lhs.begin(), lhs.end(), rhs.begin(), [](const auto& l, const auto& r) {
+    return !C{}(l.first, r.first) && !C{}(r.first, l.first) && l.second == r.second;
+  });
+}
+
+// TODO: Remove in C++20.
+template <typename K, typename V, std::size_t N, typename Q, typename W, std::size_t M, typename C>
+inline bool operator!=(const FlatMap<K, V, N, C>& lhs, const FlatMap<Q, W, M, C>& rhs) {
+  return !(lhs == rhs);
+}
+
+}  // namespace android::ftl
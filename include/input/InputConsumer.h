@@ -229,6 +229,9 @@ private:
     // will be raised for that connection, and no further events will be posted to that channel.
     std::unordered_map<uint32_t /*seq*/, nsecs_t /*consumeTime*/> mConsumeTimes;
 
+    // The finished signals of a batch, which are sent together. Kept to reuse its storage.
+    std::vector<InputMessage> mFinishedMessages;
+
     status_t consumeBatch(InputEventFactoryInterface* factory, nsecs_t frameTime, uint32_t* outSeq,
                           InputEvent** outEvent);
     status_t consumeSamples(InputEventFactoryInterface* factory, Batch& batch, size_t count,
@@ -242,7 +245,8 @@ private:
 
     nsecs_t getConsumeTime(uint32_t seq) const;
     void popConsumeTime(uint32_t seq);
-    status_t sendUnchainedFinishedSignal(uint32_t seq, bool handled);
+    InputMessage createFinishedMessage(uint32_t seq, bool handled) const;
+    void onFinishedSignalSent(uint32_t seq);
 
     static void rewriteMessage(TouchState& state, InputMessage& msg);
     static bool canAddSample(const Batch& batch, const InputMessage* msg);
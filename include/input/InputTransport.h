@@ -265,6 +265,21 @@ public:
      */
     virtual status_t sendMessage(const InputMessage* msg);
 
+    // The most messages sendMessages() writes with a single call.
+    static constexpr size_t MAX_MESSAGES_PER_WRITE = 16;
+
+    /* Send several messages to the other endpoint, with as few writes as possible.
+     *
+     * The messages are sent in order, as if by sendMessage(), and sending stops at the first
+     * message which can't be sent. The messages are sanitized in place before being sent.
+     *
+     * Sets outSentCount to the number of messages which were sent.
+     * Return OK if every message was sent.
+     * Otherwise return the error sendMessage() would have returned for the first message which
+     * wasn't sent.
+     */
+    virtual status_t sendMessages(InputMessage* msgs, size_t count, size_t* outSentCount);
+
     /* Receive a message sent by the other endpoint.
      *
      * If there is no message present, try again after poll() indicates that the fd
@@ -379,6 +394,39 @@ public:
                                 const PointerProperties* pointerProperties,
                                 const PointerCoords* pointerCoords);
 
+    /* Builds the message for a motion event, so that several events can be published together
+     * with publishPreparedEvents().
+     *
+     * Returns OK on success.
+     * Returns BAD_VALUE if the event is malformed. The event is checked against the stream of
+     * published events when it is published, so that only published events are verified.
+     */
+    status_t prepareMotionEvent(InputMessage& msg, uint32_t seq, int32_t eventId,
+                                int32_t deviceId, int32_t source, ui::LogicalDisplayId displayId,
+                                std::array<uint8_t, 32> hmac, int32_t action,
+                                int32_t actionButton, int32_t flags, int32_t edgeFlags,
+                                int32_t metaState, int32_t buttonState,
+                                MotionClassification classification, const ui::Transform& transform,
+                                float xPrecision, float yPrecision, float xCursorPosition,
+                                float yCursorPosition, const ui::Transform& rawTransform,
+                                nsecs_t downTime, nsecs_t eventTime, uint32_t pointerCount,
+                                const PointerProperties* pointerProperties,
+                                const PointerCoords* pointerCoords);
+
+    /* Publishes prepared events to the input channel, in order, with as few writes as possible.
+     * Publishing stops at the first event which can't be published.
+     *
+     * Sets outPublishedCount to the number of events which were published.
+     * Returns OK if every event was published.
+     * Returns BAD_VALUE if event verification is enabled and an event is inconsistent with the
+     * published stream. A single event is checked before it is sent, and the events of a batch
+     * once they have been sent.
+     * Returns WOULD_BLOCK if the channel filled up.
+     * Returns DEAD_OBJECT if the channel's peer has been closed.
+     * Other errors probably indicate that the channel is broken.
+     */
+    status_t publishPreparedEvents(InputMessage* msgs, size_t count, size_t* outPublishedCount);
+
     /* Publishes a focus event to the input channel.
      *
      * Returns OK on success.
@@ -450,6 +498,8 @@ public:
     android::base::Result<ConsumerResponse> receiveConsumerResponse();
 
 private:
+    status_t verifyMotionMessage(const InputMessage& msg);
+
     std::shared_ptr<InputChannel> mChannel;
     InputVerifier mInputVerifier;
 };
@@ -18,6 +18,7 @@
 
 #include <array>
 #include <cstdint>
+#include <future>
 #include <memory>
 #include <mutex>
 #include <optional>
@@ -126,6 +127,9 @@ private:
     const std::function<bool()> mCheckMotionPredictionEnabled;
 
     std::unique_ptr<TfLiteMotionPredictorModel> mModel;
+    // The model being loaded in the background, started once prediction is known to be available
+    // so that the first stroke doesn't wait for the model to be read and warmed up.
+    std::future<std::unique_ptr<TfLiteMotionPredictorModel>> mPendingModel;
 
     std::unique_ptr<TfLiteMotionPredictorBuffers> mBuffers;
     std::optional<MotionEvent> mLastEvent;
@@ -140,6 +144,9 @@ private:
     // Called during lazy initialization.
     // TODO: b/210158587 Consider removing lazy initialization.
     void initializeObjects();
+
+    // Starts loading the model in the background, if it isn't loaded or being loaded yet.
+    void loadModelAsync();
 };
 
 } // namespace android
@@ -20,6 +20,7 @@
 #include <optional>
 #include <vector>
 
+#include <ftl/small_vector.h>
 #include <input/Input.h>
 #include <input/InputTransport.h>
 #include <input/RingBuffer.h>
@@ -78,12 +79,14 @@ private:
         PointerCoords coords;
     };
 
+    // The pointers of a sample are stored inline, so that resampling an event on every frame does
+    // not allocate.
     struct Sample {
         std::chrono::nanoseconds eventTime;
-        std::vector<Pointer> pointers;
+        ftl::SmallVector<Pointer, MAX_POINTERS> pointers;
 
-        std::vector<PointerCoords> asPointerCoords() const {
-            std::vector<PointerCoords> pointersCoords;
+        ftl::SmallVector<PointerCoords, MAX_POINTERS> asPointerCoords() const {
+            ftl::SmallVector<PointerCoords, MAX_POINTERS> pointersCoords;
             for (const Pointer& pointer : pointers) {
                 pointersCoords.push_back(pointer.coords);
             }
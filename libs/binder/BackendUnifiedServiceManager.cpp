@@ -14,9 +14,15 @@
  * limitations under the License.
  */
 #include "BackendUnifiedServiceManager.h"
+#include "file.h"
 
+#include <android/os/BnServiceCallback.h>
 #include <android/os/IAccessor.h>
 #include <binder/RpcSession.h>
+#include <utils/String8.h>
+
+#include <inttypes.h>
+#include <algorithm>
 
 #if defined(__BIONIC__) && !defined(__ANDROID_VNDK__)
 #include <android-base/properties.h>
@@ -94,6 +100,23 @@ static const char* kStaticCachableList[] = {
         // go/keep-sorted end
 };
 
+// Lookups of services which aren't registered are remembered for this long,
+// unless servicemanager tells us about a registration first.
+constexpr std::chrono::milliseconds kDefaultNegativeCacheTtl = std::chrono::seconds(10);
+constexpr size_t kDefaultMaxNegativeCacheEntries = 128;
+
+BinderCacheWithInvalidation::BinderCacheWithInvalidation()
+      : mNegativeTtl(kDefaultNegativeCacheTtl),
+        mMaxNegativeEntries(kDefaultMaxNegativeCacheEntries) {
+#if defined(__BIONIC__) && !defined(__ANDROID_VNDK__)
+    mNegativeTtl = std::chrono::milliseconds(
+            base::GetUintProperty<uint64_t>("binder.client_cache.negative_ttl_ms",
+                                            kDefaultNegativeCacheTtl.count()));
+    mMaxNegativeEntries = base::GetUintProperty<size_t>("binder.client_cache.negative_max_entries",
+                                                        kDefaultMaxNegativeCacheEntries);
+#endif
+}
+
 bool BinderCacheWithInvalidation::isClientSideCachingEnabled(const std::string& serviceName) {
     if (ProcessState::self()->getThreadPoolMaxTotalThreadCount() <= 0) {
         ALOGW("Thread Pool max thread count is 0. Cannot cache binder as linkToDeath cannot be "
@@ -109,6 +132,125 @@ bool BinderCacheWithInvalidation::isClientSideCachingEnabled(const std::string&
     return false;
 }
 
+bool BinderCacheWithInvalidation::isNegativeCachingEnabled() {
+    if (mNegativeTtl.count() == 0 || mMaxNegativeEntries == 0) return false;
+    // registration callbacks are needed to invalidate entries
+    return ProcessState::self()->getThreadPoolMaxTotalThreadCount() > 0;
+}
+
+void BinderCacheWithInvalidation::removeExpiredNegativeItemsLocked(
+        NegativeRegistrations* expired) {
+    const auto now = std::chrono::steady_clock::now();
+    if (now < mNextNegativeExpiry) return;
+
+    mNextNegativeExpiry = std::chrono::steady_clock::time_point::max();
+    for (auto it = mNegativeCache.begin(); it != mNegativeCache.end();) {
+        if (it->second.expiry <= now) {
+            expired->emplace_back(it->first, std::move(it->second.callback));
+            it = mNegativeCache.erase(it);
+        } else {
+            mNextNegativeExpiry = std::min(mNextNegativeExpiry, it->second.expiry);
+            ++it;
+        }
+    }
+}
+
+bool BinderCacheWithInvalidation::isNegativeItem(const std::string& key,
+                                                 NegativeRegistrations* expired) {
+    std::lock_guard<std::mutex> lock(mCacheMutex);
+    removeExpiredNegativeItemsLocked(expired);
+    if (mNegativeCache.find(key) != mNegativeCache.end()) {
+        mNegativeHits++;
+        return true;
+    }
+    return false;
+}
+
+BinderCacheWithInvalidation::NegativeRegistrations BinderCacheWithInvalidation::setNegativeItem(
+        const std::string& key, const sp<os::IServiceCallback>& callback,
+        const std::atomic<bool>& callbackFired) {
+    std::lock_guard<std::mutex> lock(mCacheMutex);
+    NegativeRegistrations dropped;
+    removeExpiredNegativeItemsLocked(&dropped);
+    // The service was registered after our lookup. Checked under the lock, so
+    // a registration racing with this drops the entry once we release it.
+    if (callbackFired) return dropped;
+
+    if (auto it = mNegativeCache.find(key); it != mNegativeCache.end()) {
+        // a concurrent lookup added it
+        dropped.emplace_back(it->first, std::move(it->second.callback));
+        mNegativeCache.erase(it);
+    } else if (mNegativeCache.size() >= mMaxNegativeEntries) {
+        auto oldest = mNegativeCache.begin();
+        for (auto it = mNegativeCache.begin(); it != mNegativeCache.end(); ++it) {
+            if (it->second.expiry < oldest->second.expiry) oldest = it;
+        }
+        dropped.emplace_back(oldest->first, std::move(oldest->second.callback));
+        mNegativeCache.erase(oldest);
+    }
+    const auto expiry = std::chrono::steady_clock::now() + mNegativeTtl;
+    mNegativeCache[key] = NegativeEntry{
+            .expiry = expiry,
+            .callback = callback,
+    };
+    mNextNegativeExpiry = std::min(mNextNegativeExpiry, expiry);
+    return dropped;
+}
+
+void BinderCacheWithInvalidation::removeNegativeItem(const std::string& key,
+                                                     const sp<os::IServiceCallback>& callback) {
+    std::lock_guard<std::mutex> lock(mCacheMutex);
+    if (auto it = mNegativeCache.find(key); it != mNegativeCache.end()) {
+        if (callback == nullptr || it->second.callback == callback) {
+            mNegativeCache.erase(it);
+        }
+    }
+}
+
+std::string BinderCacheWithInvalidation::dumpStats() const {
+    size_t entries, negativeEntries;
+    {
+        std::lock_guard<std::mutex> lock(mCacheMutex);
+        entries = mCache.size();
+        negativeEntries = mNegativeCache.size();
+    }
+    return String8::format("Client side service cache: %zu entries, %zu not-found entries "
+                           "(max %zu, ttl %" PRId64 "ms)\n"
+                           "  hits: %" PRIu64 ", not-found hits: %" PRIu64 ", misses: %" PRIu64
+                           "\n",
+                           entries, negativeEntries, mMaxNegativeEntries,
+                           static_cast<int64_t>(mNegativeTtl.count()), mPositiveHits.load(),
+                           mNegativeHits.load(), mMisses.load())
+            .c_str();
+}
+
+// Registered with servicemanager for each name in the negative cache, so a
+// registration of that service drops the entry.
+class NegativeCacheInvalidation : public os::BnServiceCallback {
+public:
+    NegativeCacheInvalidation(std::weak_ptr<BinderCacheWithInvalidation> cache,
+                              const sp<AidlServiceManager>& serviceManager)
+          : mCache(std::move(cache)), mServiceManager(serviceManager) {}
+
+    binder::Status onRegistration(const std::string& name, const sp<IBinder>&) override {
+        if (mFired.exchange(true)) return binder::Status::ok();
+        if (std::shared_ptr<BinderCacheWithInvalidation> cache = mCache.lock()) {
+            cache->removeNegativeItem(name, sp<os::IServiceCallback>::fromExisting(this));
+        }
+        // nothing left to invalidate
+        (void)mServiceManager->unregisterForNotifications(
+                name, sp<os::IServiceCallback>::fromExisting(this));
+        return binder::Status::ok();
+    }
+
+    const std::atomic<bool>& fired() const { return mFired; }
+
+private:
+    std::weak_ptr<BinderCacheWithInvalidation> mCache;
+    sp<AidlServiceManager> mServiceManager;
+    std::atomic<bool> mFired = false;
+};
+
 binder::Status BackendUnifiedServiceManager::updateCache(const std::string& serviceName,
                                                          const os::Service& service) {
     if (!kUseCache) {
@@ -138,6 +280,42 @@ bool BackendUnifiedServiceManager::returnIfCached(const std::string& serviceName
     return false;
 }
 
+bool BackendUnifiedServiceManager::returnIfNegativeCached(const std::string& serviceName,
+                                                          os::Service* _out) {
+    if (!kUseCache) {
+        return false;
+    }
+    BinderCacheWithInvalidation::NegativeRegistrations expired;
+    const bool isNegative = mCacheForGetService->isNegativeItem(serviceName, &expired);
+    unregisterNegativeCallbacks(expired);
+    if (isNegative) {
+        *_out = os::Service::make<os::Service::Tag::binder>(nullptr);
+        return true;
+    }
+    mCacheForGetService->noteMiss();
+    return false;
+}
+
+void BackendUnifiedServiceManager::updateNegativeCache(const std::string& serviceName) {
+    if (!kUseCache || !mCacheForGetService->isNegativeCachingEnabled()) {
+        return;
+    }
+    auto callback = sp<NegativeCacheInvalidation>::make(mCacheForGetService, mTheRealServiceManager);
+    // without a way to learn about the registration, don't cache
+    if (!mTheRealServiceManager->registerForNotifications(serviceName, callback).isOk()) {
+        return;
+    }
+    unregisterNegativeCallbacks(
+            mCacheForGetService->setNegativeItem(serviceName, callback, callback->fired()));
+}
+
+void BackendUnifiedServiceManager::unregisterNegativeCallbacks(
+        const BinderCacheWithInvalidation::NegativeRegistrations& registrations) {
+    for (const auto& [name, callback] : registrations) {
+        (void)mTheRealServiceManager->unregisterForNotifications(name, callback);
+    }
+}
+
 BackendUnifiedServiceManager::BackendUnifiedServiceManager(const sp<AidlServiceManager>& impl)
       : mTheRealServiceManager(impl) {
     mCacheForGetService = std::make_shared<BinderCacheWithInvalidation>();
@@ -175,7 +353,7 @@ binder::Status BackendUnifiedServiceManager::getService2(const ::std::string& na
 binder::Status BackendUnifiedServiceManager::checkService(const ::std::string& name,
                                                           os::Service* _out) {
     os::Service service;
-    if (returnIfCached(name, _out)) {
+    if (returnIfCached(name, _out) || returnIfNegativeCached(name, _out)) {
         return binder::Status::ok();
     }
 
@@ -183,6 +361,10 @@ binder::Status BackendUnifiedServiceManager::checkService(const ::std::string& n
     if (status.isOk()) {
         status = toBinderService(name, service, _out);
         if (status.isOk()) {
+            if (_out->getTag() == os::Service::Tag::binder &&
+                _out->get<os::Service::Tag::binder>() == nullptr) {
+                updateNegativeCache(name);
+            }
             return updateCache(name, service);
         }
     }
@@ -254,7 +436,13 @@ binder::Status BackendUnifiedServiceManager::toBinderService(const ::std::string
 binder::Status BackendUnifiedServiceManager::addService(const ::std::string& name,
                                                         const sp<IBinder>& service,
                                                         bool allowIsolated, int32_t dumpPriority) {
-    return mTheRealServiceManager->addService(name, service, allowIsolated, dumpPriority);
+    binder::Status status =
+            mTheRealServiceManager->addService(name, service, allowIsolated, dumpPriority);
+    // don't wait for the registration callback to see our own service
+    if (kUseCache && status.isOk()) {
+        mCacheForGetService->removeNegativeItem(name, nullptr);
+    }
+    return status;
 }
 binder::Status BackendUnifiedServiceManager::listServices(
         int32_t dumpPriority, ::std::vector<::std::string>* _aidl_return) {
@@ -302,6 +490,12 @@ binder::Status BackendUnifiedServiceManager::getServiceDebugInfo(
     return mTheRealServiceManager->getServiceDebugInfo(_aidl_return);
 }
 
+status_t BackendUnifiedServiceManager::dump(int fd, const Vector<String16>&) {
+    std::string stats = mCacheForGetService->dumpStats();
+    if (!binder::WriteFully(fd, stats.data(), stats.size())) return -errno;
+    return OK;
+}
+
 [[clang::no_destroy]] static std::once_flag gUSmOnce;
 [[clang::no_destroy]] static sp<BackendUnifiedServiceManager> gUnifiedServiceManager;
 
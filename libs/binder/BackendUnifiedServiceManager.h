@@ -18,8 +18,12 @@
 #include <android/os/BnServiceManager.h>
 #include <android/os/IServiceManager.h>
 #include <binder/IPCThreadState.h>
+#include <atomic>
+#include <chrono>
 #include <map>
 #include <memory>
+#include <optional>
+#include <vector>
 
 namespace android {
 
@@ -48,11 +52,21 @@ class BinderCacheWithInvalidation
         sp<BinderInvalidation> deathRecipient;
     };
 
+    // A name which servicemanager didn't know about. Only kept while
+    // `callback` is registered for the name, so registration drops it.
+    struct NegativeEntry {
+        std::chrono::steady_clock::time_point expiry;
+        sp<os::IServiceCallback> callback;
+    };
+
 public:
+    BinderCacheWithInvalidation();
+
     sp<IBinder> getItem(const std::string& key) const {
         std::lock_guard<std::mutex> lock(mCacheMutex);
 
         if (auto it = mCache.find(key); it != mCache.end()) {
+            mPositiveHits++;
             return it->second.service;
         }
         return nullptr;
@@ -93,10 +107,45 @@ public:
     }
 
     bool isClientSideCachingEnabled(const std::string& serviceName);
+    bool isNegativeCachingEnabled();
+
+    // Names and callbacks of dropped negative entries, for the caller to
+    // unregister.
+    using NegativeRegistrations = std::vector<std::pair<std::string, sp<os::IServiceCallback>>>;
+
+    // Whether `key` is known not to be registered, and the entry hasn't
+    // expired. Expired entries are dropped, and added to `expired`.
+    bool isNegativeItem(const std::string& key, NegativeRegistrations* expired);
+    // Adds a negative entry, unless `callbackFired` is set. Returns the
+    // dropped entries: the expired ones, an earlier one for `key`, and the
+    // one closest to expiry if the cache is full.
+    NegativeRegistrations setNegativeItem(const std::string& key,
+                                          const sp<os::IServiceCallback>& callback,
+                                          const std::atomic<bool>& callbackFired);
+    // Drops the negative entry for `key`. If `callback` is set, only an entry
+    // registered with that callback is dropped.
+    void removeNegativeItem(const std::string& key, const sp<os::IServiceCallback>& callback);
+
+    void noteMiss() { mMisses++; }
+    std::string dumpStats() const;
 
 private:
     std::map<std::string, Entry> mCache;
+    std::map<std::string, NegativeEntry> mNegativeCache;
+    // No negative entry expires before this.
+    std::chrono::steady_clock::time_point mNextNegativeExpiry =
+            std::chrono::steady_clock::time_point::max();
     mutable std::mutex mCacheMutex;
+
+    // Drops the expired negative entries. Requires mCacheMutex.
+    void removeExpiredNegativeItemsLocked(NegativeRegistrations* expired);
+
+    std::chrono::milliseconds mNegativeTtl;
+    size_t mMaxNegativeEntries;
+
+    mutable std::atomic<uint64_t> mPositiveHits = 0;
+    std::atomic<uint64_t> mNegativeHits = 0;
+    std::atomic<uint64_t> mMisses = 0;
 };
 
 class BackendUnifiedServiceManager : public android::os::BnServiceManager {
@@ -130,6 +179,9 @@ public:
                                         const sp<IBinder>& service) override;
     binder::Status getServiceDebugInfo(::std::vector<os::ServiceDebugInfo>* _aidl_return) override;
 
+    // Reports client side cache statistics.
+    status_t dump(int fd, const Vector<String16>& args) override;
+
     // for legacy ABI
     const String16& getInterfaceDescriptor() const override {
         return mTheRealServiceManager->getInterfaceDescriptor();
@@ -142,6 +194,10 @@ private:
                                    os::Service* _out);
     binder::Status updateCache(const std::string& serviceName, const os::Service& service);
     bool returnIfCached(const std::string& serviceName, os::Service* _out);
+    bool returnIfNegativeCached(const std::string& serviceName, os::Service* _out);
+    void updateNegativeCache(const std::string& serviceName);
+    void unregisterNegativeCallbacks(
+            const BinderCacheWithInvalidation::NegativeRegistrations& registrations);
 };
 
 sp<BackendUnifiedServiceManager> getBackendUnifiedServiceManager();
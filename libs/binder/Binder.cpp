@@ -27,6 +27,7 @@
 #include <binder/Parcel.h>
 #include <binder/RecordedTransaction.h>
 #include <binder/RpcServer.h>
+#include <binder/TransactionLatencyStats.h>
 #include <binder/unique_fd.h>
 #include <pthread.h>
 
@@ -46,6 +47,7 @@ namespace android {
 using android::binder::unique_fd;
 
 constexpr uid_t kUidRoot = 0;
+constexpr uid_t kUidShell = 2000;
 
 // Service implementations inherit from BBinder and IBinder, and this is frozen
 // in prebuilts.
@@ -364,6 +366,25 @@ status_t BBinder::stopRecordingTransactions() {
     }
 }
 
+static status_t dumpLatencyStats(const Parcel& data) {
+    if constexpr (!kEnableKernelIpc) {
+        (void)data;
+        ALOGW("Binder latency dump disallowed because kernel binder is not enabled");
+        return INVALID_OPERATION;
+    } else {
+        uid_t uid = IPCThreadState::self()->getCallingUid();
+        if (uid != kUidRoot && uid != kUidShell) {
+            ALOGE("Binder latency dump not allowed because client %" PRIu32
+                  " is not root or shell",
+                  uid);
+            return PERMISSION_DENIED;
+        }
+        int fd = data.readFileDescriptor();
+        if (fd < 0) return BAD_VALUE;
+        return TransactionLatencyStats::dump(fd);
+    }
+}
+
 const String16& BBinder::getInterfaceDescriptor() const
 {
     static StaticString16 sBBinder(u"BBinder");
@@ -392,6 +413,9 @@ status_t BBinder::transact(
         case STOP_RECORDING_TRANSACTION:
             err = stopRecordingTransactions();
             break;
+        case DUMP_LATENCY_TRANSACTION:
+            err = dumpLatencyStats(data);
+            break;
         case EXTENSION_TRANSACTION:
             LOG_ALWAYS_FATAL_IF(reply == nullptr, "reply == nullptr");
             err = reply->writeStrongBinder(getExtension());
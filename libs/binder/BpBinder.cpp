@@ -24,9 +24,12 @@
 #include <binder/RpcSession.h>
 #include <binder/Stability.h>
 #include <binder/Trace.h>
+#include <binder/TransactionLatencyStats.h>
 
 #include <stdio.h>
 
+#include <set>
+
 #include "BuildFlags.h"
 #include "file.h"
 
@@ -50,6 +53,21 @@ bool BpBinder::sBinderProxyThrottleCreate = false;
 
 static StaticString16 kDescriptorUninit(u"");
 
+// Only local descriptors are interned, but they are kept for the life of the process, so bound the
+// size of their contents anyway.
+static constexpr size_t kMaxInternedDescriptorBytes = 64 * 1024;
+
+struct InternedDescriptors {
+    RpcMutex lock;
+    std::set<String16> descriptors;
+    size_t bytes = 0;
+};
+
+static InternedDescriptors& internedDescriptors() {
+    static InternedDescriptors* sInterned = new InternedDescriptors();
+    return *sInterned;
+}
+
 // Arbitrarily high value that probably distinguishes a bad behaving app
 uint32_t BpBinder::sBinderProxyCountHighWatermark = 2500;
 // Another arbitrary value a binder count needs to drop below before another callback will be called
@@ -252,6 +270,7 @@ BpBinder::BpBinder(Handle&& handle)
         mObitsSent(false),
         mObituaries(nullptr),
         mDescriptorCache(kDescriptorUninit),
+        mDescriptorCached(false),
         mTrackedUid(-1) {
     extendObjectLifetime(OBJECT_LIFETIME_WEAK);
 }
@@ -298,8 +317,7 @@ std::optional<int32_t> BpBinder::getDebugBinderHandle() const {
 }
 
 bool BpBinder::isDescriptorCached() const {
-    RpcMutexUniqueLock _l(mLock);
-    return mDescriptorCache.c_str() != kDescriptorUninit.c_str();
+    return mDescriptorCached.load(std::memory_order_acquire);
 }
 
 const String16& BpBinder::getInterfaceDescriptor() const
@@ -313,11 +331,14 @@ const String16& BpBinder::getInterfaceDescriptor() const
         // do the IPC without a lock held.
         status_t err = thiz->transact(INTERFACE_TRANSACTION, data, &reply);
         if (err == NO_ERROR) {
-            String16 res(reply.readString16());
+            String16 res(findInternedDescriptor(reply.readString16()));
             RpcMutexUniqueLock _l(mLock);
             // mDescriptorCache could have been assigned while the lock was
             // released.
-            if (mDescriptorCache.c_str() == kDescriptorUninit.c_str()) mDescriptorCache = res;
+            if (!mDescriptorCached.load(std::memory_order_relaxed)) {
+                mDescriptorCache = res;
+                mDescriptorCached.store(true, std::memory_order_release);
+            }
         }
     }
 
@@ -381,7 +402,9 @@ status_t BpBinder::transact(
         if (code >= FIRST_CALL_TRANSACTION && code <= LAST_CALL_TRANSACTION) {
             using android::internal::Stability;
 
-            int16_t stability = Stability::getRepr(this);
+            // Read directly rather than through Stability::getRepr, which needs two virtual
+            // calls to find out that this is a BpBinder.
+            int16_t stability = mStability;
             Stability::Level required = privateVendor ? Stability::VENDOR
                 : Stability::getLocalLevel();
 
@@ -394,6 +417,13 @@ status_t BpBinder::transact(
             }
         }
 
+        // latency stats are only readable over kernel binder
+        const bool recordLatency = kEnableKernelIpc && TransactionLatencyStats::isEnabled();
+        std::chrono::steady_clock::time_point start;
+        if (recordLatency) [[unlikely]] {
+            start = std::chrono::steady_clock::now();
+        }
+
         status_t status;
         if (isRpcBinder()) [[unlikely]] {
             status = rpcSession()->transact(sp<IBinder>::fromExisting(this), code, data, reply,
@@ -412,6 +442,15 @@ status_t BpBinder::transact(
                   data.dataSize(), String8(mDescriptorCache).c_str(), code);
         }
 
+        if (recordLatency) [[unlikely]] {
+            String16 descriptor;
+            {
+                RpcMutexUniqueLock _l(mLock);
+                descriptor = mDescriptorCache;
+            }
+            TransactionLatencyStats::recordClient(descriptor, data, code, start);
+        }
+
         if (status == DEAD_OBJECT) mAlive = 0;
 
         return status;
@@ -858,6 +897,25 @@ uint32_t BpBinder::getBinderProxyCount()
     return sBinderProxyCount.load();
 }
 
+String16 BpBinder::internDescriptor(const String16& descriptor) {
+    InternedDescriptors& interned = internedDescriptors();
+    RpcMutexUniqueLock _l(interned.lock);
+    if (auto it = interned.descriptors.find(descriptor); it != interned.descriptors.end()) {
+        return *it;
+    }
+    const size_t bytes = descriptor.size() * sizeof(char16_t);
+    if (interned.bytes + bytes > kMaxInternedDescriptorBytes) return descriptor;
+    interned.bytes += bytes;
+    return *interned.descriptors.insert(descriptor).first;
+}
+
+String16 BpBinder::findInternedDescriptor(const String16& descriptor) {
+    InternedDescriptors& interned = internedDescriptors();
+    RpcMutexUniqueLock _l(interned.lock);
+    auto it = interned.descriptors.find(descriptor);
+    return it == interned.descriptors.end() ? descriptor : *it;
+}
+
 void BpBinder::getCountByUid(Vector<uint32_t>& uids, Vector<uint32_t>& counts)
 {
     RpcMutexUniqueLock _l(sTrackingLock);
@@ -59,6 +59,11 @@ bool FdTrigger::isTriggered() {
 }
 
 status_t FdTrigger::triggerablePoll(const android::RpcTransportFd& transportFd, int16_t event) {
+    return triggerablePoll(transportFd, event, binder::borrowed_fd(-1));
+}
+
+status_t FdTrigger::triggerablePoll(const android::RpcTransportFd& transportFd, int16_t event,
+                                    binder::borrowed_fd hangupFd) {
 #ifdef BINDER_RPC_SINGLE_THREADED
     if (mTriggered) {
         return DEAD_OBJECT;
@@ -69,6 +74,8 @@ status_t FdTrigger::triggerablePoll(const android::RpcTransportFd& transportFd,
                         transportFd.fd.get());
     pollfd pfd[]{
             {.fd = transportFd.fd.get(), .events = static_cast<int16_t>(event), .revents = 0},
+            // poll() ignores negative FDs, so this is a no-op without a hangup FD
+            {.fd = hangupFd.get(), .events = 0, .revents = 0},
 #ifndef BINDER_RPC_SINGLE_THREADED
             {.fd = mRead.get(), .events = 0, .revents = 0},
 #endif
@@ -92,18 +99,18 @@ status_t FdTrigger::triggerablePoll(const android::RpcTransportFd& transportFd,
 
 #ifndef BINDER_RPC_SINGLE_THREADED
     // Detect explicit trigger(): DEAD_OBJECT
-    if (pfd[1].revents & POLLHUP) {
+    if (pfd[2].revents & POLLHUP) {
         return DEAD_OBJECT;
     }
     // See unknown flags in trigger FD's revents (POLLERR / POLLNVAL).
     // Treat this error condition as UNKNOWN_ERROR.
-    if (pfd[1].revents != 0) {
-        ALOGE("Unknown revents on trigger FD %d: revents = %d", pfd[1].fd, pfd[1].revents);
+    if (pfd[2].revents != 0) {
+        ALOGE("Unknown revents on trigger FD %d: revents = %d", pfd[2].fd, pfd[2].revents);
         return UNKNOWN_ERROR;
     }
 
-    // pfd[1].revents is 0, hence pfd[0].revents must be set, and only possible values are
-    // a subset of event | POLLHUP | POLLERR | POLLNVAL.
+    // pfd[2].revents is 0, hence pfd[0].revents or pfd[1].revents must be set, and only
+    // possible values are a subset of event | POLLHUP | POLLERR | POLLNVAL.
 #endif
 
     // POLLNVAL: invalid FD number, e.g. not opened.
@@ -126,7 +133,7 @@ status_t FdTrigger::triggerablePoll(const android::RpcTransportFd& transportFd,
         return OK;
     }
 
-    // POLLHUP: Peer closed connection. Treat as DEAD_OBJECT.
+    // POLLHUP: Peer closed connection (either |fd| or |hangupFd|). Treat as DEAD_OBJECT.
     // This is a very common case, so don't log.
     return DEAD_OBJECT;
 }
@@ -57,6 +57,14 @@ public:
     [[nodiscard]] status_t triggerablePoll(const android::RpcTransportFd& transportFd,
                                            int16_t event);
 
+    /**
+     * Same as above, but also returns DEAD_OBJECT if |hangupFd| reports
+     * POLLHUP or POLLERR before |event| is seen on |transportFd|. Used by
+     * transports whose data path is not the connection socket itself.
+     */
+    [[nodiscard]] status_t triggerablePoll(const android::RpcTransportFd& transportFd,
+                                           int16_t event, binder::borrowed_fd hangupFd);
+
 private:
 #ifdef BINDER_RPC_SINGLE_THREADED
     bool mTriggered = false;
@@ -21,6 +21,7 @@
 #include <binder/Binder.h>
 #include <binder/BpBinder.h>
 #include <binder/TextOutput.h>
+#include <binder/TransactionLatencyStats.h>
 
 #include <utils/CallStack.h>
 
@@ -687,7 +688,16 @@ status_t IPCThreadState::getAndExecuteCommand()
             ALOGI("%s", message.c_str());
         }
 
+        if (mIsLooper && mProcess->canIdleThreadsExit()) {
+            mCommandReadTime = std::chrono::steady_clock::now();
+        }
+
         size_t newThreadsCount = mProcess->mExecutingThreadsCount.fetch_add(1) + 1;
+        size_t peak = mProcess->mPeakExecutingThreadsCount.load(std::memory_order_relaxed);
+        while (newThreadsCount > peak &&
+               !mProcess->mPeakExecutingThreadsCount.compare_exchange_weak(peak,
+                                                                           newThreadsCount)) {
+        }
         if (newThreadsCount >= mProcess->mMaxThreads) {
             auto expected = ProcessState::never();
             mProcess->mStarvationStartTime
@@ -780,6 +790,8 @@ void IPCThreadState::joinThreadPool(bool isMain)
 
     mIsLooper = true;
     status_t result;
+    bool exitedIdle = false;
+    auto idleSince = std::chrono::steady_clock::now();
     do {
         processPendingDerefs();
         // now get the next command to be processed, waiting if necessary
@@ -795,6 +807,19 @@ void IPCThreadState::joinThreadPool(bool isMain)
         if(result == TIMED_OUT && !isMain) {
             break;
         }
+
+        // Also leave if this thread waited long enough for the command, and the
+        // pool has enough idle threads without it. Only do so once every command
+        // read from the driver has been executed.
+        if (result == NO_ERROR && !isMain && mIn.dataPosition() >= mIn.dataSize() &&
+            mProcess->canIdleThreadsExit()) {
+            if (mProcess->shouldIdleThreadExit(mCommandReadTime - idleSince)) {
+                processPendingDerefs();
+                exitedIdle = true;
+                break;
+            }
+            idleSince = std::chrono::steady_clock::now();
+        }
     } while (result != -ECONNREFUSED && result != -EBADF);
 
     LOG_THREADPOOL("**** THREAD %p (PID %d) IS LEAVING THE THREAD POOL err=%d\n",
@@ -803,6 +828,11 @@ void IPCThreadState::joinThreadPool(bool isMain)
     mOut.writeInt32(BC_EXIT_LOOPER);
     mIsLooper = false;
     talkWithDriver(false);
+    if (exitedIdle) {
+        // shouldIdleThreadExit already removed this thread from mCurrentThreads.
+        mProcess->onIdleThreadExited();
+        return;
+    }
     size_t oldCount = mProcess->mCurrentThreads.fetch_sub(1);
     LOG_ALWAYS_FATAL_IF(oldCount == 0,
                         "Threadpool thread count underflowed. Thread cannot exist and exit in "
@@ -866,6 +896,15 @@ status_t IPCThreadState::transact(int32_t handle,
 
     LOG_ONEWAY(">>>> SEND from pid %d uid %d %s", getpid(), getuid(),
         (flags & TF_ONE_WAY) == 0 ? "READ REPLY" : "ONE WAY");
+
+    if (mOnewayBatchDepth > 0) [[unlikely]] {
+        if (flags & TF_ONE_WAY) {
+            return queueOnewayTransaction(handle, code, data, flags);
+        }
+        // Otherwise the completions of the batch would be mixed up with our reply.
+        submitOnewayBatch();
+    }
+
     err = writeTransactionData(BC_TRANSACTION, flags, handle, code, data, nullptr);
 
     if (err != NO_ERROR) {
@@ -923,6 +962,72 @@ status_t IPCThreadState::transact(int32_t handle,
     return err;
 }
 
+void IPCThreadState::beginOnewayBatch() {
+    mOnewayBatchDepth++;
+}
+
+status_t IPCThreadState::flushOnewayBatch() {
+    LOG_ALWAYS_FATAL_IF(mOnewayBatchDepth == 0, "flushOnewayBatch() without beginOnewayBatch()");
+    if (--mOnewayBatchDepth > 0) return NO_ERROR;
+
+    submitOnewayBatch();
+    status_t result = mOnewayBatchStatus;
+    mOnewayBatchStatus = NO_ERROR;
+    return result;
+}
+
+status_t IPCThreadState::queueOnewayTransaction(int32_t handle, uint32_t code, const Parcel& data,
+                                                uint32_t flags) {
+    // Cap the number of parcel copies held here, the batch is flushed and restarted.
+    constexpr size_t kMaxOnewayBatchSize = 64;
+
+    if (status_t err = data.errorCheck(); err != NO_ERROR) return (mLastError = err);
+
+    // writeTransactionData only records a pointer to the parcel data, which is
+    // read by the driver when the batch is submitted.
+    auto copy = std::make_unique<Parcel>();
+    if (status_t err = copy->appendFrom(&data, 0, data.dataSize()); err != NO_ERROR) {
+        return (mLastError = err);
+    }
+    if (status_t err = writeTransactionData(BC_TRANSACTION, flags, handle, code, *copy, nullptr);
+        err != NO_ERROR) {
+        return (mLastError = err);
+    }
+    mOnewayBatch.push_back(std::move(copy));
+
+    if (mOnewayBatch.size() >= kMaxOnewayBatchSize) submitOnewayBatch();
+    return NO_ERROR;
+}
+
+void IPCThreadState::submitOnewayBatch() {
+    // The driver answers every oneway BC_TRANSACTION with exactly one
+    // BR_TRANSACTION_COMPLETE (or an error). The first waitForResponse writes
+    // the whole batch and the others are normally served from mIn.
+    for (size_t i = 0; i < mOnewayBatch.size(); i++) {
+        status_t err = waitForResponse(nullptr, nullptr);
+        if (err != NO_ERROR && mOnewayBatchStatus == NO_ERROR) mOnewayBatchStatus = err;
+    }
+    mOnewayBatch.clear();
+}
+
+std::unique_ptr<Parcel> IPCThreadState::acquireReplyParcel() {
+    if (mReplyParcelPool.empty()) return std::make_unique<Parcel>();
+    std::unique_ptr<Parcel> parcel = std::move(mReplyParcelPool.back());
+    mReplyParcelPool.pop_back();
+    return parcel;
+}
+
+void IPCThreadState::releaseReplyParcel(std::unique_ptr<Parcel> parcel) {
+    // Nested incoming transactions each need their own reply, so keep a few.
+    constexpr size_t kMaxPooledReplies = 4;
+    // Larger replies are rare enough that holding on to their buffers isn't worth it.
+    constexpr size_t kMaxRetainedReplyCapacity = 16 * 1024;
+
+    if (mReplyParcelPool.size() >= kMaxPooledReplies) return;
+    parcel->recycle(kMaxRetainedReplyCapacity);
+    mReplyParcelPool.push_back(std::move(parcel));
+}
+
 void IPCThreadState::incStrongHandle(int32_t handle, BpBinder *proxy)
 {
     LOG_REMOTEREFS("IPCThreadState::incStrongHandle(%d)\n", handle);
@@ -1030,7 +1135,9 @@ IPCThreadState::IPCThreadState()
         mIsFlushing(false),
         mStrictModePolicy(0),
         mLastTransactionBinderFlags(0),
-        mCallRestriction(mProcess->mCallRestriction) {
+        mCallRestriction(mProcess->mCallRestriction),
+        mOnewayBatchDepth(0),
+        mOnewayBatchStatus(NO_ERROR) {
     pthread_setspecific(gTLS, this);
     clearCaller();
     mHasExplicitIdentity = false;
@@ -1046,6 +1153,7 @@ status_t IPCThreadState::sendReply(const Parcel& reply, uint32_t flags)
 {
     status_t err;
     status_t statusBuffer;
+    if (!mOnewayBatch.empty()) submitOnewayBatch();
     err = writeTransactionData(BC_REPLY, flags, -1, 0, reply, &statusBuffer);
     if (err < NO_ERROR) return err;
 
@@ -1449,7 +1557,8 @@ status_t IPCThreadState::executeCommand(int32_t cmd)
             // ALOGI(">>>> TRANSACT from pid %d sid %s uid %d\n", mCallingPid,
             //    (mCallingSid ? mCallingSid : "<N/A>"), mCallingUid);
 
-            Parcel reply;
+            std::unique_ptr<Parcel> replyHolder = acquireReplyParcel();
+            Parcel& reply = *replyHolder;
             status_t error;
             IF_LOG_TRANSACTIONS() {
                 std::ostringstream logStream;
@@ -1467,9 +1576,16 @@ status_t IPCThreadState::executeCommand(int32_t cmd)
                 // safely acquire a strong reference before doing anything else with it.
                 if (reinterpret_cast<RefBase::weakref_type*>(
                         tr.target.ptr)->attemptIncStrong(this)) {
-                    error = reinterpret_cast<BBinder*>(tr.cookie)->transact(tr.code, buffer,
-                            &reply, tr.flags);
-                    reinterpret_cast<BBinder*>(tr.cookie)->decStrong(this);
+                    BBinder* target = reinterpret_cast<BBinder*>(tr.cookie);
+                    if (TransactionLatencyStats::isEnabled()) [[unlikely]] {
+                        auto start = std::chrono::steady_clock::now();
+                        error = target->transact(tr.code, buffer, &reply, tr.flags);
+                        TransactionLatencyStats::recordServer(target->getInterfaceDescriptor(),
+                                                              tr.code, start);
+                    } else {
+                        error = target->transact(tr.code, buffer, &reply, tr.flags);
+                    }
+                    target->decStrong(this);
                 } else {
                     error = UNKNOWN_TRANSACTION;
                 }
@@ -1533,6 +1649,8 @@ status_t IPCThreadState::executeCommand(int32_t cmd)
                 ALOGI("%s", message.c_str());
             }
 
+            releaseReplyParcel(std::move(replyHolder));
+
         }
         break;
 
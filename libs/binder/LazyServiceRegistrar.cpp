@@ -16,17 +16,54 @@
 
 #define LOG_TAG "AidlLazyServiceRegistrar"
 
+#include <android-base/file.h>
+#include <android-base/parseint.h>
+#include <android-base/strings.h>
 #include <android/os/BnClientCallback.h>
 #include <android/os/IServiceManager.h>
 #include <binder/IPCThreadState.h>
 #include <binder/IServiceManager.h>
 #include <binder/LazyServiceRegistrar.h>
 
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <thread>
+
 namespace android {
 namespace binder {
 namespace internal {
 
 using AidlServiceManager = android::os::IServiceManager;
+using std::chrono::milliseconds;
+using std::chrono::steady_clock;
+
+// Time since this process started, or zero if it cannot be read from /proc.
+static milliseconds timeSinceProcessStart() {
+    std::string stat;
+    if (!android::base::ReadFileToString("/proc/self/stat", &stat)) return {};
+
+    // The command name may contain spaces, so split the fields after it. They start with the
+    // state, which is field 3, and the start time is field 22.
+    size_t commandEnd = stat.rfind(") ");
+    if (commandEnd == std::string::npos) return {};
+    std::vector<std::string> fields = android::base::Split(stat.substr(commandEnd + 2), " ");
+    constexpr size_t kStartTimeIndex = 22 - 3;
+    uint64_t startTicks;
+    if (fields.size() <= kStartTimeIndex ||
+        !android::base::ParseUint(fields[kStartTimeIndex], &startTicks)) {
+        return {};
+    }
+
+    // The start time is in clock ticks since boot.
+    timespec now;
+    if (clock_gettime(CLOCK_BOOTTIME, &now) != 0) return {};
+    milliseconds uptime = std::chrono::duration_cast<milliseconds>(
+            std::chrono::seconds(now.tv_sec) + std::chrono::nanoseconds(now.tv_nsec));
+    return uptime - milliseconds(startTicks * 1000 / sysconf(_SC_CLK_TCK));
+}
 
 class ClientCounterCallbackImpl : public ::android::os::BnClientCallback {
 public:
@@ -42,6 +79,12 @@ public:
 
     void reRegisterLocked();
 
+    void setShutdownDelay(milliseconds delay, milliseconds maxDelay);
+
+    bool shutdownIfIdle();
+
+    LazyServiceRegistrar::Stats getStats();
+
 protected:
     Status onClients(const sp<IBinder>& service, bool clients) override;
 
@@ -79,9 +122,23 @@ private:
      */
     void maybeTryShutdownLocked();
 
+    /**
+     * Shuts down now, or after the shutdown delay unless a client comes back before then.
+     */
+    void scheduleShutdownLocked();
+
+    /**
+     * The shutdown delay, stretched towards twice the average idle time if clients have been
+     * coming back.
+     */
+    milliseconds shutdownDelayLocked() const;
+
     // for below
     std::mutex mMutex;
 
+    // notified when clients come back, to cancel a delayed shutdown
+    std::condition_variable mClientsBack;
+
     // count of services with clients
     size_t mNumConnectedServices;
 
@@ -95,6 +152,22 @@ private:
 
     // Callback used to report if there are services with clients
     std::function<bool(bool)> mActiveServicesCallback;
+
+    milliseconds mShutdownDelay{0};
+    milliseconds mMaxShutdownDelay{0};
+
+    // when the services last ran out of clients, if they have none now
+    std::optional<steady_clock::time_point> mIdleSince;
+
+    // incremented when clients come back, which cancels a delayed shutdown
+    uint64_t mIdleGeneration = 0;
+
+    bool mShutdownPending = false;
+
+    // number of idle periods that mStats.averageIdleTime is computed from
+    size_t mIdleTimeSamples = 0;
+
+    LazyServiceRegistrar::Stats mStats;
 };
 
 class ClientCounterCallback {
@@ -115,6 +188,12 @@ public:
 
     void reRegister();
 
+    void setShutdownDelay(milliseconds delay, milliseconds maxDelay);
+
+    bool shutdownIfIdle();
+
+    LazyServiceRegistrar::Stats getStats();
+
 private:
     sp<ClientCounterCallbackImpl> mImpl;
 };
@@ -151,6 +230,10 @@ bool ClientCounterCallbackImpl::registerServiceLocked(const sp<IBinder>& service
             return false;
         }
 
+        if (mRegisteredServices.empty()) {
+            mStats.startupTime = timeSinceProcessStart();
+        }
+
         // Only add this when a service is added for the first time, as it is not removed
         mRegisteredServices[name] = {
               .service = service,
@@ -234,8 +317,70 @@ void ClientCounterCallbackImpl::maybeTryShutdownLocked() {
     // client count change event, try to shutdown the process if its services
     // have no clients.
     if (!handledInCallback && mNumConnectedServices == 0) {
+        scheduleShutdownLocked();
+    }
+}
+
+void ClientCounterCallbackImpl::scheduleShutdownLocked() {
+    milliseconds delay = shutdownDelayLocked();
+    if (delay == milliseconds::zero()) {
         tryShutdownLocked();
+        return;
+    }
+
+    if (mShutdownPending) return;
+    mShutdownPending = true;
+    if (delay == milliseconds::max()) {
+        ALOGI("No clients in use for any service in process. Waiting for shutdownIfIdle.");
+        return;
+    }
+
+    ALOGI("No clients in use for any service in process. Shutting down in %lld ms.",
+          static_cast<long long>(delay.count()));
+    std::thread([self = sp<ClientCounterCallbackImpl>::fromExisting(this),
+                 generation = mIdleGeneration, deadline = steady_clock::now() + delay] {
+        std::unique_lock<std::mutex> lock(self->mMutex);
+        if (self->mClientsBack.wait_until(lock, deadline, [&] {
+                return self->mIdleGeneration != generation;
+            })) {
+            return;
+        }
+
+        self->mShutdownPending = false;
+        if (!self->mForcePersist && self->mNumConnectedServices == 0) {
+            self->tryShutdownLocked();
+        }
+    }).detach();
+}
+
+milliseconds ClientCounterCallbackImpl::shutdownDelayLocked() const {
+    if (mShutdownDelay == milliseconds::max() || mIdleTimeSamples == 0) {
+        return mShutdownDelay;
     }
+    return std::clamp(2 * mStats.averageIdleTime, mShutdownDelay,
+                      std::max(mShutdownDelay, mMaxShutdownDelay));
+}
+
+void ClientCounterCallbackImpl::setShutdownDelay(milliseconds delay, milliseconds maxDelay) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mShutdownDelay = std::max(delay, milliseconds::zero());
+    mMaxShutdownDelay = maxDelay;
+}
+
+bool ClientCounterCallbackImpl::shutdownIfIdle() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (mForcePersist || mNumConnectedServices != 0) {
+        return false;
+    }
+
+    // Only returns if some service could not be unregistered.
+    tryShutdownLocked();
+    return false;
+}
+
+LazyServiceRegistrar::Stats ClientCounterCallbackImpl::getStats() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mStats;
 }
 
 Status ClientCounterCallbackImpl::onClients(const sp<IBinder>& service, bool clients) {
@@ -247,6 +392,8 @@ Status ClientCounterCallbackImpl::onClients(const sp<IBinder>& service, bool cli
     }
     registered.clients = clients;
 
+    size_t previousNumConnectedServices = mNumConnectedServices;
+
     // update cache count of clients
     {
          size_t numWithClients = 0;
@@ -260,6 +407,26 @@ Status ClientCounterCallbackImpl::onClients(const sp<IBinder>& service, bool cli
     ALOGI("Process has %zu (of %zu available) client(s) in use after notification %s has clients: %d",
           mNumConnectedServices, mRegisteredServices.size(), name.c_str(), clients);
 
+    if (previousNumConnectedServices != 0 && mNumConnectedServices == 0) {
+        mIdleSince = steady_clock::now();
+        mStats.idlePeriods++;
+    } else if (previousNumConnectedServices == 0 && mNumConnectedServices != 0 && mIdleSince) {
+        milliseconds idleTime =
+                std::chrono::duration_cast<milliseconds>(steady_clock::now() - *mIdleSince);
+        mIdleSince.reset();
+        // Weigh recent idle periods the most, as they say the most about the next one.
+        mStats.averageIdleTime = mIdleTimeSamples++ == 0
+                ? idleTime
+                : (3 * mStats.averageIdleTime + idleTime) / 4;
+
+        if (mShutdownPending) {
+            mShutdownPending = false;
+            mStats.reconnectsDuringDelay++;
+        }
+        mIdleGeneration++;
+        mClientsBack.notify_all();
+    }
+
     maybeTryShutdownLocked();
     return Status::ok();
 }
@@ -311,6 +478,18 @@ void ClientCounterCallback::reRegister() {
     mImpl->reRegisterLocked();
 }
 
+void ClientCounterCallback::setShutdownDelay(milliseconds delay, milliseconds maxDelay) {
+    mImpl->setShutdownDelay(delay, maxDelay);
+}
+
+bool ClientCounterCallback::shutdownIfIdle() {
+    return mImpl->shutdownIfIdle();
+}
+
+LazyServiceRegistrar::Stats ClientCounterCallback::getStats() {
+    return mImpl->getStats();
+}
+
 }  // namespace internal
 
 LazyServiceRegistrar::LazyServiceRegistrar() {
@@ -351,5 +530,18 @@ void LazyServiceRegistrar::reRegister() {
     mClientCC->reRegister();
 }
 
+void LazyServiceRegistrar::setShutdownDelay(std::chrono::milliseconds delay,
+                                            std::chrono::milliseconds maxDelay) {
+    mClientCC->setShutdownDelay(delay, maxDelay);
+}
+
+bool LazyServiceRegistrar::shutdownIfIdle() {
+    return mClientCC->shutdownIfIdle();
+}
+
+LazyServiceRegistrar::Stats LazyServiceRegistrar::getStats() {
+    return mClientCC->getStats();
+}
+
 }  // namespace hardware
 }  // namespace android
@@ -486,6 +486,12 @@ status_t Parcel::setDataCapacity(size_t size)
     return NO_ERROR;
 }
 
+status_t Parcel::reserve(size_t len) {
+    size_t desired;
+    if (__builtin_add_overflow(mDataPos, len, &desired)) return NO_MEMORY;
+    return setDataCapacity(desired);
+}
+
 status_t Parcel::setData(const uint8_t* buffer, size_t len)
 {
     if (len > INT32_MAX) {
@@ -2926,6 +2932,26 @@ void Parcel::freeData()
     initState();
 }
 
+void Parcel::recycle(size_t maxRetainedCapacity) {
+    auto* kernelFields = maybeKernelFields();
+    if (mOwner || mDeallocZero || kernelFields == nullptr ||
+        mDataCapacity > maxRetainedCapacity) {
+        freeData();
+        return;
+    }
+
+    LOG_ALLOC("Parcel %p: recycling %zu capacity", this, mDataCapacity);
+    releaseObjects();
+    free(kernelFields->mObjects);
+
+    uint8_t* data = mData;
+    size_t capacity = mDataCapacity;
+    initState();
+    // Still accounted for in gParcelGlobalAllocSize/Count.
+    mData = data;
+    mDataCapacity = capacity;
+}
+
 void Parcel::freeDataNoInit()
 {
     if (mOwner) {
@@ -16,7 +16,10 @@
 
 #define LOG_TAG "PermissionCache"
 
+#include <sched.h>
 #include <stdint.h>
+#include <functional>
+#include <string_view>
 #include <utils/Log.h>
 #include <binder/IPCThreadState.h>
 #include <binder/IServiceManager.h>
@@ -31,47 +34,186 @@ ANDROID_SINGLETON_STATIC_INSTANCE(PermissionCache)
 
 // ----------------------------------------------------------------------------
 
-PermissionCache::PermissionCache() {
+namespace {
+
+class PermissionControllerDeathRecipient : public IBinder::DeathRecipient {
+public:
+    explicit PermissionControllerDeathRecipient(std::function<void()> onDied)
+          : mOnDied(std::move(onDied)) {}
+
+    void binderDied(const wp<IBinder>&) override { mOnDied(); }
+
+private:
+    const std::function<void()> mOnDied;
+};
+
+size_t hashPermission(const String16& permission) {
+    return std::hash<std::u16string_view>{}(
+            std::u16string_view(permission.c_str(), permission.size()));
+}
+
+} // namespace
+
+PermissionCache::PermissionCache()
+      : mPermissionControllerDeathRecipient(sp<PermissionControllerDeathRecipient>::make(
+                [this] { onPermissionControllerDied(); })) {}
+
+ssize_t PermissionCache::findPermissionName(const String16& permission, size_t hash) const {
+    const size_t count = mPermissionNameCount.load(std::memory_order_acquire);
+    for (size_t i = 0; i < count; i++) {
+        if (mPermissionNames[i].hash == hash && mPermissionNames[i].name == permission) {
+            return static_cast<ssize_t>(i);
+        }
+    }
+    return -1;
+}
+
+uint64_t PermissionCache::slotKey(size_t nameIndex, uid_t uid) {
+    return kSlotValid | (static_cast<uint64_t>(nameIndex) << 2) |
+            (static_cast<uint64_t>(uid) << 32);
+}
+
+size_t PermissionCache::firstSlot(uint64_t key) {
+    // Mix the uid into the low bits, so that the entries of one permission are spread out.
+    return static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> 32) % kSlotsPerShard;
 }
 
 status_t PermissionCache::check(bool* granted,
         const String16& permission, uid_t uid) const {
-    Mutex::Autolock _l(mLock);
-    Entry e;
-    e.name = permission;
-    e.uid  = uid;
-    ssize_t index = mCache.indexOf(e);
-    if (index >= 0) {
-        *granted = mCache.itemAt(index).granted;
-        return NO_ERROR;
+    const Shard& shard = shardFor(uid);
+    // Register as a reader before looking at the names, and check that they weren't being reset
+    // before registering. Then a reset either sees this check, or this check sees the reset.
+    const uint32_t generation = mPermissionNameGeneration.load();
+    if (generation % 2 != 0) {
+        shard.misses.fetch_add(1, std::memory_order_relaxed);
+        return NAME_NOT_FOUND;
+    }
+    shard.readers.fetch_add(1);
+    const ssize_t nameIndex = mPermissionNameGeneration.load() == generation
+            ? findPermissionName(permission, hashPermission(permission))
+            : -1;
+    if (nameIndex >= 0) {
+        const uint64_t key = slotKey(static_cast<size_t>(nameIndex), uid);
+        const size_t first = firstSlot(key);
+        for (size_t i = 0; i < kSlotsPerShard; i++) {
+            const uint64_t slot =
+                    shard.slots[(first + i) % kSlotsPerShard].load(std::memory_order_acquire);
+            if (slot == 0) break;
+            if ((slot & ~kSlotGranted) == key) {
+                shard.readers.fetch_sub(1, std::memory_order_release);
+                shard.hits.fetch_add(1, std::memory_order_relaxed);
+                *granted = (slot & kSlotGranted) != 0;
+                return NO_ERROR;
+            }
+        }
     }
+    shard.readers.fetch_sub(1, std::memory_order_release);
+    shard.misses.fetch_add(1, std::memory_order_relaxed);
     return NAME_NOT_FOUND;
 }
 
+void PermissionCache::insertLocked(Shard& shard, uint64_t slot) {
+    const uint64_t key = slot & ~kSlotGranted;
+    const size_t first = firstSlot(key);
+    for (size_t i = 0; i < kSlotsPerShard; i++) {
+        std::atomic<uint64_t>& entry = shard.slots[(first + i) % kSlotsPerShard];
+        const uint64_t current = entry.load(std::memory_order_relaxed);
+        if ((current & ~kSlotGranted) == key) return;
+        if (current == 0) {
+            entry.store(slot, std::memory_order_release);
+            return;
+        }
+    }
+    // The probe sequence is full. Replace the entry in the first slot, which keeps the slot in
+    // use, so the probe sequences of the other entries through it still work.
+    shard.slots[first].store(slot, std::memory_order_release);
+}
+
+void PermissionCache::resetPermissionNamesLocked() {
+    const uint32_t generation = mPermissionNameGeneration.load(std::memory_order_relaxed);
+    mPermissionNameGeneration.store(generation + 1);
+    purgeLocked();
+    // Wait for the checks which started before the names were being reset. Checks are short and
+    // don't block, and the table only fills up with many distinct permissions, so this is rare.
+    for (const Shard& shard : mShards) {
+        while (shard.readers.load() != 0) {
+            sched_yield();
+        }
+    }
+    for (PermissionName& name : mPermissionNames) {
+        name = {};
+    }
+    mPermissionNameCount.store(0, std::memory_order_relaxed);
+    mPermissionNameGeneration.store(generation + 2);
+}
+
 void PermissionCache::cache(const String16& permission,
         uid_t uid, bool granted) {
     Mutex::Autolock _l(mLock);
-    Entry e;
-    ssize_t index = mPermissionNamesPool.indexOf(permission);
-    if (index > 0) {
-        e.name = mPermissionNamesPool.itemAt(index);
-    } else {
-        mPermissionNamesPool.add(permission);
-        e.name = permission;
+    const size_t hash = hashPermission(permission);
+    ssize_t nameIndex = findPermissionName(permission, hash);
+    if (nameIndex < 0) {
+        size_t count = mPermissionNameCount.load(std::memory_order_relaxed);
+        if (count == kMaxPermissionNames) {
+            ALOGI("too many permission names, resetting the permission cache");
+            resetPermissionNamesLocked();
+            count = 0;
+        }
+        mPermissionNames[count] = {.hash = hash, .name = permission};
+        mPermissionNameCount.store(count + 1, std::memory_order_release);
+        nameIndex = static_cast<ssize_t>(count);
     }
     // note, we don't need to store the pid, which is not actually used in
     // permission checks
-    e.uid  = uid;
-    e.granted = granted;
-    index = mCache.indexOf(e);
-    if (index < 0) {
-        mCache.add(e);
-    }
+    insertLocked(shardFor(uid),
+                 slotKey(static_cast<size_t>(nameIndex), uid) | (granted ? kSlotGranted : 0));
 }
 
 void PermissionCache::purge() {
     Mutex::Autolock _l(mLock);
-    mCache.clear();
+    purgeLocked();
+}
+
+void PermissionCache::purgeLocked() {
+    for (Shard& shard : mShards) {
+        for (auto& slot : shard.slots) {
+            slot.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+void PermissionCache::watchPermissionController() {
+    if (mWatchingPermissionController.load(std::memory_order_acquire)) {
+        return;
+    }
+    // Misses are frequent until the permission controller is up, so don't look it up each time.
+    const nsecs_t now = systemTime();
+    nsecs_t nextAttempt = mNextWatchAttempt.load(std::memory_order_relaxed);
+    if (now < nextAttempt ||
+        !mNextWatchAttempt.compare_exchange_strong(nextAttempt, now + kWatchRetryInterval,
+                                                   std::memory_order_relaxed)) {
+        return;
+    }
+    sp<IBinder> binder = defaultServiceManager()->checkService(String16("permission"));
+    if (binder == nullptr) {
+        return;
+    }
+    Mutex::Autolock _l(mLock);
+    if (mWatchingPermissionController.load(std::memory_order_relaxed)) {
+        return;
+    }
+    // A local permission controller can't die without this process, so it is as good as watched.
+    if (binder->localBinder() == nullptr &&
+        binder->linkToDeath(mPermissionControllerDeathRecipient) != NO_ERROR) {
+        return;
+    }
+    mWatchingPermissionController.store(true, std::memory_order_release);
+}
+
+void PermissionCache::onPermissionControllerDied() {
+    ALOGI("permission controller died, purging the permission cache");
+    mWatchingPermissionController.store(false, std::memory_order_release);
+    purge();
 }
 
 bool PermissionCache::checkCallingPermission(const String16& permission) {
@@ -104,6 +246,7 @@ bool PermissionCache::checkPermission(
         ALOGD("checking %s for uid=%d => %s (%d us)", String8(permission).c_str(), uid,
               granted ? "granted" : "denied", (int)ns2us(t));
         pc.cache(permission, uid, granted);
+        pc.watchPermissionController();
     }
     return granted;
 }
@@ -113,5 +256,42 @@ void PermissionCache::purgeCache() {
     pc.purge();
 }
 
+void PermissionCache::purgeUid(uid_t uid) {
+    PermissionCache& pc(PermissionCache::getInstance());
+    Mutex::Autolock _l(pc.mLock);
+    pc.purgeUidLocked(uid);
+}
+
+void PermissionCache::purgeUidLocked(uid_t uid) {
+    // Clearing single slots would cut the probe sequences of other entries, so rebuild the shard
+    // without the uid's entries. Checks racing with this may miss and check again.
+    Shard& shard = shardFor(uid);
+    uint64_t kept[kSlotsPerShard];
+    size_t keptCount = 0;
+    for (auto& slot : shard.slots) {
+        const uint64_t value = slot.load(std::memory_order_relaxed);
+        if (value != 0 && (value >> 32) != uid) {
+            kept[keptCount++] = value;
+        }
+        slot.store(0, std::memory_order_relaxed);
+    }
+    for (size_t i = 0; i < keptCount; i++) {
+        insertLocked(shard, kept[i]);
+    }
+}
+
+PermissionCache::Stats PermissionCache::getStats() {
+    PermissionCache& pc(PermissionCache::getInstance());
+    Stats stats{};
+    for (const Shard& shard : pc.mShards) {
+        stats.hits += shard.hits.load(std::memory_order_relaxed);
+        stats.misses += shard.misses.load(std::memory_order_relaxed);
+        for (const auto& slot : shard.slots) {
+            if (slot.load(std::memory_order_relaxed) != 0) stats.entries++;
+        }
+    }
+    return stats;
+}
+
 // ---------------------------------------------------------------------------
 } // namespace android
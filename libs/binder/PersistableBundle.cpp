@@ -19,6 +19,8 @@
 #include <binder/PersistableBundle.h>
 
 #include <limits>
+#include <mutex>
+#include <string_view>
 
 #include <binder/IBinder.h>
 #include <binder/Parcel.h>
@@ -59,14 +61,159 @@ bool getValue(const android::String16& key, T* out, const map<android::String16,
 }
 
 template <typename T>
-set<android::String16> getKeys(const map<android::String16, T>& map) {
-    if (map.empty()) return set<android::String16>();
-    set<android::String16> keys;
+set<android::String16> getKeys(const map<android::String16, T>& map,
+                               set<android::String16> keys = {}) {
     for (const auto& key_value_pair : map) {
         keys.emplace(key_value_pair.first);
     }
     return keys;
 }
+
+// Reads a value of the type held by |out|, as written by writeToParcelInner().
+android::status_t readValue(const android::Parcel& parcel, bool* out) {
+    return parcel.readBool(out);
+}
+
+android::status_t readValue(const android::Parcel& parcel, int32_t* out) {
+    return parcel.readInt32(out);
+}
+
+android::status_t readValue(const android::Parcel& parcel, int64_t* out) {
+    return parcel.readInt64(out);
+}
+
+android::status_t readValue(const android::Parcel& parcel, double* out) {
+    return parcel.readDouble(out);
+}
+
+android::status_t readValue(const android::Parcel& parcel, android::String16* out) {
+    return parcel.readString16(out);
+}
+
+android::status_t readValue(const android::Parcel& parcel, vector<bool>* out) {
+    return parcel.readBoolVector(out);
+}
+
+android::status_t readValue(const android::Parcel& parcel, vector<int32_t>* out) {
+    return parcel.readInt32Vector(out);
+}
+
+android::status_t readValue(const android::Parcel& parcel, vector<int64_t>* out) {
+    return parcel.readInt64Vector(out);
+}
+
+android::status_t readValue(const android::Parcel& parcel, vector<double>* out) {
+    return parcel.readDoubleVector(out);
+}
+
+android::status_t readValue(const android::Parcel& parcel, vector<android::String16>* out) {
+    return parcel.readString16Vector(out);
+}
+
+android::status_t readValue(const android::Parcel& parcel,
+                            android::os::PersistableBundle* out) {
+    return out->readFromParcel(&parcel);
+}
+
+// Advances past a vector of |elementSize| byte elements without decoding it.
+android::status_t skipVector(const android::Parcel& parcel, size_t elementSize) {
+    int32_t size;
+    android::status_t status = parcel.readInt32(&size);
+    if (status != android::OK) return status;
+    if (size < 0) return android::UNEXPECTED_NULL;
+    if (static_cast<size_t>(size) > parcel.dataAvail() / elementSize) return android::BAD_VALUE;
+    return parcel.readInplace(size * elementSize) ? android::OK : android::BAD_VALUE;
+}
+
+android::status_t skipString16(const android::Parcel& parcel) {
+    size_t length;
+    return parcel.readString16Inplace(&length) ? android::OK : android::UNEXPECTED_NULL;
+}
+
+android::status_t skipValue(const android::Parcel& parcel, int32_t type);
+
+// Advances past a nested bundle without decoding it, checking that its entries are well formed,
+// have unique keys and fit within the length it was written with.
+android::status_t skipPersistableBundle(const android::Parcel& parcel) {
+    int32_t length;
+    android::status_t status = parcel.readInt32(&length);
+    if (status != android::OK) return status;
+    if (length < 0) return android::UNEXPECTED_NULL;
+    if (length == 0) return android::OK;
+    // The length does not include the magic number that follows it.
+    if (static_cast<size_t>(length) > parcel.dataAvail() ||
+        parcel.dataAvail() - length < sizeof(int32_t)) {
+        return android::BAD_VALUE;
+    }
+    const size_t end = parcel.dataPosition() + sizeof(int32_t) + length;
+
+    int32_t magic;
+    status = parcel.readInt32(&magic);
+    if (status != android::OK) return status;
+    if (magic != BUNDLE_MAGIC && magic != BUNDLE_MAGIC_NATIVE) {
+        ALOGE("Bad magic number for PersistableBundle: 0x%08x", magic);
+        return android::BAD_VALUE;
+    }
+
+    int32_t num_entries;
+    status = parcel.readInt32(&num_entries);
+    if (status != android::OK) return status;
+    // The keys point into the parcel, which doesn't change while skipping.
+    set<std::u16string_view> keys;
+    for (; num_entries > 0; --num_entries) {
+        size_t key_length;
+        const char16_t* key = parcel.readString16Inplace(&key_length);
+        if (key == nullptr) return android::UNEXPECTED_NULL;
+        if (!keys.emplace(key, key_length).second) {
+            ALOGE("Duplicate key in PersistableBundle");
+            return android::BAD_VALUE;
+        }
+        int32_t value_type;
+        status = parcel.readInt32(&value_type);
+        if (status != android::OK) return status;
+        status = skipValue(parcel, value_type);
+        if (status != android::OK) return status;
+        if (parcel.dataPosition() > end) return android::BAD_VALUE;
+    }
+    parcel.setDataPosition(end);
+    return android::OK;
+}
+
+// Advances past a value of |type| without decoding it, checking only that it is well formed.
+android::status_t skipValue(const android::Parcel& parcel, int32_t type) {
+    switch (type) {
+        case VAL_STRING:
+            return skipString16(parcel);
+        case VAL_INTEGER:
+        case VAL_BOOLEAN:
+            return parcel.readInplace(sizeof(int32_t)) ? android::OK : android::BAD_VALUE;
+        case VAL_LONG:
+        case VAL_DOUBLE:
+            return parcel.readInplace(sizeof(int64_t)) ? android::OK : android::BAD_VALUE;
+        case VAL_STRINGARRAY: {
+            int32_t size;
+            android::status_t status = parcel.readInt32(&size);
+            if (status != android::OK) return status;
+            if (size < 0) return android::UNEXPECTED_NULL;
+            for (; size > 0; --size) {
+                status = skipString16(parcel);
+                if (status != android::OK) return status;
+            }
+            return android::OK;
+        }
+        case VAL_INTARRAY:
+        case VAL_BOOLEANARRAY:
+            return skipVector(parcel, sizeof(int32_t));
+        case VAL_LONGARRAY:
+        case VAL_DOUBLEARRAY:
+            return skipVector(parcel, sizeof(int64_t));
+        case VAL_PERSISTABLEBUNDLE:
+            return skipPersistableBundle(parcel);
+        default:
+            ALOGE("Unrecognized type: %d", type);
+            return android::BAD_TYPE;
+    }
+}
 }  // namespace
 
 namespace android {
@@ -90,6 +237,30 @@ namespace os {
         }                                     \
     }
 
+struct PersistableBundle::LazyData {
+    // Getters share the read position of |parcel|, so they hold |lock| while decoding.
+    std::mutex lock;
+    Parcel parcel;
+};
+
+template <typename T>
+bool PersistableBundle::getLazyValue(const String16& key, int32_t type, T* out) const {
+    const auto& it = mLazyEntries.find(key);
+    if (it == mLazyEntries.end() || it->second.type != type) return false;
+
+    T value;
+    {
+        std::lock_guard<std::mutex> guard(mLazyData->lock);
+        mLazyData->parcel.setDataPosition(it->second.position);
+        if (readValue(mLazyData->parcel, &value) != NO_ERROR) {
+            ALOGE("Failed to decode value of type %d", type);
+            return false;
+        }
+    }
+    *out = std::move(value);
+    return true;
+}
+
 status_t PersistableBundle::writeToParcel(Parcel* parcel) const {
     /*
      * Keep implementation in sync with writeToParcelInner() in
@@ -133,6 +304,10 @@ status_t PersistableBundle::readFromParcel(const Parcel* parcel) {
         return UNEXPECTED_NULL;
     }
 
+    // Merging into existing entries needs them decoded, so only an empty bundle is lazy.
+    if (length > 0 && empty()) {
+        return indexFromParcel(parcel, static_cast<size_t>(length));
+    }
     return readFromParcelInner(parcel, static_cast<size_t>(length));
 }
 
@@ -151,7 +326,8 @@ size_t PersistableBundle::size() const {
             mLongVectorMap.size() +
             mDoubleVectorMap.size() +
             mStringVectorMap.size() +
-            mPersistableBundleMap.size());
+            mPersistableBundleMap.size() +
+            mLazyEntries.size());
 }
 
 size_t PersistableBundle::erase(const String16& key) {
@@ -165,7 +341,13 @@ size_t PersistableBundle::erase(const String16& key) {
     RETURN_IF_ENTRY_ERASED(mLongVectorMap, key);
     RETURN_IF_ENTRY_ERASED(mDoubleVectorMap, key);
     RETURN_IF_ENTRY_ERASED(mStringVectorMap, key);
-    return mPersistableBundleMap.erase(key);
+    RETURN_IF_ENTRY_ERASED(mPersistableBundleMap, key);
+
+    size_t num_erased = mLazyEntries.erase(key);
+    if (mLazyEntries.empty()) {
+        mLazyData.reset();
+    }
+    return num_erased;
 }
 
 void PersistableBundle::putBoolean(const String16& key, bool value) {
@@ -224,91 +406,144 @@ void PersistableBundle::putPersistableBundle(const String16& key, const Persista
 }
 
 bool PersistableBundle::getBoolean(const String16& key, bool* out) const {
-    return getValue(key, out, mBoolMap);
+    return getValue(key, out, mBoolMap) || getLazyValue(key, VAL_BOOLEAN, out);
 }
 
 bool PersistableBundle::getInt(const String16& key, int32_t* out) const {
-    return getValue(key, out, mIntMap);
+    return getValue(key, out, mIntMap) || getLazyValue(key, VAL_INTEGER, out);
 }
 
 bool PersistableBundle::getLong(const String16& key, int64_t* out) const {
-    return getValue(key, out, mLongMap);
+    return getValue(key, out, mLongMap) || getLazyValue(key, VAL_LONG, out);
 }
 
 bool PersistableBundle::getDouble(const String16& key, double* out) const {
-    return getValue(key, out, mDoubleMap);
+    return getValue(key, out, mDoubleMap) || getLazyValue(key, VAL_DOUBLE, out);
 }
 
 bool PersistableBundle::getString(const String16& key, String16* out) const {
-    return getValue(key, out, mStringMap);
+    return getValue(key, out, mStringMap) || getLazyValue(key, VAL_STRING, out);
 }
 
 bool PersistableBundle::getBooleanVector(const String16& key, vector<bool>* out) const {
-    return getValue(key, out, mBoolVectorMap);
+    return getValue(key, out, mBoolVectorMap) || getLazyValue(key, VAL_BOOLEANARRAY, out);
 }
 
 bool PersistableBundle::getIntVector(const String16& key, vector<int32_t>* out) const {
-    return getValue(key, out, mIntVectorMap);
+    return getValue(key, out, mIntVectorMap) || getLazyValue(key, VAL_INTARRAY, out);
 }
 
 bool PersistableBundle::getLongVector(const String16& key, vector<int64_t>* out) const {
-    return getValue(key, out, mLongVectorMap);
+    return getValue(key, out, mLongVectorMap) || getLazyValue(key, VAL_LONGARRAY, out);
 }
 
 bool PersistableBundle::getDoubleVector(const String16& key, vector<double>* out) const {
-    return getValue(key, out, mDoubleVectorMap);
+    return getValue(key, out, mDoubleVectorMap) || getLazyValue(key, VAL_DOUBLEARRAY, out);
 }
 
 bool PersistableBundle::getStringVector(const String16& key, vector<String16>* out) const {
-    return getValue(key, out, mStringVectorMap);
+    return getValue(key, out, mStringVectorMap) || getLazyValue(key, VAL_STRINGARRAY, out);
 }
 
 bool PersistableBundle::getPersistableBundle(const String16& key, PersistableBundle* out) const {
-    return getValue(key, out, mPersistableBundleMap);
+    return getValue(key, out, mPersistableBundleMap) ||
+            getLazyValue(key, VAL_PERSISTABLEBUNDLE, out);
 }
 
 set<String16> PersistableBundle::getBooleanKeys() const {
-    return getKeys(mBoolMap);
+    return getKeys(mBoolMap, getLazyKeys(VAL_BOOLEAN));
 }
 
 set<String16> PersistableBundle::getIntKeys() const {
-    return getKeys(mIntMap);
+    return getKeys(mIntMap, getLazyKeys(VAL_INTEGER));
 }
 
 set<String16> PersistableBundle::getLongKeys() const {
-    return getKeys(mLongMap);
+    return getKeys(mLongMap, getLazyKeys(VAL_LONG));
 }
 
 set<String16> PersistableBundle::getDoubleKeys() const {
-    return getKeys(mDoubleMap);
+    return getKeys(mDoubleMap, getLazyKeys(VAL_DOUBLE));
 }
 
 set<String16> PersistableBundle::getStringKeys() const {
-    return getKeys(mStringMap);
+    return getKeys(mStringMap, getLazyKeys(VAL_STRING));
 }
 
 set<String16> PersistableBundle::getBooleanVectorKeys() const {
-    return getKeys(mBoolVectorMap);
+    return getKeys(mBoolVectorMap, getLazyKeys(VAL_BOOLEANARRAY));
 }
 
 set<String16> PersistableBundle::getIntVectorKeys() const {
-    return getKeys(mIntVectorMap);
+    return getKeys(mIntVectorMap, getLazyKeys(VAL_INTARRAY));
 }
 
 set<String16> PersistableBundle::getLongVectorKeys() const {
-    return getKeys(mLongVectorMap);
+    return getKeys(mLongVectorMap, getLazyKeys(VAL_LONGARRAY));
 }
 
 set<String16> PersistableBundle::getDoubleVectorKeys() const {
-    return getKeys(mDoubleVectorMap);
+    return getKeys(mDoubleVectorMap, getLazyKeys(VAL_DOUBLEARRAY));
 }
 
 set<String16> PersistableBundle::getStringVectorKeys() const {
-    return getKeys(mStringVectorMap);
+    return getKeys(mStringVectorMap, getLazyKeys(VAL_STRINGARRAY));
 }
 
 set<String16> PersistableBundle::getPersistableBundleKeys() const {
-    return getKeys(mPersistableBundleMap);
+    return getKeys(mPersistableBundleMap, getLazyKeys(VAL_PERSISTABLEBUNDLE));
+}
+
+set<String16> PersistableBundle::getLazyKeys(int32_t type) const {
+    set<String16> keys;
+    for (const auto& [key, entry] : mLazyEntries) {
+        if (entry.type == type) keys.emplace(key);
+    }
+    return keys;
+}
+
+PersistableBundle PersistableBundle::decodeAll() const {
+    PersistableBundle bundle(*this);
+    bundle.mLazyData.reset();
+    bundle.mLazyEntries.clear();
+    for (const auto& [key, entry] : mLazyEntries) {
+        switch (entry.type) {
+            case VAL_BOOLEAN:
+                getLazyValue(key, VAL_BOOLEAN, &bundle.mBoolMap[key]);
+                break;
+            case VAL_INTEGER:
+                getLazyValue(key, VAL_INTEGER, &bundle.mIntMap[key]);
+                break;
+            case VAL_LONG:
+                getLazyValue(key, VAL_LONG, &bundle.mLongMap[key]);
+                break;
+            case VAL_DOUBLE:
+                getLazyValue(key, VAL_DOUBLE, &bundle.mDoubleMap[key]);
+                break;
+            case VAL_STRING:
+                getLazyValue(key, VAL_STRING, &bundle.mStringMap[key]);
+                break;
+            case VAL_BOOLEANARRAY:
+                getLazyValue(key, VAL_BOOLEANARRAY, &bundle.mBoolVectorMap[key]);
+                break;
+            case VAL_INTARRAY:
+                getLazyValue(key, VAL_INTARRAY, &bundle.mIntVectorMap[key]);
+                break;
+            case VAL_LONGARRAY:
+                getLazyValue(key, VAL_LONGARRAY, &bundle.mLongVectorMap[key]);
+                break;
+            case VAL_DOUBLEARRAY:
+                getLazyValue(key, VAL_DOUBLEARRAY, &bundle.mDoubleVectorMap[key]);
+                break;
+            case VAL_STRINGARRAY:
+                getLazyValue(key, VAL_STRINGARRAY, &bundle.mStringVectorMap[key]);
+                break;
+            case VAL_PERSISTABLEBUNDLE:
+                getLazyValue(key, VAL_PERSISTABLEBUNDLE, &bundle.mPersistableBundleMap[key]);
+                break;
+        }
+    }
+    return bundle;
 }
 
 status_t PersistableBundle::writeToParcelInner(Parcel* parcel) const {
@@ -381,6 +616,12 @@ status_t PersistableBundle::writeToParcelInner(Parcel* parcel) const {
         RETURN_IF_FAILED(parcel->writeInt32(VAL_PERSISTABLEBUNDLE));
         RETURN_IF_FAILED(key_val_pair.second.writeToParcel(parcel));
     }
+    // Values that were never decoded are written back as they were read.
+    for (const auto& [key, entry] : mLazyEntries) {
+        RETURN_IF_FAILED(parcel->writeString16(key));
+        RETURN_IF_FAILED(parcel->writeInt32(entry.type));
+        RETURN_IF_FAILED(parcel->write(mLazyData->parcel.data() + entry.position, entry.size));
+    }
     return NO_ERROR;
 }
 
@@ -411,6 +652,7 @@ status_t PersistableBundle::readFromParcelInner(const Parcel* parcel, size_t len
     int32_t num_entries;
     RETURN_IF_FAILED(parcel->readInt32(&num_entries));
 
+    set<String16> keys;
     for (; num_entries > 0; --num_entries) {
         String16 key;
         int32_t value_type;
@@ -418,9 +660,16 @@ status_t PersistableBundle::readFromParcelInner(const Parcel* parcel, size_t len
         RETURN_IF_FAILED(parcel->readInt32(&value_type));
 
         /*
-         * We assume that both the C++ and Java APIs ensure that all keys in a PersistableBundle
-         * are unique.
+         * Like the ArrayMap of BaseBundle in Java, reject bundles with duplicate keys, rather
+         * than keeping a key that was written with two types in two of the typed maps. A key
+         * of the bundle read into is replaced, like put*() does.
          */
+        if (!keys.insert(key).second) {
+            ALOGE("Duplicate key in PersistableBundle");
+            return BAD_VALUE;
+        }
+        erase(key);
+
         switch (value_type) {
             case VAL_STRING: {
                 RETURN_IF_FAILED(parcel->readString16(&mStringMap[key]));
@@ -477,6 +726,57 @@ status_t PersistableBundle::readFromParcelInner(const Parcel* parcel, size_t len
     return NO_ERROR;
 }
 
+status_t PersistableBundle::indexFromParcel(const Parcel* parcel, size_t length) {
+    /*
+     * Unlike readFromParcelInner(), this relies on length to copy the whole PersistableBundle
+     * out of parcel, as the Java implementation does. The length does not include the magic
+     * number.
+     */
+    size_t start_pos = parcel->dataPosition();
+    if (length > parcel->dataAvail() || parcel->dataAvail() - length < sizeof(int32_t)) {
+        ALOGE("Bad length in parcel: %zu", length);
+        return BAD_VALUE;
+    }
+    length += sizeof(int32_t);
+
+    auto data = std::make_shared<LazyData>();
+    RETURN_IF_FAILED(data->parcel.setData(parcel->data() + start_pos, length));
+    const Parcel& in = data->parcel;
+
+    int32_t magic;
+    RETURN_IF_FAILED(in.readInt32(&magic));
+    if (magic != BUNDLE_MAGIC && magic != BUNDLE_MAGIC_NATIVE) {
+        ALOGE("Bad magic number for PersistableBundle: 0x%08x", magic);
+        return BAD_VALUE;
+    }
+
+    int32_t num_entries;
+    RETURN_IF_FAILED(in.readInt32(&num_entries));
+
+    map<String16, LazyEntry> entries;
+    for (; num_entries > 0; --num_entries) {
+        String16 key;
+        int32_t value_type;
+        RETURN_IF_FAILED(in.readString16(&key));
+        RETURN_IF_FAILED(in.readInt32(&value_type));
+
+        size_t position = in.dataPosition();
+        RETURN_IF_FAILED(skipValue(in, value_type));
+        // See readFromParcelInner().
+        if (!entries.try_emplace(key, LazyEntry{value_type, position,
+                                                in.dataPosition() - position})
+                     .second) {
+            ALOGE("Duplicate key in PersistableBundle");
+            return BAD_VALUE;
+        }
+    }
+
+    parcel->setDataPosition(start_pos + length);
+    mLazyData = std::move(data);
+    mLazyEntries = std::move(entries);
+    return NO_ERROR;
+}
+
 }  // namespace os
 
 }  // namespace android
@@ -43,6 +43,7 @@
 #include <sys/types.h>
 #include <unistd.h>
 #include <mutex>
+#include <new>
 
 #define BINDER_VM_SIZE ((1 * 1024 * 1024) - sysconf(_SC_PAGE_SIZE) * 2)
 #define DEFAULT_MAX_BINDER_THREADS 15
@@ -310,17 +311,30 @@ void ProcessState::setCallRestriction(CallRestriction restriction) {
     mCallRestriction = restriction;
 }
 
-ProcessState::handle_entry* ProcessState::lookupHandleLocked(int32_t handle)
+ProcessState::handle_entry* ProcessState::lookupHandle(int32_t handle)
 {
-    const size_t N=mHandleToObject.size();
-    if (N <= (size_t)handle) {
-        handle_entry e;
-        e.binder = nullptr;
-        e.refs = nullptr;
-        status_t err = mHandleToObject.insertAt(e, N, handle+1-N);
-        if (err < NO_ERROR) return nullptr;
+    if (handle < 0) return nullptr;
+
+    // Segment k starts at handle kFirstHandleSegmentSize * (2^k - 1).
+    const uint64_t blocks = static_cast<uint64_t>(handle) / kFirstHandleSegmentSize + 1;
+    const size_t k = 63 - __builtin_clzll(blocks);
+    const size_t index = static_cast<size_t>(handle) - kFirstHandleSegmentSize * ((1ull << k) - 1);
+
+    handle_entry* segment = mHandleSegments[k].load(std::memory_order_acquire);
+    if (segment == nullptr) {
+        std::lock_guard<std::mutex> _l(mHandleSegmentsLock);
+        segment = mHandleSegments[k].load(std::memory_order_relaxed);
+        if (segment == nullptr) {
+            segment = new (std::nothrow) handle_entry[kFirstHandleSegmentSize << k]();
+            if (segment == nullptr) return nullptr;
+            mHandleSegments[k].store(segment, std::memory_order_release);
+        }
     }
-    return &mHandleToObject.editItemAt(handle);
+    return &segment[index];
+}
+
+std::mutex& ProcessState::handleLock(int32_t handle) {
+    return mHandleLocks[static_cast<uint32_t>(handle) % kHandleLockCount];
 }
 
 // see b/166779391: cannot change the VNDK interface, so access like this
@@ -331,17 +345,17 @@ sp<IBinder> ProcessState::getStrongProxyForHandle(int32_t handle)
     sp<IBinder> result;
     std::function<void()> postTask;
 
-    std::unique_lock<std::mutex> _l(mLock);
+    std::unique_lock<std::mutex> _l(handleLock(handle));
 
     if (handle == 0 && the_context_object != nullptr) return the_context_object;
 
-    handle_entry* e = lookupHandleLocked(handle);
+    handle_entry* e = lookupHandle(handle);
 
     if (e != nullptr) {
         // We need to create a new BpBinder if there isn't currently one, OR we
         // are unable to acquire a weak reference on this current one.  The
         // attemptIncWeak() is safe because we know the BpBinder destructor will always
-        // call expungeHandle(), which acquires the same lock we are holding now.
+        // call expungeHandle(), which acquires the same handle lock we are holding now.
         // We need to do this because there is a race condition between someone
         // releasing a reference on this BpBinder, and a new reference on its handle
         // arriving from the driver.
@@ -399,9 +413,9 @@ sp<IBinder> ProcessState::getStrongProxyForHandle(int32_t handle)
 
 void ProcessState::expungeHandle(int32_t handle, IBinder* binder)
 {
-    std::unique_lock<std::mutex> _l(mLock);
+    std::unique_lock<std::mutex> _l(handleLock(handle));
 
-    handle_entry* e = lookupHandleLocked(handle);
+    handle_entry* e = lookupHandle(handle);
 
     // This handle may have already been replaced with a new BpBinder
     // (if someone failed the AttemptIncWeak() above); we don't want
@@ -428,8 +442,10 @@ void ProcessState::spawnPooledThread(bool isMain)
         String8 name = makeBinderThreadName();
         ALOGV("Spawning new pooled thread, name=%s\n", name.c_str());
         sp<Thread> t = sp<PoolThread>::make(isMain);
-        t->run(name.c_str());
+        // Count the thread before it runs, since it may leave the pool again as soon as it
+        // executed a command (see shouldIdleThreadExit).
         mKernelStartedThreads++;
+        t->run(name.c_str());
     }
     // TODO: if startThreadPool is called on another thread after the process
     // starts up, the kernel might think that it already requested those
@@ -442,7 +458,10 @@ status_t ProcessState::setThreadPoolMaxThreadCount(size_t maxThreads) {
     LOG_ALWAYS_FATAL_IF(mThreadPoolStarted && maxThreads < mMaxThreads,
            "Binder threadpool cannot be shrunk after starting");
     status_t result = NO_ERROR;
-    if (ioctl(mDriverFD, BINDER_SET_MAX_THREADS, &maxThreads) != -1) {
+    std::lock_guard<std::mutex> _l(mLock);
+    // The kernel keeps counting threads that left the pool, so raise its limit by as many.
+    size_t kernelMaxThreads = maxThreads + mExitedIdleThreads;
+    if (ioctl(mDriverFD, BINDER_SET_MAX_THREADS, &kernelMaxThreads) != -1) {
         mMaxThreads = maxThreads;
     } else {
         result = -errno;
@@ -497,6 +516,61 @@ size_t ProcessState::getThreadPoolMaxTotalThreadCount() const {
     return mCurrentThreads;
 }
 
+void ProcessState::setThreadPoolMaxIdleThreadCount(size_t maxIdleThreads, size_t minThreads,
+                                                   std::chrono::milliseconds minIdleTime) {
+    mMinThreads = minThreads;
+    mMinIdleTime = minIdleTime;
+    mMaxIdleThreads = maxIdleThreads;
+}
+
+bool ProcessState::canIdleThreadsExit() const {
+    return mMaxIdleThreads != SIZE_MAX;
+}
+
+ProcessState::ThreadPoolStats ProcessState::getThreadPoolStats() const {
+    return ThreadPoolStats{
+            .threads = mCurrentThreads,
+            .executingThreads = mExecutingThreadsCount,
+            .peakExecutingThreads = mPeakExecutingThreadsCount,
+            .exitedIdleThreads = mExitedIdleThreads,
+    };
+}
+
+bool ProcessState::shouldIdleThreadExit(std::chrono::steady_clock::duration idleTime) {
+    // A thread which just waited for a command may be needed again soon. Only a thread which was
+    // idle for a while shows that the pool has more threads than the incoming calls need.
+    if (idleTime < mMinIdleTime.load()) {
+        return false;
+    }
+    const size_t maxIdle = mMaxIdleThreads;
+    const size_t minThreads = mMinThreads;
+    size_t current = mCurrentThreads;
+    // Leave the count of executing threads stale rather than reloading it in the loop: it only
+    // makes this thread stay in the pool when other threads just finished commands.
+    const size_t executing = mExecutingThreadsCount;
+    while (current > minThreads && current > executing && current - executing > maxIdle) {
+        // Claim the exit by leaving mCurrentThreads, so that concurrently idle threads do not
+        // shrink the pool below maxIdle or minThreads.
+        if (mCurrentThreads.compare_exchange_weak(current, current - 1)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void ProcessState::onIdleThreadExited() {
+    std::lock_guard<std::mutex> _l(mLock);
+    mKernelStartedThreads--;
+    mExitedIdleThreads++;
+
+    // The kernel never forgets about the threads it started, and would not replace this one
+    // unless its limit is raised accordingly.
+    size_t kernelMaxThreads = mMaxThreads + mExitedIdleThreads;
+    if (ioctl(mDriverFD, BINDER_SET_MAX_THREADS, &kernelMaxThreads) == -1) {
+        ALOGE("Binder ioctl to set max threads failed: %s", strerror(errno));
+    }
+}
+
 bool ProcessState::isThreadPoolStarted() const {
     return mThreadPoolStarted;
 }
@@ -578,6 +652,11 @@ ProcessState::ProcessState(const char* driver)
         mMaxThreads(DEFAULT_MAX_BINDER_THREADS),
         mCurrentThreads(0),
         mKernelStartedThreads(0),
+        mPeakExecutingThreadsCount(0),
+        mMaxIdleThreads(SIZE_MAX),
+        mMinThreads(1),
+        mMinIdleTime(std::chrono::steady_clock::duration::zero()),
+        mExitedIdleThreads(0),
         mStarvationStartTime(never()),
         mForked(false),
         mThreadPoolStarted(false),
@@ -618,6 +697,10 @@ ProcessState::~ProcessState()
         close(mDriverFD);
     }
     mDriverFD = -1;
+
+    for (auto& segment : mHandleSegments) {
+        delete[] segment.load(std::memory_order_relaxed);
+    }
 }
 
 } // namespace android
@@ -44,6 +44,11 @@ namespace android {
 
 constexpr size_t kSessionIdBytes = 32;
 
+// The most connections join() accepts per wakeup, when the server socket allows draining them.
+// Under a burst of connections this saves a poll per connection, while the shutdown trigger is
+// still checked regularly.
+constexpr size_t kMaxAcceptsPerPoll = 16;
+
 using namespace android::binder::impl;
 using android::binder::borrowed_fd;
 using android::binder::unique_fd;
@@ -218,6 +223,8 @@ status_t RpcServer::acceptSocketConnection(const RpcServer& server, RpcTransport
             accept4(server.mServer.fd.get(), nullptr, nullptr, SOCK_CLOEXEC | SOCK_NONBLOCK))));
     if (!clientSocket.fd.ok()) {
         int savedErrno = errno;
+        // All pending connections were accepted.
+        if (savedErrno == EAGAIN || savedErrno == EWOULDBLOCK) return WOULD_BLOCK;
         ALOGE("Could not accept4 socket: %s", strerror(savedErrno));
         return -savedErrno;
     }
@@ -252,6 +259,33 @@ status_t RpcServer::recvmsgSocketConnection(const RpcServer& server, RpcTranspor
     return OK;
 }
 
+void RpcServer::acceptConnection(RpcTransportFd clientSocket) {
+    std::array<uint8_t, kRpcAddressSize> addr;
+    static_assert(addr.size() >= sizeof(sockaddr_storage), "kRpcAddressSize is too small");
+    socklen_t addrLen = addr.size();
+
+    LOG_RPC_DETAIL("accept on fd %d yields fd %d", mServer.fd.get(), clientSocket.fd.get());
+
+    if (getpeername(clientSocket.fd.get(), reinterpret_cast<sockaddr*>(addr.data()), &addrLen)) {
+        ALOGE("Could not getpeername socket: %s", strerror(errno));
+        return;
+    }
+
+    if (mConnectionFilter != nullptr && !mConnectionFilter(addr.data(), addrLen)) {
+        ALOGE("Dropped client connection fd %d", clientSocket.fd.get());
+        return;
+    }
+
+    RpcMutexLockGuard _l(mLock);
+    RpcMaybeThread thread =
+            RpcMaybeThread(&RpcServer::establishConnection, sp<RpcServer>::fromExisting(this),
+                           std::move(clientSocket), addr, addrLen, RpcSession::join);
+
+    auto& threadRef = mConnectingThreads[thread.get_id()];
+    threadRef = std::move(thread);
+    rpcJoinIfSingleThreaded(threadRef);
+}
+
 void RpcServer::join() {
 
     {
@@ -266,42 +300,13 @@ void RpcServer::join() {
 
     status_t status;
     while ((status = mShutdownTrigger->triggerablePoll(mServer, POLLIN)) == OK) {
-        std::array<uint8_t, kRpcAddressSize> addr;
-        static_assert(addr.size() >= sizeof(sockaddr_storage), "kRpcAddressSize is too small");
-        socklen_t addrLen = addr.size();
-
-        RpcTransportFd clientSocket;
-        if ((status = mAcceptFn(*this, &clientSocket)) != OK) {
-            if (status == DEAD_OBJECT)
-                break;
-            else
-                continue;
-        }
-
-        LOG_RPC_DETAIL("accept on fd %d yields fd %d", mServer.fd.get(), clientSocket.fd.get());
-
-        if (getpeername(clientSocket.fd.get(), reinterpret_cast<sockaddr*>(addr.data()),
-                        &addrLen)) {
-            ALOGE("Could not getpeername socket: %s", strerror(errno));
-            continue;
-        }
-
-        if (mConnectionFilter != nullptr && !mConnectionFilter(addr.data(), addrLen)) {
-            ALOGE("Dropped client connection fd %d", clientSocket.fd.get());
-            continue;
-        }
-
-        {
-            RpcMutexLockGuard _l(mLock);
-            RpcMaybeThread thread =
-                    RpcMaybeThread(&RpcServer::establishConnection,
-                                   sp<RpcServer>::fromExisting(this), std::move(clientSocket), addr,
-                                   addrLen, RpcSession::join);
-
-            auto& threadRef = mConnectingThreads[thread.get_id()];
-            threadRef = std::move(thread);
-            rpcJoinIfSingleThreaded(threadRef);
+        const size_t maxAccepts = mAcceptUntilWouldBlock ? kMaxAcceptsPerPoll : 1;
+        for (size_t i = 0; i < maxAccepts && !mShutdownTrigger->isTriggered(); i++) {
+            RpcTransportFd clientSocket;
+            if ((status = mAcceptFn(*this, &clientSocket)) != OK) break;
+            acceptConnection(std::move(clientSocket));
         }
+        if (status == DEAD_OBJECT) break;
     }
     LOG_RPC_DETAIL("RpcServer::join exiting with %s", statusToString(status).c_str());
 
@@ -672,7 +677,18 @@ status_t RpcServer::setupExternalServer(
 }
 
 status_t RpcServer::setupExternalServer(unique_fd serverFd) {
-    return setupExternalServer(std::move(serverFd), &RpcServer::acceptSocketConnection);
+    // join() only accepts after polling, so a non-blocking socket lets it accept every pending
+    // connection without the risk of blocking shutdown.
+    const bool nonBlocking = binder::os::setNonBlocking(serverFd) == OK;
+    if (status_t status =
+                setupExternalServer(std::move(serverFd), &RpcServer::acceptSocketConnection);
+        status != OK) {
+        return status;
+    }
+
+    RpcMutexLockGuard _l(mLock);
+    mAcceptUntilWouldBlock = nonBlocking;
+    return OK;
 }
 
 bool RpcServer::hasActiveRequests() {
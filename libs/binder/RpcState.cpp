@@ -69,6 +69,19 @@ static bool enableAncillaryFds(RpcSession::FileDescriptorTransportMode mode) {
 RpcState::RpcState() {}
 RpcState::~RpcState() {}
 
+RpcState::NodeShard& RpcState::shardFor(uint64_t address) {
+    // the low word is the id counter, so consecutive binders spread evenly
+    return mNodeShards[RpcWireAddress::fromRaw(address).address % kNodeShardCount];
+}
+
+void RpcState::lockAllNodeShards() {
+    for (auto& shard : mNodeShards) shard.mutex.lock();
+}
+
+void RpcState::unlockAllNodeShards() {
+    for (auto it = mNodeShards.rbegin(); it != mNodeShards.rend(); ++it) it->mutex.unlock();
+}
+
 status_t RpcState::onBinderLeaving(const sp<RpcSession>& session, const sp<IBinder>& binder,
                                    uint64_t* outAddress) {
     bool isRemote = binder->remoteBinder();
@@ -94,32 +107,47 @@ status_t RpcState::onBinderLeaving(const sp<RpcSession>& session, const sp<IBind
         return INVALID_OPERATION;
     }
 
-    RpcMutexLockGuard _l(mNodeMutex);
+    if (isRpc) {
+        // RPC binders already know their address, so only one shard is needed
+        uint64_t addr = binder->remoteBinder()->getPrivateAccessor().rpcAddress();
+        NodeShard& shard = shardFor(addr);
+        RpcMutexLockGuard _l(shard.mutex);
+        if (mTerminated) return DEAD_OBJECT;
+
+        auto it = shard.nodes.find(addr);
+        LOG_ALWAYS_FATAL_IF(it == shard.nodes.end() || it->second.binder != binder,
+                            "RPC binder must have known address at this point %" PRIu64, addr);
+        it->second.timesSent++;
+        it->second.sentRef = binder; // might already be set
+        *outAddress = addr;
+        return OK;
+    }
+
+    // Only this function creates nodes for local binders, so holding this
+    // while searching the shards one by one guarantees the same binder isn't
+    // given two addresses.
+    RpcMutexLockGuard _leaving(mNodeLeavingMutex);
     if (mTerminated) return DEAD_OBJECT;
 
     // TODO(b/182939933): maybe move address out of BpBinder, and keep binder->address map
     // in RpcState
-    for (auto& [addr, node] : mNodeForAddress) {
-        if (binder == node.binder) {
-            if (isRpc) {
-                // check integrity of data structure
-                uint64_t actualAddr = binder->remoteBinder()->getPrivateAccessor().rpcAddress();
-                LOG_ALWAYS_FATAL_IF(addr != actualAddr, "Address mismatch %" PRIu64 " vs %" PRIu64,
-                                    addr, actualAddr);
+    for (auto& shard : mNodeShards) {
+        RpcMutexLockGuard _l(shard.mutex);
+        for (auto& [addr, node] : shard.nodes) {
+            if (binder == node.binder) {
+                node.timesSent++;
+                node.sentRef = binder; // might already be set
+                *outAddress = addr;
+                return OK;
             }
-            node.timesSent++;
-            node.sentRef = binder; // might already be set
-            *outAddress = addr;
-            return OK;
         }
     }
-    LOG_ALWAYS_FATAL_IF(isRpc, "RPC binder must have known address at this point");
 
     bool forServer = session->server() != nullptr;
 
     // arbitrary limit for maximum number of nodes in a process (otherwise we
     // might run out of addresses)
-    if (mNodeForAddress.size() > 100000) {
+    if (mNodeCount > 100000) {
         return NO_MEMORY;
     }
 
@@ -139,13 +167,19 @@ status_t RpcState::onBinderLeaving(const sp<RpcSession>& session, const sp<IBind
             mNextId++;
         }
 
-        auto&& [it, inserted] = mNodeForAddress.insert({RpcWireAddress::toRaw(address),
-                                                        BinderNode{
-                                                                .binder = binder,
-                                                                .sentRef = binder,
-                                                                .timesSent = 1,
-                                                        }});
+        uint64_t rawAddress = RpcWireAddress::toRaw(address);
+        NodeShard& shard = shardFor(rawAddress);
+        RpcMutexLockGuard _l(shard.mutex);
+        if (mTerminated) return DEAD_OBJECT;
+
+        auto&& [it, inserted] = shard.nodes.insert({rawAddress,
+                                                    BinderNode{
+                                                            .binder = binder,
+                                                            .sentRef = binder,
+                                                            .timesSent = 1,
+                                                    }});
         if (inserted) {
+            mNodeCount++;
             *outAddress = it->first;
             return OK;
         }
@@ -170,10 +204,11 @@ status_t RpcState::onBinderEntering(const sp<RpcSession>& session, uint64_t addr
         return BAD_VALUE;
     }
 
-    RpcMutexLockGuard _l(mNodeMutex);
+    NodeShard& shard = shardFor(address);
+    RpcMutexLockGuard _l(shard.mutex);
     if (mTerminated) return DEAD_OBJECT;
 
-    if (auto it = mNodeForAddress.find(address); it != mNodeForAddress.end()) {
+    if (auto it = shard.nodes.find(address); it != shard.nodes.end()) {
         *out = it->second.binder.promote();
 
         // implicitly have strong RPC refcount, since we received this binder
@@ -189,8 +224,9 @@ status_t RpcState::onBinderEntering(const sp<RpcSession>& session, uint64_t addr
         return BAD_VALUE;
     }
 
-    auto&& [it, inserted] = mNodeForAddress.insert({address, BinderNode{}});
+    auto&& [it, inserted] = shard.nodes.insert({address, BinderNode{}});
     LOG_ALWAYS_FATAL_IF(!inserted, "Failed to insert binder when creating proxy");
+    mNodeCount++;
 
     // Currently, all binders are assumed to be part of the same session (no
     // device global binders in the RPC world).
@@ -205,12 +241,13 @@ status_t RpcState::flushExcessBinderRefs(const sp<RpcSession>& session, uint64_t
     // extra reference counting packets now.
     if (binder->remoteBinder()) return OK;
 
-    RpcMutexUniqueLock _l(mNodeMutex);
+    NodeShard& shard = shardFor(address);
+    RpcMutexUniqueLock _l(shard.mutex);
     if (mTerminated) return DEAD_OBJECT;
 
-    auto it = mNodeForAddress.find(address);
+    auto it = shard.nodes.find(address);
 
-    LOG_ALWAYS_FATAL_IF(it == mNodeForAddress.end(), "Can't be deleted while we hold sp<>");
+    LOG_ALWAYS_FATAL_IF(it == shard.nodes.end(), "Can't be deleted while we hold sp<>");
     LOG_ALWAYS_FATAL_IF(it->second.binder != binder,
                         "Caller of flushExcessBinderRefs using inconsistent arguments");
 
@@ -233,19 +270,19 @@ status_t RpcState::flushExcessBinderRefs(const sp<RpcSession>& session, uint64_t
 }
 
 status_t RpcState::sendObituaries(const sp<RpcSession>& session) {
-    RpcMutexUniqueLock _l(mNodeMutex);
-
     // Gather strong pointers to all of the remote binders for this session so
     // we hold the strong references. remoteBinder() returns a raw pointer.
     // Send the obituaries and drop the strong pointers outside of the lock so
     // the destructors and the onBinderDied calls are not done while locked.
     std::vector<sp<IBinder>> remoteBinders;
-    for (const auto& [_, binderNode] : mNodeForAddress) {
-        if (auto binder = binderNode.binder.promote()) {
-            remoteBinders.push_back(std::move(binder));
+    for (auto& shard : mNodeShards) {
+        RpcMutexLockGuard _l(shard.mutex);
+        for (const auto& [_, binderNode] : shard.nodes) {
+            if (auto binder = binderNode.binder.promote()) {
+                remoteBinders.push_back(std::move(binder));
+            }
         }
     }
-    _l.unlock();
 
     for (const auto& binder : remoteBinders) {
         if (binder->remoteBinder() &&
@@ -257,24 +294,30 @@ status_t RpcState::sendObituaries(const sp<RpcSession>& session) {
 }
 
 size_t RpcState::countBinders() {
-    RpcMutexLockGuard _l(mNodeMutex);
-    return mNodeForAddress.size();
+    return mNodeCount;
 }
 
 void RpcState::dump() {
-    RpcMutexLockGuard _l(mNodeMutex);
+    lockAllNodeShards();
     dumpLocked();
+    unlockAllNodeShards();
 }
 
 void RpcState::clear() {
-    return clear(RpcMutexUniqueLock(mNodeMutex));
+    (void)terminate(false /*onlyIfEmpty*/);
 }
 
-void RpcState::clear(RpcMutexUniqueLock nodeLock) {
+bool RpcState::terminate(bool onlyIfEmpty) {
+    lockAllNodeShards();
     if (mTerminated) {
-        LOG_ALWAYS_FATAL_IF(!mNodeForAddress.empty(),
-                            "New state should be impossible after terminating!");
-        return;
+        LOG_ALWAYS_FATAL_IF(mNodeCount != 0, "New state should be impossible after terminating!");
+        unlockAllNodeShards();
+        return true;
+    }
+    // another thread may have added a node since the caller saw it empty
+    if (onlyIfEmpty && mNodeCount != 0) {
+        unlockAllNodeShards();
+        return false;
     }
     mTerminated = true;
 
@@ -284,30 +327,39 @@ void RpcState::clear(RpcMutexUniqueLock nodeLock) {
     }
 
     // invariants
-    for (auto& [address, node] : mNodeForAddress) {
-        bool guaranteedHaveBinder = node.timesSent > 0;
-        if (guaranteedHaveBinder) {
-            LOG_ALWAYS_FATAL_IF(node.sentRef == nullptr,
-                                "Binder expected to be owned with address: %" PRIu64 " %s", address,
-                                node.toString().c_str());
+    for (auto& shard : mNodeShards) {
+        for (auto& [address, node] : shard.nodes) {
+            bool guaranteedHaveBinder = node.timesSent > 0;
+            if (guaranteedHaveBinder) {
+                LOG_ALWAYS_FATAL_IF(node.sentRef == nullptr,
+                                    "Binder expected to be owned with address: %" PRIu64 " %s",
+                                    address, node.toString().c_str());
+            }
         }
     }
 
     // if the destructor of a binder object makes another RPC call, then calling
     // decStrong could deadlock. So, we must hold onto these binders until
-    // mNodeMutex is no longer taken.
-    auto temp = std::move(mNodeForAddress);
-    mNodeForAddress.clear(); // RpcState isn't reusable, but for future/explicit
+    // the shard locks are no longer taken.
+    std::array<std::map<uint64_t, BinderNode>, kNodeShardCount> temp;
+    for (size_t i = 0; i < kNodeShardCount; i++) {
+        temp[i] = std::move(mNodeShards[i].nodes);
+        mNodeShards[i].nodes.clear(); // RpcState isn't reusable, but for future/explicit
+    }
+    mNodeCount = 0;
 
-    nodeLock.unlock();
-    temp.clear(); // explicit
+    unlockAllNodeShards();
+    for (auto& nodes : temp) nodes.clear(); // explicit
+    return true;
 }
 
 void RpcState::dumpLocked() {
     ALOGE("DUMP OF RpcState %p", this);
-    ALOGE("DUMP OF RpcState (%zu nodes)", mNodeForAddress.size());
-    for (const auto& [address, node] : mNodeForAddress) {
-        ALOGE("- address: %" PRIu64 " %s", address, node.toString().c_str());
+    ALOGE("DUMP OF RpcState (%zu nodes)", mNodeCount.load());
+    for (const auto& shard : mNodeShards) {
+        for (const auto& [address, node] : shard.nodes) {
+            ALOGE("- address: %" PRIu64 " %s", address, node.toString().c_str());
+        }
     }
     ALOGE("END DUMP OF RpcState");
 }
@@ -546,10 +598,11 @@ status_t RpcState::transactAddress(const sp<RpcSession::RpcConnection>& connecti
     uint64_t asyncNumber = 0;
 
     if (address != 0) {
-        RpcMutexUniqueLock _l(mNodeMutex);
+        NodeShard& shard = shardFor(address);
+        RpcMutexUniqueLock _l(shard.mutex);
         if (mTerminated) return DEAD_OBJECT; // avoid fatal only, otherwise races
-        auto it = mNodeForAddress.find(address);
-        LOG_ALWAYS_FATAL_IF(it == mNodeForAddress.end(),
+        auto it = shard.nodes.find(address);
+        LOG_ALWAYS_FATAL_IF(it == shard.nodes.end(),
                             "Sending transact on unknown address %" PRIu64, address);
 
         if (flags & IBinder::FLAG_ONEWAY) {
@@ -595,6 +648,9 @@ status_t RpcState::transactAddress(const sp<RpcSession::RpcConnection>& connecti
     constexpr size_t kWaitLogUs = 10000;
     size_t waitUs = 0;
 
+    // The header, transaction and parcel segments are handed to the transport
+    // as separate iovecs, so the parcel data is never copied into an
+    // intermediate buffer before sendmsg.
     iovec iovs[]{
             {&command, sizeof(RpcWireHeader)},
             {&transaction, sizeof(RpcWireTransaction)},
@@ -734,10 +790,11 @@ status_t RpcState::sendDecStrongToTarget(const sp<RpcSession::RpcConnection>& co
     };
 
     {
-        RpcMutexUniqueLock _l(mNodeMutex);
+        NodeShard& shard = shardFor(addr);
+        RpcMutexUniqueLock _l(shard.mutex);
         if (mTerminated) return DEAD_OBJECT; // avoid fatal only, otherwise races
-        auto it = mNodeForAddress.find(addr);
-        LOG_ALWAYS_FATAL_IF(it == mNodeForAddress.end(),
+        auto it = shard.nodes.find(addr);
+        LOG_ALWAYS_FATAL_IF(it == shard.nodes.end(),
                             "Sending dec strong on unknown address %" PRIu64, addr);
 
         LOG_ALWAYS_FATAL_IF(it->second.timesRecd < target, "Can't dec count of %zu to %zu.",
@@ -750,7 +807,7 @@ status_t RpcState::sendDecStrongToTarget(const sp<RpcSession::RpcConnection>& co
         body.amount = it->second.timesRecd - target;
         it->second.timesRecd = target;
 
-        LOG_ALWAYS_FATAL_IF(nullptr != tryEraseNode(session, std::move(_l), it),
+        LOG_ALWAYS_FATAL_IF(nullptr != tryEraseNode(session, shard, std::move(_l), it),
                             "Bad state. RpcState shouldn't own received binder");
         // LOCK ALREADY RELEASED
     }
@@ -839,6 +896,8 @@ status_t RpcState::processTransact(
         std::vector<std::variant<unique_fd, borrowed_fd>>&& ancillaryFds) {
     LOG_ALWAYS_FATAL_IF(command.command != RPC_COMMAND_TRANSACT, "command: %d", command.command);
 
+    // The body is read directly into the buffer that backs the incoming
+    // Parcel (see processTransactInternal), so there is no further copy.
     CommandData transactionData(command.bodySize);
     if (!transactionData.valid()) {
         return NO_MEMORY;
@@ -907,8 +966,9 @@ processTransactInternalTailCall:
             (void)session->shutdownAndWait(false);
             replyStatus = BAD_VALUE;
         } else if (oneway) {
-            RpcMutexUniqueLock _l(mNodeMutex);
-            auto it = mNodeForAddress.find(addr);
+            NodeShard& shard = shardFor(addr);
+            RpcMutexUniqueLock _l(shard.mutex);
+            auto it = shard.nodes.find(addr);
             if (it->second.binder.promote() != target) {
                 ALOGE("Binder became invalid during transaction. Bad client? %" PRIu64, addr);
                 replyStatus = BAD_VALUE;
@@ -1056,10 +1116,11 @@ processTransactInternalTailCall:
         // downside: asynchronous transactions may drown out synchronous
         // transactions.
         {
-            RpcMutexUniqueLock _l(mNodeMutex);
-            auto it = mNodeForAddress.find(addr);
+            NodeShard& shard = shardFor(addr);
+            RpcMutexUniqueLock _l(shard.mutex);
+            auto it = shard.nodes.find(addr);
             // last refcount dropped after this transaction happened
-            if (it == mNodeForAddress.end()) return OK;
+            if (it == shard.nodes.end()) return OK;
 
             if (!nodeProgressAsyncNumber(&it->second)) {
                 _l.unlock();
@@ -1165,9 +1226,10 @@ status_t RpcState::processDecStrong(const sp<RpcSession::RpcConnection>& connect
         return status;
 
     uint64_t addr = RpcWireAddress::toRaw(body.address);
-    RpcMutexUniqueLock _l(mNodeMutex);
-    auto it = mNodeForAddress.find(addr);
-    if (it == mNodeForAddress.end()) {
+    NodeShard& shard = shardFor(addr);
+    RpcMutexUniqueLock _l(shard.mutex);
+    auto it = shard.nodes.find(addr);
+    if (it == shard.nodes.end()) {
         ALOGE("Unknown binder address %" PRIu64 " for dec strong.", addr);
         return OK;
     }
@@ -1195,7 +1257,7 @@ status_t RpcState::processDecStrong(const sp<RpcSession::RpcConnection>& connect
                    it->second.timesSent);
 
     it->second.timesSent -= body.amount;
-    sp<IBinder> tempHold = tryEraseNode(session, std::move(_l), it);
+    sp<IBinder> tempHold = tryEraseNode(session, shard, std::move(_l), it);
     // LOCK ALREADY RELEASED
     tempHold = nullptr; // destructor may make binder calls on this session
 
@@ -1263,7 +1325,8 @@ status_t RpcState::validateParcel(const sp<RpcSession>& session, const Parcel& p
     return OK;
 }
 
-sp<IBinder> RpcState::tryEraseNode(const sp<RpcSession>& session, RpcMutexUniqueLock nodeLock,
+sp<IBinder> RpcState::tryEraseNode(const sp<RpcSession>& session, NodeShard& shard,
+                                   RpcMutexUniqueLock nodeLock,
                                    std::map<uint64_t, BinderNode>::iterator& it) {
     bool shouldShutdown = false;
 
@@ -1275,22 +1338,23 @@ sp<IBinder> RpcState::tryEraseNode(const sp<RpcSession>& session, RpcMutexUnique
         if (it->second.timesRecd == 0) {
             LOG_ALWAYS_FATAL_IF(!it->second.asyncTodo.empty(),
                                 "Can't delete binder w/ pending async transactions");
-            mNodeForAddress.erase(it);
+            shard.nodes.erase(it);
 
-            if (mNodeForAddress.size() == 0) {
+            if (--mNodeCount == 0) {
                 shouldShutdown = true;
             }
         }
     }
 
+    nodeLock.unlock(); // explicit
+    // LOCK IS RELEASED
+
     // If we shutdown, prevent RpcState from being re-used. This prevents another
-    // thread from getting the root object again.
+    // thread from getting the root object again. terminate() re-checks under
+    // all shard locks, in case a node was added in another shard meanwhile.
     if (shouldShutdown) {
-        clear(std::move(nodeLock));
-    } else {
-        nodeLock.unlock(); // explicit
+        shouldShutdown = terminate(true /*onlyIfEmpty*/);
     }
-    // LOCK IS RELEASED
 
     if (shouldShutdown) {
         ALOGI("RpcState has no binders left, so triggering shutdown...");
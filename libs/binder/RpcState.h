@@ -22,6 +22,8 @@
 #include <binder/RpcThreads.h>
 #include <binder/unique_fd.h>
 
+#include <array>
+#include <atomic>
 #include <map>
 #include <optional>
 #include <queue>
@@ -171,8 +173,13 @@ public:
     void clear();
 
 private:
-    void clear(RpcMutexUniqueLock nodeLock);
-    void dumpLocked();
+    // Terminates the state, dropping all nodes. If onlyIfEmpty is set, this
+    // is a no-op unless there are no nodes left. Returns whether the state is
+    // terminated after this call.
+    bool terminate(bool onlyIfEmpty);
+    void lockAllNodeShards();
+    void unlockAllNodeShards();
+    void dumpLocked(); // requires all node shard locks
 
     // Alternative to std::vector<uint8_t> that doesn't abort on allocation failure and caps
     // large allocations to avoid being requested from allocating too much data.
@@ -273,6 +280,19 @@ private:
         std::string toString() const;
     };
 
+    // binders known by both sides of a session
+    //
+    // The table is sharded by address so that threads processing transactions
+    // on different binders don't contend for a single lock. Lock order is
+    // mNodeLeavingMutex, then shards in increasing index order; other than
+    // terminate() and dump(), nothing holds more than one shard lock.
+    struct NodeShard {
+        RpcMutex mutex;
+        std::map<uint64_t, BinderNode> nodes;
+    };
+    static constexpr size_t kNodeShardCount = 16;
+    NodeShard& shardFor(uint64_t address);
+
     // Checks if there is any reference left to a node and erases it. If this
     // is the last node, shuts down the session.
     //
@@ -284,18 +304,23 @@ private:
     // this introduces the posssibility that another thread calls
     // getRootBinder and thinks it is valid, rather than immediately getting
     // an error.
-    sp<IBinder> tryEraseNode(const sp<RpcSession>& session, RpcMutexUniqueLock nodeLock,
+    sp<IBinder> tryEraseNode(const sp<RpcSession>& session, NodeShard& shard,
+                             RpcMutexUniqueLock nodeLock,
                              std::map<uint64_t, BinderNode>::iterator& it);
 
     // true - success
     // false - session shutdown, halt
     [[nodiscard]] bool nodeProgressAsyncNumber(BinderNode* node);
 
-    RpcMutex mNodeMutex;
-    bool mTerminated = false;
+    std::array<NodeShard, kNodeShardCount> mNodeShards;
+    // Serializes onBinderLeaving, which has to search every shard for a local
+    // binder before assigning it a new address. Also guards mNextId.
+    RpcMutex mNodeLeavingMutex;
     uint32_t mNextId = 0;
-    // binders known by both sides of a session
-    std::map<uint64_t, BinderNode> mNodeForAddress;
+    // only set while holding every shard lock
+    std::atomic<bool> mTerminated = false;
+    // total size of all shards, only modified while holding a shard lock
+    std::atomic<size_t> mNodeCount = 0;
 };
 
 } // namespace android
@@ -0,0 +1,452 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "RpcShmTransport"
+#include <log/log.h>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <stddef.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+
+#include <binder/RpcTransportRaw.h>
+#include <binder/RpcTransportShm.h>
+
+#include "FdTrigger.h"
+#include "OS.h"
+#include "RpcState.h"
+#include "RpcTransportUtils.h"
+
+namespace android {
+
+using namespace android::binder::impl;
+using android::binder::borrowed_fd;
+using android::binder::unique_fd;
+
+namespace {
+
+constexpr uint32_t kShmHelloMagic = 0x52534d31; // 'RSM1'
+
+// Must be a power of two so that free-running indices can be masked.
+constexpr uint32_t kShmRingSize = 128 * 1024;
+static_assert((kShmRingSize & (kShmRingSize - 1)) == 0);
+
+// The first message on the socket, sent by the client together with the memfd
+// and the two eventfds. The server echoes it back (without FDs) to accept.
+struct ShmHello {
+    uint32_t magic;
+    uint32_t ringSize;
+};
+
+struct alignas(64) ShmIndex {
+    std::atomic<uint32_t> value;
+};
+static_assert(std::atomic<uint32_t>::is_always_lock_free);
+
+// Single-producer, single-consumer byte ring. Indices are free running and
+// only ever compared modulo kShmRingSize.
+struct ShmRing {
+    ShmIndex head;            // written by the producer
+    ShmIndex tail;            // written by the consumer
+    ShmIndex consumerWaiting; // consumer is about to sleep on its eventfd
+    ShmIndex producerWaiting; // producer is about to sleep on its eventfd
+    uint8_t data[kShmRingSize];
+};
+
+struct ShmRegion {
+    ShmRing rings[2]; // [0]: client -> server, [1]: server -> client
+};
+
+enum FdIndex : size_t { MEMFD = 0, CLIENT_WAKE = 1, SERVER_WAKE = 2, FD_COUNT = 3 };
+
+bool isUnixSocket(borrowed_fd fd) {
+    int domain = 0;
+    socklen_t len = sizeof(domain);
+    if (getsockopt(fd.get(), SOL_SOCKET, SO_DOMAIN, &domain, &len) != 0) return false;
+    return domain == AF_UNIX;
+}
+
+} // namespace
+
+// RpcTransport that moves bytes through shared memory.
+class RpcTransportShm : public RpcTransport {
+public:
+    RpcTransportShm(android::RpcTransportFd socket, unique_fd wakeSelf, unique_fd wakePeer,
+                    ShmRegion* region, bool isClient)
+          : mSocket(std::move(socket)),
+            mWake(std::move(wakeSelf)),
+            mPeerWake(std::move(wakePeer)),
+            mRegion(region),
+            mTx(region->rings[isClient ? 0 : 1]),
+            mRx(region->rings[isClient ? 1 : 0]),
+            mTxHead(mTx.head.value.load(std::memory_order_relaxed)),
+            mRxTail(mRx.tail.value.load(std::memory_order_relaxed)) {}
+
+    ~RpcTransportShm() { munmap(mRegion, sizeof(ShmRegion)); }
+
+    status_t pollRead(void) override {
+        if (mRx.head.value.load(std::memory_order_acquire) != mRxTail) {
+            return OK;
+        }
+
+        pollfd pfd{.fd = mSocket.fd.get(), .events = 0, .revents = 0};
+        if (TEMP_FAILURE_RETRY(::poll(&pfd, 1, 0)) < 0) {
+            int savedErrno = errno;
+            LOG_RPC_DETAIL("RpcTransport poll(): %s", strerror(savedErrno));
+            return -savedErrno;
+        }
+        if (pfd.revents & (POLLHUP | POLLERR)) {
+            return DEAD_OBJECT;
+        }
+        return WOULD_BLOCK;
+    }
+
+    status_t interruptableWriteFully(
+            FdTrigger* fdTrigger, iovec* iovs, int niovs,
+            const std::optional<SmallFunction<status_t()>>& altPoll,
+            const std::vector<std::variant<unique_fd, borrowed_fd>>* ancillaryFds) override {
+        MAYBE_WAIT_IN_FLAKE_MODE;
+
+        if (niovs < 0) return BAD_VALUE;
+        if (ancillaryFds != nullptr && !ancillaryFds->empty()) {
+            ALOGE("RpcTransportShm cannot send file descriptors");
+            return BAD_VALUE;
+        }
+        if (fdTrigger->isTriggered()) return DEAD_OBJECT;
+
+        // Only publish the new head once all iovecs are in the ring (or the
+        // ring is full), so that the reader is woken at most once per message.
+        for (int i = 0; i < niovs; i++) {
+            const uint8_t* src = reinterpret_cast<const uint8_t*>(iovs[i].iov_base);
+            size_t remaining = iovs[i].iov_len;
+            while (remaining > 0) {
+                uint32_t used = mTxHead - mTx.tail.value.load(std::memory_order_acquire);
+                if (used > kShmRingSize) {
+                    ALOGE("RpcTransportShm: peer corrupted ring (used %u)", used);
+                    return DEAD_OBJECT;
+                }
+                size_t len = std::min<size_t>(kShmRingSize - used, remaining);
+                if (len == 0) {
+                    publishTx();
+                    if (status_t status = waitForSpace(fdTrigger, altPoll); status != OK) {
+                        return status;
+                    }
+                    continue;
+                }
+                copyIn(src, len);
+                src += len;
+                remaining -= len;
+            }
+        }
+        publishTx();
+        return OK;
+    }
+
+    status_t interruptableReadFully(
+            FdTrigger* fdTrigger, iovec* iovs, int niovs,
+            const std::optional<SmallFunction<status_t()>>& altPoll,
+            std::vector<std::variant<unique_fd, borrowed_fd>>* ancillaryFds) override {
+        MAYBE_WAIT_IN_FLAKE_MODE;
+        (void)ancillaryFds; // never populated, see RpcTransportShm.h
+
+        if (niovs < 0) return BAD_VALUE;
+        if (fdTrigger->isTriggered()) return DEAD_OBJECT;
+
+        for (int i = 0; i < niovs; i++) {
+            uint8_t* dst = reinterpret_cast<uint8_t*>(iovs[i].iov_base);
+            size_t remaining = iovs[i].iov_len;
+            while (remaining > 0) {
+                uint32_t avail = mRx.head.value.load(std::memory_order_acquire) - mRxTail;
+                if (avail > kShmRingSize) {
+                    ALOGE("RpcTransportShm: peer corrupted ring (avail %u)", avail);
+                    return DEAD_OBJECT;
+                }
+                size_t len = std::min<size_t>(avail, remaining);
+                if (len == 0) {
+                    publishRx();
+                    if (status_t status = waitForData(fdTrigger, altPoll); status != OK) {
+                        return status;
+                    }
+                    continue;
+                }
+                copyOut(dst, len);
+                dst += len;
+                remaining -= len;
+            }
+        }
+        publishRx();
+        return OK;
+    }
+
+    bool isWaiting() override { return mWake.isInPollingState(); }
+
+private:
+    void copyIn(const uint8_t* src, size_t len) {
+        size_t offset = mTxHead & (kShmRingSize - 1);
+        size_t first = std::min<size_t>(len, kShmRingSize - offset);
+        memcpy(mTx.data + offset, src, first);
+        memcpy(mTx.data, src + first, len - first);
+        mTxHead += len;
+    }
+
+    void copyOut(uint8_t* dst, size_t len) {
+        size_t offset = mRxTail & (kShmRingSize - 1);
+        size_t first = std::min<size_t>(len, kShmRingSize - offset);
+        memcpy(dst, mRx.data + offset, first);
+        memcpy(dst + first, mRx.data, len - first);
+        mRxTail += len;
+    }
+
+    // The store to the index and the load of the waiting flag must not be
+    // reordered with the peer's store to the flag and load of the index, so
+    // these are all sequentially consistent.
+    void publishTx() {
+        mTx.head.value.store(mTxHead, std::memory_order_seq_cst);
+        if (mTx.consumerWaiting.value.exchange(0, std::memory_order_seq_cst)) ringPeer();
+    }
+
+    void publishRx() {
+        mRx.tail.value.store(mRxTail, std::memory_order_seq_cst);
+        if (mRx.producerWaiting.value.exchange(0, std::memory_order_seq_cst)) ringPeer();
+    }
+
+    void ringPeer() {
+        uint64_t one = 1;
+        // EAGAIN means the counter is already (very) non-zero, so the peer will wake anyway.
+        (void)TEMP_FAILURE_RETRY(write(mPeerWake.get(), &one, sizeof(one)));
+    }
+
+    status_t waitForSpace(FdTrigger* fdTrigger,
+                          const std::optional<SmallFunction<status_t()>>& altPoll) {
+        mTx.producerWaiting.value.store(1, std::memory_order_seq_cst);
+        if (mTxHead - mTx.tail.value.load(std::memory_order_seq_cst) < kShmRingSize) {
+            return OK;
+        }
+        return wait(fdTrigger, altPoll);
+    }
+
+    status_t waitForData(FdTrigger* fdTrigger,
+                         const std::optional<SmallFunction<status_t()>>& altPoll) {
+        mRx.consumerWaiting.value.store(1, std::memory_order_seq_cst);
+        if (mRx.head.value.load(std::memory_order_seq_cst) != mRxTail) {
+            return OK;
+        }
+        return wait(fdTrigger, altPoll);
+    }
+
+    status_t wait(FdTrigger* fdTrigger, const std::optional<SmallFunction<status_t()>>& altPoll) {
+        if (altPoll) {
+            if (status_t status = (*altPoll)(); status != OK) return status;
+            return fdTrigger->isTriggered() ? DEAD_OBJECT : OK;
+        }
+        if (status_t status = fdTrigger->triggerablePoll(mWake, POLLIN, mSocket.fd);
+            status != OK) {
+            return status;
+        }
+        uint64_t count;
+        (void)TEMP_FAILURE_RETRY(read(mWake.fd.get(), &count, sizeof(count)));
+        return OK;
+    }
+
+    // Only used to detect that the peer went away, and for the handshake.
+    android::RpcTransportFd mSocket;
+    // Our doorbell; the peer writes to it after producing or consuming data.
+    android::RpcTransportFd mWake;
+    unique_fd mPeerWake;
+
+    ShmRegion* mRegion;
+    ShmRing& mTx;
+    ShmRing& mRx;
+    // Local copies of the indices this side owns, so that a misbehaving peer
+    // cannot make us read or write outside of the ring.
+    uint32_t mTxHead;
+    uint32_t mRxTail;
+};
+
+// RpcTransportCtx for the shared-memory transport.
+class RpcTransportCtxShm : public RpcTransportCtx {
+public:
+    explicit RpcTransportCtxShm(bool isClient)
+          : mIsClient(isClient),
+            mRawCtx(isClient ? RpcTransportCtxFactoryRaw::make()->newClientCtx()
+                             : RpcTransportCtxFactoryRaw::make()->newServerCtx()) {}
+
+    std::unique_ptr<RpcTransport> newTransport(android::RpcTransportFd socket,
+                                               FdTrigger* fdTrigger) const override {
+        if (!isUnixSocket(socket.fd)) {
+            // Shared memory can only be negotiated where FDs can be passed.
+            return mRawCtx->newTransport(std::move(socket), fdTrigger);
+        }
+        return mIsClient ? connect(std::move(socket), fdTrigger)
+                         : accept(std::move(socket), fdTrigger);
+    }
+    std::vector<uint8_t> getCertificate(RpcCertificateFormat) const override { return {}; }
+
+private:
+    static ShmRegion* mapRegion(borrowed_fd memfd) {
+        void* addr =
+                mmap(nullptr, sizeof(ShmRegion), PROT_READ | PROT_WRITE, MAP_SHARED, memfd.get(), 0);
+        if (addr == MAP_FAILED) {
+            ALOGE("Failed to mmap shared ring: %s", strerror(errno));
+            return nullptr;
+        }
+        return reinterpret_cast<ShmRegion*>(addr);
+    }
+
+    static status_t sendHello(android::RpcTransportFd& socket, FdTrigger* fdTrigger,
+                              const std::vector<std::variant<unique_fd, borrowed_fd>>* fds) {
+        ShmHello hello{.magic = kShmHelloMagic, .ringSize = kShmRingSize};
+        iovec iov{&hello, sizeof(hello)};
+        bool sentFds = false;
+        auto send = [&](iovec* iovs, int niovs) -> ssize_t {
+            ssize_t ret =
+                    binder::os::sendMessageOnSocket(socket, iovs, niovs, sentFds ? nullptr : fds);
+            sentFds |= ret > 0;
+            return ret;
+        };
+        return interruptableReadOrWrite(socket, fdTrigger, &iov, 1, send, "sendmsg", POLLOUT,
+                                        std::nullopt);
+    }
+
+    static status_t receiveHello(android::RpcTransportFd& socket, FdTrigger* fdTrigger,
+                                 std::vector<std::variant<unique_fd, borrowed_fd>>* fds) {
+        ShmHello hello{};
+        iovec iov{&hello, sizeof(hello)};
+        auto recv = [&](iovec* iovs, int niovs) -> ssize_t {
+            return binder::os::receiveMessageFromSocket(socket, iovs, niovs, fds);
+        };
+        if (status_t status = interruptableReadOrWrite(socket, fdTrigger, &iov, 1, recv,
+                                                       "recvmsg", POLLIN, std::nullopt);
+            status != OK) {
+            return status;
+        }
+        if (hello.magic != kShmHelloMagic || hello.ringSize != kShmRingSize) {
+            ALOGE("Unexpected shared-memory transport hello: magic %x ring size %u", hello.magic,
+                  hello.ringSize);
+            return BAD_VALUE;
+        }
+        return OK;
+    }
+
+    std::unique_ptr<RpcTransport> connect(android::RpcTransportFd socket,
+                                          FdTrigger* fdTrigger) const {
+        unique_fd memfd(memfd_create("binder_rpc_shm", MFD_CLOEXEC | MFD_ALLOW_SEALING));
+        if (!memfd.ok()) {
+            ALOGE("Failed memfd_create: %s", strerror(errno));
+            return nullptr;
+        }
+        // Sealing the size means the server can map the region without having
+        // to worry about SIGBUS because we truncated it later.
+        if (ftruncate(memfd.get(), sizeof(ShmRegion)) != 0 ||
+            fcntl(memfd.get(), F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) != 0) {
+            ALOGE("Failed to size and seal shared ring: %s", strerror(errno));
+            return nullptr;
+        }
+        unique_fd clientWake(eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK));
+        unique_fd serverWake(eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK));
+        if (!clientWake.ok() || !serverWake.ok()) {
+            ALOGE("Failed eventfd: %s", strerror(errno));
+            return nullptr;
+        }
+        ShmRegion* region = mapRegion(memfd);
+        if (region == nullptr) return nullptr;
+        // memfd contents are zero-filled, which is the initial state of every ring.
+
+        std::vector<std::variant<unique_fd, borrowed_fd>> fds;
+        fds.emplace_back(borrowed_fd(memfd));
+        fds.emplace_back(borrowed_fd(clientWake));
+        fds.emplace_back(borrowed_fd(serverWake));
+        if (status_t status = sendHello(socket, fdTrigger, &fds); status != OK) {
+            ALOGE("Failed to send shared-memory transport hello: %s",
+                  statusToString(status).c_str());
+            munmap(region, sizeof(ShmRegion));
+            return nullptr;
+        }
+        if (status_t status = receiveHello(socket, fdTrigger, nullptr); status != OK) {
+            ALOGE("Server did not accept shared-memory transport: %s",
+                  statusToString(status).c_str());
+            munmap(region, sizeof(ShmRegion));
+            return nullptr;
+        }
+        return std::make_unique<RpcTransportShm>(std::move(socket), std::move(clientWake),
+                                                 std::move(serverWake), region, true);
+    }
+
+    std::unique_ptr<RpcTransport> accept(android::RpcTransportFd socket,
+                                         FdTrigger* fdTrigger) const {
+        std::vector<std::variant<unique_fd, borrowed_fd>> fds;
+        if (status_t status = receiveHello(socket, fdTrigger, &fds); status != OK) {
+            ALOGE("Failed to receive shared-memory transport hello: %s",
+                  statusToString(status).c_str());
+            return nullptr;
+        }
+        if (fds.size() != FD_COUNT) {
+            ALOGE("Expected %zu FDs with shared-memory transport hello, got %zu",
+                  static_cast<size_t>(FD_COUNT), fds.size());
+            return nullptr;
+        }
+        unique_fd memfd = std::move(std::get<unique_fd>(fds[MEMFD]));
+        unique_fd clientWake = std::move(std::get<unique_fd>(fds[CLIENT_WAKE]));
+        unique_fd serverWake = std::move(std::get<unique_fd>(fds[SERVER_WAKE]));
+
+        struct stat st;
+        int seals = fcntl(memfd.get(), F_GET_SEALS);
+        if (fstat(memfd.get(), &st) != 0 || st.st_size < static_cast<off_t>(sizeof(ShmRegion)) ||
+            seals < 0 || (seals & F_SEAL_SHRINK) == 0) {
+            ALOGE("Rejecting shared ring: size %jd seals %d", static_cast<intmax_t>(st.st_size),
+                  seals);
+            return nullptr;
+        }
+        ShmRegion* region = mapRegion(memfd);
+        if (region == nullptr) return nullptr;
+
+        if (status_t status = sendHello(socket, fdTrigger, nullptr); status != OK) {
+            ALOGE("Failed to accept shared-memory transport: %s", statusToString(status).c_str());
+            munmap(region, sizeof(ShmRegion));
+            return nullptr;
+        }
+        return std::make_unique<RpcTransportShm>(std::move(socket), std::move(serverWake),
+                                                 std::move(clientWake), region, false);
+    }
+
+    bool mIsClient;
+    std::unique_ptr<RpcTransportCtx> mRawCtx;
+};
+
+std::unique_ptr<RpcTransportCtx> RpcTransportCtxFactoryShm::newServerCtx() const {
+    return std::make_unique<RpcTransportCtxShm>(false);
+}
+
+std::unique_ptr<RpcTransportCtx> RpcTransportCtxFactoryShm::newClientCtx() const {
+    return std::make_unique<RpcTransportCtxShm>(true);
+}
+
+const char* RpcTransportCtxFactoryShm::toCString() const {
+    return "shm";
+}
+
+std::unique_ptr<RpcTransportCtxFactory> RpcTransportCtxFactoryShm::make() {
+    return std::unique_ptr<RpcTransportCtxFactoryShm>(new RpcTransportCtxFactoryShm());
+}
+
+} // namespace android
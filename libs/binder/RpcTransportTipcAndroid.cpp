@@ -78,12 +78,30 @@ public:
             FdTrigger* fdTrigger, iovec* iovs, int niovs,
             const std::optional<SmallFunction<status_t()>>& altPoll,
             const std::vector<std::variant<unique_fd, borrowed_fd>>* ancillaryFds) override {
+        // File descriptors go along with the message as shared memory, which the secure side
+        // maps instead of having the contents copied through the tipc buffers. The driver only
+        // accepts memory that it can share, such as dma-bufs.
+        trusty_shm shms[kMaxFdsPerMsg];
+        int nshms = 0;
+        if (ancillaryFds != nullptr && !ancillaryFds->empty()) {
+            if (ancillaryFds->size() > kMaxFdsPerMsg) {
+                // This shouldn't happen because we check the FD count in RpcState.
+                ALOGE("Saw too many file descriptors in RpcTransportTipcAndroid: "
+                      "%zu (max is %zu). Aborting session.",
+                      ancillaryFds->size(), kMaxFdsPerMsg);
+                return BAD_VALUE;
+            }
+            for (const auto& fd : *ancillaryFds) {
+                shms[nshms++] = trusty_shm{
+                        .fd = std::visit([](const auto& fd) { return fd.get(); }, fd),
+                        .transfer = TRUSTY_SHARE,
+                };
+            }
+        }
+
         auto writeFn = [&](iovec* iovs, size_t niovs) -> ssize_t {
-            // TODO: send ancillaryFds. For now, we just abort if anyone tries
-            // to send any.
-            LOG_ALWAYS_FATAL_IF(ancillaryFds != nullptr && !ancillaryFds->empty(),
-                                "File descriptors are not supported on Trusty yet");
-            return TEMP_FAILURE_RETRY(tipc_send(mSocket.fd.get(), iovs, niovs, nullptr, 0));
+            // tipc messages are sent whole, so the handles are never sent twice.
+            return TEMP_FAILURE_RETRY(tipc_send(mSocket.fd.get(), iovs, niovs, shms, nshms));
         };
 
         status_t status = interruptableReadOrWrite(mSocket, fdTrigger, iovs, niovs, writeFn,
@@ -188,6 +206,10 @@ private:
         }
     }
 
+    // Keep this in sync with IPC_MAX_MSG_HANDLES in trusty_ipc.h, and with the check in
+    // Parcel.cpp.
+    static constexpr size_t kMaxFdsPerMsg = 8;
+
     RpcTransportFd mSocket;
 
     // For now, we copy all the input data into a temporary buffer because
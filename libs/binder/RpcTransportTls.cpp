@@ -23,6 +23,7 @@
 #include <openssl/bn.h>
 #include <openssl/ssl.h>
 
+#include <binder/RpcThreads.h>
 #include <binder/RpcTlsUtils.h>
 #include <binder/RpcTransportTls.h>
 
@@ -30,6 +31,7 @@
 #include "RpcState.h"
 #include "Utils.h"
 
+#include <deque>
 #include <sstream>
 
 #define SHOULD_LOG_TLS_DETAIL false
@@ -459,6 +461,7 @@ public:
 
 protected:
     static ssl_verify_result_t sslCustomVerify(SSL* ssl, uint8_t* outAlert);
+    bool verifyResumedSession(Ssl* ssl) const;
     virtual void preHandshake(Ssl* ssl) const = 0;
     bssl::UniquePtr<SSL_CTX> mCtx;
     std::shared_ptr<RpcCertificateVerifier> mCertVerifier;
@@ -490,6 +493,26 @@ ssl_verify_result_t RpcTransportCtxTls::sslCustomVerify(SSL* ssl, uint8_t* outAl
     return ssl_verify_invalid;
 }
 
+// libssl only calls sslCustomVerify on full handshakes. A resumed session carries the peer
+// certificate of the connection that received its ticket, and the verifier may have stopped
+// trusting it since, so verify it again.
+bool RpcTransportCtxTls::verifyResumedSession(Ssl* ssl) const {
+    auto [reused, reusedErrorQueue] = ssl->call(SSL_session_reused);
+    reusedErrorQueue.clear();
+    if (!reused) return true;
+
+    uint8_t alert = SSL_AD_CERTIFICATE_UNKNOWN;
+    auto [verifyStatus, verifyErrorQueue] =
+            ssl->call([&](SSL* raw) { return mCertVerifier->verify(raw, &alert); });
+    verifyErrorQueue.clear();
+    if (verifyStatus != OK) {
+        ALOGE("%s: Failed to verify resumed session: status = %s, alert = %s", __func__,
+              statusToString(verifyStatus).c_str(), SSL_alert_desc_string_long(alert));
+        return false;
+    }
+    return true;
+}
+
 // Common implementation for creating server and client contexts. The child class, |Impl|, is
 // provided as a template argument so that this function can initialize an |Impl| object.
 template <typename Impl, typename>
@@ -519,6 +542,7 @@ std::unique_ptr<RpcTransportCtxTls> RpcTransportCtxTls::create(
     auto ret = std::make_unique<Impl>();
     // RpcTransportCtxTls* -> void*
     TEST_AND_RETURN(nullptr, SSL_CTX_set_app_data(ctx.get(), reinterpret_cast<void*>(ret.get())));
+    TEST_AND_RETURN(nullptr, ret->configureSessionResumption(ctx.get()));
     ret->mCtx = std::move(ctx);
     ret->mCertVerifier = std::move(verifier);
     return ret;
@@ -532,21 +556,88 @@ std::unique_ptr<RpcTransport> RpcTransportCtxTls::newTransport(android::RpcTrans
 
     preHandshake(&wrapped);
     TEST_AND_RETURN(nullptr, setFdAndDoHandshake(&wrapped, socket, fdTrigger));
+    TEST_AND_RETURN(nullptr, verifyResumedSession(&wrapped));
     return std::make_unique<RpcTransportTls>(std::move(socket), std::move(wrapped));
 }
 
 class RpcTransportCtxTlsServer : public RpcTransportCtxTls {
+public:
+    // TLS 1.3 servers issue stateless session tickets, so they only need to accept them. The
+    // session ID context is the same for every server, since tickets are already bound to the
+    // SSL_CTX that issued them.
+    bool configureSessionResumption(SSL_CTX* ctx) {
+        static constexpr uint8_t kSessionIdContext[] = {'b', 'i', 'n', 'd', 'e', 'r'};
+        return SSL_CTX_set_session_id_context(ctx, kSessionIdContext, sizeof(kSessionIdContext));
+    }
+
 protected:
     void preHandshake(Ssl* ssl) const override {
         ssl->call(SSL_set_accept_state).errorQueue.clear();
     }
 };
 
+// Keeps the session tickets the server sent on earlier connections of this context, so that
+// further connections of the session, and reconnects, resume instead of doing a full handshake.
+// The peer certificate of a resumed connection is verified again, see verifyResumedSession.
 class RpcTransportCtxTlsClient : public RpcTransportCtxTls {
+public:
+    bool configureSessionResumption(SSL_CTX* ctx) {
+        TEST_AND_RETURN(false, SSL_CTX_set_ex_data(ctx, sessionsExDataIndex(), this));
+        SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL);
+        SSL_CTX_sess_set_new_cb(ctx, onNewSession);
+        return true;
+    }
+
 protected:
     void preHandshake(Ssl* ssl) const override {
         ssl->call(SSL_set_connect_state).errorQueue.clear();
+        if (bssl::UniquePtr<SSL_SESSION> session = takeSession(); session != nullptr) {
+            LOG_TLS_DETAIL("Client: resuming TLS session");
+            ssl->call(SSL_set_session, session.get()).errorQueue.clear();
+        }
     }
+
+private:
+    // The server sends two tickets per handshake. TLS 1.3 tickets should only be used once, so
+    // a few are kept for the connections that a session opens at once.
+    static constexpr size_t kMaxSessions = 8;
+
+    // The ex_data slot of an SSL_CTX that holds its RpcTransportCtxTlsClient. Unlike the app
+    // data, which holds the base class, only client contexts set it.
+    static int sessionsExDataIndex() {
+        static const int index = SSL_CTX_get_ex_new_index(0, nullptr, nullptr, nullptr, nullptr);
+        LOG_ALWAYS_FATAL_IF(index < 0, "SSL_CTX_get_ex_new_index failed");
+        return index;
+    }
+
+    static int onNewSession(SSL* ssl, SSL_SESSION* session) {
+        auto ctx = SSL_get_SSL_CTX(ssl); // Does not set error queue
+        LOG_ALWAYS_FATAL_IF(ctx == nullptr);
+        auto client = static_cast<RpcTransportCtxTlsClient*>(
+                SSL_CTX_get_ex_data(ctx, sessionsExDataIndex()));
+        LOG_ALWAYS_FATAL_IF(client == nullptr);
+
+        client->addSession(bssl::UniquePtr<SSL_SESSION>(session));
+        return 1; // Takes ownership of |session|.
+    }
+
+    void addSession(bssl::UniquePtr<SSL_SESSION> session) const {
+        RpcMutexLockGuard _l(mSessionsMutex);
+        if (mSessions.size() == kMaxSessions) mSessions.pop_front();
+        mSessions.push_back(std::move(session));
+    }
+
+    bssl::UniquePtr<SSL_SESSION> takeSession() const {
+        RpcMutexLockGuard _l(mSessionsMutex);
+        if (mSessions.empty()) return nullptr;
+        // The newest ticket expires last.
+        bssl::UniquePtr<SSL_SESSION> session = std::move(mSessions.back());
+        mSessions.pop_back();
+        return session;
+    }
+
+    mutable RpcMutex mSessionsMutex;
+    mutable std::deque<bssl::UniquePtr<SSL_SESSION>> mSessions;
 };
 
 std::unique_ptr<RpcTransportCtx> RpcTransportCtxFactoryTls::newServerCtx() const {
@@ -0,0 +1,277 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <binder/TransactionLatencyStats.h>
+
+#include <binder/Parcel.h>
+#include <binder/RpcThreads.h>
+#include <utils/String8.h>
+
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string_view>
+#include <tuple>
+
+#ifdef __ANDROID__
+#include <cutils/properties.h>
+#endif
+
+#include "file.h"
+
+namespace android {
+
+namespace {
+
+// Latencies are bucketed by microseconds: exact below 4us, and then four
+// buckets per power of two, up to ~70 minutes. Percentiles are reported as
+// the lower bound of their bucket, so are within 25% of the real value.
+constexpr size_t kSubBucketBits = 2;
+constexpr size_t kSubBuckets = 1 << kSubBucketBits;
+constexpr size_t kBuckets = 32 * kSubBuckets;
+
+size_t bucketFor(uint64_t us) {
+    if (us < kSubBuckets) return us;
+    size_t msb = 63 - __builtin_clzll(us);
+    size_t sub = (us >> (msb - kSubBucketBits)) & (kSubBuckets - 1);
+    return std::min((msb - kSubBucketBits + 1) * kSubBuckets + sub, kBuckets - 1);
+}
+
+uint64_t bucketLowerBound(size_t bucket) {
+    if (bucket < kSubBuckets) return bucket;
+    size_t msb = bucket / kSubBuckets + kSubBucketBits - 1;
+    uint64_t sub = bucket % kSubBuckets;
+    return (kSubBuckets + sub) << (msb - kSubBucketBits);
+}
+
+struct Histogram {
+    uint64_t buckets[kBuckets] = {};
+    uint64_t count = 0;
+    uint64_t maxUs = 0;
+
+    void add(uint64_t us) {
+        buckets[bucketFor(us)]++;
+        count++;
+        maxUs = std::max(maxUs, us);
+    }
+
+    void merge(const Histogram& o) {
+        for (size_t i = 0; i < kBuckets; i++) buckets[i] += o.buckets[i];
+        count += o.count;
+        maxUs = std::max(maxUs, o.maxUs);
+    }
+
+    uint64_t percentile(uint64_t permille) const {
+        uint64_t target = (count * permille + 999) / 1000;
+        uint64_t seen = 0;
+        for (size_t i = 0; i < kBuckets; i++) {
+            seen += buckets[i];
+            if (seen >= target && seen != 0) return std::min(bucketLowerBound(i), maxUs);
+        }
+        return maxUs;
+    }
+};
+
+struct Key {
+    bool server;
+    std::u16string descriptor;
+    uint32_t code;
+};
+
+// Lookups use this form, so recording doesn't need to copy the descriptor.
+struct KeyView {
+    bool server;
+    std::u16string_view descriptor;
+    uint32_t code;
+};
+
+struct KeyLess {
+    using is_transparent = void;
+
+    template <typename A, typename B>
+    bool operator()(const A& a, const B& b) const {
+        return std::tie(a.server, a.descriptor, a.code) <
+                std::forward_as_tuple(b.server, std::u16string_view(b.descriptor), b.code);
+    }
+};
+
+using HistogramMap = std::map<Key, Histogram, KeyLess>;
+
+void mergeInto(HistogramMap* into, const HistogramMap& from) {
+    for (const auto& [key, histogram] : from) {
+        auto it = into->find(key);
+        if (it == into->end()) it = into->emplace(key, Histogram{}).first;
+        it->second.merge(histogram);
+    }
+}
+
+struct ThreadStats;
+
+struct Registry {
+    RpcMutex mutex;
+    std::set<ThreadStats*> threads;
+    // stats of threads which have exited
+    HistogramMap retired;
+};
+
+Registry& registry() {
+    [[clang::no_destroy]] static Registry sRegistry;
+    return sRegistry;
+}
+
+// Only the owning thread records into a ThreadStats, so its lock is only
+// contended by dump() and reset().
+struct ThreadStats {
+    RpcMutex mutex;
+    HistogramMap histograms;
+
+    ThreadStats() {
+        RpcMutexLockGuard _l(registry().mutex);
+        registry().threads.insert(this);
+    }
+    ~ThreadStats() {
+        RpcMutexLockGuard _l(registry().mutex);
+        registry().threads.erase(this);
+        mergeInto(&registry().retired, histograms);
+    }
+
+    void record(const KeyView& key, uint64_t us) {
+        RpcMutexLockGuard _l(mutex);
+        auto it = histograms.find(key);
+        if (it == histograms.end()) {
+            it = histograms
+                         .emplace(Key{key.server, std::u16string(key.descriptor), key.code},
+                                  Histogram{})
+                         .first;
+        }
+        it->second.add(us);
+    }
+};
+
+ThreadStats& threadStats() {
+#ifdef BINDER_RPC_SINGLE_THREADED
+    [[clang::no_destroy]] static ThreadStats sStats;
+    return sStats;
+#else
+    thread_local ThreadStats tStats;
+    return tStats;
+#endif
+}
+
+std::atomic<int> gEnabled = -1; // -1: not read from the system property yet
+
+void record(bool server, std::u16string_view descriptor, uint32_t code,
+            std::chrono::steady_clock::time_point start) {
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    uint64_t us = std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+    threadStats().record(KeyView{server, descriptor, code}, us);
+}
+
+} // namespace
+
+void TransactionLatencyStats::setEnabled(bool enabled) {
+    gEnabled.store(enabled ? 1 : 0, std::memory_order_relaxed);
+}
+
+bool TransactionLatencyStats::isEnabled() {
+    int enabled = gEnabled.load(std::memory_order_relaxed);
+    if (enabled >= 0) [[likely]] {
+        return enabled;
+    }
+#ifdef __ANDROID__
+    enabled = property_get_bool("binder.latency_stats.enabled", false) ? 1 : 0;
+#else
+    enabled = 0;
+#endif
+    int expected = -1;
+    gEnabled.compare_exchange_strong(expected, enabled, std::memory_order_relaxed);
+    return gEnabled.load(std::memory_order_relaxed);
+}
+
+void TransactionLatencyStats::recordClient(const String16& descriptor, const Parcel& data,
+                                           uint32_t code,
+                                           std::chrono::steady_clock::time_point start) {
+    std::u16string_view view(descriptor.c_str(), descriptor.size());
+    if (view.empty()) {
+        // Proxies only cache a descriptor once someone asks for it, but user
+        // transactions carry it after the request header.
+        if (const auto* kernelFields = data.maybeKernelFields();
+            kernelFields != nullptr && kernelFields->mRequestHeaderPresent) {
+            size_t pos = data.dataPosition();
+            // skip the work source and the vendor header
+            data.setDataPosition(kernelFields->mWorkSourceRequestHeaderPosition +
+                                 2 * sizeof(int32_t));
+            size_t len;
+            if (const char16_t* str = data.readString16Inplace(&len); str != nullptr) {
+                view = std::u16string_view(str, len);
+            }
+            data.setDataPosition(pos);
+        }
+    }
+    record(false /*server*/, view, code, start);
+}
+
+void TransactionLatencyStats::recordServer(const String16& descriptor, uint32_t code,
+                                           std::chrono::steady_clock::time_point start) {
+    record(true /*server*/, std::u16string_view(descriptor.c_str(), descriptor.size()), code,
+           start);
+}
+
+void TransactionLatencyStats::reset() {
+    Registry& r = registry();
+    RpcMutexLockGuard _l(r.mutex);
+    r.retired.clear();
+    for (ThreadStats* thread : r.threads) {
+        RpcMutexLockGuard _t(thread->mutex);
+        thread->histograms.clear();
+    }
+}
+
+std::string TransactionLatencyStats::dump() {
+    HistogramMap all;
+    {
+        Registry& r = registry();
+        RpcMutexLockGuard _l(r.mutex);
+        all = r.retired;
+        for (ThreadStats* thread : r.threads) {
+            RpcMutexLockGuard _t(thread->mutex);
+            mergeInto(&all, thread->histograms);
+        }
+    }
+
+    std::stringstream ss;
+    ss << "Binder transaction latency (us)" << (isEnabled() ? "" : ", collection disabled")
+       << ":\n";
+    for (const auto& [key, histogram] : all) {
+        String8 descriptor(key.descriptor.data(), key.descriptor.size());
+        ss << "  " << (key.server ? "server " : "client ")
+           << (descriptor.empty() ? "(unknown)" : descriptor.c_str()) << " code " << key.code
+           << ": count " << histogram.count << " p50 " << histogram.percentile(500) << " p90 "
+           << histogram.percentile(900) << " p99 " << histogram.percentile(990) << " max "
+           << histogram.maxUs << "\n";
+    }
+    return ss.str();
+}
+
+status_t TransactionLatencyStats::dump(int fd) {
+    std::string out = dump();
+    if (!binder::WriteFully(fd, out.data(), out.size())) return -errno;
+    return OK;
+}
+
+} // namespace android
@@ -21,6 +21,7 @@
 #include <binder/RpcThreads.h>
 #include <binder/unique_fd.h>
 
+#include <atomic>
 #include <map>
 #include <optional>
 #include <unordered_map>
@@ -96,6 +97,14 @@ public:
     LIBBINDER_EXPORTED static void setBinderProxyCountWatermarks(int high, int low, int warning);
     LIBBINDER_EXPORTED static uint32_t getBinderProxyCount();
 
+    // Returns a copy of |descriptor| that shares its buffer with every other descriptor interned
+    // with the same contents, so that interned descriptors can be compared by pointer first.
+    // Only descriptors of local interfaces, such as AIBinder_Class, should be interned. Proxies
+    // share an interned buffer when their descriptor has one, but don't add theirs, since they
+    // come from the remote side. The table is bounded, and descriptors past the limit are
+    // returned as they are.
+    LIBBINDER_EXPORTED static String16 internDescriptor(const String16& descriptor);
+
     LIBBINDER_EXPORTED std::optional<int32_t> getDebugBinderHandle() const;
 
     // Start recording transactions to the unique_fd.
@@ -218,6 +227,8 @@ private:
 
     void reportOneDeath(const Obituary& obit);
     bool isDescriptorCached() const;
+    // Returns the interned copy of |descriptor| if there is one, or |descriptor| otherwise.
+    static String16 findInternedDescriptor(const String16& descriptor);
 
     mutable RpcMutex mLock;
     volatile int32_t mAlive;
@@ -226,6 +237,8 @@ private:
     std::unique_ptr<FrozenStateChange> mFrozen;
     ObjectManager mObjects;
     mutable String16 mDescriptorCache;
+    // Set once mDescriptorCache is assigned, after which it never changes.
+    mutable std::atomic_bool mDescriptorCached;
     int32_t mTrackedUid;
 
     static RpcMutex sTrackingLock;
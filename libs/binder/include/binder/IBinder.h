@@ -59,6 +59,7 @@ public:
         START_RECORDING_TRANSACTION = B_PACK_CHARS('_', 'S', 'R', 'D'),
         STOP_RECORDING_TRANSACTION = B_PACK_CHARS('_', 'E', 'R', 'D'),
         DUMP_TRANSACTION = B_PACK_CHARS('_', 'D', 'M', 'P'),
+        DUMP_LATENCY_TRANSACTION = B_PACK_CHARS('_', 'L', 'A', 'T'),
         SHELL_COMMAND_TRANSACTION = B_PACK_CHARS('_', 'C', 'M', 'D'),
         INTERFACE_TRANSACTION = B_PACK_CHARS('_', 'N', 'T', 'F'),
         SYSPROPS_TRANSACTION = B_PACK_CHARS('_', 'S', 'P', 'R'),
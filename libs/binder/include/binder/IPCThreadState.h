@@ -22,6 +22,10 @@
 #include <utils/Errors.h>
 #include <utils/Vector.h>
 
+#include <chrono>
+#include <memory>
+#include <vector>
+
 #if defined(_WIN32)
 typedef  int  uid_t;
 #endif
@@ -166,6 +170,18 @@ public:
     LIBBINDER_EXPORTED status_t transact(int32_t handle, uint32_t code, const Parcel& data,
                                          Parcel* reply, uint32_t flags);
 
+    // Oneway transactions made on this thread after beginOnewayBatch() are
+    // queued and submitted to the driver with a single BINDER_WRITE_READ by
+    // the matching flushOnewayBatch(). The Parcels are copied into the batch,
+    // so callers may destroy them as soon as transact returns. A two-way
+    // transaction or a reply made while the batch is open submits it first.
+    //
+    // Batches may be nested; only the outermost flushOnewayBatch() submits.
+    // It returns the first error the driver reported for any transaction in
+    // the batch.
+    LIBBINDER_EXPORTED void beginOnewayBatch();
+    LIBBINDER_EXPORTED status_t flushOnewayBatch();
+
     LIBBINDER_EXPORTED void incStrongHandle(int32_t handle, BpBinder* proxy);
     LIBBINDER_EXPORTED void decStrongHandle(int32_t handle);
     LIBBINDER_EXPORTED void incWeakHandle(int32_t handle, BpBinder* proxy);
@@ -218,6 +234,11 @@ private:
     [[nodiscard]] status_t writeTransactionData(int32_t cmd, uint32_t binderFlags, int32_t handle,
                                                 uint32_t code, const Parcel& data,
                                                 status_t* statusBuffer);
+    [[nodiscard]] status_t queueOnewayTransaction(int32_t handle, uint32_t code,
+                                                  const Parcel& data, uint32_t flags);
+    void submitOnewayBatch();
+    std::unique_ptr<Parcel> acquireReplyParcel();
+    void releaseReplyParcel(std::unique_ptr<Parcel> parcel);
     [[nodiscard]] status_t getAndExecuteCommand();
     [[nodiscard]] status_t executeCommand(int32_t command);
     void processPendingDerefs();
@@ -249,11 +270,21 @@ private:
             // Whether the work source should be propagated.
             bool                mPropagateWorkSource;
             bool                mIsLooper;
+            // When the last command was read from the driver, only kept while
+            // idle threads may leave the thread pool.
+            std::chrono::steady_clock::time_point mCommandReadTime;
             bool mIsFlushing;
             bool mHasExplicitIdentity;
             int32_t             mStrictModePolicy;
             int32_t             mLastTransactionBinderFlags;
             CallRestriction     mCallRestriction;
+            size_t mOnewayBatchDepth;
+            status_t mOnewayBatchStatus;
+            // Keeps the data referenced by the queued BC_TRANSACTIONs alive.
+            std::vector<std::unique_ptr<Parcel>> mOnewayBatch;
+            // Reply parcels for incoming transactions, reused so that their
+            // buffers don't need to be reallocated for every transaction.
+            std::vector<std::unique_ptr<Parcel>> mReplyParcelPool;
 };
 
 } // namespace android
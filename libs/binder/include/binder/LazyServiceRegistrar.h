@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include <chrono>
 #include <functional>
 
 #include <binder/Common.h>
@@ -95,6 +96,44 @@ public:
      */
     LIBBINDER_EXPORTED void reRegister();
 
+    /**
+     * Keep the process running for 'delay' once its services have no clients, instead of
+     * shutting it down right away, so that a client that comes back soon does not wait for the
+     * process to start again. If clients keep coming back, the process waits for about twice the
+     * average time they took to do so, up to 'maxDelay'. The default is no delay.
+     *
+     * With a 'delay' of std::chrono::milliseconds::max(), the process only shuts down when
+     * 'shutdownIfIdle' is called, for instance from a memory pressure handler.
+     *
+     * This has no effect while 'forcePersist' is set, or when the callback registered by
+     * setActiveServicesCallback handles the shutdown.
+     */
+    LIBBINDER_EXPORTED void setShutdownDelay(std::chrono::milliseconds delay,
+                                             std::chrono::milliseconds maxDelay = {});
+
+    /**
+     * Shut the process down now if its services have no clients, without waiting for the delay
+     * set by 'setShutdownDelay'. Returns 'false' if the process keeps running.
+     */
+    LIBBINDER_EXPORTED bool shutdownIfIdle();
+
+    struct Stats {
+        // Time from the start of the process to its first service being registered, or zero if
+        // it is unknown.
+        std::chrono::milliseconds startupTime{0};
+        // Number of times the services ran out of clients.
+        size_t idlePeriods = 0;
+        // Number of those that ended with a client coming back during the shutdown delay.
+        size_t reconnectsDuringDelay = 0;
+        // Average time it took a client to come back, weighted towards recent idle periods.
+        std::chrono::milliseconds averageIdleTime{0};
+    };
+
+    /**
+     * Statistics to tune 'setShutdownDelay' with.
+     */
+    LIBBINDER_EXPORTED Stats getStats();
+
     /**
      * Create a second instance of lazy service registrar.
      *
@@ -54,6 +54,7 @@ class ProcessState;
 class RpcSession;
 class String8;
 class TextOutput;
+class TransactionLatencyStats;
 namespace binder {
 class Status;
 namespace debug {
@@ -64,6 +65,7 @@ class RecordedTransaction;
 class Parcel {
     friend class IPCThreadState;
     friend class RpcState;
+    friend class TransactionLatencyStats;
 
 public:
     class ReadableBlob;
@@ -87,6 +89,10 @@ public:
     // Writing over objects, such as file descriptors and binders, is not supported.
     LIBBINDER_EXPORTED void setDataPosition(size_t pos) const;
     LIBBINDER_EXPORTED status_t setDataCapacity(size_t size);
+    // Makes sure |len| more bytes can be written at the current position
+    // without growing the buffer again. Use when the serialized size is known
+    // ahead of time.
+    LIBBINDER_EXPORTED status_t reserve(size_t len);
 
     LIBBINDER_EXPORTED status_t setData(const uint8_t* buffer, size_t len);
 
@@ -164,6 +170,10 @@ public:
     LIBBINDER_EXPORTED bool isServiceFuzzing() const;
 
     LIBBINDER_EXPORTED void freeData();
+    // Like freeData(), but keeps the data buffer for reuse if its capacity is
+    // at most |maxRetainedCapacity|. Parcels that reference memory they don't
+    // own, are marked sensitive or are used for RPC are always freed.
+    LIBBINDER_EXPORTED void recycle(size_t maxRetainedCapacity);
 
     LIBBINDER_EXPORTED size_t objectsCount() const;
 
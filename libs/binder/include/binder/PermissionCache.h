@@ -21,10 +21,15 @@
 #include <stdint.h>
 #include <unistd.h>
 
-#include <utils/String16.h>
+#include <atomic>
+
+#include <binder/Common.h>
+#include <binder/IBinder.h>
+#include <utils/Mutex.h>
 #include <utils/Singleton.h>
 #include <utils/SortedVector.h>
-#include <binder/Common.h>
+#include <utils/String16.h>
+#include <utils/Timers.h>
 
 namespace android {
 // ---------------------------------------------------------------------------
@@ -32,8 +37,10 @@ namespace android {
 /*
  * PermissionCache caches permission checks for a given uid.
  *
- * Currently the cache is not updated when there is a permission change,
- * for instance when an application is uninstalled.
+ * The cache is purged when the permission controller dies, but it is not
+ * otherwise updated when there is a permission change, for instance when an
+ * application is uninstalled. Services which learn of such changes can call
+ * purgeCache() or purgeUid(), e.g. when a uid is gone.
  *
  * IMPORTANT: for the reason stated above, only system permissions are safe
  * to cache. This restriction may be lifted at a later time.
@@ -41,29 +48,74 @@ namespace android {
  */
 
 class PermissionCache : Singleton<PermissionCache> {
-    struct Entry {
-        String16    name;
-        uid_t       uid;
-        bool        granted;
-        inline bool operator < (const Entry& e) const {
-            return (uid == e.uid) ? (name < e.name) : (uid < e.uid);
-        }
+    friend class PermissionCacheTest;
+
+    // Permission names are interned, so that entries can refer to them by index. The first
+    // mPermissionNameCount names are only modified while the names are reset, so they are read
+    // without the lock. When the table is full, the cache is purged and the names are reset.
+    static constexpr size_t kMaxPermissionNames = 256;
+    struct PermissionName {
+        size_t hash = 0;
+        String16 name;
+    };
+    PermissionName mPermissionNames[kMaxPermissionNames];
+    std::atomic<size_t> mPermissionNameCount = 0;
+    // Incremented before and after the names are reset, so it is odd while they are. Checks miss
+    // while it is odd, or if it changes during the check.
+    std::atomic<uint32_t> mPermissionNameGeneration = 0;
+
+    // Entries are sharded by uid, so that checks for different callers don't share cache lines.
+    // Each shard is an open-addressed table of entries, which are only ever written as a whole
+    // under mLock, so checks don't take a lock. Once the probe sequence of a new entry is full,
+    // the entry replaces the one in its first slot.
+    static constexpr size_t kShardCount = 16;
+    static constexpr size_t kSlotsPerShard = 64;
+    struct alignas(64) Shard {
+        // Each slot is 0, or holds kSlotValid | (granted ? kSlotGranted : 0) | name index << 2 |
+        // uid << 32.
+        std::atomic<uint64_t> slots[kSlotsPerShard] = {};
+        mutable std::atomic<uint64_t> hits = 0;
+        mutable std::atomic<uint64_t> misses = 0;
+        // The checks of this shard reading the permission names, which a reset waits for.
+        mutable std::atomic<uint32_t> readers = 0;
     };
+    static constexpr uint64_t kSlotValid = 1;
+    static constexpr uint64_t kSlotGranted = 2;
+    Shard mShards[kShardCount];
+
+    // Guards writes to the entries and permission names.
     mutable Mutex mLock;
-    // we pool all the permission names we see, as many permissions checks
-    // will have identical names
-    SortedVector< String16 > mPermissionNamesPool;
-    // this is our cache per say. it stores pooled names.
-    SortedVector< Entry > mCache;
+
+    // Whether the cache is purged when the permission controller dies. Watching is retried at most
+    // once per kWatchRetryInterval, rather than on every miss.
+    std::atomic<bool> mWatchingPermissionController = false;
+    static constexpr nsecs_t kWatchRetryInterval = s2ns(1);
+    std::atomic<nsecs_t> mNextWatchAttempt = 0;
+    sp<IBinder::DeathRecipient> mPermissionControllerDeathRecipient;
 
     // free the whole cache, but keep the permission name pool
     void purge();
+    void purgeLocked();
+    void purgeUidLocked(uid_t uid);
 
     status_t check(bool* granted,
             const String16& permission, uid_t uid) const;
 
     void cache(const String16& permission, uid_t uid, bool granted);
 
+    // Returns the index of the interned permission name, or -1 if it hasn't been interned.
+    ssize_t findPermissionName(const String16& permission, size_t hash) const;
+    // Purges the cache and drops all permission names.
+    void resetPermissionNamesLocked();
+    static uint64_t slotKey(size_t nameIndex, uid_t uid);
+    static size_t firstSlot(uint64_t key);
+    const Shard& shardFor(uid_t uid) const { return mShards[uid % kShardCount]; }
+    Shard& shardFor(uid_t uid) { return mShards[uid % kShardCount]; }
+    void insertLocked(Shard& shard, uint64_t slot);
+
+    void watchPermissionController();
+    void onPermissionControllerDied();
+
 public:
     LIBBINDER_EXPORTED PermissionCache();
 
@@ -76,6 +128,16 @@ public:
                                                    uid_t uid);
 
     LIBBINDER_EXPORTED static void purgeCache();
+
+    // Drops the cached checks of one uid, e.g. after its permissions changed.
+    LIBBINDER_EXPORTED static void purgeUid(uid_t uid);
+
+    struct Stats {
+        uint64_t hits;
+        uint64_t misses;
+        size_t entries;
+    };
+    LIBBINDER_EXPORTED static Stats getStats();
 };
 
 // ---------------------------------------------------------------------------
@@ -17,6 +17,7 @@
 #pragma once
 
 #include <map>
+#include <memory>
 #include <set>
 #include <vector>
 
@@ -94,6 +95,9 @@ public:
     std::set<String16> getPersistableBundleKeys() const;
 
     friend bool operator==(const PersistableBundle& lhs, const PersistableBundle& rhs) {
+        if (!lhs.mLazyEntries.empty() || !rhs.mLazyEntries.empty()) {
+            return lhs.decodeAll() == rhs.decodeAll();
+        }
         return (lhs.mBoolMap == rhs.mBoolMap && lhs.mIntMap == rhs.mIntMap &&
                 lhs.mLongMap == rhs.mLongMap && lhs.mDoubleMap == rhs.mDoubleMap &&
                 lhs.mStringMap == rhs.mStringMap && lhs.mBoolVectorMap == rhs.mBoolVectorMap &&
@@ -111,6 +115,12 @@ public:
 private:
     status_t writeToParcelInner(Parcel* parcel) const;
     status_t readFromParcelInner(const Parcel* parcel, size_t length);
+    status_t indexFromParcel(const Parcel* parcel, size_t length);
+
+    template <typename T>
+    bool getLazyValue(const String16& key, int32_t type, T* out) const;
+    std::set<String16> getLazyKeys(int32_t type) const;
+    PersistableBundle decodeAll() const;
 
     std::map<String16, bool> mBoolMap;
     std::map<String16, int32_t> mIntMap;
@@ -123,6 +133,21 @@ private:
     std::map<String16, std::vector<double>> mDoubleVectorMap;
     std::map<String16, std::vector<String16>> mStringVectorMap;
     std::map<String16, PersistableBundle> mPersistableBundleMap;
+
+    /*
+     * A bundle read into an empty PersistableBundle is not decoded right away. Its bytes are
+     * copied into mLazyData, and mLazyEntries maps each key to the type and position of its
+     * value there. Getters decode values on access, and writeToParcel() copies them back
+     * verbatim. A key is held either in one of the typed maps or in mLazyEntries, never both.
+     */
+    struct LazyData;
+    struct LazyEntry {
+        int32_t type;
+        size_t position;
+        size_t size;
+    };
+    std::shared_ptr<LazyData> mLazyData;
+    std::map<String16, LazyEntry> mLazyEntries;
 };
 
 }  // namespace os
@@ -66,6 +66,21 @@ public:
     // threads started by 'startThreadPool' or 'joinRpcThreadpool'.
     LIBBINDER_EXPORTED status_t setThreadPoolMaxThreadCount(size_t maxThreads);
 
+    // Lets kernel-started threads leave the threadpool, so that the pool
+    // shrinks back after a burst of incoming calls instead of keeping every
+    // thread it ever started. A thread leaves once it finishes a command it
+    // waited at least 'minIdleTime' for, while more than 'maxIdleThreads'
+    // threads of the pool are idle and more than 'minThreads' threads are in
+    // the pool. The kernel starts threads again on demand, up to the count
+    // set in setThreadPoolMaxThreadCount.
+    //
+    // By default, threads never leave the threadpool. Like
+    // setThreadPoolMaxThreadCount, this is for programs to configure, not
+    // libraries.
+    LIBBINDER_EXPORTED void setThreadPoolMaxIdleThreadCount(
+            size_t maxIdleThreads, size_t minThreads = 1,
+            std::chrono::milliseconds minIdleTime = std::chrono::seconds(10));
+
     // Libraries should not call this, as processes should configure
     // threadpools themselves. Should be called in the main function
     // directly before any code executes or joins the threadpool.
@@ -125,6 +140,23 @@ public:
      */
     LIBBINDER_EXPORTED size_t getThreadPoolMaxTotalThreadCount() const;
 
+    struct ThreadPoolStats {
+        // Threads currently inside the thread pool.
+        size_t threads;
+        // Threads currently executing a command.
+        size_t executingThreads;
+        // Highest number of threads that executed commands at the same time.
+        size_t peakExecutingThreads;
+        // Kernel-started threads that left the thread pool while idle.
+        size_t exitedIdleThreads;
+    };
+
+    /**
+     * Snapshot of the thread pool usage, e.g. to tune the counts passed to
+     * setThreadPoolMaxThreadCount and setThreadPoolMaxIdleThreadCount.
+     */
+    LIBBINDER_EXPORTED ThreadPoolStats getThreadPoolStats() const;
+
     /**
      * Check to see if the thread pool has started.
      */
@@ -155,12 +187,25 @@ private:
     ProcessState& operator=(const ProcessState& o);
     String8 makeBinderThreadName();
 
+    // Whether kernel-started threads may leave the thread pool, in which case
+    // they time how long they wait for commands.
+    bool canIdleThreadsExit() const;
+    // Called by a kernel-started thread after it executed a command it waited
+    // 'idleTime' for. Returns whether the thread should leave the thread
+    // pool, in which case it has been removed from mCurrentThreads.
+    bool shouldIdleThreadExit(std::chrono::steady_clock::duration idleTime);
+    // Called by a kernel-started thread once it left the thread pool after
+    // shouldIdleThreadExit returned true.
+    void onIdleThreadExited();
+
     struct handle_entry {
         IBinder* binder;
         RefBase::weakref_type* refs;
     };
 
-    handle_entry* lookupHandleLocked(int32_t handle);
+    // Returns the entry of a handle, whose fields are guarded by handleLock(handle).
+    handle_entry* lookupHandle(int32_t handle);
+    std::mutex& handleLock(int32_t handle);
 
     String8 mDriverName;
     int mDriverFD;
@@ -179,14 +224,33 @@ private:
     std::atomic_size_t mCurrentThreads;
     // Current number of pooled threads inside the thread pool.
     std::atomic_size_t mKernelStartedThreads;
+    // Highest value of mExecutingThreadsCount so far.
+    std::atomic_size_t mPeakExecutingThreadsCount;
+    // Kernel-started threads leave the pool when more threads are idle, if
+    // they were idle for mMinIdleTime and the pool keeps mMinThreads.
+    std::atomic_size_t mMaxIdleThreads;
+    std::atomic_size_t mMinThreads;
+    std::atomic<std::chrono::steady_clock::duration> mMinIdleTime;
+    // Number of kernel-started threads that left the pool while idle.
+    std::atomic_size_t mExitedIdleThreads;
     // Time when thread pool was emptied
     std::atomic<std::chrono::steady_clock::time_point> mStarvationStartTime;
 
     static constexpr auto never = &std::chrono::steady_clock::time_point::min;
 
-    mutable std::mutex mLock; // protects everything below.
+    // Entries of handles live in segments that never move once allocated, so
+    // lookupHandle only takes a lock to allocate a segment. Segment k holds
+    // the kFirstHandleSegmentSize << k handles following those of segment k-1.
+    static constexpr size_t kFirstHandleSegmentSize = 64;
+    static constexpr size_t kHandleSegmentCount = 26; // Enough for every int32_t handle.
+    std::atomic<handle_entry*> mHandleSegments[kHandleSegmentCount] = {};
+    std::mutex mHandleSegmentsLock;
 
-    Vector<handle_entry> mHandleToObject;
+    // Threads looking up different handles rarely contend on the same lock.
+    static constexpr size_t kHandleLockCount = 16;
+    std::mutex mHandleLocks[kHandleLockCount];
+
+    mutable std::mutex mLock; // protects everything below.
 
     bool mForked;
     std::atomic_bool mThreadPoolStarted;
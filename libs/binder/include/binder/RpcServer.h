@@ -267,6 +267,7 @@ private:
             std::function<void(sp<RpcSession>&&, RpcSession::PreJoinSetupResult&&)>&& joinFn);
     static status_t acceptSocketConnection(const RpcServer& server, RpcTransportFd* out);
     static status_t recvmsgSocketConnection(const RpcServer& server, RpcTransportFd* out);
+    void acceptConnection(RpcTransportFd clientSocket);
 
     [[nodiscard]] status_t setupSocketServer(const RpcSocketAddress& address);
 
@@ -292,6 +293,8 @@ private:
     std::unique_ptr<FdTrigger> mShutdownTrigger;
     RpcConditionVariable mShutdownCv;
     std::function<status_t(const RpcServer& server, RpcTransportFd* out)> mAcceptFn;
+    // Whether mAcceptFn returns WOULD_BLOCK rather than blocking once no connection is pending.
+    bool mAcceptUntilWouldBlock = false;
 };
 
 } // namespace android
@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <binder/Common.h>
+#include <utils/Errors.h>
+#include <utils/String16.h>
+
+#include <chrono>
+#include <string>
+
+namespace android {
+
+class Parcel;
+
+/**
+ * Process-wide histograms of binder transaction latency, keyed by interface
+ * descriptor and transaction code, for both outgoing (client) and incoming
+ * (server) transactions.
+ *
+ * Collection is off by default, and may be enabled with setEnabled() or by
+ * setting the system property binder.latency_stats.enabled before the first
+ * transaction of the process. Each thread accumulates into its own table, so
+ * recording never contends with other transacting threads.
+ *
+ * Stats for a process may be read with `dumpsys --latency SERVICE`.
+ */
+class TransactionLatencyStats {
+public:
+    LIBBINDER_EXPORTED static void setEnabled(bool enabled);
+    LIBBINDER_EXPORTED static bool isEnabled();
+
+    /**
+     * Drops everything collected so far.
+     */
+    LIBBINDER_EXPORTED static void reset();
+
+    /**
+     * Count, p50, p90, p99 and max latency of each (side, descriptor, code).
+     */
+    LIBBINDER_EXPORTED static std::string dump();
+    LIBBINDER_EXPORTED static status_t dump(int fd);
+
+    // Used by libbinder to record a transaction which started at `start`.
+    // `data` is used to find the descriptor for proxies which haven't cached one.
+    static void recordClient(const String16& descriptor, const Parcel& data, uint32_t code,
+                             std::chrono::steady_clock::time_point start);
+    static void recordServer(const String16& descriptor, uint32_t code,
+                             std::chrono::steady_clock::time_point start);
+};
+
+} // namespace android
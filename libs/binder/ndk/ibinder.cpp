@@ -18,6 +18,7 @@
 #include <android/binder_ibinder_platform.h>
 #include <android/binder_stability.h>
 #include <android/binder_status.h>
+#include <binder/BpBinder.h>
 #include <binder/IPCThreadState.h>
 #include <binder/IResultReceiver.h>
 #if __has_include(<private/android_filesystem_config.h>)
@@ -139,8 +140,11 @@ bool AIBinder::associateClass(const AIBinder_Class* clazz) {
     // This will always be an O(n) comparison, but it's expected to be extremely rare.
     // since it's an error condition. Do the comparison after we take the lock and
     // check the pointer equality fast path. By always taking the lock, it's also
-    // more flake-proof. However, the check is not dependent on the lock.
-    if (descriptor != newDescriptor && !(asABpBinder() && asABpBinder()->isServiceFuzzing())) {
+    // more flake-proof. However, the check is not dependent on the lock. Class and
+    // proxy descriptors are both interned, so matching ones usually share a buffer.
+    bool sameDescriptor =
+            descriptor.c_str() == newDescriptor.c_str() || descriptor == newDescriptor;
+    if (!sameDescriptor && !(asABpBinder() && asABpBinder()->isServiceFuzzing())) {
         if (getBinder()->isBinderAlive()) {
             ALOGE("%s: Expecting binder to have class '%s' but descriptor is actually '%s'.",
                   __func__, String8(newDescriptor).c_str(), SanitizeString(descriptor).c_str());
@@ -383,7 +387,9 @@ AIBinder_Class::AIBinder_Class(const char* interfaceDescriptor, AIBinder_Class_o
       onDestroy(onDestroy),
       onTransact(onTransact),
       mInterfaceDescriptor(interfaceDescriptor),
-      mWideInterfaceDescriptor(interfaceDescriptor) {}
+      // Interned, so that it shares its buffer with the descriptors proxies cache.
+      mWideInterfaceDescriptor(
+              ::android::BpBinder::internDescriptor(String16(interfaceDescriptor))) {}
 
 AIBinder_Class* AIBinder_Class_define(const char* interfaceDescriptor,
                                       AIBinder_Class_onCreate onCreate,
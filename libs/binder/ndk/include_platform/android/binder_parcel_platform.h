@@ -31,6 +31,33 @@ __BEGIN_DECLS
  */
 bool AParcel_getAllowFds(const AParcel*);
 
+/**
+ * Writes a blob of bytes, like Parcel::writeBlob. Unlike AParcel_writeByteArray, a blob larger
+ * than 16KB is copied to an immutable shared memory region that is sent as a file descriptor if
+ * the parcel allows FDs, so it does not count against the binder transaction buffer and the
+ * driver does not copy it again. Smaller blobs are written in place.
+ *
+ * \param parcel the parcel to write to.
+ * \param data the bytes to write, may be null if length is 0.
+ * \param length the number of bytes to write.
+ *
+ * \return STATUS_OK on successful write.
+ */
+binder_status_t AParcel_writeBlob(AParcel* parcel, const int8_t* data, int32_t length);
+
+/**
+ * Reads a blob written by AParcel_writeBlob.
+ *
+ * \param parcel the parcel to read from.
+ * \param arrayData some external representation of an array.
+ * \param allocator the callback that will be called to allocate the array, which is never
+ * called with a negative length.
+ *
+ * \return STATUS_OK on successful read.
+ */
+binder_status_t AParcel_readBlob(const AParcel* parcel, void* arrayData,
+                                 AParcel_byteArrayAllocator allocator);
+
 #endif
 
 /**
@@ -23,6 +23,9 @@
 #include <utils/Unicode.h>
 
 #include <limits>
+#include <memory>
+#include <type_traits>
+#include <vector>
 
 #include "ibinder_internal.h"
 #include "parcel_internal.h"
@@ -104,14 +107,14 @@ binder_status_t WriteArray<char16_t>(AParcel* parcel, const char16_t* array, int
     if (length <= 0) return STATUS_OK;
 
     int32_t size = 0;
-    if (__builtin_smul_overflow(sizeof(char16_t), length, &size)) return STATUS_NO_MEMORY;
+    if (__builtin_smul_overflow(sizeof(int32_t), length, &size)) return STATUS_NO_MEMORY;
 
-    Parcel* rawParcel = parcel->get();
+    // Reserve the whole array once rather than bounds checking each writeChar.
+    int32_t* data = reinterpret_cast<int32_t*>(parcel->get()->writeInplace(size));
+    if (data == nullptr) return STATUS_NO_MEMORY;
 
     for (int32_t i = 0; i < length; i++) {
-        status = rawParcel->writeChar(array[i]);
-
-        if (status != STATUS_OK) return PruneStatusT(status);
+        data[i] = static_cast<int32_t>(array[i]);
     }
 
     return STATUS_OK;
@@ -174,12 +177,13 @@ binder_status_t ReadArray<char16_t>(const AParcel* parcel, void* arrayData,
     if (array == nullptr) return STATUS_NO_MEMORY;
 
     int32_t size = 0;
-    if (__builtin_smul_overflow(sizeof(char16_t), length, &size)) return STATUS_NO_MEMORY;
+    if (__builtin_smul_overflow(sizeof(int32_t), length, &size)) return STATUS_NO_MEMORY;
 
-    for (int32_t i = 0; i < length; i++) {
-        status_t status = rawParcel->readChar(array + i);
+    const int32_t* data = reinterpret_cast<const int32_t*>(rawParcel->readInplace(size));
+    if (data == nullptr) return STATUS_NO_MEMORY;
 
-        if (status != STATUS_OK) return PruneStatusT(status);
+    for (int32_t i = 0; i < length; i++) {
+        array[i] = static_cast<char16_t>(data[i]);
     }
 
     return STATUS_OK;
@@ -196,6 +200,18 @@ binder_status_t WriteArray(AParcel* parcel, const void* arrayData, int32_t lengt
 
     Parcel* rawParcel = parcel->get();
 
+    if constexpr (std::is_same_v<T, bool>) {
+        // bools are written as int32_t; reserve the whole array at once.
+        int32_t size = 0;
+        if (__builtin_smul_overflow(sizeof(int32_t), length, &size)) return STATUS_NO_MEMORY;
+        int32_t* data = reinterpret_cast<int32_t*>(rawParcel->writeInplace(size));
+        if (data == nullptr) return STATUS_NO_MEMORY;
+        for (int32_t i = 0; i < length; i++) {
+            data[i] = static_cast<int32_t>(getter(arrayData, i));
+        }
+        return STATUS_OK;
+    }
+
     for (int32_t i = 0; i < length; i++) {
         status = (rawParcel->*write)(getter(arrayData, i));
 
@@ -225,6 +241,17 @@ binder_status_t ReadArray(const AParcel* parcel, void* arrayData, ArrayAllocator
 
     if (length <= 0) return STATUS_OK;
 
+    if constexpr (std::is_same_v<T, bool>) {
+        int32_t size = 0;
+        if (__builtin_smul_overflow(sizeof(int32_t), length, &size)) return STATUS_NO_MEMORY;
+        const int32_t* data = reinterpret_cast<const int32_t*>(rawParcel->readInplace(size));
+        if (data == nullptr) return STATUS_NO_MEMORY;
+        for (int32_t i = 0; i < length; i++) {
+            setter(arrayData, i, data[i] != 0);
+        }
+        return STATUS_OK;
+    }
+
     for (int32_t i = 0; i < length; i++) {
         T readTarget;
         status_t status = (rawParcel->*read)(&readTarget);
@@ -236,6 +263,57 @@ binder_status_t ReadArray(const AParcel* parcel, void* arrayData, ArrayAllocator
     return STATUS_OK;
 }
 
+#ifdef BINDER_WITH_KERNEL_IPC
+namespace {
+
+// Holds the Parcels of AParcels destroyed on this thread for the next ones created on it. Only
+// kernel binder parcels are recycled, so builds without it don't need thread-local storage.
+struct ParcelPool {
+    // A transaction needs an in and an out parcel, and nested transactions need their own.
+    static constexpr size_t kMaxPooledParcels = 4;
+    // Larger parcels are rare enough that holding on to their buffers isn't worth it.
+    static constexpr size_t kMaxRetainedCapacity = 16 * 1024;
+
+    ~ParcelPool() { tPoolDestroyed = true; }
+
+    std::vector<std::unique_ptr<Parcel>> parcels;
+    // AParcels may still be destroyed after the pool during thread exit.
+    static thread_local bool tPoolDestroyed;
+};
+
+thread_local bool ParcelPool::tPoolDestroyed = false;
+thread_local ParcelPool tParcelPool;
+
+}  // namespace
+
+Parcel* AParcel::acquireParcel() {
+    if (ParcelPool::tPoolDestroyed || tParcelPool.parcels.empty()) {
+        return new Parcel;
+    }
+    Parcel* parcel = tParcelPool.parcels.back().release();
+    tParcelPool.parcels.pop_back();
+    return parcel;
+}
+
+void AParcel::releaseParcel(Parcel* parcel) {
+    if (ParcelPool::tPoolDestroyed ||
+        tParcelPool.parcels.size() >= ParcelPool::kMaxPooledParcels) {
+        delete parcel;
+        return;
+    }
+    parcel->recycle(ParcelPool::kMaxRetainedCapacity);
+    tParcelPool.parcels.emplace_back(parcel);
+}
+#else   // BINDER_WITH_KERNEL_IPC
+Parcel* AParcel::acquireParcel() {
+    return new Parcel;
+}
+
+void AParcel::releaseParcel(Parcel* parcel) {
+    delete parcel;
+}
+#endif  // BINDER_WITH_KERNEL_IPC
+
 void AParcel_delete(AParcel* parcel) {
     delete parcel;
 }
@@ -679,6 +757,49 @@ bool AParcel_getAllowFds(const AParcel* parcel) {
     return parcel->get()->allowFds();
 }
 
+binder_status_t AParcel_writeBlob(AParcel* parcel, const int8_t* data, int32_t length) {
+    if (length < 0 || (length > 0 && data == nullptr)) return STATUS_BAD_VALUE;
+
+    Parcel* rawParcel = parcel->get();
+    if (status_t status = rawParcel->writeInt32(length); status != STATUS_OK) {
+        return PruneStatusT(status);
+    }
+
+    Parcel::WritableBlob blob;
+    if (status_t status = rawParcel->writeBlob(length, false /*mutableCopy*/, &blob);
+        status != STATUS_OK) {
+        return PruneStatusT(status);
+    }
+    if (length > 0) memcpy(blob.data(), data, length);
+    return STATUS_OK;
+}
+
+binder_status_t AParcel_readBlob(const AParcel* parcel, void* arrayData,
+                                 AParcel_byteArrayAllocator allocator) {
+    const Parcel* rawParcel = parcel->get();
+
+    int32_t length;
+    if (status_t status = rawParcel->readInt32(&length); status != STATUS_OK) {
+        return PruneStatusT(status);
+    }
+    if (length < 0) return STATUS_BAD_VALUE;
+
+    // The size is only bounded by the data in the parcel for blobs written in place, which
+    // readBlob checks.
+    Parcel::ReadableBlob blob;
+    if (status_t status = rawParcel->readBlob(length, &blob); status != STATUS_OK) {
+        return PruneStatusT(status);
+    }
+
+    int8_t* array;
+    if (!allocator(arrayData, length, &array)) return STATUS_NO_MEMORY;
+    if (length == 0) return STATUS_OK;
+    if (array == nullptr) return STATUS_NO_MEMORY;
+
+    memcpy(array, blob.data(), length);
+    return STATUS_OK;
+}
+
 binder_status_t AParcel_reset(AParcel* parcel) {
     parcel->get()->freeData();
     return STATUS_OK;
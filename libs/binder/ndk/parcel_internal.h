@@ -27,13 +27,13 @@ struct AParcel {
     const ::android::Parcel* get() const { return mParcel; }
     ::android::Parcel* get() { return mParcel; }
 
-    explicit AParcel(AIBinder* binder) : AParcel(binder, new ::android::Parcel, true /*owns*/) {}
+    explicit AParcel(AIBinder* binder) : AParcel(binder, acquireParcel(), true /*owns*/) {}
     AParcel(AIBinder* binder, ::android::Parcel* parcel, bool owns)
         : mBinder(binder), mParcel(parcel), mOwns(owns) {}
 
     ~AParcel() {
         if (mOwns) {
-            delete mParcel;
+            releaseParcel(mParcel);
         }
     }
 
@@ -44,6 +44,11 @@ struct AParcel {
     const AIBinder* getBinder() { return mBinder; }
 
    private:
+    // Owned parcels are recycled into a per-thread pool when the AParcel is destroyed, so that
+    // each transaction doesn't allocate its in and out Parcels and their buffers.
+    static ::android::Parcel* acquireParcel();
+    static void releaseParcel(::android::Parcel* parcel);
+
     // This object is associated with a calls to a specific AIBinder object. This is used for sanity
     // checking to make sure that a parcel is one that is expected.
     const AIBinder* mBinder;
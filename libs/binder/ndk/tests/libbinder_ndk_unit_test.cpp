@@ -22,6 +22,7 @@
 #include <android/binder_ibinder_platform.h>
 #include <android/binder_libbinder.h>
 #include <android/binder_manager.h>
+#include <android/binder_parcel_platform.h>
 #include <android/binder_process.h>
 #include <gtest/gtest.h>
 #include <iface/iface.h>
@@ -965,6 +966,33 @@ TEST(NdkBinder, ConvertToPlatformParcel) {
     EXPECT_EQ(42, pparcel->readInt32());
 }
 
+TEST(NdkBinder, ParcelBlob) {
+    const auto allocator = [](void* arrayData, int32_t length, int8_t** outBuffer) {
+        auto* vec = static_cast<std::vector<int8_t>*>(arrayData);
+        vec->resize(length);
+        *outBuffer = vec->data();
+        return true;
+    };
+
+    // In place, and in shared memory.
+    for (const size_t size : {0, 100, 1 << 20}) {
+        ndk::ScopedAParcel parcel = ndk::ScopedAParcel(AParcel_create());
+        std::vector<int8_t> blob(size);
+        for (size_t i = 0; i < size; i++) blob[i] = static_cast<int8_t>(i);
+
+        EXPECT_EQ(OK, AParcel_writeBlob(parcel.get(), blob.data(), blob.size()));
+        EXPECT_EQ(OK, AParcel_writeInt32(parcel.get(), 42));
+        EXPECT_EQ(OK, AParcel_setDataPosition(parcel.get(), 0));
+
+        std::vector<int8_t> out;
+        EXPECT_EQ(OK, AParcel_readBlob(parcel.get(), &out, allocator));
+        EXPECT_EQ(blob, out);
+        int32_t trailer;
+        EXPECT_EQ(OK, AParcel_readInt32(parcel.get(), &trailer));
+        EXPECT_EQ(42, trailer);
+    }
+}
+
 TEST(NdkBinder, GetAndVerifyScopedAIBinder_Weak) {
     LIBBINDER_IGNORE("-Wdeprecated-declarations")
     ndk::SpAIBinder remoteBinder(AServiceManager_getService(kBinderNdkUnitTestService));
@@ -94,6 +94,7 @@ status_t RpcCertificateVerifierSimple::verify(const SSL* ssl, uint8_t* outAlert)
                         "%s: libssl should not ask to verify non-existing cert", logPrefix);
 
     std::lock_guard<std::mutex> lock(mMutex);
+    if (SSL_session_reused(ssl)) mResumedSessionVerifyCount++;
     for (const auto& trustedCert : mTrustedPeerCertificates) {
         if (0 == X509_cmp(trustedCert.get(), peerCert.get())) {
             return OK;
@@ -103,6 +104,11 @@ status_t RpcCertificateVerifierSimple::verify(const SSL* ssl, uint8_t* outAlert)
     return PERMISSION_DENIED;
 }
 
+size_t RpcCertificateVerifierSimple::getResumedSessionVerifyCount() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mResumedSessionVerifyCount;
+}
+
 status_t RpcCertificateVerifierSimple::addTrustedPeerCertificate(RpcCertificateFormat format,
                                                                  const std::vector<uint8_t>& cert) {
     bssl::UniquePtr<X509> x509 = deserializeCertificate(cert, format);
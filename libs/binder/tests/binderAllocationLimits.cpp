@@ -162,6 +162,26 @@ TEST(BinderAllocation, ParcelOnStack) {
     imaginary_use = p.data();
 }
 
+TEST(BinderAllocation, RecycledParcel) {
+    Parcel p;
+    p.writeInt32(1); // first write allocates
+    p.recycle(1024);
+    const auto m = ScopeDisallowMalloc();
+    p.writeInt32(2);
+    imaginary_use = p.data();
+}
+
+TEST(BinderAllocation, ReservedParcel) {
+    Parcel p;
+    p.reserve(256 * sizeof(int32_t));
+
+    size_t mallocs = 0;
+    const auto on_malloc = OnMalloc([&](size_t) { mallocs++; });
+    for (int32_t i = 0; i < 256; i++) p.writeInt32(i);
+
+    EXPECT_EQ(mallocs, 0u);
+}
+
 TEST(BinderAllocation, GetServiceManager) {
     defaultServiceManager(); // first call may alloc
     const auto m = ScopeDisallowMalloc();
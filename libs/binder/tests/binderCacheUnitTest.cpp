@@ -24,7 +24,12 @@
 #include "fakeservicemanager/FakeServiceManager.h"
 
 #include <sys/prctl.h>
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <mutex>
 #include <thread>
+#include <vector>
 
 using namespace android;
 
@@ -63,6 +68,7 @@ public:
     MockAidlServiceManager() : innerSm() {}
 
     binder::Status checkService(const ::std::string& name, os::Service* _out) override {
+        checkServiceCalls++;
         sp<IBinder> binder = innerSm.getService(String16(name.c_str()));
         *_out = os::Service::make<os::Service::Tag::binder>(binder);
         return binder::Status::ok();
@@ -70,18 +76,45 @@ public:
 
     binder::Status addService(const std::string& name, const sp<IBinder>& service,
                               bool allowIsolated, int32_t dumpPriority) override {
-        return binder::Status::fromStatusT(
+        binder::Status status = binder::Status::fromStatusT(
                 innerSm.addService(String16(name.c_str()), service, allowIsolated, dumpPriority));
+        if (status.isOk()) {
+            std::vector<sp<os::IServiceCallback>> callbacks;
+            {
+                std::lock_guard<std::mutex> lock(callbacksMutex);
+                callbacks = this->callbacks[name];
+            }
+            for (const auto& callback : callbacks) callback->onRegistration(name, service);
+        }
+        return status;
+    }
+
+    binder::Status registerForNotifications(const std::string& name,
+                                            const sp<os::IServiceCallback>& callback) override {
+        std::lock_guard<std::mutex> lock(callbacksMutex);
+        callbacks[name].push_back(callback);
+        return binder::Status::ok();
+    }
+
+    binder::Status unregisterForNotifications(const std::string& name,
+                                              const sp<os::IServiceCallback>& callback) override {
+        std::lock_guard<std::mutex> lock(callbacksMutex);
+        auto& list = callbacks[name];
+        list.erase(std::remove(list.begin(), list.end(), callback), list.end());
+        return binder::Status::ok();
     }
 
     FakeServiceManager innerSm;
+    std::atomic<size_t> checkServiceCalls = 0;
+    std::mutex callbacksMutex;
+    std::map<std::string, std::vector<sp<os::IServiceCallback>>> callbacks;
 };
 
 class LibbinderCacheTest : public ::testing::Test {
 protected:
     void SetUp() override {
-        sp<MockAidlServiceManager> sm = sp<MockAidlServiceManager>::make();
-        mServiceManager = getServiceManagerShimFromAidlServiceManagerForTests(sm);
+        mAidlServiceManager = sp<MockAidlServiceManager>::make();
+        mServiceManager = getServiceManagerShimFromAidlServiceManagerForTests(mAidlServiceManager);
     }
 
     void TearDown() override {}
@@ -108,6 +141,7 @@ public:
         }
     }
 
+    sp<MockAidlServiceManager> mAidlServiceManager;
     sp<android::IServiceManager> mServiceManager;
 };
 
@@ -189,6 +223,19 @@ TEST_F(LibbinderCacheTest, DoNotCacheServiceNotInList) {
     EXPECT_EQ(binder2, result);
 }
 
+TEST_F(LibbinderCacheTest, MissingServiceCachedUntilRegistration) {
+    String16 serviceName = String16("NegativeLibbinderCacheTest");
+
+    EXPECT_EQ(nullptr, mServiceManager->checkService(serviceName));
+    EXPECT_EQ(nullptr, mServiceManager->checkService(serviceName));
+    EXPECT_EQ(kUseLibbinderCache ? 1u : 2u, mAidlServiceManager->checkServiceCalls.load());
+
+    // Registering the service, from any process, drops the entry.
+    sp<IBinder> binder = sp<BBinder>::make();
+    EXPECT_OK(mAidlServiceManager->addService(String8(serviceName).c_str(), binder, false, 0));
+    EXPECT_EQ(binder, mServiceManager->checkService(serviceName));
+}
+
 int main(int argc, char** argv) {
     ::testing::InitGoogleTest(&argc, argv);
 
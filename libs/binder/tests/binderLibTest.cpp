@@ -39,6 +39,7 @@
 #include <binder/RpcServer.h>
 #include <binder/RpcSession.h>
 #include <binder/Status.h>
+#include <binder/TransactionLatencyStats.h>
 #include <binder/unique_fd.h>
 #include <input/BlockingQueue.h>
 #include <processgroup/processgroup.h>
@@ -134,7 +135,9 @@ enum BinderLibTestTranscationCode {
     BINDER_LIB_TEST_LOCK_UNLOCK,
     BINDER_LIB_TEST_PROCESS_LOCK,
     BINDER_LIB_TEST_UNLOCK_AFTER_MS,
-    BINDER_LIB_TEST_PROCESS_TEMPORARY_LOCK
+    BINDER_LIB_TEST_PROCESS_TEMPORARY_LOCK,
+    BINDER_LIB_TEST_SET_IDLE_THREAD_EXIT,
+    BINDER_LIB_TEST_GET_THREAD_POOL_STATS,
 };
 
 pid_t start_server_process(int arg2, bool usePoll = false)
@@ -617,6 +620,35 @@ TEST_F(BinderLibTest, NopTransaction) {
                 StatusEq(NO_ERROR));
 }
 
+TEST_F(BinderLibTest, TransactionLatencyStats) {
+    TransactionLatencyStats::reset();
+    TransactionLatencyStats::setEnabled(true);
+    auto disable = make_scope_guard([] { TransactionLatencyStats::setEnabled(false); });
+
+    String8 descriptor(m_server->getInterfaceDescriptor());
+    for (int i = 0; i < 10; i++) {
+        Parcel data, reply;
+        EXPECT_THAT(m_server->transact(BINDER_LIB_TEST_NOP_TRANSACTION, data, &reply),
+                    StatusEq(NO_ERROR));
+    }
+
+    std::string dump = TransactionLatencyStats::dump();
+    std::string expected = std::string("client ") + descriptor.c_str() + " code " +
+            std::to_string(BINDER_LIB_TEST_NOP_TRANSACTION) + ": count 10 ";
+    EXPECT_THAT(dump, testing::HasSubstr(expected));
+}
+
+TEST_F(BinderLibTest, InterfaceDescriptorInterned) {
+    String8 descriptor(m_server->getInterfaceDescriptor());
+    const String16 interned = BpBinder::internDescriptor(String16(descriptor.c_str()));
+    EXPECT_EQ(BpBinder::internDescriptor(String16(descriptor.c_str())).c_str(), interned.c_str());
+
+    // A new proxy shares the interned buffer of its descriptor.
+    sp<IBinder> server = addServer();
+    ASSERT_NE(nullptr, server);
+    EXPECT_EQ(server->getInterfaceDescriptor().c_str(), interned.c_str());
+}
+
 TEST_F(BinderLibTest, NopTransactionOneway) {
     Parcel data, reply;
     EXPECT_THAT(m_server->transact(BINDER_LIB_TEST_NOP_TRANSACTION, data, &reply, TF_ONE_WAY),
@@ -800,6 +832,43 @@ TEST_F(BinderLibTest, CallBack)
     EXPECT_THAT(callBack->getResult(), StatusEq(NO_ERROR));
 }
 
+TEST_F(BinderLibTest, OnewayBatch) {
+    constexpr size_t kNumCallBacks = 8;
+    std::vector<sp<BinderLibTestCallBack>> callBacks;
+
+    IPCThreadState::self()->beginOnewayBatch();
+    for (size_t i = 0; i < kNumCallBacks; i++) {
+        // The parcel goes out of scope before the batch is submitted.
+        Parcel data;
+        sp<BinderLibTestCallBack> callBack = new BinderLibTestCallBack();
+        data.writeStrongBinder(callBack);
+        EXPECT_THAT(m_server->transact(BINDER_LIB_TEST_NOP_CALL_BACK, data, nullptr, TF_ONE_WAY),
+                    StatusEq(NO_ERROR));
+        callBacks.push_back(callBack);
+    }
+    EXPECT_THAT(IPCThreadState::self()->flushOnewayBatch(), StatusEq(NO_ERROR));
+
+    for (const auto& callBack : callBacks) {
+        EXPECT_THAT(callBack->waitEvent(5), StatusEq(NO_ERROR));
+        EXPECT_THAT(callBack->getResult(), StatusEq(NO_ERROR));
+    }
+}
+
+TEST_F(BinderLibTest, OnewayBatchWithTwoWayTransaction) {
+    Parcel data, reply;
+    sp<BinderLibTestCallBack> callBack = new BinderLibTestCallBack();
+    data.writeStrongBinder(callBack);
+
+    IPCThreadState::self()->beginOnewayBatch();
+    EXPECT_THAT(m_server->transact(BINDER_LIB_TEST_NOP_CALL_BACK, data, nullptr, TF_ONE_WAY),
+                StatusEq(NO_ERROR));
+    // Submits the batch before waiting for the reply.
+    EXPECT_THAT(m_server->transact(BINDER_LIB_TEST_NOP_TRANSACTION, Parcel(), &reply),
+                StatusEq(NO_ERROR));
+    EXPECT_THAT(callBack->waitEvent(5), StatusEq(NO_ERROR));
+    EXPECT_THAT(IPCThreadState::self()->flushOnewayBatch(), StatusEq(NO_ERROR));
+}
+
 TEST_F(BinderLibTest, BinderCallContextGuard) {
     sp<IBinder> binder = addServer();
     Parcel data, reply;
@@ -1823,6 +1892,103 @@ TEST_F(BinderLibTest, ThreadPoolAvailableThreads) {
     EXPECT_EQ(replyi, kKernelThreads + 2);
 }
 
+// Keeps every kernel-started thread of the server busy at once, so that the kernel starts all of
+// them.
+static void useAllThreads(const sp<IBinder>& server) {
+    Parcel data, reply;
+    EXPECT_THAT(server->transact(BINDER_LIB_TEST_PROCESS_LOCK, data, &reply), NO_ERROR);
+    std::vector<std::thread> ts;
+    for (size_t i = 0; i < kKernelThreads; i++) {
+        ts.push_back(std::thread([&] {
+            Parcel local_data, local_reply;
+            EXPECT_THAT(server->transact(BINDER_LIB_TEST_LOCK_UNLOCK, local_data, &local_reply),
+                        NO_ERROR);
+        }));
+    }
+    // see ThreadPoolAvailableThreads
+    sleep(1);
+    data.writeInt32(100);
+    EXPECT_THAT(server->transact(BINDER_LIB_TEST_UNLOCK_AFTER_MS, data, &reply), NO_ERROR);
+    for (auto& t : ts) {
+        t.join();
+    }
+}
+
+static void setIdleThreadExit(const sp<IBinder>& server, int32_t maxIdleThreads,
+                              int32_t minThreads, std::chrono::milliseconds minIdleTime) {
+    Parcel data, reply;
+    data.writeInt32(maxIdleThreads);
+    data.writeInt32(minThreads);
+    data.writeInt64(minIdleTime.count());
+    EXPECT_THAT(server->transact(BINDER_LIB_TEST_SET_IDLE_THREAD_EXIT, data, &reply), NO_ERROR);
+}
+
+static ProcessState::ThreadPoolStats getThreadPoolStats(const sp<IBinder>& server) {
+    Parcel data, reply;
+    EXPECT_THAT(server->transact(BINDER_LIB_TEST_GET_THREAD_POOL_STATS, data, &reply), NO_ERROR);
+    ProcessState::ThreadPoolStats stats{};
+    stats.threads = reply.readUint64();
+    stats.executingThreads = reply.readUint64();
+    stats.peakExecutingThreads = reply.readUint64();
+    stats.exitedIdleThreads = reply.readUint64();
+    return stats;
+}
+
+static void callSequentially(const sp<IBinder>& server, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        Parcel data, reply;
+        EXPECT_THAT(server->transact(BINDER_LIB_TEST_NOP_TRANSACTION, data, &reply), NO_ERROR);
+    }
+}
+
+TEST_F(BinderLibTest, ThreadPoolIdleThreadsExit) {
+    sp<IBinder> server = addServer();
+    ASSERT_NE(server, nullptr);
+    constexpr int32_t kMinThreads = 3;
+    setIdleThreadExit(server, 0, kMinThreads, 100ms);
+
+    useAllThreads(server);
+    const auto busyStats = getThreadPoolStats(server);
+    EXPECT_GE(busyStats.peakExecutingThreads, static_cast<size_t>(kKernelThreads));
+
+    // Every thread waited long enough for its next call, so each call lets the thread handling
+    // it leave, down to the minimum.
+    std::this_thread::sleep_for(300ms);
+    callSequentially(server, 2 * kKernelThreads);
+
+    const auto idleStats = getThreadPoolStats(server);
+    EXPECT_GT(idleStats.exitedIdleThreads, 0u);
+    EXPECT_LT(idleStats.threads, busyStats.threads);
+    EXPECT_GE(idleStats.threads, static_cast<size_t>(kMinThreads));
+}
+
+TEST_F(BinderLibTest, ThreadPoolKeepsRecentlyBusyThreads) {
+    sp<IBinder> server = addServer();
+    ASSERT_NE(server, nullptr);
+    setIdleThreadExit(server, 0, 1, 60s);
+
+    useAllThreads(server);
+    callSequentially(server, 2 * kKernelThreads);
+
+    // No thread waited for a call for as long as the minimum idle time.
+    const auto stats = getThreadPoolStats(server);
+    EXPECT_EQ(stats.exitedIdleThreads, 0u);
+}
+
+TEST_F(BinderLibTest, ThreadPoolKeepsMinThreads) {
+    sp<IBinder> server = addServer();
+    ASSERT_NE(server, nullptr);
+    constexpr int32_t kMinThreads = kKernelThreads + 2;
+    setIdleThreadExit(server, 0, kMinThreads, 100ms);
+
+    useAllThreads(server);
+    std::this_thread::sleep_for(300ms);
+    callSequentially(server, 2 * kKernelThreads);
+
+    const auto stats = getThreadPoolStats(server);
+    EXPECT_EQ(stats.exitedIdleThreads, 0u);
+}
+
 TEST_F(BinderLibTest, ThreadPoolStarted) {
     Parcel data, reply;
     sp<IBinder> server = addServer();
@@ -2490,6 +2656,23 @@ public:
                 t.detach();
                 return NO_ERROR;
             }
+            case BINDER_LIB_TEST_SET_IDLE_THREAD_EXIT: {
+                int32_t maxIdleThreads = data.readInt32();
+                int32_t minThreads = data.readInt32();
+                int64_t minIdleTimeMs = data.readInt64();
+                ProcessState::self()->setThreadPoolMaxIdleThreadCount(maxIdleThreads, minThreads,
+                                                                      std::chrono::milliseconds(
+                                                                              minIdleTimeMs));
+                return NO_ERROR;
+            }
+            case BINDER_LIB_TEST_GET_THREAD_POOL_STATS: {
+                const auto stats = ProcessState::self()->getThreadPoolStats();
+                reply->writeUint64(stats.threads);
+                reply->writeUint64(stats.executingThreads);
+                reply->writeUint64(stats.peakExecutingThreads);
+                reply->writeUint64(stats.exitedIdleThreads);
+                return NO_ERROR;
+            }
             default:
                 return UNKNOWN_TRANSACTION;
         };
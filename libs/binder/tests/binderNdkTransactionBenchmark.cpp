@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <android/binder_ibinder.h>
+#include <android/binder_parcel.h>
+#include <benchmark/benchmark.h>
+#include <binder/Binder.h>
+#include <binder/Parcel.h>
+
+// Usage: atest binderNdkTransactionBenchmark
+//
+// Compares the overhead the NDK adds to a transaction with libbinder. The binders are local, so
+// that the cost of the kernel doesn't hide the cost of the wrappers.
+
+using android::BBinder;
+using android::IBinder;
+using android::Parcel;
+using android::sp;
+using android::status_t;
+using android::String16;
+
+static constexpr const char* kDescriptor = "android.binder.benchmark.IEcho";
+static constexpr transaction_code_t kEchoCode = IBinder::FIRST_CALL_TRANSACTION;
+
+// Echoes an int32, checking the interface token like the NDK does for its classes.
+class EchoBinder : public BBinder {
+public:
+    const String16& getInterfaceDescriptor() const override { return mDescriptor; }
+
+    status_t onTransact(uint32_t code, const Parcel& data, Parcel* reply,
+                        uint32_t flags) override {
+        if (code != kEchoCode) return BBinder::onTransact(code, data, reply, flags);
+        if (!data.checkInterface(this)) return android::BAD_TYPE;
+        return reply->writeInt32(data.readInt32());
+    }
+
+private:
+    const String16 mDescriptor{kDescriptor};
+};
+
+static void BM_libbinderTransact(benchmark::State& state) {
+    sp<IBinder> binder = sp<EchoBinder>::make();
+    const String16 descriptor(kDescriptor);
+    int32_t value = 0;
+    while (state.KeepRunning()) {
+        Parcel data;
+        Parcel reply;
+        data.writeInterfaceToken(descriptor);
+        data.writeInt32(value);
+        if (binder->transact(kEchoCode, data, &reply) != android::OK) {
+            state.SkipWithError("transact failed");
+            break;
+        }
+        value = reply.readInt32() + 1;
+        benchmark::DoNotOptimize(value);
+    }
+}
+BENCHMARK(BM_libbinderTransact);
+
+static void* EchoOnCreate(void* args) {
+    return args;
+}
+
+static void EchoOnDestroy(void*) {}
+
+static binder_status_t EchoOnTransact(AIBinder*, transaction_code_t code, const AParcel* in,
+                                      AParcel* out) {
+    if (code != kEchoCode) return STATUS_UNKNOWN_TRANSACTION;
+    int32_t value;
+    if (binder_status_t status = AParcel_readInt32(in, &value); status != STATUS_OK) {
+        return status;
+    }
+    return AParcel_writeInt32(out, value);
+}
+
+static void BM_ndkTransact(benchmark::State& state) {
+    static AIBinder_Class* clazz =
+            AIBinder_Class_define(kDescriptor, EchoOnCreate, EchoOnDestroy, EchoOnTransact);
+    AIBinder* binder = AIBinder_new(clazz, nullptr);
+    int32_t value = 0;
+    while (state.KeepRunning()) {
+        AParcel* in = nullptr;
+        AParcel* out = nullptr;
+        if (AIBinder_prepareTransaction(binder, &in) != STATUS_OK ||
+            AParcel_writeInt32(in, value) != STATUS_OK ||
+            AIBinder_transact(binder, kEchoCode, &in, &out, 0) != STATUS_OK) {
+            AParcel_delete(in);
+            state.SkipWithError("transact failed");
+            break;
+        }
+        AParcel_readInt32(out, &value);
+        AParcel_delete(out);
+        value++;
+        benchmark::DoNotOptimize(value);
+    }
+    AIBinder_decStrong(binder);
+}
+BENCHMARK(BM_ndkTransact);
+
+BENCHMARK_MAIN();
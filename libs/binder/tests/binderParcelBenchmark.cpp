@@ -36,6 +36,8 @@ void writeVector(android::Parcel &p, const V<T, Args...> &v) {
         p.writeInt32Vector(v);
     } else if constexpr (std::is_same_v<T, int64_t>) {
         p.writeInt64Vector(v);
+    } else if constexpr (std::is_same_v<T, float>) {
+        p.writeFloatVector(v);
     } else {
         static_assert(dependent_false_v<V<T>>);
     }
@@ -53,6 +55,8 @@ void readVector(android::Parcel &p, V<T, Args...> *v) {
         p.readInt32Vector(v);
     } else if constexpr (std::is_same_v<T, int64_t>) {
         p.readInt64Vector(v);
+    } else if constexpr (std::is_same_v<T, float>) {
+        p.readFloatVector(v);
     } else {
         static_assert(dependent_false_v<V<T>>);
     }
@@ -163,10 +167,50 @@ static void BM_Int64Vector(benchmark::State& state) {
     BM_ParcelVector<int64_t>(state);
 }
 
+static void BM_FloatVector(benchmark::State& state) {
+    BM_ParcelVector<float>(state);
+}
+
 BENCHMARK(BM_BoolVector)->Apply(VectorArgs);
 BENCHMARK(BM_ByteVector)->Apply(VectorArgs);
 BENCHMARK(BM_CharVector)->Apply(VectorArgs);
 BENCHMARK(BM_Int32Vector)->Apply(VectorArgs);
 BENCHMARK(BM_Int64Vector)->Apply(VectorArgs);
+BENCHMARK(BM_FloatVector)->Apply(VectorArgs);
+
+// Writes a parcel of state.range(0) int32s, either into a fresh Parcel every
+// iteration or into one that is recycled (as IPCThreadState does for replies).
+static void BM_ParcelFresh(benchmark::State& state) {
+    const int32_t elements = state.range(0);
+    while (state.KeepRunning()) {
+        android::Parcel p;
+        for (int32_t i = 0; i < elements; i++) p.writeInt32(i);
+        benchmark::DoNotOptimize(p.data());
+    }
+}
+
+static void BM_ParcelRecycled(benchmark::State& state) {
+    const int32_t elements = state.range(0);
+    android::Parcel p;
+    while (state.KeepRunning()) {
+        for (int32_t i = 0; i < elements; i++) p.writeInt32(i);
+        benchmark::DoNotOptimize(p.data());
+        p.recycle(16 * 1024);
+    }
+}
+
+static void BM_ParcelReserved(benchmark::State& state) {
+    const int32_t elements = state.range(0);
+    while (state.KeepRunning()) {
+        android::Parcel p;
+        p.reserve(elements * sizeof(int32_t));
+        for (int32_t i = 0; i < elements; i++) p.writeInt32(i);
+        benchmark::DoNotOptimize(p.data());
+    }
+}
+
+BENCHMARK(BM_ParcelFresh)->Apply(VectorArgs);
+BENCHMARK(BM_ParcelRecycled)->Apply(VectorArgs);
+BENCHMARK(BM_ParcelReserved)->Apply(VectorArgs);
 
 BENCHMARK_MAIN();
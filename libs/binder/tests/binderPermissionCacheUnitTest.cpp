@@ -0,0 +1,197 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <gtest/gtest.h>
+
+#include <binder/PermissionCache.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace android {
+
+// Drives a private cache rather than the singleton, so that the tests don't interfere with each
+// other.
+class PermissionCacheTest : public testing::Test {
+protected:
+    static constexpr size_t kSlotsPerShard = PermissionCache::kSlotsPerShard;
+    static constexpr size_t kShardCount = PermissionCache::kShardCount;
+    static constexpr size_t kMaxPermissionNames = PermissionCache::kMaxPermissionNames;
+
+    std::optional<bool> check(const String16& permission, uid_t uid) {
+        bool granted = false;
+        if (mCache->check(&granted, permission, uid) != NO_ERROR) return std::nullopt;
+        return granted;
+    }
+
+    void cache(const String16& permission, uid_t uid, bool granted) {
+        mCache->cache(permission, uid, granted);
+    }
+
+    void purge() { mCache->purge(); }
+
+    void purgeUid(uid_t uid) {
+        Mutex::Autolock _l(mCache->mLock);
+        mCache->purgeUidLocked(uid);
+    }
+
+    size_t entryCount() const {
+        size_t count = 0;
+        for (const auto& shard : mCache->mShards) {
+            for (const auto& slot : shard.slots) {
+                if (slot.load() != 0) count++;
+            }
+        }
+        return count;
+    }
+
+    static String16 permissionName(size_t i) {
+        return String16(("android.permission.TEST_" + std::to_string(i)).c_str());
+    }
+
+    const std::unique_ptr<PermissionCache> mCache = std::make_unique<PermissionCache>();
+};
+
+namespace {
+
+const String16 kPermission("android.permission.TEST");
+const String16 kOtherPermission("android.permission.OTHER_TEST");
+
+} // namespace
+
+TEST_F(PermissionCacheTest, CachesGrantedAndDenied) {
+    EXPECT_EQ(std::nullopt, check(kPermission, 10000));
+
+    cache(kPermission, 10000, true);
+    cache(kPermission, 10001, false);
+
+    EXPECT_EQ(true, check(kPermission, 10000));
+    EXPECT_EQ(false, check(kPermission, 10001));
+    EXPECT_EQ(std::nullopt, check(kOtherPermission, 10000));
+    EXPECT_EQ(std::nullopt, check(kPermission, 10002));
+}
+
+TEST_F(PermissionCacheTest, Purge) {
+    cache(kPermission, 10000, true);
+    cache(kOtherPermission, 10001, true);
+
+    purge();
+
+    EXPECT_EQ(std::nullopt, check(kPermission, 10000));
+    EXPECT_EQ(std::nullopt, check(kOtherPermission, 10001));
+    EXPECT_EQ(0u, entryCount());
+}
+
+TEST_F(PermissionCacheTest, PurgeUidKeepsOtherUidsOfTheShard) {
+    // These uids are in the same shard.
+    const uid_t uid = 10000;
+    const uid_t otherUid = uid + kShardCount;
+    cache(kPermission, uid, true);
+    cache(kOtherPermission, uid, false);
+    cache(kPermission, otherUid, true);
+    cache(kOtherPermission, otherUid, false);
+
+    purgeUid(uid);
+
+    EXPECT_EQ(std::nullopt, check(kPermission, uid));
+    EXPECT_EQ(std::nullopt, check(kOtherPermission, uid));
+    EXPECT_EQ(true, check(kPermission, otherUid));
+    EXPECT_EQ(false, check(kOtherPermission, otherUid));
+}
+
+TEST_F(PermissionCacheTest, FullShardEvicts) {
+    // Fill one shard, and then some.
+    constexpr size_t kUidCount = kSlotsPerShard * 2;
+    for (size_t i = 0; i < kUidCount; i++) {
+        cache(kPermission, static_cast<uid_t>(10000 + i * kShardCount), true);
+    }
+    EXPECT_EQ(kSlotsPerShard, entryCount());
+
+    // The latest entry replaced an older one, rather than being dropped.
+    const uid_t lastUid = static_cast<uid_t>(10000 + (kUidCount - 1) * kShardCount);
+    EXPECT_EQ(true, check(kPermission, lastUid));
+
+    size_t hits = 0;
+    for (size_t i = 0; i < kUidCount; i++) {
+        if (check(kPermission, static_cast<uid_t>(10000 + i * kShardCount))) hits++;
+    }
+    EXPECT_EQ(kSlotsPerShard, hits);
+}
+
+TEST_F(PermissionCacheTest, FullNameTableResets) {
+    for (size_t i = 0; i < kMaxPermissionNames; i++) {
+        cache(permissionName(i), 10000, true);
+    }
+    EXPECT_EQ(true, check(permissionName(0), 10000));
+
+    // This doesn't fit, so the names are reset, which drops the entries.
+    cache(kPermission, 10000, false);
+
+    EXPECT_EQ(false, check(kPermission, 10000));
+    EXPECT_EQ(std::nullopt, check(permissionName(0), 10000));
+    EXPECT_EQ(1u, entryCount());
+
+    cache(permissionName(0), 10000, true);
+    EXPECT_EQ(true, check(permissionName(0), 10000));
+}
+
+TEST_F(PermissionCacheTest, ConcurrentCheckCacheAndPurge) {
+    // Checks never see the result of another permission or uid, while entries are cached, purged,
+    // and the names are reset.
+    constexpr size_t kPermissionCount = kMaxPermissionNames * 2;
+    constexpr uid_t kUidCount = 32;
+    const auto expected = [](size_t permission, uid_t uid) { return (permission + uid) % 3 == 0; };
+
+    std::atomic<bool> stop = false;
+    std::atomic<size_t> mismatches = 0;
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < 4; t++) {
+        threads.emplace_back([&, t] {
+            size_t i = t;
+            while (!stop) {
+                const size_t permission = i % kPermissionCount;
+                const uid_t uid = static_cast<uid_t>(10000 + i % kUidCount);
+                const auto granted = check(permissionName(permission), uid);
+                if (granted && *granted != expected(permission, uid)) mismatches++;
+                if (!granted) cache(permissionName(permission), uid, expected(permission, uid));
+                i += 7;
+            }
+        });
+    }
+    threads.emplace_back([&] {
+        for (uid_t i = 0; !stop; i++) {
+            if (i % 64 == 0) {
+                purge();
+            } else {
+                purgeUid(10000 + i % kUidCount);
+            }
+            std::this_thread::yield();
+        }
+    });
+
+    std::this_thread::sleep_for(std::chrono::seconds(2));
+    stop = true;
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(0u, mismatches);
+}
+
+} // namespace android
@@ -17,13 +17,19 @@
 #include <binder/Parcel.h>
 #include <binder/PersistableBundle.h>
 #include <gtest/gtest.h>
+#include <functional>
 #include <numeric>
 
+#include "../ParcelValTypes.h"
+
 using android::OK;
 using android::Parcel;
 using android::status_t;
 using android::String16;
 using android::String8;
+using android::binder::VAL_INTEGER;
+using android::binder::VAL_LONG;
+using android::binder::VAL_PERSISTABLEBUNDLE;
 using android::os::PersistableBundle;
 
 namespace android {
@@ -132,3 +138,206 @@ TEST(PersistableBundle, OverwriteKey) {
     EXPECT_TRUE(pb.getDouble(kKey, &out));
     EXPECT_EQ(out, 0.5);
 }
+
+static PersistableBundle createFullPersistableBundle() {
+    PersistableBundle pb{};
+    pb.putBoolean(String16{"boolean"}, true);
+    pb.putInt(String16{"int"}, 64);
+    pb.putLong(String16{"long"}, 42);
+    pb.putDouble(String16{"double"}, 42.64);
+    pb.putString(String16{"string"}, String16{"foo"});
+    pb.putBooleanVector(String16{"booleanVector"}, {true, false, true});
+    pb.putIntVector(String16{"intVector"}, {1, 2, 3});
+    pb.putLongVector(String16{"longVector"}, {1, 2});
+    pb.putDoubleVector(String16{"doubleVector"}, {4.2, 5.9});
+    pb.putStringVector(String16{"stringVector"}, {String16{"foo"}, String16{"bar"}});
+    pb.putPersistableBundle(String16{"persistableBundle"}, createSimplePersistableBundle());
+    return pb;
+}
+
+TEST(PersistableBundle, ParcelAndUnparcelAllTypes) {
+    PersistableBundle expected = createFullPersistableBundle();
+    PersistableBundle out{};
+
+    Parcel p{};
+    EXPECT_EQ(expected.writeToParcel(&p), 0);
+    p.setDataPosition(0);
+    EXPECT_EQ(out.readFromParcel(&p), 0);
+    EXPECT_EQ(p.dataPosition(), p.dataSize());
+
+    EXPECT_EQ(out.size(), expected.size());
+    EXPECT_EQ(out.getStringVectorKeys(), std::set<String16>{String16{"stringVector"}});
+
+    std::vector<int32_t> intVector;
+    EXPECT_TRUE(out.getIntVector(String16{"intVector"}, &intVector));
+    EXPECT_EQ(intVector, (std::vector<int32_t>{1, 2, 3}));
+
+    PersistableBundle nested;
+    EXPECT_TRUE(out.getPersistableBundle(String16{"persistableBundle"}, &nested));
+    EXPECT_EQ(nested, createSimplePersistableBundle());
+
+    // Values are only returned for their own type.
+    int64_t longValue;
+    EXPECT_FALSE(out.getLong(String16{"int"}, &longValue));
+
+    EXPECT_EQ(expected, out);
+}
+
+TEST(PersistableBundle, ReparcelWithoutDecoding) {
+    PersistableBundle expected = createFullPersistableBundle();
+    PersistableBundle forwarded{};
+    PersistableBundle out{};
+
+    Parcel first{};
+    EXPECT_EQ(expected.writeToParcel(&first), 0);
+    first.setDataPosition(0);
+    EXPECT_EQ(forwarded.readFromParcel(&first), 0);
+
+    Parcel second{};
+    EXPECT_EQ(forwarded.writeToParcel(&second), 0);
+    EXPECT_EQ(second.dataSize(), first.dataSize());
+    second.setDataPosition(0);
+    EXPECT_EQ(out.readFromParcel(&second), 0);
+
+    EXPECT_EQ(expected, out);
+}
+
+TEST(PersistableBundle, ModifyAfterUnparcel) {
+    PersistableBundle expected = createFullPersistableBundle();
+    PersistableBundle out{};
+
+    Parcel p{};
+    EXPECT_EQ(expected.writeToParcel(&p), 0);
+    p.setDataPosition(0);
+    EXPECT_EQ(out.readFromParcel(&p), 0);
+
+    EXPECT_EQ(out.erase(String16{"long"}), 1u);
+    EXPECT_EQ(out.erase(String16{"long"}), 0u);
+    out.putDouble(String16{"string"}, 0.5);
+    expected.erase(String16{"long"});
+    expected.putDouble(String16{"string"}, 0.5);
+
+    String16 stringValue;
+    EXPECT_FALSE(out.getString(String16{"string"}, &stringValue));
+    EXPECT_EQ(out.getStringKeys().size(), 0);
+    EXPECT_EQ(out.size(), expected.size());
+    EXPECT_EQ(expected, out);
+}
+
+// BUNDLE_MAGIC in frameworks/base/core/java/android/os/BaseBundle.java.
+static constexpr int32_t kBundleMagic = 0x4C444E42;
+
+// Writes a bundle of |numEntries| entries written by |writeEntries|, the way writeToParcel() does.
+static void writeRawBundle(Parcel* p, int32_t numEntries,
+                           const std::function<void()>& writeEntries) {
+    size_t lengthPos = p->dataPosition();
+    p->writeInt32(0);
+    p->writeInt32(kBundleMagic);
+    size_t startPos = p->dataPosition();
+    p->writeInt32(numEntries);
+    writeEntries();
+    size_t endPos = p->dataPosition();
+    p->setDataPosition(lengthPos);
+    p->writeInt32(static_cast<int32_t>(endPos - startPos));
+    p->setDataPosition(endPos);
+}
+
+static void writeDuplicateKeyEntries(Parcel* p) {
+    p->writeString16(kKey);
+    p->writeInt32(VAL_INTEGER);
+    p->writeInt32(1);
+    p->writeString16(kKey);
+    p->writeInt32(VAL_LONG);
+    p->writeInt64(2);
+}
+
+TEST(PersistableBundle, RejectDuplicateKeys) {
+    Parcel p{};
+    writeRawBundle(&p, 2, [&] { writeDuplicateKeyEntries(&p); });
+
+    PersistableBundle out{};
+    p.setDataPosition(0);
+    EXPECT_EQ(out.readFromParcel(&p), android::BAD_VALUE);
+
+    // Also when merging into a bundle with entries.
+    PersistableBundle merged = createSimplePersistableBundle();
+    p.setDataPosition(0);
+    EXPECT_EQ(merged.readFromParcel(&p), android::BAD_VALUE);
+}
+
+TEST(PersistableBundle, RejectDuplicateKeysOfNestedBundle) {
+    Parcel p{};
+    writeRawBundle(&p, 1, [&] {
+        p.writeString16(String16{"nested"});
+        p.writeInt32(VAL_PERSISTABLEBUNDLE);
+        writeRawBundle(&p, 2, [&] { writeDuplicateKeyEntries(&p); });
+    });
+
+    PersistableBundle out{};
+    p.setDataPosition(0);
+    EXPECT_EQ(out.readFromParcel(&p), android::BAD_VALUE);
+}
+
+TEST(PersistableBundle, RejectMalformedNestedBundle) {
+    Parcel p{};
+    writeRawBundle(&p, 1, [&] {
+        p.writeString16(String16{"nested"});
+        p.writeInt32(VAL_PERSISTABLEBUNDLE);
+        writeRawBundle(&p, 1, [&] {
+            p.writeString16(kKey);
+            p.writeInt32(1000); // not a value type
+            p.writeInt32(1);
+        });
+    });
+
+    PersistableBundle out{};
+    p.setDataPosition(0);
+    EXPECT_EQ(out.readFromParcel(&p), android::BAD_TYPE);
+}
+
+TEST(PersistableBundle, RejectNestedBundleLongerThanItsLength) {
+    Parcel p{};
+    size_t nestedLengthPos = 0;
+    writeRawBundle(&p, 2, [&] {
+        p.writeString16(String16{"nested"});
+        p.writeInt32(VAL_PERSISTABLEBUNDLE);
+        nestedLengthPos = p.dataPosition();
+        writeRawBundle(&p, 1, [&] {
+            p.writeString16(kKey);
+            p.writeInt32(VAL_INTEGER);
+            p.writeInt32(1);
+        });
+        p.writeString16(String16{"after"});
+        p.writeInt32(VAL_INTEGER);
+        p.writeInt32(2);
+    });
+    // Only cover the entry count, so that the entry runs into the next key of the outer bundle.
+    size_t endPos = p.dataPosition();
+    p.setDataPosition(nestedLengthPos);
+    p.writeInt32(sizeof(int32_t));
+    p.setDataPosition(endPos);
+
+    PersistableBundle out{};
+    p.setDataPosition(0);
+    EXPECT_EQ(out.readFromParcel(&p), android::BAD_VALUE);
+}
+
+TEST(PersistableBundle, MergeReplacesKeyOfOtherType) {
+    Parcel p{};
+    writeRawBundle(&p, 1, [&] {
+        p.writeString16(kKey);
+        p.writeInt32(VAL_LONG);
+        p.writeInt64(2);
+    });
+
+    PersistableBundle out = createSimplePersistableBundle();
+    p.setDataPosition(0);
+    EXPECT_EQ(out.readFromParcel(&p), OK);
+
+    int32_t intValue;
+    int64_t longValue;
+    EXPECT_FALSE(out.getInt(kKey, &intValue));
+    EXPECT_TRUE(out.getLong(kKey, &longValue));
+    EXPECT_EQ(longValue, 2);
+    EXPECT_EQ(out.size(), 1u);
+}
@@ -0,0 +1,224 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Replays a recording made with `record_binder start SERVICE` against a
+// running service, and reports throughput, latency percentiles and the
+// allocations made by this process per transaction.
+//
+// Usage: binderReplayBenchmark [OPTIONS] SERVICE RECORDING
+// ex. binderReplayBenchmark -x 10 manager /data/local/recordings/manager
+
+#include <binder/IBinder.h>
+#include <binder/IServiceManager.h>
+#include <binder/Parcel.h>
+#include <binder/RecordedTransaction.h>
+#include <binder/unique_fd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <malloc.h>
+#include <unistd.h>
+
+using namespace android;
+using android::binder::unique_fd;
+using android::binder::debug::RecordedTransaction;
+using std::chrono::steady_clock;
+
+// Allocations are counted with the libc malloc hooks, as in
+// binderAllocationLimits. Only this (client) process is counted.
+static size_t gAllocations = 0;
+static decltype(__malloc_hook) gOrigMallocHook = nullptr;
+static decltype(__realloc_hook) gOrigReallocHook = nullptr;
+
+static void* countingMallocHook(size_t bytes, const void* arg) {
+    gAllocations++;
+    return gOrigMallocHook(bytes, arg);
+}
+
+static void* countingReallocHook(void* ptr, size_t bytes, const void* arg) {
+    gAllocations++;
+    return gOrigReallocHook(ptr, bytes, arg);
+}
+
+static void startCountingAllocations() {
+    gOrigMallocHook = __malloc_hook;
+    gOrigReallocHook = __realloc_hook;
+    __malloc_hook = countingMallocHook;
+    __realloc_hook = countingReallocHook;
+}
+
+static void stopCountingAllocations() {
+    __malloc_hook = gOrigMallocHook;
+    __realloc_hook = gOrigReallocHook;
+}
+
+static uint64_t toNs(const timespec& ts) {
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + ts.tv_nsec;
+}
+
+static void usage(const char* name) {
+    std::cout << "Usage: " << name << " [OPTIONS] SERVICE RECORDING\n"
+              << "\t-i N : Replay the recording N times (default 1).\n"
+              << "\t-x N : Replay N times faster than recorded, 0 for as fast as possible\n"
+              << "\t       (default 1, the original timing).\n"
+              << "\t-k   : Keep going when a transaction returns a different status than\n"
+              << "\t       it did when recorded.\n"
+              << "\n*Use record_binder tool for recording binder transactions." << std::endl;
+}
+
+int main(int argc, char** argv) {
+    if (getenv("LIBC_HOOKS_ENABLE") == nullptr) {
+        if (setenv("LIBC_HOOKS_ENABLE", "1", true /*overwrite*/) != 0) return EXIT_FAILURE;
+        execv(argv[0], argv);
+        return EXIT_FAILURE;
+    }
+
+    int iterations = 1;
+    double speedup = 1;
+    bool keepGoing = false;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "i:x:kh")) != -1) {
+        switch (opt) {
+            case 'i':
+                iterations = atoi(optarg);
+                break;
+            case 'x':
+                speedup = atof(optarg);
+                break;
+            case 'k':
+                keepGoing = true;
+                break;
+            default:
+                usage(argv[0]);
+                return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+    if (argc - optind != 2 || iterations < 1 || speedup < 0) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    const char* serviceName = argv[optind];
+    const char* recordingPath = argv[optind + 1];
+
+    unique_fd fd(open(recordingPath, O_RDONLY | O_CLOEXEC));
+    if (!fd.ok()) {
+        std::cerr << "Failed to open recording file at path " << recordingPath
+                  << " with error: " << strerror(errno) << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // Binder objects and file descriptors in a recording refer to the
+    // recording process, so only flat transactions can be replayed.
+    std::vector<RecordedTransaction> transactions;
+    size_t skipped = 0;
+    while (auto transaction = RecordedTransaction::fromFile(fd)) {
+        if (!transaction->getObjectOffsets().empty()) {
+            skipped++;
+            continue;
+        }
+        transactions.push_back(std::move(*transaction));
+    }
+    if (transactions.empty()) {
+        std::cerr << "No replayable transaction has been found in recording file: "
+                  << recordingPath << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    sp<IBinder> binder = defaultServiceManager()->checkService(String16(serviceName));
+    if (binder == nullptr) {
+        std::cerr << "Can't find service: " << serviceName << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // Prepare every parcel ahead of time so that setup isn't counted.
+    std::vector<Parcel> parcels(transactions.size());
+    for (size_t i = 0; i < transactions.size(); i++) {
+        const Parcel& recorded = transactions[i].getDataParcel();
+        parcels[i].setData(recorded.data(), recorded.dataSize());
+    }
+
+    std::vector<uint64_t> latenciesNs;
+    latenciesNs.reserve(transactions.size() * iterations);
+    size_t mismatches = 0;
+    Parcel reply;
+
+    const uint64_t firstTimestampNs = toNs(transactions[0].getTimestamp());
+    const steady_clock::time_point begin = steady_clock::now();
+    startCountingAllocations();
+    for (int iteration = 0; iteration < iterations; iteration++) {
+        const steady_clock::time_point iterationBegin = steady_clock::now();
+        for (size_t i = 0; i < transactions.size(); i++) {
+            const RecordedTransaction& transaction = transactions[i];
+            if (speedup > 0) {
+                uint64_t offsetNs = toNs(transaction.getTimestamp()) - firstTimestampNs;
+                std::this_thread::sleep_until(iterationBegin +
+                                              std::chrono::nanoseconds(
+                                                      static_cast<uint64_t>(offsetNs / speedup)));
+            }
+
+            reply.freeData();
+            steady_clock::time_point start = steady_clock::now();
+            status_t status = binder->transact(transaction.getCode(), parcels[i], &reply,
+                                               transaction.getFlags());
+            latenciesNs.push_back((steady_clock::now() - start).count());
+
+            if (status != transaction.getReturnedStatus()) {
+                mismatches++;
+                if (!keepGoing) {
+                    stopCountingAllocations();
+                    std::cerr << "Transaction " << i << " (code " << transaction.getCode()
+                              << ") returned " << statusToString(status) << " but recorded "
+                              << statusToString(transaction.getReturnedStatus())
+                              << ". Use -k to ignore." << std::endl;
+                    return EXIT_FAILURE;
+                }
+            }
+        }
+    }
+    stopCountingAllocations();
+    const double elapsedS =
+            std::chrono::duration<double>(steady_clock::now() - begin).count();
+
+    std::sort(latenciesNs.begin(), latenciesNs.end());
+    auto percentileUs = [&](double p) {
+        size_t index = std::min(latenciesNs.size() - 1,
+                                static_cast<size_t>(p * latenciesNs.size()));
+        return latenciesNs[index] / 1000.0;
+    };
+
+    std::cout << "Replayed " << latenciesNs.size() << " transactions (" << transactions.size()
+              << " x " << iterations << ", " << skipped << " with objects skipped) in "
+              << elapsedS << "s\n"
+              << "Throughput: " << latenciesNs.size() / elapsedS << " transactions/s\n"
+              << "Latency (us): p50 " << percentileUs(0.5) << " p90 " << percentileUs(0.9)
+              << " p99 " << percentileUs(0.99) << " p99.9 " << percentileUs(0.999) << " max "
+              << latenciesNs.back() / 1000.0 << "\n"
+              << "Allocations per transaction: "
+              << static_cast<double>(gAllocations) / latenciesNs.size() << "\n";
+    if (mismatches > 0) {
+        std::cout << "Status mismatches: " << mismatches << "\n";
+    }
+    return EXIT_SUCCESS;
+}
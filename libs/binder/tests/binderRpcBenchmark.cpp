@@ -129,22 +129,34 @@ static const std::initializer_list<int64_t> kTransportList = {
 };
 
 std::unique_ptr<RpcTransportCtxFactory> makeFactoryTls() {
-    auto pkey = android::makeKeyPairForSelfSignedCert();
-    CHECK_NE(pkey.get(), nullptr);
-    auto cert = android::makeSelfSignedCert(pkey.get(), android::kCertValidSeconds);
-    CHECK_NE(cert.get(), nullptr);
-
+    // All factories share one certificate, so that BM_connectSession does not measure key
+    // generation.
+    static const bssl::UniquePtr<EVP_PKEY> sPkey = android::makeKeyPairForSelfSignedCert();
+    CHECK_NE(sPkey.get(), nullptr);
+    static const bssl::UniquePtr<X509> sCert =
+            android::makeSelfSignedCert(sPkey.get(), android::kCertValidSeconds);
+    CHECK_NE(sCert.get(), nullptr);
+
+    CHECK_EQ(1, EVP_PKEY_up_ref(sPkey.get()));
+    CHECK_EQ(1, X509_up_ref(sCert.get()));
     auto verifier = std::make_shared<RpcCertificateVerifierNoOp>(OK);
-    auto auth = std::make_unique<RpcAuthPreSigned>(std::move(pkey), std::move(cert));
+    auto auth = std::make_unique<RpcAuthPreSigned>(bssl::UniquePtr<EVP_PKEY>(sPkey.get()),
+                                                   bssl::UniquePtr<X509>(sCert.get()));
     return RpcTransportCtxFactoryTls::make(verifier, std::move(auth));
 }
 
+static std::string gRpcAddr;
+static std::string gRpcTlsAddr;
 static sp<RpcSession> gSession = RpcSession::make();
 static sp<IBinder> gRpcBinder;
 // Certificate validation happens during handshake and does not affect the result of benchmarks.
 // Skip certificate validation to simplify the setup process.
 static sp<RpcSession> gSessionTls = RpcSession::make(makeFactoryTls());
 static sp<IBinder> gRpcTlsBinder;
+// Raw RPC server and session with enough threads for the multi-threaded benchmarks.
+static constexpr size_t kMaxBenchmarkThreads = 32;
+static sp<RpcSession> gSessionThreaded = RpcSession::make();
+static sp<IBinder> gRpcThreadedBinder;
 #ifdef __BIONIC__
 static const String16 kKernelBinderInstance = String16(u"binderRpcBenchmark-control");
 static sp<IBinder> gKernelBinder;
@@ -301,6 +313,58 @@ void BM_repeatBinder(benchmark::State& state) {
 }
 BENCHMARK(BM_repeatBinder)->ArgsProduct({kTransportList});
 
+// Each thread pings its own binder over one RPC session, so this shows how
+// transactions on different nodes of a session scale with the thread count.
+void BM_pingTransactionThreaded(benchmark::State& state) {
+    sp<IBinderRpcBenchmark> iface = interface_cast<IBinderRpcBenchmark>(gRpcThreadedBinder);
+    CHECK(iface != nullptr);
+
+    sp<IBinder> binder;
+    Status ret = iface->gimmeBinder(&binder);
+    CHECK(ret.isOk()) << ret;
+
+    while (state.KeepRunning()) {
+        CHECK_EQ(OK, binder->pingBinder());
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_pingTransactionThreaded)->ThreadRange(1, kMaxBenchmarkThreads)->UseRealTime();
+
+static sp<RpcSession> makeSessionForOptions(benchmark::State& state, std::string* addr) {
+    Transport transport = static_cast<Transport>(state.range(0));
+    switch (transport) {
+        case RPC:
+            *addr = gRpcAddr;
+            return RpcSession::make(RpcTransportCtxFactoryRaw::make());
+        case RPC_TLS:
+            *addr = gRpcTlsAddr;
+            return RpcSession::make(makeFactoryTls());
+        default:
+            LOG(FATAL) << "Unsupported transport value: " << transport;
+            return nullptr;
+    }
+}
+
+// Each iteration connects a new session to the server and tears it down again, which shows how
+// many clients per second the server can take on, e.g. when many of them reconnect at once.
+void BM_connectSession(benchmark::State& state) {
+    while (state.KeepRunning()) {
+        std::string addr;
+        sp<RpcSession> session = makeSessionForOptions(state, &addr);
+        CHECK_EQ(OK, session->setupUnixDomainClient(addr.c_str()));
+        CHECK_NE(nullptr, session->getRootObject());
+        CHECK(session->shutdownAndWait(true));
+    }
+
+    state.SetItemsProcessed(state.iterations());
+    SetLabel(state);
+}
+BENCHMARK(BM_connectSession)
+        ->ArgsProduct({{Transport::RPC, Transport::RPC_TLS}})
+        ->ThreadRange(1, 8)
+        ->UseRealTime();
+
 void forkRpcServer(const char* addr, const sp<RpcServer>& server) {
     if (0 == fork()) {
         prctl(PR_SET_PDEATHSIG, SIGHUP); // racey, okay
@@ -344,18 +408,27 @@ int main(int argc, char** argv) {
 
     std::string tmp = getenv("TMPDIR") ?: "/tmp";
 
-    std::string addr = tmp + "/binderRpcBenchmark";
-    (void)unlink(addr.c_str());
-    forkRpcServer(addr.c_str(), RpcServer::make(RpcTransportCtxFactoryRaw::make()));
-    setupClient(gSession, addr.c_str());
+    gRpcAddr = tmp + "/binderRpcBenchmark";
+    (void)unlink(gRpcAddr.c_str());
+    forkRpcServer(gRpcAddr.c_str(), RpcServer::make(RpcTransportCtxFactoryRaw::make()));
+    setupClient(gSession, gRpcAddr.c_str());
     gRpcBinder = gSession->getRootObject();
 
-    std::string tlsAddr = tmp + "/binderRpcTlsBenchmark";
-    (void)unlink(tlsAddr.c_str());
-    forkRpcServer(tlsAddr.c_str(), RpcServer::make(makeFactoryTls()));
-    setupClient(gSessionTls, tlsAddr.c_str());
+    gRpcTlsAddr = tmp + "/binderRpcTlsBenchmark";
+    (void)unlink(gRpcTlsAddr.c_str());
+    forkRpcServer(gRpcTlsAddr.c_str(), RpcServer::make(makeFactoryTls()));
+    setupClient(gSessionTls, gRpcTlsAddr.c_str());
     gRpcTlsBinder = gSessionTls->getRootObject();
 
+    std::string threadedAddr = tmp + "/binderRpcThreadedBenchmark";
+    (void)unlink(threadedAddr.c_str());
+    auto threadedServer = RpcServer::make(RpcTransportCtxFactoryRaw::make());
+    threadedServer->setMaxThreads(kMaxBenchmarkThreads);
+    forkRpcServer(threadedAddr.c_str(), threadedServer);
+    gSessionThreaded->setMaxOutgoingConnections(kMaxBenchmarkThreads);
+    setupClient(gSessionThreaded, threadedAddr.c_str());
+    gRpcThreadedBinder = gSessionThreaded->getRootObject();
+
     ::benchmark::RunSpecifiedBenchmarks();
     return 0;
 }
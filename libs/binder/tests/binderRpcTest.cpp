@@ -1990,6 +1990,34 @@ TEST_P(RpcTransportTest, MultipleClients) {
     for (auto& client : clients) client.run();
 }
 
+// With TLS, the second connection resumes the session of the first one, and both ends verify the
+// peer certificate of the resumed session again.
+TEST_P(RpcTransportTest, ReconnectWithSameContext) {
+    auto [socketType, rpcSecurity, certificateFormat, serverVersion] = GetParam();
+    (void)serverVersion;
+    auto server = std::make_unique<Server>();
+    ASSERT_TRUE(server->setUp(GetParam()));
+
+    Client client(server->getConnectToServerFn());
+    ASSERT_TRUE(client.setUp(GetParam()));
+
+    ASSERT_EQ(OK, trust(&client, server));
+    ASSERT_EQ(OK, trust(server, &client));
+
+    server->start();
+    client.run();
+    if (rpcSecurity == RpcSecurity::TLS) {
+        EXPECT_EQ(0u, client.getCertVerifier()->getResumedSessionVerifyCount());
+        EXPECT_EQ(0u, server->getCertVerifier()->getResumedSessionVerifyCount());
+    }
+
+    client.run();
+    if (rpcSecurity == RpcSecurity::TLS) {
+        EXPECT_EQ(1u, client.getCertVerifier()->getResumedSessionVerifyCount());
+        EXPECT_EQ(1u, server->getCertVerifier()->getResumedSessionVerifyCount());
+    }
+}
+
 TEST_P(RpcTransportTest, UntrustedServer) {
     auto [socketType, rpcSecurity, certificateFormat, serverVersion] = GetParam();
     (void)serverVersion;
@@ -2194,6 +2222,71 @@ INSTANTIATE_TEST_SUITE_P(BinderRpc, RpcTransportTest,
                          ::testing::ValuesIn(RpcTransportTest::getRpcTranportTestParams()),
                          RpcTransportTest::PrintParamInfo);
 
+class RpcTransportShmTest : public testing::Test {
+public:
+    void SetUp() override {
+        if constexpr (!kEnableRpcThreads) {
+            GTEST_SKIP() << "Test skipped because threads were disabled at build time";
+        }
+        unique_fd clientFd, serverFd;
+        ASSERT_TRUE(binder::Socketpair(SOCK_STREAM, &clientFd, &serverFd));
+        auto factory = RpcTransportCtxFactoryShm::make();
+        auto serverCtx = factory->newServerCtx();
+        auto clientCtx = factory->newClientCtx();
+
+        std::thread serverThread([&] {
+            mServer = serverCtx->newTransport(RpcTransportFd(std::move(serverFd)),
+                                              mFdTrigger.get());
+        });
+        mClient = clientCtx->newTransport(RpcTransportFd(std::move(clientFd)), mFdTrigger.get());
+        serverThread.join();
+        ASSERT_NE(nullptr, mClient);
+        ASSERT_NE(nullptr, mServer);
+    }
+
+protected:
+    std::unique_ptr<FdTrigger> mFdTrigger = FdTrigger::make();
+    std::unique_ptr<RpcTransport> mClient;
+    std::unique_ptr<RpcTransport> mServer;
+};
+
+TEST_F(RpcTransportShmTest, MessageLargerThanRing) {
+    std::string message(1024 * 1024, '\0');
+    for (size_t i = 0; i < message.size(); i++) message[i] = static_cast<char>(i % 251);
+
+    std::thread writer([&] {
+        iovec iov{message.data(), message.size()};
+        EXPECT_EQ(OK, mClient->interruptableWriteFully(mFdTrigger.get(), &iov, 1, std::nullopt,
+                                                       nullptr));
+    });
+    std::string received(message.size(), '\0');
+    iovec iov{received.data(), received.size()};
+    EXPECT_EQ(OK,
+              mServer->interruptableReadFully(mFdTrigger.get(), &iov, 1, std::nullopt, nullptr));
+    writer.join();
+    EXPECT_EQ(message, received);
+}
+
+TEST_F(RpcTransportShmTest, PeerDeath) {
+    EXPECT_EQ(WOULD_BLOCK, mServer->pollRead());
+    mClient = nullptr;
+    EXPECT_EQ(DEAD_OBJECT, mServer->pollRead());
+
+    char c;
+    iovec iov{&c, sizeof(c)};
+    EXPECT_EQ(DEAD_OBJECT,
+              mServer->interruptableReadFully(mFdTrigger.get(), &iov, 1, std::nullopt, nullptr));
+}
+
+TEST_F(RpcTransportShmTest, RejectsFileDescriptors) {
+    std::vector<std::variant<unique_fd, borrowed_fd>> fds;
+    fds.emplace_back(borrowed_fd(STDIN_FILENO));
+    char c = 0;
+    iovec iov{&c, sizeof(c)};
+    EXPECT_EQ(BAD_VALUE,
+              mClient->interruptableWriteFully(mFdTrigger.get(), &iov, 1, std::nullopt, &fds));
+}
+
 class RpcTransportTlsKeyTest
       : public testing::TestWithParam<
                 std::tuple<SocketType, RpcCertificateFormat, RpcKeyFormat, uint32_t>> {
@@ -31,6 +31,7 @@
 #include <binder/RpcThreads.h>
 #include <binder/RpcTransport.h>
 #include <binder/RpcTransportRaw.h>
+#include <binder/RpcTransportShm.h>
 #include <unistd.h>
 #include <cinttypes>
 #include <string>
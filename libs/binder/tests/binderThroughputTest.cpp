@@ -20,6 +20,7 @@ using namespace android;
 
 enum BinderWorkerServiceCode {
     BINDER_NOP = IBinder::FIRST_CALL_TRANSACTION,
+    BINDER_READ_BINDERS,
 };
 
 #define ASSERT_TRUE(cond) \
@@ -44,6 +45,16 @@ public:
         switch (code) {
         case BINDER_NOP:
             return NO_ERROR;
+        case BINDER_READ_BINDERS: {
+            // Unflattening each binder looks up a proxy for its handle.
+            int32_t count = data.readInt32();
+            for (int32_t i = 0; i < count; i++) {
+                sp<IBinder> binder;
+                status_t ret = data.readStrongBinder(&binder);
+                if (ret != NO_ERROR) return ret;
+            }
+            return NO_ERROR;
+        }
         default:
             return UNKNOWN_TRANSACTION;
         };
@@ -51,6 +62,7 @@ public:
 };
 
 static uint64_t warn_latency = std::numeric_limits<uint64_t>::max();
+static int binder_count = 0;
 
 struct ProcResults {
     vector<uint64_t> data;
@@ -233,6 +245,12 @@ void worker_fx(int num,
         workers.push_back(serviceMgr->waitForService(generateServiceName(i)));
     }
 
+    // Binders sent with every transaction, which the servers hold proxies for.
+    vector<sp<IBinder> > callbacks;
+    for (int i = 0; i < binder_count; i++) {
+        callbacks.push_back(sp<BBinder>::make());
+    }
+
     p.signal();
     p.wait();
 
@@ -245,13 +263,21 @@ void worker_fx(int num,
             Parcel data, reply;
             int target = cs_pair ? num % server_count : rand() % workers.size();
             int sz = payload_size;
-
+            uint32_t code = BINDER_NOP;
+
+            if (!callbacks.empty()) {
+                code = BINDER_READ_BINDERS;
+                data.writeInt32(callbacks.size());
+                for (const auto& callback : callbacks) {
+                    data.writeStrongBinder(callback);
+                }
+            }
             while (sz >= sizeof(uint32_t)) {
                 data.writeInt32(0);
                 sz -= sizeof(uint32_t);
             }
             start = chrono::high_resolution_clock::now();
-            status_t ret = workers[target]->transact(BINDER_NOP, data, &reply);
+            status_t ret = workers[target]->transact(code, data, &reply);
             end = chrono::high_resolution_clock::now();
 
             uint64_t cur_time = uint64_t(chrono::duration_cast<chrono::nanoseconds>(end - start).count());
@@ -387,6 +413,7 @@ int main(int argc, char *argv[])
             cout << "\t-t      : Run training round." << endl;
             cout << "\t-w N    : Specify total number of workers." << endl;
             cout << "\t-d FILE : Dump raw data to file." << endl;
+            cout << "\t-b N    : Send N binder objects with every transaction." << endl;
             return 0;
         }
         if (string(argv[i]) == "-w") {
@@ -445,6 +472,17 @@ int main(int argc, char *argv[])
             i++;
             continue;
         }
+        if (string(argv[i]) == "-b") {
+            if (i + 1 == argc) {
+                cout << "-b requires an argument\n" << endl;
+                exit(EXIT_FAILURE);
+            }
+            // Servers look up a proxy for each binder, from as many binder threads as there
+            // are concurrent clients.
+            binder_count = atoi(argv[i+1]);
+            i++;
+            continue;
+        }
         if (string(argv[i]) == "-d") {
             if (i + 1 == argc) {
                 cout << "-d requires an argument\n" << endl;
@@ -73,9 +73,13 @@ public:
     [[nodiscard]] status_t addTrustedPeerCertificate(RpcCertificateFormat format,
                                                      const std::vector<uint8_t>& cert);
 
+    // The number of verify() calls for connections that resumed an earlier TLS session.
+    size_t getResumedSessionVerifyCount();
+
 private:
     std::mutex mMutex; // for below
     std::vector<bssl::UniquePtr<X509>> mTrustedPeerCertificates;
+    size_t mResumedSessionVerifyCount = 0;
 };
 
 // A RpcCertificateVerifier that does not verify anything.
@@ -17,10 +17,14 @@
 #include <android-base/logging.h>
 #include <android-base/parseint.h>
 #include <android-base/strings.h>
+#include <android-base/unique_fd.h>
 #include <binder/Binder.h>
+#include <fcntl.h>
 #include <sys/types.h>
+#include <unistd.h>
 #include <fstream>
-#include <regex>
+#include <functional>
+#include <string_view>
 
 #include <binderdebug/BinderDebug.h>
 
@@ -39,42 +43,111 @@ static std::string contextToString(BinderDebugContext context) {
     }
 }
 
-static status_t scanBinderContext(pid_t pid, const std::string& contextName,
-                                  std::function<void(const std::string&)> eachLine) {
-    std::ifstream ifs("/dev/binderfs/binder_logs/proc/" + std::to_string(pid));
-    if (!ifs.is_open()) {
-        ifs.open("/d/binder/proc/" + std::to_string(pid));
-        if (!ifs.is_open()) {
+// binder_logs files are generated by the driver as they are read, and can't be mapped. Read them
+// in chunks into a fixed buffer, so that lines cost no allocation, and so that a caller which has
+// what it needs can stop before the driver formats the rest of the file.
+static status_t forEachLine(const std::string& path, const std::string& fallbackPath,
+                            const std::function<bool(std::string_view)>& eachLine) {
+    base::unique_fd fd(TEMP_FAILURE_RETRY(open(path.c_str(), O_RDONLY | O_CLOEXEC)));
+    if (!fd.ok()) {
+        fd.reset(TEMP_FAILURE_RETRY(open(fallbackPath.c_str(), O_RDONLY | O_CLOEXEC)));
+        if (!fd.ok()) {
             return -errno;
         }
     }
 
-    bool isDesiredContext = false;
-    std::string line;
-    while (getline(ifs, line)) {
-        if (base::StartsWith(line, "context")) {
-            isDesiredContext = base::Split(line, " ").back() == contextName;
-            continue;
+    char buffer[4096];
+    std::string partial; // a line split across two reads
+    while (true) {
+        ssize_t size = TEMP_FAILURE_RETRY(read(fd.get(), buffer, sizeof(buffer)));
+        if (size < 0) {
+            return -errno;
         }
-        if (!isDesiredContext) {
-            continue;
+        if (size == 0) {
+            break;
+        }
+
+        std::string_view chunk(buffer, size);
+        while (!chunk.empty()) {
+            size_t newline = chunk.find('\n');
+            if (newline == std::string_view::npos) {
+                partial.append(chunk);
+                break;
+            }
+            std::string_view line = chunk.substr(0, newline);
+            chunk.remove_prefix(newline + 1);
+
+            bool more;
+            if (partial.empty()) {
+                more = eachLine(line);
+            } else {
+                partial.append(line);
+                more = eachLine(partial);
+                partial.clear();
+            }
+            if (!more) {
+                return OK;
+            }
         }
-        eachLine(line);
+    }
+    if (!partial.empty()) {
+        eachLine(partial);
     }
     return OK;
 }
 
+// eachLine returns false to stop scanning
+static status_t scanBinderContext(pid_t pid, const std::string& contextName,
+                                  std::function<bool(std::string_view)> eachLine) {
+    bool isDesiredContext = false;
+    return forEachLine("/dev/binderfs/binder_logs/proc/" + std::to_string(pid),
+                       "/d/binder/proc/" + std::to_string(pid), [&](std::string_view line) {
+                           if (base::StartsWith(line, "context")) {
+                               isDesiredContext =
+                                       line.substr(line.rfind(' ') + 1) == contextName;
+                               return true;
+                           }
+                           if (!isDesiredContext) {
+                               return true;
+                           }
+                           return eachLine(line);
+                       });
+}
+
+// Counts a thread line, such as:
+// thread 2999: l 00 need_return 1 tr 0
+static void countBinderThread(std::string_view line, uint32_t* threadUsage,
+                              uint32_t* threadCount) {
+    auto pos = line.find("l ");
+    if (pos == std::string_view::npos || pos + 3 >= line.size()) {
+        return;
+    }
+    // "1" is waiting in binder driver
+    // "2" is poll. It's impossible to tell if these are in use.
+    //     and HIDL default code doesn't use it.
+    bool isInUse = line[pos + 2] != '1';
+    // "0" is a thread that has called into binder
+    // "1" is looper thread
+    // "2" is main looper thread
+    bool isBinderThread = line[pos + 3] != '0';
+    if (!isBinderThread) {
+        return;
+    }
+    if (isInUse) {
+        (*threadUsage)++;
+    }
+
+    (*threadCount)++;
+}
+
 // Examples of what we are looking at:
 // node 66730: u00007590061890e0 c0000759036130950 pri 0:120 hs 1 hw 1 ls 0 lw 0 is 2 iw 2 tr 1 proc 2300 1790
 // thread 2999: l 00 need_return 1 tr 0
 status_t getBinderPidInfo(BinderDebugContext context, pid_t pid, BinderPidInfo* pidInfo) {
-    std::smatch match;
-    static const std::regex kReferencePrefix("^\\s*node \\d+:\\s+u([0-9a-f]+)\\s+c([0-9a-f]+)\\s+");
-    static const std::regex kThreadPrefix("^\\s*thread \\d+:\\s+l\\s+(\\d)(\\d)");
     std::string contextStr = contextToString(context);
-    status_t ret = scanBinderContext(pid, contextStr, [&](const std::string& line) {
+    status_t ret = scanBinderContext(pid, contextStr, [&](std::string_view line) {
         if (base::StartsWith(line, "  node")) {
-            std::vector<std::string> splitString = base::Tokenize(line, " ");
+            std::vector<std::string> splitString = base::Tokenize(std::string(line), " ");
             bool pids = false;
             uint64_t ptr = 0;
             for (const auto& token : splitString) {
@@ -82,7 +155,7 @@ status_t getBinderPidInfo(BinderDebugContext context, pid_t pid, BinderPidInfo*
                     const std::string ptrString = "0x" + token.substr(1);
                     if (!::android::base::ParseUint(ptrString.c_str(), &ptr)) {
                         LOG(ERROR) << "Failed to parse pointer: " << ptrString;
-                        return;
+                        return true;
                     }
                 } else {
                     // The last numbers in the line after "proc" are all client PIDs
@@ -92,83 +165,79 @@ status_t getBinderPidInfo(BinderDebugContext context, pid_t pid, BinderPidInfo*
                         int32_t pid;
                         if (!::android::base::ParseInt(token, &pid)) {
                             LOG(ERROR) << "Failed to parse pid int: " << token;
-                            return;
+                            return true;
                         }
                         if (ptr == 0) {
                             LOG(ERROR) << "We failed to parse the pointer, so we can't add the refPids";
-                            return;
+                            return true;
                         }
                         pidInfo->refPids[ptr].push_back(pid);
                     }
                 }
             }
         } else if (base::StartsWith(line, "  thread")) {
-            auto pos = line.find("l ");
-            if (pos != std::string::npos) {
-                // "1" is waiting in binder driver
-                // "2" is poll. It's impossible to tell if these are in use.
-                //     and HIDL default code doesn't use it.
-                bool isInUse = line.at(pos + 2) != '1';
-                // "0" is a thread that has called into binder
-                // "1" is looper thread
-                // "2" is main looper thread
-                bool isBinderThread = line.at(pos + 3) != '0';
-                if (!isBinderThread) {
-                    return;
-                }
-                if (isInUse) {
-                    pidInfo->threadUsage++;
-                }
-
-                pidInfo->threadCount++;
-            }
+            countBinderThread(line, &pidInfo->threadUsage, &pidInfo->threadCount);
         }
+        return true;
     });
     return ret;
 }
 
+status_t getBinderThreadPoolStats(BinderDebugContext context, pid_t pid,
+                                  BinderThreadPoolStats* stats) {
+    std::string contextStr = contextToString(context);
+    *stats = {};
+    return scanBinderContext(pid, contextStr, [&](std::string_view line) {
+        if (base::StartsWith(line, "  thread")) {
+            countBinderThread(line, &stats->threadUsage, &stats->threadCount);
+            return true;
+        }
+        // the driver lists all threads first, each followed by its transactions
+        return base::StartsWith(line, "    ");
+    });
+}
+
 // Examples of what we are looking at:
 // ref 52493: desc 910 node 52492 s 1 w 1 d 0000000000000000
 // node 29413: u00007803fc982e80 c000078042c982210 pri 0:139 hs 1 hw 1 ls 0 lw 0 is 2 iw 2 tr 1 proc 488 683
 status_t getBinderClientPids(BinderDebugContext context, pid_t pid, pid_t servicePid,
                              int32_t handle, std::vector<pid_t>* pids) {
-    std::smatch match;
-    static const std::regex kNodeNumber("^\\s+ref \\d+:\\s+desc\\s+(\\d+)\\s+node\\s+(\\d+).*");
     std::string contextStr = contextToString(context);
     int32_t node;
-    status_t ret = scanBinderContext(pid, contextStr, [&](const std::string& line) {
-        if (!base::StartsWith(line, "  ref")) return;
+    status_t ret = scanBinderContext(pid, contextStr, [&](std::string_view line) {
+        if (!base::StartsWith(line, "  ref")) return true;
 
-        std::vector<std::string> splitString = base::Tokenize(line, " ");
+        std::vector<std::string> splitString = base::Tokenize(std::string(line), " ");
         if (splitString.size() < 12) {
             LOG(ERROR) << "Failed to parse binder_logs ref entry. Expecting size greater than 11, but got: " << splitString.size();
-            return;
+            return true;
         }
         int32_t desc;
         if (!::android::base::ParseInt(splitString[3].c_str(), &desc)) {
             LOG(ERROR) << "Failed to parse desc int: " << splitString[3];
-            return;
+            return true;
         }
         if (handle != desc) {
-            return;
+            return true;
         }
         if (!::android::base::ParseInt(splitString[5].c_str(), &node)) {
             LOG(ERROR) << "Failed to parse node int: " << splitString[5];
-            return;
+            return true;
         }
         LOG(INFO) << "Parsed the node: " << node;
+        return true;
     });
     if (ret != OK) {
         return ret;
     }
 
-    ret = scanBinderContext(servicePid, contextStr, [&](const std::string& line) {
-        if (!base::StartsWith(line, "  node")) return;
+    ret = scanBinderContext(servicePid, contextStr, [&](std::string_view line) {
+        if (!base::StartsWith(line, "  node")) return true;
 
-        std::vector<std::string> splitString = base::Tokenize(line, " ");
+        std::vector<std::string> splitString = base::Tokenize(std::string(line), " ");
         if (splitString.size() < 21) {
             LOG(ERROR) << "Failed to parse binder_logs node entry. Expecting size greater than 20, but got: " << splitString.size();
-            return;
+            return true;
         }
 
         // remove the colon
@@ -176,11 +245,11 @@ status_t getBinderClientPids(BinderDebugContext context, pid_t pid, pid_t servic
         int32_t matchedNode;
         if (!::android::base::ParseInt(nodeString.c_str(), &matchedNode)) {
             LOG(ERROR) << "Failed to parse node int: " << nodeString;
-            return;
+            return true;
         }
 
         if (node != matchedNode) {
-            return;
+            return true;
         }
         bool pidsSection = false;
         for (const auto& token : splitString) {
@@ -190,11 +259,12 @@ status_t getBinderClientPids(BinderDebugContext context, pid_t pid, pid_t servic
                 int32_t pid;
                 if (!::android::base::ParseInt(token.c_str(), &pid)) {
                     LOG(ERROR) << "Failed to parse PID int: " << token;
-                    return;
+                    return true;
                 }
                 pids->push_back(pid);
             }
         }
+        return true;
     });
     return ret;
 }
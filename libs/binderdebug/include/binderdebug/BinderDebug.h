@@ -28,6 +28,14 @@ struct BinderPidInfo {
     uint32_t threadCount;                           // number of threads total
 };
 
+struct BinderThreadPoolStats {
+    uint32_t threadUsage; // number of threads in use
+    uint32_t threadCount; // number of threads total
+
+    // whether incoming transactions have to wait for a thread to become free
+    bool exhausted() const { return threadCount > 0 && threadUsage >= threadCount; }
+};
+
 enum class BinderDebugContext {
     BINDER,
     HWBINDER,
@@ -38,6 +46,14 @@ enum class BinderDebugContext {
  * pid is the pid of the service
  */
 status_t getBinderPidInfo(BinderDebugContext context, pid_t pid, BinderPidInfo* pidInfo);
+/**
+ * Counts the binder threads of a process, like getBinderPidInfo, without parsing its nodes.
+ * Reading stops once the driver has listed the threads, so this is cheap enough to poll every
+ * process periodically.
+ * pid is the pid of the service
+ */
+status_t getBinderThreadPoolStats(BinderDebugContext context, pid_t pid,
+                                  BinderThreadPoolStats* stats);
 /**
  * pid is typically the pid of this process that is making the query
  */
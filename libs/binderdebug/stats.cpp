@@ -45,8 +45,8 @@ extern "C" int main() {
         pid_t pid;
         CHECK_EQ(OK, binder->getDebugPid(&pid));
 
-        BinderPidInfo info;
-        CHECK_EQ(OK, getBinderPidInfo(BinderDebugContext::BINDER, pid, &info));
+        BinderThreadPoolStats info;
+        CHECK_EQ(OK, getBinderThreadPoolStats(BinderDebugContext::BINDER, pid, &info));
 
         std::vector<pid_t> clientPids;
         CHECK_EQ(OK,
@@ -60,6 +60,14 @@ TEST(BinderDebugTests, BinderThreads) {
     EXPECT_GE(pidInfo.threadCount, 1);
 }
 
+TEST(BinderDebugTests, BinderThreadPoolStats) {
+    BinderThreadPoolStats stats;
+    const auto& status = getBinderThreadPoolStats(BinderDebugContext::BINDER, getpid(), &stats);
+    ASSERT_EQ(status, OK);
+    EXPECT_LE(stats.threadUsage, stats.threadCount);
+    EXPECT_GE(stats.threadCount, 1);
+}
+
 extern "C" {
 int main(int argc, char** argv) {
     ::testing::InitGoogleTest(&argc, argv);
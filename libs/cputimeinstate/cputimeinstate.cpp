@@ -349,6 +349,18 @@ static std::optional<bool> uidUpdatedSince(uint32_t uid, uint64_t lastUpdate,
     return true;
 }
 
+// Like uidUpdatedSince, but remembers the result for each uid in updatedUids. The time in state
+// maps have an entry per bucket of each uid, and looking up the last update time for every one
+// of them would cost a syscall per entry rather than per uid.
+static std::optional<bool> uidUpdatedSinceCached(uint32_t uid, uint64_t lastUpdate,
+                                                 uint64_t *newLastUpdate,
+                                                 std::unordered_map<uint32_t, bool> *updatedUids) {
+    if (auto it = updatedUids->find(uid); it != updatedUids->end()) return it->second;
+    auto uidUpdated = uidUpdatedSince(uid, lastUpdate, newLastUpdate);
+    if (uidUpdated.has_value()) updatedUids->emplace(uid, *uidUpdated);
+    return uidUpdated;
+}
+
 // Retrieve the times in ns that each uid spent running at each CPU freq.
 // Return contains no value on error, otherwise it contains a map from uids to vectors of vectors
 // using the format:
@@ -377,23 +389,25 @@ getUidsUpdatedCpuFreqTimes(uint64_t *lastUpdate) {
     for (const auto &freqList : gPolicyFreqs) mapFormat.emplace_back(freqList.size(), 0);
 
     uint64_t newLastUpdate = lastUpdate ? *lastUpdate : 0;
+    std::unordered_map<uint32_t, bool> updatedUids;
     std::vector<tis_val_t> vals(gNCpus);
     do {
         if (lastUpdate) {
-            auto uidUpdated = uidUpdatedSince(key.uid, *lastUpdate, &newLastUpdate);
+            auto uidUpdated =
+                    uidUpdatedSinceCached(key.uid, *lastUpdate, &newLastUpdate, &updatedUids);
             if (!uidUpdated.has_value()) return {};
             if (!*uidUpdated) continue;
         }
         if (findMapEntry(gTisMapFd, &key, vals.data())) return {};
-        if (map.find(key.uid) == map.end()) map.emplace(key.uid, mapFormat);
+        auto &uidTimes = map.try_emplace(key.uid, mapFormat).first->second;
 
         auto offset = key.bucket * FREQS_PER_ENTRY;
         auto nextOffset = (key.bucket + 1) * FREQS_PER_ENTRY;
         for (uint32_t i = 0; i < gNPolicies; ++i) {
             if (offset >= gPolicyFreqs[i].size()) continue;
-            auto begin = map[key.uid][i].begin() + offset;
+            auto begin = uidTimes[i].begin() + offset;
             auto end = nextOffset < gPolicyFreqs[i].size() ? begin + FREQS_PER_ENTRY :
-                map[key.uid][i].end();
+                uidTimes[i].end();
             for (const auto &cpu : gPolicyCpus[i]) {
                 std::transform(begin, end, std::begin(vals[gCpuIndexMap[cpu]].ar), begin,
                                std::plus<uint64_t>());
@@ -492,21 +506,23 @@ std::optional<std::unordered_map<uint32_t, concurrent_time_t>> getUidsUpdatedCon
     std::vector<uint64_t>::iterator activeBegin, activeEnd, policyBegin, policyEnd;
 
     uint64_t newLastUpdate = lastUpdate ? *lastUpdate : 0;
+    std::unordered_map<uint32_t, bool> updatedUids;
     do {
         if (key.bucket > (gNCpus - 1) / CPUS_PER_ENTRY) return {};
         if (lastUpdate) {
-            auto uidUpdated = uidUpdatedSince(key.uid, *lastUpdate, &newLastUpdate);
+            auto uidUpdated =
+                    uidUpdatedSinceCached(key.uid, *lastUpdate, &newLastUpdate, &updatedUids);
             if (!uidUpdated.has_value()) return {};
             if (!*uidUpdated) continue;
         }
         if (findMapEntry(gConcurrentMapFd, &key, vals.data())) return {};
-        if (ret.find(key.uid) == ret.end()) ret.emplace(key.uid, retFormat);
+        auto &uidTimes = ret.try_emplace(key.uid, retFormat).first->second;
 
         auto offset = key.bucket * CPUS_PER_ENTRY;
         auto nextOffset = (key.bucket + 1) * CPUS_PER_ENTRY;
 
-        activeBegin = ret[key.uid].active.begin();
-        activeEnd = nextOffset < gNCpus ? activeBegin + CPUS_PER_ENTRY : ret[key.uid].active.end();
+        activeBegin = uidTimes.active.begin();
+        activeEnd = nextOffset < gNCpus ? activeBegin + CPUS_PER_ENTRY : uidTimes.active.end();
 
         for (uint32_t cpu = 0; cpu < gNCpus; ++cpu) {
             std::transform(activeBegin, activeEnd, std::begin(vals[cpu].active), activeBegin,
@@ -515,9 +531,9 @@ std::optional<std::unordered_map<uint32_t, concurrent_time_t>> getUidsUpdatedCon
 
         for (uint32_t policy = 0; policy < gNPolicies; ++policy) {
             if (offset >= gPolicyCpus[policy].size()) continue;
-            policyBegin = ret[key.uid].policy[policy].begin() + offset;
+            policyBegin = uidTimes.policy[policy].begin() + offset;
             policyEnd = nextOffset < gPolicyCpus[policy].size() ? policyBegin + CPUS_PER_ENTRY
-                                                                : ret[key.uid].policy[policy].end();
+                                                                : uidTimes.policy[policy].end();
 
             for (const auto &cpu : gPolicyCpus[policy]) {
                 std::transform(policyBegin, policyEnd, std::begin(vals[gCpuIndexMap[cpu]].policy),
@@ -0,0 +1,62 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+#include <ftl/flat_map.h>
+#include <ftl/small_map.h>
+
+#include <cstdint>
+
+namespace android {
+namespace {
+
+// Keys spread out like PhysicalDisplayId values, which encode the port in the low bits.
+constexpr uint64_t key(int64_t i) {
+  return (static_cast<uint64_t>(i) * 0x9e3779b97f4a7c15ull) | 0x42;
+}
+
+// Looks up every key of a map with state.range(0) mappings, which stay inline. SmallMap tends to
+// win up to about 16 mappings, and FlatMap beyond.
+template <typename Map>
+void lookup(benchmark::State& state) {
+  Map map;
+  for (int64_t i = 0; i < state.range(0); i++) {
+    map.try_emplace(key(i), i);
+  }
+
+  for (auto _ : state) {
+    for (int64_t i = 0; i < state.range(0); i++) {
+      benchmark::DoNotOptimize(map.get(key(i)));
+    }
+  }
+
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void smallMapLookup(benchmark::State& state) {
+  lookup<ftl::SmallMap<uint64_t, int64_t, 64>>(state);
+}
+BENCHMARK(smallMapLookup)->RangeMultiplier(2)->Range(1, 64);
+
+void flatMapLookup(benchmark::State& state) {
+  lookup<ftl::FlatMap<uint64_t, int64_t, 64>>(state);
+}
+BENCHMARK(flatMapLookup)->RangeMultiplier(2)->Range(1, 64);
+
+}  // namespace
+}  // namespace android
+
+BENCHMARK_MAIN();
@@ -0,0 +1,193 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <ftl/flat_map.h>
+#include <gtest/gtest.h>
+
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std::string_literals;
+using namespace std::string_view_literals;
+
+namespace android::test {
+
+using ftl::FlatMap;
+
+// Keep in sync with example usage in header file.
+TEST(FlatMap, Example) {
+  ftl::FlatMap<int, std::string, 3> map;
+  EXPECT_TRUE(map.empty());
+  EXPECT_FALSE(map.dynamic());
+
+  map = ftl::init::map<int, std::string>(123, "abc")(-1)(42, 3u, '?');
+  EXPECT_EQ(map.size(), 3u);
+  EXPECT_FALSE(map.dynamic());
+
+  EXPECT_TRUE(map.contains(123));
+  EXPECT_EQ(map.get(42).transform([](const std::string& s) { return s.size(); }), 3u);
+  EXPECT_EQ(map.begin()->first, -1);
+
+  map.emplace_or_replace(0, "vanilla", 2u, 3u);
+  EXPECT_TRUE(map.dynamic());
+
+  EXPECT_EQ(map, FlatMap(ftl::init::map(-1, ""sv)(0, "nil"sv)(42, "???"sv)(123, "abc"sv)));
+}
+
+TEST(FlatMap, Construct) {
+  {
+    // Default constructor.
+    FlatMap<int, std::string, 2> map;
+
+    EXPECT_TRUE(map.empty());
+    EXPECT_FALSE(map.dynamic());
+  }
+  {
+    // In-place constructor with implicit size.
+    FlatMap map = ftl::init::map<int, std::string>(123, "abc")(-1)(42, 3u, '?');
+
+    static_assert(std::is_same_v<decltype(map), FlatMap<int, std::string, 3>>);
+    EXPECT_EQ(map.size(), 3u);
+    EXPECT_EQ(map.max_size(), 3u);
+    EXPECT_FALSE(map.dynamic());
+
+    EXPECT_EQ(map, FlatMap(ftl::init::map(-1, ""sv)(42, "???"sv)(123, "abc"sv)));
+  }
+  {
+    // Zero capacity.
+    FlatMap<char, std::string, 0> map = ftl::init::map('M', "mega")('G', "giga");
+
+    EXPECT_EQ(map.size(), 2u);
+    EXPECT_TRUE(map.dynamic());
+    EXPECT_EQ(map.begin()->first, 'G');
+  }
+}
+
+TEST(FlatMap, UniqueKeys) {
+  // Duplicate mappings are discarded, and the first mapping of each key is kept.
+  const FlatMap map = ftl::init::map(3, 'a')(1, 'b')(3, 'c')(2, 'd')(1, 'e');
+
+  EXPECT_EQ(map.size(), 3u);
+  EXPECT_EQ(map.max_size(), 5u);
+  EXPECT_EQ(map, FlatMap(ftl::init::map(1, 'b')(2, 'd')(3, 'a')));
+}
+
+TEST(FlatMap, Sorted) {
+  FlatMap<int, int, 4> map;
+  for (const int key : {5, -3, 8, 0, 2, 7, -1}) {
+    EXPECT_TRUE(map.try_emplace(key, key * 10).second);
+  }
+  EXPECT_TRUE(map.dynamic());
+
+  std::vector<int> keys;
+  for (const auto& [key, value] : map) {
+    EXPECT_EQ(value, key * 10);
+    keys.push_back(key);
+  }
+  EXPECT_EQ(keys, (std::vector{-3, -1, 0, 2, 5, 7, 8}));
+}
+
+TEST(FlatMap, Get) {
+  FlatMap map = ftl::init::map('a', 'A')('b', 'B')('c', 'C');
+
+  EXPECT_EQ(map.get('c'), 'C');
+  EXPECT_FALSE(map.get('d'));
+  EXPECT_EQ(map.find('d'), map.end());
+  EXPECT_EQ(map.find('b'), map.begin() + 1);
+
+  map.get('a').value().get() = 'Z';
+  EXPECT_EQ(map.get('a'), 'Z');
+}
+
+TEST(FlatMap, TryEmplace) {
+  FlatMap<int, std::string, 2> map;
+  {
+    const auto [it, ok] = map.try_emplace(2, "two");
+    ASSERT_TRUE(ok);
+    EXPECT_EQ(it->second, "two");
+  }
+  {
+    const auto [it, ok] = map.try_emplace(1, "one");
+    ASSERT_TRUE(ok);
+    EXPECT_EQ(it, map.begin());
+  }
+  {
+    const auto [it, ok] = map.try_emplace(2, "deux");
+    EXPECT_FALSE(ok);
+    EXPECT_EQ(it->second, "two");
+  }
+  EXPECT_EQ(map, FlatMap(ftl::init::map(1, "one"s)(2, "two"s)));
+}
+
+TEST(FlatMap, TryReplace) {
+  FlatMap map = ftl::init::map<int, std::string>(1, "a")(2, "B");
+
+  EXPECT_EQ(map.try_replace(3, "c"), map.end());
+  EXPECT_EQ(map.try_replace(2, "b")->second, "b");
+
+  // Replace with a value the mapping refers to.
+  EXPECT_EQ(map.try_replace(1, map.get(2)->get() + 'c')->second, "bc");
+}
+
+TEST(FlatMap, EmplaceOrReplace) {
+  FlatMap<int, std::string, 2> map;
+
+  EXPECT_TRUE(map.emplace_or_replace(2, "b").second);
+  EXPECT_FALSE(map.emplace_or_replace(2, "B").second);
+  EXPECT_TRUE(map.emplace_or_replace(1, "a").second);
+
+  EXPECT_EQ(map, FlatMap(ftl::init::map(1, "a"sv)(2, "B"sv)));
+}
+
+TEST(FlatMap, Erase) {
+  FlatMap map = ftl::init::map(1, '1')(2, '2')(3, '3')(4, '4');
+
+  EXPECT_FALSE(map.erase(0));
+  EXPECT_TRUE(map.erase(2));
+  EXPECT_EQ(map, FlatMap(ftl::init::map(1, '1')(3, '3')(4, '4')));
+
+  EXPECT_TRUE(map.erase(1));
+  EXPECT_TRUE(map.erase(4));
+  EXPECT_EQ(map, FlatMap(ftl::init::map(3, '3')));
+
+  EXPECT_TRUE(map.erase(3));
+  EXPECT_TRUE(map.empty());
+}
+
+TEST(FlatMap, Clear) {
+  FlatMap map = ftl::init::map(1, '1')(2, '2')(3, '3');
+  map.clear();
+
+  EXPECT_TRUE(map.empty());
+  EXPECT_FALSE(map.dynamic());
+}
+
+TEST(FlatMap, Compare) {
+  // Descending order of keys.
+  FlatMap<int, char, 3, std::greater<int>> map;
+  map.try_emplace(1, 'a');
+  map.try_emplace(3, 'c');
+  map.try_emplace(2, 'b');
+
+  EXPECT_EQ(map.begin()->first, 3);
+  EXPECT_EQ(map.get(1), 'a');
+  EXPECT_TRUE(map.erase(3));
+  EXPECT_EQ(map.begin()->first, 2);
+}
+
+}  // namespace android::test
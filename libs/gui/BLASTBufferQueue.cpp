@@ -1344,6 +1344,11 @@ status_t BLASTBufferQueue::BufferReleaseReader::readBlocking(ReleaseCallbackId&
         return WOULD_BLOCK;
     }
 
+    return readNonBlocking(outId, outFence, outMaxAcquiredBufferCount);
+}
+
+status_t BLASTBufferQueue::BufferReleaseReader::readNonBlocking(
+        ReleaseCallbackId& outId, sp<Fence>& outFence, uint32_t& outMaxAcquiredBufferCount) {
     std::lock_guard lock{mMutex};
     return mEndpoint->readReleaseFence(outId, outFence, outMaxAcquiredBufferCount);
 }
@@ -1360,23 +1365,43 @@ void BLASTBufferQueue::BufferReleaseThread::start(const sp<BLASTBufferQueue>& bb
     mReader = bbq->mBufferReleaseReader;
     std::thread([running = mRunning, reader = mReader, weakBbq = wp<BLASTBufferQueue>(bbq)]() {
         pthread_setname_np(pthread_self(), "BufferReleaseThread");
+        std::vector<BufferRelease> releases;
+        releases.reserve(kMaxReleasesPerBatch);
         while (*running) {
-            ReleaseCallbackId id;
-            sp<Fence> fence;
-            uint32_t maxAcquiredBufferCount;
-            if (status_t status = reader->readBlocking(id, fence, maxAcquiredBufferCount);
+            releases.clear();
+            BufferRelease& release = releases.emplace_back();
+            if (status_t status = reader->readBlocking(release.id, release.fence,
+                                                       release.maxAcquiredBufferCount);
                 status != OK) {
                 continue;
             }
+            // Pick up the releases that arrived in the meantime.
+            while (releases.size() < kMaxReleasesPerBatch) {
+                BufferRelease& next = releases.emplace_back();
+                if (reader->readNonBlocking(next.id, next.fence, next.maxAcquiredBufferCount) !=
+                    OK) {
+                    releases.pop_back();
+                    break;
+                }
+            }
             sp<BLASTBufferQueue> bbq = weakBbq.promote();
             if (!bbq) {
                 return;
             }
-            bbq->releaseBufferCallback(id, fence, maxAcquiredBufferCount);
+            bbq->releaseBufferCallbacks(releases);
         }
     }).detach();
 }
 
+void BLASTBufferQueue::releaseBufferCallbacks(const std::vector<BufferRelease>& releases) {
+    std::lock_guard _lock{mMutex};
+    BBQ_TRACE();
+    for (const BufferRelease& release : releases) {
+        releaseBufferCallbackLocked(release.id, release.fence, release.maxAcquiredBufferCount,
+                                    false /* fakeRelease */);
+    }
+}
+
 BLASTBufferQueue::BufferReleaseThread::~BufferReleaseThread() {
     *mRunning = false;
     mReader->interruptBlockingRead();
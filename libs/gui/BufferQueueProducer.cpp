@@ -16,6 +16,9 @@
 
 #include <inttypes.h>
 
+#include <algorithm>
+#include <limits>
+
 #define LOG_TAG "BufferQueueProducer"
 #define ATRACE_TAG ATRACE_TAG_GRAPHICS
 //#define LOG_NDEBUG 0
@@ -97,7 +100,24 @@ status_t BufferQueueProducer::requestBuffer(int slot, sp<GraphicBuffer>* buf) {
     ATRACE_CALL();
     BQ_LOGV("requestBuffer: slot %d", slot);
     std::lock_guard<std::mutex> lock(mCore->mMutex);
+    return requestBufferLocked(slot, buf);
+}
+
+status_t BufferQueueProducer::requestBuffers(const std::vector<int32_t>& slots,
+                                             std::vector<RequestBufferOutput>* outputs) {
+    ATRACE_CALL();
+    outputs->clear();
+    outputs->reserve(slots.size());
+
+    std::lock_guard<std::mutex> lock(mCore->mMutex);
+    for (int32_t slot : slots) {
+        RequestBufferOutput& output = outputs->emplace_back();
+        output.result = requestBufferLocked(static_cast<int>(slot), &output.buffer);
+    }
+    return NO_ERROR;
+}
 
+status_t BufferQueueProducer::requestBufferLocked(int slot, sp<GraphicBuffer>* buf) {
     if (mCore->mIsAbandoned) {
         BQ_LOGE("requestBuffer: BufferQueue has been abandoned");
         return NO_INIT;
@@ -689,6 +709,38 @@ status_t BufferQueueProducer::dequeueBuffer(int* outSlot, sp<android::Fence>* ou
     return returnFlags;
 }
 
+status_t BufferQueueProducer::dequeueBuffers(const std::vector<DequeueBufferInput>& inputs,
+                                             std::vector<DequeueBufferOutput>* outputs) {
+    ATRACE_CALL();
+
+    // When a batch of buffers with the same properties is dequeued, e.g. by a new surface, allocate
+    // the buffers it is missing up front. Otherwise each dequeueBuffer would allocate its own
+    // buffer while the next one waits for it.
+    const auto sameProperties = [&inputs](const DequeueBufferInput& input) {
+        return input.width == inputs.front().width && input.height == inputs.front().height &&
+                input.format == inputs.front().format && input.usage == inputs.front().usage;
+    };
+    if (inputs.size() > 1 && std::all_of(inputs.begin(), inputs.end(), sameProperties)) {
+        size_t missingBufferCount = 0;
+        {
+            std::lock_guard<std::mutex> lock(mCore->mMutex);
+            const size_t freeBufferCount = mCore->mFreeBuffers.size();
+            if (!mCore->mIsAbandoned && mCore->mConnectedApi != BufferQueueCore::NO_CONNECTED_API &&
+                mCore->mAllowAllocation && inputs.size() > freeBufferCount) {
+                missingBufferCount = inputs.size() - freeBufferCount;
+            }
+        }
+
+        if (missingBufferCount > 0) {
+            const DequeueBufferInput& input = inputs.front();
+            allocateBuffers(input.width, input.height, input.format, input.usage,
+                            missingBufferCount);
+        }
+    }
+
+    return IGraphicBufferProducer::dequeueBuffers(inputs, outputs);
+}
+
 status_t BufferQueueProducer::detachBuffer(int slot) {
     ATRACE_CALL();
     ATRACE_BUFFER_INDEX(slot);
@@ -1505,10 +1557,16 @@ status_t BufferQueueProducer::setSidebandStream(const sp<NativeHandle>& stream)
 
 void BufferQueueProducer::allocateBuffers(uint32_t width, uint32_t height,
         PixelFormat format, uint64_t usage) {
+    allocateBuffers(width, height, format, usage, std::numeric_limits<size_t>::max());
+}
+
+void BufferQueueProducer::allocateBuffers(uint32_t width, uint32_t height, PixelFormat format,
+                                          uint64_t usage, size_t maxBufferCount) {
     ATRACE_CALL();
 
     const bool useDefaultSize = !width && !height;
-    while (true) {
+    size_t allocatedBufferCount = 0;
+    while (allocatedBufferCount < maxBufferCount) {
         size_t newBufferCount = 0;
         uint32_t allocWidth = 0;
         uint32_t allocHeight = 0;
@@ -1642,6 +1700,7 @@ void BufferQueueProducer::allocateBuffers(uint32_t width, uint32_t height,
 
                 BQ_LOGV("allocateBuffers: allocated a new buffer in slot %d",
                         *slot);
+                allocatedBufferCount++;
 
                 // Make sure the erase is done after all uses of the slot
                 // iterator since it will be invalid after this point.
@@ -203,52 +203,79 @@ int BufferReleaseChannel::ProducerEndpoint::writeReleaseFence(const ReleaseCallb
                                                               const sp<Fence>& fence,
                                                               uint32_t maxAcquiredBufferCount) {
     Message message{callbackId, fence ? fence : Fence::NO_FENCE, maxAcquiredBufferCount};
-    mFlattenedBuffer.resize(message.getFlattenedSize());
-    int flattenedFd;
-    {
-        // Make copies of needed items since flatten modifies them, and we don't
-        // want to send anything if there's an error during flatten.
-        void* flattenedBufferPtr = mFlattenedBuffer.data();
-        size_t flattenedBufferSize = mFlattenedBuffer.size();
-        int* flattenedFdPtr = &flattenedFd;
-        size_t flattenedFdCount = 1;
-        if (status_t err = message.flatten(flattenedBufferPtr, flattenedBufferSize, flattenedFdPtr,
-                                           flattenedFdCount);
-            err != OK) {
-            ALOGE("Failed to flatten BufferReleaseChannel message.");
-            return err;
-        }
-    }
+    return writeReleaseFences({std::move(message)});
+}
 
-    iovec iov{
-            .iov_base = mFlattenedBuffer.data(),
-            .iov_len = mFlattenedBuffer.size(),
+int BufferReleaseChannel::ProducerEndpoint::writeReleaseFences(
+        const std::vector<Message>& messages) {
+    struct FlattenedMessage {
+        std::vector<uint8_t> buffer;
+        int fd = -1;
+        iovec iov;
+        std::array<uint8_t, CMSG_SPACE(sizeof(int))> controlMessageBuffer;
     };
 
-    msghdr msg{
-            .msg_iov = &iov,
-            .msg_iovlen = 1,
-    };
+    // The message of a single release, the common case, reuses mFlattenedBuffer.
+    std::vector<FlattenedMessage> flattenedMessages(messages.size());
+    std::vector<mmsghdr> headers(messages.size());
+
+    for (size_t i = 0; i < messages.size(); i++) {
+        const Message& message = messages[i];
+        FlattenedMessage& flattened = flattenedMessages[i];
+        std::vector<uint8_t>& buffer = i == 0 ? mFlattenedBuffer : flattened.buffer;
+        buffer.resize(message.getFlattenedSize());
+        {
+            // Make copies of needed items since flatten modifies them, and we don't
+            // want to send anything if there's an error during flatten.
+            void* flattenedBufferPtr = buffer.data();
+            size_t flattenedBufferSize = buffer.size();
+            int* flattenedFdPtr = &flattened.fd;
+            size_t flattenedFdCount = 1;
+            if (status_t err = message.flatten(flattenedBufferPtr, flattenedBufferSize,
+                                               flattenedFdPtr, flattenedFdCount);
+                err != OK) {
+                ALOGE("Failed to flatten BufferReleaseChannel message.");
+                return err;
+            }
+        }
 
-    std::array<uint8_t, CMSG_SPACE(sizeof(int))> controlMessageBuffer;
-    if (fence && fence->isValid()) {
-        msg.msg_control = controlMessageBuffer.data();
-        msg.msg_controllen = controlMessageBuffer.size();
-
-        cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
-        cmsg->cmsg_level = SOL_SOCKET;
-        cmsg->cmsg_type = SCM_RIGHTS;
-        cmsg->cmsg_len = CMSG_LEN(sizeof(int));
-        memcpy(CMSG_DATA(cmsg), &flattenedFd, sizeof(int));
+        flattened.iov = {
+                .iov_base = buffer.data(),
+                .iov_len = buffer.size(),
+        };
+
+        msghdr& msg = headers[i].msg_hdr;
+        msg = {
+                .msg_iov = &flattened.iov,
+                .msg_iovlen = 1,
+        };
+
+        if (message.releaseFence->isValid()) {
+            msg.msg_control = flattened.controlMessageBuffer.data();
+            msg.msg_controllen = flattened.controlMessageBuffer.size();
+
+            cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+            cmsg->cmsg_level = SOL_SOCKET;
+            cmsg->cmsg_type = SCM_RIGHTS;
+            cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+            memcpy(CMSG_DATA(cmsg), &flattened.fd, sizeof(int));
+        }
     }
 
-    int result;
-    do {
-        result = sendmsg(mFd, &msg, 0);
-    } while (result == -1 && errno == EINTR);
-    if (result == -1) {
-        ALOGD("Error writing release fence to socket: error %#x (%s)", errno, strerror(errno));
-        return -errno;
+    // Each release is still its own datagram, so that the consumer reads them as before, but all
+    // of them are written with one system call.
+    size_t sentCount = 0;
+    while (sentCount < headers.size()) {
+        int result;
+        do {
+            result = sendmmsg(mFd, headers.data() + sentCount,
+                              static_cast<unsigned int>(headers.size() - sentCount), 0);
+        } while (result == -1 && errno == EINTR);
+        if (result == -1) {
+            ALOGD("Error writing release fence to socket: error %#x (%s)", errno, strerror(errno));
+            return -errno;
+        }
+        sentCount += static_cast<size_t>(result);
     }
 
     return OK;
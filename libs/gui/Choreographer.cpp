@@ -286,13 +286,13 @@ void Choreographer::handleRefreshRateUpdates() {
 }
 
 void Choreographer::dispatchCallbacks(const std::vector<FrameCallback>& callbacks,
-                                      VsyncEventData vsyncEventData, nsecs_t timestamp) {
+                                      const VsyncEventData& vsyncEventData, nsecs_t timestamp) {
+    const ChoreographerFrameCallbackDataImpl frameCallbackData =
+            createFrameCallbackData(timestamp);
     for (const auto& cb : callbacks) {
         if (cb.vsyncCallback != nullptr) {
             ATRACE_FORMAT("AChoreographer_vsyncCallback %" PRId64,
                           vsyncEventData.preferredVsyncId());
-            const ChoreographerFrameCallbackDataImpl frameCallbackData =
-                    createFrameCallbackData(timestamp);
             registerStartTime();
             mInCallback = true;
             cb.vsyncCallback(reinterpret_cast<const AChoreographerFrameCallbackData*>(
@@ -329,11 +329,11 @@ void Choreographer::dispatchVsync(nsecs_t timestamp, PhysicalDisplayId, uint32_t
     // Callbacks with type CALLBACK_INPUT should always run first
     {
         ATRACE_FORMAT("CALLBACK_INPUT");
-        dispatchCallbacks(inputCallbacks, vsyncEventData, timestamp);
+        dispatchCallbacks(inputCallbacks, mLastVsyncEventData, timestamp);
     }
     {
         ATRACE_FORMAT("CALLBACK_ANIMATION");
-        dispatchCallbacks(animationCallbacks, vsyncEventData, timestamp);
+        dispatchCallbacks(animationCallbacks, mLastVsyncEventData, timestamp);
     }
 }
 
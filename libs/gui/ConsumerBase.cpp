@@ -387,7 +387,11 @@ status_t ConsumerBase::setMaxBufferCount(int bufferCount) {
         CB_LOGE("setMaxBufferCount: ConsumerBase is abandoned!");
         return NO_INIT;
     }
-    return mConsumer->setMaxBufferCount(bufferCount);
+    status_t err = mConsumer->setMaxBufferCount(bufferCount);
+    if (err == OK) {
+        discardFreeBuffersLocked();
+    }
+    return err;
 }
 #endif // COM_ANDROID_GRAPHICS_LIBGUI_FLAGS(WB_CONSUMER_BASE_OWNS_BQ)
 
@@ -397,7 +401,11 @@ status_t ConsumerBase::setMaxAcquiredBufferCount(int maxAcquiredBuffers) {
         CB_LOGE("setMaxAcquiredBufferCount: ConsumerBase is abandoned!");
         return NO_INIT;
     }
-    return mConsumer->setMaxAcquiredBufferCount(maxAcquiredBuffers);
+    status_t err = mConsumer->setMaxAcquiredBufferCount(maxAcquiredBuffers);
+    if (err == OK) {
+        discardFreeBuffersLocked();
+    }
+    return err;
 }
 
 #if COM_ANDROID_GRAPHICS_LIBGUI_FLAGS(WB_CONSUMER_BASE_OWNS_BQ)
@@ -455,9 +463,12 @@ status_t ConsumerBase::discardFreeBuffers() {
             freeBufferLocked(i);
         }
     }
+    discardFreeBuffersLocked();
     return OK;
 }
 
+void ConsumerBase::discardFreeBuffersLocked() {}
+
 void ConsumerBase::dumpState(String8& result) const {
     dumpState(result, "");
 }
@@ -101,12 +101,15 @@ static bool isPossiblyYUV(PixelFormat format) {
     }
 }
 
-status_t CpuConsumer::lockBufferItem(const BufferItem& item, LockedBuffer* outBuffer) const {
+status_t CpuConsumer::lockBufferItem(const BufferItem& item, LockedBuffer* outBuffer) {
     android_ycbcr ycbcr = android_ycbcr();
 
     PixelFormat format = item.mGraphicBuffer->getPixelFormat();
     PixelFormat flexFormat = format;
-    if (isPossiblyYUV(format)) {
+    const bool isSlotValid = item.mSlot >= 0 && item.mSlot < BufferQueue::NUM_BUFFER_SLOTS;
+    const uint64_t bufferId = item.mGraphicBuffer->getId();
+    const bool knownNonFlexYuv = isSlotValid && mNonFlexYuvBufferIds[item.mSlot] == bufferId;
+    if (isPossiblyYUV(format) && !knownNonFlexYuv) {
         int fenceFd = item.mFence.get() ? item.mFence->dup() : -1;
         status_t err = item.mGraphicBuffer->lockAsyncYCbCr(GraphicBuffer::USAGE_SW_READ_OFTEN,
                                                            item.mCrop, &ycbcr, fenceFd);
@@ -118,6 +121,9 @@ status_t CpuConsumer::lockBufferItem(const BufferItem& item, LockedBuffer* outBu
         } else if (format == HAL_PIXEL_FORMAT_YCbCr_420_888) {
             CC_LOGE("Unable to lock YCbCr buffer for CPU reading: %s (%d)", strerror(-err), err);
             return err;
+        } else if (isSlotValid) {
+            // The buffer stays in its slot until it is reallocated, so don't try again for it.
+            mNonFlexYuvBufferIds[item.mSlot] = bufferId;
         }
     }
 
@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gui/DisplayEventCoalescer.h>
+
+#include <algorithm>
+
+namespace android {
+
+namespace {
+
+// The number of events read at once. The channel is a SOCK_SEQPACKET socket, so a read returns
+// the events of a single send, and the part of a send which doesn't fit is discarded. Most sends
+// are one event, but frame rate overrides are sent together in one, so this matches the buffer
+// DisplayEventDispatcher used to read into.
+constexpr size_t kReadSize = 100;
+
+} // namespace
+
+ssize_t DisplayEventCoalescer::drain(DisplayEventReceiver& receiver) {
+    return drainWith(
+            [&receiver](Event* events, size_t count) { return receiver.getEvents(events, count); });
+}
+
+ssize_t DisplayEventCoalescer::drain(gui::BitTube* channel) {
+    return drainWith([channel](Event* events, size_t count) {
+        return DisplayEventReceiver::getEvents(channel, events, count);
+    });
+}
+
+template <typename Read>
+ssize_t DisplayEventCoalescer::drainWith(Read read) {
+    mEventCount = 0;
+    mLatestVsync.reset();
+    mDroppedEventCount = 0;
+
+    ssize_t n;
+    do {
+        if (mEvents.size() < mEventCount + kReadSize) {
+            mEvents.resize(mEventCount + kReadSize);
+        }
+        n = read(mEvents.data() + mEventCount, kReadSize);
+        if (n > 0) {
+            mEventCount += static_cast<size_t>(n);
+        }
+    } while (n > 0);
+
+    const size_t readCount = mEventCount;
+    coalesce();
+    return n < 0 ? n : static_cast<ssize_t>(readCount);
+}
+
+void DisplayEventCoalescer::coalesce() {
+    // Walk the events backwards, so that the latest of each kind is seen first, and move the ones
+    // that are kept to the end of the buffer.
+    mDisplaysWithModeChange.clear();
+    size_t keptBegin = mEventCount;
+    for (size_t i = mEventCount; i-- > 0;) {
+        const Event& event = mEvents[i];
+        const auto findModeChange = [this, displayId = event.header.displayId] {
+            return std::find(mDisplaysWithModeChange.begin(), mDisplaysWithModeChange.end(),
+                             displayId);
+        };
+        bool keep = true;
+        switch (event.header.type) {
+            case DisplayEventReceiver::DISPLAY_EVENT_VSYNC:
+                if (!mLatestVsync) {
+                    mLatestVsync = event;
+                } else {
+                    mDroppedEventCount++;
+                }
+                keep = false;
+                break;
+            case DisplayEventReceiver::DISPLAY_EVENT_MODE_CHANGE:
+                if (findModeChange() != mDisplaysWithModeChange.end()) {
+                    mDroppedEventCount++;
+                    keep = false;
+                } else {
+                    mDisplaysWithModeChange.push_back(event.header.displayId);
+                }
+                break;
+            case DisplayEventReceiver::DISPLAY_EVENT_HOTPLUG:
+                // The mode changes sent before a hotplug are about a different connection.
+                if (const auto it = findModeChange(); it != mDisplaysWithModeChange.end()) {
+                    mDisplaysWithModeChange.erase(it);
+                }
+                break;
+            default:
+                break;
+        }
+        if (keep && --keptBegin != i) {
+            mEvents[keptBegin] = event;
+        }
+    }
+
+    std::copy(mEvents.begin() + static_cast<ptrdiff_t>(keptBegin),
+              mEvents.begin() + static_cast<ptrdiff_t>(mEventCount), mEvents.begin());
+    mEventCount -= keptBegin;
+}
+
+} // namespace android
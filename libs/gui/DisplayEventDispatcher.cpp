@@ -32,11 +32,6 @@
 namespace android {
 using namespace com::android::graphics::libgui;
 
-// Number of events to read at a time from the DisplayEventDispatcher pipe.
-// The value should be large enough that we can quickly drain the pipe
-// using just a few large reads.
-static const size_t EVENT_BUFFER_SIZE = 100;
-
 static constexpr nsecs_t WAITING_FOR_VSYNC_TIMEOUT = ms2ns(300);
 
 DisplayEventDispatcher::DisplayEventDispatcher(const sp<Looper>& looper,
@@ -158,69 +153,67 @@ bool DisplayEventDispatcher::processPendingEvents(nsecs_t* outTimestamp,
                                                   PhysicalDisplayId* outDisplayId,
                                                   uint32_t* outCount,
                                                   VsyncEventData* outVsyncEventData) {
-    bool gotVsync = false;
-    DisplayEventReceiver::Event buf[EVENT_BUFFER_SIZE];
-    ssize_t n;
-    while ((n = mReceiver.getEvents(buf, EVENT_BUFFER_SIZE)) > 0) {
-        ALOGV("dispatcher %p ~ Read %d events.", this, int(n));
-        mFrameRateOverrides.reserve(n);
-        for (ssize_t i = 0; i < n; i++) {
-            const DisplayEventReceiver::Event& ev = buf[i];
-            switch (ev.header.type) {
-                case DisplayEventReceiver::DISPLAY_EVENT_VSYNC:
-                    // Later vsync events will just overwrite the info from earlier
-                    // ones. That's fine, we only care about the most recent.
-                    gotVsync = true;
-                    *outTimestamp = ev.header.timestamp;
-                    *outDisplayId = ev.header.displayId;
-                    *outCount = ev.vsync.count;
-                    *outVsyncEventData = ev.vsync.vsyncData;
-
-                    // Trace the RenderRate for this app
-                    if (ATRACE_ENABLED() && flags::trace_frame_rate_override()) {
-                        const auto frameInterval = ev.vsync.vsyncData.frameInterval;
-                        int fps = frameInterval > 0 ? 1e9f / frameInterval : 0;
-                        ATRACE_INT("RenderRate", fps);
-                    }
-                    break;
-                case DisplayEventReceiver::DISPLAY_EVENT_HOTPLUG:
-                    if (ev.hotplug.connectionError == 0) {
-                        dispatchHotplug(ev.header.timestamp, ev.header.displayId,
-                                        ev.hotplug.connected);
-                    } else {
-                        dispatchHotplugConnectionError(ev.header.timestamp,
-                                                       ev.hotplug.connectionError);
-                    }
-                    break;
-                case DisplayEventReceiver::DISPLAY_EVENT_MODE_CHANGE:
-                    dispatchModeChanged(ev.header.timestamp, ev.header.displayId,
-                                        ev.modeChange.modeId, ev.modeChange.vsyncPeriod);
-                    break;
-                case DisplayEventReceiver::DISPLAY_EVENT_NULL:
-                    dispatchNullEvent(ev.header.timestamp, ev.header.displayId);
-                    break;
-                case DisplayEventReceiver::DISPLAY_EVENT_FRAME_RATE_OVERRIDE:
-                    mFrameRateOverrides.emplace_back(ev.frameRateOverride);
-                    break;
-                case DisplayEventReceiver::DISPLAY_EVENT_FRAME_RATE_OVERRIDE_FLUSH:
-                    dispatchFrameRateOverrides(ev.header.timestamp, ev.header.displayId,
-                                               std::move(mFrameRateOverrides));
-                    break;
-                case DisplayEventReceiver::DISPLAY_EVENT_HDCP_LEVELS_CHANGE:
-                    dispatchHdcpLevelsChanged(ev.header.displayId,
-                                              ev.hdcpLevelsChange.connectedLevel,
-                                              ev.hdcpLevelsChange.maxLevel);
-                    break;
-                default:
-                    ALOGW("dispatcher %p ~ ignoring unknown event type %#x", this, ev.header.type);
-                    break;
-            }
+    const ssize_t n = mCoalescer.drain(mReceiver);
+    ALOGV("dispatcher %p ~ Read %d events, dropped %zu stale ones.", this, int(n),
+          mCoalescer.droppedEventCount());
+
+    const DisplayEventReceiver::Event* events = mCoalescer.events();
+    for (size_t i = 0; i < mCoalescer.eventCount(); i++) {
+        const DisplayEventReceiver::Event& ev = events[i];
+        switch (ev.header.type) {
+            case DisplayEventReceiver::DISPLAY_EVENT_HOTPLUG:
+                if (ev.hotplug.connectionError == 0) {
+                    dispatchHotplug(ev.header.timestamp, ev.header.displayId,
+                                    ev.hotplug.connected);
+                } else {
+                    dispatchHotplugConnectionError(ev.header.timestamp,
+                                                   ev.hotplug.connectionError);
+                }
+                break;
+            case DisplayEventReceiver::DISPLAY_EVENT_MODE_CHANGE:
+                dispatchModeChanged(ev.header.timestamp, ev.header.displayId,
+                                    ev.modeChange.modeId, ev.modeChange.vsyncPeriod);
+                break;
+            case DisplayEventReceiver::DISPLAY_EVENT_NULL:
+                dispatchNullEvent(ev.header.timestamp, ev.header.displayId);
+                break;
+            case DisplayEventReceiver::DISPLAY_EVENT_FRAME_RATE_OVERRIDE:
+                mFrameRateOverrides.emplace_back(ev.frameRateOverride);
+                break;
+            case DisplayEventReceiver::DISPLAY_EVENT_FRAME_RATE_OVERRIDE_FLUSH:
+                dispatchFrameRateOverrides(ev.header.timestamp, ev.header.displayId,
+                                           std::move(mFrameRateOverrides));
+                break;
+            case DisplayEventReceiver::DISPLAY_EVENT_HDCP_LEVELS_CHANGE:
+                dispatchHdcpLevelsChanged(ev.header.displayId, ev.hdcpLevelsChange.connectedLevel,
+                                          ev.hdcpLevelsChange.maxLevel);
+                break;
+            default:
+                ALOGW("dispatcher %p ~ ignoring unknown event type %#x", this, ev.header.type);
+                break;
         }
     }
     if (n < 0) {
         ALOGW("Failed to get events from display event dispatcher, status=%d", status_t(n));
     }
-    return gotVsync;
+
+    // Earlier vsyncs were dropped, only the most recent one matters.
+    const auto& vsync = mCoalescer.latestVsync();
+    if (!vsync) {
+        return false;
+    }
+    *outTimestamp = vsync->header.timestamp;
+    *outDisplayId = vsync->header.displayId;
+    *outCount = vsync->vsync.count;
+    *outVsyncEventData = vsync->vsync.vsyncData;
+
+    // Trace the RenderRate for this app
+    if (ATRACE_ENABLED() && flags::trace_frame_rate_override()) {
+        const auto frameInterval = vsync->vsync.vsyncData.frameInterval;
+        int fps = frameInterval > 0 ? 1e9f / frameInterval : 0;
+        ATRACE_INT("RenderRate", fps);
+    }
+    return true;
 }
 
 status_t DisplayEventDispatcher::getLatestVsyncEventData(
@@ -384,12 +384,19 @@ status_t GLConsumer::acquireBufferLocked(BufferItem *item,
         return err;
     }
 
+    mAcquireCount++;
+
     // If item->mGraphicBuffer is not null, this buffer has not been acquired
-    // before, so any prior EglImage created is using a stale buffer. This
-    // replaces any old EglImage with a new one (using the new buffer).
+    // in this slot before, so any prior EglImage of the slot is using a stale
+    // buffer. This replaces it with the cached EglImage of the new buffer if
+    // the buffer was in a slot recently, or with a new one otherwise.
     if (item->mGraphicBuffer != nullptr) {
         int slot = item->mSlot;
-        mEglSlots[slot].mEglImage = new EglImage(item->mGraphicBuffer);
+        sp<EglImage> image = takeCachedEglImageLocked(item->mGraphicBuffer->getId());
+        if (image == nullptr) {
+            image = new EglImage(item->mGraphicBuffer);
+        }
+        mEglSlots[slot].mEglImage = image;
     }
 
     return NO_ERROR;
@@ -962,14 +969,46 @@ void GLConsumer::freeBufferLocked(int slotIndex) {
     if (slotIndex == mCurrentTexture) {
         mCurrentTexture = BufferQueue::INVALID_BUFFER_SLOT;
     }
-    mEglSlots[slotIndex].mEglImage.clear();
+    if (mEglSlots[slotIndex].mEglImage != nullptr) {
+        cacheEglImageLocked(std::move(mEglSlots[slotIndex].mEglImage));
+    }
     ConsumerBase::freeBufferLocked(slotIndex);
 }
 
+void GLConsumer::discardFreeBuffersLocked() {
+    GLC_LOGV("discardFreeBuffersLocked");
+    mEglImageCache.clear();
+    ConsumerBase::discardFreeBuffersLocked();
+}
+
+void GLConsumer::cacheEglImageLocked(sp<EglImage> image) {
+    if (mEglImageCache.size() == MAX_CACHED_EGL_IMAGES) {
+        mEglImageCache.erase(mEglImageCache.begin());
+    }
+    mEglImageCache.push_back({std::move(image), mAcquireCount});
+}
+
+sp<GLConsumer::EglImage> GLConsumer::takeCachedEglImageLocked(uint64_t bufferId) {
+    sp<EglImage> image;
+    for (auto it = mEglImageCache.begin(); it != mEglImageCache.end();) {
+        if (it->image->graphicBuffer()->getId() == bufferId) {
+            image = std::move(it->image);
+            it = mEglImageCache.erase(it);
+        } else if (mAcquireCount - it->acquireCount > MAX_EGL_IMAGE_CACHE_AGE) {
+            it = mEglImageCache.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    return image;
+}
+
 void GLConsumer::abandonLocked() {
     GLC_LOGV("abandonLocked");
     mCurrentTextureImage.clear();
     ConsumerBase::abandonLocked();
+    // Abandoning frees all slots, which caches their images.
+    mEglImageCache.clear();
 }
 
 status_t GLConsumer::setConsumerUsageBits(uint64_t usage) {
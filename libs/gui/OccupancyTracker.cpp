@@ -22,6 +22,7 @@
 #include <utils/String8.h>
 #include <utils/Trace.h>
 
+#include <algorithm>
 #include <inttypes.h>
 
 namespace android {
@@ -68,17 +69,14 @@ void OccupancyTracker::registerOccupancyChange(size_t occupancy) {
         recordPendingSegment();
     } else {
         mPendingSegment.totalTime += delta;
-        if (mPendingSegment.mOccupancyTimes.count(mLastOccupancy)) {
-            mPendingSegment.mOccupancyTimes[mLastOccupancy] += delta;
-        } else {
-            mPendingSegment.mOccupancyTimes[mLastOccupancy] = delta;
-        }
+        mPendingSegment.mOccupancyTimes[mLastOccupancy] += delta;
+        mPendingSegment.usedThirdBuffer = mPendingSegment.usedThirdBuffer || (mLastOccupancy > 1);
     }
     if (occupancy > mLastOccupancy) {
         ++mPendingSegment.numFrames;
     }
     mLastOccupancyChangeTime = now;
-    mLastOccupancy = occupancy;
+    mLastOccupancy = std::min(occupancy, MAX_OCCUPANCY);
 }
 
 std::vector<OccupancyTracker::Segment> OccupancyTracker::getSegmentHistory(
@@ -97,16 +95,17 @@ void OccupancyTracker::recordPendingSegment() {
     // vs. triple-buffered time
     if (mPendingSegment.numFrames > LONG_SEGMENT_THRESHOLD) {
         float occupancyAverage = 0.0f;
-        bool usedThirdBuffer = false;
-        for (const auto& timePair : mPendingSegment.mOccupancyTimes) {
-            size_t occupancy = timePair.first;
-            float timeRatio = static_cast<float>(timePair.second) /
-                    mPendingSegment.totalTime;
+        for (size_t occupancy = 1; occupancy <= MAX_OCCUPANCY; ++occupancy) {
+            const nsecs_t time = mPendingSegment.mOccupancyTimes[occupancy];
+            if (time == 0) {
+                continue;
+            }
+            float timeRatio = static_cast<float>(time) / mPendingSegment.totalTime;
             occupancyAverage += timeRatio * occupancy;
-            usedThirdBuffer = usedThirdBuffer || (occupancy > 1);
         }
         mSegmentHistory.push_front({mPendingSegment.totalTime,
-                mPendingSegment.numFrames, occupancyAverage, usedThirdBuffer});
+                mPendingSegment.numFrames, occupancyAverage,
+                mPendingSegment.usedThirdBuffer});
         if (mSegmentHistory.size() > MAX_HISTORY_SIZE) {
             mSegmentHistory.pop_back();
         }
@@ -51,6 +51,16 @@ status_t StreamSplitter::createSplitter(
     status_t status = splitter->mInput->consumerConnect(splitter, false);
     if (status == NO_ERROR) {
         splitter->mInput->setConsumerName(String8("StreamSplitter"));
+        // Outstanding buffers stay acquired from the input until the outputs
+        // release them
+        status = splitter->mInput->setMaxAcquiredBufferCount(
+                MAX_OUTSTANDING_BUFFERS);
+        if (status != NO_ERROR) {
+            ALOGE("createSplitter: failed to set max acquired buffer count (%d)",
+                    status);
+            splitter->mInput->consumerDisconnect();
+            return status;
+        }
         *outSplitter = splitter;
     }
     return status;
@@ -58,7 +68,8 @@ status_t StreamSplitter::createSplitter(
 
 StreamSplitter::StreamSplitter(const sp<IGraphicBufferConsumer>& inputQueue)
       : mIsAbandoned(false), mMutex(), mReleaseCondition(),
-        mOutstandingBuffers(0), mInput(inputQueue), mOutputs(), mBuffers() {}
+        mOutstandingBuffers(0), mInput(inputQueue), mOutputs(), mBuffers(),
+        mInputBuffers() {}
 
 StreamSplitter::~StreamSplitter() {
     mInput->consumerDisconnect();
@@ -125,22 +136,30 @@ void StreamSplitter::onFrameAvailable(const BufferItem& /* item */) {
     }
     ++mOutstandingBuffers;
 
-    // Acquire and detach the buffer from the input
+    // Acquire the buffer from the input. It stays acquired, and in its slot,
+    // until every output has released it, so that the input producer doesn't
+    // need to request the buffer again when it dequeues the slot.
     BufferItem bufferItem;
     status_t status = mInput->acquireBuffer(&bufferItem, /* presentWhen */ 0);
     LOG_ALWAYS_FATAL_IF(status != NO_ERROR,
             "acquiring buffer from input failed (%d)", status);
 
+    sp<GraphicBuffer>& inputBuffer =
+            mInputBuffers[static_cast<size_t>(bufferItem.mSlot)];
+    if (bufferItem.mGraphicBuffer != nullptr) {
+        inputBuffer = bufferItem.mGraphicBuffer;
+    }
+    bufferItem.mGraphicBuffer = inputBuffer;
+    LOG_ALWAYS_FATAL_IF(bufferItem.mGraphicBuffer == nullptr,
+            "no buffer for input slot %d", bufferItem.mSlot);
+
     ALOGV("acquired buffer %#" PRIx64 " from input",
             bufferItem.mGraphicBuffer->getId());
 
-    status = mInput->detachBuffer(bufferItem.mSlot);
-    LOG_ALWAYS_FATAL_IF(status != NO_ERROR,
-            "detaching buffer from input failed (%d)", status);
-
     // Initialize our reference count for this buffer
     mBuffers.add(bufferItem.mGraphicBuffer->getId(),
-            new BufferTracker(bufferItem.mGraphicBuffer));
+            new BufferTracker(bufferItem.mGraphicBuffer, bufferItem.mSlot,
+                    bufferItem.mFrameNumber));
 
     IGraphicBufferProducer::QueueBufferInput queueInput(
             bufferItem.mTimestamp, bufferItem.mIsAutoTimestamp,
@@ -209,9 +228,9 @@ void StreamSplitter::onBufferReleasedByOutput(
 
     const sp<BufferTracker>& tracker = mBuffers.editValueFor(buffer->getId());
 
-    // Merge the release fence of the incoming buffer so that the fence we send
+    // Keep the release fence of the incoming buffer so that the fence we send
     // back to the input includes all of the outputs' fences
-    tracker->mergeFence(fence);
+    tracker->addReleaseFence(fence);
 
     // Check to see if this is the last outstanding reference to this buffer
     size_t releaseCount = tracker->incrementReleaseCountLocked();
@@ -228,15 +247,12 @@ void StreamSplitter::onBufferReleasedByOutput(
         return;
     }
 
-    // Attach and release the buffer back to the input
-    int consumerSlot;
-    status = mInput->attachBuffer(&consumerSlot, tracker->getBuffer());
-    LOG_ALWAYS_FATAL_IF(status != NO_ERROR,
-            "attaching buffer to input failed (%d)", status);
-
-    status = mInput->releaseBuffer(consumerSlot, /* frameNumber */ 0,
+    // Release the buffer back to its input slot. If the input freed the slot
+    // in the meantime, the buffer is simply dropped.
+    status = mInput->releaseBuffer(tracker->getSlot(), tracker->getFrameNumber(),
             EGL_NO_DISPLAY, EGL_NO_SYNC_KHR, tracker->getMergedFence());
-    LOG_ALWAYS_FATAL_IF(status != NO_ERROR,
+    LOG_ALWAYS_FATAL_IF(status != NO_ERROR &&
+            status != IGraphicBufferConsumer::STALE_BUFFER_SLOT,
             "releasing buffer to input failed (%d)", status);
 
     ALOGV("released buffer %#" PRIx64 " to input", buffer->getId());
@@ -250,6 +266,21 @@ void StreamSplitter::onBufferReleasedByOutput(
     mReleaseCondition.signal();
 }
 
+void StreamSplitter::onBuffersReleased() {
+    Mutex::Autolock lock(mMutex);
+    if (mIsAbandoned) {
+        return;
+    }
+
+    uint64_t mask = 0;
+    mInput->getReleasedBuffers(&mask);
+    for (size_t slot = 0; slot < mInputBuffers.size(); ++slot) {
+        if (mask & (1ULL << slot)) {
+            mInputBuffers[slot].clear();
+        }
+    }
+}
+
 void StreamSplitter::onAbandonedLocked() {
     ALOGE("one of my outputs has abandoned me");
     if (!mIsAbandoned) {
@@ -275,13 +306,25 @@ void StreamSplitter::OutputListener::binderDied(const wp<IBinder>& /* who */) {
     mSplitter->onAbandonedLocked();
 }
 
-StreamSplitter::BufferTracker::BufferTracker(const sp<GraphicBuffer>& buffer)
-      : mBuffer(buffer), mMergedFence(Fence::NO_FENCE), mReleaseCount(0) {}
+StreamSplitter::BufferTracker::BufferTracker(const sp<GraphicBuffer>& buffer,
+        int slot, uint64_t frameNumber)
+      : mBuffer(buffer), mSlot(slot), mFrameNumber(frameNumber),
+        mReleaseFences(), mReleaseCount(0) {}
 
 StreamSplitter::BufferTracker::~BufferTracker() {}
 
-void StreamSplitter::BufferTracker::mergeFence(const sp<Fence>& with) {
-    mMergedFence = Fence::merge(String8("StreamSplitter"), mMergedFence, with);
+void StreamSplitter::BufferTracker::addReleaseFence(const sp<Fence>& fence) {
+    if (fence != nullptr && fence->isValid()) {
+        mReleaseFences.push_back(fence);
+    }
+}
+
+sp<Fence> StreamSplitter::BufferTracker::getMergedFence() const {
+    // A single fence needs no merging
+    if (mReleaseFences.size() == 1) {
+        return mReleaseFences.front();
+    }
+    return Fence::merge("StreamSplitter", mReleaseFences);
 }
 
 } // namespace android
@@ -118,6 +118,7 @@ Surface::Surface(const sp<IGraphicBufferProducer>& bufferProducer, bool controll
     ANativeWindow::queueBuffer      = hook_queueBuffer;
     ANativeWindow::query            = hook_query;
     ANativeWindow::perform          = hook_perform;
+    ANativeWindow::performTable     = &sPerformTable;
 
     ANativeWindow::dequeueBuffer_DEPRECATED = hook_dequeueBuffer_DEPRECATED;
     ANativeWindow::cancelBuffer_DEPRECATED  = hook_cancelBuffer_DEPRECATED;
@@ -562,6 +563,68 @@ int Surface::performInternal(ANativeWindow* window, int operation, va_list args)
     return c->perform(operation, args);
 }
 
+const ANativeWindowPerformTable Surface::sPerformTable = {
+        .size = sizeof(ANativeWindowPerformTable),
+        .setBuffersDataSpace = hook_setBuffersDataSpace,
+        .setBuffersTimestamp = hook_setBuffersTimestamp,
+        .setBuffersTransform = hook_setBuffersTransform,
+        .setCrop = hook_setCrop,
+        .setSurfaceDamage = hook_setSurfaceDamage,
+};
+
+void Surface::disablePerformTable() {
+    ANativeWindow::performTable = nullptr;
+}
+
+bool Surface::hasPerformInterceptor() const {
+    std::shared_lock<std::shared_mutex> lock(mInterceptorMutex);
+    return mPerformInterceptor != nullptr;
+}
+
+// The perform table hooks go through hook_perform when a perform interceptor
+// is installed, so that the interceptor sees every operation.
+int Surface::hook_setBuffersDataSpace(ANativeWindow* window, android_dataspace_t dataSpace) {
+    Surface* c = getSelf(window);
+    if (c->hasPerformInterceptor()) {
+        return hook_perform(window, NATIVE_WINDOW_SET_BUFFERS_DATASPACE, dataSpace);
+    }
+    return c->setBuffersDataSpace(static_cast<Dataspace>(dataSpace));
+}
+
+int Surface::hook_setBuffersTimestamp(ANativeWindow* window, int64_t timestamp) {
+    Surface* c = getSelf(window);
+    if (c->hasPerformInterceptor()) {
+        return hook_perform(window, NATIVE_WINDOW_SET_BUFFERS_TIMESTAMP, timestamp);
+    }
+    return c->setBuffersTimestamp(timestamp);
+}
+
+int Surface::hook_setBuffersTransform(ANativeWindow* window, int transform) {
+    Surface* c = getSelf(window);
+    if (c->hasPerformInterceptor()) {
+        return hook_perform(window, NATIVE_WINDOW_SET_BUFFERS_TRANSFORM, transform);
+    }
+    return c->setBuffersTransform(static_cast<uint32_t>(transform));
+}
+
+int Surface::hook_setCrop(ANativeWindow* window, const android_native_rect_t* crop) {
+    Surface* c = getSelf(window);
+    if (c->hasPerformInterceptor()) {
+        return hook_perform(window, NATIVE_WINDOW_SET_CROP, crop);
+    }
+    return c->setCrop(reinterpret_cast<Rect const*>(crop));
+}
+
+int Surface::hook_setSurfaceDamage(ANativeWindow* window, const android_native_rect_t* rects,
+                                   size_t numRects) {
+    Surface* c = getSelf(window);
+    if (c->hasPerformInterceptor()) {
+        return hook_perform(window, NATIVE_WINDOW_SET_SURFACE_DAMAGE, rects, numRects);
+    }
+    c->setSurfaceDamage(const_cast<android_native_rect_t*>(rects), numRects);
+    return NO_ERROR;
+}
+
 int Surface::hook_query(const ANativeWindow* window, int what, int* value) {
     const Surface* c = getSelf(window);
     {
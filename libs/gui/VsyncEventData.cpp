@@ -38,6 +38,10 @@ int64_t VsyncEventData::preferredExpectedPresentationTime() const {
     return frameTimelines[preferredFrameTimelineIndex].expectedPresentationTime;
 }
 
+int64_t VsyncEventData::timeUntilPreferredDeadline(int64_t now) const {
+    return preferredDeadlineTimestamp() - now;
+}
+
 status_t ParcelableVsyncEventData::readFromParcel(const Parcel* parcel) {
     if (parcel == nullptr) {
         ALOGE("%s: Null parcel", __func__);
@@ -92,6 +92,8 @@ binder::Status WindowInfosListenerReporter::onWindowInfosChanged(
         const gui::WindowInfosUpdate& update) {
     std::unordered_set<sp<WindowInfosListener>, gui::SpHash<WindowInfosListener>>
             windowInfosListeners;
+    std::optional<gui::WindowInfosUpdate> expandedUpdate;
+    const gui::WindowInfosUpdate* fullUpdate = &update;
 
     {
         std::scoped_lock lock(mListenersMutex);
@@ -99,12 +101,21 @@ binder::Status WindowInfosListenerReporter::onWindowInfosChanged(
             windowInfosListeners.insert(listener);
         }
 
-        mLastWindowInfos = update.windowInfos;
-        mLastDisplayInfos = update.displayInfos;
+        // Local listeners always see the full list of windows.
+        if (update.isDelta) {
+            expandedUpdate = update;
+            if (expandedUpdate->applyDelta(mLastWindowInfos) != OK) {
+                mWindowInfosPublisher->ackWindowInfosReceived(update.vsyncId, mListenerId);
+                return binder::Status::ok();
+            }
+            fullUpdate = &*expandedUpdate;
+        }
+        mLastWindowInfos = fullUpdate->windowInfos;
+        mLastDisplayInfos = fullUpdate->displayInfos;
     }
 
     for (auto listener : windowInfosListeners) {
-        listener->onWindowInfosChanged(update);
+        listener->onWindowInfosChanged(*fullUpdate);
     }
 
     mWindowInfosPublisher->ackWindowInfosReceived(update.vsyncId, mListenerId);
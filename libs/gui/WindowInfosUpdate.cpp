@@ -17,8 +17,82 @@
 #include <gui/WindowInfosUpdate.h>
 #include <private/gui/ParcelUtils.h>
 
+#include <unordered_map>
+#include <unordered_set>
+
 namespace android::gui {
 
+namespace {
+
+// WindowInfo::operator== leaves out the fields which input doesn't compare windows by, but a
+// delta must carry every change.
+bool isSameWindow(const WindowInfo& a, const WindowInfo& b) {
+    return a == b && a.alpha == b.alpha && a.windowToken == b.windowToken &&
+            a.touchableRegionCropHandle == b.touchableRegionCropHandle &&
+            a.focusTransferTarget == b.focusTransferTarget;
+}
+
+} // namespace
+
+std::optional<WindowInfosUpdate> WindowInfosUpdate::makeDelta(
+        const std::vector<WindowInfo>& previousWindowInfos) const {
+    std::unordered_map<int32_t, const WindowInfo*> previousById;
+    previousById.reserve(previousWindowInfos.size());
+    for (const auto& windowInfo : previousWindowInfos) {
+        if (!previousById.try_emplace(windowInfo.id, &windowInfo).second) {
+            return std::nullopt;
+        }
+    }
+
+    WindowInfosUpdate delta{{}, displayInfos, vsyncId, timestamp};
+    delta.isDelta = true;
+    delta.windowIds.reserve(windowInfos.size());
+    std::unordered_set<int32_t> ids;
+    ids.reserve(windowInfos.size());
+    for (const auto& windowInfo : windowInfos) {
+        if (!ids.insert(windowInfo.id).second) {
+            return std::nullopt;
+        }
+        delta.windowIds.push_back(windowInfo.id);
+        auto it = previousById.find(windowInfo.id);
+        if (it == previousById.end() || !isSameWindow(*it->second, windowInfo)) {
+            delta.windowInfos.push_back(windowInfo);
+        }
+    }
+    return delta;
+}
+
+status_t WindowInfosUpdate::applyDelta(const std::vector<WindowInfo>& previousWindowInfos) {
+    if (!isDelta) {
+        return OK;
+    }
+
+    std::unordered_map<int32_t, const WindowInfo*> byId;
+    byId.reserve(previousWindowInfos.size() + windowInfos.size());
+    for (const auto& windowInfo : previousWindowInfos) {
+        byId[windowInfo.id] = &windowInfo;
+    }
+    for (const auto& windowInfo : windowInfos) {
+        byId[windowInfo.id] = &windowInfo;
+    }
+
+    std::vector<WindowInfo> expanded;
+    expanded.reserve(windowIds.size());
+    for (int32_t id : windowIds) {
+        auto it = byId.find(id);
+        if (it == byId.end()) {
+            ALOGE("%s: No window with id %d in the previous update", __func__, id);
+            return BAD_VALUE;
+        }
+        expanded.push_back(*it->second);
+    }
+
+    windowInfos = std::move(expanded);
+    windowIds.clear();
+    isDelta = false;
+    return OK;
+}
+
 status_t WindowInfosUpdate::readFromParcel(const android::Parcel* parcel) {
     if (parcel == nullptr) {
         ALOGE("%s: Null parcel", __func__);
@@ -43,6 +117,8 @@ status_t WindowInfosUpdate::readFromParcel(const android::Parcel* parcel) {
 
     SAFE_PARCEL(parcel->readInt64, &vsyncId);
     SAFE_PARCEL(parcel->readInt64, &timestamp);
+    SAFE_PARCEL(parcel->readBool, &isDelta);
+    SAFE_PARCEL(parcel->readInt32Vector, &windowIds);
 
     return OK;
 }
@@ -65,6 +141,8 @@ status_t WindowInfosUpdate::writeToParcel(android::Parcel* parcel) const {
 
     SAFE_PARCEL(parcel->writeInt64, vsyncId);
     SAFE_PARCEL(parcel->writeInt64, timestamp);
+    SAFE_PARCEL(parcel->writeBool, isDelta);
+    SAFE_PARCEL(parcel->writeInt32Vector, windowIds);
 
     return OK;
 }
@@ -332,6 +332,15 @@ private:
         status_t readBlocking(ReleaseCallbackId& outId, sp<Fence>& outReleaseFence,
                               uint32_t& outMaxAcquiredBufferCount);
 
+        // Reads a buffer release message if one is already available.
+        //
+        // Returns:
+        // * OK if a ReleaseCallbackId and Fence were successfully read.
+        // * WOULD_BLOCK if there is no message to read.
+        // * UNKNOWN_ERROR if something went wrong.
+        status_t readNonBlocking(ReleaseCallbackId& outId, sp<Fence>& outReleaseFence,
+                                 uint32_t& outMaxAcquiredBufferCount);
+
         // Signals the reader's eventfd to wake up any threads waiting on readBlocking.
         void interruptBlockingRead();
 
@@ -347,6 +356,16 @@ private:
     std::shared_ptr<BufferReleaseReader> mBufferReleaseReader;
     std::shared_ptr<gui::BufferReleaseChannel::ProducerEndpoint> mBufferReleaseProducer;
 
+    struct BufferRelease {
+        ReleaseCallbackId id;
+        sp<Fence> fence;
+        uint32_t maxAcquiredBufferCount;
+    };
+
+    // Handles the releases that BufferReleaseThread read from the channel in one go, so that a
+    // burst of releases acquires mMutex once rather than once per buffer.
+    void releaseBufferCallbacks(const std::vector<BufferRelease>&);
+
     class BufferReleaseThread {
     public:
         BufferReleaseThread() = default;
@@ -354,6 +373,9 @@ private:
         void start(const sp<BLASTBufferQueue>&);
 
     private:
+        // The most releases that are handled under one acquisition of mMutex.
+        static constexpr size_t kMaxReleasesPerBatch = 8;
+
         std::shared_ptr<std::atomic_bool> mRunning;
         std::shared_ptr<BufferReleaseReader> mReader;
     };
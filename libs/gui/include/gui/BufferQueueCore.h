@@ -22,6 +22,7 @@
 #include <gui/AdditionalOptions.h>
 #include <gui/BufferItem.h>
 #include <gui/BufferQueueDefs.h>
+#include <gui/BufferQueueSlots.h>
 #include <gui/BufferSlot.h>
 #include <gui/OccupancyTracker.h>
 
@@ -32,8 +33,6 @@
 #include <utils/Trace.h>
 #include <utils/Vector.h>
 
-#include <list>
-#include <set>
 #include <mutex>
 #include <condition_variable>
 
@@ -209,18 +208,18 @@ private:
 
     // mFreeSlots contains all of the slots which are FREE and do not currently
     // have a buffer attached.
-    std::set<int> mFreeSlots;
+    BufferQueueDefs::SlotSet mFreeSlots;
 
     // mFreeBuffers contains all of the slots which are FREE and currently have
     // a buffer attached.
-    std::list<int> mFreeBuffers;
+    BufferQueueDefs::SlotList mFreeBuffers;
 
     // mUnusedSlots contains all slots that are currently unused. They should be
     // free and not have a buffer attached.
-    std::list<int> mUnusedSlots;
+    BufferQueueDefs::SlotList mUnusedSlots;
 
     // mActiveBuffers contains all slots which have a non-FREE buffer attached.
-    std::set<int> mActiveBuffers;
+    BufferQueueDefs::SlotSet mActiveBuffers;
 
     // mDequeueCondition is a condition variable used for dequeueBuffer in
     // synchronous mode.
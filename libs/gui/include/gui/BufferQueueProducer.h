@@ -47,6 +47,11 @@ public:
     // flags indicating that previously-returned buffers are no longer valid.
     virtual status_t requestBuffer(int slot, sp<GraphicBuffer>* buf);
 
+    // See IGraphicBufferProducer::requestBuffers. Unlike the default implementation, the whole
+    // batch is handled under a single acquisition of the BufferQueue lock.
+    status_t requestBuffers(const std::vector<int32_t>& slots,
+                            std::vector<RequestBufferOutput>* outputs) override;
+
     // see IGraphicsBufferProducer::setMaxDequeuedBufferCount
     virtual status_t setMaxDequeuedBufferCount(int maxDequeuedBuffers);
 
@@ -93,6 +98,11 @@ public:
                                    uint64_t* outBufferAge,
                                    FrameEventHistoryDelta* outTimestamps) override;
 
+    // See IGraphicBufferProducer::dequeueBuffers. The buffers that a batch with uniform
+    // properties is missing are allocated before the buffers are dequeued.
+    status_t dequeueBuffers(const std::vector<DequeueBufferInput>& inputs,
+                            std::vector<DequeueBufferOutput>* outputs) override;
+
     // See IGraphicBufferProducer::detachBuffer
     virtual status_t detachBuffer(int slot);
 
@@ -230,6 +240,12 @@ private:
     // BufferQueueCore::INVALID_BUFFER_SLOT otherwise
     int getFreeSlotLocked() const;
 
+    status_t requestBufferLocked(int slot, sp<GraphicBuffer>* buf);
+
+    // Allocates buffers like allocateBuffers, but stops after maxBufferCount buffers.
+    void allocateBuffers(uint32_t width, uint32_t height, PixelFormat format, uint64_t usage,
+                         size_t maxBufferCount);
+
     void addAndGetFrameTimestamps(const NewFrameEventsEntry* newTimestamps,
             FrameEventHistoryDelta* outDelta);
 
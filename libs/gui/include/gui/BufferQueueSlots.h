@@ -0,0 +1,204 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_GUI_BUFFERQUEUESLOTS_H
+#define ANDROID_GUI_BUFFERQUEUESLOTS_H
+
+#include <ui/BufferQueueDefs.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+
+namespace android {
+namespace BufferQueueDefs {
+
+static_assert(NUM_BUFFER_SLOTS <= 64, "Slot sets are stored in a 64-bit mask");
+
+// Set of buffer slots, stored as a bit mask. Iteration is in ascending order of slots. All
+// operations are O(1) and never allocate, and iterators stay valid when the set is modified.
+class SlotSet {
+public:
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = int;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const int*;
+        using reference = int;
+
+        const_iterator() = default;
+
+        int operator*() const { return __builtin_ctzll(mBits); }
+
+        const_iterator& operator++() {
+            mBits &= mBits - 1;
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            const const_iterator it = *this;
+            ++*this;
+            return it;
+        }
+
+        bool operator==(const const_iterator& other) const { return mBits == other.mBits; }
+        bool operator!=(const const_iterator& other) const { return !(*this == other); }
+
+    private:
+        friend class SlotSet;
+        explicit const_iterator(uint64_t bits) : mBits(bits) {}
+
+        uint64_t mBits = 0;
+    };
+
+    const_iterator begin() const { return const_iterator(mBits); }
+    const_iterator end() const { return const_iterator(); }
+
+    bool empty() const { return mBits == 0; }
+    size_t size() const { return static_cast<size_t>(__builtin_popcountll(mBits)); }
+    size_t count(int slot) const {
+        return isValid(slot) && (mBits & bit(slot)) != 0 ? 1 : 0;
+    }
+
+    // Returns the lowest slot. The set must not be empty.
+    int front() const { return *begin(); }
+
+    void insert(int slot) { mBits |= bit(slot); }
+
+    // Returns the number of slots removed, as std::set does.
+    size_t erase(int slot) {
+        if (count(slot) == 0) return 0;
+        mBits &= ~bit(slot);
+        return 1;
+    }
+
+    void erase(const_iterator it) { erase(*it); }
+
+    void clear() { mBits = 0; }
+
+private:
+    static bool isValid(int slot) { return slot >= 0 && slot < NUM_BUFFER_SLOTS; }
+    static uint64_t bit(int slot) { return uint64_t{1} << slot; }
+
+    uint64_t mBits = 0;
+};
+
+// Ordered list of distinct buffer slots. Slots link to their neighbors through fixed arrays, so
+// all operations, including the removal of a slot from the middle of the list, are O(1) and never
+// allocate. Adding a slot that is already listed moves it.
+class SlotList {
+public:
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = int;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const int*;
+        using reference = int;
+
+        const_iterator() = default;
+
+        int operator*() const { return mSlot; }
+
+        const_iterator& operator++() {
+            mSlot = mList->mNext[static_cast<size_t>(mSlot)];
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            const const_iterator it = *this;
+            ++*this;
+            return it;
+        }
+
+        bool operator==(const const_iterator& other) const { return mSlot == other.mSlot; }
+        bool operator!=(const const_iterator& other) const { return !(*this == other); }
+
+    private:
+        friend class SlotList;
+        const_iterator(const SlotList* list, int slot) : mList(list), mSlot(slot) {}
+
+        const SlotList* mList = nullptr;
+        int mSlot = kNone;
+    };
+
+    const_iterator begin() const { return const_iterator(this, mHead); }
+    const_iterator end() const { return const_iterator(this, kNone); }
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend() const { return end(); }
+
+    bool empty() const { return mSlots.empty(); }
+    size_t size() const { return mSlots.size(); }
+    bool contains(int slot) const { return mSlots.count(slot) != 0; }
+
+    // The list must not be empty.
+    int front() const { return mHead; }
+    int back() const { return mTail; }
+
+    void push_front(int slot) {
+        remove(slot);
+        link(slot, kNone, mHead);
+    }
+
+    void push_back(int slot) {
+        remove(slot);
+        link(slot, mTail, kNone);
+    }
+
+    void pop_front() { remove(mHead); }
+    void pop_back() { remove(mTail); }
+
+    // Removes the slot if it is listed.
+    void remove(int slot) {
+        if (!contains(slot)) return;
+
+        const int prev = mPrev[static_cast<size_t>(slot)];
+        const int next = mNext[static_cast<size_t>(slot)];
+        (prev == kNone ? mHead : mNext[static_cast<size_t>(prev)]) = static_cast<int8_t>(next);
+        (next == kNone ? mTail : mPrev[static_cast<size_t>(next)]) = static_cast<int8_t>(prev);
+        mSlots.erase(slot);
+    }
+
+    void clear() {
+        mHead = kNone;
+        mTail = kNone;
+        mSlots.clear();
+    }
+
+private:
+    static constexpr int8_t kNone = -1;
+
+    void link(int slot, int prev, int next) {
+        mPrev[static_cast<size_t>(slot)] = static_cast<int8_t>(prev);
+        mNext[static_cast<size_t>(slot)] = static_cast<int8_t>(next);
+        (prev == kNone ? mHead : mNext[static_cast<size_t>(prev)]) = static_cast<int8_t>(slot);
+        (next == kNone ? mTail : mPrev[static_cast<size_t>(next)]) = static_cast<int8_t>(slot);
+        mSlots.insert(slot);
+    }
+
+    std::array<int8_t, NUM_BUFFER_SLOTS> mPrev{};
+    std::array<int8_t, NUM_BUFFER_SLOTS> mNext{};
+    int8_t mHead = kNone;
+    int8_t mTail = kNone;
+    SlotSet mSlots;
+};
+
+} // namespace BufferQueueDefs
+} // namespace android
+
+#endif
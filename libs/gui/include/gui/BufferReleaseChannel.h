@@ -53,6 +53,8 @@ private:
     };
 
 public:
+    struct Message;
+
     class ConsumerEndpoint : public Endpoint {
     public:
         ConsumerEndpoint(std::string name, android::base::unique_fd fd)
@@ -84,6 +86,13 @@ public:
         status_t writeReleaseFence(const ReleaseCallbackId&, const sp<Fence>& releaseFence,
                                    uint32_t maxAcquiredBufferCount);
 
+        /**
+         * Writes several release fences with a single system call. Each one is read by the
+         * consumer as if it had been written with writeReleaseFence. The release fences of the
+         * messages must not be null.
+         */
+        status_t writeReleaseFences(const std::vector<Message>& messages);
+
     private:
         std::vector<uint8_t> mFlattenedBuffer;
     };
@@ -58,11 +58,14 @@ class Choreographer;
 
 /**
  * Implementation of AChoreographerFrameCallbackData.
+ *
+ * It is only valid for the duration of the callback, so it refers to the vsync data that the
+ * Choreographer received rather than copying it for every callback.
  */
 struct ChoreographerFrameCallbackDataImpl {
     int64_t frameTimeNanos{0};
 
-    VsyncEventData vsyncEventData;
+    const VsyncEventData& vsyncEventData;
 
     const Choreographer* choreographer;
 };
@@ -116,8 +119,8 @@ private:
 
     void dispatchVsync(nsecs_t timestamp, PhysicalDisplayId displayId, uint32_t count,
                        VsyncEventData vsyncEventData) override;
-    void dispatchCallbacks(const std::vector<FrameCallback>&, VsyncEventData vsyncEventData,
-                           nsecs_t timestamp);
+    void dispatchCallbacks(const std::vector<FrameCallback>&,
+                           const VsyncEventData& vsyncEventData, nsecs_t timestamp);
     void dispatchHotplug(nsecs_t timestamp, PhysicalDisplayId displayId, bool connected) override;
     void dispatchHotplugConnectionError(nsecs_t timestamp, int32_t connectionError) override;
     void dispatchModeChanged(nsecs_t timestamp, PhysicalDisplayId displayId, int32_t modeId,
@@ -201,6 +201,16 @@ protected:
     // This method must be called with mMutex locked.
     virtual void freeBufferLocked(int slotIndex);
 
+    // discardFreeBuffersLocked is called once buffers that are not expected
+    // back have been freed: when free buffers are discarded, and when the
+    // buffer count is changed.
+    //
+    // Derived classes that keep state for buffers after their slots are freed
+    // should override this method to release that state.
+    //
+    // This method must be called with mMutex locked.
+    virtual void discardFreeBuffersLocked();
+
     // abandonLocked puts the BufferQueue into the abandoned state, causing
     // all future operations on it to fail. This method rather than the public
     // abandon method should be overridden by child classes to add abandon-
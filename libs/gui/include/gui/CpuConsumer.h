@@ -150,10 +150,14 @@ class CpuConsumer : public ConsumerBase
 
     size_t findAcquiredBufferLocked(uintptr_t id) const;
 
-    status_t lockBufferItem(const BufferItem& item, LockedBuffer* outBuffer) const;
+    status_t lockBufferItem(const BufferItem& item, LockedBuffer* outBuffer);
 
     Vector<AcquiredBuffer> mAcquiredBuffers;
 
+    // The buffers of each slot that could not be locked as flexible YUV, so that later frames in
+    // them are locked directly instead of failing a YCbCr lock first. Guarded by mMutex.
+    uint64_t mNonFlexYuvBufferIds[BufferQueue::NUM_BUFFER_SLOTS] = {};
+
     // Count of currently locked buffers
     size_t mCurrentLockedBuffers;
 };
@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <gui/DisplayEventReceiver.h>
+
+#include <optional>
+#include <vector>
+
+namespace android {
+
+// Reads all the events queued on a display event channel, and drops the ones that are stale by
+// the time they are read. This happens when the main thread of an app is busy, and events pile up
+// until it gets back to its looper.
+//
+// Only the latest vsync is kept. A mode change is dropped if a later mode change for the same
+// display follows it without a hotplug of that display in between. All other events are kept in
+// the order they were sent.
+class DisplayEventCoalescer {
+public:
+    using Event = DisplayEventReceiver::Event;
+
+    // Reads the pending events. Returns the number of events read, or the read error. Events read
+    // before an error are still coalesced.
+    ssize_t drain(DisplayEventReceiver& receiver);
+    ssize_t drain(gui::BitTube* channel);
+
+    // The latest vsync read by the last drain.
+    const std::optional<Event>& latestVsync() const { return mLatestVsync; }
+
+    // The events left to dispatch after the last drain, in order. This excludes the vsync.
+    const Event* events() const { return mEvents.data(); }
+    size_t eventCount() const { return mEventCount; }
+
+    // The number of events the last drain dropped, including earlier vsyncs.
+    size_t droppedEventCount() const { return mDroppedEventCount; }
+
+private:
+    template <typename Read>
+    ssize_t drainWith(Read read);
+    void coalesce();
+
+    // The read buffer. It keeps its size between drains, so that it's only allocated once.
+    std::vector<Event> mEvents;
+    size_t mEventCount = 0;
+    std::optional<Event> mLatestVsync;
+    size_t mDroppedEventCount = 0;
+    // The displays with a later mode change, while walking the events backwards.
+    std::vector<PhysicalDisplayId> mDisplaysWithModeChange;
+};
+
+} // namespace android
@@ -14,6 +14,7 @@
  * limitations under the License.
  */
 
+#include <gui/DisplayEventCoalescer.h>
 #include <gui/DisplayEventReceiver.h>
 #include <utils/Log.h>
 #include <utils/Looper.h>
@@ -46,6 +47,7 @@ private:
     bool mWaitingForVsync;
     uint32_t mLastVsyncCount;
     nsecs_t mLastScheduleVsyncTime;
+    DisplayEventCoalescer mCoalescer;
 
     std::vector<FrameRateOverride> mFrameRateOverrides;
 
@@ -31,6 +31,8 @@
 #include <utils/Vector.h>
 #include <utils/threads.h>
 
+#include <vector>
+
 namespace android {
 // ----------------------------------------------------------------------------
 
@@ -254,7 +256,8 @@ public:
 protected:
 
     // abandonLocked overrides the ConsumerBase method to clear
-    // mCurrentTextureImage in addition to the ConsumerBase behavior.
+    // mCurrentTextureImage and mEglImageCache in addition to the ConsumerBase
+    // behavior.
     virtual void abandonLocked();
 
     // dumpLocked overrides the ConsumerBase method to dump GLConsumer-
@@ -364,11 +367,30 @@ private:
 
     // freeBufferLocked frees up the given buffer slot. If the slot has been
     // initialized this will release the reference to the GraphicBuffer in that
-    // slot and destroy the EGLImage in that slot.  Otherwise it has no effect.
+    // slot and move the EglImage of that slot to mEglImageCache.  Otherwise it
+    // has no effect.
     //
     // This method must be called with mMutex locked.
     virtual void freeBufferLocked(int slotIndex);
 
+    // discardFreeBuffersLocked overrides the ConsumerBase method to destroy
+    // the EglImages in mEglImageCache, so that the buffers they keep alive
+    // are released with the rest.
+    //
+    // This method must be called with mMutex locked.
+    virtual void discardFreeBuffersLocked() override;
+
+    // cacheEglImageLocked adds the EglImage of a buffer that left its slot to
+    // mEglImageCache, evicting the least recently cached image if the cache is
+    // full.
+    void cacheEglImageLocked(sp<EglImage> image);
+
+    // takeCachedEglImageLocked removes the EglImage of the buffer with the
+    // given id from mEglImageCache and returns it, or returns null if there is
+    // none.  Cached images that have not been reused for MAX_EGL_IMAGE_CACHE_AGE
+    // acquires are destroyed along the way.
+    sp<EglImage> takeCachedEglImageLocked(uint64_t bufferId);
+
     // computeCurrentTransformMatrixLocked computes the transform matrix for the
     // current texture.  It uses mCurrentTransform and the current GraphicBuffer
     // to compute this matrix and stores it in mCurrentTransformMatrix.
@@ -400,6 +422,30 @@ private:
     // must track it separately in order to support the getCurrentBuffer method.
     sp<EglImage> mCurrentTextureImage;
 
+    // MAX_CACHED_EGL_IMAGES bounds mEglImageCache, and MAX_EGL_IMAGE_CACHE_AGE
+    // is the number of acquires after which a cached image that has not come
+    // back is destroyed.  Cached images keep their GraphicBuffer alive, so
+    // both bounds are kept small.
+    static constexpr size_t MAX_CACHED_EGL_IMAGES = 4;
+    static constexpr uint64_t MAX_EGL_IMAGE_CACHE_AGE = 64;
+
+    struct CachedEglImage {
+        sp<EglImage> image;
+        // acquireCount is the value of mAcquireCount when image was cached.
+        uint64_t acquireCount;
+    };
+
+    // mEglImageCache holds the EglImages of buffers that recently left their
+    // slots, least recently cached first.  Producers that rotate more buffers
+    // through the queue than it has slots, e.g. by attaching them in turn, get
+    // their EGLImages back from here instead of creating a new one each time a
+    // buffer returns to a slot.
+    std::vector<CachedEglImage> mEglImageCache;
+
+    // mAcquireCount is the number of buffers acquired, and ages the entries of
+    // mEglImageCache.
+    uint64_t mAcquireCount = 0;
+
     // mCurrentCrop is the crop rectangle that applies to the current texture.
     // It gets set each time updateTexImage is called.
     Rect mCurrentCrop;
@@ -19,11 +19,12 @@
 #define ANDROID_GUI_OCCUPANCYTRACKER_H
 
 #include <binder/Parcelable.h>
+#include <ui/BufferQueueDefs.h>
 
 #include <utils/Timers.h>
 
+#include <array>
 #include <deque>
-#include <unordered_map>
 
 namespace android {
 
@@ -77,16 +78,24 @@ private:
     static constexpr nsecs_t NEW_SEGMENT_DELAY = ms2ns(100);
     static constexpr size_t LONG_SEGMENT_THRESHOLD = 3;
 
+    // The queue can't hold more buffers than there are slots.
+    static constexpr size_t MAX_OCCUPANCY = BufferQueueDefs::NUM_BUFFER_SLOTS;
+
     struct PendingSegment {
         void clear() {
             totalTime = 0;
             numFrames = 0;
-            mOccupancyTimes.clear();
+            usedThirdBuffer = false;
+            mOccupancyTimes.fill(0);
         }
 
         nsecs_t totalTime;
         size_t numFrames;
-        std::unordered_map<size_t, nsecs_t> mOccupancyTimes;
+        bool usedThirdBuffer;
+
+        // Time spent at each occupancy, indexed by occupancy. This is updated on every queue and
+        // acquire, so it is a fixed array instead of a map.
+        std::array<nsecs_t, MAX_OCCUPANCY + 1> mOccupancyTimes;
     };
 
     void recordPendingSegment();
@@ -19,12 +19,16 @@
 
 #include <gui/IConsumerListener.h>
 #include <gui/IProducerListener.h>
+#include <ui/BufferQueueDefs.h>
 
 #include <utils/Condition.h>
 #include <utils/KeyedVector.h>
 #include <utils/Mutex.h>
 #include <utils/StrongPointer.h>
 
+#include <array>
+#include <vector>
+
 namespace android {
 
 class GraphicBuffer;
@@ -36,7 +40,9 @@ class IGraphicBufferProducer;
 // in BufferQueue, it is able to present the illusion of a single split
 // BufferQueue, where each buffer queued to the input is available to be
 // acquired by each of the outputs, and is able to be dequeued by the input
-// again only once all of the outputs have released it.
+// again only once all of the outputs have released it. Buffers stay acquired
+// from the input while the outputs hold them, so the input producer gets its
+// buffers back in the same slots.
 class StreamSplitter : public BnConsumerListener {
 public:
     // createSplitter creates a new splitter, outSplitter, using inputQueue as
@@ -69,7 +75,7 @@ public:
 private:
     // From IConsumerListener
     //
-    // During this callback, we store some tracking information, detach the
+    // During this callback, we store some tracking information, acquire the
     // buffer from the input, and attach it to each of the outputs. This call
     // can block if there are too many outstanding buffers. If it blocks, it
     // will resume when onBufferReleasedByOutput releases a buffer back to the
@@ -77,10 +83,11 @@ private:
     virtual void onFrameAvailable(const BufferItem& item);
 
     // From IConsumerListener
-    // We don't care about released buffers because we detach each buffer as
-    // soon as we acquire it. See the comment for onBufferReleased below for
-    // some clarifying notes about the name.
-    virtual void onBuffersReleased() {}
+    // During this callback, we forget the input buffers that were freed, so
+    // that the next acquire of their slots provides the new buffer. See the
+    // comment for onBufferReleased below for some clarifying notes about the
+    // name.
+    virtual void onBuffersReleased();
 
     // From IConsumerListener
     // We don't care about sideband streams, since we won't be splitting them
@@ -128,12 +135,17 @@ private:
 
     class BufferTracker : public LightRefBase<BufferTracker> {
     public:
-        explicit BufferTracker(const sp<GraphicBuffer>& buffer);
+        BufferTracker(const sp<GraphicBuffer>& buffer, int slot,
+                uint64_t frameNumber);
 
         const sp<GraphicBuffer>& getBuffer() const { return mBuffer; }
-        const sp<Fence>& getMergedFence() const { return mMergedFence; }
+        int getSlot() const { return mSlot; }
+        uint64_t getFrameNumber() const { return mFrameNumber; }
 
-        void mergeFence(const sp<Fence>& with);
+        // Release fences are collected as the outputs release the buffer, and
+        // merged once when it is released to the input.
+        void addReleaseFence(const sp<Fence>& fence);
+        sp<Fence> getMergedFence() const;
 
         // Returns the new value
         // Only called while mMutex is held
@@ -149,7 +161,9 @@ private:
         BufferTracker& operator=(const BufferTracker& other);
 
         sp<GraphicBuffer> mBuffer; // One instance that holds this native handle
-        sp<Fence> mMergedFence;
+        int mSlot; // The input slot that the buffer was acquired from
+        uint64_t mFrameNumber;
+        std::vector<sp<Fence>> mReleaseFences;
         size_t mReleaseCount;
     };
 
@@ -177,6 +191,10 @@ private:
     // objects (which are mostly for counting how many outputs have released the
     // buffer, but also contain merged release fences).
     KeyedVector<uint64_t, sp<BufferTracker> > mBuffers;
+
+    // The buffers of the input slots. The input only provides the buffer of a
+    // slot on its first acquire, so it is kept until the input frees the slot.
+    std::array<sp<GraphicBuffer>, BufferQueueDefs::NUM_BUFFER_SLOTS> mInputBuffers;
 };
 
 } // namespace android
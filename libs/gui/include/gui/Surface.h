@@ -298,6 +298,19 @@ private:
             ANativeWindowBuffer* buffer, int fenceFd);
     static int hook_setSwapInterval(ANativeWindow* window, int interval);
 
+    // ANativeWindowPerformTable hooks, which bypass the variadic hook_perform
+    // unless a perform interceptor is installed. Subclasses that override
+    // perform() opt out of them with disablePerformTable().
+    static int hook_setBuffersDataSpace(ANativeWindow* window, android_dataspace_t dataSpace);
+    static int hook_setBuffersTimestamp(ANativeWindow* window, int64_t timestamp);
+    static int hook_setBuffersTransform(ANativeWindow* window, int transform);
+    static int hook_setCrop(ANativeWindow* window, const android_native_rect_t* crop);
+    static int hook_setSurfaceDamage(ANativeWindow* window, const android_native_rect_t* rects,
+                                     size_t numRects);
+    static const ANativeWindowPerformTable sPerformTable;
+
+    bool hasPerformInterceptor() const;
+
     static int cancelBufferInternal(ANativeWindow* window, ANativeWindowBuffer* buffer,
                                     int fenceFd);
     static int dequeueBufferInternal(ANativeWindow* window, ANativeWindowBuffer** buffer,
@@ -379,6 +392,11 @@ protected:
     virtual int perform(int operation, va_list args);
     virtual int setSwapInterval(int interval);
 
+    // Surface implements the operations of ANativeWindowPerformTable without going through
+    // perform(). Subclasses that override perform() to handle any of them must call this from
+    // their constructor, so that those operations reach their override.
+    void disablePerformTable();
+
     virtual int lockBuffer_DEPRECATED(ANativeWindowBuffer* buffer);
 
     virtual int connect(int api);
@@ -58,6 +58,10 @@ struct VsyncEventData {
 
     // Gets the preferred frame timeline's expected vsync timestamp.
     int64_t preferredExpectedPresentationTime() const;
+
+    // Gets the time left until the preferred frame timeline's deadline, given the current time in
+    // CLOCK_MONOTONIC nanos. Negative once the deadline has passed.
+    int64_t timeUntilPreferredDeadline(int64_t now) const;
 };
 
 struct ParcelableVsyncEventData : public Parcelable {
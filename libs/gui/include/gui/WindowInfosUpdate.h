@@ -20,6 +20,8 @@
 #include <gui/DisplayInfo.h>
 #include <gui/WindowInfo.h>
 
+#include <optional>
+
 namespace android::gui {
 
 struct WindowInfosUpdate : public Parcelable {
@@ -37,6 +39,20 @@ struct WindowInfosUpdate : public Parcelable {
     int64_t vsyncId;
     int64_t timestamp;
 
+    // Set when windowInfos only holds the windows which were added or changed since the previous
+    // update sent to the same listener. windowIds then holds the id of every window, in order.
+    bool isDelta = false;
+    std::vector<int32_t> windowIds;
+
+    // Returns a delta of this update against the windows of the previous one, or std::nullopt if
+    // the windows can't be told apart by their ids.
+    std::optional<WindowInfosUpdate> makeDelta(
+            const std::vector<WindowInfo>& previousWindowInfos) const;
+
+    // Expands a delta into the full list of windows, given the windows of the previous update.
+    // Returns BAD_VALUE if the delta refers to a window which isn't in previousWindowInfos.
+    status_t applyDelta(const std::vector<WindowInfo>& previousWindowInfos);
+
     status_t writeToParcel(android::Parcel*) const override;
     status_t readFromParcel(const android::Parcel*) override;
 };
@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <gui/DisplayEventCoalescer.h>
+#include <private/gui/BitTube.h>
+
+#include <iterator>
+
+namespace android {
+
+namespace {
+
+using Event = DisplayEventReceiver::Event;
+
+constexpr PhysicalDisplayId kDisplayId = PhysicalDisplayId::fromPort(1);
+
+// Queues the events SurfaceFlinger sends while the main thread of an app is busy for the given
+// number of frames: a vsync per frame, and a mode change every fourth frame. The channel is a
+// SOCK_SEQPACKET socket, which holds a limited number of packets, so the frame counts stay small.
+void queueEvents(gui::BitTube& channel, int frames) {
+    for (int frame = 0; frame < frames; frame++) {
+        Event event{};
+        event.header = {DisplayEventReceiver::DISPLAY_EVENT_VSYNC, kDisplayId, frame};
+        event.vsync.count = static_cast<uint32_t>(frame);
+        event.vsync.vsyncData.frameTimelinesLength = VsyncEventData::kFrameTimelinesCapacity;
+        DisplayEventReceiver::sendEvents(&channel, &event, 1);
+
+        if (frame % 4 == 3) {
+            event = {};
+            event.header = {DisplayEventReceiver::DISPLAY_EVENT_MODE_CHANGE, kDisplayId, frame};
+            event.modeChange.modeId = frame;
+            DisplayEventReceiver::sendEvents(&channel, &event, 1);
+        }
+    }
+}
+
+// Reads the events as DisplayEventDispatcher used to: in fixed batches, copying the vsync data of
+// every vsync and handing every other event on.
+void drainPerEvent(benchmark::State& state) {
+    gui::BitTube channel(gui::BitTube::DefaultSize);
+    Event buffer[100];
+    for (auto _ : state) {
+        state.PauseTiming();
+        queueEvents(channel, static_cast<int>(state.range(0)));
+        state.ResumeTiming();
+
+        VsyncEventData vsyncData;
+        size_t dispatched = 0;
+        ssize_t n;
+        while ((n = DisplayEventReceiver::getEvents(&channel, buffer, std::size(buffer))) > 0) {
+            for (ssize_t i = 0; i < n; i++) {
+                if (buffer[i].header.type == DisplayEventReceiver::DISPLAY_EVENT_VSYNC) {
+                    vsyncData = buffer[i].vsync.vsyncData;
+                } else {
+                    dispatched++;
+                }
+            }
+        }
+        benchmark::DoNotOptimize(vsyncData);
+        benchmark::DoNotOptimize(dispatched);
+    }
+}
+BENCHMARK(drainPerEvent)->Arg(1)->Arg(4)->Arg(8);
+
+void drainCoalesced(benchmark::State& state) {
+    gui::BitTube channel(gui::BitTube::DefaultSize);
+    DisplayEventCoalescer coalescer;
+    for (auto _ : state) {
+        state.PauseTiming();
+        queueEvents(channel, static_cast<int>(state.range(0)));
+        state.ResumeTiming();
+
+        coalescer.drain(&channel);
+        VsyncEventData vsyncData;
+        if (const auto& vsync = coalescer.latestVsync()) {
+            vsyncData = vsync->vsync.vsyncData;
+        }
+        benchmark::DoNotOptimize(vsyncData);
+        benchmark::DoNotOptimize(coalescer.eventCount());
+    }
+}
+BENCHMARK(drainCoalesced)->Arg(1)->Arg(4)->Arg(8);
+
+} // namespace
+
+} // namespace android
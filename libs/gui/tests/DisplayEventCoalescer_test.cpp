@@ -0,0 +1,147 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <gui/DisplayEventCoalescer.h>
+#include <private/gui/BitTube.h>
+
+#include <vector>
+
+namespace android::test {
+
+using Event = DisplayEventReceiver::Event;
+
+constexpr PhysicalDisplayId kDisplayId = PhysicalDisplayId::fromPort(1);
+constexpr PhysicalDisplayId kOtherDisplayId = PhysicalDisplayId::fromPort(2);
+
+class DisplayEventCoalescerTest : public testing::Test {
+protected:
+    void send(const Event& event) {
+        ASSERT_EQ(1, DisplayEventReceiver::sendEvents(&mChannel, &event, 1));
+    }
+
+    static Event vsync(uint32_t count) {
+        Event event{};
+        event.header = {DisplayEventReceiver::DISPLAY_EVENT_VSYNC, kDisplayId, count * 10};
+        event.vsync.count = count;
+        return event;
+    }
+
+    static Event modeChange(PhysicalDisplayId displayId, int32_t modeId) {
+        Event event{};
+        event.header = {DisplayEventReceiver::DISPLAY_EVENT_MODE_CHANGE, displayId, 0};
+        event.modeChange.modeId = modeId;
+        return event;
+    }
+
+    static Event hotplug(PhysicalDisplayId displayId, bool connected) {
+        Event event{};
+        event.header = {DisplayEventReceiver::DISPLAY_EVENT_HOTPLUG, displayId, 0};
+        event.hotplug.connected = connected;
+        return event;
+    }
+
+    static Event frameRateOverride(uid_t uid, float frameRateHz) {
+        Event event{};
+        event.header = {DisplayEventReceiver::DISPLAY_EVENT_FRAME_RATE_OVERRIDE, kDisplayId, 0};
+        event.frameRateOverride = {uid, frameRateHz};
+        return event;
+    }
+
+    static Event frameRateOverrideFlush() {
+        Event event{};
+        event.header = {DisplayEventReceiver::DISPLAY_EVENT_FRAME_RATE_OVERRIDE_FLUSH, kDisplayId,
+                        0};
+        return event;
+    }
+
+    // Large enough for a send of many frame rate overrides.
+    gui::BitTube mChannel{64 * 1024};
+    DisplayEventCoalescer mCoalescer;
+};
+
+TEST_F(DisplayEventCoalescerTest, keepsLatestVsync) {
+    send(vsync(1));
+    send(vsync(2));
+    send(vsync(3));
+
+    EXPECT_EQ(3, mCoalescer.drain(&mChannel));
+    ASSERT_TRUE(mCoalescer.latestVsync());
+    EXPECT_EQ(3u, mCoalescer.latestVsync()->vsync.count);
+    EXPECT_EQ(0u, mCoalescer.eventCount());
+    EXPECT_EQ(2u, mCoalescer.droppedEventCount());
+
+    // Nothing is left for the next drain.
+    EXPECT_EQ(0, mCoalescer.drain(&mChannel));
+    EXPECT_FALSE(mCoalescer.latestVsync());
+}
+
+TEST_F(DisplayEventCoalescerTest, keepsLatestModeChangeOfEachDisplay) {
+    send(modeChange(kDisplayId, 1));
+    send(modeChange(kOtherDisplayId, 10));
+    send(vsync(1));
+    send(modeChange(kDisplayId, 2));
+
+    EXPECT_EQ(4, mCoalescer.drain(&mChannel));
+    ASSERT_EQ(2u, mCoalescer.eventCount());
+    EXPECT_EQ(kOtherDisplayId, mCoalescer.events()[0].header.displayId);
+    EXPECT_EQ(10, mCoalescer.events()[0].modeChange.modeId);
+    EXPECT_EQ(kDisplayId, mCoalescer.events()[1].header.displayId);
+    EXPECT_EQ(2, mCoalescer.events()[1].modeChange.modeId);
+    EXPECT_EQ(1u, mCoalescer.droppedEventCount());
+}
+
+TEST_F(DisplayEventCoalescerTest, keepsModeChangesAcrossHotplug) {
+    send(modeChange(kDisplayId, 1));
+    send(hotplug(kDisplayId, false));
+    send(hotplug(kDisplayId, true));
+    send(modeChange(kDisplayId, 2));
+
+    EXPECT_EQ(4, mCoalescer.drain(&mChannel));
+    ASSERT_EQ(4u, mCoalescer.eventCount());
+    EXPECT_EQ(1, mCoalescer.events()[0].modeChange.modeId);
+    EXPECT_FALSE(mCoalescer.events()[1].hotplug.connected);
+    EXPECT_TRUE(mCoalescer.events()[2].hotplug.connected);
+    EXPECT_EQ(2, mCoalescer.events()[3].modeChange.modeId);
+    EXPECT_EQ(0u, mCoalescer.droppedEventCount());
+}
+
+TEST_F(DisplayEventCoalescerTest, readsAllFrameRateOverridesOfASend) {
+    // The overrides of a display are sent together, followed by a flush.
+    constexpr size_t kOverrideCount = 40;
+    std::vector<Event> events;
+    for (size_t i = 0; i < kOverrideCount; i++) {
+        events.push_back(frameRateOverride(static_cast<uid_t>(10000 + i), 30.f));
+    }
+    events.push_back(frameRateOverrideFlush());
+    ASSERT_EQ(static_cast<ssize_t>(events.size()),
+              DisplayEventReceiver::sendEvents(&mChannel, events.data(), events.size()));
+    send(vsync(1));
+
+    EXPECT_EQ(static_cast<ssize_t>(kOverrideCount + 2), mCoalescer.drain(&mChannel));
+    ASSERT_EQ(kOverrideCount + 1, mCoalescer.eventCount());
+    for (size_t i = 0; i < kOverrideCount; i++) {
+        EXPECT_EQ(static_cast<uint32_t>(DisplayEventReceiver::DISPLAY_EVENT_FRAME_RATE_OVERRIDE),
+                  mCoalescer.events()[i].header.type);
+        EXPECT_EQ(static_cast<uid_t>(10000 + i), mCoalescer.events()[i].frameRateOverride.uid);
+    }
+    EXPECT_EQ(static_cast<uint32_t>(DisplayEventReceiver::DISPLAY_EVENT_FRAME_RATE_OVERRIDE_FLUSH),
+              mCoalescer.events()[kOverrideCount].header.type);
+    EXPECT_TRUE(mCoalescer.latestVsync());
+}
+
+} // namespace android::test
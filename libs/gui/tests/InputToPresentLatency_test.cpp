@@ -0,0 +1,376 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Measures where the time goes between a touch and the frame that responds to it being presented.
+//
+// The test acts as a small app: it injects taps onto its own window, and for every ACTION_DOWN it
+// receives it renders and queues one frame. The frame carries the id of the input event in its
+// FrameTimelineInfo, which is the identifier that ties the two together in the input traces
+// (InputEventTimeline) and in SurfaceFlinger's FrameTimeline. The frame timestamps reported back
+// by SurfaceFlinger then split the latency into stages, and the test prints percentiles for each.
+
+#include <gtest/gtest.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <android-base/stringprintf.h>
+#include <android-base/thread_annotations.h>
+#include <android/gui/BnWindowInfosReportedListener.h>
+#include <android/gui/FrameTimelineInfo.h>
+#include <android/native_window.h>
+#include <android/os/IInputFlinger.h>
+#include <binder/Binder.h>
+#include <binder/IServiceManager.h>
+#include <binder/ProcessState.h>
+#include <gui/Surface.h>
+#include <gui/SurfaceComposerClient.h>
+#include <gui/SurfaceControl.h>
+#include <gui/WindowInfo.h>
+#include <input/Input.h>
+#include <input/InputConsumer.h>
+#include <input/InputTransport.h>
+#include <log/log.h>
+#include <system/window.h>
+#include <utils/Timers.h>
+
+namespace android::test {
+
+using namespace std::chrono_literals;
+
+using android::base::StringAppendF;
+using android::base::StringPrintf;
+using android::gui::InputApplicationInfo;
+using android::gui::WindowInfo;
+using android::os::IInputFlinger;
+
+namespace {
+
+constexpr int kSurfaceX = 100;
+constexpr int kSurfaceY = 100;
+constexpr int kSurfaceSize = 200;
+// Above everything else, like the other end-to-end input tests.
+constexpr int kLayer = INT32_MAX - 10;
+
+constexpr size_t kSampleCount = 50;
+constexpr std::chrono::milliseconds kInputTimeout = 3000ms;
+constexpr std::chrono::milliseconds kPresentTimeout = 1000ms;
+
+class SynchronousWindowInfosReportedListener : public gui::BnWindowInfosReportedListener {
+public:
+    binder::Status onWindowInfosReported() override {
+        std::scoped_lock lock{mLock};
+        mWindowInfosReported = true;
+        mConditionVariable.notify_one();
+        return binder::Status::ok();
+    }
+
+    void wait() {
+        std::unique_lock lock{mLock};
+        android::base::ScopedLockAssertion assumeLocked(mLock);
+        mConditionVariable.wait(lock, [&]() REQUIRES(mLock) { return mWindowInfosReported; });
+    }
+
+private:
+    std::mutex mLock;
+    std::condition_variable mConditionVariable;
+    bool mWindowInfosReported GUARDED_BY(mLock){false};
+};
+
+// The stages a touch goes through on its way to the display. Each is measured from the end of the
+// previous one.
+enum class Stage {
+    // From the injection of the event to the app reading it from its input channel.
+    INPUT_DISPATCH,
+    // From the app reading the event to the app queueing the frame that responds to it.
+    APP_RENDER,
+    // From queueBuffer to SurfaceFlinger latching the buffer.
+    LATCH,
+    // From the latch to the start of the composition that includes the buffer.
+    COMPOSITION_START,
+    // From the start of composition to the present fence of the display signalling.
+    PRESENT,
+    // The whole way, from the injection of the event to the present fence.
+    TOTAL,
+};
+
+constexpr std::array<const char*, static_cast<size_t>(Stage::TOTAL) + 1> kStageNames = {
+        "input dispatch", "app render", "latch", "composition start", "present", "total",
+};
+
+class LatencyReport {
+public:
+    void add(Stage stage, nsecs_t duration) {
+        mSamples[static_cast<size_t>(stage)].push_back(duration);
+    }
+
+    std::string dump() {
+        std::string out = StringPrintf("%-20s %8s %8s %8s %8s %8s\n", "stage (ms)", "count", "p50",
+                                       "p90", "p99", "max");
+        for (size_t i = 0; i < mSamples.size(); i++) {
+            std::vector<nsecs_t>& samples = mSamples[i];
+            if (samples.empty()) {
+                continue;
+            }
+            std::sort(samples.begin(), samples.end());
+            StringAppendF(&out, "%-20s %8zu %8.2f %8.2f %8.2f %8.2f\n", kStageNames[i],
+                          samples.size(), percentileMs(samples, 50), percentileMs(samples, 90),
+                          percentileMs(samples, 99), ns2us(samples.back()) / 1000.f);
+        }
+        return out;
+    }
+
+private:
+    static float percentileMs(const std::vector<nsecs_t>& sortedSamples, size_t percentile) {
+        const size_t index = (sortedSamples.size() - 1) * percentile / 100;
+        return ns2us(sortedSamples[index]) / 1000.f;
+    }
+
+    std::array<std::vector<nsecs_t>, kStageNames.size()> mSamples;
+};
+
+sp<IInputFlinger> getInputFlinger() {
+    sp<IBinder> input(defaultServiceManager()->waitForService(String16("inputflinger")));
+    return interface_cast<IInputFlinger>(input);
+}
+
+// Injects a tap through the shell, the same way a user-driven test would, and waits for the
+// injection to finish so that taps don't overlap.
+void injectTap(int x, int y) {
+    const std::string xArg = std::to_string(x);
+    const std::string yArg = std::to_string(y);
+    const pid_t pid = fork();
+    if (pid == 0) {
+        execlp("input", "input", "tap", xArg.c_str(), yArg.c_str(), nullptr);
+        _exit(1);
+    }
+    if (pid > 0) {
+        waitpid(pid, nullptr, 0);
+    }
+}
+
+} // namespace
+
+class InputToPresentLatencyTest : public ::testing::Test {
+protected:
+    InputToPresentLatencyTest() { ProcessState::self()->startThreadPool(); }
+
+    void SetUp() override {
+        mComposerClient = sp<SurfaceComposerClient>::make();
+        ASSERT_EQ(NO_ERROR, mComposerClient->initCheck());
+
+        mSurfaceControl =
+                mComposerClient->createSurface(String8("InputToPresentLatency"), kSurfaceSize,
+                                               kSurfaceSize, PIXEL_FORMAT_RGBA_8888,
+                                               ISurfaceComposerClient::eFXSurfaceBufferState);
+        ASSERT_NE(nullptr, mSurfaceControl);
+
+        mInputFlinger = getInputFlinger();
+        ASSERT_NE(nullptr, mInputFlinger);
+        android::os::InputChannelCore channel;
+        ASSERT_TRUE(mInputFlinger->createInputChannel("InputToPresentLatency", &channel).isOk());
+        mClientChannel = InputChannel::create(std::move(channel));
+        mInputConsumer = std::make_unique<InputConsumer>(mClientChannel);
+
+        WindowInfo info;
+        info.token = mClientChannel->getConnectionToken();
+        info.name = "InputToPresentLatency";
+        info.dispatchingTimeout = 5s;
+        info.globalScaleFactor = 1.0;
+        info.touchableRegion.orSelf(Rect(0, 0, kSurfaceSize, kSurfaceSize));
+        InputApplicationInfo applicationInfo;
+        applicationInfo.token = sp<BBinder>::make();
+        applicationInfo.name = "InputToPresentLatency";
+        applicationInfo.dispatchingTimeoutMillis = 5000;
+        info.applicationInfo = applicationInfo;
+
+        mSurface = mSurfaceControl->getSurface();
+        ASSERT_NE(nullptr, mSurface);
+        mWindow = mSurface;
+        // The surface connects as a CPU producer on the first ANativeWindow_lock.
+        ASSERT_EQ(NO_ERROR, native_window_enable_frame_timestamps(mWindow.get(), true));
+
+        SurfaceComposerClient::Transaction t;
+        t.show(mSurfaceControl);
+        t.setInputWindowInfo(mSurfaceControl, info);
+        t.setLayer(mSurfaceControl, kLayer);
+        t.setPosition(mSurfaceControl, kSurfaceX, kSurfaceY);
+        t.setCrop(mSurfaceControl, Rect(0, 0, kSurfaceSize, kSurfaceSize));
+        auto reportedListener = sp<SynchronousWindowInfosReportedListener>::make();
+        t.addWindowInfosReportedListener(reportedListener);
+        t.apply();
+        reportedListener->wait();
+    }
+
+    void TearDown() override {
+        if (mClientChannel != nullptr) {
+            mInputFlinger->removeInputChannel(mClientChannel->getConnectionToken());
+        }
+        mComposerClient->dispose();
+    }
+
+    // Reads events from the input channel until an ACTION_DOWN arrives. Returns nullptr if none
+    // arrives within the timeout.
+    const MotionEvent* receiveDown() {
+        const nsecs_t deadline = systemTime(SYSTEM_TIME_MONOTONIC) +
+                std::chrono::nanoseconds(kInputTimeout).count();
+        while (systemTime(SYSTEM_TIME_MONOTONIC) < deadline) {
+            mClientChannel->waitForMessage(kInputTimeout);
+            InputEvent* event;
+            uint32_t seq;
+            if (mInputConsumer->consume(&mInputEventFactory, /*consumeBatches=*/true,
+                                        /*frameTime=*/-1, &seq, &event) != OK) {
+                continue;
+            }
+            mInputConsumer->sendFinishedSignal(seq, /*handled=*/true);
+            if (event->getType() != InputEventType::MOTION) {
+                continue;
+            }
+            const MotionEvent* motionEvent = static_cast<const MotionEvent*>(event);
+            if (motionEvent->getActionMasked() == AMOTION_EVENT_ACTION_DOWN) {
+                return motionEvent;
+            }
+        }
+        return nullptr;
+    }
+
+    // Renders and queues a frame in response to the input event with the given id. Returns the
+    // frame number, or nullopt on failure.
+    std::optional<uint64_t> renderFrame(int32_t inputEventId, uint8_t shade) {
+        uint64_t frameNumber;
+        if (native_window_get_next_frame_id(mWindow.get(), &frameNumber) != NO_ERROR) {
+            return std::nullopt;
+        }
+        const ANativeWindowFrameTimelineInfo frameTimelineInfo{
+                .frameNumber = frameNumber,
+                .frameTimelineVsyncId = gui::FrameTimelineInfo::INVALID_VSYNC_ID,
+                .inputEventId = inputEventId,
+                .startTimeNanos = systemTime(SYSTEM_TIME_MONOTONIC),
+                .useForRefreshRateSelection = false,
+        };
+        if (native_window_set_frame_timeline_info(mWindow.get(), frameTimelineInfo) != NO_ERROR) {
+            return std::nullopt;
+        }
+
+        ANativeWindow_Buffer buffer;
+        if (ANativeWindow_lock(mWindow.get(), &buffer, nullptr) != NO_ERROR) {
+            return std::nullopt;
+        }
+        uint8_t* row = static_cast<uint8_t*>(buffer.bits);
+        for (int32_t y = 0; y < buffer.height; y++) {
+            std::fill(row, row + buffer.width * 4, shade);
+            row += buffer.stride * 4;
+        }
+        if (ANativeWindow_unlockAndPost(mWindow.get()) != NO_ERROR) {
+            return std::nullopt;
+        }
+        return frameNumber;
+    }
+
+    struct FrameTimes {
+        nsecs_t latch;
+        nsecs_t compositionStart;
+        nsecs_t present;
+    };
+
+    // Waits for SurfaceFlinger to report when the frame was presented.
+    std::optional<FrameTimes> waitForPresent(uint64_t frameNumber) {
+        const nsecs_t deadline = systemTime(SYSTEM_TIME_MONOTONIC) +
+                std::chrono::nanoseconds(kPresentTimeout).count();
+        while (systemTime(SYSTEM_TIME_MONOTONIC) < deadline) {
+            int64_t latch = -1, firstRefreshStart = -1, present = -1;
+            const status_t status =
+                    native_window_get_frame_timestamps(mWindow.get(), frameNumber, nullptr,
+                                                       nullptr, &latch, &firstRefreshStart,
+                                                       nullptr, nullptr, &present, nullptr,
+                                                       nullptr);
+            if (status == NO_ERROR && present != NATIVE_WINDOW_TIMESTAMP_PENDING) {
+                if (present == NATIVE_WINDOW_TIMESTAMP_INVALID || latch < 0 ||
+                    firstRefreshStart < 0) {
+                    return std::nullopt;
+                }
+                return FrameTimes{latch, firstRefreshStart, present};
+            }
+            std::this_thread::sleep_for(2ms);
+        }
+        return std::nullopt;
+    }
+
+    sp<SurfaceComposerClient> mComposerClient;
+    sp<SurfaceControl> mSurfaceControl;
+    sp<Surface> mSurface;
+    sp<ANativeWindow> mWindow;
+    sp<IInputFlinger> mInputFlinger;
+    std::shared_ptr<InputChannel> mClientChannel;
+    std::unique_ptr<InputConsumer> mInputConsumer;
+    PreallocatedInputEventFactory mInputEventFactory;
+};
+
+TEST_F(InputToPresentLatencyTest, TapToPresent) {
+    // Show the window with a first frame, so that the taps land on a visible window.
+    std::optional<uint64_t> firstFrame = renderFrame(/*inputEventId=*/0, /*shade=*/0);
+    ASSERT_TRUE(firstFrame.has_value());
+    ASSERT_TRUE(waitForPresent(*firstFrame).has_value());
+
+    LatencyReport report;
+    size_t presentedFrames = 0;
+    for (size_t i = 0; i < kSampleCount; i++) {
+        injectTap(kSurfaceX + kSurfaceSize / 2, kSurfaceY + kSurfaceSize / 2);
+
+        const MotionEvent* down = receiveDown();
+        ASSERT_NE(nullptr, down) << "Did not receive the tap " << i;
+        const nsecs_t receiveTime = systemTime(SYSTEM_TIME_MONOTONIC);
+        const nsecs_t eventTime = down->getEventTime();
+        const int32_t inputEventId = down->getId();
+
+        const std::optional<uint64_t> frameNumber =
+                renderFrame(inputEventId, /*shade=*/static_cast<uint8_t>(i * 5));
+        ASSERT_TRUE(frameNumber.has_value());
+        const nsecs_t queueTime = systemTime(SYSTEM_TIME_MONOTONIC);
+
+        const std::optional<FrameTimes> frameTimes = waitForPresent(*frameNumber);
+        if (!frameTimes) {
+            ALOGW("Frame %" PRIu64 " for input event %" PRId32 " was not presented", *frameNumber,
+                  inputEventId);
+            continue;
+        }
+        presentedFrames++;
+
+        report.add(Stage::INPUT_DISPATCH, receiveTime - eventTime);
+        report.add(Stage::APP_RENDER, queueTime - receiveTime);
+        report.add(Stage::LATCH, frameTimes->latch - queueTime);
+        report.add(Stage::COMPOSITION_START, frameTimes->compositionStart - frameTimes->latch);
+        report.add(Stage::PRESENT, frameTimes->present - frameTimes->compositionStart);
+        report.add(Stage::TOTAL, frameTimes->present - eventTime);
+    }
+
+    const std::string dump = report.dump();
+    ALOGI("Input to present latency:\n%s", dump.c_str());
+    // Frames can be dropped now and then, but most of them must make it to the display for the
+    // report to mean anything.
+    EXPECT_GE(presentedFrames, kSampleCount * 9 / 10);
+}
+
+} // namespace android::test
@@ -0,0 +1,189 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <binder/Parcel.h>
+
+#include <gui/LayerState.h>
+
+namespace android::test {
+
+using gui::WindowInfo;
+
+// Sets the fields that layer_state_t only parcels when their change flag is set, and a few of the
+// ones it always parcels, to values other than their defaults.
+layer_state_t makeState(uint64_t what) {
+    layer_state_t state;
+    state.what = what;
+    state.layerId = 42;
+    state.x = 10.f;
+    state.y = 20.f;
+    state.z = 3;
+    state.crop = Rect(1, 2, 3, 4);
+    state.cornerRadius = 5.f;
+
+    WindowInfo* info = state.windowInfoHandle->editInfo();
+    info->name = "LayerStateTest";
+    info->id = 7;
+    info->frame = Rect(0, 0, 100, 200);
+    info->alpha = 0.5f;
+
+    state.hdrMetadata.validTypes = HdrMetadata::CTA861_3;
+    state.hdrMetadata.cta8613 = {.maxContentLightLevel = 1000.f,
+                                 .maxFrameAverageLightLevel = 500.f};
+    state.colorTransform = mat4(2.f);
+    state.metadata.setInt32(gui::METADATA_OWNER_UID, 1234);
+    state.blurRegions.push_back(BlurRegion{.blurRadius = 8,
+                                           .cornerRadiusTL = 1.f,
+                                           .cornerRadiusTR = 2.f,
+                                           .cornerRadiusBL = 3.f,
+                                           .cornerRadiusBR = 4.f,
+                                           .alpha = 0.25f,
+                                           .left = 5,
+                                           .top = 6,
+                                           .right = 7,
+                                           .bottom = 8});
+    state.stretchEffect.width = 100.f;
+    state.stretchEffect.height = 200.f;
+    state.stretchEffect.vectorX = 0.5f;
+    state.edgeExtensionParameters.extendLeft = true;
+    state.trustedPresentationThresholds.minAlpha = 0.75f;
+    state.trustedPresentationThresholds.minFractionRendered = 0.5f;
+    state.trustedPresentationThresholds.stabilityRequirementMs = 100;
+    state.trustedPresentationListener.callbackId = 9;
+    return state;
+}
+
+// Writes the state and reads it back, checking that read() consumes exactly what write() wrote.
+void roundTrip(const layer_state_t& in, layer_state_t* out) {
+    Parcel p;
+    ASSERT_EQ(OK, in.write(p));
+    p.setDataPosition(0);
+    ASSERT_EQ(OK, out->read(p));
+    EXPECT_EQ(p.dataSize(), p.dataPosition());
+}
+
+// Checks the fields gated on a change flag: they match `expected` if the flag is set, and keep
+// their defaults otherwise.
+void expectGatedFields(const layer_state_t& expected, const layer_state_t& actual) {
+    const layer_state_t defaults;
+    const auto& source = [&](uint64_t flag) -> const layer_state_t& {
+        return (actual.what & flag) ? expected : defaults;
+    };
+
+    EXPECT_EQ(*source(layer_state_t::eInputInfoChanged).windowInfoHandle->getInfo(),
+              *actual.windowInfoHandle->getInfo());
+    EXPECT_EQ(source(layer_state_t::eHdrMetadataChanged).hdrMetadata, actual.hdrMetadata);
+    EXPECT_EQ(source(layer_state_t::eColorTransformChanged).colorTransform, actual.colorTransform);
+    EXPECT_EQ(source(layer_state_t::eMetadataChanged).metadata.mMap, actual.metadata.mMap);
+    EXPECT_EQ(source(layer_state_t::eBlurRegionsChanged).blurRegions, actual.blurRegions);
+    EXPECT_EQ(source(layer_state_t::eStretchChanged).stretchEffect, actual.stretchEffect);
+
+    const auto& edge = source(layer_state_t::eEdgeExtensionChanged).edgeExtensionParameters;
+    EXPECT_EQ(edge.extendLeft, actual.edgeExtensionParameters.extendLeft);
+    EXPECT_EQ(edge.extendRight, actual.edgeExtensionParameters.extendRight);
+    EXPECT_EQ(edge.extendTop, actual.edgeExtensionParameters.extendTop);
+    EXPECT_EQ(edge.extendBottom, actual.edgeExtensionParameters.extendBottom);
+
+    const auto& trusted = source(layer_state_t::eTrustedPresentationInfoChanged);
+    EXPECT_EQ(trusted.trustedPresentationThresholds.minAlpha,
+              actual.trustedPresentationThresholds.minAlpha);
+    EXPECT_EQ(trusted.trustedPresentationThresholds.minFractionRendered,
+              actual.trustedPresentationThresholds.minFractionRendered);
+    EXPECT_EQ(trusted.trustedPresentationThresholds.stabilityRequirementMs,
+              actual.trustedPresentationThresholds.stabilityRequirementMs);
+    EXPECT_EQ(trusted.trustedPresentationListener.callbackId,
+              actual.trustedPresentationListener.callbackId);
+}
+
+// Checks some of the fields that are parcelled whatever the change flags.
+void expectUngatedFields(const layer_state_t& expected, const layer_state_t& actual) {
+    EXPECT_EQ(expected.layerId, actual.layerId);
+    EXPECT_EQ(expected.x, actual.x);
+    EXPECT_EQ(expected.y, actual.y);
+    EXPECT_EQ(expected.z, actual.z);
+    EXPECT_EQ(expected.crop, actual.crop);
+    EXPECT_EQ(expected.cornerRadius, actual.cornerRadius);
+}
+
+TEST(LayerState, ParcellingEachChangeFlag) {
+    for (uint64_t bit = 0; bit < 64; bit++) {
+        SCOPED_TRACE(bit);
+        const layer_state_t state = makeState(uint64_t{1} << bit);
+
+        layer_state_t read;
+        ASSERT_NO_FATAL_FAILURE(roundTrip(state, &read));
+        EXPECT_EQ(state.what, read.what);
+        expectUngatedFields(state, read);
+        expectGatedFields(state, read);
+    }
+}
+
+TEST(LayerState, ParcellingAllChangeFlags) {
+    const layer_state_t state = makeState(~uint64_t{0});
+
+    layer_state_t read;
+    ASSERT_NO_FATAL_FAILURE(roundTrip(state, &read));
+    EXPECT_EQ(state.what, read.what);
+    expectUngatedFields(state, read);
+    expectGatedFields(state, read);
+}
+
+TEST(LayerState, ParcellingSkipsUnchangedFields) {
+    Parcel unset;
+    ASSERT_EQ(OK, layer_state_t().write(unset));
+
+    Parcel set;
+    ASSERT_EQ(OK, makeState(0).write(set));
+
+    // The gated fields take no space, and the ungated ones are fixed size.
+    EXPECT_EQ(unset.dataSize(), set.dataSize());
+}
+
+TEST(LayerState, ParcellingMergedState) {
+    layer_state_t state = makeState(layer_state_t::ePositionChanged |
+                                    layer_state_t::eInputInfoChanged |
+                                    layer_state_t::eColorTransformChanged);
+
+    // The other state carries different gated fields, and values of its own for the flags the
+    // first one has.
+    layer_state_t other = makeState(layer_state_t::eColorTransformChanged |
+                                    layer_state_t::eMetadataChanged |
+                                    layer_state_t::eBlurRegionsChanged |
+                                    layer_state_t::eTrustedPresentationInfoChanged);
+    other.colorTransform = mat4(3.f);
+    other.metadata.setInt32(gui::METADATA_WINDOW_TYPE, 2);
+    other.trustedPresentationListener.callbackId = 11;
+
+    state.merge(other);
+
+    layer_state_t read;
+    ASSERT_NO_FATAL_FAILURE(roundTrip(state, &read));
+    EXPECT_EQ(layer_state_t::ePositionChanged | layer_state_t::eInputInfoChanged |
+                      layer_state_t::eColorTransformChanged | layer_state_t::eMetadataChanged |
+                      layer_state_t::eBlurRegionsChanged |
+                      layer_state_t::eTrustedPresentationInfoChanged,
+              read.what);
+    expectUngatedFields(state, read);
+    expectGatedFields(state, read);
+    EXPECT_EQ(mat4(3.f), read.colorTransform);
+    EXPECT_EQ(1234, read.metadata.getInt32(gui::METADATA_OWNER_UID, 0));
+    EXPECT_EQ(2, read.metadata.getInt32(gui::METADATA_WINDOW_TYPE, 0));
+    EXPECT_EQ(11, read.trustedPresentationListener.callbackId);
+}
+
+} // namespace android::test
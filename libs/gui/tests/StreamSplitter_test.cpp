@@ -99,8 +99,9 @@ TEST_F(StreamSplitterTest, OneInputOneOutput) {
             EGL_NO_DISPLAY, EGL_NO_SYNC_KHR, Fence::NO_FENCE));
 
     // This should succeed even with allocation disabled since it will have
-    // received the buffer back from the output BufferQueue
-    ASSERT_EQ(IGraphicBufferProducer::BUFFER_NEEDS_REALLOCATION,
+    // received the buffer back from the output BufferQueue. The buffer is back
+    // in its slot, so it doesn't need to be requested again.
+    ASSERT_EQ(OK,
               inputProducer->dequeueBuffer(&slot, &fence, 0, 0, 0, GRALLOC_USAGE_SW_WRITE_OFTEN,
                                            nullptr, nullptr));
 }
@@ -174,8 +175,9 @@ TEST_F(StreamSplitterTest, OneInputMultipleOutputs) {
     }
 
     // This should succeed even with allocation disabled since it will have
-    // received the buffer back from the output BufferQueues
-    ASSERT_EQ(IGraphicBufferProducer::BUFFER_NEEDS_REALLOCATION,
+    // received the buffer back from the output BufferQueues. The buffer is back
+    // in its slot, so it doesn't need to be requested again.
+    ASSERT_EQ(OK,
               inputProducer->dequeueBuffer(&slot, &fence, 0, 0, 0, GRALLOC_USAGE_SW_WRITE_OFTEN,
                                            nullptr, nullptr));
 }
@@ -533,6 +533,31 @@ TEST_F(SurfaceTextureGLTest, DisconnectClearsCurrentTexture) {
             NATIVE_WINDOW_API_CPU));
 }
 
+TEST_F(SurfaceTextureGLTest, DiscardFreeBuffersReleasesCachedEglImages) {
+    ASSERT_EQ(OK, native_window_api_connect(mANW.get(), NATIVE_WINDOW_API_CPU));
+
+    ANativeWindowBuffer* anb;
+    ASSERT_EQ(OK, native_window_dequeue_buffer_and_wait(mANW.get(), &anb));
+    wp<GraphicBuffer> firstBuffer = GraphicBuffer::from(anb);
+    ASSERT_EQ(OK, mANW->queueBuffer(mANW.get(), anb, -1));
+    mFW->waitForFrame();
+    ASSERT_EQ(OK, mST->updateTexImage());
+
+    // Latching a second buffer releases the first one to the BufferQueue.
+    ASSERT_EQ(OK, native_window_dequeue_buffer_and_wait(mANW.get(), &anb));
+    ASSERT_EQ(OK, mANW->queueBuffer(mANW.get(), anb, -1));
+    mFW->waitForFrame();
+    ASSERT_EQ(OK, mST->updateTexImage());
+
+    // Disconnecting frees every slot. The GLConsumer keeps the EGLImage of the
+    // first buffer, and with it the buffer, in case the buffer comes back.
+    ASSERT_EQ(OK, native_window_api_disconnect(mANW.get(), NATIVE_WINDOW_API_CPU));
+    EXPECT_NE(nullptr, firstBuffer.promote());
+
+    ASSERT_EQ(OK, mST->discardFreeBuffers());
+    EXPECT_EQ(nullptr, firstBuffer.promote());
+}
+
 TEST_F(SurfaceTextureGLTest, ScaleToWindowMode) {
     ASSERT_EQ(OK, native_window_set_scaling_mode(mANW.get(),
         NATIVE_WINDOW_SCALING_MODE_SCALE_TO_WINDOW));
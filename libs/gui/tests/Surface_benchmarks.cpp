@@ -0,0 +1,183 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <gui/BufferItem.h>
+#include <gui/BufferQueue.h>
+#include <gui/Surface.h>
+#include <system/window.h>
+#include <ui/GraphicBuffer.h>
+
+#include <vector>
+
+#include "MockConsumer.h"
+
+namespace android {
+
+namespace {
+
+constexpr int kBufferCount = 3;
+constexpr uint32_t kWidth = 1080;
+constexpr uint32_t kHeight = 2400;
+
+// A Surface connected to a BufferQueue in the same process, as BLASTBufferQueue sets it up. The
+// producer is the BufferQueueProducer itself rather than a binder proxy, so Surface calls into it
+// directly and these benchmarks measure the CPU cost of the Surface and BufferQueue bookkeeping
+// that every frame of an app pays.
+class LocalSurface {
+public:
+    LocalSurface() {
+        sp<IGraphicBufferProducer> producer;
+        BufferQueue::createBufferQueue(&producer, &mConsumer);
+        mConsumer->consumerConnect(sp<MockConsumer>::make(), false);
+        mConsumer->setConsumerName(String8("SurfaceBenchmark"));
+        mConsumer->setMaxAcquiredBufferCount(1);
+
+        mSurface = sp<Surface>::make(producer);
+        mWindow = mSurface;
+        native_window_api_connect(mWindow.get(), NATIVE_WINDOW_API_CPU);
+        native_window_set_buffer_count(mWindow.get(), kBufferCount);
+        native_window_set_buffers_dimensions(mWindow.get(), kWidth, kHeight);
+        native_window_set_buffers_format(mWindow.get(), PIXEL_FORMAT_RGBA_8888);
+        native_window_set_usage(mWindow.get(), GRALLOC_USAGE_SW_WRITE_OFTEN);
+    }
+
+    ~LocalSurface() { native_window_api_disconnect(mWindow.get(), NATIVE_WINDOW_API_CPU); }
+
+    ANativeWindow* window() const { return mWindow.get(); }
+
+    // Acquires and releases the buffer that was just queued, as the consumer would.
+    bool consume() {
+        BufferItem item;
+        if (mConsumer->acquireBuffer(&item, 0) != NO_ERROR) return false;
+        return mConsumer->releaseBuffer(item.mSlot, item.mFrameNumber, Fence::NO_FENCE) ==
+                NO_ERROR;
+    }
+
+private:
+    sp<IGraphicBufferConsumer> mConsumer;
+    sp<Surface> mSurface;
+    sp<ANativeWindow> mWindow;
+};
+
+// Dequeues and cancels a buffer. Once every slot has been allocated, this is the cost of
+// Surface::dequeueBuffer alone.
+void dequeueCancel(benchmark::State& state) {
+    LocalSurface surface;
+    ANativeWindow* window = surface.window();
+
+    for (auto _ : state) {
+        ANativeWindowBuffer* buffer;
+        int fenceFd;
+        if (window->dequeueBuffer(window, &buffer, &fenceFd) != NO_ERROR) {
+            state.SkipWithError("dequeueBuffer failed");
+            return;
+        }
+        window->cancelBuffer(window, buffer, fenceFd);
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(dequeueCancel);
+
+// Dequeues and queues a buffer, and lets the consumer acquire and release it. This is the round
+// trip of a frame without rendering or composition.
+void dequeueQueue(benchmark::State& state) {
+    LocalSurface surface;
+    ANativeWindow* window = surface.window();
+
+    for (auto _ : state) {
+        ANativeWindowBuffer* buffer;
+        int fenceFd;
+        if (window->dequeueBuffer(window, &buffer, &fenceFd) != NO_ERROR) {
+            state.SkipWithError("dequeueBuffer failed");
+            return;
+        }
+        if (window->queueBuffer(window, buffer, fenceFd) != NO_ERROR || !surface.consume()) {
+            state.SkipWithError("queueBuffer failed");
+            return;
+        }
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(dequeueQueue);
+
+// Dequeues and queues state.range(0) buffers through the BufferQueueProducer, then acquires and
+// releases each of them through the BufferQueueConsumer. Without Surface in the way, this is the
+// cost of the BufferQueue slot bookkeeping around each round trip.
+void bufferQueueRoundTrip(benchmark::State& state) {
+    const int bufferCount = static_cast<int>(state.range(0));
+
+    sp<IGraphicBufferProducer> producer;
+    sp<IGraphicBufferConsumer> consumer;
+    BufferQueue::createBufferQueue(&producer, &consumer);
+    consumer->consumerConnect(sp<MockConsumer>::make(), false);
+    consumer->setConsumerName(String8("BufferQueueBenchmark"));
+    consumer->setMaxAcquiredBufferCount(1);
+
+    IGraphicBufferProducer::QueueBufferOutput output;
+    producer->connect(nullptr, NATIVE_WINDOW_API_CPU, false, &output);
+    producer->setMaxDequeuedBufferCount(bufferCount);
+
+    const IGraphicBufferProducer::QueueBufferInput input(0, false, HAL_DATASPACE_UNKNOWN,
+                                                         Rect(kWidth, kHeight),
+                                                         NATIVE_WINDOW_SCALING_MODE_FREEZE, 0,
+                                                         Fence::NO_FENCE);
+    std::vector<int> slots(static_cast<size_t>(bufferCount));
+
+    for (auto _ : state) {
+        for (int& slot : slots) {
+            sp<Fence> fence;
+            const status_t status =
+                    producer->dequeueBuffer(&slot, &fence, kWidth, kHeight, PIXEL_FORMAT_RGBA_8888,
+                                            GRALLOC_USAGE_SW_WRITE_OFTEN, nullptr, nullptr);
+            if (status < NO_ERROR) {
+                state.SkipWithError("dequeueBuffer failed");
+                return;
+            }
+            if (status & IGraphicBufferProducer::BUFFER_NEEDS_REALLOCATION) {
+                sp<GraphicBuffer> buffer;
+                producer->requestBuffer(slot, &buffer);
+            }
+        }
+        for (const int slot : slots) {
+            if (producer->queueBuffer(slot, input, &output) != NO_ERROR) {
+                state.SkipWithError("queueBuffer failed");
+                return;
+            }
+        }
+        for (int i = 0; i < bufferCount; i++) {
+            BufferItem item;
+            if (consumer->acquireBuffer(&item, 0) != NO_ERROR ||
+                consumer->releaseBuffer(item.mSlot, item.mFrameNumber, Fence::NO_FENCE) !=
+                        NO_ERROR) {
+                state.SkipWithError("acquireBuffer failed");
+                return;
+            }
+        }
+    }
+
+    producer->disconnect(NATIVE_WINDOW_API_CPU);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * bufferCount);
+}
+BENCHMARK(bufferQueueRoundTrip)->Arg(1)->Arg(3)->Arg(8);
+
+} // namespace
+} // namespace android
+
+BENCHMARK_MAIN();
@@ -2159,6 +2159,47 @@ TEST_F(SurfaceTest, DefaultMaxBufferCountSetAndUpdated) {
     EXPECT_EQ(BufferQueueDefs::NUM_BUFFER_SLOTS, count);
 }
 
+// Records the operations that reach perform(), the way a subclass that handles some of them itself
+// would see them.
+class PerformRecordingSurface : public Surface {
+public:
+    explicit PerformRecordingSurface(const sp<IGraphicBufferProducer>& producer)
+          : Surface(producer) {
+        disablePerformTable();
+    }
+
+    std::vector<int> operations;
+
+protected:
+    int perform(int operation, va_list args) override {
+        operations.push_back(operation);
+        return Surface::perform(operation, args);
+    }
+};
+
+TEST_F(SurfaceTest, SubclassWithoutPerformTableSeesEveryOperation) {
+    sp<IGraphicBufferProducer> producer;
+    sp<IGraphicBufferConsumer> consumer;
+    BufferQueue::createBufferQueue(&producer, &consumer);
+
+    sp<PerformRecordingSurface> surface = sp<PerformRecordingSurface>::make(producer);
+    ANativeWindow* window = surface.get();
+    EXPECT_EQ(nullptr, native_window_get_perform_table(window));
+
+    const android_native_rect_t crop = {.left = 0, .top = 0, .right = 1, .bottom = 1};
+    EXPECT_EQ(NO_ERROR, native_window_set_buffers_timestamp(window, 1234));
+    EXPECT_EQ(NO_ERROR, native_window_set_crop(window, &crop));
+    EXPECT_EQ(NO_ERROR, native_window_set_buffers_transform(window, 0));
+    EXPECT_EQ(NO_ERROR, native_window_set_buffers_data_space(window, HAL_DATASPACE_SRGB));
+    EXPECT_EQ(NO_ERROR, native_window_set_surface_damage(window, &crop, 1));
+
+    EXPECT_EQ((std::vector<int>{NATIVE_WINDOW_SET_BUFFERS_TIMESTAMP, NATIVE_WINDOW_SET_CROP,
+                                NATIVE_WINDOW_SET_BUFFERS_TRANSFORM,
+                                NATIVE_WINDOW_SET_BUFFERS_DATASPACE,
+                                NATIVE_WINDOW_SET_SURFACE_DAMAGE}),
+              surface->operations);
+}
+
 TEST_F(SurfaceTest, BatchOperations) {
     const int BUFFER_COUNT = 16;
     const int BATCH_SIZE = 8;
@@ -56,5 +56,16 @@ TEST(ParcelableVsyncEventData, Parcelling) {
     }
 }
 
+TEST(VsyncEventData, TimeUntilPreferredDeadline) {
+    VsyncEventData data;
+    data.preferredFrameTimelineIndex = 1;
+    data.frameTimelines[0] = FrameTimeline{1, 100, 200};
+    data.frameTimelines[1] = FrameTimeline{2, 300, 400};
+    data.frameTimelinesLength = 2;
+
+    EXPECT_EQ(250, data.timeUntilPreferredDeadline(50));
+    EXPECT_EQ(-50, data.timeUntilPreferredDeadline(350));
+}
+
 } // namespace test
 } // namespace android
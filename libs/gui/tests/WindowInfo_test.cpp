@@ -20,6 +20,7 @@
 #include <binder/Parcel.h>
 
 #include <gui/WindowInfo.h>
+#include <gui/WindowInfosUpdate.h>
 
 using std::chrono_literals::operator""s;
 
@@ -28,6 +29,7 @@ namespace android {
 using gui::InputApplicationInfo;
 using gui::TouchOcclusionMode;
 using gui::WindowInfo;
+using gui::WindowInfosUpdate;
 using ui::Size;
 
 namespace test {
@@ -116,5 +118,52 @@ TEST(InputApplicationInfo, Parcelling) {
     ASSERT_EQ(i, i2);
 }
 
+static WindowInfo makeWindow(int32_t id) {
+    WindowInfo info;
+    info.id = id;
+    info.name = "Window " + std::to_string(id);
+    info.alpha = 1.0f;
+    return info;
+}
+
+TEST(WindowInfosUpdate, DeltaOnlyCarriesChangedWindows) {
+    std::vector<WindowInfo> previous{makeWindow(1), makeWindow(2), makeWindow(3)};
+    WindowInfosUpdate update{{makeWindow(3), makeWindow(2), makeWindow(4)}, {}, 2, 0};
+    update.windowInfos[1].alpha = 0.5f;
+
+    auto delta = update.makeDelta(previous);
+    ASSERT_TRUE(delta);
+    EXPECT_TRUE(delta->isDelta);
+    EXPECT_EQ(std::vector<int32_t>({3, 2, 4}), delta->windowIds);
+    ASSERT_EQ(2u, delta->windowInfos.size());
+    EXPECT_EQ(2, delta->windowInfos[0].id);
+    EXPECT_EQ(4, delta->windowInfos[1].id);
+
+    Parcel p;
+    ASSERT_EQ(OK, delta->writeToParcel(&p));
+    p.setDataPosition(0);
+    WindowInfosUpdate received;
+    ASSERT_EQ(OK, received.readFromParcel(&p));
+    ASSERT_EQ(OK, received.applyDelta(previous));
+    EXPECT_FALSE(received.isDelta);
+    ASSERT_EQ(update.windowInfos.size(), received.windowInfos.size());
+    for (size_t i = 0; i < update.windowInfos.size(); i++) {
+        EXPECT_EQ(update.windowInfos[i], received.windowInfos[i]);
+        EXPECT_EQ(update.windowInfos[i].alpha, received.windowInfos[i].alpha);
+    }
+}
+
+TEST(WindowInfosUpdate, NoDeltaForDuplicateIds) {
+    WindowInfosUpdate update{{makeWindow(1), makeWindow(1)}, {}, 2, 0};
+    EXPECT_FALSE(update.makeDelta({makeWindow(1)}));
+}
+
+TEST(WindowInfosUpdate, DeltaWithUnknownWindowIsRejected) {
+    WindowInfosUpdate update{{makeWindow(1), makeWindow(2)}, {}, 2, 0};
+    auto delta = update.makeDelta({makeWindow(1), makeWindow(2)});
+    ASSERT_TRUE(delta);
+    EXPECT_EQ(BAD_VALUE, delta->applyDelta({makeWindow(1)}));
+}
+
 } // namespace test
 } // namespace android
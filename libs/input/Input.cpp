@@ -507,8 +507,9 @@ status_t PointerCoords::readFromParcel(Parcel* parcel) {
         return BAD_VALUE;
     }
 
-    for (uint32_t i = 0; i < count; i++) {
-        values[i] = parcel->readFloat();
+    // The values of the axes that are set are packed at the front of the array.
+    if (parcel->read(values, count * sizeof(float)) != OK) {
+        return BAD_VALUE;
     }
 
     isResampled = parcel->readBool();
@@ -518,9 +519,12 @@ status_t PointerCoords::readFromParcel(Parcel* parcel) {
 status_t PointerCoords::writeToParcel(Parcel* parcel) const {
     parcel->writeInt64(bits);
 
+    // The values of the axes that are set are packed at the front of the array, so they are
+    // written in one go. This is the same layout as writing them one float at a time.
     uint32_t count = BitSet64::count(bits);
-    for (uint32_t i = 0; i < count; i++) {
-        parcel->writeFloat(values[i]);
+    status_t status = parcel->write(values, count * sizeof(float));
+    if (status) {
+        return status;
     }
 
     parcel->writeBool(isResampled);
@@ -930,6 +934,16 @@ status_t MotionEvent::writeToParcel(Parcel* parcel) const {
         parcel->writeInt32(static_cast<int32_t>(properties.toolType));
     }
 
+    // Reserve room for the samples up front, so that an event with a long history does not make
+    // the parcel grow several times while its samples are written.
+    size_t samplesSize = sampleCount * sizeof(int64_t);
+    for (const PointerCoords& coords : mSamplePointerCoords) {
+        // The axis bits, the values of the axes that are set, and isResampled.
+        samplesSize += sizeof(int64_t) + BitSet64::count(coords.bits) * sizeof(float) +
+                sizeof(int32_t);
+    }
+    parcel->setDataCapacity(parcel->dataPosition() + samplesSize);
+
     const PointerCoords* pc = mSamplePointerCoords.data();
     for (size_t h = 0; h < sampleCount; h++) {
         parcel->writeInt64(mSampleEventTimes[h]);
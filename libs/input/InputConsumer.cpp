@@ -710,12 +710,14 @@ status_t InputConsumer::sendFinishedSignal(uint32_t seq, bool handled) {
         return BAD_VALUE;
     }
 
-    // Send finished signals for the batch sequence chain first.
+    // Send finished signals for the batch sequence chain first, followed by the finished signal
+    // for the last message in the batch. They are written to the channel together, so finishing a
+    // batch of samples costs a single write.
     size_t seqChainCount = mSeqChains.size();
+    uint32_t chainSeqs[seqChainCount + 1];
+    size_t chainIndex = 0;
     if (seqChainCount) {
         uint32_t currentSeq = seq;
-        uint32_t chainSeqs[seqChainCount];
-        size_t chainIndex = 0;
         for (size_t i = seqChainCount; i > 0;) {
             i--;
             const SeqChain& seqChain = mSeqChains[i];
@@ -725,27 +727,36 @@ status_t InputConsumer::sendFinishedSignal(uint32_t seq, bool handled) {
                 mSeqChains.erase(mSeqChains.begin() + i);
             }
         }
-        status_t status = OK;
-        while (!status && chainIndex > 0) {
+    }
+
+    mFinishedMessages.clear();
+    for (size_t i = chainIndex; i > 0;) {
+        i--;
+        mFinishedMessages.push_back(createFinishedMessage(chainSeqs[i], handled));
+    }
+    mFinishedMessages.push_back(createFinishedMessage(seq, handled));
+
+    size_t sentCount;
+    const status_t status =
+            mChannel->sendMessages(mFinishedMessages.data(), mFinishedMessages.size(), &sentCount);
+    for (size_t i = 0; i < sentCount; i++) {
+        onFinishedSignalSent(mFinishedMessages[i].header.seq);
+    }
+
+    if (status && sentCount < chainIndex) {
+        // An error occurred so at least one signal of the chain was not sent, reconstruct the
+        // chain from the first signal which wasn't.
+        chainIndex -= sentCount + 1;
+        for (;;) {
+            SeqChain seqChain;
+            seqChain.seq = chainIndex != 0 ? chainSeqs[chainIndex - 1] : seq;
+            seqChain.chain = chainSeqs[chainIndex];
+            mSeqChains.push_back(seqChain);
+            if (!chainIndex) break;
             chainIndex--;
-            status = sendUnchainedFinishedSignal(chainSeqs[chainIndex], handled);
-        }
-        if (status) {
-            // An error occurred so at least one signal was not sent, reconstruct the chain.
-            for (;;) {
-                SeqChain seqChain;
-                seqChain.seq = chainIndex != 0 ? chainSeqs[chainIndex - 1] : seq;
-                seqChain.chain = chainSeqs[chainIndex];
-                mSeqChains.push_back(seqChain);
-                if (!chainIndex) break;
-                chainIndex--;
-            }
-            return status;
         }
     }
-
-    // Send finished signal for the last message in the batch.
-    return sendUnchainedFinishedSignal(seq, handled);
+    return status;
 }
 
 status_t InputConsumer::sendTimeline(int32_t inputEventId,
@@ -778,23 +789,23 @@ void InputConsumer::popConsumeTime(uint32_t seq) {
     mConsumeTimes.erase(seq);
 }
 
-status_t InputConsumer::sendUnchainedFinishedSignal(uint32_t seq, bool handled) {
+InputMessage InputConsumer::createFinishedMessage(uint32_t seq, bool handled) const {
     InputMessage msg;
     msg.header.type = InputMessage::Type::FINISHED;
     msg.header.seq = seq;
     msg.body.finished.handled = handled;
     msg.body.finished.consumeTime = getConsumeTime(seq);
-    status_t result = mChannel->sendMessage(&msg);
-    if (result == OK) {
-        // Remove the consume time if the socket write succeeded. We will not need to ack this
-        // message anymore. If the socket write did not succeed, we will try again and will still
-        // need consume time.
-        popConsumeTime(seq);
+    return msg;
+}
 
-        // Trace the event processing timeline - event was just finished
-        ATRACE_ASYNC_END(mProcessingTraceTag.c_str(), /*cookie=*/seq);
-    }
-    return result;
+void InputConsumer::onFinishedSignalSent(uint32_t seq) {
+    // Remove the consume time once the socket write succeeded. We will not need to ack this
+    // message anymore. If the socket write did not succeed, we will try again and will still
+    // need consume time.
+    popConsumeTime(seq);
+
+    // Trace the event processing timeline - event was just finished
+    ATRACE_ASYNC_END(mProcessingTraceTag.c_str(), /*cookie=*/seq);
 }
 
 bool InputConsumer::hasPendingBatch() const {
@@ -15,6 +15,9 @@
 #include <sys/types.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <array>
+
 #include <android-base/logging.h>
 #include <android-base/properties.h>
 #include <android-base/stringprintf.h>
@@ -94,6 +97,16 @@ android::base::unique_fd dupChannelFd(int fd) {
 // behind processing touches.
 constexpr size_t SOCKET_BUFFER_SIZE = 32 * 1024;
 
+status_t sendErrorToStatus(int error) {
+    if (error == EAGAIN || error == EWOULDBLOCK) {
+        return WOULD_BLOCK;
+    }
+    if (error == EPIPE || error == ENOTCONN || error == ECONNREFUSED || error == ECONNRESET) {
+        return DEAD_OBJECT;
+    }
+    return -error;
+}
+
 /**
  * Crash if the events that are getting sent to the InputPublisher are inconsistent.
  * Enable this via "adb shell setprop log.tag.InputTransportVerifyEvents DEBUG"
@@ -400,13 +413,7 @@ status_t InputChannel::sendMessage(const InputMessage* msg) {
         int error = errno;
         ALOGD_IF(DEBUG_CHANNEL_MESSAGES, "channel '%s' ~ error sending message of type %s, %s",
                  name.c_str(), ftl::enum_string(msg->header.type).c_str(), strerror(error));
-        if (error == EAGAIN || error == EWOULDBLOCK) {
-            return WOULD_BLOCK;
-        }
-        if (error == EPIPE || error == ENOTCONN || error == ECONNREFUSED || error == ECONNRESET) {
-            return DEAD_OBJECT;
-        }
-        return -error;
+        return sendErrorToStatus(error);
     }
 
     if (size_t(nWrite) != msgLength) {
@@ -422,6 +429,57 @@ status_t InputChannel::sendMessage(const InputMessage* msg) {
     return OK;
 }
 
+status_t InputChannel::sendMessages(InputMessage* msgs, size_t count, size_t* outSentCount) {
+    ATRACE_NAME_IF(ATRACE_ENABLED(),
+                   StringPrintf("sendMessages(inputChannel=%s, count=%zu)", name.c_str(), count));
+    if (count == 1) {
+        const status_t status = sendMessage(msgs);
+        *outSentCount = status == OK ? 1 : 0;
+        return status;
+    }
+    *outSentCount = 0;
+    while (*outSentCount < count) {
+        const size_t batchSize = std::min(count - *outSentCount, MAX_MESSAGES_PER_WRITE);
+        InputMessage* batch = msgs + *outSentCount;
+        std::array<iovec, MAX_MESSAGES_PER_WRITE> iovecs;
+        std::array<mmsghdr, MAX_MESSAGES_PER_WRITE> headers{};
+        for (size_t i = 0; i < batchSize; i++) {
+            InputMessage cleanMsg;
+            batch[i].getSanitizedCopy(&cleanMsg);
+            batch[i] = cleanMsg;
+            iovecs[i] = {.iov_base = &batch[i], .iov_len = batch[i].size()};
+            headers[i].msg_hdr.msg_iov = &iovecs[i];
+            headers[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        int nSent;
+        do {
+            nSent = ::sendmmsg(getFd(), headers.data(), batchSize, MSG_DONTWAIT | MSG_NOSIGNAL);
+        } while (nSent == -1 && errno == EINTR);
+
+        if (nSent < 0) {
+            int error = errno;
+            ALOGD_IF(DEBUG_CHANNEL_MESSAGES, "channel '%s' ~ error sending message of type %s, %s",
+                     name.c_str(), ftl::enum_string(batch[0].header.type).c_str(),
+                     strerror(error));
+            return sendErrorToStatus(error);
+        }
+        for (int i = 0; i < nSent; i++) {
+            if (headers[i].msg_len != iovecs[i].iov_len) {
+                ALOGD_IF(DEBUG_CHANNEL_MESSAGES,
+                         "channel '%s' ~ error sending message type %s, send was incomplete",
+                         name.c_str(), ftl::enum_string(batch[i].header.type).c_str());
+                return DEAD_OBJECT;
+            }
+            (*outSentCount)++;
+        }
+        // If the channel filled up part way, the next write returns the error.
+    }
+
+    ALOGD_IF(DEBUG_CHANNEL_MESSAGES, "channel '%s' ~ sent %zu messages", name.c_str(), count);
+    return OK;
+}
+
 android::base::Result<InputMessage> InputChannel::receiveMessage() {
     ssize_t nRead;
     InputMessage msg;
@@ -579,19 +637,32 @@ status_t InputPublisher::publishMotionEvent(
         const ui::Transform& rawTransform, nsecs_t downTime, nsecs_t eventTime,
         uint32_t pointerCount, const PointerProperties* pointerProperties,
         const PointerCoords* pointerCoords) {
+    InputMessage msg;
+    status_t status =
+            prepareMotionEvent(msg, seq, eventId, deviceId, source, displayId, std::move(hmac),
+                               action, actionButton, flags, edgeFlags, metaState, buttonState,
+                               classification, transform, xPrecision, yPrecision,
+                               xCursorPosition, yCursorPosition, rawTransform, downTime,
+                               eventTime, pointerCount, pointerProperties, pointerCoords);
+    if (status != OK) {
+        return status;
+    }
+    return mChannel->sendMessage(&msg);
+}
+
+status_t InputPublisher::prepareMotionEvent(
+        InputMessage& msg, uint32_t seq, int32_t eventId, int32_t deviceId, int32_t source,
+        ui::LogicalDisplayId displayId, std::array<uint8_t, 32> hmac, int32_t action,
+        int32_t actionButton, int32_t flags, int32_t edgeFlags, int32_t metaState,
+        int32_t buttonState, MotionClassification classification, const ui::Transform& transform,
+        float xPrecision, float yPrecision, float xCursorPosition, float yCursorPosition,
+        const ui::Transform& rawTransform, nsecs_t downTime, nsecs_t eventTime,
+        uint32_t pointerCount, const PointerProperties* pointerProperties,
+        const PointerCoords* pointerCoords) {
     ATRACE_NAME_IF(ATRACE_ENABLED(),
                    StringPrintf("publishMotionEvent(inputChannel=%s, action=%s)",
                                 mChannel->getName().c_str(),
                                 MotionEvent::actionToString(action).c_str()));
-    if (verifyEvents()) {
-        Result<void> result =
-                mInputVerifier.processMovement(deviceId, source, action, pointerCount,
-                                               pointerProperties, pointerCoords, flags);
-        if (!result.ok()) {
-            LOG(ERROR) << "Bad stream: " << result.error();
-            return BAD_VALUE;
-        }
-    }
     if (debugTransportPublisher()) {
         std::string transformString;
         transform.dump(transformString, "transform", "        ");
@@ -619,7 +690,6 @@ status_t InputPublisher::publishMotionEvent(
         return BAD_VALUE;
     }
 
-    InputMessage msg;
     msg.header.type = InputMessage::Type::MOTION;
     msg.header.seq = seq;
     msg.body.motion.eventId = eventId;
@@ -657,8 +727,50 @@ status_t InputPublisher::publishMotionEvent(
         msg.body.motion.pointers[i].properties = pointerProperties[i];
         msg.body.motion.pointers[i].coords = pointerCoords[i];
     }
+    return OK;
+}
 
-    return mChannel->sendMessage(&msg);
+status_t InputPublisher::publishPreparedEvents(InputMessage* msgs, size_t count,
+                                               size_t* outPublishedCount) {
+    if (!verifyEvents()) {
+        return mChannel->sendMessages(msgs, count, outPublishedCount);
+    }
+    if (count == 1) {
+        *outPublishedCount = 0;
+        if (status_t status = verifyMotionMessage(msgs[0]); status != OK) {
+            return status;
+        }
+        return mChannel->sendMessages(msgs, count, outPublishedCount);
+    }
+    // The verifier can't take back an event, and it isn't known up front how many of the events
+    // fit in the channel, so the events of a batch are verified once they have been sent.
+    const status_t status = mChannel->sendMessages(msgs, count, outPublishedCount);
+    for (size_t i = 0; i < *outPublishedCount; i++) {
+        if (status_t verifyStatus = verifyMotionMessage(msgs[i]); verifyStatus != OK) {
+            return verifyStatus;
+        }
+    }
+    return status;
+}
+
+status_t InputPublisher::verifyMotionMessage(const InputMessage& msg) {
+    const auto& motion = msg.body.motion;
+    const uint32_t pointerCount = std::min<uint32_t>(motion.pointerCount, MAX_POINTERS);
+    PointerProperties pointerProperties[MAX_POINTERS];
+    PointerCoords pointerCoords[MAX_POINTERS];
+    for (uint32_t i = 0; i < pointerCount; i++) {
+        pointerProperties[i] = motion.pointers[i].properties;
+        pointerCoords[i] = motion.pointers[i].coords;
+    }
+    Result<void> result =
+            mInputVerifier.processMovement(motion.deviceId, motion.source, motion.action,
+                                           pointerCount, pointerProperties, pointerCoords,
+                                           motion.flags);
+    if (!result.ok()) {
+        LOG(ERROR) << "Bad stream: " << result.error();
+        return BAD_VALUE;
+    }
+    return OK;
 }
 
 status_t InputPublisher::publishFocusEvent(uint32_t seq, int32_t eventId, bool hasFocus) {
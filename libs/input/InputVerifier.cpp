@@ -37,11 +37,21 @@ Result<void> InputVerifier::processMovement(DeviceId deviceId, int32_t source, i
                                             uint32_t pointerCount,
                                             const PointerProperties* pointerProperties,
                                             const PointerCoords* pointerCoords, int32_t flags) {
-    std::vector<RustPointerProperties> rpp;
+    if (!isFromSource(source, AINPUT_SOURCE_CLASS_POINTER)) {
+        // The rust verifier skips non-pointer sources, so don't cross the FFI boundary for them.
+        return {};
+    }
+    if (pointerCount > MAX_POINTERS) {
+        return Error() << "Invalid event: " << pointerCount << " pointers exceeds the maximum of "
+                       << MAX_POINTERS;
+    }
+    // The pointer ids are passed to rust as a borrowed slice of this stack buffer, so verifying an
+    // event does not allocate.
+    std::array<RustPointerProperties, MAX_POINTERS> rpp;
     for (size_t i = 0; i < pointerCount; i++) {
-        rpp.emplace_back(RustPointerProperties{.id = pointerProperties[i].id});
+        rpp[i] = RustPointerProperties{.id = pointerProperties[i].id};
     }
-    rust::Slice<const RustPointerProperties> properties{rpp.data(), rpp.size()};
+    rust::Slice<const RustPointerProperties> properties{rpp.data(), pointerCount};
     rust::String errorMessage =
             android::input::verifier::process_movement(*mVerifier, deviceId, source, action,
                                                        properties, static_cast<uint32_t>(flags));
@@ -17,6 +17,7 @@
 #define LOG_TAG "KeyLayoutMap"
 
 #include <android-base/logging.h>
+#include <android-base/thread_annotations.h>
 #include <android/keycodes.h>
 #include <ftl/enum.h>
 #include <input/InputEventLabels.h>
@@ -30,7 +31,9 @@
 #include <vintf/KernelConfigs.h>
 #endif
 
+#include <sys/stat.h>
 #include <cstdlib>
+#include <mutex>
 #include <string_view>
 #include <unordered_map>
 
@@ -125,6 +128,56 @@ bool kernelConfigsArePresent(const std::set<std::string>& configs) {
 #endif
 }
 
+// Identifies the version of a key layout file that a cached map was parsed from.
+struct FileIdentity {
+    dev_t device;
+    ino_t inode;
+    off_t size;
+    int64_t modificationTime;
+
+    bool operator==(const FileIdentity&) const = default;
+};
+
+std::optional<FileIdentity> getFileIdentity(const std::string& filename) {
+    struct stat st;
+    if (stat(filename.c_str(), &st) != 0) {
+        return std::nullopt;
+    }
+    return FileIdentity{.device = st.st_dev,
+                        .inode = st.st_ino,
+                        .size = st.st_size,
+                        .modificationTime = st.st_mtim.tv_sec * 1'000'000'000LL +
+                                st.st_mtim.tv_nsec};
+}
+
+// Key layout maps are immutable once loaded, so the devices that use the same file can share a
+// single map instead of each parsing their own copy when they are added. The cache only holds weak
+// references, so a map is released when the last device that uses it is removed.
+struct CachedMap {
+    FileIdentity identity;
+    std::weak_ptr<KeyLayoutMap> map;
+};
+
+std::mutex gCacheLock;
+std::unordered_map<std::string, CachedMap> gCache GUARDED_BY(gCacheLock);
+
+std::shared_ptr<KeyLayoutMap> findCachedMap(const std::string& filename,
+                                            const FileIdentity& identity) {
+    std::scoped_lock lock(gCacheLock);
+    const auto it = gCache.find(filename);
+    if (it == gCache.end() || it->second.identity != identity) {
+        return nullptr;
+    }
+    return it->second.map.lock();
+}
+
+void addCachedMap(const std::string& filename, const FileIdentity& identity,
+                  const std::shared_ptr<KeyLayoutMap>& map) {
+    std::scoped_lock lock(gCacheLock);
+    std::erase_if(gCache, [](const auto& entry) { return entry.second.map.expired(); });
+    gCache[filename] = CachedMap{.identity = identity, .map = map};
+}
+
 } // namespace
 
 KeyLayoutMap::KeyLayoutMap() = default;
@@ -137,6 +190,14 @@ base::Result<std::shared_ptr<KeyLayoutMap>> KeyLayoutMap::loadContents(const std
 
 base::Result<std::shared_ptr<KeyLayoutMap>> KeyLayoutMap::load(const std::string& filename,
                                                                const char* contents) {
+    const std::optional<FileIdentity> identity =
+            contents == nullptr ? getFileIdentity(filename) : std::nullopt;
+    if (identity) {
+        if (std::shared_ptr<KeyLayoutMap> map = findCachedMap(filename, *identity); map) {
+            return map;
+        }
+    }
+
     Tokenizer* tokenizer;
     status_t status;
     if (contents == nullptr) {
@@ -160,6 +221,9 @@ base::Result<std::shared_ptr<KeyLayoutMap>> KeyLayoutMap::load(const std::string
         return Errorf("Missing kernel config");
     }
     map->mLoadFileName = filename;
+    if (identity) {
+        addCachedMap(filename, *identity, map);
+    }
     return ret;
 }
 
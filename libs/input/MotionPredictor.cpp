@@ -68,6 +68,23 @@ float normalizeRange(float x, float min, float max) {
     return std::min(1.0f, std::max(0.0f, normalized));
 }
 
+// Loads the model and runs it once on empty inputs. The first invocation of an interpreter
+// allocates and prepares its kernels, which would otherwise happen on the first prediction.
+std::unique_ptr<TfLiteMotionPredictorModel> createWarmedUpModel() {
+    std::unique_ptr<TfLiteMotionPredictorModel> model = TfLiteMotionPredictorModel::create();
+    if (!model) return nullptr;
+
+    std::ranges::fill(model->inputR(), 0.f);
+    std::ranges::fill(model->inputPhi(), 0.f);
+    std::ranges::fill(model->inputPressure(), 0.f);
+    std::ranges::fill(model->inputTilt(), 0.f);
+    std::ranges::fill(model->inputOrientation(), 0.f);
+    if (!model->invoke()) {
+        ALOGW("Failed to warm up the motion prediction model");
+    }
+    return model;
+}
+
 } // namespace
 
 // --- JerkTracker ---
@@ -153,8 +170,16 @@ MotionPredictor::MotionPredictor(nsecs_t predictionTimestampOffsetNanos,
         mCheckMotionPredictionEnabled(std::move(checkMotionPredictionEnabled)),
         mReportAtomFunction(reportAtomFunction) {}
 
+void MotionPredictor::loadModelAsync() {
+    if (mModel || mPendingModel.valid()) {
+        return;
+    }
+    mPendingModel = std::async(std::launch::async, createWarmedUpModel);
+}
+
 void MotionPredictor::initializeObjects() {
-    mModel = TfLiteMotionPredictorModel::create();
+    loadModelAsync();
+    mModel = mPendingModel.get();
     LOG_ALWAYS_FATAL_IF(!mModel);
 
     // mJerkTracker assumes normalized dt = 1 between recorded samples because
@@ -376,6 +401,10 @@ bool MotionPredictor::isPredictionAvailable(int32_t /*deviceId*/, int32_t source
                  inputEventSourceToString(source).c_str());
         return false;
     }
+
+    // Apps check for availability before they start recording a stroke, which gives the model
+    // time to load.
+    loadModelAsync();
     return true;
 }
 
@@ -82,7 +82,7 @@ void LegacyResampler::updateLatestSamples(const MotionEvent& motionEvent) {
     const size_t latestIndex = numSamples - 1;
     const size_t secondToLatestIndex = (latestIndex > 0) ? (latestIndex - 1) : 0;
     for (size_t sampleIndex = secondToLatestIndex; sampleIndex < numSamples; ++sampleIndex) {
-        std::vector<Pointer> pointers;
+        ftl::SmallVector<Pointer, MAX_POINTERS> pointers;
         const size_t numPointers = motionEvent.getPointerCount();
         for (size_t pointerIndex = 0; pointerIndex < numPointers; ++pointerIndex) {
             // getSamplePointerCoords is the vector representation of a getHistorySize by
@@ -98,7 +98,7 @@ void LegacyResampler::updateLatestSamples(const MotionEvent& motionEvent) {
 }
 
 LegacyResampler::Sample LegacyResampler::messageToSample(const InputMessage& message) {
-    std::vector<Pointer> pointers;
+    ftl::SmallVector<Pointer, MAX_POINTERS> pointers;
     for (uint32_t i = 0; i < message.body.motion.pointerCount; ++i) {
         pointers.push_back(Pointer{message.body.motion.pointers[i].properties,
                                    message.body.motion.pointers[i].coords});
@@ -165,7 +165,7 @@ std::optional<LegacyResampler::Sample> LegacyResampler::attemptInterpolation(
     const float alpha =
             std::chrono::duration<float, std::milli>(resampleTime - pastSample.eventTime) / delta;
 
-    std::vector<Pointer> resampledPointers;
+    ftl::SmallVector<Pointer, MAX_POINTERS> resampledPointers;
     for (size_t i = 0; i < pastSample.pointers.size(); ++i) {
         const PointerCoords& resampledCoords =
                 calculateResampledCoords(pastSample.pointers[i].coords,
@@ -225,7 +225,7 @@ std::optional<LegacyResampler::Sample> LegacyResampler::attemptExtrapolation(
             std::chrono::duration<float, std::milli>(newResampleTime - pastSample.eventTime) /
             delta;
 
-    std::vector<Pointer> resampledPointers;
+    ftl::SmallVector<Pointer, MAX_POINTERS> resampledPointers;
     for (size_t i = 0; i < presentSample.pointers.size(); ++i) {
         const PointerCoords& resampledCoords =
                 calculateResampledCoords(pastSample.pointers[i].coords,
@@ -237,7 +237,7 @@ std::optional<LegacyResampler::Sample> LegacyResampler::attemptExtrapolation(
 
 inline void LegacyResampler::addSampleToMotionEvent(const Sample& sample,
                                                     MotionEvent& motionEvent) {
-    motionEvent.addSample(sample.eventTime.count(), sample.asPointerCoords().data(),
+    motionEvent.addSample(sample.eventTime.count(), sample.asPointerCoords().begin(),
                           motionEvent.getId());
 }
 
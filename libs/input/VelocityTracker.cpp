@@ -23,6 +23,7 @@
 #include <math.h>
 #include <array>
 #include <optional>
+#include <span>
 
 #include <input/PrintTools.h>
 #include <input/VelocityTracker.h>
@@ -119,7 +120,7 @@ static std::string vectorToString(const float* a, uint32_t m) {
     return str;
 }
 
-static std::string vectorToString(const std::vector<float>& v) {
+static std::string vectorToString(std::span<const float> v) {
     return vectorToString(v.data(), v.size());
 }
 
@@ -479,9 +480,8 @@ LeastSquaresVelocityTrackerStrategy::~LeastSquaresVelocityTrackerStrategy() {}
  * http://en.wikipedia.org/wiki/Numerical_methods_for_linear_least_squares
  * http://en.wikipedia.org/wiki/Gram-Schmidt
  */
-static std::optional<float> solveLeastSquares(const std::vector<float>& x,
-                                              const std::vector<float>& y,
-                                              const std::vector<float>& w, uint32_t n) {
+static std::optional<float> solveLeastSquares(std::span<const float> x, std::span<const float> y,
+                                              std::span<const float> w, uint32_t n) {
     const size_t m = x.size();
 
     ALOGD_IF(DEBUG_STRATEGY, "solveLeastSquares: m=%d, n=%d, x=%s, y=%s, w=%s", int(m), int(n),
@@ -671,22 +671,25 @@ std::optional<float> LeastSquaresVelocityTrackerStrategy::getVelocity(int32_t po
         return solveUnweightedLeastSquaresDeg2(movements);
     }
 
-    // Iterate over movement samples in reverse time order and collect samples.
-    std::vector<float> positions;
-    std::vector<float> w;
-    std::vector<float> time;
+    // Iterate over movement samples in reverse time order and collect samples. The ring never
+    // holds more than HISTORY_SIZE movements, so this is done on the stack.
+    std::array<float, HISTORY_SIZE> positions;
+    std::array<float, HISTORY_SIZE> w;
+    std::array<float, HISTORY_SIZE> time;
 
     const Movement& newestMovement = movements[size - 1];
-    for (ssize_t i = size - 1; i >= 0; i--) {
-        const Movement& movement = movements[i];
+    for (size_t i = 0; i < size; i++) {
+        const size_t index = size - 1 - i;
+        const Movement& movement = movements[index];
         nsecs_t age = newestMovement.eventTime - movement.eventTime;
-        positions.push_back(movement.position);
-        w.push_back(chooseWeight(pointerId, i));
-        time.push_back(-age * 0.000000001f);
+        positions[i] = movement.position;
+        w[i] = chooseWeight(pointerId, index);
+        time[i] = -age * 0.000000001f;
     }
 
     // General case for an Nth degree polynomial fit
-    return solveLeastSquares(time, positions, w, degree + 1);
+    return solveLeastSquares({time.data(), size}, {positions.data(), size}, {w.data(), size},
+                             degree + 1);
 }
 
 float LeastSquaresVelocityTrackerStrategy::chooseWeight(int32_t pointerId, uint32_t index) const {
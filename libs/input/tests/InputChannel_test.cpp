@@ -227,6 +227,33 @@ TEST_F(InputChannelTest, SendAndReceive_MotionClassification) {
     }
 }
 
+TEST_F(InputChannelTest, SendMessages_DeliversEveryMessageInOrder) {
+    std::unique_ptr<InputChannel> serverChannel, clientChannel;
+    status_t result =
+            InputChannel::openInputChannelPair("channel name", serverChannel, clientChannel);
+    ASSERT_EQ(OK, result) << "should have successfully opened a channel pair";
+
+    // More than are written with a single call.
+    std::array<InputMessage, 20> serverMsgs = {};
+    for (size_t i = 0; i < serverMsgs.size(); i++) {
+        serverMsgs[i].header.type = InputMessage::Type::MOTION;
+        serverMsgs[i].header.seq = i + 1;
+        serverMsgs[i].body.motion.pointerCount = 1 + i % 3;
+    }
+    size_t sentCount = 0;
+    EXPECT_EQ(OK, serverChannel->sendMessages(serverMsgs.data(), serverMsgs.size(), &sentCount));
+    EXPECT_EQ(serverMsgs.size(), sentCount);
+
+    for (size_t i = 0; i < serverMsgs.size(); i++) {
+        android::base::Result<InputMessage> clientMsgResult = clientChannel->receiveMessage();
+        ASSERT_TRUE(clientMsgResult.ok())
+                << "client channel should be able to receive message from server channel";
+        EXPECT_EQ(i + 1, clientMsgResult->header.seq);
+        EXPECT_EQ(1 + i % 3, clientMsgResult->body.motion.pointerCount);
+    }
+    EXPECT_FALSE(clientChannel->receiveMessage().ok());
+}
+
 TEST_F(InputChannelTest, DuplicateChannelAndAssertEqual) {
     std::unique_ptr<InputChannel> serverChannel, clientChannel;
 
@@ -202,6 +202,15 @@ TEST(InputDeviceKeyLayoutTest, HidUsageCodesFallbackMapping) {
     }
 }
 
+TEST(InputDeviceKeyLayoutTest, SharesMapLoadedFromSameFile) {
+    std::string klPath = base::GetExecutableDirectory() + "/data/hid_fallback_mapping.kl";
+    base::Result<std::shared_ptr<KeyLayoutMap>> first = KeyLayoutMap::load(klPath);
+    ASSERT_TRUE(first.ok()) << "Unable to load KeyLayout at " << klPath;
+    base::Result<std::shared_ptr<KeyLayoutMap>> second = KeyLayoutMap::load(klPath);
+    ASSERT_TRUE(second.ok()) << "Unable to load KeyLayout at " << klPath;
+    ASSERT_EQ(*first, *second);
+}
+
 TEST(InputDeviceKeyLayoutTest, DoesNotLoadWhenRequiredKernelConfigIsMissing) {
 #if !defined(__ANDROID__)
     GTEST_SKIP() << "Can't check kernel configs on host";
@@ -51,4 +51,40 @@ TEST(InputVerifierTest, ProcessSourceClassPointer) {
     ASSERT_TRUE(result.ok());
 }
 
+TEST(InputVerifierTest, NonPointerSourceIsNotVerified) {
+    InputVerifier verifier("Verify non-pointer source");
+
+    PointerProperties properties;
+    properties.clear();
+    properties.id = 0;
+    PointerCoords coords;
+    coords.clear();
+
+    // An UP without a preceding DOWN is inconsistent, but relative mouse streams are not verified.
+    const Result<void> result =
+            verifier.processMovement(/*deviceId=*/0, AINPUT_SOURCE_MOUSE_RELATIVE,
+                                     AMOTION_EVENT_ACTION_UP, /*pointerCount=*/1, &properties,
+                                     &coords, /*flags=*/0);
+    ASSERT_TRUE(result.ok());
+}
+
+TEST(InputVerifierTest, TooManyPointersIsRejected) {
+    InputVerifier verifier("Verify too many pointers");
+
+    std::vector<PointerProperties> properties(MAX_POINTERS + 1);
+    std::vector<PointerCoords> coords(MAX_POINTERS + 1);
+    for (size_t i = 0; i < properties.size(); i++) {
+        properties[i].clear();
+        properties[i].id = i;
+        coords[i].clear();
+    }
+
+    const Result<void> result =
+            verifier.processMovement(/*deviceId=*/0, AINPUT_SOURCE_TOUCHSCREEN,
+                                     AMOTION_EVENT_ACTION_MOVE,
+                                     /*pointerCount=*/properties.size(), properties.data(),
+                                     coords.data(), /*flags=*/0);
+    ASSERT_FALSE(result.ok());
+}
+
 } // namespace android
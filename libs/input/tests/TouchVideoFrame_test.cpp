@@ -68,6 +68,22 @@ TEST(TouchVideoFrame, Equality) {
     ASSERT_FALSE(frame == changedTimestampFrame);
 }
 
+TEST(TouchVideoFrame, CopySharesData) {
+    TouchVideoFrame frame(3, 2, {1, 2, 3, 4, 5, 6}, TIMESTAMP);
+    TouchVideoFrame copy = frame;
+    ASSERT_EQ(frame, copy);
+    ASSERT_EQ(&frame.getData(), &copy.getData());
+}
+
+TEST(TouchVideoFrame, RotatingCopyDoesNotAffectOriginal) {
+    TouchVideoFrame frame(3, 2, {1, 2, 3, 4, 5, 6}, TIMESTAMP);
+    TouchVideoFrame frameOriginal(3, 2, {1, 2, 3, 4, 5, 6}, TIMESTAMP);
+    TouchVideoFrame copy = frame;
+    copy.rotate(ui::ROTATION_90);
+    copy.rotate(ui::ROTATION_180);
+    ASSERT_EQ(frame, frameOriginal);
+}
+
 // --- Rotate 90 degrees ---
 
 TEST(TouchVideoFrame, Rotate90_0x0) {
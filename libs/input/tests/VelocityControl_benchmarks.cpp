@@ -0,0 +1,65 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <input/AccelerationCurve.h>
+#include <input/VelocityControl.h>
+
+namespace android {
+
+namespace {
+
+// Moves the pointer as a mouse polling at the rate given by the benchmark argument does, with a
+// movement that speeds up and slows down so that every segment of the curve is used.
+template <typename Control>
+void moveAtPollingRate(benchmark::State& state, Control& control) {
+    const nsecs_t sampleInterval = 1'000'000'000 / state.range(0);
+    nsecs_t eventTime = 0;
+    int step = 0;
+
+    for (auto _ : state) {
+        eventTime += sampleInterval;
+        // Counts per sample: ramps from 1 to 32 and back.
+        const int phase = step++ % 64;
+        float deltaX = static_cast<float>(phase < 32 ? phase + 1 : 64 - phase);
+        float deltaY = deltaX / 2;
+        control.move(eventTime, &deltaX, &deltaY);
+        benchmark::DoNotOptimize(deltaX);
+        benchmark::DoNotOptimize(deltaY);
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+
+void curvedVelocityControlMove(benchmark::State& state) {
+    CurvedVelocityControl control;
+    control.setCurve(createAccelerationCurveForPointerSensitivity(/*sensitivity=*/0));
+    moveAtPollingRate(state, control);
+}
+BENCHMARK(curvedVelocityControlMove)->Arg(125)->Arg(1000)->Arg(8000);
+
+void simpleVelocityControlMove(benchmark::State& state) {
+    SimpleVelocityControl control;
+    control.setParameters(VelocityControlParameters(/*scale=*/1.0f, /*lowThreshold=*/500.0f,
+                                                    /*highThreshold=*/3000.0f,
+                                                    /*acceleration=*/3.0f));
+    moveAtPollingRate(state, control);
+}
+BENCHMARK(simpleVelocityControlMove)->Arg(125)->Arg(1000)->Arg(8000);
+
+} // namespace
+} // namespace android
@@ -0,0 +1,71 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <ftl/enum.h>
+#include <input/Input.h>
+#include <input/VelocityTracker.h>
+
+namespace android {
+
+namespace {
+
+constexpr int32_t kPointerCount = 10;
+// A touchscreen reporting at 120 Hz.
+constexpr nsecs_t kSampleInterval = 8'333'333;
+
+// Adds a sample to every pointer on both axes, and asks for their velocity, as an app does for
+// each MOVE of a ten finger gesture when it calls computeCurrentVelocity.
+void addMovementAndGetVelocity(benchmark::State& state) {
+    const auto strategy = static_cast<VelocityTracker::Strategy>(state.range(0));
+    state.SetLabel(ftl::enum_string(strategy));
+
+    VelocityTracker tracker(strategy);
+    nsecs_t eventTime = 0;
+    float position = 0;
+
+    const auto addMovement = [&]() {
+        eventTime += kSampleInterval;
+        position += 10;
+        for (int32_t pointerId = 0; pointerId < kPointerCount; pointerId++) {
+            const float offset = static_cast<float>(pointerId) * 100;
+            tracker.addMovement(eventTime, pointerId, AMOTION_EVENT_AXIS_X, position + offset);
+            tracker.addMovement(eventTime, pointerId, AMOTION_EVENT_AXIS_Y, position - offset);
+        }
+    };
+
+    // Fill the history of every pointer before measuring.
+    for (int i = 0; i < 20; i++) {
+        addMovement();
+    }
+
+    for (auto _ : state) {
+        addMovement();
+        for (int32_t pointerId = 0; pointerId < kPointerCount; pointerId++) {
+            benchmark::DoNotOptimize(tracker.getVelocity(AMOTION_EVENT_AXIS_X, pointerId));
+            benchmark::DoNotOptimize(tracker.getVelocity(AMOTION_EVENT_AXIS_Y, pointerId));
+        }
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * kPointerCount);
+}
+BENCHMARK(addMovementAndGetVelocity)
+        ->DenseRange(static_cast<int64_t>(VelocityTracker::Strategy::MIN),
+                     static_cast<int64_t>(VelocityTracker::Strategy::MAX));
+
+} // namespace
+} // namespace android
@@ -224,6 +224,63 @@ CONSTEXPR MATRIX PURE fastInverse3(const MATRIX& x) {
     return inverted;
 }
 
+
+//------------------------------------------------------------------------------
+// 4x4 analytic inverse using the Laplace expansion theorem, from David Eberly's
+// "The Laplace Expansion Theorem: Computing the Determinants and Inverses of
+// Matrices". This is several times faster than gaussJordanInverse(), and has
+// no branches so compilers vectorize it well.
+template <typename MATRIX>
+CONSTEXPR MATRIX PURE fastInverse4(const MATRIX& x) {
+    typedef typename MATRIX::value_type T;
+
+    // The expansion is written for a row-major matrix a[i][j]. Applying it
+    // to our column-major storage computes the inverse of the transpose, which
+    // is the transpose of the inverse, so the result is in the right order
+    // when stored back column-major.
+    const T s0 = x[0][0] * x[1][1] - x[1][0] * x[0][1];
+    const T s1 = x[0][0] * x[1][2] - x[1][0] * x[0][2];
+    const T s2 = x[0][0] * x[1][3] - x[1][0] * x[0][3];
+    const T s3 = x[0][1] * x[1][2] - x[1][1] * x[0][2];
+    const T s4 = x[0][1] * x[1][3] - x[1][1] * x[0][3];
+    const T s5 = x[0][2] * x[1][3] - x[1][2] * x[0][3];
+
+    const T c5 = x[2][2] * x[3][3] - x[3][2] * x[2][3];
+    const T c4 = x[2][1] * x[3][3] - x[3][1] * x[2][3];
+    const T c3 = x[2][1] * x[3][2] - x[3][1] * x[2][2];
+    const T c2 = x[2][0] * x[3][3] - x[3][0] * x[2][3];
+    const T c1 = x[2][0] * x[3][2] - x[3][0] * x[2][2];
+    const T c0 = x[2][0] * x[3][1] - x[3][0] * x[2][1];
+
+    const T det(s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0);
+
+    MATRIX inverted(MATRIX::NO_INIT);
+    inverted[0][0] =  x[1][1] * c5 - x[1][2] * c4 + x[1][3] * c3;
+    inverted[0][1] = -x[0][1] * c5 + x[0][2] * c4 - x[0][3] * c3;
+    inverted[0][2] =  x[3][1] * s5 - x[3][2] * s4 + x[3][3] * s3;
+    inverted[0][3] = -x[2][1] * s5 + x[2][2] * s4 - x[2][3] * s3;
+    inverted[1][0] = -x[1][0] * c5 + x[1][2] * c2 - x[1][3] * c1;
+    inverted[1][1] =  x[0][0] * c5 - x[0][2] * c2 + x[0][3] * c1;
+    inverted[1][2] = -x[3][0] * s5 + x[3][2] * s2 - x[3][3] * s1;
+    inverted[1][3] =  x[2][0] * s5 - x[2][2] * s2 + x[2][3] * s1;
+    inverted[2][0] =  x[1][0] * c4 - x[1][1] * c2 + x[1][3] * c0;
+    inverted[2][1] = -x[0][0] * c4 + x[0][1] * c2 - x[0][3] * c0;
+    inverted[2][2] =  x[3][0] * s4 - x[3][1] * s2 + x[3][3] * s0;
+    inverted[2][3] = -x[2][0] * s4 + x[2][1] * s2 - x[2][3] * s0;
+    inverted[3][0] = -x[1][0] * c3 + x[1][1] * c1 - x[1][2] * c0;
+    inverted[3][1] =  x[0][0] * c3 - x[0][1] * c1 + x[0][2] * c0;
+    inverted[3][2] = -x[3][0] * s3 + x[3][1] * s1 - x[3][2] * s0;
+    inverted[3][3] =  x[2][0] * s3 - x[2][1] * s1 + x[2][2] * s0;
+
+    for (size_t col = 0; col < 4; ++col) {
+        for (size_t row = 0; row < 4; ++row) {
+            inverted[col][row] /= det;
+        }
+    }
+
+    return inverted;
+}
+
 /**
  * Inversion function which switches on the matrix size.
  * @warning This function assumes the matrix is invertible. The result is
@@ -235,7 +292,8 @@ inline constexpr MATRIX PURE inverse(const MATRIX& matrix) {
     static_assert(MATRIX::NUM_ROWS == MATRIX::NUM_COLS, "only square matrices can be inverted");
     return (MATRIX::NUM_ROWS == 2) ? fastInverse2<MATRIX>(matrix) :
           ((MATRIX::NUM_ROWS == 3) ? fastInverse3<MATRIX>(matrix) :
-                    gaussJordanInverse<MATRIX>(matrix));
+          ((MATRIX::NUM_ROWS == 4) ? fastInverse4<MATRIX>(matrix) :
+                    gaussJordanInverse<MATRIX>(matrix)));
 }
 
 template<typename MATRIX_R, typename MATRIX_A, typename MATRIX_B>
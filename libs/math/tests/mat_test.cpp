@@ -421,6 +421,25 @@ TYPED_TEST(MatTestT, Inverse4) {
     TEST_MATRIX_INVERSE(m5, 20.0 * std::numeric_limits<TypeParam>::epsilon());
 }
 
+TYPED_TEST(MatTestT, Inverse4MatchesGaussJordan) {
+    typedef ::android::details::TMat44<TypeParam> M44T;
+
+    M44T m(
+        4.683281e-01, 1.251189e-02, -8.834660e-01, -4.726541e+00,
+        -8.749647e-01,  1.456563e-01, -4.617587e-01, 3.044795e+00,
+        1.229049e-01,  9.892561e-01, 7.916244e-02, -6.737138e+00,
+        1.000000e+00, 2.000000e+00, 3.000000e+00, 4.000000e+00);
+
+    M44T fast = inverse(m);
+    M44T reference = ::android::details::matrix::gaussJordanInverse(m);
+    for (size_t c = 0; c < M44T::COL_SIZE; ++c) {
+        for (size_t r = 0; r < M44T::ROW_SIZE; ++r) {
+            EXPECT_NEAR(reference[c][r], fast[c][r],
+                        20.0 * std::numeric_limits<TypeParam>::epsilon());
+        }
+    }
+}
+
 //------------------------------------------------------------------------------
 TYPED_TEST(MatTestT, Inverse3) {
     typedef ::android::details::TMat33<TypeParam> M33T;
@@ -35,6 +35,7 @@
 #include <errno.h>
 #include <limits.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <string.h>
 #include <sys/cdefs.h>
@@ -343,11 +344,14 @@ static const int64_t NATIVE_WINDOW_TIMESTAMP_AUTO = (-9223372036854775807LL-1);
 static const int64_t NATIVE_WINDOW_TIMESTAMP_PENDING = -2;
 static const int64_t NATIVE_WINDOW_TIMESTAMP_INVALID = -1;
 
+struct ANativeWindowPerformTable;
+
 struct ANativeWindow
 {
 #ifdef __cplusplus
     ANativeWindow()
-        : flags(0), minSwapInterval(0), maxSwapInterval(0), xdpi(0), ydpi(0)
+        : flags(0), minSwapInterval(0), maxSwapInterval(0), xdpi(0), ydpi(0),
+          performTable(NULL)
     {
         common.magic = ANDROID_NATIVE_WINDOW_MAGIC;
         common.version = sizeof(ANativeWindow);
@@ -562,8 +566,70 @@ struct ANativeWindow
      */
     int     (*cancelBuffer)(struct ANativeWindow* window,
                 struct ANativeWindowBuffer* buffer, int fenceFd);
+
+    /*
+     * Direct entry points for perform() operations that producers issue
+     * every frame, or NULL if the window only implements perform(). See
+     * struct ANativeWindowPerformTable.
+     *
+     * This field was appended after the others, so windows built against
+     * older headers don't have it. Use native_window_get_perform_table()
+     * rather than reading it directly.
+     */
+    const struct ANativeWindowPerformTable* performTable;
 };
 
+/*
+ * Table of functions that a window may implement in addition to perform(),
+ * so that the per-frame native_window_* helpers below avoid the variadic
+ * dispatch. Each function behaves exactly as the perform() operation it
+ * replaces, including any perform interceptor the window has.
+ *
+ * Functions are only ever appended to the table. size is the sizeof() of the
+ * table the window was built with, and a function is present if it lies
+ * within size and is not NULL; NATIVE_WINDOW_PERFORM_TABLE_HAS checks both.
+ */
+struct ANativeWindowPerformTable {
+    size_t size;
+
+    /* NATIVE_WINDOW_SET_BUFFERS_DATASPACE */
+    int (*setBuffersDataSpace)(struct ANativeWindow* window, android_dataspace_t dataSpace);
+
+    /* NATIVE_WINDOW_SET_BUFFERS_TIMESTAMP */
+    int (*setBuffersTimestamp)(struct ANativeWindow* window, int64_t timestamp);
+
+    /* NATIVE_WINDOW_SET_BUFFERS_TRANSFORM */
+    int (*setBuffersTransform)(struct ANativeWindow* window, int transform);
+
+    /* NATIVE_WINDOW_SET_CROP */
+    int (*setCrop)(struct ANativeWindow* window, const android_native_rect_t* crop);
+
+    /* NATIVE_WINDOW_SET_SURFACE_DAMAGE */
+    int (*setSurfaceDamage)(struct ANativeWindow* window, const android_native_rect_t* rects,
+                            size_t numRects);
+};
+
+#define NATIVE_WINDOW_PERFORM_TABLE_HAS(table, function)                             \
+    ((table) != NULL &&                                                              \
+     (table)->size >= offsetof(struct ANativeWindowPerformTable, function) +         \
+                              sizeof((table)->function) &&                           \
+     (table)->function != NULL)
+
+/*
+ * native_window_get_perform_table(...)
+ * Returns the perform table of the window, or NULL if it has none.
+ */
+static inline const struct ANativeWindowPerformTable* native_window_get_perform_table(
+        const struct ANativeWindow* window)
+{
+    /* common.version is the sizeof() of the ANativeWindow the window was built with. */
+    if (window->common.version < (int)(offsetof(struct ANativeWindow, performTable) +
+                                       sizeof(window->performTable))) {
+        return NULL;
+    }
+    return window->performTable;
+}
+
  /* Backwards compatibility: use ANativeWindow (struct ANativeWindow in C).
   * android_native_window_t is deprecated.
   */
@@ -620,6 +686,10 @@ static inline int native_window_set_crop(
         struct ANativeWindow* window,
         android_native_rect_t const * crop)
 {
+    const struct ANativeWindowPerformTable* table = native_window_get_perform_table(window);
+    if (NATIVE_WINDOW_PERFORM_TABLE_HAS(table, setCrop)) {
+        return table->setCrop(window, crop);
+    }
     return window->perform(window, NATIVE_WINDOW_SET_CROP, crop);
 }
 
@@ -730,6 +800,10 @@ static inline int native_window_set_buffers_data_space(
         struct ANativeWindow* window,
         android_dataspace_t dataSpace)
 {
+    const struct ANativeWindowPerformTable* table = native_window_get_perform_table(window);
+    if (NATIVE_WINDOW_PERFORM_TABLE_HAS(table, setBuffersDataSpace)) {
+        return table->setBuffersDataSpace(window, dataSpace);
+    }
     return window->perform(window, NATIVE_WINDOW_SET_BUFFERS_DATASPACE,
             dataSpace);
 }
@@ -800,6 +874,10 @@ static inline int native_window_set_buffers_transform(
         struct ANativeWindow* window,
         int transform)
 {
+    const struct ANativeWindowPerformTable* table = native_window_get_perform_table(window);
+    if (NATIVE_WINDOW_PERFORM_TABLE_HAS(table, setBuffersTransform)) {
+        return table->setBuffersTransform(window, transform);
+    }
     return window->perform(window, NATIVE_WINDOW_SET_BUFFERS_TRANSFORM,
             transform);
 }
@@ -835,6 +913,10 @@ static inline int native_window_set_buffers_timestamp(
         struct ANativeWindow* window,
         int64_t timestamp)
 {
+    const struct ANativeWindowPerformTable* table = native_window_get_perform_table(window);
+    if (NATIVE_WINDOW_PERFORM_TABLE_HAS(table, setBuffersTimestamp)) {
+        return table->setBuffersTimestamp(window, timestamp);
+    }
     return window->perform(window, NATIVE_WINDOW_SET_BUFFERS_TIMESTAMP,
             timestamp);
 }
@@ -919,6 +1001,10 @@ static inline int native_window_set_surface_damage(
         struct ANativeWindow* window,
         const android_native_rect_t* rects, size_t numRects)
 {
+    const struct ANativeWindowPerformTable* table = native_window_get_perform_table(window);
+    if (NATIVE_WINDOW_PERFORM_TABLE_HAS(table, setSurfaceDamage)) {
+        return table->setSurfaceDamage(window, rects, numRects);
+    }
     return window->perform(window, NATIVE_WINDOW_SET_SURFACE_DAMAGE,
             rects, numRects);
 }
@@ -17,6 +17,7 @@
 #define LOG_TAG "ANativeWindow_test"
 //#define LOG_NDEBUG 0
 
+#include <apex/window.h>
 #include <gtest/gtest.h>
 #include <gui/BufferItemConsumer.h>
 #include <gui/BufferQueue.h>
@@ -27,6 +28,8 @@
 // apexes yet.
 #include <system/window.h>
 
+#include <vector>
+
 using namespace android;
 
 class TestableSurface final : public Surface {
@@ -173,3 +176,54 @@ TEST_F(ANativeWindowTest, setDequeueTimeout_causesDequeueTimeout) {
     EXPECT_EQ(TIMED_OUT, dequeueResult);
     EXPECT_GE(end - start, timeout);
 }
+
+TEST_F(ANativeWindowTest, performTable_setsBufferState) {
+    ASSERT_NE(nullptr, native_window_get_perform_table(mWindow.get()));
+    // Large enough for the crop, which is clipped to the buffer.
+    ASSERT_EQ(0, native_window_set_buffers_dimensions(mWindow.get(), 16, 16));
+
+    constexpr int64_t kTimestamp = 1234;
+    const android_native_rect_t crop = {.left = 1, .top = 2, .right = 3, .bottom = 4};
+    EXPECT_EQ(0, native_window_set_buffers_timestamp(mWindow.get(), kTimestamp));
+    EXPECT_EQ(0, native_window_set_crop(mWindow.get(), &crop));
+    EXPECT_EQ(0,
+              native_window_set_buffers_transform(mWindow.get(), NATIVE_WINDOW_TRANSFORM_ROT_90));
+    EXPECT_EQ(0, native_window_set_buffers_data_space(mWindow.get(), HAL_DATASPACE_SRGB));
+
+    ANativeWindowBuffer* buffer;
+    int fd;
+    ASSERT_EQ(0, ANativeWindow_dequeueBuffer(mWindow.get(), &buffer, &fd));
+    ASSERT_EQ(0, ANativeWindow_queueBuffer(mWindow.get(), buffer, fd));
+
+    BufferItem item;
+    ASSERT_EQ(NO_ERROR, mItemConsumer->acquireBuffer(&item, 0));
+    EXPECT_EQ(kTimestamp, item.mTimestamp);
+    EXPECT_EQ(Rect(1, 2, 3, 4), item.mCrop);
+    EXPECT_EQ(static_cast<uint32_t>(NATIVE_WINDOW_TRANSFORM_ROT_90), item.mTransform);
+    EXPECT_EQ(HAL_DATASPACE_SRGB, item.mDataSpace);
+    EXPECT_EQ(NO_ERROR, mItemConsumer->releaseBuffer(item));
+}
+
+TEST_F(ANativeWindowTest, performTable_goesThroughPerformInterceptor) {
+    std::vector<int> operations;
+    ANativeWindow_performInterceptor interceptor = [](ANativeWindow* window,
+                                                      ANativeWindow_performFn perform, void* data,
+                                                      int operation, va_list args) {
+        static_cast<std::vector<int>*>(data)->push_back(operation);
+        return perform(window, operation, args);
+    };
+    ASSERT_EQ(0, ANativeWindow_setPerformInterceptor(mWindow.get(), interceptor, &operations));
+
+    const android_native_rect_t crop = {.left = 0, .top = 0, .right = 1, .bottom = 1};
+    EXPECT_EQ(0, native_window_set_buffers_timestamp(mWindow.get(), 1234));
+    EXPECT_EQ(0, native_window_set_crop(mWindow.get(), &crop));
+    EXPECT_EQ(0, native_window_set_buffers_transform(mWindow.get(), 0));
+    EXPECT_EQ(0, native_window_set_buffers_data_space(mWindow.get(), HAL_DATASPACE_SRGB));
+    EXPECT_EQ(0, native_window_set_surface_damage(mWindow.get(), &crop, 1));
+
+    EXPECT_EQ((std::vector<int>{NATIVE_WINDOW_SET_BUFFERS_TIMESTAMP, NATIVE_WINDOW_SET_CROP,
+                                NATIVE_WINDOW_SET_BUFFERS_TRANSFORM,
+                                NATIVE_WINDOW_SET_BUFFERS_DATASPACE,
+                                NATIVE_WINDOW_SET_SURFACE_DAMAGE}),
+              operations);
+}
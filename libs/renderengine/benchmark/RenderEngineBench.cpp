@@ -23,8 +23,11 @@
 #include <renderengine/LayerSettings.h>
 #include <renderengine/RenderEngine.h>
 #include <renderengine/impl/ExternalTexture.h>
+#include <utils/Timers.h>
 
+#include <algorithm>
 #include <mutex>
+#include <tuple>
 
 using namespace android;
 using namespace android::renderengine;
@@ -76,6 +79,7 @@ std::pair<uint32_t, uint32_t> getDisplaySize() {
 
 static std::unique_ptr<RenderEngine> createRenderEngine(
         RenderEngine::Threaded threaded, RenderEngine::GraphicsApi graphicsApi,
+        RenderEngine::SkiaBackend skiaBackend = RenderEngine::SkiaBackend::GANESH,
         RenderEngine::BlurAlgorithm blurAlgorithm = RenderEngine::BlurAlgorithm::KAWASE) {
     auto args = RenderEngineCreationArgs::Builder()
                         .setPixelFormat(static_cast<int>(ui::PixelFormat::RGBA_8888))
@@ -86,10 +90,27 @@ static std::unique_ptr<RenderEngine> createRenderEngine(
                         .setContextPriority(RenderEngine::ContextPriority::REALTIME)
                         .setThreaded(threaded)
                         .setGraphicsApi(graphicsApi)
+                        .setSkiaBackend(skiaBackend)
                         .build();
     return RenderEngine::create(args);
 }
 
+/**
+ * Create the RenderEngine described by a benchmark's arguments: whether it is threaded, its
+ * graphics API, its Skia backend and, optionally, its blur algorithm.
+ */
+template <class... Args>
+static std::unique_ptr<RenderEngine> createRenderEngine(const std::tuple<Args...>& args) {
+    auto blurAlgorithm = RenderEngine::BlurAlgorithm::KAWASE;
+    if constexpr (sizeof...(Args) > 3) {
+        blurAlgorithm = static_cast<RenderEngine::BlurAlgorithm>(std::get<3>(args));
+    }
+    return createRenderEngine(static_cast<RenderEngine::Threaded>(std::get<0>(args)),
+                              static_cast<RenderEngine::GraphicsApi>(std::get<1>(args)),
+                              static_cast<RenderEngine::SkiaBackend>(std::get<2>(args)),
+                              blurAlgorithm);
+}
+
 static std::shared_ptr<ExternalTexture> allocateBuffer(RenderEngine& re, uint32_t width,
                                                        uint32_t height,
                                                        uint64_t extraUsageFlags = 0,
@@ -145,31 +166,40 @@ static std::shared_ptr<ExternalTexture> copyBuffer(RenderEngine& re,
 /**
  * Helper for timing calls to drawLayers.
  *
- * Caller needs to create RenderEngine and the LayerSettings, and this takes
- * care of setting up the display, starting and stopping the timer, calling
- * drawLayers, and saving (if --save is used).
+ * Caller needs to create RenderEngine, the LayerSettings, the DisplaySettings and the output
+ * buffer, and this takes care of starting and stopping the timer, calling drawLayers, and
+ * saving (if --save is used).
  *
  * This times both the CPU and GPU work initiated by drawLayers. All work done
- * outside of the for loop is excluded from the timing measurements.
+ * outside of the for loop is excluded from the timing measurements. Two counters split the
+ * time per iteration: submit_ms until drawLayers returned its fence, and gpu_ms from then until
+ * the fence signaled.
  */
 static void benchDrawLayers(RenderEngine& re, const std::vector<LayerSettings>& layers,
+                            const DisplaySettings& display,
+                            std::shared_ptr<ExternalTexture> outputBuffer,
                             benchmark::State& benchState, const char* saveFileName) {
-    auto [width, height] = getDisplaySize();
-    auto outputBuffer = allocateBuffer(re, width, height);
-
-    const Rect displayRect(0, 0, static_cast<int32_t>(width), static_cast<int32_t>(height));
-    DisplaySettings display{
-            .physicalDisplay = displayRect,
-            .clip = displayRect,
-            .maxLuminance = 500,
-    };
+    nsecs_t submitTime = 0;
+    nsecs_t gpuTime = 0;
 
     // This loop starts and stops the timer.
     for (auto _ : benchState) {
+        const nsecs_t startTime = systemTime();
         sp<Fence> waitFence =
                 re.drawLayers(display, layers, outputBuffer, base::unique_fd()).get().value();
+        const nsecs_t submittedTime = systemTime();
         waitFence->waitForever(LOG_TAG);
+
+        submitTime += submittedTime - startTime;
+        if (const nsecs_t signalTime = waitFence->getSignalTime();
+            signalTime != Fence::SIGNAL_TIME_INVALID && signalTime != Fence::SIGNAL_TIME_PENDING) {
+            gpuTime += std::max<nsecs_t>(signalTime - submittedTime, 0);
+        }
     }
+    benchState.counters["submit_ms"] =
+            benchmark::Counter(ns2us(submitTime) / 1000.0, benchmark::Counter::kAvgIterations);
+    benchState.counters["gpu_ms"] =
+            benchmark::Counter(ns2us(gpuTime) / 1000.0, benchmark::Counter::kAvgIterations);
 
     if (renderenginebench::save() && saveFileName) {
         // Copy to a CPU-accessible buffer so we can encode it.
@@ -183,6 +213,23 @@ static void benchDrawLayers(RenderEngine& re, const std::vector<LayerSettings>&
     }
 }
 
+/**
+ * Same as above, drawing into a buffer the size of the display.
+ */
+static void benchDrawLayers(RenderEngine& re, const std::vector<LayerSettings>& layers,
+                            benchmark::State& benchState, const char* saveFileName) {
+    auto [width, height] = getDisplaySize();
+    auto outputBuffer = allocateBuffer(re, width, height);
+
+    const Rect displayRect(0, 0, static_cast<int32_t>(width), static_cast<int32_t>(height));
+    DisplaySettings display{
+            .physicalDisplay = displayRect,
+            .clip = displayRect,
+            .maxLuminance = 500,
+    };
+    benchDrawLayers(re, layers, display, std::move(outputBuffer), benchState, saveFileName);
+}
+
 /**
  * Return a buffer with the image in the provided path, relative to the executable directory
  */
@@ -210,9 +257,7 @@ constexpr char kHomescreenPath[] = "/resources/homescreen.png";
  */
 template <class... Args>
 void BM_homescreen(benchmark::State& benchState, Args&&... args) {
-    auto args_tuple = std::make_tuple(std::move(args)...);
-    auto re = createRenderEngine(static_cast<RenderEngine::Threaded>(std::get<0>(args_tuple)),
-                                 static_cast<RenderEngine::GraphicsApi>(std::get<1>(args_tuple)));
+    auto re = createRenderEngine(std::make_tuple(std::move(args)...));
 
     auto [width, height] = getDisplaySize();
     auto srcBuffer = createTexture(*re, kHomescreenPath);
@@ -238,9 +283,7 @@ void BM_homescreen(benchmark::State& benchState, Args&&... args) {
 
 template <class... Args>
 void BM_homescreen_blur(benchmark::State& benchState, Args&&... args) {
-    auto args_tuple = std::make_tuple(std::move(args)...);
-    auto re = createRenderEngine(static_cast<RenderEngine::Threaded>(std::get<0>(args_tuple)),
-                                 static_cast<RenderEngine::GraphicsApi>(std::get<1>(args_tuple)));
+    auto re = createRenderEngine(std::make_tuple(std::move(args)...));
 
     auto [width, height] = getDisplaySize();
     auto srcBuffer = createTexture(*re, kHomescreenPath);
@@ -276,9 +319,7 @@ void BM_homescreen_blur(benchmark::State& benchState, Args&&... args) {
 
 template <class... Args>
 void BM_homescreen_edgeExtension(benchmark::State& benchState, Args&&... args) {
-    auto args_tuple = std::make_tuple(std::move(args)...);
-    auto re = createRenderEngine(static_cast<RenderEngine::Threaded>(std::get<0>(args_tuple)),
-                                 static_cast<RenderEngine::GraphicsApi>(std::get<1>(args_tuple)));
+    auto re = createRenderEngine(std::make_tuple(std::move(args)...));
 
     auto [width, height] = getDisplaySize();
     auto srcBuffer = createTexture(*re, kHomescreenPath);
@@ -309,17 +350,232 @@ void BM_homescreen_edgeExtension(benchmark::State& benchState, Args&&... args) {
     benchDrawLayers(*re, layers, benchState, "homescreen_edge_extension");
 }
 
+/**
+ * Blend a number of translucent copies of the homescreen on top of each other, as when several
+ * app windows are client composited. The number of layers is the benchmark's argument.
+ */
+template <class... Args>
+void BM_homescreen_layers(benchmark::State& benchState, Args&&... args) {
+    auto re = createRenderEngine(std::make_tuple(std::move(args)...));
+
+    auto [width, height] = getDisplaySize();
+    auto srcBuffer = createTexture(*re, kHomescreenPath);
+
+    std::vector<LayerSettings> layers;
+    for (int64_t i = 0; i < benchState.range(0); i++) {
+        // Offset each layer a little so that they are not drawn with the same geometry.
+        const float offset = static_cast<float>(i * 16);
+        layers.push_back(LayerSettings{
+                .geometry =
+                        Geometry{
+                                .boundaries = FloatRect(offset, offset, width, height),
+                        },
+                .source =
+                        PixelSource{
+                                .buffer =
+                                        Buffer{
+                                                .buffer = srcBuffer,
+                                        },
+                        },
+                .alpha = half(0.5f),
+        });
+    }
+    benchDrawLayers(*re, layers, benchState, "homescreen_layers");
+}
+
+/**
+ * Blur the homescreen behind a stack of shrinking panels, as with a dialog shown over the
+ * notification shade.
+ */
+template <class... Args>
+void BM_homescreen_blurStack(benchmark::State& benchState, Args&&... args) {
+    auto re = createRenderEngine(std::make_tuple(std::move(args)...));
+
+    auto [width, height] = getDisplaySize();
+    auto srcBuffer = createTexture(*re, kHomescreenPath);
+
+    std::vector<LayerSettings> layers{LayerSettings{
+            .geometry =
+                    Geometry{
+                            .boundaries = FloatRect(0, 0, width, height),
+                    },
+            .source =
+                    PixelSource{
+                            .buffer =
+                                    Buffer{
+                                            .buffer = srcBuffer,
+                                    },
+                    },
+            .alpha = half(1.0f),
+    }};
+    for (int i = 0; i < 3; i++) {
+        const float inset = static_cast<float>(i) * 0.15f;
+        layers.push_back(LayerSettings{
+                .geometry =
+                        Geometry{
+                                .boundaries = FloatRect(width * inset, height * inset,
+                                                        width * (1 - inset), height * (1 - inset)),
+                                .roundedCornersRadius = vec2(32.0f, 32.0f),
+                                .roundedCornersCrop = FloatRect(width * inset, height * inset,
+                                                                width * (1 - inset),
+                                                                height * (1 - inset)),
+                        },
+                .source =
+                        PixelSource{
+                                .solidColor = half3(0.2f, 0.2f, 0.2f),
+                        },
+                .alpha = half(0.3f),
+                .backgroundBlurRadius = 30 + i * 30,
+        });
+    }
+    benchDrawLayers(*re, layers, benchState, "homescreen_blur_stack");
+}
+
+/**
+ * Draw a full screen PQ layer on an SDR display, which tonemaps it with a LinearEffect.
+ */
+template <class... Args>
+void BM_homescreen_hdr(benchmark::State& benchState, Args&&... args) {
+    auto re = createRenderEngine(std::make_tuple(std::move(args)...));
+
+    auto [width, height] = getDisplaySize();
+    auto srcBuffer = createTexture(*re, kHomescreenPath);
+
+    LayerSettings layer{
+            .geometry =
+                    Geometry{
+                            .boundaries = FloatRect(0, 0, width, height),
+                    },
+            .source =
+                    PixelSource{
+                            .buffer =
+                                    Buffer{
+                                            .buffer = srcBuffer,
+                                    },
+                    },
+            .alpha = half(1.0f),
+            .sourceDataspace = ui::Dataspace::BT2020_ITU_PQ,
+    };
+    auto layers = std::vector<LayerSettings>{layer};
+    benchDrawLayers(*re, layers, benchState, "homescreen_hdr");
+}
+
+/**
+ * Draw the homescreen from a protected buffer into a protected output, as for DRM video.
+ */
+template <class... Args>
+void BM_homescreen_protected(benchmark::State& benchState, Args&&... args) {
+    auto re = createRenderEngine(std::make_tuple(std::move(args)...));
+    if (!re->supportsProtectedContent()) {
+        benchState.SkipWithError("Protected content is not supported");
+        return;
+    }
+
+    auto [width, height] = getDisplaySize();
+    auto srcBuffer = createTexture(*re, kHomescreenPath);
+    srcBuffer = copyBuffer(*re, srcBuffer, GRALLOC_USAGE_PROTECTED, "protected_source");
+
+    LayerSettings layer{
+            .geometry =
+                    Geometry{
+                            .boundaries = FloatRect(0, 0, width, height),
+                    },
+            .source =
+                    PixelSource{
+                            .buffer =
+                                    Buffer{
+                                            .buffer = srcBuffer,
+                                    },
+                    },
+            .alpha = half(1.0f),
+    };
+    auto layers = std::vector<LayerSettings>{layer};
+
+    const Rect displayRect(0, 0, static_cast<int32_t>(width), static_cast<int32_t>(height));
+    DisplaySettings display{
+            .physicalDisplay = displayRect,
+            .clip = displayRect,
+            .maxLuminance = 500,
+    };
+    benchDrawLayers(*re, layers, display,
+                    allocateBuffer(*re, width, height, GRALLOC_USAGE_PROTECTED), benchState,
+                    nullptr);
+}
+
+/**
+ * Capture the homescreen, with an HDR layer on top that is tonemapped locally with MouriMap,
+ * into a buffer scaled down by the benchmark's argument.
+ */
+template <class... Args>
+void BM_screenshot(benchmark::State& benchState, Args&&... args) {
+    auto re = createRenderEngine(std::make_tuple(std::move(args)...));
+
+    auto [width, height] = getDisplaySize();
+    auto srcBuffer = createTexture(*re, kHomescreenPath);
+
+    const FloatRect layerRect(0, 0, width, height);
+    LayerSettings layer{
+            .geometry =
+                    Geometry{
+                            .boundaries = layerRect,
+                    },
+            .source =
+                    PixelSource{
+                            .buffer =
+                                    Buffer{
+                                            .buffer = srcBuffer,
+                                    },
+                    },
+            .alpha = half(1.0f),
+    };
+    LayerSettings hdrLayer = layer;
+    hdrLayer.geometry.boundaries = FloatRect(0, 0, width, height / 2);
+    hdrLayer.sourceDataspace = ui::Dataspace::BT2020_ITU_PQ;
+    auto layers = std::vector<LayerSettings>{layer, hdrLayer};
+
+    const auto scale = static_cast<uint32_t>(benchState.range(0));
+    const uint32_t outputWidth = width / scale;
+    const uint32_t outputHeight = height / scale;
+    DisplaySettings display{
+            .physicalDisplay = Rect(0, 0, static_cast<int32_t>(outputWidth),
+                                    static_cast<int32_t>(outputHeight)),
+            .clip = Rect(0, 0, static_cast<int32_t>(width), static_cast<int32_t>(height)),
+            .maxLuminance = 500,
+            .tonemapStrategy = DisplaySettings::TonemapStrategy::Local,
+            .isScreenshot = true,
+    };
+    benchDrawLayers(*re, layers, display, allocateBuffer(*re, outputWidth, outputHeight),
+                    benchState, "screenshot");
+}
+
+// Registers a benchmark for each backend, named after it.
+#define BENCHMARK_BACKENDS(func, ...)                                                      \
+    BENCHMARK_CAPTURE(func, SkiaGLThreaded, RenderEngine::Threaded::YES,                   \
+                      RenderEngine::GraphicsApi::GL, RenderEngine::SkiaBackend::GANESH)    \
+            __VA_ARGS__;                                                                   \
+    BENCHMARK_CAPTURE(func, SkiaVkThreaded, RenderEngine::Threaded::YES,                   \
+                      RenderEngine::GraphicsApi::VK, RenderEngine::SkiaBackend::GANESH)    \
+            __VA_ARGS__;                                                                   \
+    BENCHMARK_CAPTURE(func, GraphiteVkThreaded, RenderEngine::Threaded::YES,               \
+                      RenderEngine::GraphicsApi::VK, RenderEngine::SkiaBackend::GRAPHITE)  \
+            __VA_ARGS__
+
 BENCHMARK_CAPTURE(BM_homescreen_blur, gaussian, RenderEngine::Threaded::YES,
-                  RenderEngine::GraphicsApi::GL, RenderEngine::BlurAlgorithm::GAUSSIAN);
+                  RenderEngine::GraphicsApi::GL, RenderEngine::SkiaBackend::GANESH,
+                  RenderEngine::BlurAlgorithm::GAUSSIAN);
 
 BENCHMARK_CAPTURE(BM_homescreen_blur, kawase, RenderEngine::Threaded::YES,
-                  RenderEngine::GraphicsApi::GL, RenderEngine::BlurAlgorithm::KAWASE);
+                  RenderEngine::GraphicsApi::GL, RenderEngine::SkiaBackend::GANESH,
+                  RenderEngine::BlurAlgorithm::KAWASE);
 
 BENCHMARK_CAPTURE(BM_homescreen_blur, kawase_dual_filter, RenderEngine::Threaded::YES,
-                  RenderEngine::GraphicsApi::GL, RenderEngine::BlurAlgorithm::KAWASE_DUAL_FILTER);
-
-BENCHMARK_CAPTURE(BM_homescreen, SkiaGLThreaded, RenderEngine::Threaded::YES,
-                  RenderEngine::GraphicsApi::GL);
-
-BENCHMARK_CAPTURE(BM_homescreen_edgeExtension, SkiaGLThreaded, RenderEngine::Threaded::YES,
-                  RenderEngine::GraphicsApi::GL);
+                  RenderEngine::GraphicsApi::GL, RenderEngine::SkiaBackend::GANESH,
+                  RenderEngine::BlurAlgorithm::KAWASE_DUAL_FILTER);
+
+BENCHMARK_BACKENDS(BM_homescreen);
+BENCHMARK_BACKENDS(BM_homescreen_edgeExtension);
+BENCHMARK_BACKENDS(BM_homescreen_layers, ->Arg(2)->Arg(4)->Arg(8));
+BENCHMARK_BACKENDS(BM_homescreen_blurStack);
+BENCHMARK_BACKENDS(BM_homescreen_hdr);
+BENCHMARK_BACKENDS(BM_homescreen_protected);
+BENCHMARK_BACKENDS(BM_screenshot, ->Arg(1)->Arg(2)->Arg(4));
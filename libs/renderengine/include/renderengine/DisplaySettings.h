@@ -50,6 +50,11 @@ struct DisplaySettings {
     // z=1.
     Rect clip = Rect::INVALID_RECT;
 
+    // Rectangle of the buffer which needs to be redrawn, in the same space as
+    // physicalDisplay. The rest of the buffer keeps its previous contents. If
+    // invalid, the whole buffer is redrawn.
+    Rect damage = Rect::INVALID_RECT;
+
     // Maximum luminance pulled from the display's HDR capabilities.
     float maxLuminance = 1.0f;
 
@@ -105,11 +110,16 @@ struct DisplaySettings {
 
     // For now, meaningful primarily when the TonemappingStrategy is Local
     float targetHdrSdrRatio = 1.f;
+
+    // True if the output buffer is a screenshot rather than a buffer presented on a display.
+    // The threaded RenderEngine lets draws for displays run ahead of screenshots.
+    bool isScreenshot = false;
 };
 
 static inline bool operator==(const DisplaySettings& lhs, const DisplaySettings& rhs) {
     return lhs.namePlusId == rhs.namePlusId && lhs.physicalDisplay == rhs.physicalDisplay &&
-            lhs.clip == rhs.clip && lhs.maxLuminance == rhs.maxLuminance &&
+            lhs.clip == rhs.clip && lhs.damage == rhs.damage &&
+            lhs.maxLuminance == rhs.maxLuminance &&
             lhs.currentLuminanceNits == rhs.currentLuminanceNits &&
             lhs.outputDataspace == rhs.outputDataspace &&
             lhs.colorTransform == rhs.colorTransform &&
@@ -148,6 +158,8 @@ static inline void PrintTo(const DisplaySettings& settings, ::std::ostream* os)
     PrintTo(settings.physicalDisplay, os);
     *os << "\n    .clip = ";
     PrintTo(settings.clip, os);
+    *os << "\n    .damage = ";
+    PrintTo(settings.damage, os);
     *os << "\n    .maxLuminance = " << settings.maxLuminance;
     *os << "\n    .currentLuminanceNits = " << settings.currentLuminanceNits;
     *os << "\n    .outputDataspace = ";
@@ -54,6 +54,21 @@
  */
 #define PROPERTY_DEBUG_RENDERENGINE_BLUR_ALGORITHM "debug.renderengine.blur_algorithm"
 
+/**
+ * The number of frames for which the local tonemapper reuses the luminance map of a layer drawn
+ * for a display. 1, the default, recomputes it every frame; larger values trade tonemapping
+ * accuracy on changing content for less GPU work. Screenshots always recompute it.
+ */
+#define PROPERTY_DEBUG_RENDERENGINE_LOCAL_TONEMAP_REFRESH_FRAMES \
+    "debug.renderengine.local_tonemap_refresh_frames"
+
+/**
+ * Draws screenshots, including region sampling, on a lower priority Vulkan queue than display
+ * composition, if the GPU has a second graphics queue. Off by default: buffers drawn into a
+ * screenshot are then imported on every screenshot instead of reusing the display's textures.
+ */
+#define PROPERTY_DEBUG_RENDERENGINE_BACKGROUND_QUEUE "debug.renderengine.background_queue"
+
 /**
  * Allows recording of Skia drawing commands with systrace.
  */
@@ -182,6 +197,10 @@ public:
     // so that it can configure its internal caches accordingly.
     virtual void onActiveDisplaySizeChanged(ui::Size size) = 0;
 
+    // Notify RenderEngine that a display was removed, so that it can drop what it keeps for
+    // drawing that display. displayNamePlusId is the DisplaySettings::namePlusId of the display.
+    virtual void onDisplayRemoved(const std::string& displayNamePlusId) = 0;
+
     // Renders layers for a particular display via GPU composition. This method
     // should be called for every display that needs to be rendered via the GPU.
     // @param display The display-wide settings that should be applied prior to
@@ -64,6 +64,7 @@ public:
     MOCK_METHOD0(getContextPriority, int());
     MOCK_METHOD0(supportsBackgroundBlur, bool());
     MOCK_METHOD1(onActiveDisplaySizeChanged, void(ui::Size));
+    MOCK_METHOD1(onDisplayRemoved, void(const std::string&));
 
 protected:
     // mock renderengine still needs to implement these, but callers should never need to call them.
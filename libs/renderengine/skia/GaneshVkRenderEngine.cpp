@@ -51,8 +51,9 @@ static void unref_semaphore(void* semaphore) {
 }
 
 std::unique_ptr<SkiaGpuContext> GaneshVkRenderEngine::createContext(
-        VulkanInterface& vulkanInterface) {
-    return SkiaGpuContext::MakeVulkan_Ganesh(vulkanInterface.getGaneshBackendContext(),
+        VulkanInterface& vulkanInterface, bool backgroundQueue) {
+    return SkiaGpuContext::MakeVulkan_Ganesh(vulkanInterface.getGaneshBackendContext(
+                                                     backgroundQueue),
                                              mSkSLCacheMonitor);
 }
 
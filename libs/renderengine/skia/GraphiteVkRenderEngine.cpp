@@ -61,8 +61,9 @@ static void unref_semaphore(void* semaphore, skgpu::CallbackResult result) {
 }
 
 std::unique_ptr<SkiaGpuContext> GraphiteVkRenderEngine::createContext(
-        VulkanInterface& vulkanInterface) {
-    return SkiaGpuContext::MakeVulkan_Graphite(vulkanInterface.getGraphiteBackendContext());
+        VulkanInterface& vulkanInterface, bool backgroundQueue) {
+    return SkiaGpuContext::MakeVulkan_Graphite(
+            vulkanInterface.getGraphiteBackendContext(backgroundQueue));
 }
 
 void GraphiteVkRenderEngine::waitFence(SkiaGpuContext*, base::borrowed_fd fenceFd) {
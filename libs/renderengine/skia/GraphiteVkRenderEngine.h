@@ -27,7 +27,8 @@ public:
     static std::unique_ptr<GraphiteVkRenderEngine> create(const RenderEngineCreationArgs& args);
 
 protected:
-    std::unique_ptr<SkiaGpuContext> createContext(VulkanInterface& vulkanInterface) override;
+    std::unique_ptr<SkiaGpuContext> createContext(VulkanInterface& vulkanInterface,
+                                                  bool backgroundQueue) override;
     void waitFence(SkiaGpuContext* context, base::borrowed_fd fenceFd) override;
     base::unique_fd flushAndSubmit(SkiaGpuContext* context, sk_sp<SkSurface> dstSurface) override;
 
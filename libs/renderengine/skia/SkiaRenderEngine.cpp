@@ -49,6 +49,8 @@
 #include <SkString.h>
 #include <SkSurface.h>
 #include <SkTileMode.h>
+#include <android-base/properties.h>
+#include <android-base/scopeguard.h>
 #include <android-base/stringprintf.h>
 #include <common/FlagManager.h>
 #include <common/trace.h>
@@ -64,10 +66,13 @@
 #include <ui/DebugUtils.h>
 #include <ui/GraphicBuffer.h>
 #include <ui/HdrRenderTypeUtils.h>
+#include <utils/Timers.h>
 
+#include <algorithm>
 #include <cmath>
 #include <cstdint>
 #include <deque>
+#include <iterator>
 #include <memory>
 #include <numeric>
 
@@ -263,9 +268,8 @@ std::future<void> SkiaRenderEngine::primeCache(PrimeCacheConfig config) {
 }
 
 sk_sp<SkData> SkiaRenderEngine::SkSLCacheMonitor::load(const SkData& key) {
-    // This "cache" does not actually cache anything. It just allows us to
-    // monitor Skia's internal cache. So this method always returns null.
-    return nullptr;
+    const auto it = mCache.find(std::string(static_cast<const char*>(key.data()), key.size()));
+    return it == mCache.end() ? nullptr : it->second;
 }
 
 void SkiaRenderEngine::SkSLCacheMonitor::store(const SkData& key, const SkData& data,
@@ -273,6 +277,13 @@ void SkiaRenderEngine::SkSLCacheMonitor::store(const SkData& key, const SkData&
     mShadersCachedSinceLastCall++;
     mTotalShadersCompiled++;
     SFTRACE_FORMAT("SF cache: %i shaders", mTotalShadersCompiled);
+
+    auto& entry = mCache[std::string(static_cast<const char*>(key.data()), key.size())];
+    if (entry) {
+        mCachedBytes -= entry->size();
+    }
+    entry = SkData::MakeWithCopy(data.data(), data.size());
+    mCachedBytes += data.size();
 }
 
 int SkiaRenderEngine::reportShadersCompiled() {
@@ -309,6 +320,10 @@ SkiaRenderEngine::SkiaRenderEngine(Threaded threaded, PixelFormat pixelFormat,
     }
 
     mCapture = std::make_unique<SkiaCapture>();
+
+    const int localTonemapRefreshFrames =
+            base::GetIntProperty(PROPERTY_DEBUG_RENDERENGINE_LOCAL_TONEMAP_REFRESH_FRAMES, 1);
+    mLocalTonemapRefreshInterval = static_cast<uint32_t>(std::max(1, localTonemapRefreshFrames));
 }
 
 SkiaRenderEngine::~SkiaRenderEngine() { }
@@ -330,6 +345,7 @@ void SkiaRenderEngine::finishRenderingAndAbandonContexts() {
     // ~SkiaGpuContext must be called before GPU API contexts are torn down.
     mContext.reset();
     mProtectedContext.reset();
+    mBackgroundContext.reset();
 }
 
 void SkiaRenderEngine::useProtectedContext(bool useProtectedContext) {
@@ -356,7 +372,10 @@ void SkiaRenderEngine::useProtectedContext(bool useProtectedContext) {
 }
 
 SkiaGpuContext* SkiaRenderEngine::getActiveContext() {
-    return mInProtectedContext ? mProtectedContext.get() : mContext.get();
+    if (mInProtectedContext) {
+        return mProtectedContext.get();
+    }
+    return mInBackgroundContext ? mBackgroundContext.get() : mContext.get();
 }
 
 static float toDegrees(uint32_t transform) {
@@ -411,6 +430,7 @@ void SkiaRenderEngine::ensureContextsCreated() {
     }
 
     std::tie(mContext, mProtectedContext) = createContexts();
+    mBackgroundContext = createBackgroundContext();
 }
 
 void SkiaRenderEngine::mapExternalTextureBuffer(const sp<GraphicBuffer>& buffer,
@@ -437,23 +457,46 @@ void SkiaRenderEngine::mapExternalTextureBuffer(const sp<GraphicBuffer>& buffer,
     // If we were to support caching protected buffers then we will need to switch the
     // currently bound context if we are not already using the protected context (and subsequently
     // switch back after the buffer is cached).
-    auto context = getActiveContext();
-    auto& cache = mTextureCache;
-
     std::lock_guard<std::mutex> lock(mRenderingMutex);
     mGraphicBufferExternalRefs[buffer->getId()]++;
 
-    if (const auto& iter = cache.find(buffer->getId()); iter == cache.end()) {
+    if (const auto& iter = mTextureCache.find(buffer->getId()); iter == mTextureCache.end()) {
         if (FlagManager::getInstance().renderable_buffer_usage()) {
             isRenderable = buffer->getUsage() & GRALLOC_USAGE_HW_RENDER;
         }
-        std::unique_ptr<SkiaBackendTexture> backendTexture =
-                context->makeBackendTexture(buffer->toAHardwareBuffer(), isRenderable);
-        auto imageTextureRef =
-                std::make_shared<AutoBackendTexture::LocalRef>(std::move(backendTexture),
-                                                               mTextureCleanupMgr);
-        cache.insert({buffer->getId(), imageTextureRef});
+        cacheTexture(buffer->getId(), importBuffer(buffer, isRenderable, /*duringDraw=*/false));
+    }
+}
+
+std::shared_ptr<AutoBackendTexture::LocalRef> SkiaRenderEngine::importBuffer(
+        const sp<GraphicBuffer>& buffer, bool isRenderable, bool duringDraw) {
+    const nsecs_t start = systemTime();
+    std::unique_ptr<SkiaBackendTexture> backendTexture =
+            getActiveContext()->makeBackendTexture(buffer->toAHardwareBuffer(), isRenderable);
+    const nsecs_t duration = systemTime() - start;
+
+    mTextureImportStats.imports++;
+    if (duringDraw) mTextureImportStats.importsDuringDraw++;
+    mTextureImportStats.totalImportTime += duration;
+    mTextureImportStats.maxImportTime = std::max(mTextureImportStats.maxImportTime, duration);
+
+    return std::make_shared<AutoBackendTexture::LocalRef>(std::move(backendTexture),
+                                                          mTextureCleanupMgr);
+}
+
+void SkiaRenderEngine::cacheTexture(uint64_t bufferId,
+                                    std::shared_ptr<AutoBackendTexture::LocalRef> texture) {
+    if (mTextureCache.size() >= kMaxTextureCacheSize) {
+        const auto leastRecentlyUsed =
+                std::min_element(mTextureCache.begin(), mTextureCache.end(),
+                                 [](const auto& lhs, const auto& rhs) {
+                                     return lhs.second.lastUse < rhs.second.lastUse;
+                                 });
+        mTextureCache.erase(leastRecentlyUsed);
+        mTextureImportStats.evictions++;
     }
+    mTextureCache.insert(
+            {bufferId, CachedTexture{std::move(texture), ++mTextureCacheUseCount}});
 }
 
 void SkiaRenderEngine::unmapExternalTextureBuffer(sp<GraphicBuffer>&& buffer) {
@@ -496,16 +539,26 @@ void SkiaRenderEngine::unmapExternalTextureBuffer(sp<GraphicBuffer>&& buffer) {
 
 std::shared_ptr<AutoBackendTexture::LocalRef> SkiaRenderEngine::getOrCreateBackendTexture(
         const sp<GraphicBuffer>& buffer, bool isOutputBuffer) {
-    // Do not lookup the buffer in the cache for protected contexts
-    if (!isProtected()) {
+    // Do not lookup the buffer in the cache for protected or background contexts
+    if (!isProtected() && !mInBackgroundContext) {
         if (const auto& it = mTextureCache.find(buffer->getId()); it != mTextureCache.end()) {
-            return it->second;
+            it->second.lastUse = ++mTextureCacheUseCount;
+            mTextureImportStats.cacheHits++;
+            return it->second.texture;
+        }
+
+        // A mapped buffer that is not cached was evicted, so cache it again rather than importing
+        // it on every draw.
+        const bool isProtectedBuffer = buffer->getUsage() & GRALLOC_USAGE_PROTECTED;
+        if (mGraphicBufferExternalRefs.contains(buffer->getId()) && !isProtectedBuffer) {
+            const bool isRenderable =
+                    isOutputBuffer || (buffer->getUsage() & GRALLOC_USAGE_HW_RENDER);
+            auto texture = importBuffer(buffer, isRenderable, /*duringDraw=*/true);
+            cacheTexture(buffer->getId(), texture);
+            return texture;
         }
     }
-    std::unique_ptr<SkiaBackendTexture> backendTexture =
-            getActiveContext()->makeBackendTexture(buffer->toAHardwareBuffer(), isOutputBuffer);
-    return std::make_shared<AutoBackendTexture::LocalRef>(std::move(backendTexture),
-                                                          mTextureCleanupMgr);
+    return importBuffer(buffer, isOutputBuffer, /*duringDraw=*/true);
 }
 
 bool SkiaRenderEngine::canSkipPostRenderCleanup() const {
@@ -562,8 +615,17 @@ sk_sp<SkShader> SkiaRenderEngine::createRuntimeEffectShader(
             const float inputRatio =
                     hdrType == HdrRenderType::GENERIC_HDR ? 1.0f : parameters.layerDimmingRatio;
             static MouriMap kMapper;
-            shader = kMapper.mouriMap(getActiveContext(), shader, inputRatio,
-                                      parameters.display.targetHdrSdrRatio);
+            if (parameters.display.isScreenshot) {
+                shader = kMapper.mouriMap(getActiveContext(), shader, inputRatio,
+                                          parameters.display.targetHdrSdrRatio);
+            } else {
+                shader = kMapper.mouriMap(getActiveContext(), shader, inputRatio,
+                                          parameters.display.targetHdrSdrRatio,
+                                          {.key = parameters.display.namePlusId + '/' +
+                                                   parameters.layer.name,
+                                           .frameNumber = mFrameNumber,
+                                           .refreshInterval = mLocalTonemapRefreshInterval});
+            }
         }
 
         // disable tonemapping if we already locally tonemapped
@@ -725,11 +787,20 @@ void SkiaRenderEngine::drawLayersInternal(
     }
 
     validateOutputBufferUsage(buffer->getBuffer());
+    mFrameNumber++;
+
+    // Screenshots go to the background queue, so that the GPU can run the composition of displays
+    // ahead of them. Buffers are shared through their fences, which both queues wait on and signal.
+    mInBackgroundContext = display.isScreenshot && !isProtected() && mBackgroundContext;
+    const auto leaveBackgroundContext =
+            base::make_scope_guard([this] { mInBackgroundContext = false; });
 
     auto context = getActiveContext();
     LOG_ALWAYS_FATAL_IF(context->isAbandonedOrDeviceLost(),
                         "Context is abandoned/device lost at start of %s", __func__);
 
+    const int shadersCompiledBefore = mSkSLCacheMonitor.totalShadersCompiled();
+
     // any AutoBackendTexture deletions will now be deferred until cleanupPostRender is called
     DeferTextureCleanup dtc(mTextureCleanupMgr);
 
@@ -798,6 +869,10 @@ void SkiaRenderEngine::drawLayersInternal(
     }
 
     AutoSaveRestore surfaceAutoSaveRestore(canvas);
+    // Only the damaged part of the buffer is redrawn, the rest already holds the same content.
+    if (display.damage.isValid() && !blurCompositionLayer) {
+        canvas->clipRect(getSkRect(display.damage));
+    }
     // Clear the entire canvas with a transparent black to prevent ghost images.
     canvas->clear(SK_ColorTRANSPARENT);
     initCanvas(canvas, display);
@@ -901,8 +976,9 @@ void SkiaRenderEngine::drawLayersInternal(
             if (blurRect.width() > 0 && blurRect.height() > 0) {
                 if (layer.backgroundBlurRadius > 0) {
                     SFTRACE_NAME("BackgroundBlur");
-                    auto blurredImage = mBlurFilter->generate(context, layer.backgroundBlurRadius,
-                                                              blurInput, blurRect);
+                    auto blurredImage =
+                            generateBlur(context, display, layers, &layer - layers.data(),
+                                         layer.backgroundBlurRadius, blurInput, blurRect);
 
                     cachedBlurs[layer.backgroundBlurRadius] = blurredImage;
 
@@ -915,8 +991,8 @@ void SkiaRenderEngine::drawLayersInternal(
                     if (cachedBlurs[region.blurRadius] == nullptr) {
                         SFTRACE_NAME("BlurRegion");
                         cachedBlurs[region.blurRadius] =
-                                mBlurFilter->generate(context, region.blurRadius, blurInput,
-                                                      blurRect);
+                                generateBlur(context, display, layers, &layer - layers.data(),
+                                             region.blurRadius, blurInput, blurRect);
                     }
 
                     mBlurFilter->drawBlurRegion(canvas, getBlurRRect(region), region.blurRadius,
@@ -1165,11 +1241,13 @@ void SkiaRenderEngine::drawLayersInternal(
                         mat4::scale(vec4(gammaCorrectedDimmingRatio, gammaCorrectedDimmingRatio,
                                          gammaCorrectedDimmingRatio, 1.f));
 
-                const auto colorFilter =
-                        SkColorFilters::Matrix(toSkColorMatrix(std::move(dimmingMatrix)));
-                paint.setColorFilter(displayColorTransform
-                                             ? displayColorTransform->makeComposed(colorFilter)
-                                             : colorFilter);
+                // Fold the dimming into the display's color transform, so that a single color
+                // matrix applies both instead of composing two filters.
+                if (displayColorTransform) {
+                    dimmingMatrix = display.colorTransform * dimmingMatrix;
+                }
+                paint.setColorFilter(
+                        SkColorFilters::Matrix(toSkColorMatrix(std::move(dimmingMatrix))));
             } else {
                 paint.setColorFilter(displayColorTransform);
             }
@@ -1199,11 +1277,75 @@ void SkiaRenderEngine::drawLayersInternal(
     mCapture->endCapture();
 
     LOG_ALWAYS_FATAL_IF(activeSurface != dstSurface);
+    // Only the blurs of this frame may be reused by the next one drawn for the same display.
+    if (!mInBackgroundContext) {
+        mCachedBlurs.erase(std::remove_if(mCachedBlurs.begin(), mCachedBlurs.end(),
+                                          [&](const CachedBlur& blur) {
+                                              return blur.display.namePlusId ==
+                                                      display.namePlusId;
+                                          }),
+                           mCachedBlurs.end());
+        std::move(mNextCachedBlurs.begin(), mNextCachedBlurs.end(),
+                  std::back_inserter(mCachedBlurs));
+        mNextCachedBlurs.clear();
+    }
+
+    const nsecs_t flushStartTime = systemTime();
     auto drawFence = sp<Fence>::make(flushAndSubmit(context, dstSurface));
+    // Ganesh builds the programs it is missing while flushing, so the flush time of a frame
+    // that compiled shaders is a good estimate of how long the frame was stalled by it.
+    if (mSkSLCacheMonitor.totalShadersCompiled() != shadersCompiledBefore) {
+        mFramesCompilingShaders++;
+        mShaderCompileStallTime += systemTime() - flushStartTime;
+    }
     trace(drawFence);
     resultPromise->set_value(std::move(drawFence));
 }
 
+sk_sp<SkImage> SkiaRenderEngine::generateBlur(SkiaGpuContext* context,
+                                              const DisplaySettings& display,
+                                              const std::vector<LayerSettings>& layers,
+                                              size_t layerIndex, uint32_t blurRadius,
+                                              const sk_sp<SkImage>& blurInput,
+                                              const SkRect& blurRect) {
+    // Blurs are only cached for the display context, which they were generated in.
+    if (!FlagManager::getInstance().cache_blur_output() || mInBackgroundContext) {
+        return mBlurFilter->generate(context, blurRadius, blurInput, blurRect);
+    }
+
+    // The damage only says which part of the buffer is redrawn, and doesn't change what the
+    // layers look like.
+    DisplaySettings cachedDisplay = display;
+    cachedDisplay.damage = Rect::INVALID_RECT;
+
+    const auto it = std::find_if(mCachedBlurs.begin(), mCachedBlurs.end(), [&](const auto& blur) {
+        return blur.blurRadius == blurRadius && blur.blurRect == blurRect &&
+                blur.isProtected == mInProtectedContext &&
+                blur.inputInfo == blurInput->imageInfo() && blur.display == cachedDisplay &&
+                std::equal(blur.layersBelow.begin(), blur.layersBelow.end(), layers.begin(),
+                           layers.begin() + layerIndex);
+    });
+    if (it != mCachedBlurs.end()) {
+        SFTRACE_NAME("CachedBlur");
+        auto image = it->image;
+        mNextCachedBlurs.push_back(std::move(*it));
+        mCachedBlurs.erase(it);
+        return image;
+    }
+
+    auto image = mBlurFilter->generate(context, blurRadius, blurInput, blurRect);
+    mNextCachedBlurs.push_back({.display = std::move(cachedDisplay),
+                                .layersBelow = std::vector<LayerSettings>(layers.begin(),
+                                                                          layers.begin() +
+                                                                                  layerIndex),
+                                .inputInfo = blurInput->imageInfo(),
+                                .blurRect = blurRect,
+                                .blurRadius = blurRadius,
+                                .isProtected = mInProtectedContext,
+                                .image = image});
+    return image;
+}
+
 void SkiaRenderEngine::drawGainmapInternal(
         const std::shared_ptr<std::promise<FenceResult>>&& resultPromise,
         const std::shared_ptr<ExternalTexture>& sdr, base::borrowed_fd&& sdrFence,
@@ -1257,6 +1399,12 @@ void SkiaRenderEngine::drawShadow(SkCanvas* canvas,
                                   const SkRRect& casterRRect,
                                   const ShadowSettings& settings) {
     SFTRACE_CALL();
+    // There is no separate cache for the shadow's geometry here. SkShadowUtils already caches
+    // the tessellation of a caster path, and the GPU backends draw shadows of rrects
+    // analytically, so replaying a recorded picture would issue the same draw. Rendering the
+    // shadow into a cached mask doesn't pay off either, since blitting the mask covers the
+    // caster too. Layers that stay unchanged across frames are flattened into a cached buffer
+    // by CompositionEngine's planner instead.
     const float casterZ = settings.length / 2.0f;
     const auto flags =
             settings.casterIsTranslucent ? kTransparentOccluder_ShadowFlag : kNone_ShadowFlag;
@@ -1267,6 +1415,15 @@ void SkiaRenderEngine::drawShadow(SkCanvas* canvas,
                               flags);
 }
 
+void SkiaRenderEngine::onDisplayRemoved(const std::string& displayNamePlusId) {
+    // The blurs of a display are otherwise only replaced when the display draws its next frame.
+    mCachedBlurs.erase(std::remove_if(mCachedBlurs.begin(), mCachedBlurs.end(),
+                                      [&](const CachedBlur& blur) {
+                                          return blur.display.namePlusId == displayNamePlusId;
+                                      }),
+                       mCachedBlurs.end());
+}
+
 void SkiaRenderEngine::onActiveDisplaySizeChanged(ui::Size size) {
     // This cache multiplier was selected based on review of cache sizes relative
     // to the screen resolution. Looking at the worst case memory needed by blur (~1.5x),
@@ -1286,6 +1443,10 @@ void SkiaRenderEngine::onActiveDisplaySizeChanged(ui::Size size) {
         // reset back to the initial context that was active when this method was called
         useProtectedContext(originalProtectedState);
     }
+
+    if (mBackgroundContext) {
+        mBackgroundContext->setResourceCacheLimit(maxResourceBytes);
+    }
 }
 
 void SkiaRenderEngine::dump(std::string& result) {
@@ -1296,8 +1457,14 @@ void SkiaRenderEngine::dump(std::string& result) {
     StringAppendF(&result, "RenderEngine supports protected context: %d\n",
                   supportsProtectedContent());
     StringAppendF(&result, "RenderEngine is in protected context: %d\n", mInProtectedContext);
+    StringAppendF(&result, "RenderEngine draws screenshots in background context: %d\n",
+                  mBackgroundContext != nullptr);
     StringAppendF(&result, "RenderEngine shaders cached since last dump/primeCache: %d\n",
                   mSkSLCacheMonitor.shadersCachedSinceLastCall());
+    StringAppendF(&result, "RenderEngine cached programs: %zu bytes\n",
+                  mSkSLCacheMonitor.cachedBytes());
+    StringAppendF(&result, "RenderEngine frames compiling shaders: %d (%.2f ms flushing)\n",
+                  mFramesCompilingShaders, ns2us(mShaderCompileStallTime) / 1000.f);
 
     std::vector<ResourcePair> cpuResourceMap = {
             {"skia/sk_resource_cache/bitmap_", "Bitmaps"},
@@ -1335,8 +1502,17 @@ void SkiaRenderEngine::dump(std::string& result) {
         for (const auto& [id, refCounts] : mGraphicBufferExternalRefs) {
             StringAppendF(&result, "- 0x%" PRIx64 " - %d refs \n", id, refCounts);
         }
-        StringAppendF(&result, "RenderEngine AHB/BackendTexture cache size: %zu\n",
-                      mTextureCache.size());
+        StringAppendF(&result, "RenderEngine AHB/BackendTexture cache size: %zu (max %zu)\n",
+                      mTextureCache.size(), kMaxTextureCacheSize);
+        const auto& stats = mTextureImportStats;
+        const nsecs_t averageImportTime = stats.imports == 0
+                ? 0
+                : stats.totalImportTime / static_cast<nsecs_t>(stats.imports);
+        StringAppendF(&result,
+                      "Buffer imports: %" PRIu64 " (%" PRIu64 " during draw), cache hits: %" PRIu64
+                      ", evictions: %" PRIu64 ", import time avg: %.3f ms, max: %.3f ms\n",
+                      stats.imports, stats.importsDuringDraw, stats.cacheHits, stats.evictions,
+                      ns2us(averageImportTime) / 1000.f, ns2us(stats.maxImportTime) / 1000.f);
         StringAppendF(&result, "Dumping buffer ids...\n");
         // TODO(178539829): It would be nice to know which layer these are coming from and what
         // the texture sizes are.
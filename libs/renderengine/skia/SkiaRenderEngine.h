@@ -20,6 +20,7 @@
 #include <renderengine/RenderEngine.h>
 
 #include <android-base/thread_annotations.h>
+#include <include/core/SkData.h>
 #include <include/core/SkImageInfo.h>
 #include <include/core/SkSurface.h>
 #include <include/gpu/ganesh/GrBackendSemaphore.h>
@@ -30,6 +31,7 @@
 
 #include <memory>
 #include <mutex>
+#include <string>
 #include <unordered_map>
 
 #include "AutoBackendTexture.h"
@@ -68,6 +70,7 @@ public:
         return mBlurFilter != nullptr;
     }
     void onActiveDisplaySizeChanged(ui::Size size) override final;
+    void onDisplayRemoved(const std::string& displayNamePlusId) override final;
     int reportShadersCompiled();
 
     virtual void setEnableTracing(bool tracingEnabled) override final;
@@ -86,6 +89,10 @@ protected:
     // Functions that a given backend (GLES, Vulkan) must implement
     using Contexts = std::pair<unique_ptr<SkiaGpuContext>, unique_ptr<SkiaGpuContext>>;
     virtual Contexts createContexts() = 0;
+    // Returns a context that submits to a lower priority GPU queue than the unprotected context,
+    // or nullptr if the backend has none. Screenshots are drawn with it so that they don't delay
+    // the composition of displays.
+    virtual unique_ptr<SkiaGpuContext> createBackgroundContext() { return nullptr; }
     virtual bool supportsProtectedContentImpl() const = 0;
     virtual bool useProtectedContextImpl(GrProtected isProtected) = 0;
     virtual void waitFence(SkiaGpuContext* context, base::borrowed_fd fenceFd) = 0;
@@ -101,7 +108,9 @@ protected:
     bool isProtected() const { return mInProtectedContext; }
 
     // Implements PersistentCache as a way to monitor what SkSL shaders Skia has
-    // cached.
+    // cached. Stored programs are kept in memory for the lifetime of RenderEngine, so that a
+    // shader compiled by one context (e.g. while priming the cache) is not compiled again by
+    // the other one.
     class SkSLCacheMonitor : public GrContextOptions::PersistentCache {
     public:
         SkSLCacheMonitor() = default;
@@ -119,9 +128,14 @@ protected:
 
         int totalShadersCompiled() const { return mTotalShadersCompiled; }
 
+        size_t cachedBytes() const { return mCachedBytes; }
+
     private:
         int mShadersCachedSinceLastCall = 0;
         int mTotalShadersCompiled = 0;
+        // Keyed on the contents of the key Skia passes in.
+        std::unordered_map<std::string, sk_sp<SkData>> mCache;
+        size_t mCachedBytes = 0;
     };
 
     SkSLCacheMonitor mSkSLCacheMonitor;
@@ -134,9 +148,22 @@ private:
 
     std::shared_ptr<AutoBackendTexture::LocalRef> getOrCreateBackendTexture(
             const sp<GraphicBuffer>& buffer, bool isOutputBuffer) REQUIRES(mRenderingMutex);
+    // Imports the buffer into the active context and records how long it took. duringDraw is
+    // true for imports that the current draw waits for, i.e. that were not mapped ahead.
+    std::shared_ptr<AutoBackendTexture::LocalRef> importBuffer(const sp<GraphicBuffer>& buffer,
+                                                               bool isRenderable, bool duringDraw)
+            REQUIRES(mRenderingMutex);
+    void cacheTexture(uint64_t bufferId, std::shared_ptr<AutoBackendTexture::LocalRef> texture)
+            REQUIRES(mRenderingMutex);
     void initCanvas(SkCanvas* canvas, const DisplaySettings& display);
     void drawShadow(SkCanvas* canvas, const SkRRect& casterRRect,
                     const ShadowSettings& shadowSettings);
+    // Blurs blurInput, or returns the blur generated for the previous frame if the layers drawn
+    // below layers[layerIndex] and the region being blurred are the same.
+    sk_sp<SkImage> generateBlur(SkiaGpuContext* context, const DisplaySettings& display,
+                                const std::vector<LayerSettings>& layers, size_t layerIndex,
+                                uint32_t blurRadius, const sk_sp<SkImage>& blurInput,
+                                const SkRect& blurRect);
     void drawLayersInternal(const std::shared_ptr<std::promise<FenceResult>>&& resultPromise,
                             const DisplaySettings& display,
                             const std::vector<LayerSettings>& layers,
@@ -176,18 +203,61 @@ private:
     // Number of external holders of ExternalTexture references, per GraphicBuffer ID.
     std::unordered_map<GraphicBufferId, int32_t> mGraphicBufferExternalRefs
             GUARDED_BY(mRenderingMutex);
-    std::unordered_map<GraphicBufferId, std::shared_ptr<AutoBackendTexture::LocalRef>> mTextureCache
-            GUARDED_BY(mRenderingMutex);
+    struct CachedTexture {
+        std::shared_ptr<AutoBackendTexture::LocalRef> texture;
+        // The value of mTextureCacheUseCount when the texture was last used.
+        uint64_t lastUse = 0;
+    };
+    // The number of imported buffers kept in mTextureCache. When it is full, the least recently
+    // used texture is dropped. A dropped buffer that is still mapped is imported and cached again
+    // when it is next drawn.
+    static constexpr size_t kMaxTextureCacheSize = 256;
+    std::unordered_map<GraphicBufferId, CachedTexture> mTextureCache GUARDED_BY(mRenderingMutex);
+    uint64_t mTextureCacheUseCount GUARDED_BY(mRenderingMutex) = 0;
+
+    struct TextureImportStats {
+        uint64_t imports = 0;
+        // Imports of buffers that were not mapped before they were drawn.
+        uint64_t importsDuringDraw = 0;
+        uint64_t cacheHits = 0;
+        uint64_t evictions = 0;
+        nsecs_t totalImportTime = 0;
+        nsecs_t maxImportTime = 0;
+    };
+    TextureImportStats mTextureImportStats GUARDED_BY(mRenderingMutex);
     std::unordered_map<shaders::LinearEffect, sk_sp<SkRuntimeEffect>, shaders::LinearEffectHasher>
             mRuntimeEffects;
     AutoBackendTexture::CleanupManager mTextureCleanupMgr GUARDED_BY(mRenderingMutex);
 
     StretchShaderFactory mStretchShaderFactory;
     EdgeExtensionShaderFactory mEdgeExtensionShaderFactory;
+    // How many frames the local tonemapper reuses the luminance map of a layer for.
+    uint32_t mLocalTonemapRefreshInterval = 1;
+    // Numbers the frames drawn by drawLayersInternal, so that the local tonemapper counts frames
+    // rather than draws of a layer.
+    uint64_t mFrameNumber = 0;
 
     sp<Fence> mLastDrawFence;
     BlurFilter* mBlurFilter = nullptr;
 
+    // A blur generated while drawing layers, along with everything it was generated from.
+    struct CachedBlur {
+        DisplaySettings display;
+        std::vector<LayerSettings> layersBelow;
+        SkImageInfo inputInfo;
+        SkRect blurRect;
+        uint32_t blurRadius;
+        bool isProtected;
+        sk_sp<SkImage> image;
+    };
+    // Blurs generated for the last frame, and those generated so far for the current one.
+    std::vector<CachedBlur> mCachedBlurs;
+    std::vector<CachedBlur> mNextCachedBlurs;
+
+    // Number of frames that had to compile shaders, and the total time spent flushing them.
+    int mFramesCompilingShaders = 0;
+    nsecs_t mShaderCompileStallTime = 0;
+
     // Object to capture commands send to Skia.
     std::unique_ptr<SkiaCapture> mCapture;
 
@@ -200,6 +270,10 @@ private:
     // Same as above, but for protected content (eg. DRM)
     unique_ptr<SkiaGpuContext> mProtectedContext;
     bool mInProtectedContext = false;
+    // Same as mContext, but submitting to a lower priority queue. Textures imported into it are
+    // not cached, as they are only valid in the context they were imported into.
+    unique_ptr<SkiaGpuContext> mBackgroundContext;
+    bool mInBackgroundContext = false;
 };
 
 } // namespace skia
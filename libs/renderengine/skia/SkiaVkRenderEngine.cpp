@@ -31,6 +31,7 @@
 #include <include/gpu/ganesh/vk/GrVkDirectContext.h>
 #include <include/gpu/ganesh/vk/GrVkTypes.h>
 
+#include <android-base/properties.h>
 #include <android-base/stringprintf.h>
 #include <common/trace.h>
 #include <sync/sync.h>
@@ -47,9 +48,15 @@ namespace renderengine {
 static skia::VulkanInterface sVulkanInterface;
 static skia::VulkanInterface sProtectedContentVulkanInterface;
 
+// The background queue is only requested when screenshots are going to use it, so that devices
+// with the property off are created exactly as before.
+static bool sUseBackgroundQueue() {
+    return base::GetBoolProperty(PROPERTY_DEBUG_RENDERENGINE_BACKGROUND_QUEUE, false);
+}
+
 static void sSetupVulkanInterface() {
     if (!sVulkanInterface.isInitialized()) {
-        sVulkanInterface.init(false /* no protected content */);
+        sVulkanInterface.init(false /* no protected content */, sUseBackgroundQueue());
         // We will have to abort if non-protected VkDevice creation fails (then nothing works).
         LOG_ALWAYS_FATAL_IF(!sVulkanInterface.isInitialized(),
                             "Could not initialize Vulkan RenderEngine!");
@@ -70,7 +77,8 @@ bool RenderEngine::canSupport(GraphicsApi graphicsApi) {
             // Static local variables are initialized once, on first invocation of the function.
             static const bool canSupportVulkan = []() {
                 if (!sVulkanInterface.isInitialized()) {
-                    sVulkanInterface.init(false /* no protected content */);
+                    sVulkanInterface.init(false /* no protected content */,
+                                          sUseBackgroundQueue());
                     ALOGD("%s: initialized == %s.", __func__,
                           sVulkanInterface.isInitialized() ? "true" : "false");
                     if (!sVulkanInterface.isInitialized()) {
@@ -135,14 +143,23 @@ SkiaRenderEngine::Contexts SkiaVkRenderEngine::createContexts() {
     }
 
     SkiaRenderEngine::Contexts contexts;
-    contexts.first = createContext(sVulkanInterface);
+    contexts.first = createContext(sVulkanInterface, /*backgroundQueue=*/false);
     if (supportsProtectedContentImpl()) {
-        contexts.second = createContext(sProtectedContentVulkanInterface);
+        contexts.second = createContext(sProtectedContentVulkanInterface,
+                                        /*backgroundQueue=*/false);
     }
 
     return contexts;
 }
 
+std::unique_ptr<SkiaGpuContext> SkiaVkRenderEngine::createBackgroundContext() {
+    // The queue only exists if the property was set when the device was created.
+    if (!sVulkanInterface.hasBackgroundQueue()) {
+        return nullptr;
+    }
+    return createContext(sVulkanInterface, /*backgroundQueue=*/true);
+}
+
 bool SkiaVkRenderEngine::supportsProtectedContentImpl() const {
     return sProtectedContentVulkanInterface.isInitialized();
 }
@@ -173,6 +190,8 @@ void SkiaVkRenderEngine::appendBackendSpecificInfoToDump(std::string& result) {
     StringAppendF(&result, "\n Vulkan device initialized: %d\n", sVulkanInterface.isInitialized());
     StringAppendF(&result, "\n Vulkan protected device initialized: %d\n",
                   sProtectedContentVulkanInterface.isInitialized());
+    StringAppendF(&result, "\n Vulkan background queue: %d\n",
+                  sVulkanInterface.hasBackgroundQueue());
 
     if (!sVulkanInterface.isInitialized()) {
         return;
@@ -68,7 +68,8 @@ public:
     };
 
 protected:
-    virtual std::unique_ptr<SkiaGpuContext> createContext(VulkanInterface& vulkanInterface) = 0;
+    virtual std::unique_ptr<SkiaGpuContext> createContext(VulkanInterface& vulkanInterface,
+                                                          bool backgroundQueue) = 0;
     // Redeclare parent functions that Ganesh vs. Graphite subclasses must implement.
     virtual void waitFence(SkiaGpuContext* context, base::borrowed_fd fenceFd) override = 0;
     virtual base::unique_fd flushAndSubmit(SkiaGpuContext* context,
@@ -79,6 +80,7 @@ protected:
     // Implementations of abstract SkiaRenderEngine functions specific to
     // Vulkan, but shareable between Ganesh and Graphite.
     SkiaRenderEngine::Contexts createContexts() override;
+    std::unique_ptr<SkiaGpuContext> createBackgroundContext() override;
     bool supportsProtectedContentImpl() const override;
     bool useProtectedContextImpl(GrProtected isProtected) override;
     void appendBackendSpecificInfoToDump(std::string& result) override;
@@ -32,16 +32,18 @@ namespace android {
 namespace renderengine {
 namespace skia {
 
-VulkanBackendContext VulkanInterface::getGaneshBackendContext() {
-    return this->getGraphiteBackendContext();
+VulkanBackendContext VulkanInterface::getGaneshBackendContext(bool backgroundQueue) {
+    return this->getGraphiteBackendContext(backgroundQueue);
 };
 
-VulkanBackendContext VulkanInterface::getGraphiteBackendContext() {
+VulkanBackendContext VulkanInterface::getGraphiteBackendContext(bool backgroundQueue) {
+    LOG_ALWAYS_FATAL_IF(backgroundQueue && !hasBackgroundQueue(),
+                        "Requested a background queue context without a background queue");
     VulkanBackendContext backendContext;
     backendContext.fInstance = mInstance;
     backendContext.fPhysicalDevice = mPhysicalDevice;
     backendContext.fDevice = mDevice;
-    backendContext.fQueue = mQueue;
+    backendContext.fQueue = backgroundQueue ? mBackgroundQueue : mQueue;
     backendContext.fGraphicsQueueIndex = mQueueIndex;
     backendContext.fMaxAPIVersion = mApiVersion;
     backendContext.fVkExtensions = &mVulkanExtensions;
@@ -220,7 +222,7 @@ static skgpu::VulkanGetProc sGetProc = [](const char* proc_name,
     PFN_vk##F vk##F = (PFN_vk##F)vkGetDeviceProcAddr(device, "vk" #F); \
     CHECK_NONNULL(vk##F)
 
-void VulkanInterface::init(bool protectedContent) {
+void VulkanInterface::init(bool protectedContent, bool backgroundQueue) {
     if (isInitialized()) {
         ALOGW("Called init on already initialized VulkanInterface");
         return;
@@ -461,7 +463,16 @@ void VulkanInterface::init(bool protectedContent) {
         BAIL("Protected memory not supported");
     }
 
-    float queuePriorities[1] = {0.0f};
+    // Both queues are in the graphics queue family, so they share the global priority below. The
+    // background queue only gets a lower priority relative to the main queue, which lets the
+    // driver schedule composition ahead of screenshots. Without it, the single queue keeps its
+    // usual priority.
+    const bool createBackgroundQueue = backgroundQueue && !protectedContent &&
+            queueProps[graphicsQueueIndex].queueFamilyProperties.queueCount >= 2;
+    const float singleQueuePriorities[1] = {0.0f};
+    const float backgroundQueuePriorities[2] = {1.0f, 0.0f};
+    const float* queuePriorities =
+            createBackgroundQueue ? backgroundQueuePriorities : singleQueuePriorities;
     void* queueNextPtr = nullptr;
 
     VkDeviceQueueGlobalPriorityCreateInfoEXT queuePriorityCreateInfo = {
@@ -483,7 +494,7 @@ void VulkanInterface::init(bool protectedContent) {
             queueNextPtr,
             deviceQueueCreateFlags,
             (uint32_t)graphicsQueueIndex,
-            1,
+            createBackgroundQueue ? 2u : 1u,
             queuePriorities,
     };
 
@@ -512,6 +523,14 @@ void VulkanInterface::init(bool protectedContent) {
                                                  (uint32_t)graphicsQueueIndex, 0};
     vkGetDeviceQueue2(device, &deviceQueueInfo2, &graphicsQueue);
 
+    VkQueue backgroundQueue = VK_NULL_HANDLE;
+    if (createBackgroundQueue) {
+        const VkDeviceQueueInfo2 backgroundQueueInfo2 = {VK_STRUCTURE_TYPE_DEVICE_QUEUE_INFO_2,
+                                                         nullptr, deviceQueueCreateFlags,
+                                                         (uint32_t)graphicsQueueIndex, 1};
+        vkGetDeviceQueue2(device, &backgroundQueueInfo2, &backgroundQueue);
+    }
+
     VK_GET_DEV_PROC(device, DeviceWaitIdle);
     VK_GET_DEV_PROC(device, DestroyDevice);
     mFuncs.vkDeviceWaitIdle = vkDeviceWaitIdle;
@@ -532,6 +551,7 @@ void VulkanInterface::init(bool protectedContent) {
     mPhysicalDevice = physicalDevice;
     mDevice = device;
     mQueue = graphicsQueue;
+    mBackgroundQueue = backgroundQueue;
     mQueueIndex = graphicsQueueIndex;
     mApiVersion = physicalDeviceApiVersion;
     // grExtensions already constructed
@@ -591,6 +611,7 @@ void VulkanInterface::teardown() {
     mIsOwned = false;
     mPhysicalDevice = VK_NULL_HANDLE; // Implicitly destroyed by destroying mInstance.
     mQueue = VK_NULL_HANDLE;          // Implicitly destroyed by destroying mDevice.
+    mBackgroundQueue = VK_NULL_HANDLE; // Implicitly destroyed by destroying mDevice.
     mQueueIndex = 0;
     mApiVersion = 0;
     mVulkanExtensions = skgpu::VulkanExtensions();
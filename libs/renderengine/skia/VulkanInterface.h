@@ -37,7 +37,9 @@ public:
     VulkanInterface& operator=(const VulkanInterface&) = delete;
     VulkanInterface& operator=(VulkanInterface&&) = delete;
 
-    void init(bool protectedContent = false);
+    // If backgroundQueue is true and the graphics queue family has a second queue, the device is
+    // also created with a lower priority background queue. It is ignored for protected content.
+    void init(bool protectedContent = false, bool backgroundQueue = false);
     // Returns true and marks this VulkanInterface as "owned" if it is initialized but unused by any
     // RenderEngine instances. Returns false if already owned, indicating that it must not be used
     // by a new RE instance.
@@ -45,8 +47,10 @@ public:
     void teardown();
 
     // TODO(b/309785258) Combine these into one now that they are the same implementation.
-    VulkanBackendContext getGaneshBackendContext();
-    VulkanBackendContext getGraphiteBackendContext();
+    // If backgroundQueue is true, the context submits to the lower priority background queue,
+    // which must exist.
+    VulkanBackendContext getGaneshBackendContext(bool backgroundQueue = false);
+    VulkanBackendContext getGraphiteBackendContext(bool backgroundQueue = false);
     VkSemaphore createExportableSemaphore();
     VkSemaphore importSemaphoreFromSyncFd(int syncFd);
     int exportSemaphoreSyncFd(VkSemaphore semaphore);
@@ -54,6 +58,9 @@ public:
 
     bool isInitialized() const { return mInitialized; }
     bool isRealtimePriority() const { return mIsRealtimePriority; }
+    // True if the device was created with a second, lower priority queue in the graphics queue
+    // family, for work that the display's composition should not wait behind.
+    bool hasBackgroundQueue() const { return mBackgroundQueue != VK_NULL_HANDLE; }
     const std::vector<std::string>& getInstanceExtensionNames() { return mInstanceExtensionNames; }
     const std::vector<std::string>& getDeviceExtensionNames() { return mDeviceExtensionNames; }
 
@@ -81,6 +88,7 @@ private:
     VkPhysicalDevice mPhysicalDevice = VK_NULL_HANDLE;
     VkDevice mDevice = VK_NULL_HANDLE;
     VkQueue mQueue = VK_NULL_HANDLE;
+    VkQueue mBackgroundQueue = VK_NULL_HANDLE;
     int mQueueIndex = 0;
     uint32_t mApiVersion = 0;
     skgpu::VulkanExtensions mVulkanExtensions;
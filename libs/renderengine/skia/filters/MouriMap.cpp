@@ -19,6 +19,8 @@
 #include <SkPaint.h>
 #include <SkTileMode.h>
 
+#include <algorithm>
+
 namespace android {
 namespace renderengine {
 namespace skia {
@@ -96,6 +98,24 @@ const SkString kTonemap(R"(
     }
 )");
 
+const SkString kTemporalBlend(R"(
+    uniform shader current;
+    uniform shader previous;
+    uniform float weight;
+    vec4 main(vec2 xy) {
+        float currentLux = current.eval(xy).r;
+        float previousLux = previous.eval(xy).r;
+        // A change of more than a stop is a scene change rather than noise, so follow it.
+        if (abs(log2(currentLux) - log2(previousLux)) > 1.0) {
+            return float4(float3(currentLux), 1.0);
+        }
+        return float4(float3(mix(previousLux, currentLux, weight)), 1.0);
+    }
+)");
+
+// How much a recomputed luminance map contributes when blended with the previous one.
+constexpr float kTemporalBlendWeight = 0.5f;
+
 // Draws the given runtime shader on a GPU surface and returns the result as an SkImage.
 sk_sp<SkImage> makeImage(SkSurface* surface, const SkRuntimeShaderBuilder& builder) {
     sk_sp<SkShader> shader = builder.makeShader(nullptr);
@@ -113,15 +133,90 @@ MouriMap::MouriMap()
       : mCrosstalkAndChunk16x16(makeEffect(kCrosstalkAndChunk16x16)),
         mChunk8x8(makeEffect(kChunk8x8)),
         mBlur(makeEffect(kBlur)),
-        mTonemap(makeEffect(kTonemap)) {}
+        mTonemap(makeEffect(kTonemap)),
+        mTemporalBlend(makeEffect(kTemporalBlend)) {}
 
 sk_sp<SkShader> MouriMap::mouriMap(SkiaGpuContext* context, sk_sp<SkShader> input,
                                    float hdrSdrRatio, float targetHdrSdrRatio) {
-    auto downchunked = downchunk(context, input, hdrSdrRatio);
-    auto localLux = blur(context, downchunked.get());
+    auto localLux = computeLocalLux(context, input, hdrSdrRatio);
+    return tonemap(input, localLux.get(), hdrSdrRatio, targetHdrSdrRatio);
+}
+
+sk_sp<SkShader> MouriMap::mouriMap(SkiaGpuContext* context, sk_sp<SkShader> input,
+                                   float hdrSdrRatio, float targetHdrSdrRatio,
+                                   const TemporalOptions& options) {
+    if (options.refreshInterval <= 1) {
+        return mouriMap(context, std::move(input), hdrSdrRatio, targetHdrSdrRatio);
+    }
+
+    SkImage* image = input->isAImage((SkMatrix*)nullptr, (SkTileMode*)nullptr);
+    const SkISize inputSize = image->dimensions();
+
+    auto it = std::find_if(mTemporalEntries.begin(), mTemporalEntries.end(),
+                           [&](const TemporalEntry& entry) { return entry.key == options.key; });
+    if (it == mTemporalEntries.end()) {
+        if (mTemporalEntries.size() == kMaxTemporalEntries) mTemporalEntries.pop_back();
+        mTemporalEntries.push_front({.key = options.key});
+    } else {
+        mTemporalEntries.splice(mTemporalEntries.begin(), mTemporalEntries, it);
+    }
+    TemporalEntry& entry = mTemporalEntries.front();
+
+    // A map computed for different content or in another context cannot be reused.
+    const bool isCompatible = entry.localLux && entry.context == context &&
+            entry.inputSize == inputSize && entry.hdrSdrRatio == hdrSdrRatio;
+
+    const bool isRefreshDue =
+            entry.refreshCounter.onDraw(options.frameNumber, options.refreshInterval);
+    if (isCompatible && !isRefreshDue) {
+        return tonemap(input, entry.localLux.get(), hdrSdrRatio, targetHdrSdrRatio);
+    }
+
+    auto localLux = computeLocalLux(context, input, hdrSdrRatio);
+    if (isCompatible) {
+        localLux = blend(context, localLux.get(), entry.localLux.get());
+    }
+
+    entry.context = context;
+    entry.inputSize = inputSize;
+    entry.hdrSdrRatio = hdrSdrRatio;
+    entry.localLux = localLux;
+    entry.refreshCounter.onRefresh(options.frameNumber);
     return tonemap(input, localLux.get(), hdrSdrRatio, targetHdrSdrRatio);
 }
 
+bool MouriMap::RefreshCounter::onDraw(uint64_t frameNumber, uint32_t refreshInterval) {
+    if (frameNumber != mLastFrameNumber) {
+        mLastFrameNumber = frameNumber;
+        mFramesSinceRefresh++;
+    }
+    return mFramesSinceRefresh >= refreshInterval;
+}
+
+void MouriMap::RefreshCounter::onRefresh(uint64_t frameNumber) {
+    mLastFrameNumber = frameNumber;
+    mFramesSinceRefresh = 0;
+}
+
+sk_sp<SkImage> MouriMap::computeLocalLux(SkiaGpuContext* context, sk_sp<SkShader> input,
+                                         float hdrSdrRatio) const {
+    auto downchunked = downchunk(context, std::move(input), hdrSdrRatio);
+    return blur(context, downchunked.get());
+}
+
+sk_sp<SkImage> MouriMap::blend(SkiaGpuContext* context, SkImage* current,
+                               SkImage* previous) const {
+    SkRuntimeShaderBuilder blendBuilder(mTemporalBlend);
+    blendBuilder.child("current") =
+            current->makeRawShader(SkTileMode::kClamp, SkTileMode::kClamp, SkSamplingOptions());
+    blendBuilder.child("previous") =
+            previous->makeRawShader(SkTileMode::kClamp, SkTileMode::kClamp, SkSamplingOptions());
+    blendBuilder.uniform("weight") = kTemporalBlendWeight;
+    sk_sp<SkSurface> blendSurface = context->createRenderTarget(current->imageInfo());
+    LOG_ALWAYS_FATAL_IF(!blendSurface, "%s: Failed to create surface!", __func__);
+    return makeImage(blendSurface.get(), blendBuilder);
+}
+
 sk_sp<SkImage> MouriMap::downchunk(SkiaGpuContext* context, sk_sp<SkShader> input,
                                    float hdrSdrRatio) const {
     SkMatrix matrix;
@@ -17,6 +17,10 @@
 #include <SkImage.h>
 #include <SkRuntimeEffect.h>
 #include <SkShader.h>
+
+#include <list>
+#include <string>
+
 #include "../compat/SkiaGpuContext.h"
 namespace android {
 namespace renderengine {
@@ -57,9 +61,39 @@ namespace skia {
  * typically not suitable to be ran "frequently", at high refresh rates (e.g., 120hz). However,
  * MouriMap is sufficiently fast enough for infrequent composition where preserving SDR detail is
  * most important, such as for screenshots.
+ *
+ * For content that is tonemapped every frame, such as video, MouriMap can instead reuse the local
+ * luminance map of an earlier frame of the same stream. The map is then only recomputed every few
+ * frames, and a recomputed map is blended with the previous one to avoid visible steps. Regions
+ * whose luminance changes by more than a stop, e.g. on a scene cut, follow the new map right away.
  */
 class MouriMap {
 public:
+    // Describes a stream of frames whose local luminance maps may be reused across frames.
+    struct TemporalOptions {
+        // Identifies the stream, e.g. by the names of the display and layer it is drawn for.
+        std::string key;
+        // The frame being drawn. Draws of the stream in the same frame count as one frame.
+        uint64_t frameNumber = 0;
+        // The luminance map is recomputed every this many frames. 1 recomputes it every frame.
+        uint32_t refreshInterval = 1;
+    };
+
+    // Counts the frames in which a stream is drawn, to tell when its luminance map is due for a
+    // refresh.
+    class RefreshCounter {
+    public:
+        // Records a draw of the stream in the given frame. Returns whether refreshInterval frames
+        // were drawn since the last refresh.
+        bool onDraw(uint64_t frameNumber, uint32_t refreshInterval);
+        // Records that the luminance map was recomputed in the given frame.
+        void onRefresh(uint64_t frameNumber);
+
+    private:
+        uint64_t mLastFrameNumber = 0;
+        uint32_t mFramesSinceRefresh = 0;
+    };
+
     MouriMap();
     // Apply the MouriMap tonemmaping operator to the input.
     // The HDR/SDR ratio describes the luminace range of the input. 1.0 means SDR. Anything larger
@@ -67,8 +101,26 @@ public:
     // Similarly, the target HDR/SDR ratio describes the luminance range of the output.
     sk_sp<SkShader> mouriMap(SkiaGpuContext* context, sk_sp<SkShader> input, float inputHdrSdrRatio,
                              float targetHdrSdrRatio);
+    // As above, but reuses the luminance map of earlier frames of the same stream.
+    sk_sp<SkShader> mouriMap(SkiaGpuContext* context, sk_sp<SkShader> input, float inputHdrSdrRatio,
+                             float targetHdrSdrRatio, const TemporalOptions& options);
 
 private:
+    // The luminance map last computed for a stream.
+    struct TemporalEntry {
+        std::string key;
+        SkiaGpuContext* context = nullptr;
+        SkISize inputSize = SkISize::MakeEmpty();
+        float hdrSdrRatio = 0.f;
+        sk_sp<SkImage> localLux;
+        RefreshCounter refreshCounter;
+    };
+    // The number of streams whose luminance maps are kept, most recently used first.
+    static constexpr size_t kMaxTemporalEntries = 4;
+
+    sk_sp<SkImage> computeLocalLux(SkiaGpuContext* context, sk_sp<SkShader> input,
+                                   float hdrSdrRatio) const;
+    sk_sp<SkImage> blend(SkiaGpuContext* context, SkImage* current, SkImage* previous) const;
     sk_sp<SkImage> downchunk(SkiaGpuContext* context, sk_sp<SkShader> input,
                              float hdrSdrRatio) const;
     sk_sp<SkImage> blur(SkiaGpuContext* context, SkImage* input) const;
@@ -78,6 +130,9 @@ private:
     const sk_sp<SkRuntimeEffect> mChunk8x8;
     const sk_sp<SkRuntimeEffect> mBlur;
     const sk_sp<SkRuntimeEffect> mTonemap;
+    const sk_sp<SkRuntimeEffect> mTemporalBlend;
+
+    std::list<TemporalEntry> mTemporalEntries;
 };
 } // namespace skia
 } // namespace renderengine
@@ -0,0 +1,66 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#undef LOG_TAG
+#define LOG_TAG "MouriMapTest"
+
+#include <gtest/gtest.h>
+
+#include "../skia/filters/MouriMap.h"
+
+namespace android::renderengine::skia {
+
+using RefreshCounter = MouriMap::RefreshCounter;
+
+TEST(MouriMapRefreshCounterTest, refreshesEveryInterval) {
+    RefreshCounter counter;
+    counter.onRefresh(1);
+
+    EXPECT_FALSE(counter.onDraw(2, 3));
+    EXPECT_FALSE(counter.onDraw(3, 3));
+    EXPECT_TRUE(counter.onDraw(4, 3));
+    counter.onRefresh(4);
+
+    EXPECT_FALSE(counter.onDraw(5, 3));
+}
+
+TEST(MouriMapRefreshCounterTest, countsDrawsOfAFrameOnce) {
+    RefreshCounter counter;
+    counter.onRefresh(1);
+
+    // The frame of the refresh reuses its map.
+    EXPECT_FALSE(counter.onDraw(1, 2));
+    EXPECT_FALSE(counter.onDraw(1, 2));
+
+    EXPECT_FALSE(counter.onDraw(2, 2));
+    EXPECT_FALSE(counter.onDraw(2, 2));
+    EXPECT_FALSE(counter.onDraw(2, 2));
+
+    EXPECT_TRUE(counter.onDraw(3, 2));
+    counter.onRefresh(3);
+    EXPECT_FALSE(counter.onDraw(3, 2));
+}
+
+TEST(MouriMapRefreshCounterTest, countsFramesTheStreamIsDrawnIn) {
+    RefreshCounter counter;
+    counter.onRefresh(1);
+
+    // Frames that don't draw the stream, e.g. of other displays, don't count.
+    EXPECT_FALSE(counter.onDraw(5, 2));
+    EXPECT_TRUE(counter.onDraw(9, 2));
+}
+
+} // namespace android::renderengine::skia
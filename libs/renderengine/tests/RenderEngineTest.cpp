@@ -22,6 +22,7 @@
 #pragma clang diagnostic ignored "-Wconversion"
 #pragma clang diagnostic ignored "-Wextra"
 
+#include <android-base/scopeguard.h>
 #include <com_android_graphics_surfaceflinger_flags.h>
 #include <cutils/properties.h>
 #include <gtest/gtest.h>
@@ -3410,6 +3411,69 @@ TEST_P(RenderEngineTest, primeShaderCache) {
     ASSERT_GT(static_cast<skia::SkiaGLRenderEngine*>(mRE.get())->reportShadersCompiled(),
               kMinimumExpectedShadersCompiled);
 }
+
+TEST_P(RenderEngineTest, drawLayers_screenshotOnBackgroundQueue) {
+    if (GetParam()->graphicsApi() != renderengine::RenderEngine::GraphicsApi::VK ||
+        !GetParam()->apiSupported()) {
+        GTEST_SKIP();
+    }
+
+    // The queue is requested when the device is created, so recreate it with the property set.
+    // Destroying the RenderEngine tears the device down again for the next test.
+    ASSERT_EQ(0, property_set(PROPERTY_DEBUG_RENDERENGINE_BACKGROUND_QUEUE, "1"));
+    const auto resetProperty = base::make_scope_guard(
+            [] { property_set(PROPERTY_DEBUG_RENDERENGINE_BACKGROUND_QUEUE, ""); });
+    renderengine::RenderEngine::teardown(renderengine::RenderEngine::GraphicsApi::VK);
+    initializeRenderEngine();
+
+    std::string dump;
+    mRE->dump(dump);
+    if (dump.find("draws screenshots in background context: 1") == std::string::npos) {
+        // The graphics queue family has a single queue.
+        GTEST_SKIP();
+    }
+
+    const auto displayRect = Rect(2, 1);
+    const auto greenBuffer = allocateAndFillSourceBuffer(1, 1, ubyte4(0, 255, 0, 255));
+    const renderengine::LayerSettings greenLayer{
+            .geometry.boundaries = FloatRect(0.f, 0.f, 1.f, 1.f),
+            .source =
+                    renderengine::PixelSource{
+                            .buffer =
+                                    renderengine::Buffer{
+                                            .buffer = greenBuffer,
+                                            .usePremultipliedAlpha = true,
+                                    },
+                    },
+            .alpha = 1.0f,
+            .sourceDataspace = ui::Dataspace::V0_SRGB_LINEAR,
+    };
+    const renderengine::LayerSettings redLayer{
+            .geometry.boundaries = FloatRect(1.f, 0.f, 2.f, 1.f),
+            .source.solidColor = half3(1.0f, 0.0f, 0.0f),
+            .alpha = 1.0f,
+            .sourceDataspace = ui::Dataspace::V0_SRGB_LINEAR,
+    };
+    std::vector<renderengine::LayerSettings> layers{greenLayer, redLayer};
+
+    // Alternate between the background and the main queue with the same source buffer, which is
+    // cached for the main queue only.
+    for (const bool isScreenshot : {true, false, true}) {
+        const renderengine::DisplaySettings display{
+                .physicalDisplay = displayRect,
+                .clip = displayRect,
+                .outputDataspace = ui::Dataspace::V0_SRGB_LINEAR,
+                .isScreenshot = isScreenshot,
+        };
+        invokeDraw(display, {});
+        expectBufferColor(displayRect, 0, 0, 0, 0);
+
+        invokeDraw(display, layers);
+        expectBufferColor(Rect(0, 0, 1, 1), 0, 255, 0, 255);
+        expectBufferColor(Rect(1, 0, 2, 1), 255, 0, 0, 255);
+    }
+}
+
 } // namespace renderengine
 } // namespace android
 
@@ -27,7 +27,9 @@ namespace android {
 
 using renderengine::PrimeCacheConfig;
 using testing::_;
+using testing::AnyNumber;
 using testing::Eq;
+using testing::InSequence;
 using testing::Mock;
 using testing::Return;
 
@@ -113,6 +115,13 @@ TEST_F(RenderEngineThreadedTest, supportsProtectedContent_returnsTrue) {
     ASSERT_EQ(true, result);
 }
 
+TEST_F(RenderEngineThreadedTest, onDisplayRemoved) {
+    EXPECT_CALL(*mRenderEngine, onDisplayRemoved(Eq("Display 1")));
+    mThreadedRE->onDisplayRemoved("Display 1");
+    // call ANY synchronous function to ensure that onDisplayRemoved has completed.
+    mThreadedRE->getContextPriority();
+}
+
 TEST_F(RenderEngineThreadedTest, PostRenderCleanup_skipped) {
     EXPECT_CALL(*mRenderEngine, cleanupPostRender()).Times(0);
     mThreadedRE->cleanupPostRender();
@@ -246,4 +255,50 @@ TEST_F(RenderEngineThreadedTest, drawLayers_protectedOutputBuffer) {
     ASSERT_TRUE(result.ok());
 }
 
+TEST_F(RenderEngineThreadedTest, drawLayers_forDisplayRunsBeforeQueuedScreenshot) {
+    renderengine::DisplaySettings displaySettings;
+    renderengine::DisplaySettings screenshotSettings;
+    screenshotSettings.isScreenshot = true;
+    std::vector<renderengine::LayerSettings> layers;
+    std::shared_ptr<renderengine::ExternalTexture> buffer = std::make_shared<
+            renderengine::impl::
+                    ExternalTexture>(sp<GraphicBuffer>::make(), *mRenderEngine,
+                                     renderengine::impl::ExternalTexture::Usage::READABLE |
+                                             renderengine::impl::ExternalTexture::Usage::WRITEABLE);
+
+    // Keep the RenderEngine thread busy until both draws are queued.
+    std::promise<void> unblock;
+    EXPECT_CALL(*mRenderEngine, primeCache(_)).WillOnce([&](PrimeCacheConfig) {
+        unblock.get_future().wait();
+        return std::future<void>();
+    });
+    EXPECT_CALL(*mRenderEngine, useProtectedContext(false)).Times(AnyNumber());
+    {
+        InSequence seq;
+        for (bool isScreenshot : {false, true}) {
+            EXPECT_CALL(*mRenderEngine, drawLayersInternal)
+                    .WillOnce([isScreenshot](
+                                      const std::shared_ptr<std::promise<FenceResult>>&&
+                                              resultPromise,
+                                      const renderengine::DisplaySettings& display,
+                                      const std::vector<renderengine::LayerSettings>&,
+                                      const std::shared_ptr<renderengine::ExternalTexture>&,
+                                      base::unique_fd&&) {
+                        EXPECT_EQ(isScreenshot, display.isScreenshot);
+                        resultPromise->set_value(Fence::NO_FENCE);
+                    });
+        }
+    }
+
+    mThreadedRE->primeCache(PrimeCacheConfig());
+    ftl::Future<FenceResult> screenshotFuture =
+            mThreadedRE->drawLayers(screenshotSettings, layers, buffer, base::unique_fd());
+    ftl::Future<FenceResult> displayFuture =
+            mThreadedRE->drawLayers(displaySettings, layers, buffer, base::unique_fd());
+    unblock.set_value();
+
+    ASSERT_TRUE(displayFuture.get().ok());
+    ASSERT_TRUE(screenshotFuture.get().ok());
+}
+
 } // namespace android
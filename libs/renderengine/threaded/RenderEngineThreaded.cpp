@@ -19,7 +19,9 @@
 #include "RenderEngineThreaded.h"
 
 #include <sched.h>
+#include <algorithm>
 #include <chrono>
+#include <cinttypes>
 #include <future>
 
 #include <android-base/stringprintf.h>
@@ -99,10 +101,18 @@ void RenderEngineThreaded::threadMain(CreateInstanceFactory factory) NO_THREAD_S
     while (mRunning) {
         const auto getNextTask = [this]() -> std::optional<Work> {
             std::scoped_lock lock(mThreadMutex);
-            if (!mFunctionCalls.empty()) {
-                Work task = mFunctionCalls.front();
-                mFunctionCalls.pop();
-                return std::make_optional<Work>(task);
+            auto& queue = mCompositionCalls.empty() ? mFunctionCalls : mCompositionCalls;
+            if (!queue.empty()) {
+                QueuedWork task = std::move(queue.front());
+                queue.pop();
+
+                auto& latency =
+                        &queue == &mCompositionCalls ? mCompositionLatency : mOtherLatency;
+                const nsecs_t waitTime = systemTime() - task.queueTime;
+                latency.count++;
+                latency.total += waitTime;
+                latency.max = std::max(latency.max, waitTime);
+                return std::make_optional<Work>(std::move(task.work));
             }
             return std::nullopt;
         };
@@ -115,7 +125,7 @@ void RenderEngineThreaded::threadMain(CreateInstanceFactory factory) NO_THREAD_S
 
         std::unique_lock<std::mutex> lock(mThreadMutex);
         mCondition.wait(lock, [this]() REQUIRES(mThreadMutex) {
-            return !mRunning || !mFunctionCalls.empty();
+            return !mRunning || !mCompositionCalls.empty() || !mFunctionCalls.empty();
         });
     }
 
@@ -123,6 +133,11 @@ void RenderEngineThreaded::threadMain(CreateInstanceFactory factory) NO_THREAD_S
     mRenderEngine.reset();
 }
 
+void RenderEngineThreaded::pushWork(Work&& work, Priority priority) {
+    auto& queue = priority == Priority::kComposition ? mCompositionCalls : mFunctionCalls;
+    queue.push({std::move(work), systemTime()});
+}
+
 void RenderEngineThreaded::waitUntilInitialized() const {
     if (!mIsInitialized) {
         std::unique_lock<std::mutex> lock(mInitializedMutex);
@@ -138,7 +153,7 @@ std::future<void> RenderEngineThreaded::primeCache(PrimeCacheConfig config) {
     // for the futures.
     {
         std::lock_guard lock(mThreadMutex);
-        mFunctionCalls.push([resultPromise, config](renderengine::RenderEngine& instance) {
+        pushWork([resultPromise, config](renderengine::RenderEngine& instance) {
             SFTRACE_NAME("REThreaded::primeCache");
             if (setSchedFifo(false) != NO_ERROR) {
                 ALOGW("Couldn't set SCHED_OTHER for primeCache");
@@ -162,7 +177,7 @@ void RenderEngineThreaded::dump(std::string& result) {
     std::future<std::string> resultFuture = resultPromise.get_future();
     {
         std::lock_guard lock(mThreadMutex);
-        mFunctionCalls.push([&resultPromise, &result](renderengine::RenderEngine& instance) {
+        pushWork([&resultPromise, &result](renderengine::RenderEngine& instance) {
             SFTRACE_NAME("REThreaded::dump");
             std::string localResult = result;
             instance.dump(localResult);
@@ -172,6 +187,18 @@ void RenderEngineThreaded::dump(std::string& result) {
     mCondition.notify_one();
     // Note: This is an rvalue.
     result.assign(resultFuture.get());
+
+    std::lock_guard lock(mThreadMutex);
+    const auto dumpLatency = [&result](const char* name, const QueueLatency& latency) {
+        base::StringAppendF(&result,
+                            "RenderEngineThreaded %s queue latency: count=%" PRIu64
+                            " avg=%.3fms max=%.3fms\n",
+                            name, latency.count,
+                            latency.count ? ns2us(latency.total / latency.count) / 1000.f : 0.f,
+                            ns2us(latency.max) / 1000.f);
+    };
+    dumpLatency("composition", mCompositionLatency);
+    dumpLatency("other", mOtherLatency);
 }
 
 void RenderEngineThreaded::mapExternalTextureBuffer(const sp<GraphicBuffer>& buffer,
@@ -181,7 +208,7 @@ void RenderEngineThreaded::mapExternalTextureBuffer(const sp<GraphicBuffer>& buf
     // for the futures.
     {
         std::lock_guard lock(mThreadMutex);
-        mFunctionCalls.push([=](renderengine::RenderEngine& instance) {
+        pushWork([=](renderengine::RenderEngine& instance) {
             SFTRACE_NAME("REThreaded::mapExternalTextureBuffer");
             instance.mapExternalTextureBuffer(buffer, isRenderable);
         });
@@ -195,7 +222,7 @@ void RenderEngineThreaded::unmapExternalTextureBuffer(sp<GraphicBuffer>&& buffer
     // for the futures.
     {
         std::lock_guard lock(mThreadMutex);
-        mFunctionCalls.push(
+        pushWork(
                 [=, buffer = std::move(buffer)](renderengine::RenderEngine& instance) mutable {
                     SFTRACE_NAME("REThreaded::unmapExternalTextureBuffer");
                     instance.unmapExternalTextureBuffer(std::move(buffer));
@@ -228,7 +255,7 @@ void RenderEngineThreaded::cleanupPostRender() {
     // for the futures.
     {
         std::lock_guard lock(mThreadMutex);
-        mFunctionCalls.push([=](renderengine::RenderEngine& instance) {
+        pushWork([=](renderengine::RenderEngine& instance) {
             SFTRACE_NAME("REThreaded::cleanupPostRender");
             instance.cleanupPostRender();
         });
@@ -269,13 +296,14 @@ ftl::Future<FenceResult> RenderEngineThreaded::drawLayers(
     {
         std::lock_guard lock(mThreadMutex);
         mNeedsPostRenderCleanup = true;
-        mFunctionCalls.push(
+        pushWork(
                 [resultPromise, display, layers, buffer, fd](renderengine::RenderEngine& instance) {
                     SFTRACE_NAME("REThreaded::drawLayers");
                     instance.updateProtectedContext(layers, {buffer.get()});
                     instance.drawLayersInternal(std::move(resultPromise), display, layers, buffer,
                                                 base::unique_fd(fd));
-                });
+                },
+                display.isScreenshot ? Priority::kOther : Priority::kComposition);
     }
     mCondition.notify_one();
     return resultFuture;
@@ -292,7 +320,7 @@ ftl::Future<FenceResult> RenderEngineThreaded::drawGainmap(
     {
         std::lock_guard lock(mThreadMutex);
         mNeedsPostRenderCleanup = true;
-        mFunctionCalls.push([resultPromise, sdr, sdrFence = std::move(sdrFence), hdr,
+        pushWork([resultPromise, sdr, sdrFence = std::move(sdrFence), hdr,
                              hdrFence = std::move(hdrFence), hdrSdrRatio, dataspace,
                              gainmap](renderengine::RenderEngine& instance) mutable {
             SFTRACE_NAME("REThreaded::drawGainmap");
@@ -310,7 +338,7 @@ int RenderEngineThreaded::getContextPriority() {
     std::future<int> resultFuture = resultPromise.get_future();
     {
         std::lock_guard lock(mThreadMutex);
-        mFunctionCalls.push([&resultPromise](renderengine::RenderEngine& instance) {
+        pushWork([&resultPromise](renderengine::RenderEngine& instance) {
             SFTRACE_NAME("REThreaded::getContextPriority");
             int priority = instance.getContextPriority();
             resultPromise.set_value(priority);
@@ -330,7 +358,7 @@ void RenderEngineThreaded::onActiveDisplaySizeChanged(ui::Size size) {
     // for the futures.
     {
         std::lock_guard lock(mThreadMutex);
-        mFunctionCalls.push([size](renderengine::RenderEngine& instance) {
+        pushWork([size](renderengine::RenderEngine& instance) {
             SFTRACE_NAME("REThreaded::onActiveDisplaySizeChanged");
             instance.onActiveDisplaySizeChanged(size);
         });
@@ -338,12 +366,25 @@ void RenderEngineThreaded::onActiveDisplaySizeChanged(ui::Size size) {
     mCondition.notify_one();
 }
 
+void RenderEngineThreaded::onDisplayRemoved(const std::string& displayNamePlusId) {
+    // This function is designed so it can run asynchronously, so we do not need to wait
+    // for the futures.
+    {
+        std::lock_guard lock(mThreadMutex);
+        pushWork([displayNamePlusId](renderengine::RenderEngine& instance) {
+            SFTRACE_NAME("REThreaded::onDisplayRemoved");
+            instance.onDisplayRemoved(displayNamePlusId);
+        });
+    }
+    mCondition.notify_one();
+}
+
 std::optional<pid_t> RenderEngineThreaded::getRenderEngineTid() const {
     std::promise<pid_t> tidPromise;
     std::future<pid_t> tidFuture = tidPromise.get_future();
     {
         std::lock_guard lock(mThreadMutex);
-        mFunctionCalls.push([&tidPromise](renderengine::RenderEngine& instance) {
+        pushWork([&tidPromise](renderengine::RenderEngine& instance) {
             tidPromise.set_value(gettid());
         });
     }
@@ -357,7 +398,7 @@ void RenderEngineThreaded::setEnableTracing(bool tracingEnabled) {
     // for the futures.
     {
         std::lock_guard lock(mThreadMutex);
-        mFunctionCalls.push([tracingEnabled](renderengine::RenderEngine& instance) {
+        pushWork([tracingEnabled](renderengine::RenderEngine& instance) {
             SFTRACE_NAME("REThreaded::setEnableTracing");
             instance.setEnableTracing(tracingEnabled);
         });
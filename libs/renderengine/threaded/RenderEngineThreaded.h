@@ -22,6 +22,8 @@
 #include <queue>
 #include <thread>
 
+#include <utils/Timers.h>
+
 #include "renderengine/RenderEngine.h"
 
 namespace android {
@@ -33,7 +35,8 @@ using CreateInstanceFactory = std::function<std::unique_ptr<renderengine::Render
 /**
  * This class extends a basic RenderEngine class. It contains a thread. Each time a function of
  * this class is called, we create a lambda function that is put on a queue. The main thread then
- * executes the functions in order.
+ * executes the functions in order, except that draws for displays run ahead of any other queued
+ * work, such as screenshots and texture mapping.
  */
 class RenderEngineThreaded : public RenderEngine {
 public:
@@ -65,6 +68,7 @@ public:
     int getContextPriority() override;
     bool supportsBackgroundBlur() override;
     void onActiveDisplaySizeChanged(ui::Size size) override;
+    void onDisplayRemoved(const std::string& displayNamePlusId) override;
     std::optional<pid_t> getRenderEngineTid() const override;
     void setEnableTracing(bool tracingEnabled) override;
 
@@ -104,9 +108,27 @@ private:
     std::atomic<bool> mNeedsPostRenderCleanup = false;
 
     using Work = std::function<void(renderengine::RenderEngine&)>;
-    mutable std::queue<Work> mFunctionCalls GUARDED_BY(mThreadMutex);
+    enum class Priority { kComposition, kOther };
+    void pushWork(Work&& work, Priority priority = Priority::kOther) REQUIRES(mThreadMutex);
+
+    struct QueuedWork {
+        Work work;
+        nsecs_t queueTime;
+    };
+    // Draws for displays, which run before anything in mFunctionCalls.
+    mutable std::queue<QueuedWork> mCompositionCalls GUARDED_BY(mThreadMutex);
+    mutable std::queue<QueuedWork> mFunctionCalls GUARDED_BY(mThreadMutex);
     mutable std::condition_variable mCondition;
 
+    // How long work of each priority waited in its queue before it started running.
+    struct QueueLatency {
+        uint64_t count = 0;
+        nsecs_t total = 0;
+        nsecs_t max = 0;
+    };
+    QueueLatency mCompositionLatency GUARDED_BY(mThreadMutex);
+    QueueLatency mOtherLatency GUARDED_BY(mThreadMutex);
+
     // Used to allow select thread safe methods to be accessed without requiring the
     // method to be invoked on the RenderEngine thread
     std::atomic_bool mIsInitialized = false;
@@ -85,4 +85,44 @@ TEST_F(TonemapTest, generateTonemapGainShaderSkSL_containsEntryPointForHLG) {
     EXPECT_THAT(shader, HasSubstr("float libtonemap_LookupTonemapGain(vec3 linearRGB, vec3 xyz)"));
 }
 
+TEST_F(TonemapTest, generateTonemapGainShaderSkSL_dependsOnlyOnTransferFunctions) {
+    using aidl::android::hardware::graphics::common::Dataspace;
+    auto* const toneMapper = tonemap::getToneMapper();
+
+    const auto shader =
+            toneMapper->generateTonemapGainShaderSkSL(Dataspace::BT2020_ITU_PQ, Dataspace::SRGB);
+    EXPECT_EQ(shader,
+              toneMapper->generateTonemapGainShaderSkSL(Dataspace::BT2020_PQ,
+                                                        Dataspace::DISPLAY_P3));
+    EXPECT_NE(shader,
+              toneMapper->generateTonemapGainShaderSkSL(Dataspace::BT2020_ITU_HLG,
+                                                        Dataspace::SRGB));
+}
+
+TEST_F(TonemapTest, lookupTonemapGain_mapsPQToSDR) {
+    using aidl::android::hardware::graphics::common::Dataspace;
+    static const constexpr float kDisplayMaxLuminance = 500.f;
+    tonemap::Metadata metadata{.displayMaxLuminance = kDisplayMaxLuminance,
+                               .contentMaxLuminance = 4000.f,
+                               .currentDisplayLuminance = kDisplayMaxLuminance};
+
+    const std::vector<tonemap::Color> colors = {{.linearRGB = vec3(0.f)},
+                                                {.linearRGB = vec3(100.f, 50.f, 10.f)},
+                                                {.linearRGB = vec3(1000.f, 2000.f, 0.f)},
+                                                {.linearRGB = vec3(8000.f)}};
+    const auto gains = tonemap::getToneMapper()->lookupTonemapGain(Dataspace::BT2020_ITU_PQ,
+                                                                   Dataspace::SRGB, colors,
+                                                                   metadata);
+
+    ASSERT_EQ(colors.size(), gains.size());
+    // Black and dim colors are left as is.
+    EXPECT_EQ(1.0, gains[0]);
+    EXPECT_EQ(1.0, gains[1]);
+    // Bright colors are compressed into the display range.
+    EXPECT_LT(gains[2] * 2000.0, kDisplayMaxLuminance);
+    EXPECT_GT(gains[2] * 2000.0, kDisplayMaxLuminance * 0.65);
+    // Colors beyond the content range map to the display max luminance.
+    EXPECT_NEAR(gains[3] * 8000.0, kDisplayMaxLuminance, 1e-3);
+}
+
 } // namespace android
@@ -18,8 +18,11 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <map>
+#include <memory>
 #include <mutex>
 #include <type_traits>
+#include <utility>
 
 namespace android::tonemap {
 
@@ -48,6 +51,23 @@ std::vector<uint8_t> buildUniformValue(T value) {
     return result;
 }
 
+// Computes the gain for each linear RGB color from its max channel, where curve maps the max
+// channel in nits to the tonemapped nits. The max channels are gathered in a first pass, so that
+// the second pass is a tight loop over contiguous doubles, which the compiler may vectorize for
+// simple curves.
+template <typename Curve>
+std::vector<double> computeMaxChannelGains(const std::vector<Color>& colors, Curve curve) {
+    std::vector<double> gains(colors.size());
+    std::transform(colors.begin(), colors.end(), gains.begin(), [](const Color& color) {
+        return std::max({color.linearRGB.r, color.linearRGB.g, color.linearRGB.b});
+    });
+    for (double& gain : gains) {
+        const double maxRGB = gain;
+        gain = maxRGB <= 0.0 ? 1.0 : curve(maxRGB) / maxRGB;
+    }
+    return gains;
+}
+
 // Refer to BT2100-2
 float computeHlgGamma(float currentDisplayBrightnessNits) {
     // BT 2100-2's recommendation for taking into account the nominal max
@@ -655,77 +675,106 @@ public:
 
         const double hlgGamma = computeHlgGamma(metadata.currentDisplayLuminance);
 
-        for (const auto [linearRGB, _] : colors) {
-            double maxRGB = std::max({linearRGB.r, linearRGB.g, linearRGB.b});
-
-            if (maxRGB <= 0.0) {
-                gains.push_back(1.0);
-                continue;
-            }
-
-            const int32_t sourceDataspaceInt = static_cast<int32_t>(sourceDataspace);
-            const int32_t destinationDataspaceInt = static_cast<int32_t>(destinationDataspace);
+        const int32_t sourceDataspaceInt = static_cast<int32_t>(sourceDataspace);
+        const int32_t destinationDataspaceInt = static_cast<int32_t>(destinationDataspace);
 
-            double targetNits = 0.0;
-            switch (sourceDataspaceInt & kTransferMask) {
-                case kTransferST2084:
-                    switch (destinationDataspaceInt & kTransferMask) {
-                        case kTransferST2084:
-                            targetNits = maxRGB;
-                            break;
-                        case kTransferHLG:
-                            // PQ has a wider luminance range (10,000 nits vs. 1,000 nits) than HLG,
-                            // so we'll clamp the luminance range in case we're mapping from PQ
-                            // input to HLG output.
-                            targetNits = std::clamp(maxRGB, 0.0, 1000.0);
-                            targetNits *= pow(targetNits / 1000.0, (1 - hlgGamma) / (hlgGamma));
-                            break;
-                        default:
-                            targetNits = maxRGB;
-                            if (targetNits < x1) {
-                                break;
+        // Resolve the curve once rather than for every color.
+        const auto identity = [](double maxRGB) { return maxRGB; };
+        switch (sourceDataspaceInt & kTransferMask) {
+            case kTransferST2084:
+                switch (destinationDataspaceInt & kTransferMask) {
+                    case kTransferST2084:
+                        return computeMaxChannelGains(colors, identity);
+                    case kTransferHLG:
+                        // PQ has a wider luminance range (10,000 nits vs. 1,000 nits) than HLG,
+                        // so we'll clamp the luminance range in case we're mapping from PQ
+                        // input to HLG output.
+                        return computeMaxChannelGains(colors, [=](double maxRGB) {
+                            const double nits = std::clamp(maxRGB, 0.0, 1000.0);
+                            return nits * std::pow(nits / 1000.0, (1 - hlgGamma) / (hlgGamma));
+                        });
+                    default:
+                        return computeMaxChannelGains(colors, [&](double maxRGB) {
+                            if (maxRGB < x1) {
+                                return maxRGB;
                             }
 
-                            if (targetNits > maxInLumi) {
-                                targetNits = maxOutLumi;
-                                break;
+                            if (maxRGB > maxInLumi) {
+                                return maxOutLumi;
                             }
 
-                            const double greyNits = OETF_ST2084(targetNits);
+                            const double greyNits = OETF_ST2084(maxRGB);
 
                             if (greyNits <= greyNorm2) {
-                                targetNits = (greyNits - greyNorm2) * slope2 + y2;
+                                return (greyNits - greyNorm2) * slope2 + y2;
                             } else if (greyNits <= greyNorm3) {
-                                targetNits = (greyNits - greyNorm3) * slope3 + y3;
-                            } else {
-                                targetNits = maxOutLumi;
+                                return (greyNits - greyNorm3) * slope3 + y3;
                             }
-                            break;
-                    }
-                    break;
-                case kTransferHLG:
-                    switch (destinationDataspaceInt & kTransferMask) {
-                        case kTransferST2084:
-                            targetNits = maxRGB * pow(maxRGB / 1000.0, hlgGamma - 1);
-                            break;
-                        case kTransferHLG:
-                            targetNits = maxRGB;
-                            break;
-                        default:
-                            targetNits = maxRGB * pow(maxRGB / 1000.0, hlgGamma - 1) *
-                                    metadata.displayMaxLuminance / 1000.0;
-                            break;
-                    }
-                    break;
-                default:
-                    targetNits = maxRGB;
-                    break;
-            }
+                            return maxOutLumi;
+                        });
+                }
+            case kTransferHLG:
+                switch (destinationDataspaceInt & kTransferMask) {
+                    case kTransferST2084:
+                        return computeMaxChannelGains(colors, [=](double maxRGB) {
+                            return maxRGB * std::pow(maxRGB / 1000.0, hlgGamma - 1);
+                        });
+                    case kTransferHLG:
+                        return computeMaxChannelGains(colors, identity);
+                    default:
+                        return computeMaxChannelGains(colors, [=](double maxRGB) {
+                            return maxRGB * std::pow(maxRGB / 1000.0, hlgGamma - 1) * maxOutLumi /
+                                    1000.0;
+                        });
+                }
+            default:
+                return computeMaxChannelGains(colors, identity);
+        }
+    }
+};
 
-            gains.push_back(targetNits / maxRGB);
+// Caches the shaders generated by a tonemapper. The shaders only depend on the transfer functions
+// of the source and destination dataspaces, so there are few of them, while callers may request
+// them for every change of layer dataspace or display luminance.
+class ShaderCachingToneMapper : public ToneMapper {
+public:
+    explicit ShaderCachingToneMapper(std::unique_ptr<ToneMapper> toneMapper)
+          : mToneMapper(std::move(toneMapper)) {}
+
+    std::string generateTonemapGainShaderSkSL(
+            aidl::android::hardware::graphics::common::Dataspace sourceDataspace,
+            aidl::android::hardware::graphics::common::Dataspace destinationDataspace) override {
+        const std::pair key(static_cast<int32_t>(sourceDataspace) & kTransferMask,
+                            static_cast<int32_t>(destinationDataspace) & kTransferMask);
+
+        std::lock_guard lock(mMutex);
+        auto it = mShaders.find(key);
+        if (it == mShaders.end()) {
+            it = mShaders
+                         .emplace(key,
+                                  mToneMapper->generateTonemapGainShaderSkSL(sourceDataspace,
+                                                                             destinationDataspace))
+                         .first;
         }
-        return gains;
+        return it->second;
     }
+
+    std::vector<ShaderUniform> generateShaderSkSLUniforms(const Metadata& metadata) override {
+        return mToneMapper->generateShaderSkSLUniforms(metadata);
+    }
+
+    std::vector<Gain> lookupTonemapGain(
+            aidl::android::hardware::graphics::common::Dataspace sourceDataspace,
+            aidl::android::hardware::graphics::common::Dataspace destinationDataspace,
+            const std::vector<Color>& colors, const Metadata& metadata) override {
+        return mToneMapper->lookupTonemapGain(sourceDataspace, destinationDataspace, colors,
+                                              metadata);
+    }
+
+private:
+    const std::unique_ptr<ToneMapper> mToneMapper;
+    std::mutex mMutex;
+    std::map<std::pair<int32_t, int32_t>, std::string> mShaders;
 };
 
 } // namespace
@@ -735,13 +784,15 @@ ToneMapper* getToneMapper() {
     static std::unique_ptr<ToneMapper> sToneMapper;
 
     std::call_once(sOnce, [&] {
+        std::unique_ptr<ToneMapper> toneMapper;
         switch (kToneMapAlgorithm) {
             case ToneMapAlgorithm::AndroidO:
-                sToneMapper = std::unique_ptr<ToneMapper>(new ToneMapperO());
+                toneMapper = std::unique_ptr<ToneMapper>(new ToneMapperO());
                 break;
             case ToneMapAlgorithm::Android13:
-                sToneMapper = std::unique_ptr<ToneMapper>(new ToneMapper13());
+                toneMapper = std::unique_ptr<ToneMapper>(new ToneMapper13());
         }
+        sToneMapper = std::make_unique<ShaderCachingToneMapper>(std::move(toneMapper));
     });
 
     return sToneMapper.get();
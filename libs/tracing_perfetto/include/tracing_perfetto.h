@@ -16,10 +16,18 @@
 
 #pragma once
 
+#include <cutils/trace.h>
 #include <stdint.h>
 
+#include <atomic>
+
 namespace tracing_perfetto {
 
+namespace internal {
+// Bit i is set while the Perfetto category for the atrace category (1 << i) is enabled.
+extern std::atomic_uint64_t enabled_perfetto_categories;
+}  // namespace internal
+
 void registerWithPerfetto(bool test = false);
 
 void traceBegin(uint64_t category, const char* name);
@@ -50,4 +58,49 @@ void traceCounter(uint64_t category, const char* name, int64_t value);
 void traceCounter32(uint64_t category, const char* name, int32_t value);
 
 bool isTagEnabled(uint64_t category);
+
+/**
+ * Same as isTagEnabled, but inlined into the caller, so that a disabled category costs two loads
+ * and a branch rather than a call into this library. Callers on hot paths check this before
+ * calling any of the functions above.
+ */
+inline bool isTagEnabledFast(uint64_t category) {
+  return ((internal::enabled_perfetto_categories.load(std::memory_order_relaxed) |
+           atrace_get_enabled_tags()) &
+          category) != 0;
+}
+
+/**
+ * Traces a slice from construction until the end of the enclosing scope. The end is only traced
+ * if the beginning was, even if the category is enabled or disabled in between.
+ */
+class ScopedTrace {
+ public:
+  inline ScopedTrace(uint64_t category, const char* name) {
+    if (CC_UNLIKELY(isTagEnabledFast(category))) {
+      traceBegin(category, name);
+      mCategory = category;
+    }
+  }
+
+  inline ~ScopedTrace() {
+    if (CC_UNLIKELY(mCategory != 0)) {
+      traceEnd(mCategory);
+    }
+  }
+
+  ScopedTrace(const ScopedTrace&) = delete;
+  ScopedTrace& operator=(const ScopedTrace&) = delete;
+
+ private:
+  uint64_t mCategory = 0;
+};
+
 }  // namespace tracing_perfetto
+
+#define TRACING_PERFETTO_PASTE_(x, y) x##y
+#define TRACING_PERFETTO_PASTE(x, y) TRACING_PERFETTO_PASTE_(x, y)
+
+// Traces name in category from here until the end of the enclosing scope.
+#define TRACING_PERFETTO_SCOPED(category, name) \
+  ::tracing_perfetto::ScopedTrace TRACING_PERFETTO_PASTE(___tracer, __LINE__)(category, name)
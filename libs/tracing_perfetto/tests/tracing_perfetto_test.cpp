@@ -149,6 +149,24 @@ TEST_F_WITH_FLAGS(TracingPerfettoTest, traceInstantWithPerfetto,
   verifyTrackEvent(trace, event_category, event_name);
 }
 
+TEST_F_WITH_FLAGS(TracingPerfettoTest, scopedTraceWithPerfetto,
+                  REQUIRES_FLAGS_ENABLED(PERFETTO_SDK_TRACING)) {
+  std::string event_category = "input";
+  std::string event_name = "scopedTraceWithPerfetto";
+
+  TracingSession tracing_session =
+      TracingSession::Builder().add_enabled_category(event_category).Build();
+
+  EXPECT_TRUE(tracing_perfetto::isTagEnabledFast(TRACE_CATEGORY_INPUT));
+  {
+    TRACING_PERFETTO_SCOPED(TRACE_CATEGORY_INPUT, event_name.c_str());
+  }
+
+  Trace trace = stopSession(tracing_session);
+
+  verifyTrackEvent(trace, event_category, event_name);
+}
+
 TEST_F_WITH_FLAGS(TracingPerfettoTest, traceInstantWithAtrace,
                   REQUIRES_FLAGS_ENABLED(PERFETTO_SDK_TRACING)) {
   std::string event_category = "input";
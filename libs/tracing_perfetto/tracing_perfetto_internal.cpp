@@ -69,6 +69,8 @@ namespace tracing_perfetto {
 
 namespace internal {
 
+std::atomic_uint64_t enabled_perfetto_categories = 0;
+
 namespace {
 PERFETTO_TE_CATEGORIES_DECLARE(FRAMEWORK_CATEGORIES);
 
@@ -158,6 +160,22 @@ struct PerfettoTeCategory* toCategory(uint64_t inCategory) {
   }
 }
 
+// Keeps |enabled_perfetto_categories| in sync with the categories, so that the inline fast path in
+// tracing_perfetto.h can check any of them with one load. user_arg is the atrace category.
+void onCategoryStateChanged(struct PerfettoTeCategoryImpl*, PerfettoDsInstanceIndex,
+                            bool created, bool global_state_changed, void* user_arg) {
+  if (!global_state_changed) {
+    return;
+  }
+
+  const uint64_t category = reinterpret_cast<uintptr_t>(user_arg);
+  if (created) {
+    enabled_perfetto_categories.fetch_or(category, std::memory_order_relaxed);
+  } else {
+    enabled_perfetto_categories.fetch_and(~category, std::memory_order_relaxed);
+  }
+}
+
 }  // namespace
 
 bool isPerfettoCategoryEnabled(PerfettoTeCategory* category) {
@@ -239,6 +257,15 @@ void registerWithPerfetto(bool test) {
     PerfettoProducerInit(args);
     PerfettoTeInit();
     PERFETTO_TE_REGISTER_CATEGORIES(FRAMEWORK_CATEGORIES);
+
+    for (int bit = 0; bit < 64; bit++) {
+      const uint64_t category = uint64_t{1} << bit;
+      struct PerfettoTeCategory* perfettoCategory = toCategory(category);
+      if (perfettoCategory != nullptr) {
+        PerfettoTeCategorySetCallback(perfettoCategory, onCategoryStateChanged,
+                                      reinterpret_cast<void*>(static_cast<uintptr_t>(category)));
+      }
+    }
   });
 }
 
@@ -27,6 +27,7 @@
 #include <sync/sync.h>
 #pragma clang diagnostic pop
 
+#include <poll.h>
 #include <sys/types.h>
 #include <unistd.h>
 #include <utils/Log.h>
@@ -118,6 +119,76 @@ sp<Fence> Fence::merge(const String8& name, const sp<Fence>& f1,
     return merge(name.c_str(), f1, f2);
 }
 
+sp<Fence> Fence::merge(const char* name, const std::vector<sp<Fence>>& fences) {
+    ATRACE_CALL();
+    std::vector<sp<Fence>> level;
+    level.reserve(fences.size());
+    for (const auto& fence : fences) {
+        if (fence != nullptr && fence->isValid()) {
+            level.push_back(fence);
+        }
+    }
+    if (level.empty()) {
+        return NO_FENCE;
+    }
+    if (level.size() == 1) {
+        return merge(name, level.front(), NO_FENCE);
+    }
+
+    // Each merged fence holds the sync points of both of its inputs, so merging
+    // neighbouring pairs copies every sync point log(N) times rather than up to
+    // N times when the fences are merged into one accumulated fence.
+    while (level.size() > 1) {
+        std::vector<sp<Fence>> next;
+        next.reserve((level.size() + 1) / 2);
+        for (size_t i = 0; i + 1 < level.size(); i += 2) {
+            sp<Fence> merged = merge(name, level[i], level[i + 1]);
+            if (!merged->isValid()) {
+                return NO_FENCE;
+            }
+            next.push_back(std::move(merged));
+        }
+        if (level.size() % 2 != 0) {
+            next.push_back(level.back());
+        }
+        level = std::move(next);
+    }
+    return level.front();
+}
+
+status_t Fence::pollSignaled(const std::vector<sp<Fence>>& fences,
+                             std::vector<bool>* outSignaled) {
+    ATRACE_CALL();
+    outSignaled->assign(fences.size(), true);
+
+    std::vector<pollfd> fds;
+    std::vector<size_t> indices;
+    fds.reserve(fences.size());
+    indices.reserve(fences.size());
+    for (size_t i = 0; i < fences.size(); i++) {
+        if (fences[i] != nullptr && fences[i]->isValid()) {
+            fds.push_back({.fd = fences[i]->get(), .events = POLLIN});
+            indices.push_back(i);
+        }
+    }
+    if (fds.empty()) {
+        return NO_ERROR;
+    }
+
+    int result;
+    do {
+        result = poll(fds.data(), fds.size(), 0);
+    } while (result == -1 && (errno == EINTR || errno == EAGAIN));
+    if (result == -1) {
+        return -errno;
+    }
+
+    for (size_t i = 0; i < fds.size(); i++) {
+        (*outSignaled)[indices[i]] = fds[i].revents != 0;
+    }
+    return NO_ERROR;
+}
+
 int Fence::dup() const {
     return ::dup(mFenceFd);
 }
@@ -24,6 +24,7 @@
 #include <stdlib.h>
 
 #include <memory>
+#include <vector>
 
 namespace android {
 
@@ -171,6 +172,11 @@ nsecs_t FenceTime::getSignalTime() {
     return signalTime;
 }
 
+sp<Fence> FenceTime::getPendingFence() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mFence.get() ? mFence : Fence::NO_FENCE;
+}
+
 nsecs_t FenceTime::getCachedSignalTime() const {
     // memory_order_acquire since we don't have a lock fallback path
     // that will do an acquire.
@@ -301,29 +307,46 @@ void FenceTimeline::push(const std::shared_ptr<FenceTime>& fence) {
             // we are removing it from the timeline.
             front->getSignalTime();
         }
-        mQueue.pop();
+        mQueue.pop_front();
     }
-    mQueue.push(fence);
+    mQueue.push_back(fence);
 }
 
 void FenceTimeline::updateSignalTimes() {
     std::lock_guard<std::mutex> lock(mMutex);
-    while (!mQueue.empty()) {
-        std::shared_ptr<FenceTime> fence = mQueue.front().lock();
-        if (!fence) {
-            // The shared_ptr no longer exists and no one cares about the
-            // timestamp anymore.
-            mQueue.pop();
-            continue;
-        } else if (fence->getSignalTime() != Fence::SIGNAL_TIME_PENDING) {
-            // The fence has signaled and we've removed the sp<Fence> ref.
-            mQueue.pop();
-            continue;
-        } else {
+    if (mQueue.empty()) {
+        return;
+    }
+
+    // Poll all of the pending fences at once, so that the signal time is only
+    // queried for the fences that have signaled. Querying the signal time of
+    // a fence is much more expensive than polling it.
+    std::vector<std::shared_ptr<FenceTime>> fenceTimes;
+    std::vector<sp<Fence>> fences;
+    fenceTimes.reserve(mQueue.size());
+    fences.reserve(mQueue.size());
+    for (const auto& weakFence : mQueue) {
+        std::shared_ptr<FenceTime> fenceTime = weakFence.lock();
+        fences.push_back(fenceTime ? fenceTime->getPendingFence() : Fence::NO_FENCE);
+        fenceTimes.push_back(std::move(fenceTime));
+    }
+
+    std::vector<bool> signaled;
+    if (Fence::pollSignaled(fences, &signaled) != NO_ERROR) {
+        // Fall back to querying the signal time of each fence.
+        signaled.assign(fences.size(), true);
+    }
+
+    for (size_t i = 0; i < fenceTimes.size(); i++) {
+        const std::shared_ptr<FenceTime>& fence = fenceTimes[i];
+        // Drop fences that no one cares about anymore, and fences that have
+        // signaled, for which getSignalTime() removes the sp<Fence> ref.
+        if (fence && (!signaled[i] || fence->getSignalTime() == Fence::SIGNAL_TIME_PENDING)) {
             // The fence didn't signal yet. Break since the later ones
             // shouldn't have signaled either.
             break;
         }
+        mQueue.pop_front();
     }
 }
 
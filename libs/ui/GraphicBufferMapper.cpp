@@ -134,11 +134,50 @@ status_t GraphicBufferMapper::freeBuffer(buffer_handle_t handle)
 {
     ATRACE_CALL();
 
+    {
+        std::lock_guard lock(mMetadataMutex);
+        mImmutableMetadata.erase(handle);
+    }
     mMapper->freeBuffer(handle);
 
     return NO_ERROR;
 }
 
+template <typename T, typename Query>
+status_t GraphicBufferMapper::getImmutableMetadata(buffer_handle_t bufferHandle,
+                                                   std::optional<T> ImmutableMetadata::*field,
+                                                   T* outValue, Query query) {
+    uint64_t generation;
+    {
+        std::lock_guard lock(mMetadataMutex);
+        auto [it, inserted] = mImmutableMetadata.try_emplace(bufferHandle);
+        if (inserted) {
+            it->second.generation = ++mMetadataGeneration;
+        } else if ((it->second.*field).has_value()) {
+            *outValue = *(it->second.*field);
+            return NO_ERROR;
+        }
+        generation = it->second.generation;
+    }
+
+    // Query and decode the metadata without the lock held. Errors are not cached.
+    T value;
+    const status_t status = query(&value);
+    if (status != NO_ERROR) {
+        return status;
+    }
+
+    // The buffer may have been freed while the metadata was queried, and its handle reused for
+    // another buffer. Its entry is then gone, or belongs to the other buffer.
+    std::lock_guard lock(mMetadataMutex);
+    if (const auto it = mImmutableMetadata.find(bufferHandle);
+        it != mImmutableMetadata.end() && it->second.generation == generation) {
+        it->second.*field = value;
+    }
+    *outValue = std::move(value);
+    return NO_ERROR;
+}
+
 ui::Result<LockResult> GraphicBufferMapper::lock(buffer_handle_t handle, int64_t usage,
                                                  const Rect& bounds, unique_fd&& acquireFence) {
     ATRACE_CALL();
@@ -251,17 +290,26 @@ status_t GraphicBufferMapper::getLayerCount(buffer_handle_t bufferHandle, uint64
 
 status_t GraphicBufferMapper::getPixelFormatRequested(buffer_handle_t bufferHandle,
                                                       ui::PixelFormat* outPixelFormatRequested) {
-    return mMapper->getPixelFormatRequested(bufferHandle, outPixelFormatRequested);
+    return getImmutableMetadata(bufferHandle, &ImmutableMetadata::pixelFormatRequested,
+                                outPixelFormatRequested, [&](ui::PixelFormat* value) {
+                                    return mMapper->getPixelFormatRequested(bufferHandle, value);
+                                });
 }
 
 status_t GraphicBufferMapper::getPixelFormatFourCC(buffer_handle_t bufferHandle,
                                                    uint32_t* outPixelFormatFourCC) {
-    return mMapper->getPixelFormatFourCC(bufferHandle, outPixelFormatFourCC);
+    return getImmutableMetadata(bufferHandle, &ImmutableMetadata::pixelFormatFourCC,
+                                outPixelFormatFourCC, [&](uint32_t* value) {
+                                    return mMapper->getPixelFormatFourCC(bufferHandle, value);
+                                });
 }
 
 status_t GraphicBufferMapper::getPixelFormatModifier(buffer_handle_t bufferHandle,
                                                      uint64_t* outPixelFormatModifier) {
-    return mMapper->getPixelFormatModifier(bufferHandle, outPixelFormatModifier);
+    return getImmutableMetadata(bufferHandle, &ImmutableMetadata::pixelFormatModifier,
+                                outPixelFormatModifier, [&](uint64_t* value) {
+                                    return mMapper->getPixelFormatModifier(bufferHandle, value);
+                                });
 }
 
 status_t GraphicBufferMapper::getUsage(buffer_handle_t bufferHandle, uint64_t* outUsage) {
@@ -270,7 +318,10 @@ status_t GraphicBufferMapper::getUsage(buffer_handle_t bufferHandle, uint64_t* o
 
 status_t GraphicBufferMapper::getAllocationSize(buffer_handle_t bufferHandle,
                                                 uint64_t* outAllocationSize) {
-    return mMapper->getAllocationSize(bufferHandle, outAllocationSize);
+    return getImmutableMetadata(bufferHandle, &ImmutableMetadata::allocationSize,
+                                outAllocationSize, [&](uint64_t* value) {
+                                    return mMapper->getAllocationSize(bufferHandle, value);
+                                });
 }
 
 status_t GraphicBufferMapper::getProtectedContent(buffer_handle_t bufferHandle,
@@ -313,13 +364,16 @@ status_t GraphicBufferMapper::getChromaSiting(buffer_handle_t bufferHandle,
 
 status_t GraphicBufferMapper::getPlaneLayouts(buffer_handle_t bufferHandle,
                                               std::vector<ui::PlaneLayout>* outPlaneLayouts) {
-    return mMapper->getPlaneLayouts(bufferHandle, outPlaneLayouts);
+    return getImmutableMetadata(bufferHandle, &ImmutableMetadata::planeLayouts, outPlaneLayouts,
+                                [&](std::vector<ui::PlaneLayout>* value) {
+                                    return mMapper->getPlaneLayouts(bufferHandle, value);
+                                });
 }
 
 ui::Result<std::vector<ui::PlaneLayout>> GraphicBufferMapper::getPlaneLayouts(
         buffer_handle_t bufferHandle) {
     std::vector<ui::PlaneLayout> temp;
-    status_t status = mMapper->getPlaneLayouts(bufferHandle, &temp);
+    status_t status = getPlaneLayouts(bufferHandle, &temp);
     if (status == OK) {
         return std::move(temp);
     } else {
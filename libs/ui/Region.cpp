@@ -643,6 +643,77 @@ bool Region::validate(const Region& reg, const char* name, bool silent)
     return result;
 }
 
+// Most operations on the visible and coverage regions of layers either have
+// sides which don't overlap, or a single rect which covers the other side. The
+// result is then one of the sides, or their intersection, which is found from
+// the bounds of the sides without rasterizing their spans.
+enum class TrivialResult { none, empty, lhs, rhs, intersection };
+
+static inline bool contains(const Rect& outer, const Rect& inner) {
+    return outer.left <= inner.left && outer.top <= inner.top &&
+            outer.right >= inner.right && outer.bottom >= inner.bottom;
+}
+
+static TrivialResult trivialResult(uint32_t op,
+        const Rect& lhsBounds, bool lhsIsRect,
+        const Rect& rhsBounds, bool rhsIsRect, Rect* intersection)
+{
+    if (rhsBounds.isEmpty()) {
+        return op == op_and ? TrivialResult::empty : TrivialResult::lhs;
+    }
+    if (lhsBounds.isEmpty()) {
+        return (op == op_or || op == op_xor) ? TrivialResult::rhs : TrivialResult::empty;
+    }
+    if (!lhsBounds.intersect(rhsBounds, intersection)) {
+        // Disjoint sides still need to be merged band by band for OR and XOR.
+        if (op == op_and) return TrivialResult::empty;
+        if (op == op_nand) return TrivialResult::lhs;
+        return TrivialResult::none;
+    }
+    if (rhsIsRect && contains(rhsBounds, lhsBounds)) {
+        if (op == op_and) return TrivialResult::lhs;
+        if (op == op_nand) return TrivialResult::empty;
+        if (op == op_or) return TrivialResult::rhs;
+    }
+    if (lhsIsRect && contains(lhsBounds, rhsBounds)) {
+        if (op == op_and) return TrivialResult::rhs;
+        if (op == op_or) return TrivialResult::lhs;
+    }
+    if (lhsIsRect && rhsIsRect && op == op_and) {
+        return TrivialResult::intersection;
+    }
+    return TrivialResult::none;
+}
+
+template <typename SetRhs>
+static bool trivialBooleanOperation(uint32_t op, Region& dst, const Region& lhs,
+        const Rect& rhsBounds, bool rhsIsRect, SetRhs setRhs)
+{
+    Rect intersection;
+    switch (trivialResult(op, lhs.getBounds(), lhs.isRect(), rhsBounds, rhsIsRect,
+            &intersection)) {
+        case TrivialResult::none:
+            return false;
+        case TrivialResult::empty:
+            dst.clear();
+            return true;
+        case TrivialResult::lhs:
+            if (lhs.isEmpty()) {
+                dst.clear();
+            } else {
+                dst = lhs;
+            }
+            return true;
+        case TrivialResult::rhs:
+            setRhs();
+            return true;
+        case TrivialResult::intersection:
+            dst.set(intersection);
+            return true;
+    }
+    return false;
+}
+
 void Region::boolean_operation(uint32_t op, Region& dst,
         const Region& lhs,
         const Region& rhs, int dx, int dy)
@@ -653,6 +724,15 @@ void Region::boolean_operation(uint32_t op, Region& dst,
     validate(dst, "boolean_operation (before): dst");
 #endif
 
+    Rect rhsBounds = rhs.getBounds();
+    rhsBounds.offsetBy(dx, dy);
+    if (trivialBooleanOperation(op, dst, lhs, rhsBounds, rhs.isRect(), [&] {
+            dst = rhs;
+            dst.translateSelf(dx, dy);
+        })) {
+        return;
+    }
+
     size_t lhs_count;
     Rect const * const lhs_rects = lhs.getArray(&lhs_count);
 
@@ -767,6 +847,12 @@ void Region::boolean_operation(uint32_t op, Region& dst,
 #if VALIDATE_WITH_CORECG || defined(VALIDATE_REGIONS)
     boolean_operation(op, dst, lhs, Region(rhs), dx, dy);
 #else
+    Rect rhsBounds(rhs);
+    rhsBounds.offsetBy(dx, dy);
+    if (trivialBooleanOperation(op, dst, lhs, rhsBounds, true, [&] { dst.set(rhsBounds); })) {
+        return;
+    }
+
     size_t lhs_count;
     Rect const * const lhs_rects = lhs.getArray(&lhs_count);
 
@@ -21,6 +21,7 @@
 
 #include <android-base/stringprintf.h>
 #include <cutils/compiler.h>
+#include <log/log.h>
 #include <ui/Region.h>
 #include <ui/Transform.h>
 #include <utils/String8.h>
@@ -84,6 +85,7 @@ Transform Transform::operator*(const Transform& rhs) const {
     // TODO: we could recompute this value from r and rhs
     r.mType &= 0xFF;
     r.mType |= UNKNOWN_TYPE;
+    r.type();
     return r;
 }
 
@@ -179,6 +181,7 @@ void Transform::set(float dsdx, float dtdy, float dtdx, float dsdy) {
     M[0][1] = dtdx;    M[1][1] = dsdy;
     M[0][2] = 0;       M[1][2] = 0;
     mType = UNKNOWN_TYPE;
+    type();
 }
 
 status_t Transform::set(uint32_t flags, float w, float h) {
@@ -258,6 +261,10 @@ Rect Transform::makeBounds(int w, int h) const {
 }
 
 Rect Transform::transform(const Rect& bounds, bool roundOutwards) const {
+    if (CC_LIKELY(preserveRects())) {
+        return transformPreservingRect(bounds, roundOutwards);
+    }
+
     Rect r;
     vec2 lt( bounds.left,  bounds.top    );
     vec2 rt( bounds.right, bounds.top    );
@@ -304,6 +311,49 @@ FloatRect Transform::transform(const FloatRect& bounds) const {
     return r;
 }
 
+void Transform::transform(std::span<const Rect> rects, std::span<Rect> out,
+                          bool roundOutwards) const {
+    LOG_ALWAYS_FATAL_IF(rects.size() != out.size(), "Mapping %zu rects to %zu", rects.size(),
+                        out.size());
+
+    if (CC_LIKELY(preserveRects())) {
+        for (size_t i = 0; i < rects.size(); i++) {
+            out[i] = transformPreservingRect(rects[i], roundOutwards);
+        }
+    } else {
+        for (size_t i = 0; i < rects.size(); i++) {
+            out[i] = transform(rects[i], roundOutwards);
+        }
+    }
+}
+
+// The image of a rect under a transform that preserves rects is spanned by the images of two
+// opposite corners. The off-axis terms of the matrix are exactly zero, so the two other corners
+// would yield the same coordinates.
+Rect Transform::transformPreservingRect(const Rect& bounds, bool roundOutwards) const {
+    const vec2 lt = transform(vec2(bounds.left, bounds.top));
+    const vec2 rb = transform(vec2(bounds.right, bounds.bottom));
+
+    const float left = std::min(lt[0], rb[0]);
+    const float top = std::min(lt[1], rb[1]);
+    const float right = std::max(lt[0], rb[0]);
+    const float bottom = std::max(lt[1], rb[1]);
+
+    Rect r;
+    if (roundOutwards) {
+        r.left   = static_cast<int32_t>(floorf(left));
+        r.top    = static_cast<int32_t>(floorf(top));
+        r.right  = static_cast<int32_t>(ceilf(right));
+        r.bottom = static_cast<int32_t>(ceilf(bottom));
+    } else {
+        r.left   = static_cast<int32_t>(floorf(left + 0.5f));
+        r.top    = static_cast<int32_t>(floorf(top + 0.5f));
+        r.right  = static_cast<int32_t>(floorf(right + 0.5f));
+        r.bottom = static_cast<int32_t>(floorf(bottom + 0.5f));
+    }
+    return r;
+}
+
 Region Transform::transform(const Region& reg) const {
     Region out;
     if (CC_UNLIKELY(type() > TRANSLATE)) {
@@ -311,7 +361,7 @@ Region Transform::transform(const Region& reg) const {
             Region::const_iterator it = reg.begin();
             Region::const_iterator const end = reg.end();
             while (it != end) {
-                out.orSelf(transform(*it++));
+                out.orSelf(transformPreservingRect(*it++, false));
             }
         } else {
             out.set(transform(reg.bounds()));
@@ -410,6 +460,7 @@ Transform Transform::inverse() const {
             // Recalculate the type if there is a 90-degree rotation component, since the inverse
             // of ROT_90 is ROT_270 and vice versa.
             result.mType |= UNKNOWN_TYPE;
+            result.type();
         }
 
         vec2 T(-x, -y);
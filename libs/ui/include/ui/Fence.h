@@ -24,6 +24,8 @@
 #include <utils/RefBase.h>
 #include <utils/Timers.h>
 
+#include <vector>
+
 namespace android {
 
 namespace mock {
@@ -98,6 +100,21 @@ public:
     static sp<Fence> merge(const String8& name, const sp<Fence>& f1,
             const sp<Fence>& f2);
 
+    // merge combines any number of Fence objects into a new Fence object that
+    // becomes signaled when all of them are signaled. Invalid fences are
+    // skipped, and NO_FENCE is returned if none is valid or on error. The
+    // fences are merged as a balanced tree, which copies fewer sync points
+    // than merging them one by one.
+    static sp<Fence> merge(const char* name, const std::vector<sp<Fence>>& fences);
+
+    // pollSignaled checks whether each of the given fences has signaled,
+    // without blocking and with a single system call for all of them. Invalid
+    // fences are reported as signaled, as most Fence methods treat them, and
+    // so are fences in an error state. Use it to skip the more expensive
+    // getSignalTime() for fences that are still pending.
+    static status_t pollSignaled(const std::vector<sp<Fence>>& fences,
+                                 std::vector<bool>* outSignaled);
+
     // Return a duplicate of the fence file descriptor. The caller is
     // responsible for closing the returned file descriptor. On error, -1 will
     // be returned and errno will indicate the problem.
@@ -23,18 +23,20 @@
 #include <utils/Timers.h>
 
 #include <atomic>
+#include <deque>
 #include <mutex>
-#include <queue>
 #include <unordered_map>
 
 namespace android {
 
+class FenceTimeline;
 class FenceToFenceTimeMap;
 
 // A wrapper around fence that only implements isValid and getSignalTime.
 // It automatically closes the fence in a thread-safe manner once the signal
 // time is known.
 class FenceTime {
+friend class FenceTimeline;
 friend class FenceToFenceTimeMap;
 public:
     // An atomic snapshot of the FenceTime that is flattenable.
@@ -126,6 +128,10 @@ private:
     // never return SIGNAL_TIME_INVALID and isValid will always return true.
     FenceTime(const sp<Fence>& fence, bool forceValidForTest);
 
+    // Returns the fence whose signal time is pending, or NO_FENCE once the
+    // signal time is known.
+    sp<Fence> getPendingFence() const;
+
     enum class State {
         VALID,
         INVALID,
@@ -169,7 +175,7 @@ public:
 
 private:
     mutable std::mutex mMutex;
-    std::queue<std::weak_ptr<FenceTime>> mQueue GUARDED_BY(mMutex);
+    std::deque<std::weak_ptr<FenceTime>> mQueue GUARDED_BY(mMutex);
 };
 
 // Used by test code to create or get FenceTimes for a given Fence.
@@ -21,6 +21,10 @@
 #include <sys/types.h>
 
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
 
 #include <android-base/unique_fd.h>
 #include <ui/GraphicTypes.h>
@@ -181,8 +185,30 @@ private:
 
     GraphicBufferMapper();
 
+    // Metadata that gralloc does not allow to change once a buffer is allocated. It is queried
+    // from the mapper the first time it is asked for, and dropped when the buffer is freed. Handles
+    // are reused once freed, so an entry is told apart from the entry of an earlier buffer with the
+    // same handle by its generation.
+    struct ImmutableMetadata {
+        uint64_t generation = 0;
+        std::optional<ui::PixelFormat> pixelFormatRequested;
+        std::optional<uint32_t> pixelFormatFourCC;
+        std::optional<uint64_t> pixelFormatModifier;
+        std::optional<uint64_t> allocationSize;
+        std::optional<std::vector<ui::PlaneLayout>> planeLayouts;
+    };
+
+    template <typename T, typename Query>
+    status_t getImmutableMetadata(buffer_handle_t bufferHandle,
+                                  std::optional<T> ImmutableMetadata::*field, T* outValue,
+                                  Query query);
+
     std::unique_ptr<const GrallocMapper> mMapper;
 
+    std::mutex mMetadataMutex;
+    std::unordered_map<buffer_handle_t, ImmutableMetadata> mImmutableMetadata;
+    uint64_t mMetadataGeneration = 0;
+
     Version mMapperVersion;
 };
 
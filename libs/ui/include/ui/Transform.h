@@ -20,6 +20,7 @@
 #include <sys/types.h>
 #include <array>
 #include <ostream>
+#include <span>
 #include <string>
 
 #include <math/mat4.h>
@@ -96,6 +97,10 @@ public:
     Rect    transform(const Rect& bounds,
                       bool roundOutwards = false) const;
     FloatRect transform(const FloatRect& bounds) const;
+    // Maps each of rects to the same index of out, as transform(rect, roundOutwards) does. out
+    // must have the same size as rects, and may be the same span.
+    void    transform(std::span<const Rect> rects, std::span<Rect> out,
+                      bool roundOutwards = false) const;
     Transform& operator = (const Transform& other);
     Transform operator * (const Transform& rhs) const;
     Transform operator * (float value) const;
@@ -125,6 +130,7 @@ private:
     enum { UNKNOWN_TYPE = 0x80000000 };
 
     uint32_t type() const;
+    Rect transformPreservingRect(const Rect& bounds, bool roundOutwards) const;
     static bool absIsOne(float f);
     static bool isZero(float f);
 
@@ -17,9 +17,12 @@
 #define LOG_TAG "GraphicBufferTest"
 
 #include <ui/GraphicBuffer.h>
+#include <ui/GraphicBufferMapper.h>
 
 #include <gtest/gtest.h>
 
+#include <thread>
+
 namespace android {
 
 namespace {
@@ -66,4 +69,58 @@ TEST_F(GraphicBufferTest, AllocateBadDimensions) {
     ASSERT_EQ(BAD_VALUE, gb2->initCheck());
 }
 
+static bool mapperSupportsMetadata() {
+    sp<GraphicBuffer> gb(new GraphicBuffer(kTestWidth, kTestHeight, PIXEL_FORMAT_RGBA_8888,
+                                           kTestLayerCount, kTestUsage, std::string("test")));
+    ui::PixelFormat formatRequested;
+    return gb->initCheck() == NO_ERROR &&
+            GraphicBufferMapper::get().getPixelFormatRequested(gb->handle, &formatRequested) ==
+            NO_ERROR;
+}
+
+// Allocates a buffer of the given format, and checks that the mapper reports it, both when it
+// queries gralloc and when it answers from its cache. Once a buffer is freed, its handle may be
+// reused for the next one.
+static void expectPixelFormatRequested(PixelFormat format) {
+    sp<GraphicBuffer> gb(new GraphicBuffer(kTestWidth, kTestHeight, format, kTestLayerCount,
+                                           kTestUsage, std::string("test")));
+    ASSERT_EQ(NO_ERROR, gb->initCheck());
+
+    for (int i = 0; i < 2; i++) {
+        ui::PixelFormat formatRequested;
+        ASSERT_EQ(NO_ERROR,
+                  GraphicBufferMapper::get().getPixelFormatRequested(gb->handle,
+                                                                     &formatRequested));
+        EXPECT_EQ(static_cast<ui::PixelFormat>(format), formatRequested);
+    }
+}
+
+TEST_F(GraphicBufferTest, MapperMetadataOfReusedHandle) {
+    if (!mapperSupportsMetadata()) {
+        GTEST_SKIP() << "The mapper does not support metadata queries";
+    }
+
+    for (int i = 0; i < 100; i++) {
+        expectPixelFormatRequested(i % 2 ? PIXEL_FORMAT_RGB_565 : PIXEL_FORMAT_RGBA_8888);
+    }
+}
+
+TEST_F(GraphicBufferTest, MapperMetadataWhileFreeingConcurrently) {
+    if (!mapperSupportsMetadata()) {
+        GTEST_SKIP() << "The mapper does not support metadata queries";
+    }
+
+    // Each thread frees its buffers while the other queries its own, so handles are reused across
+    // threads while their metadata is being cached.
+    std::thread other([] {
+        for (int i = 0; i < 100; i++) {
+            expectPixelFormatRequested(PIXEL_FORMAT_RGB_565);
+        }
+    });
+    for (int i = 0; i < 100; i++) {
+        expectPixelFormatRequested(PIXEL_FORMAT_RGBA_8888);
+    }
+    other.join();
+}
+
 } // namespace android
@@ -17,6 +17,10 @@
 #define LOG_TAG "RegionTest"
 
 #include <stdlib.h>
+
+#include <algorithm>
+#include <bitset>
+
 #include <ui/Region.h>
 #include <ui/Rect.h>
 #include <gtest/gtest.h>
@@ -152,6 +156,79 @@ TEST_F(RegionTest, Random_TJunction) {
     }
 }
 
+TEST_F(RegionTest, BooleanOperationsOnRects) {
+    const Rect screen(0, 0, 1080, 2400);
+    const Rect popup(100, 500, 980, 1500);
+    const Rect bar(0, 0, 1080, 100);
+
+    EXPECT_TRUE(Region(screen).intersect(popup).hasSameRects(Region(popup)));
+    EXPECT_TRUE(Region(popup).intersect(Region(screen)).hasSameRects(Region(popup)));
+    EXPECT_TRUE(Region(popup).subtract(screen).isEmpty());
+    EXPECT_TRUE(Region(popup).subtract(bar).hasSameRects(Region(popup)));
+    EXPECT_TRUE(Region(popup).intersect(bar).isEmpty());
+    EXPECT_TRUE(Region(screen).merge(popup).hasSameRects(Region(screen)));
+    EXPECT_TRUE(Region(popup).merge(Region(screen)).hasSameRects(Region(screen)));
+    EXPECT_TRUE(Region().merge(popup).hasSameRects(Region(popup)));
+    EXPECT_TRUE(Region(popup).intersect(Rect(0, 0, 200, 600)).hasSameRects(
+            Region(Rect(100, 500, 200, 600))));
+    EXPECT_TRUE(Region(popup).subtract(Region(screen), 50, 0).isEmpty());
+    EXPECT_TRUE(Region(bar).intersect(Region(popup), 0, -500).hasSameRects(
+            Region(Rect(100, 0, 980, 100))));
+}
+
+// Checks each operation, with and without an offset, against the same operation on bitmaps.
+TEST_F(RegionTest, Random_BooleanOperations) {
+    static constexpr int kSize = 12;
+    using Bitmap = std::bitset<kSize * kSize>;
+    auto toBitmap = [](const Region& region, int dx = 0, int dy = 0) {
+        Bitmap bitmap;
+        for (const Rect& rect : region) {
+            for (int y = std::max(rect.top + dy, 0); y < std::min(rect.bottom + dy, kSize); y++) {
+                for (int x = std::max(rect.left + dx, 0); x < std::min(rect.right + dx, kSize);
+                     x++) {
+                    bitmap.set(y * kSize + x);
+                }
+            }
+        }
+        return bitmap;
+    };
+    auto randomRegion = [] {
+        Region region;
+        for (int i = random() % 4; i > 0; i--) {
+            const int left = random() % kSize;
+            const int top = random() % kSize;
+            const Rect rect(left, top, left + random() % (kSize - left + 1),
+                            top + random() % (kSize - top + 1));
+            if (random() % 2) {
+                region.orSelf(rect);
+            } else {
+                region.subtractSelf(rect);
+            }
+        }
+        return region;
+    };
+    srandom(12345);
+
+    for (int iter = 0; iter < ITER_MAX * 10; iter++) {
+        const Region lhs = randomRegion();
+        const Region rhs = randomRegion();
+        const int dx = static_cast<int>(random() % 5) - 2;
+        const int dy = static_cast<int>(random() % 5) - 2;
+        const Bitmap l = toBitmap(lhs);
+        const Bitmap r = toBitmap(rhs);
+        const Bitmap rOffset = toBitmap(rhs, dx, dy);
+
+        EXPECT_EQ(toBitmap(lhs.intersect(rhs)), l & r);
+        EXPECT_EQ(toBitmap(lhs.subtract(rhs)), l & ~r);
+        EXPECT_EQ(toBitmap(lhs.merge(rhs)), l | r);
+        EXPECT_EQ(toBitmap(lhs.mergeExclusive(rhs)), l ^ r);
+        EXPECT_EQ(toBitmap(lhs.intersect(rhs, dx, dy)), l & rOffset);
+        EXPECT_EQ(toBitmap(lhs.subtract(rhs, dx, dy)), l & ~rOffset);
+        EXPECT_EQ(toBitmap(lhs.merge(rhs, dx, dy)), l | rOffset);
+        EXPECT_EQ(toBitmap(lhs.mergeExclusive(rhs, dx, dy)), l ^ rOffset);
+    }
+}
+
 TEST_F(RegionTest, EqualsToSelf) {
     Region touchableRegion;
     touchableRegion.orSelf(Rect(0, 0, 100, 100));
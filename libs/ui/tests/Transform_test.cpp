@@ -46,4 +46,45 @@ TEST(TransformTest, inverseRotation_hasCorrectType) {
     testRotationFlagsForInverse(Transform::FLIP_V, Transform::FLIP_V, false);
 }
 
+TEST(TransformTest, transformRects) {
+    const std::array<Rect, 3> rects = {Rect(0, 0, 10, 20), Rect(5, 7, 6, 30),
+                                       Rect(-3, -4, 2, 1)};
+
+    Transform scale;
+    scale.set(2.f, 0.f, 0.f, 0.5f);
+    scale.set(100.f, 200.f);
+
+    Transform skew;
+    skew.set(1.f, 0.5f, 0.25f, 1.f);
+
+    for (const Transform& t :
+         {Transform(), Transform(Transform::ROT_90, 100, 200),
+          Transform(Transform::ROT_270 | Transform::FLIP_H, 100, 200), scale, skew}) {
+        for (const bool roundOutwards : {false, true}) {
+            std::array<Rect, 3> out;
+            t.transform(rects, out, roundOutwards);
+            for (size_t i = 0; i < rects.size(); i++) {
+                EXPECT_EQ(t.transform(rects[i], roundOutwards), out[i]);
+            }
+        }
+    }
+
+    EXPECT_EQ(Rect(100, 200, 120, 210), scale.transform(rects[0]));
+    EXPECT_EQ(Rect(80, 0, 100, 10), Transform(Transform::ROT_90, 100, 200).transform(rects[0]));
+
+    // Mapping in place.
+    std::array<Rect, 3> inPlace = rects;
+    scale.transform(inPlace, inPlace);
+    EXPECT_EQ(scale.transform(rects[2]), inPlace[2]);
+}
+
+TEST(TransformTest, productHasKnownType) {
+    Transform scale;
+    scale.set(2.f, 0.f, 0.f, 2.f);
+    const Transform t = Transform(Transform::ROT_90, 100, 200) * scale;
+
+    EXPECT_EQ(Transform::ROTATE | Transform::SCALE | Transform::TRANSLATE, t.getType());
+    EXPECT_EQ(Transform::ROT_90, t.getOrientation());
+}
+
 } // namespace android::ui
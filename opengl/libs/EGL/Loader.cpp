@@ -155,7 +155,7 @@ int Loader::driver_t::set(void* hnd, int32_t api)
 }
 
 Loader::Loader()
-    : getProcAddress(nullptr)
+    : getProcAddress(nullptr), mGles1Pending(false), mGles1Dso(nullptr)
 {
 }
 
@@ -225,6 +225,11 @@ void Loader::unload_system_driver(egl_connection_t* cnx) {
                        ->hooks[egl_connection_t::GLESv1_INDEX]
                        ->gl);
     uninit_api(egl_names, (__eglMustCastToProperFunctionPointerType*)&cnx->egl);
+    {
+        std::lock_guard<std::mutex> lock(mGles1Lock);
+        mGles1Pending = false;
+        mGles1Dso = nullptr;
+    }
 
     if (cnx->dso) {
         ALOGD("Unload system gl driver.");
@@ -729,10 +734,10 @@ void Loader::initialize_api(void* dso, egl_connection_t* cnx, uint32_t mask) {
     }
 
     if (mask & GLESv1_CM) {
-        init_api(dso, gl_names_1, gl_names,
-            (__eglMustCastToProperFunctionPointerType*)
-                &cnx->hooks[egl_connection_t::GLESv1_INDEX]->gl,
-            getProcAddress);
+        // Deferred until the first GLES 1 context is created, see init_gles1_api
+        std::lock_guard<std::mutex> lock(mGles1Lock);
+        mGles1Pending = true;
+        mGles1Dso = dso;
     }
 
     if (mask & GLESv2) {
@@ -743,4 +748,18 @@ void Loader::initialize_api(void* dso, egl_connection_t* cnx, uint32_t mask) {
     }
 }
 
+void Loader::init_gles1_api(egl_connection_t* cnx) {
+    std::lock_guard<std::mutex> lock(mGles1Lock);
+    if (!mGles1Pending) {
+        return;
+    }
+
+    init_api(mGles1Dso, gl_names_1, gl_names,
+        (__eglMustCastToProperFunctionPointerType*)
+            &cnx->hooks[egl_connection_t::GLESv1_INDEX]->gl,
+        getProcAddress);
+    mGles1Pending = false;
+    mGles1Dso = nullptr;
+}
+
 } // namespace android
@@ -20,6 +20,8 @@
 #include <EGL/egl.h>
 #include <stdint.h>
 
+#include <mutex>
+
 namespace android {
 
 struct egl_connection_t;
@@ -43,6 +45,13 @@ class Loader {
 
     getProcAddressType getProcAddress;
 
+    // Most processes never create a GLES 1 context, so the GLESv1_CM entry points of the driver
+    // are only resolved when the first one is created. Until then, mGles1Dso is the library to
+    // resolve them from.
+    std::mutex mGles1Lock;
+    bool mGles1Pending;
+    void* mGles1Dso;
+
 public:
     static Loader& getInstance();
     ~Loader();
@@ -50,6 +59,10 @@ public:
     void* open(egl_connection_t* cnx);
     void close(egl_connection_t* cnx);
 
+    // Fills the GLESv1_CM hooks of the loaded driver, if that hasn't been done yet. This must be
+    // called before a GLES 1 context is handed out.
+    void init_gles1_api(egl_connection_t* cnx);
+
 private:
     Loader();
     driver_t* attempt_to_load_angle(egl_connection_t* cnx);
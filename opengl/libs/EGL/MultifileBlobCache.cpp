@@ -35,6 +35,7 @@
 #include <chrono>
 #include <limits>
 #include <locale>
+#include <vector>
 
 #include <utils/JenkinsHash.h>
 
@@ -425,9 +426,9 @@ EGLsizeiANDROID MultifileBlobCache::get(const void* key, EGLsizeiANDROID keySize
     uint8_t* cacheEntry = 0;
 
     // Check hot cache
-    if (mHotCache.find(entryHash) != mHotCache.end()) {
+    if (auto hotCacheIter = mHotCache.find(entryHash); hotCacheIter != mHotCache.end()) {
         ALOGV("GET: HotCache HIT for entry %u", entryHash);
-        cacheEntry = mHotCache[entryHash].entryBuffer;
+        cacheEntry = hotCacheIter->second.entryBuffer;
     } else {
         ALOGV("GET: HotCache MISS for entry: %u", entryHash);
 
@@ -469,8 +470,6 @@ EGLsizeiANDROID MultifileBlobCache::get(const void* key, EGLsizeiANDROID keySize
             ALOGE("GET: Failed to add %u to hot cache", entryHash);
             return 0;
         }
-
-        cacheEntry = mHotCache[entryHash].entryBuffer;
     }
 
     // Ensure the header matches
@@ -496,6 +495,9 @@ EGLsizeiANDROID MultifileBlobCache::get(const void* key, EGLsizeiANDROID keySize
     uint8_t* cachedValue = cacheEntry + (keySize + sizeof(MultifileHeader));
     memcpy(value, cachedValue, cachedValueSize);
 
+    // Track the access so that trimming removes the least recently used entries first
+    mEntryStats[entryHash].accessTime = time(0);
+
     return cachedValueSize;
 }
 
@@ -717,10 +719,18 @@ bool MultifileBlobCache::removeFromHotCache(uint32_t entryHash) {
 }
 
 bool MultifileBlobCache::applyLRU(size_t cacheSizeLimit, size_t cacheEntryLimit) {
-    // Walk through our map of sorted last access times and remove files until under the limit
-    for (auto cacheEntryIter = mEntryStats.begin(); cacheEntryIter != mEntryStats.end();) {
-        uint32_t entryHash = cacheEntryIter->first;
-
+    // Sort the entries by last access time, oldest first
+    std::vector<std::pair<time_t, uint32_t>> entriesByAccessTime;
+    entriesByAccessTime.reserve(mEntryStats.size());
+    for (const auto& [entryHash, entryStats] : mEntryStats) {
+        entriesByAccessTime.emplace_back(entryStats.accessTime, entryHash);
+    }
+    std::sort(entriesByAccessTime.begin(), entriesByAccessTime.end());
+
+    // Walk through the sorted last access times and remove files until under the limit
+    bool reduced = false;
+    std::vector<std::string> removedPaths;
+    for (const auto& [accessTime, entryHash] : entriesByAccessTime) {
         ALOGV("LRU: Removing entryHash %u", entryHash);
 
         // Track the overall size
@@ -730,22 +740,10 @@ bool MultifileBlobCache::applyLRU(size_t cacheSizeLimit, size_t cacheEntryLimit)
         // Remove it from hot cache if present
         removeFromHotCache(entryHash);
 
-        // Remove it from the system
-        std::string entryPath = mMultifileDirName + "/" + std::to_string(entryHash);
-        if (remove(entryPath.c_str()) != 0) {
-            ALOGE("LRU: Error removing %s: %s", entryPath.c_str(), std::strerror(errno));
-            return false;
-        }
-
-        // Increment the iterator before clearing the entry
-        cacheEntryIter++;
-
         // Delete the entry from our tracking
-        size_t count = mEntryStats.erase(entryHash);
-        if (count != 1) {
-            ALOGE("LRU: Failed to remove entryHash (%u) from mEntryStats", entryHash);
-            return false;
-        }
+        mEntries.erase(entryHash);
+        mEntryStats.erase(entryHash);
+        removedPaths.push_back(mMultifileDirName + "/" + std::to_string(entryHash));
 
         // See if it has been reduced enough
         size_t totalCacheSize = getTotalSize();
@@ -753,12 +751,24 @@ bool MultifileBlobCache::applyLRU(size_t cacheSizeLimit, size_t cacheEntryLimit)
         if (totalCacheSize <= cacheSizeLimit && totalCacheEntries <= cacheEntryLimit) {
             // Success
             ALOGV("LRU: Reduced cache to size %zu entries %zu", totalCacheSize, totalCacheEntries);
-            return true;
+            reduced = true;
+            break;
         }
     }
 
-    ALOGV("LRU: Cache is empty");
-    return false;
+    // Remove the files on the worker thread rather than blocking the caller on every unlink.
+    // Tasks run in order, so a later write of the same entry recreates the file after it has been
+    // removed. This is queued after the loop, as removeFromHotCache waits for the queue to drain.
+    for (std::string& removedPath : removedPaths) {
+        DeferredTask task(TaskCommand::RemoveFromDisk);
+        task.initRemoveFromDisk(std::move(removedPath));
+        queueTask(std::move(task));
+    }
+
+    if (!reduced) {
+        ALOGV("LRU: Cache is empty");
+    }
+    return reduced;
 }
 
 // Clear the cache by removing all entries and deleting the directory
@@ -814,7 +824,7 @@ void MultifileBlobCache::trimCache() {
     }
 }
 
-// This function performs a task.  It only knows how to write files to disk,
+// This function performs a task.  It only knows how to write files to disk and remove them,
 // but it could be expanded if needed.
 void MultifileBlobCache::processTask(DeferredTask& task) {
     switch (task.getTaskCommand()) {
@@ -872,6 +882,16 @@ void MultifileBlobCache::processTask(DeferredTask& task) {
 
             return;
         }
+        case TaskCommand::RemoveFromDisk: {
+            std::string& fullPath = task.getFullPath();
+            if (remove(fullPath.c_str()) != 0) {
+                ALOGE("LRU: Error removing %s: %s", fullPath.c_str(), std::strerror(errno));
+                return;
+            }
+
+            ALOGV("DEFERRED: Removed %s", fullPath.c_str());
+            return;
+        }
         default: {
             ALOGE("DEFERRED: Unhandled task type");
             return;
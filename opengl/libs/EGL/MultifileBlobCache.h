@@ -66,6 +66,7 @@ struct MultifileHotCache {
 enum class TaskCommand {
     Invalid = 0,
     WriteToDisk,
+    RemoveFromDisk,
     Exit,
 };
 
@@ -85,6 +86,11 @@ public:
         mBufferSize = bufferSize;
     }
 
+    void initRemoveFromDisk(std::string fullPath) {
+        mCommand = TaskCommand::RemoveFromDisk;
+        mFullPath = std::move(fullPath);
+    }
+
     uint32_t getEntryHash() { return mEntryHash; }
     std::string& getFullPath() { return mFullPath; }
     uint8_t* getBuffer() { return mBuffer; }
@@ -93,7 +99,7 @@ public:
 private:
     TaskCommand mCommand;
 
-    // Parameters for WriteToDisk
+    // Parameters for WriteToDisk, RemoveFromDisk only uses the path
     uint32_t mEntryHash;
     std::string mFullPath;
     uint8_t* mBuffer;
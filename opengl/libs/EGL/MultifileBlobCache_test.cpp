@@ -503,4 +503,32 @@ TEST_F(MultifileBlobCacheTest, MismatchedBuildIdClears) {
     ASSERT_EQ(getCacheEntries().size(), 0);
 }
 
+// Verify trimming the cache removes the files of the entries it drops
+TEST_F(MultifileBlobCacheTest, TrimRemovesEntryFiles) {
+    // Fill the cache with max entries, then add another one to trigger a trim
+    for (int i = 0; i <= kMaxTotalEntries; i++) {
+        mMBC->set(&i, sizeof(i), &i, sizeof(i));
+    }
+    ASSERT_EQ(mMBC->getTotalEntries(), kMaxTotalEntries / 2 + 1);
+
+    // Close the cache so the deferred writes and removals complete
+    mMBC->finish();
+
+    // Only the entries that survived the trim are left on disk
+    ASSERT_EQ(getCacheEntries().size(), kMaxTotalEntries / 2 + 1);
+
+    // And only those entries are returned
+    mMBC.reset(new MultifileBlobCache(kMaxKeySize, kMaxValueSize, kMaxTotalSize, kMaxTotalEntries,
+                                      &mTempFile->path[0]));
+    size_t hits = 0;
+    for (int i = 0; i <= kMaxTotalEntries; i++) {
+        int result = 0;
+        if (mMBC->get(&i, sizeof(i), &result, sizeof(result)) == sizeof(i)) {
+            ASSERT_EQ(i, result);
+            hits++;
+        }
+    }
+    ASSERT_EQ(hits, kMaxTotalEntries / 2 + 1);
+}
+
 } // namespace android
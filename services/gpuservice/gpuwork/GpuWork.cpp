@@ -20,6 +20,7 @@
 
 #include "gpuwork/GpuWork.h"
 
+#include <android-base/properties.h>
 #include <android-base/stringprintf.h>
 #include <binder/PermissionCache.h>
 #include <bpf/WaitForProgsLoaded.h>
@@ -32,6 +33,7 @@
 #include <utils/Timers.h>
 #include <utils/Trace.h>
 
+#include <algorithm>
 #include <bit>
 #include <chrono>
 #include <cstdint>
@@ -142,6 +144,13 @@ void GpuWork::initialize() {
         mPreviousMapClearTimePoint = std::chrono::steady_clock::now();
     }
 
+    mAggregationWindow = std::chrono::seconds{
+            base::GetUintProperty<uint32_t>("gpuservice.gpu_work.aggregation_window_s",
+                                            kDefaultAggregationWindowSeconds,
+                                            kMaxAggregationWindowSeconds)};
+    mAggregationWindow = std::max(mAggregationWindow,
+                                  std::chrono::seconds{kMinAggregationWindowSeconds});
+
     // Attach the tracepoint.
     if (!attachTracepoint("/sys/fs/bpf/prog_gpuWork_tracepoint_power_gpu_work_period", "power",
                           "gpu_work_period")) {
@@ -171,51 +180,37 @@ void GpuWork::dump(const Vector<String16>& /* args */, std::string* result) {
         return;
     }
 
-    // Ordered map ensures output data is sorted.
-    std::map<GpuIdUid, UidTrackingInfo, decltype(lessThanGpuIdUid)*> dumpMap(&lessThanGpuIdUid);
-
+    // Dumps only read the summary of the last aggregation window, so that they
+    // never wait for |mMutex| while the map is being read or cleared.
+    std::shared_ptr<const Summary> summary;
     {
-        std::lock_guard<std::mutex> lock(mMutex);
-
-        if (!mGpuWorkMap.isValid()) {
-            result->append("GPU work map is not available.\n");
-            return;
-        }
-
-        // Iteration of BPF hash maps can be unreliable (no data races, but elements
-        // may be repeated), as the map is typically being modified by other
-        // threads. The buckets are all preallocated. Our eBPF program only updates
-        // entries (in-place) or adds entries. |GpuWork| only iterates or clears the
-        // map while holding |mMutex|. Given this, we should be able to iterate over
-        // all elements reliably. Nevertheless, we copy into a map to avoid
-        // duplicates.
-
-        // Note that userspace reads of BPF maps make a copy of the value, and
-        // thus the returned value is not being concurrently accessed by the BPF
-        // program (no atomic reads needed below).
+        std::lock_guard<std::mutex> lock(mSummaryMutex);
+        summary = mSummary;
+    }
 
-        mGpuWorkMap.iterateWithValue(
-                [&dumpMap](const GpuIdUid& key, const UidTrackingInfo& value,
-                           const android::bpf::BpfMap<GpuIdUid, UidTrackingInfo>&)
-                        -> base::Result<void> {
-                    dumpMap[key] = value;
-                    return {};
-                });
+    if (!summary) {
+        result->append("GPU work map is not available.\n");
+        return;
     }
 
     // Dump work information.
     // E.g.
-    // GPU work information.
+    // GPU work information, as of 12s ago (aggregation window: 60s).
     // gpu_id uid total_active_duration_ns total_inactive_duration_ns
     // 0 1000 0 0
     // 0 1003 1234 123
     // [errors:3]0 1006 4567 456
 
     // Header.
-    result->append("GPU work information.\ngpu_id uid total_active_duration_ns "
-                   "total_inactive_duration_ns\n");
-
-    for (const auto& idToUidInfo : dumpMap) {
+    const auto age = std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::steady_clock::now() - summary->timePoint);
+    StringAppendF(result,
+                  "GPU work information, as of %llds ago (aggregation window: %llds).\n",
+                  static_cast<long long>(age.count()),
+                  static_cast<long long>(mAggregationWindow.count()));
+    result->append("gpu_id uid total_active_duration_ns total_inactive_duration_ns\n");
+
+    for (const auto& idToUidInfo : summary->entries) {
         if (idToUidInfo.second.error_count) {
             StringAppendF(result, "[errors:%" PRIu32 "]", idToUidInfo.second.error_count);
         }
@@ -452,14 +447,46 @@ void GpuWork::periodicallyClearMap() {
             // We only update |previousTime| if we actually checked the map.
             previousTime = nextTime;
         }
-        // Sleep for ~1 hour. It does not matter if we don't check the map for 2
-        // hours.
-        mIsTerminatingConditionVariable.wait_for(lock,
-                                                 std::chrono::seconds{
-                                                         kMapClearerWaitDurationSeconds});
+        summarizeMap();
+        // Sleep until the end of the aggregation window. It does not matter if
+        // we check whether to clear the map up to one window late.
+        mIsTerminatingConditionVariable.wait_for(lock, mAggregationWindow);
     }
 }
 
+void GpuWork::summarizeMap() {
+    ATRACE_CALL();
+
+    if (!mGpuWorkMap.isValid()) {
+        return;
+    }
+
+    // See |pullWorkAtoms| about iterating |mGpuWorkMap|; the ordered map also
+    // drops any repeated elements.
+    std::map<GpuIdUid, UidTrackingInfo, decltype(lessThanGpuIdUid)*> workMap(&lessThanGpuIdUid);
+    mGpuWorkMap.iterateWithValue([&workMap](const GpuIdUid& key, const UidTrackingInfo& value,
+                                            const android::bpf::BpfMap<GpuIdUid, UidTrackingInfo>&)
+                                         -> base::Result<void> {
+        workMap[key] = value;
+        return {};
+    });
+
+    auto summary = std::make_shared<Summary>();
+    summary->timePoint = std::chrono::steady_clock::now();
+    summary->entries.assign(workMap.begin(), workMap.end());
+    publishSummary(std::move(summary));
+}
+
+void GpuWork::publishSummary(std::shared_ptr<const Summary> summary) {
+    std::shared_ptr<const Summary> previousSummary;
+    {
+        std::lock_guard<std::mutex> lock(mSummaryMutex);
+        previousSummary = std::exchange(mSummary, std::move(summary));
+    }
+    // |previousSummary| is freed here, outside of |mSummaryMutex|, unless a
+    // dump still holds it.
+}
+
 void GpuWork::clearMapIfNeeded() {
     if (!mInitialized.load() || !mGpuWorkMap.isValid() || !mGpuWorkGlobalDataMap.isValid()) {
         ALOGW("Map clearing could not occur because we are not initialized properly");
@@ -528,6 +555,11 @@ void GpuWork::clearMap() {
     // Update |mPreviousMapClearTimePoint| so we know when we started collecting
     // the stats.
     mPreviousMapClearTimePoint = std::chrono::steady_clock::now();
+
+    // Don't keep dumping the stats that were just cleared.
+    auto summary = std::make_shared<Summary>();
+    summary->timePoint = mPreviousMapClearTimePoint;
+    publishSummary(std::move(summary));
 }
 
 void GpuWork::waitForPermissions() {
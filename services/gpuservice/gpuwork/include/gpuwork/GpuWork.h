@@ -22,10 +22,14 @@
 #include <utils/String16.h>
 #include <utils/Vector.h>
 
+#include <chrono>
 #include <condition_variable>
 #include <cstdint>
 #include <functional>
+#include <memory>
 #include <thread>
+#include <utility>
+#include <vector>
 
 #include "gpuwork/gpuWork.h"
 
@@ -58,14 +62,28 @@ private:
 
     AStatsManager_PullAtomCallbackReturn pullWorkAtoms(AStatsEventList* data);
 
-    // Periodically calls |clearMapIfNeeded| to clear the |mGpuWorkMap| map, if
-    // needed.
+    // A copy of |mGpuWorkMap| taken at the end of an aggregation window, sorted
+    // by GPU ID and then UID.
+    struct Summary {
+        std::chrono::steady_clock::time_point timePoint;
+        std::vector<std::pair<GpuIdUid, UidTrackingInfo>> entries;
+    };
+
+    // Every aggregation window, calls |summarizeMap| and, every ~1 hour, calls
+    // |clearMapIfNeeded| to clear the |mGpuWorkMap| map, if needed.
     //
     // Thread safety analysis is skipped because we need to use
     // |std::unique_lock|, which is not currently supported by thread safety
     // analysis.
     void periodicallyClearMap() NO_THREAD_SAFETY_ANALYSIS;
 
+    // Copies |mGpuWorkMap| into a new |Summary| and publishes it.
+    void summarizeMap() REQUIRES(mMutex);
+
+    // Publishes |summary| for |dump|. Only the pointer swap is done under
+    // |mSummaryMutex|, so readers never wait for the map to be read.
+    void publishSummary(std::shared_ptr<const Summary> summary);
+
     // Checks whether the |mGpuWorkMap| map is nearly full and, if so, clears
     // it.
     void clearMapIfNeeded() REQUIRES(mMutex);
@@ -103,6 +121,18 @@ private:
     // A condition variable for |mIsTerminating|.
     std::condition_variable mIsTerminatingConditionVariable GUARDED_BY(mMutex);
 
+    // Mutex for |mSummary|. It is never held while |mMutex| is acquired, and
+    // only ever held to copy or replace the pointer.
+    std::mutex mSummaryMutex;
+
+    // The summary of the last aggregation window, or null before the first
+    // one ends.
+    std::shared_ptr<const Summary> mSummary GUARDED_BY(mSummaryMutex);
+
+    // How often |mGpuWorkMap| is summarized for |dump|, set from the
+    // gpuservice.gpu_work.aggregation_window_s property.
+    std::chrono::seconds mAggregationWindow{kDefaultAggregationWindowSeconds};
+
     // 30 second timeout for trying to attach a BPF program to a tracepoint.
     static constexpr int kGpuWaitTimeoutSeconds = 30;
 
@@ -110,6 +140,12 @@ private:
     // every ~1 hour.
     static constexpr uint32_t kMapClearerWaitDurationSeconds = 60 * 60;
 
+    // The default, minimum and maximum aggregation windows. The window is
+    // never longer than the map clearer wait duration.
+    static constexpr uint32_t kDefaultAggregationWindowSeconds = 60;
+    static constexpr uint32_t kMinAggregationWindowSeconds = 1;
+    static constexpr uint32_t kMaxAggregationWindowSeconds = kMapClearerWaitDurationSeconds;
+
     // Whether our |pullAtomCallback| function is registered.
     bool mStatsdRegistered GUARDED_BY(mMutex) = false;
 
@@ -352,7 +352,7 @@ MotionEvent toMotionEvent(const NotifyMotionArgs& args, const ui::Transform* tra
                      args.buttonState, args.classification, *transform, args.xPrecision,
                      args.yPrecision, args.xCursorPosition, args.yCursorPosition, *rawTransform,
                      args.downTime, args.eventTime, args.getPointerCount(),
-                     args.pointerProperties.data(), args.pointerCoords.data());
+                     args.pointerProperties.begin(), args.pointerCoords.begin());
     return event;
 }
 
@@ -277,6 +277,7 @@ void InputDeviceMetricsCollector::onInputDeviceUsage(DeviceId deviceId, nanoseco
     for (InputDeviceUsageSource source : getSources(infoIt->second)) {
         sessionIt->second.recordUsage(eventTime, source);
     }
+    mNextSessionExpiryTime = std::min(mNextSessionExpiryTime, eventTime + mUsageSessionTimeout);
 }
 
 void InputDeviceMetricsCollector::onInputDeviceInteraction(const Interaction& interaction) {
@@ -286,6 +287,8 @@ void InputDeviceMetricsCollector::onInputDeviceInteraction(const Interaction& in
     }
 
     activeSessionIt->second.recordInteraction(interaction);
+    mNextSessionExpiryTime =
+            std::min(mNextSessionExpiryTime, activeSessionIt->second.getNextExpiryTime());
 }
 
 void InputDeviceMetricsCollector::reportCompletedSessions() {
@@ -296,12 +299,20 @@ void InputDeviceMetricsCollector::reportCompletedSessions() {
     }
 
     const auto currentTime = mLogger.getCurrentTime();
+    if (currentTime < mNextSessionExpiryTime) {
+        // Nothing can have expired yet. This is the common case for a stream of input events.
+        return;
+    }
     std::vector<DeviceId> completedUsageSessions;
+    mNextSessionExpiryTime = nanoseconds::max();
 
     // Process usages for all active session to determine if any sessions have expired.
     for (auto& [deviceId, activeSession] : mActiveUsageSessions) {
         if (activeSession.checkIfCompletedAt(currentTime)) {
             completedUsageSessions.emplace_back(deviceId);
+        } else {
+            mNextSessionExpiryTime =
+                    std::min(mNextSessionExpiryTime, activeSession.getNextExpiryTime());
         }
     }
 
@@ -385,6 +396,17 @@ bool InputDeviceMetricsCollector::ActiveSession::checkIfCompletedAt(nanoseconds
     return mActiveSessionsBySource.empty();
 }
 
+nanoseconds InputDeviceMetricsCollector::ActiveSession::getNextExpiryTime() const {
+    nanoseconds earliestEnd = nanoseconds::max();
+    for (const auto& [_, session] : mActiveSessionsBySource) {
+        earliestEnd = std::min(earliestEnd, session.end);
+    }
+    for (const auto& [_, session] : mActiveSessionsByUid) {
+        earliestEnd = std::min(earliestEnd, session.end);
+    }
+    return earliestEnd == nanoseconds::max() ? earliestEnd : earliestEnd + mUsageSessionTimeout;
+}
+
 InputDeviceMetricsLogger::DeviceUsageReport
 InputDeviceMetricsCollector::ActiveSession::finishSession() {
     const auto deviceUsageDuration = mDeviceSession.end - mDeviceSession.start;
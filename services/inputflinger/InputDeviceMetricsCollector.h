@@ -151,6 +151,8 @@ private:
         void recordUsage(std::chrono::nanoseconds eventTime, InputDeviceUsageSource source);
         void recordInteraction(const Interaction&);
         bool checkIfCompletedAt(std::chrono::nanoseconds timestamp);
+        // The earliest time at which a source or uid session of this device can expire.
+        std::chrono::nanoseconds getNextExpiryTime() const;
         InputDeviceMetricsLogger::DeviceUsageReport finishSession();
 
     private:
@@ -171,6 +173,11 @@ private:
 
     // The input devices that currently have active usage sessions.
     std::map<DeviceId, ActiveSession> mActiveUsageSessions GUARDED_BY(mLock);
+    // No session can expire before this time, so there is no need to look for completed sessions
+    // until then. Usage only ever extends sessions, so this can be lowered as events arrive, and
+    // it is recomputed exactly whenever the sessions are checked.
+    std::chrono::nanoseconds mNextSessionExpiryTime GUARDED_BY(mLock){
+            std::chrono::nanoseconds::max()};
 
     void onInputDevicesChanged(const std::vector<InputDeviceInfo>& infos) REQUIRES(mLock);
     void onInputDeviceRemoved(DeviceId deviceId, const MetricsDeviceInfo& info) REQUIRES(mLock);
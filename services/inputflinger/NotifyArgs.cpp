@@ -64,7 +64,7 @@ NotifyMotionArgs::NotifyMotionArgs(
         int32_t edgeFlags, uint32_t pointerCount, const PointerProperties* pointerProperties,
         const PointerCoords* pointerCoords, float xPrecision, float yPrecision,
         float xCursorPosition, float yCursorPosition, nsecs_t downTime,
-        const std::vector<TouchVideoFrame>& videoFrames)
+        std::vector<TouchVideoFrame> videoFrames)
       : id(id),
         eventTime(eventTime),
         deviceId(deviceId),
@@ -84,7 +84,7 @@ NotifyMotionArgs::NotifyMotionArgs(
         yCursorPosition(yCursorPosition),
         downTime(downTime),
         readTime(readTime),
-        videoFrames(videoFrames) {
+        videoFrames(std::move(videoFrames)) {
     for (uint32_t i = 0; i < pointerCount; i++) {
         this->pointerProperties.emplace_back(pointerProperties[i]);
         this->pointerCoords.emplace_back(pointerCoords[i]);
@@ -54,7 +54,11 @@ bool isHoverAction(int32_t action) {
 }
 
 bool isStylusHoverEvent(const NotifyMotionArgs& args) {
-    return isStylusEvent(args.source, args.pointerProperties) && isHoverAction(args.action);
+    return isFromSource(args.source, AINPUT_SOURCE_STYLUS) && isHoverAction(args.action) &&
+            std::any_of(args.pointerProperties.begin(), args.pointerProperties.end(),
+                        [](const PointerProperties& properties) {
+                            return isStylusToolType(properties.toolType);
+                        });
 }
 
 bool isMouseOrTouchpad(uint32_t sources) {
@@ -239,12 +243,17 @@ NotifyMotionArgs PointerChoreographer::processMouseEventLocked(const NotifyMotio
         const float deltaY = args.yCursorPosition - y;
         newArgs.pointerCoords[0].setAxisValue(AMOTION_EVENT_AXIS_RELATIVE_X, deltaX);
         newArgs.pointerCoords[0].setAxisValue(AMOTION_EVENT_AXIS_RELATIVE_Y, deltaY);
-        pc.setPosition(args.xCursorPosition, args.yCursorPosition);
+        if (deltaX != 0 || deltaY != 0) {
+            pc.setPosition(args.xCursorPosition, args.yCursorPosition);
+        }
     } else {
         // This is a relative mouse, so move the cursor by the specified amount.
         const float deltaX = args.pointerCoords[0].getAxisValue(AMOTION_EVENT_AXIS_RELATIVE_X);
         const float deltaY = args.pointerCoords[0].getAxisValue(AMOTION_EVENT_AXIS_RELATIVE_Y);
-        pc.move(deltaX, deltaY);
+        // Button and scroll events don't move the cursor, so skip the controller update for them.
+        if (deltaX != 0 || deltaY != 0) {
+            pc.move(deltaX, deltaY);
+        }
         const auto [x, y] = pc.getPosition();
         newArgs.pointerCoords[0].setAxisValue(AMOTION_EVENT_AXIS_X, x);
         newArgs.pointerCoords[0].setAxisValue(AMOTION_EVENT_AXIS_Y, y);
@@ -359,7 +368,7 @@ void PointerChoreographer::processTouchscreenAndStylusEventLocked(const NotifyMo
 
     PointerControllerInterface& pc = *it->second;
 
-    const PointerCoords* coords = args.pointerCoords.data();
+    const PointerCoords* coords = args.pointerCoords.begin();
     const int32_t maskedAction = MotionEvent::getActionMasked(args.action);
     const uint8_t actionIndex = MotionEvent::getActionIndex(args.action);
     std::array<uint32_t, MAX_POINTER_ID + 1> idToIndex;
@@ -566,6 +566,7 @@ PalmRejector::PalmRejector(const AndroidPalmFilterDeviceInfo& info,
       : mSharedPalmState(std::make_unique<::ui::SharedPalmDetectionFilterState>()),
         mDeviceInfo(info),
         mPalmDetectionFilter(std::move(filter)) {
+    mTouches.reserve(::ui::kNumTouchEvdevSlots);
     if (mPalmDetectionFilter != nullptr) {
         // This path is used for testing. Non-testing invocations should let this constructor
         // create a real PalmDetectionFilter
@@ -582,6 +583,14 @@ std::vector<::ui::InProgressTouchEvdev> getTouches(const NotifyMotionArgs& args,
                                                    const SlotState& oldSlotState,
                                                    const SlotState& newSlotState) {
     std::vector<::ui::InProgressTouchEvdev> touches;
+    getTouches(args, deviceInfo, oldSlotState, newSlotState, touches);
+    return touches;
+}
+
+void getTouches(const NotifyMotionArgs& args, const AndroidPalmFilterDeviceInfo& deviceInfo,
+                const SlotState& oldSlotState, const SlotState& newSlotState,
+                std::vector<::ui::InProgressTouchEvdev>& touches) {
+    touches.clear();
 
     for (size_t i = 0; i < args.getPointerCount(); i++) {
         const int32_t pointerId = args.pointerProperties[i].id;
@@ -641,7 +650,6 @@ std::vector<::ui::InProgressTouchEvdev> getTouches(const NotifyMotionArgs& args,
         // The field 'reported_tool_type' is not used for palm rejection
         touches.back().stylus_button = false;
     }
-    return touches;
 }
 
 std::set<int32_t> PalmRejector::detectPalmPointers(const NotifyMotionArgs& args) {
@@ -649,12 +657,18 @@ std::set<int32_t> PalmRejector::detectPalmPointers(const NotifyMotionArgs& args)
     std::bitset<::ui::kNumTouchEvdevSlots> slotsToSuppress;
 
     // Store the slot state before we call getTouches and update it. This way, we can find
-    // the slots that have been removed due to the incoming event.
-    SlotState oldSlotState = mSlotState;
-    mSlotState.update(args);
-
-    std::vector<::ui::InProgressTouchEvdev> touches =
-            getTouches(args, mDeviceInfo, oldSlotState, mSlotState);
+    // the slots that have been removed due to the incoming event. MOVE events never change the
+    // slots, so the current state can be used as the old one without copying it.
+    const bool changesSlots =
+            MotionEvent::getActionMasked(args.action) != AMOTION_EVENT_ACTION_MOVE;
+    if (changesSlots) {
+        mOldSlotState = mSlotState;
+        mSlotState.update(args);
+    }
+    const SlotState& oldSlotState = changesSlots ? mOldSlotState : mSlotState;
+
+    getTouches(args, mDeviceInfo, oldSlotState, mSlotState, mTouches);
+    const std::vector<::ui::InProgressTouchEvdev>& touches = mTouches;
     ::base::TimeTicks chromeTimestamp = toChromeTimestamp(args.eventTime);
 
     if (DEBUG_MODEL) {
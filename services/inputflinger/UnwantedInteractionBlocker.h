@@ -160,6 +160,13 @@ std::vector<::ui::InProgressTouchEvdev> getTouches(const NotifyMotionArgs& args,
                                                    const SlotState& oldSlotState,
                                                    const SlotState& newSlotState);
 
+/**
+ * Same as above, but writes the touches into the provided vector, reusing its storage.
+ */
+void getTouches(const NotifyMotionArgs& args, const AndroidPalmFilterDeviceInfo& deviceInfo,
+                const SlotState& oldSlotState, const SlotState& newSlotState,
+                std::vector<::ui::InProgressTouchEvdev>& outTouches);
+
 class PalmRejector {
 public:
     explicit PalmRejector(const AndroidPalmFilterDeviceInfo& info,
@@ -189,6 +196,12 @@ private:
 
     // Used to help convert an Android touch stream to Linux input stream.
     SlotState mSlotState;
+    // The slot state from before the last event that changed the slots. Kept as a member so that
+    // its storage is reused from one event to the next.
+    SlotState mOldSlotState;
+    // The converted touches of the event being processed. Reused across events to avoid
+    // allocating a new vector for every touch event.
+    std::vector<::ui::InProgressTouchEvdev> mTouches;
 };
 
 } // namespace android
@@ -16,6 +16,10 @@
 
 #include <benchmark/benchmark.h>
 
+#include <algorithm>
+#include <thread>
+#include <vector>
+
 #include <android/os/IInputConstants.h>
 #include <binder/Binder.h>
 #include "../dispatcher/InputDispatcher.h"
@@ -41,6 +45,11 @@ constexpr ui::LogicalDisplayId DISPLAY_ID = ui::LogicalDisplayId::DEFAULT;
 
 static constexpr std::chrono::duration INJECT_EVENT_TIMEOUT = 5s;
 
+static constexpr std::chrono::milliseconds CONSUME_TIMEOUT = 100ms;
+
+// An arbitrary pid for the monitors.
+static constexpr gui::Pid MONITOR_PID{2001};
+
 static nsecs_t now() {
     return systemTime(SYSTEM_TIME_MONOTONIC);
 }
@@ -195,11 +204,83 @@ static void benchmarkOnWindowInfosChanged(benchmark::State& state) {
     dispatcher->stop();
 }
 
+// Sends a gesture whose moves arrive at 1 kHz, like a touchscreen sampling at a high rate, to a
+// window under a spy window while state.range(0) gesture monitors are registered. Reports the
+// median and 99th percentile of the time from notifyMotion until the window receives the event.
+static void benchmarkNotifyMotionStream(benchmark::State& state) {
+    constexpr size_t kMovesPerGesture = 100;
+    constexpr std::chrono::microseconds kMoveInterval = 1ms;
+
+    FakeInputDispatcherPolicy fakePolicy;
+    auto dispatcher = std::make_unique<InputDispatcher>(fakePolicy);
+    dispatcher->setInputDispatchMode(/*enabled*/ true, /*frozen*/ false);
+    dispatcher->start();
+
+    std::shared_ptr<FakeApplicationHandle> application = std::make_shared<FakeApplicationHandle>();
+    sp<FakeWindowHandle> spy =
+            sp<FakeWindowHandle>::make(application, dispatcher, "Fake Spy", DISPLAY_ID);
+    spy->setSpy(true);
+    spy->setTrustedOverlay(true);
+    sp<FakeWindowHandle> window =
+            sp<FakeWindowHandle>::make(application, dispatcher, "Fake Window", DISPLAY_ID);
+
+    dispatcher->onWindowInfosChanged({{*spy->getInfo(), *window->getInfo()}, {}, 0, 0});
+
+    std::vector<std::unique_ptr<FakeInputReceiver>> monitors;
+    for (int64_t i = 0; i < state.range(0); i++) {
+        const std::string name = "Fake Monitor " + std::to_string(i);
+        monitors.push_back(std::make_unique<FakeInputReceiver>(
+                *dispatcher->createInputMonitor(DISPLAY_ID, name, MONITOR_PID), name));
+    }
+
+    std::vector<nsecs_t> latencies;
+    NotifyMotionArgs motionArgs = generateMotionArgs();
+
+    const auto sendAndConsume = [&](int32_t action) {
+        motionArgs.action = action;
+        motionArgs.eventTime = now();
+        dispatcher->notifyMotion(motionArgs);
+
+        window->consumeMotionEvent();
+        latencies.push_back(now() - motionArgs.eventTime);
+
+        spy->consumeMotionEvent();
+        for (const auto& monitor : monitors) {
+            monitor->consume(CONSUME_TIMEOUT);
+        }
+    };
+
+    for (auto _ : state) {
+        motionArgs.downTime = now();
+        sendAndConsume(AMOTION_EVENT_ACTION_DOWN);
+
+        auto nextMove = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < kMovesPerGesture; i++) {
+            nextMove += kMoveInterval;
+            std::this_thread::sleep_until(nextMove);
+            sendAndConsume(AMOTION_EVENT_ACTION_MOVE);
+        }
+
+        sendAndConsume(AMOTION_EVENT_ACTION_UP);
+    }
+
+    dispatcher->stop();
+
+    std::sort(latencies.begin(), latencies.end());
+    const auto percentile = [&](size_t percent) {
+        return ns2us(latencies[(latencies.size() - 1) * percent / 100]);
+    };
+    state.counters["p50_us"] = percentile(50);
+    state.counters["p99_us"] = percentile(99);
+    state.SetItemsProcessed(static_cast<int64_t>(latencies.size()));
+}
+
 } // namespace
 
 BENCHMARK(benchmarkNotifyMotion);
 BENCHMARK(benchmarkInjectMotion);
 BENCHMARK(benchmarkOnWindowInfosChanged);
+BENCHMARK(benchmarkNotifyMotionStream)->Arg(0)->Arg(2)->Arg(4)->Unit(benchmark::kMillisecond);
 
 } // namespace android::inputdispatcher
 
@@ -0,0 +1,130 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+#include "../UnwantedInteractionBlocker.h"
+#include "ui/events/ozone/evdev/touch_filter/neural_stylus_palm_detection_filter.h"
+
+namespace android {
+
+namespace {
+
+constexpr int32_t DEVICE_ID = 3;
+
+const nsecs_t RESAMPLE_PERIOD = ::ui::kResamplePeriod.InNanoseconds();
+
+NotifyMotionArgs generateMotionArgs(nsecs_t downTime, nsecs_t eventTime, int32_t action,
+                                    size_t pointerCount, float offset) {
+    std::vector<PointerProperties> pointerProperties(pointerCount);
+    std::vector<PointerCoords> pointerCoords(pointerCount);
+    for (size_t i = 0; i < pointerCount; i++) {
+        pointerProperties[i].clear();
+        pointerProperties[i].id = i;
+        pointerProperties[i].toolType = ToolType::FINGER;
+
+        pointerCoords[i].clear();
+        pointerCoords[i].setAxisValue(AMOTION_EVENT_AXIS_X, 100 + 200 * i + offset);
+        pointerCoords[i].setAxisValue(AMOTION_EVENT_AXIS_Y, 200 + offset);
+        pointerCoords[i].setAxisValue(AMOTION_EVENT_AXIS_TOUCH_MAJOR, 10);
+    }
+
+    return NotifyMotionArgs(/*id=*/0, eventTime, /*readTime=*/0, DEVICE_ID,
+                            AINPUT_SOURCE_TOUCHSCREEN, ui::LogicalDisplayId::DEFAULT,
+                            POLICY_FLAG_PASS_TO_USER, action, /*actionButton=*/0, /*flags=*/0,
+                            AMETA_NONE, /*buttonState=*/0, MotionClassification::NONE,
+                            AMOTION_EVENT_EDGE_FLAG_NONE, pointerCount, pointerProperties.data(),
+                            pointerCoords.data(), /*xPrecision=*/0, /*yPrecision=*/0,
+                            AMOTION_EVENT_INVALID_CURSOR_POSITION,
+                            AMOTION_EVENT_INVALID_CURSOR_POSITION, downTime, /*videoFrames=*/{});
+}
+
+AndroidPalmFilterDeviceInfo generatePalmFilterDeviceInfo() {
+    InputDeviceInfo info;
+    info.initialize(DEVICE_ID, /*generation=*/1, /*controllerNumber=*/1, InputDeviceIdentifier{},
+                    "alias", /*isExternal=*/false, /*hasMic=*/false,
+                    ui::LogicalDisplayId::INVALID);
+    info.addSource(AINPUT_SOURCE_TOUCHSCREEN);
+    info.addMotionRange(AMOTION_EVENT_AXIS_X, AINPUT_SOURCE_TOUCHSCREEN, 0, 1599, /*flat=*/0,
+                        /*fuzz=*/0, /*resolution=*/11);
+    info.addMotionRange(AMOTION_EVENT_AXIS_Y, AINPUT_SOURCE_TOUCHSCREEN, 0, 2559, /*flat=*/0,
+                        /*fuzz=*/0, /*resolution=*/11);
+    info.addMotionRange(AMOTION_EVENT_AXIS_TOUCH_MAJOR, AINPUT_SOURCE_TOUCHSCREEN, 0, 255,
+                        /*flat=*/0, /*fuzz=*/0, /*resolution=*/1);
+    return *createPalmFilterDeviceInfo(info);
+}
+
+} // namespace
+
+/**
+ * Measure the latency that palm rejection adds to every touch MOVE while the given number of
+ * fingers is on the screen. The gesture is restarted periodically so that the model keeps
+ * seeing a realistic stream rather than a single touch that lasts for the whole run.
+ */
+static void benchmarkPalmRejectorMove(benchmark::State& state) {
+    const size_t pointerCount = state.range(0);
+    PalmRejector rejector(generatePalmFilterDeviceInfo());
+
+    constexpr size_t MOVES_PER_GESTURE = 100;
+    nsecs_t downTime = 0;
+    nsecs_t eventTime = 0;
+    size_t moveCount = 0;
+
+    auto startGesture = [&]() {
+        downTime = eventTime;
+        rejector.processMotion(
+                generateMotionArgs(downTime, eventTime, AMOTION_EVENT_ACTION_DOWN, 1, 0));
+        for (size_t i = 1; i < pointerCount; i++) {
+            const int32_t action = AMOTION_EVENT_ACTION_POINTER_DOWN |
+                    (static_cast<int32_t>(i) << AMOTION_EVENT_ACTION_POINTER_INDEX_SHIFT);
+            rejector.processMotion(generateMotionArgs(downTime, eventTime, action, i + 1, 0));
+        }
+    };
+    auto endGesture = [&]() {
+        NotifyMotionArgs cancel = generateMotionArgs(downTime, eventTime,
+                                                     AMOTION_EVENT_ACTION_CANCEL, pointerCount, 0);
+        cancel.flags |= AMOTION_EVENT_FLAG_CANCELED;
+        rejector.processMotion(cancel);
+    };
+
+    startGesture();
+    for (auto _ : state) {
+        state.PauseTiming();
+        eventTime += RESAMPLE_PERIOD;
+        moveCount++;
+        const NotifyMotionArgs move = generateMotionArgs(downTime, eventTime,
+                                                         AMOTION_EVENT_ACTION_MOVE, pointerCount,
+                                                         /*offset=*/moveCount % MOVES_PER_GESTURE);
+        state.ResumeTiming();
+
+        benchmark::DoNotOptimize(rejector.processMotion(move));
+
+        if (moveCount % MOVES_PER_GESTURE == 0) {
+            state.PauseTiming();
+            endGesture();
+            eventTime += RESAMPLE_PERIOD;
+            startGesture();
+            state.ResumeTiming();
+        }
+    }
+}
+BENCHMARK(benchmarkPalmRejectorMove)->Arg(1)->Arg(2)->Arg(5);
+
+} // namespace android
+
+BENCHMARK_MAIN();
@@ -183,8 +183,8 @@ MotionEntry::MotionEntry(int32_t id, std::shared_ptr<InjectionState> injectionSt
                          int32_t buttonState, MotionClassification classification,
                          int32_t edgeFlags, float xPrecision, float yPrecision,
                          float xCursorPosition, float yCursorPosition, nsecs_t downTime,
-                         const std::vector<PointerProperties>& pointerProperties,
-                         const std::vector<PointerCoords>& pointerCoords)
+                         std::vector<PointerProperties> pointerProperties,
+                         std::vector<PointerCoords> pointerCoords)
       : EventEntry(id, Type::MOTION, eventTime, policyFlags),
         deviceId(deviceId),
         source(source),
@@ -201,8 +201,8 @@ MotionEntry::MotionEntry(int32_t id, std::shared_ptr<InjectionState> injectionSt
         xCursorPosition(xCursorPosition),
         yCursorPosition(yCursorPosition),
         downTime(downTime),
-        pointerProperties(pointerProperties),
-        pointerCoords(pointerCoords) {
+        pointerProperties(std::move(pointerProperties)),
+        pointerCoords(std::move(pointerCoords)) {
     EventEntry::injectionState = std::move(injectionState);
 }
 
@@ -88,6 +88,12 @@ bool isInputTracingEnabled() {
     return input_flags::enable_input_event_tracing() && isUserdebugOrEng;
 }
 
+// Only every Nth inbound move event is traced when this is set to N, to reduce the cost of
+// tracing. Like the tracing flag, changes are only applied after reboot.
+uint32_t getInputTracingMoveSamplingInterval() {
+    return base::GetUintProperty<uint32_t>("debug.input.tracing.move_sampling_interval", 1);
+}
+
 // Create the input tracing backend that writes to perfetto from a single thread.
 std::unique_ptr<trace::InputTracingBackendInterface> createInputTracingBackendIfEnabled() {
     if (!isInputTracingEnabled()) {
@@ -846,6 +852,33 @@ Result<void> validateWindowInfosUpdate(const gui::WindowInfosUpdate& update) {
     return {};
 }
 
+bool isSameDisplayInfos(const std::vector<gui::DisplayInfo>& a,
+                        const std::vector<gui::DisplayInfo>& b) {
+    return std::equal(a.begin(), a.end(), b.begin(), b.end(),
+                      [](const gui::DisplayInfo& x, const gui::DisplayInfo& y) {
+                          return x.displayId == y.displayId && x.logicalWidth == y.logicalWidth &&
+                                  x.logicalHeight == y.logicalHeight && x.transform == y.transform;
+                      });
+}
+
+std::unordered_map<ui::LogicalDisplayId, std::vector<int32_t>> getWindowIdsByDisplay(
+        const std::vector<WindowInfo>& windowInfos) {
+    std::unordered_map<ui::LogicalDisplayId, std::vector<int32_t>> idsByDisplay;
+    for (const WindowInfo& info : windowInfos) {
+        idsByDisplay[info.displayId].push_back(info.id);
+    }
+    return idsByDisplay;
+}
+
+sp<WindowInfoHandle> createWindowHandle(const WindowInfo& info) {
+    auto handle = sp<WindowInfoHandle>::make(info);
+    if (input_flags::split_all_touches()) {
+        handle->editInfo()->setInputConfig(android::gui::WindowInfo::InputConfig::PREVENT_SPLITTING,
+                                           false);
+    }
+    return handle;
+}
+
 int32_t getUserActivityEventType(const EventEntry& eventEntry) {
     switch (eventEntry.type) {
         case EventEntry::Type::KEY: {
@@ -959,7 +992,8 @@ InputDispatcher::InputDispatcher(InputDispatcherPolicyInterface& policy,
     mKeyRepeatState.lastKeyEntry = nullptr;
 
     if (traceBackend) {
-        mTracer = std::make_unique<trace::impl::InputTracer>(std::move(traceBackend));
+        mTracer = std::make_unique<trace::impl::InputTracer>(std::move(traceBackend),
+                                                             getInputTracingMoveSamplingInterval());
     }
 
     mLastUserActivityTimes.fill(0);
@@ -1341,7 +1375,7 @@ bool InputDispatcher::shouldPruneInboundQueueLocked(const MotionEntry& motionEnt
     return false;
 }
 
-bool InputDispatcher::enqueueInboundEventLocked(std::unique_ptr<EventEntry> newEntry) {
+bool InputDispatcher::enqueueInboundEventLocked(std::shared_ptr<EventEntry> newEntry) {
     bool needWake = mInboundQueue.empty();
     mInboundQueue.push_back(std::move(newEntry));
     const EventEntry& entry = *(mInboundQueue.back());
@@ -1432,16 +1466,28 @@ void InputDispatcher::addRecentEventLocked(std::shared_ptr<const EventEntry> ent
 sp<WindowInfoHandle> InputDispatcher::findTouchedWindowAtLocked(ui::LogicalDisplayId displayId,
                                                                 float x, float y, bool isStylus,
                                                                 bool ignoreDragWindow) const {
-    // Traverse windows from front to back to find touched window.
-    const auto& windowHandles = getWindowHandlesLocked(displayId);
-    for (const sp<WindowInfoHandle>& windowHandle : windowHandles) {
+    const ui::Transform displayTransform = getTransformLocked(displayId);
+    const auto isTouchedWindow = [&](const sp<WindowInfoHandle>& windowHandle) REQUIRES(mLock) {
         if (ignoreDragWindow && haveSameToken(windowHandle, mDragState->dragWindow)) {
-            continue;
+            return false;
         }
-
         const WindowInfo& info = *windowHandle->getInfo();
-        if (!info.isSpy() &&
-            windowAcceptsTouchAt(info, displayId, x, y, isStylus, getTransformLocked(displayId))) {
+        return !info.isSpy() &&
+                windowAcceptsTouchAt(info, displayId, x, y, isStylus, displayTransform);
+    };
+
+    // Traverse windows from front to back to find touched window.
+    const auto& windowHandles = getWindowHandlesLocked(displayId);
+    if (const auto* index = getWindowSpatialIndexLocked(displayId, displayTransform)) {
+        for (uint32_t i : index->getTouchableCandidates(x, y)) {
+            if (isTouchedWindow(windowHandles[i])) {
+                return windowHandles[i];
+            }
+        }
+        return nullptr;
+    }
+    for (const sp<WindowInfoHandle>& windowHandle : windowHandles) {
+        if (isTouchedWindow(windowHandle)) {
             return windowHandle;
         }
     }
@@ -3146,13 +3192,25 @@ InputDispatcher::TouchOcclusionInfo InputDispatcher::computeTouchOcclusionInfoLo
     info.obscuringOpacity = 0;
     info.obscuringUid = gui::Uid::INVALID;
     std::map<gui::Uid, float> opacityByUid;
-    for (const sp<WindowInfoHandle>& otherHandle : windowHandles) {
-        if (windowHandle == otherHandle) {
+    const ui::Transform displayTransform = getTransformLocked(displayId);
+    // Windows below the touched window can't obscure it.
+    const size_t touchedPosition =
+            std::find(windowHandles.begin(), windowHandles.end(), windowHandle) -
+            windowHandles.begin();
+    // With an index, only the windows whose frame may contain the location are checked.
+    const auto* index = getWindowSpatialIndexLocked(displayId, displayTransform);
+    const std::vector<uint32_t>* candidates =
+            index != nullptr ? &index->getFrameCandidates(x, y) : nullptr;
+    const size_t count = candidates != nullptr ? candidates->size() : touchedPosition;
+    for (size_t i = 0; i < count; i++) {
+        const size_t position = candidates != nullptr ? (*candidates)[i] : i;
+        if (position >= touchedPosition) {
             break; // All future windows are below us. Exit early.
         }
+        const sp<WindowInfoHandle>& otherHandle = windowHandles[position];
         const WindowInfo* otherInfo = otherHandle->getInfo();
         if (canBeObscuredBy(windowHandle, otherHandle) &&
-            windowOccludesTouchAt(*otherInfo, displayId, x, y, getTransformLocked(displayId)) &&
+            windowOccludesTouchAt(*otherInfo, displayId, x, y, displayTransform) &&
             !haveSameApplicationToken(windowInfo, otherInfo)) {
             if (DEBUG_TOUCH_OCCLUSION) {
                 info.debugInfo.push_back(
@@ -3742,8 +3800,9 @@ void InputDispatcher::dispatchPointerDownOutsideFocus(uint32_t source, int32_t a
     postCommandLocked(std::move(command));
 }
 
-status_t InputDispatcher::publishMotionEvent(Connection& connection,
-                                             DispatchEntry& dispatchEntry) const {
+status_t InputDispatcher::prepareMotionEvent(Connection& connection,
+                                             const DispatchEntry& dispatchEntry,
+                                             InputMessage& msg) const {
     const EventEntry& eventEntry = *(dispatchEntry.eventEntry);
     const MotionEntry& motionEntry = static_cast<const MotionEntry&>(eventEntry);
 
@@ -3769,9 +3828,8 @@ status_t InputDispatcher::publishMotionEvent(Connection& connection,
 
     std::array<uint8_t, 32> hmac = getSignature(motionEntry, dispatchEntry);
 
-    // Publish the motion event.
     return connection.inputPublisher
-            .publishMotionEvent(dispatchEntry.seq, motionEntry.id, motionEntry.deviceId,
+            .prepareMotionEvent(msg, dispatchEntry.seq, motionEntry.id, motionEntry.deviceId,
                                 motionEntry.source, motionEntry.displayId, std::move(hmac),
                                 motionEntry.action, motionEntry.actionButton,
                                 dispatchEntry.resolvedFlags, motionEntry.edgeFlags,
@@ -3784,6 +3842,17 @@ status_t InputDispatcher::publishMotionEvent(Connection& connection,
                                 motionEntry.pointerProperties.data(), usingCoords);
 }
 
+status_t InputDispatcher::publishMotionEvent(Connection& connection,
+                                             DispatchEntry& dispatchEntry) const {
+    InputMessage msg;
+    status_t status = prepareMotionEvent(connection, dispatchEntry, msg);
+    if (status != OK) {
+        return status;
+    }
+    size_t publishedCount;
+    return connection.inputPublisher.publishPreparedEvents(&msg, 1, &publishedCount);
+}
+
 void InputDispatcher::startDispatchCycleLocked(nsecs_t currentTime,
                                                const std::shared_ptr<Connection>& connection) {
     ATRACE_NAME_IF(ATRACE_ENABLED(),
@@ -3794,6 +3863,32 @@ void InputDispatcher::startDispatchCycleLocked(nsecs_t currentTime,
     }
 
     while (connection->status == Connection::Status::NORMAL && !connection->outboundQueue.empty()) {
+        if (input_flags::batch_motion_event_publishing()) {
+            // A burst of moves is written to the channel together, rather than one at a time.
+            // The batch is a single write, and stops before a down or up, which are signed, so
+            // that only events which are actually sent get signed.
+            size_t batchSize = 0;
+            for (const std::unique_ptr<DispatchEntry>& entry : connection->outboundQueue) {
+                if (batchSize == InputChannel::MAX_MESSAGES_PER_WRITE ||
+                    entry->eventEntry->type != EventEntry::Type::MOTION) {
+                    break;
+                }
+                const int32_t actionMasked = MotionEvent::getActionMasked(
+                        static_cast<const MotionEntry&>(*entry->eventEntry).action);
+                if (actionMasked == AMOTION_EVENT_ACTION_DOWN ||
+                    actionMasked == AMOTION_EVENT_ACTION_UP) {
+                    break;
+                }
+                batchSize++;
+            }
+            if (batchSize > 1) {
+                if (!publishMotionEventBatchLocked(currentTime, connection, batchSize)) {
+                    return;
+                }
+                continue;
+            }
+        }
+
         std::unique_ptr<DispatchEntry>& dispatchEntry = connection->outboundQueue.front();
         dispatchEntry->deliveryTime = currentTime;
         const std::chrono::nanoseconds timeout = getDispatchingTimeoutLocked(connection);
@@ -3892,43 +3987,93 @@ void InputDispatcher::startDispatchCycleLocked(nsecs_t currentTime,
 
         // Check the result.
         if (status) {
-            if (status == WOULD_BLOCK) {
-                if (connection->waitQueue.empty()) {
-                    ALOGE("channel '%s' ~ Could not publish event because the pipe is full. "
-                          "This is unexpected because the wait queue is empty, so the pipe "
-                          "should be empty and we shouldn't have any problems writing an "
-                          "event to it, status=%s(%d)",
-                          connection->getInputChannelName().c_str(), statusToString(status).c_str(),
-                          status);
-                    abortBrokenDispatchCycleLocked(currentTime, connection, /*notify=*/true);
-                } else {
-                    // Pipe is full and we are waiting for the app to finish process some events
-                    // before sending more events to it.
-                    if (DEBUG_DISPATCH_CYCLE) {
-                        ALOGD("channel '%s' ~ Could not publish event because the pipe is full, "
-                              "waiting for the application to catch up",
-                              connection->getInputChannelName().c_str());
-                    }
-                }
-            } else {
-                ALOGE("channel '%s' ~ Could not publish event due to an unexpected error, "
-                      "status=%s(%d)",
-                      connection->getInputChannelName().c_str(), statusToString(status).c_str(),
-                      status);
-                abortBrokenDispatchCycleLocked(currentTime, connection, /*notify=*/true);
-            }
+            handlePublishErrorLocked(currentTime, connection, status);
             return;
         }
 
         // Re-enqueue the event on the wait queue.
-        const nsecs_t timeoutTime = dispatchEntry->timeoutTime;
-        connection->waitQueue.emplace_back(std::move(dispatchEntry));
-        connection->outboundQueue.erase(connection->outboundQueue.begin());
-        traceOutboundQueueLength(*connection);
-        if (connection->responsive) {
-            mAnrTracker.insert(timeoutTime, connection->getToken());
+        onDispatchEntryPublishedLocked(*connection);
+    }
+}
+
+bool InputDispatcher::publishMotionEventBatchLocked(nsecs_t currentTime,
+                                                    const std::shared_ptr<Connection>& connection,
+                                                    size_t batchSize) {
+    const std::chrono::nanoseconds timeout = getDispatchingTimeoutLocked(connection);
+    mMotionEventBatch.resize(std::max(mMotionEventBatch.size(), batchSize));
+    for (size_t i = 0; i < batchSize; i++) {
+        DispatchEntry& dispatchEntry = *connection->outboundQueue[i];
+        dispatchEntry.deliveryTime = currentTime;
+        dispatchEntry.timeoutTime = currentTime + timeout.count();
+        if (DEBUG_OUTBOUND_EVENT_DETAILS) {
+            LOG(INFO) << "Publishing " << dispatchEntry << " to "
+                      << connection->getInputChannelName();
         }
-        traceWaitQueueLength(*connection);
+        if (prepareMotionEvent(*connection, dispatchEntry, mMotionEventBatch[i]) == BAD_VALUE) {
+            logDispatchStateLocked();
+            LOG(FATAL) << "Publisher failed for "
+                       << static_cast<const MotionEntry&>(*dispatchEntry.eventEntry);
+        }
+    }
+
+    size_t publishedCount = 0;
+    const status_t status =
+            connection->inputPublisher.publishPreparedEvents(mMotionEventBatch.data(), batchSize,
+                                                             &publishedCount);
+    for (size_t i = 0; i < publishedCount; i++) {
+        if (mTracer) {
+            const DispatchEntry& dispatchEntry = *connection->outboundQueue.front();
+            const auto& motionEntry = static_cast<const MotionEntry&>(*dispatchEntry.eventEntry);
+            ensureEventTraced(motionEntry);
+            mTracer->traceEventDispatch(dispatchEntry, *motionEntry.traceTracker);
+        }
+        onDispatchEntryPublishedLocked(*connection);
+    }
+    if (status) {
+        handlePublishErrorLocked(currentTime, connection, status);
+        return false;
+    }
+    return true;
+}
+
+void InputDispatcher::onDispatchEntryPublishedLocked(Connection& connection) {
+    std::unique_ptr<DispatchEntry>& dispatchEntry = connection.outboundQueue.front();
+    const nsecs_t timeoutTime = dispatchEntry->timeoutTime;
+    connection.waitQueue.emplace_back(std::move(dispatchEntry));
+    connection.outboundQueue.erase(connection.outboundQueue.begin());
+    traceOutboundQueueLength(connection);
+    if (connection.responsive) {
+        mAnrTracker.insert(timeoutTime, connection.getToken());
+    }
+    traceWaitQueueLength(connection);
+}
+
+void InputDispatcher::handlePublishErrorLocked(nsecs_t currentTime,
+                                               const std::shared_ptr<Connection>& connection,
+                                               status_t status) {
+    if (status == WOULD_BLOCK) {
+        if (connection->waitQueue.empty()) {
+            ALOGE("channel '%s' ~ Could not publish event because the pipe is full. "
+                  "This is unexpected because the wait queue is empty, so the pipe "
+                  "should be empty and we shouldn't have any problems writing an "
+                  "event to it, status=%s(%d)",
+                  connection->getInputChannelName().c_str(), statusToString(status).c_str(),
+                  status);
+            abortBrokenDispatchCycleLocked(currentTime, connection, /*notify=*/true);
+        } else {
+            // Pipe is full and we are waiting for the app to finish process some events
+            // before sending more events to it.
+            if (DEBUG_DISPATCH_CYCLE) {
+                ALOGD("channel '%s' ~ Could not publish event because the pipe is full, "
+                      "waiting for the application to catch up",
+                      connection->getInputChannelName().c_str());
+            }
+        }
+    } else {
+        ALOGE("channel '%s' ~ Could not publish event due to an unexpected error, "
+              "status=%s(%d)",
+              connection->getInputChannelName().c_str(), statusToString(status).c_str(), status);
+        abortBrokenDispatchCycleLocked(currentTime, connection, /*notify=*/true);
     }
 }
 
@@ -4513,8 +4658,8 @@ void InputDispatcher::notifyKey(const NotifyKeyArgs& args) {
             mLock.lock();
         }
 
-        std::unique_ptr<KeyEntry> newEntry =
-                std::make_unique<KeyEntry>(args.id, /*injectionState=*/nullptr, args.eventTime,
+        std::shared_ptr<KeyEntry> newEntry =
+                std::make_shared<KeyEntry>(args.id, /*injectionState=*/nullptr, args.eventTime,
                                            args.deviceId, args.source, args.displayId, policyFlags,
                                            args.action, flags, keyCode, args.scanCode, metaState,
                                            repeatCount, args.downTime);
@@ -4565,7 +4710,7 @@ void InputDispatcher::notifyMotion(const NotifyMotionArgs& args) {
 
     Result<void> motionCheck =
             validateMotionEvent(args.action, args.actionButton, args.getPointerCount(),
-                                args.pointerProperties.data());
+                                args.pointerProperties.begin());
     if (!motionCheck.ok()) {
         LOG(FATAL) << "Invalid event: " << args.dump() << "; reason: " << motionCheck.error();
         return;
@@ -4578,8 +4723,8 @@ void InputDispatcher::notifyMotion(const NotifyMotionArgs& args) {
                                                              args.displayId.toString().c_str()));
         Result<void> result =
                 it->second.processMovement(args.deviceId, args.source, args.action,
-                                           args.getPointerCount(), args.pointerProperties.data(),
-                                           args.pointerCoords.data(), args.flags);
+                                           args.getPointerCount(), args.pointerProperties.begin(),
+                                           args.pointerCoords.begin(), args.flags);
         if (!result.ok()) {
             LOG(FATAL) << "Bad stream: " << result.error() << " caused by " << args.dump();
         }
@@ -4627,7 +4772,7 @@ void InputDispatcher::notifyMotion(const NotifyMotionArgs& args) {
                              displayTransform, args.xPrecision, args.yPrecision,
                              args.xCursorPosition, args.yCursorPosition, displayTransform,
                              args.downTime, args.eventTime, args.getPointerCount(),
-                             args.pointerProperties.data(), args.pointerCoords.data());
+                             args.pointerProperties.begin(), args.pointerCoords.begin());
 
             policyFlags |= POLICY_FLAG_FILTERED;
             if (!mPolicy.filterInputEvent(event, policyFlags)) {
@@ -4638,15 +4783,19 @@ void InputDispatcher::notifyMotion(const NotifyMotionArgs& args) {
         }
 
         // Just enqueue a new motion event.
-        std::unique_ptr<MotionEntry> newEntry =
-                std::make_unique<MotionEntry>(args.id, /*injectionState=*/nullptr, args.eventTime,
+        std::shared_ptr<MotionEntry> newEntry =
+                std::make_shared<MotionEntry>(args.id, /*injectionState=*/nullptr, args.eventTime,
                                               args.deviceId, args.source, args.displayId,
                                               policyFlags, args.action, args.actionButton,
                                               args.flags, args.metaState, args.buttonState,
                                               args.classification, args.edgeFlags, args.xPrecision,
                                               args.yPrecision, args.xCursorPosition,
                                               args.yCursorPosition, args.downTime,
-                                              args.pointerProperties, args.pointerCoords);
+                                              std::vector<PointerProperties>(
+                                                      args.pointerProperties.begin(),
+                                                      args.pointerProperties.end()),
+                                              std::vector<PointerCoords>(args.pointerCoords.begin(),
+                                                                         args.pointerCoords.end()));
         if (mTracer) {
             newEntry->traceTracker = mTracer->traceInboundEvent(*newEntry);
         }
@@ -5279,6 +5428,7 @@ void InputDispatcher::updateWindowHandlesForDisplayLocked(
     if (windowInfoHandles.empty()) {
         // Remove all handles on a display if there are no windows left.
         mWindowHandlesByDisplay.erase(displayId);
+        mWindowSpatialIndexByDisplay.erase(displayId);
         return;
     }
 
@@ -5325,6 +5475,26 @@ void InputDispatcher::updateWindowHandlesForDisplayLocked(
 
     // Insert or replace
     mWindowHandlesByDisplay[displayId] = newHandles;
+
+    mWindowSpatialIndexByDisplay.erase(displayId);
+    if (input_flags::spatial_window_index()) {
+        mWindowSpatialIndexByDisplay.try_emplace(displayId, mWindowHandlesByDisplay[displayId],
+                                                 getTransformLocked(displayId));
+    }
+}
+
+const WindowSpatialIndex* InputDispatcher::getWindowSpatialIndexLocked(
+        ui::LogicalDisplayId displayId, const ui::Transform& displayTransform) const {
+    if (!input_flags::spatial_window_index()) {
+        return nullptr;
+    }
+    const auto it = mWindowSpatialIndexByDisplay.find(displayId);
+    // The index is in logical display space, so it can't be used once the display has moved.
+    if (it == mWindowSpatialIndexByDisplay.end() ||
+        it->second.getDisplayTransform() != displayTransform) {
+        return nullptr;
+    }
+    return &it->second;
 }
 
 /**
@@ -5456,8 +5626,13 @@ void InputDispatcher::setInputWindowsLocked(
     // This ensures that unused input channels are released promptly.
     // Otherwise, they might stick around until the window handle is destroyed
     // which might not happen until the next GC.
+    // Windows that are still on this display keep their handle, so only the others need to be
+    // looked up on every display.
+    const std::unordered_set<sp<WindowInfoHandle>, StrongPointerHash<WindowInfoHandle>>
+            currentHandles(windowHandles.begin(), windowHandles.end());
     for (const sp<WindowInfoHandle>& oldWindowHandle : oldWindowHandles) {
-        if (getWindowHandleLocked(oldWindowHandle) == nullptr) {
+        if (!currentHandles.contains(oldWindowHandle) &&
+            getWindowHandleLocked(oldWindowHandle) == nullptr) {
             if (DEBUG_FOCUS) {
                 ALOGD("Window went away: %s", oldWindowHandle->getName().c_str());
             }
@@ -7053,18 +7228,28 @@ void InputDispatcher::onWindowInfosChanged(const gui::WindowInfosUpdate& update)
         LOG_ALWAYS_FATAL("Incorrect WindowInfosUpdate provided: %s",
                          result.error().message().c_str());
     };
+    std::scoped_lock _wl(mWindowInfosUpdateLock);
+    // Displays whose windows are the same as in the last update are left as they are.
+    std::optional<std::unordered_set<ui::LogicalDisplayId>> changedDisplays;
+    if (input_flags::incremental_window_infos_update()) {
+        changedDisplays = getDisplaysWithChangedWindows(update);
+        mLastWindowInfosUpdate = update;
+    }
+    const auto needsUpdate = [&changedDisplays](ui::LogicalDisplayId displayId) {
+        return !changedDisplays || changedDisplays->contains(displayId);
+    };
+
     // The listener sends the windows as a flattened array. Separate the windows by display for
     // more convenient parsing.
     std::unordered_map<ui::LogicalDisplayId, std::vector<sp<WindowInfoHandle>>> handlesPerDisplay;
+    std::unordered_map<ui::LogicalDisplayId, size_t> windowCountPerDisplay;
+    // The handles that are replaced by this update, kept so that they are destroyed once mLock is
+    // released rather than while the reader thread may be waiting for it.
+    std::vector<sp<WindowInfoHandle>> replacedHandles;
     for (const auto& info : update.windowInfos) {
-        handlesPerDisplay.emplace(info.displayId, std::vector<sp<WindowInfoHandle>>());
-        handlesPerDisplay[info.displayId].push_back(sp<WindowInfoHandle>::make(info));
-        if (input_flags::split_all_touches()) {
-            handlesPerDisplay[info.displayId]
-                    .back()
-                    ->editInfo()
-                    ->setInputConfig(android::gui::WindowInfo::InputConfig::PREVENT_SPLITTING,
-                                     false);
+        windowCountPerDisplay[info.displayId]++;
+        if (needsUpdate(info.displayId)) {
+            handlesPerDisplay[info.displayId].push_back(createWindowHandle(info));
         }
     }
 
@@ -7074,7 +7259,27 @@ void InputDispatcher::onWindowInfosChanged(const gui::WindowInfosUpdate& update)
         // Ensure that we have an entry created for all existing displays so that if a displayId has
         // no windows, we can tell that the windows were removed from the display.
         for (const auto& [displayId, _] : mWindowHandlesByDisplay) {
-            handlesPerDisplay[displayId];
+            if (needsUpdate(displayId) || !windowCountPerDisplay.contains(displayId)) {
+                handlesPerDisplay[displayId];
+            }
+        }
+
+        if (changedDisplays) {
+            // Windows without a registered input channel are left out of their display, and a
+            // removed display drops its windows, so a display which doesn't hold every window of
+            // the update is updated again.
+            for (const auto& [displayId, count] : windowCountPerDisplay) {
+                if (needsUpdate(displayId) ||
+                    getWindowHandlesLocked(displayId).size() == count) {
+                    continue;
+                }
+                auto& handles = handlesPerDisplay[displayId];
+                for (const auto& info : update.windowInfos) {
+                    if (info.displayId == displayId) {
+                        handles.push_back(createWindowHandle(info));
+                    }
+                }
+            }
         }
 
         mDisplayInfos.clear();
@@ -7083,6 +7288,8 @@ void InputDispatcher::onWindowInfosChanged(const gui::WindowInfosUpdate& update)
         }
 
         for (const auto& [displayId, handles] : handlesPerDisplay) {
+            const std::vector<sp<WindowInfoHandle>>& oldHandles = getWindowHandlesLocked(displayId);
+            replacedHandles.insert(replacedHandles.end(), oldHandles.begin(), oldHandles.end());
             setInputWindowsLocked(handles, displayId);
         }
 
@@ -7097,6 +7304,33 @@ void InputDispatcher::onWindowInfosChanged(const gui::WindowInfosUpdate& update)
     mLooper->wake();
 }
 
+std::optional<std::unordered_set<ui::LogicalDisplayId>>
+InputDispatcher::getDisplaysWithChangedWindows(const gui::WindowInfosUpdate& update) {
+    if (!isSameDisplayInfos(update.displayInfos, mLastWindowInfosUpdate.displayInfos)) {
+        return std::nullopt;
+    }
+    const std::optional<gui::WindowInfosUpdate> delta =
+            update.makeDelta(mLastWindowInfosUpdate.windowInfos);
+    if (!delta) {
+        return std::nullopt;
+    }
+
+    std::unordered_set<ui::LogicalDisplayId> changedDisplays;
+    for (const WindowInfo& info : delta->windowInfos) {
+        changedDisplays.insert(info.displayId);
+    }
+    // Displays whose windows were removed or reordered.
+    const auto lastIdsByDisplay = getWindowIdsByDisplay(mLastWindowInfosUpdate.windowInfos);
+    const auto idsByDisplay = getWindowIdsByDisplay(update.windowInfos);
+    for (const auto& [displayId, lastIds] : lastIdsByDisplay) {
+        const auto it = idsByDisplay.find(displayId);
+        if (it == idsByDisplay.end() || it->second != lastIds) {
+            changedDisplays.insert(displayId);
+        }
+    }
+    return changedDisplays;
+}
+
 bool InputDispatcher::shouldDropInput(
         const EventEntry& entry, const sp<android::gui::WindowInfoHandle>& windowHandle) const {
     if (windowHandle->getInfo()->inputConfig.test(WindowInfo::InputConfig::DROP_INPUT) ||
@@ -32,6 +32,7 @@
 #include "Monitor.h"
 #include "TouchState.h"
 #include "TouchedWindow.h"
+#include "WindowSpatialIndex.h"
 #include "trace/InputTracerInterface.h"
 #include "trace/InputTracingBackendInterface.h"
 
@@ -229,7 +230,9 @@ private:
     void dispatchOnceInnerLocked(nsecs_t& nextWakeupTime) REQUIRES(mLock);
 
     // Enqueues an inbound event.  Returns true if mLooper->wake() should be called.
-    bool enqueueInboundEventLocked(std::unique_ptr<EventEntry> entry) REQUIRES(mLock);
+    // Takes a shared_ptr so that entries created with std::make_shared share a single allocation
+    // with their control block, rather than allocating one when moved into mInboundQueue.
+    bool enqueueInboundEventLocked(std::shared_ptr<EventEntry> entry) REQUIRES(mLock);
 
     // Cleans up input state when dropping an inbound event.
     void dropInboundEventLocked(const EventEntry& entry, DropReason dropReason) REQUIRES(mLock);
@@ -368,6 +371,15 @@ private:
     void setInputWindowsLocked(
             const std::vector<sp<android::gui::WindowInfoHandle>>& inputWindowHandles,
             ui::LogicalDisplayId displayId) REQUIRES(mLock);
+
+    // Serializes window infos updates, so that each one is compared with the one before it
+    // without holding mLock.
+    std::mutex mWindowInfosUpdateLock ACQUIRED_BEFORE(mLock);
+    gui::WindowInfosUpdate mLastWindowInfosUpdate GUARDED_BY(mWindowInfosUpdateLock);
+    // Returns the displays with a window that was added, removed, moved or changed since the last
+    // update, or std::nullopt if every display should be updated.
+    std::optional<std::unordered_set<ui::LogicalDisplayId>> getDisplaysWithChangedWindows(
+            const gui::WindowInfosUpdate& update) REQUIRES(mWindowInfosUpdateLock);
     // Get a reference to window handles by display, return an empty vector if not found.
     const std::vector<sp<android::gui::WindowInfoHandle>>& getWindowHandlesLocked(
             ui::LogicalDisplayId displayId) const REQUIRES(mLock);
@@ -396,6 +408,17 @@ private:
             const std::vector<sp<android::gui::WindowInfoHandle>>& inputWindowHandles,
             ui::LogicalDisplayId displayId) REQUIRES(mLock);
 
+    // Built from mWindowHandlesByDisplay when the display's windows are updated.
+    std::unordered_map<ui::LogicalDisplayId /*displayId*/, WindowSpatialIndex>
+            mWindowSpatialIndexByDisplay GUARDED_BY(mLock);
+
+    // Reused by publishMotionEventBatchLocked, so that publishing a batch doesn't allocate.
+    std::vector<InputMessage> mMotionEventBatch GUARDED_BY(mLock);
+    // Returns nullptr if the windows of the display should be walked instead.
+    const WindowSpatialIndex* getWindowSpatialIndexLocked(
+            ui::LogicalDisplayId displayId, const ui::Transform& displayTransform) const
+            REQUIRES(mLock);
+
     std::unordered_map<ui::LogicalDisplayId /*displayId*/, TouchState> mTouchStatesByDisplay
             GUARDED_BY(mLock);
     std::unique_ptr<DragState> mDragState GUARDED_BY(mLock);
@@ -604,9 +627,22 @@ private:
     void enqueueDispatchEntryLocked(const std::shared_ptr<Connection>& connection,
                                     std::shared_ptr<const EventEntry>,
                                     const InputTarget& inputTarget) REQUIRES(mLock);
+    status_t prepareMotionEvent(Connection& connection, const DispatchEntry& dispatchEntry,
+                                InputMessage& msg) const;
     status_t publishMotionEvent(Connection& connection, DispatchEntry& dispatchEntry) const;
     void startDispatchCycleLocked(nsecs_t currentTime,
                                   const std::shared_ptr<Connection>& connection) REQUIRES(mLock);
+    // Publishes the run of motion events at the front of the outbound queue with as few writes
+    // as possible. Returns false if the dispatch cycle can't continue.
+    bool publishMotionEventBatchLocked(nsecs_t currentTime,
+                                       const std::shared_ptr<Connection>& connection,
+                                       size_t batchSize) REQUIRES(mLock);
+    // Moves the entry at the front of the outbound queue, which has been published, to the wait
+    // queue.
+    void onDispatchEntryPublishedLocked(Connection& connection) REQUIRES(mLock);
+    void handlePublishErrorLocked(nsecs_t currentTime,
+                                  const std::shared_ptr<Connection>& connection, status_t status)
+            REQUIRES(mLock);
     void finishDispatchCycleLocked(nsecs_t currentTime,
                                    const std::shared_ptr<Connection>& connection, uint32_t seq,
                                    bool handled, nsecs_t consumeTime) REQUIRES(mLock);
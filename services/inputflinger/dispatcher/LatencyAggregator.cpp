@@ -15,14 +15,17 @@
  */
 
 #define LOG_TAG "LatencyAggregator"
+#define ATRACE_TAG ATRACE_TAG_INPUT
 #include "LatencyAggregator.h"
 
 #include <inttypes.h>
 
 #include <android-base/stringprintf.h>
+#include <ftl/enum.h>
 #include <input/Input.h>
 #include <log/log.h>
 #include <server_configurable_flags/get_flags.h>
+#include <utils/Trace.h>
 
 using android::base::StringPrintf;
 using dist_proc::aggregation::KllQuantile;
@@ -42,6 +45,9 @@ static inline int64_t ns2hus(nsecs_t nanos) {
 // The value here has been determined empirically.
 static constexpr size_t MAX_EVENTS_FOR_STATISTICS = 20000;
 
+// The number of events in each window of the rolling histograms.
+static constexpr size_t HISTOGRAM_WINDOW_SIZE = 5000;
+
 // Category (=namespace) name for the input settings that are applied at boot time
 static const char* INPUT_NATIVE_BOOT = "input_native_boot";
 // Feature flag name for the threshold of end-to-end touch latency that would trigger
@@ -76,6 +82,23 @@ static std::chrono::milliseconds getSlowEventMinReportingInterval() {
 
 namespace android::inputdispatcher {
 
+namespace {
+
+constexpr std::array<const char*, SketchIndex::SIZE> STAGE_NAMES = {
+        "EVENT_TO_READ",           "READ_TO_DELIVER",         "DELIVER_TO_CONSUME",
+        "CONSUME_TO_FINISH",       "CONSUME_TO_GPU_COMPLETE", "GPU_COMPLETE_TO_PRESENT",
+        "END_TO_END",
+};
+
+constexpr std::array<const char*, SketchIndex::SIZE> STAGE_COUNTER_NAMES = {
+        "InputLatency:EVENT_TO_READ",           "InputLatency:READ_TO_DELIVER",
+        "InputLatency:DELIVER_TO_CONSUME",      "InputLatency:CONSUME_TO_FINISH",
+        "InputLatency:CONSUME_TO_GPU_COMPLETE", "InputLatency:GPU_COMPLETE_TO_PRESENT",
+        "InputLatency:END_TO_END",
+};
+
+} // namespace
+
 /**
  * Same as android::util::BytesField, but doesn't store raw pointers, and therefore deletes its
  * resources automatically.
@@ -123,6 +146,7 @@ AStatsManager_PullAtomCallbackReturn LatencyAggregator::pullAtomCallback(int32_t
 void LatencyAggregator::processTimeline(const InputEventTimeline& timeline) {
     processStatistics(timeline);
     processSlowEvent(timeline);
+    processHistograms(timeline);
 }
 
 void LatencyAggregator::processStatistics(const InputEventTimeline& timeline) {
@@ -262,6 +286,52 @@ void LatencyAggregator::processSlowEvent(const InputEventTimeline& timeline) {
     }
 }
 
+void LatencyAggregator::processHistograms(const InputEventTimeline& timeline) {
+    for (const auto& [token, connectionTimeline] : timeline.connectionTimelines) {
+        if (!connectionTimeline.isComplete()) {
+            continue;
+        }
+        const nsecs_t gpuCompletedTime =
+                connectionTimeline.graphicsTimeline[GraphicsTimeline::GPU_COMPLETED_TIME];
+        const nsecs_t presentTime =
+                connectionTimeline.graphicsTimeline[GraphicsTimeline::PRESENT_TIME];
+
+        std::array<nsecs_t, SketchIndex::SIZE> latencies;
+        latencies[SketchIndex::EVENT_TO_READ] = timeline.readTime - timeline.eventTime;
+        latencies[SketchIndex::READ_TO_DELIVER] =
+                connectionTimeline.deliveryTime - timeline.readTime;
+        latencies[SketchIndex::DELIVER_TO_CONSUME] =
+                connectionTimeline.consumeTime - connectionTimeline.deliveryTime;
+        latencies[SketchIndex::CONSUME_TO_FINISH] =
+                connectionTimeline.finishTime - connectionTimeline.consumeTime;
+        latencies[SketchIndex::CONSUME_TO_GPU_COMPLETE] =
+                gpuCompletedTime - connectionTimeline.consumeTime;
+        latencies[SketchIndex::GPU_COMPLETE_TO_PRESENT] = presentTime - gpuCompletedTime;
+        latencies[SketchIndex::END_TO_END] = presentTime - timeline.eventTime;
+
+        for (const InputDeviceUsageSource source : timeline.sources) {
+            StageHistograms& histograms = mHistograms[source];
+            if (histograms.numEventsInWindow >= HISTOGRAM_WINDOW_SIZE) {
+                std::swap(histograms.current, histograms.previous);
+                for (LatencyHistogram& histogram : histograms.current) {
+                    histogram.clear();
+                }
+                histograms.numEventsInWindow = 0;
+            }
+            histograms.numEventsInWindow++;
+            for (size_t i = 0; i < SketchIndex::SIZE; i++) {
+                histograms.current[i].add(latencies[i]);
+            }
+        }
+
+        if (ATRACE_ENABLED()) {
+            for (size_t i = 0; i < SketchIndex::SIZE; i++) {
+                ATRACE_INT64(STAGE_COUNTER_NAMES[i], ns2us(latencies[i]));
+            }
+        }
+    }
+}
+
 std::string LatencyAggregator::dump(const char* prefix) const {
     std::scoped_lock lock(mLock);
     std::string sketchDump = StringPrintf("%s  Sketches:\n", prefix);
@@ -278,7 +348,24 @@ std::string LatencyAggregator::dump(const char* prefix) const {
                              prefix, i, numDown, downBytesKb, i, numMove, moveBytesKb);
     }
 
-    return StringPrintf("%sLatencyAggregator:\n", prefix) + sketchDump +
+    std::string histogramDump = StringPrintf("%s  Histograms (p50/p90/p99 in ms):\n", prefix);
+    for (const auto& [source, histograms] : mHistograms) {
+        std::array<LatencyHistogram, SketchIndex::SIZE> merged = histograms.current;
+        for (size_t i = 0; i < SketchIndex::SIZE; i++) {
+            merged[i].add(histograms.previous[i]);
+        }
+        histogramDump += StringPrintf("%s    %s (%zu events):\n", prefix,
+                                      ftl::enum_string(source).c_str(),
+                                      merged[SketchIndex::END_TO_END].count());
+        for (size_t i = 0; i < SketchIndex::SIZE; i++) {
+            histogramDump += StringPrintf("%s      %-24s %.3f / %.3f / %.3f\n", prefix,
+                                          STAGE_NAMES[i], merged[i].percentile(50) * 1E-6,
+                                          merged[i].percentile(90) * 1E-6,
+                                          merged[i].percentile(99) * 1E-6);
+        }
+    }
+
+    return StringPrintf("%sLatencyAggregator:\n", prefix) + sketchDump + histogramDump +
             StringPrintf("%s  mNumSketchEventsProcessed=%zu\n", prefix, mNumSketchEventsProcessed) +
             StringPrintf("%s  mLastSlowEventTime=%" PRId64 "\n", prefix, mLastSlowEventTime) +
             StringPrintf("%s  mNumEventsSinceLastSlowEventReport = %zu\n", prefix,
@@ -21,7 +21,10 @@
 #include <statslog.h>
 #include <utils/Timers.h>
 
+#include <map>
+
 #include "InputEventTimeline.h"
+#include "LatencyHistogram.h"
 
 namespace android::inputdispatcher {
 
@@ -89,6 +92,19 @@ private:
             mMoveSketches GUARDED_BY(mLock);
     // How many events have been processed so far
     size_t mNumSketchEventsProcessed GUARDED_BY(mLock) = 0;
+
+    // ---------- Rolling histograms ----------
+    // Unlike the sketches, these are never reset by a pull, and are reported in the dump and as
+    // trace counters. Each usage source keeps the histograms of the current and of the previous
+    // window of events, so the dump always covers the most recent events.
+    struct StageHistograms {
+        std::array<LatencyHistogram, SketchIndex::SIZE> current;
+        std::array<LatencyHistogram, SketchIndex::SIZE> previous;
+        size_t numEventsInWindow = 0;
+    };
+    void processHistograms(const InputEventTimeline& timeline);
+    // There is at most one entry per InputDeviceUsageSource, so the memory used is bounded.
+    std::map<InputDeviceUsageSource, StageHistograms> mHistograms;
 };
 
 } // namespace android::inputdispatcher
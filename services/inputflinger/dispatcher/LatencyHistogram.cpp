@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "LatencyHistogram.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace android::inputdispatcher {
+
+namespace {
+
+size_t bucketIndex(nsecs_t latency) {
+    if (latency <= 0) return 0;
+    const auto micros = static_cast<uint64_t>(ns2us(latency));
+    const auto index = static_cast<size_t>(std::bit_width(micros));
+    return std::min(index, LatencyHistogram::kBucketCount - 1);
+}
+
+nsecs_t bucketUpperBound(size_t index) {
+    return us2ns(static_cast<nsecs_t>(1) << index);
+}
+
+} // namespace
+
+void LatencyHistogram::add(nsecs_t latency) {
+    mBuckets[bucketIndex(latency)]++;
+    mCount++;
+}
+
+void LatencyHistogram::add(const LatencyHistogram& other) {
+    for (size_t i = 0; i < kBucketCount; i++) {
+        mBuckets[i] += other.mBuckets[i];
+    }
+    mCount += other.mCount;
+}
+
+void LatencyHistogram::clear() {
+    mBuckets.fill(0);
+    mCount = 0;
+}
+
+nsecs_t LatencyHistogram::percentile(float percent) const {
+    if (mCount == 0) return 0;
+    const auto rank = static_cast<size_t>(
+            std::ceil(std::clamp(percent, 0.f, 100.f) / 100.f * static_cast<float>(mCount)));
+    size_t seen = 0;
+    for (size_t i = 0; i < kBucketCount - 1; i++) {
+        seen += mBuckets[i];
+        if (seen >= std::max(rank, size_t{1})) {
+            return bucketUpperBound(i);
+        }
+    }
+    // The percentile is in the last bucket, which has no upper bound, so report where it starts.
+    return bucketUpperBound(kBucketCount - 2);
+}
+
+} // namespace android::inputdispatcher
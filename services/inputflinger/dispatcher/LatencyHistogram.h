@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <utils/Timers.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace android::inputdispatcher {
+
+/**
+ * A histogram of latencies with a fixed number of exponentially sized buckets. Bucket i holds the
+ * latencies in [2^(i-1), 2^i) microseconds, except for the last one, which holds everything from
+ * 2^(kBucketCount-2) microseconds up. Unlike a KLL sketch, adding a value and reading a percentile
+ * are constant time and the memory used does not depend on the number of values, so it can be kept
+ * up to date for every event.
+ */
+class LatencyHistogram {
+public:
+    // The last bucket starts at 2^22 us, about 4 seconds.
+    static constexpr size_t kBucketCount = 24;
+
+    void add(nsecs_t latency);
+    void add(const LatencyHistogram& other);
+    void clear();
+
+    size_t count() const { return mCount; }
+
+    /**
+     * Returns the upper bound of the bucket that contains the given percentile, in [0, 100], or 0
+     * if the histogram is empty. The last bucket has no upper bound, so its lower bound is
+     * returned instead.
+     */
+    nsecs_t percentile(float percent) const;
+
+private:
+    std::array<uint32_t, kBucketCount> mBuckets{};
+    size_t mCount = 0;
+};
+
+} // namespace android::inputdispatcher
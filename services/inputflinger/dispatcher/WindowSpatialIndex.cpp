@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "WindowSpatialIndex.h"
+
+#include <algorithm>
+#include <cmath>
+
+using android::gui::WindowInfo;
+using android::gui::WindowInfoHandle;
+
+namespace android::inputdispatcher {
+
+namespace {
+
+// Enough cells to keep a few windows per cell for typical layouts, without the cost of adding
+// full screen windows to every cell getting out of hand.
+constexpr int32_t kMaxCellsPerSide = 16;
+
+int32_t cellIndex(int32_t value, int32_t origin, int32_t cellSize, int32_t count) {
+    return std::clamp((value - origin) / cellSize, 0, count - 1);
+}
+
+std::vector<Rect> transformBounds(const std::vector<sp<WindowInfoHandle>>& windowHandles,
+                                  const ui::Transform& displayTransform, bool touchable) {
+    std::vector<Rect> bounds;
+    bounds.reserve(windowHandles.size());
+    for (const sp<WindowInfoHandle>& windowHandle : windowHandles) {
+        const WindowInfo& info = *windowHandle->getInfo();
+        const Rect rect = touchable ? info.touchableRegion.getBounds() : info.frame;
+        // Rounding outwards keeps the transformed region, and so every location the hit tests
+        // accept, inside the transformed bounds.
+        bounds.push_back(rect.isEmpty() ? Rect::EMPTY_RECT
+                                        : displayTransform.transform(rect,
+                                                                     /*roundOutwards=*/true));
+    }
+    return bounds;
+}
+
+} // namespace
+
+WindowSpatialIndex::WindowSpatialIndex(const std::vector<sp<WindowInfoHandle>>& windowHandles,
+                                       const ui::Transform& displayTransform)
+      : mDisplayTransform(displayTransform),
+        mTouchableGrid(transformBounds(windowHandles, displayTransform, /*touchable=*/true)),
+        mFrameGrid(transformBounds(windowHandles, displayTransform, /*touchable=*/false)) {}
+
+const std::vector<uint32_t>& WindowSpatialIndex::getTouchableCandidates(float x, float y) const {
+    const vec2 p = floor(mDisplayTransform.transform(x, y));
+    return mTouchableGrid.getCandidates(static_cast<int32_t>(p.x), static_cast<int32_t>(p.y));
+}
+
+const std::vector<uint32_t>& WindowSpatialIndex::getFrameCandidates(float x, float y) const {
+    const vec2 p = floor(mDisplayTransform.transform(x, y));
+    return mFrameGrid.getCandidates(static_cast<int32_t>(p.x), static_cast<int32_t>(p.y));
+}
+
+WindowSpatialIndex::Grid::Grid(const std::vector<Rect>& bounds) {
+    size_t windowCount = 0;
+    for (const Rect& rect : bounds) {
+        if (rect.isEmpty()) {
+            continue;
+        }
+        if (windowCount++ == 0) {
+            mBounds = rect;
+        } else {
+            mBounds.left = std::min(mBounds.left, rect.left);
+            mBounds.top = std::min(mBounds.top, rect.top);
+            mBounds.right = std::max(mBounds.right, rect.right);
+            mBounds.bottom = std::max(mBounds.bottom, rect.bottom);
+        }
+    }
+    if (windowCount == 0) {
+        return;
+    }
+
+    const int32_t cellsPerSide =
+            std::clamp(static_cast<int32_t>(std::ceil(std::sqrt(windowCount))), 1,
+                       kMaxCellsPerSide);
+    mCellWidth = std::max(1, (mBounds.getWidth() + cellsPerSide - 1) / cellsPerSide);
+    mCellHeight = std::max(1, (mBounds.getHeight() + cellsPerSide - 1) / cellsPerSide);
+    mColumns = (mBounds.getWidth() + mCellWidth - 1) / mCellWidth;
+    mRows = (mBounds.getHeight() + mCellHeight - 1) / mCellHeight;
+    mCells.resize(mColumns * mRows);
+
+    // Windows are added front to back, so every cell lists its windows in z order.
+    for (uint32_t i = 0; i < bounds.size(); i++) {
+        const Rect& rect = bounds[i];
+        if (rect.isEmpty()) {
+            continue;
+        }
+        // Rects are half open, so the last pixel inside is at (right - 1, bottom - 1).
+        const int32_t left = cellIndex(rect.left, mBounds.left, mCellWidth, mColumns);
+        const int32_t right = cellIndex(rect.right - 1, mBounds.left, mCellWidth, mColumns);
+        const int32_t top = cellIndex(rect.top, mBounds.top, mCellHeight, mRows);
+        const int32_t bottom = cellIndex(rect.bottom - 1, mBounds.top, mCellHeight, mRows);
+        for (int32_t row = top; row <= bottom; row++) {
+            for (int32_t column = left; column <= right; column++) {
+                mCells[row * mColumns + column].push_back(i);
+            }
+        }
+    }
+}
+
+const std::vector<uint32_t>& WindowSpatialIndex::Grid::getCandidates(int32_t x, int32_t y) const {
+    static const std::vector<uint32_t> EMPTY_CANDIDATES;
+    if (mCells.empty() || x < mBounds.left || x >= mBounds.right || y < mBounds.top ||
+        y >= mBounds.bottom) {
+        return EMPTY_CANDIDATES;
+    }
+    const int32_t column = (x - mBounds.left) / mCellWidth;
+    const int32_t row = (y - mBounds.top) / mCellHeight;
+    return mCells[row * mColumns + column];
+}
+
+} // namespace android::inputdispatcher
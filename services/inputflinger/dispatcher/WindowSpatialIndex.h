@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+#include <gui/WindowInfo.h>
+#include <ui/Rect.h>
+#include <ui/Transform.h>
+
+namespace android::inputdispatcher {
+
+// A grid over the windows of a display, used to narrow hit tests down to the windows which may
+// contain a location instead of walking every window. Windows are indexed by the bounds of their
+// touchable region and by their frame, in logical display space, which is where the hit tests
+// are done.
+//
+// Queries return the positions of the candidate windows in the z-ordered list the index was built
+// from, front to back. The candidates are a superset of the windows containing the location, so
+// callers still hit test each of them.
+class WindowSpatialIndex {
+public:
+    WindowSpatialIndex(const std::vector<sp<android::gui::WindowInfoHandle>>& windowHandles,
+                       const ui::Transform& displayTransform);
+
+    // Windows whose touchable region may contain the display location (x, y).
+    const std::vector<uint32_t>& getTouchableCandidates(float x, float y) const;
+    // Windows whose frame may contain the display location (x, y).
+    const std::vector<uint32_t>& getFrameCandidates(float x, float y) const;
+
+    const ui::Transform& getDisplayTransform() const { return mDisplayTransform; }
+
+private:
+    class Grid {
+    public:
+        explicit Grid(const std::vector<Rect>& bounds);
+        const std::vector<uint32_t>& getCandidates(int32_t x, int32_t y) const;
+
+    private:
+        Rect mBounds = Rect::EMPTY_RECT;
+        int32_t mColumns = 0;
+        int32_t mRows = 0;
+        int32_t mCellWidth = 1;
+        int32_t mCellHeight = 1;
+        std::vector<std::vector<uint32_t>> mCells;
+    };
+
+    ui::Transform mDisplayTransform;
+    Grid mTouchableGrid;
+    Grid mFrameGrid;
+};
+
+} // namespace android::inputdispatcher
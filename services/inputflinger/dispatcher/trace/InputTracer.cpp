@@ -96,12 +96,33 @@ InputTargetInfo getTargetInfo(const InputTarget& target) {
 
 // --- InputTracer ---
 
-InputTracer::InputTracer(std::unique_ptr<InputTracingBackendInterface> backend)
-      : mBackend(std::move(backend)) {}
+InputTracer::InputTracer(std::unique_ptr<InputTracingBackendInterface> backend,
+                         uint32_t moveSamplingInterval)
+      : mBackend(std::move(backend)), mMoveSamplingInterval(std::max(moveSamplingInterval, 1u)) {}
+
+bool InputTracer::shouldSampleInboundEvent(const EventEntry& entry) {
+    if (mMoveSamplingInterval == 1 || entry.type != EventEntry::Type::MOTION) {
+        return true;
+    }
+    const auto& motion = static_cast<const MotionEntry&>(entry);
+    const int32_t action = MotionEvent::getActionMasked(motion.action);
+    if (action != AMOTION_EVENT_ACTION_MOVE && action != AMOTION_EVENT_ACTION_HOVER_MOVE) {
+        return true;
+    }
+    if (++mSkippedMoveCount < mMoveSamplingInterval) {
+        return false;
+    }
+    mSkippedMoveCount = 0;
+    return true;
+}
 
 std::unique_ptr<EventTrackerInterface> InputTracer::traceInboundEvent(const EventEntry& entry) {
     // This is a newly traced inbound event. Create a new state to track it and its derived events.
     auto eventState = std::make_shared<EventState>(*this);
+    if (!shouldSampleInboundEvent(entry)) {
+        eventState->isSampledOut = true;
+        return std::make_unique<EventTrackerImpl>(std::move(eventState), /*isDerived=*/false);
+    }
 
     if (entry.type == EventEntry::Type::MOTION) {
         const auto& motion = static_cast<const MotionEntry&>(entry);
@@ -125,6 +146,9 @@ std::unique_ptr<EventTrackerInterface> InputTracer::createTrackerForSyntheticEve
 void InputTracer::dispatchToTargetHint(const EventTrackerInterface& cookie,
                                        const InputTarget& target) {
     auto& eventState = getState(cookie);
+    if (eventState->isSampledOut) {
+        return;
+    }
     const InputTargetInfo& targetInfo = getTargetInfo(target);
     if (eventState->isEventProcessingComplete) {
         // Disallow adding new targets after eventProcessingComplete() is called.
@@ -163,6 +187,9 @@ std::unique_ptr<EventTrackerInterface> InputTracer::traceDerivedEvent(
     // This is an event derived from an already-established event. Use the same state to track
     // this event too.
     auto eventState = getState(originalEventCookie);
+    if (eventState->isSampledOut) {
+        return std::make_unique<EventTrackerImpl>(std::move(eventState), /*isDerived=*/true);
+    }
 
     if (entry.type == EventEntry::Type::MOTION) {
         const auto& motion = static_cast<const MotionEntry&>(entry);
@@ -187,6 +214,9 @@ std::unique_ptr<EventTrackerInterface> InputTracer::traceDerivedEvent(
 void InputTracer::traceEventDispatch(const DispatchEntry& dispatchEntry,
                                      const EventTrackerInterface& cookie) {
     auto& eventState = getState(cookie);
+    if (eventState->isSampledOut) {
+        return;
+    }
     const EventEntry& entry = *dispatchEntry.eventEntry;
     const int32_t eventId = entry.id;
     // TODO(b/328618922): Remove resolved key repeats after making repeatCount non-mutable.
@@ -244,6 +274,10 @@ bool InputTracer::isDerivedCookie(const EventTrackerInterface& cookie) {
 // --- InputTracer::EventState ---
 
 void InputTracer::EventState::onEventProcessingComplete(nsecs_t processingTimestamp) {
+    if (isSampledOut) {
+        isEventProcessingComplete = true;
+        return;
+    }
     metadata.processingTimestamp = processingTimestamp;
     metadata.isImeConnectionActive = tracer.mIsImeConnectionActive;
 
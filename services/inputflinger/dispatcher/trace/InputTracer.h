@@ -32,11 +32,16 @@ namespace android::inputdispatcher::trace::impl {
  * and to write the events to the tracing backend when enough information is collected. InputTracer
  * is not thread-safe.
  *
+ * To reduce the cost of tracing, the tracer can be configured to only trace every Nth inbound MOVE
+ * or HOVER_MOVE event. All other events are always traced. The events derived from an inbound event
+ * that was not sampled, and its dispatches, are not traced either.
+ *
  * See the documentation in InputTracerInterface for the API surface.
  */
 class InputTracer : public InputTracerInterface {
 public:
-    explicit InputTracer(std::unique_ptr<InputTracingBackendInterface>);
+    explicit InputTracer(std::unique_ptr<InputTracingBackendInterface>,
+                         uint32_t moveSamplingInterval = 1);
     ~InputTracer() = default;
     InputTracer(const InputTracer&) = delete;
     InputTracer& operator=(const InputTracer&) = delete;
@@ -56,6 +61,11 @@ public:
 private:
     std::unique_ptr<InputTracingBackendInterface> mBackend;
     bool mIsImeConnectionActive{false};
+    const uint32_t mMoveSamplingInterval;
+    // The number of inbound move events that were not traced since the last traced one.
+    uint32_t mSkippedMoveCount{0};
+
+    bool shouldSampleInboundEvent(const EventEntry&);
 
     // The state of a tracked event, shared across all events derived from the original event.
     struct EventState {
@@ -67,6 +77,8 @@ private:
         InputTracer& tracer;
         std::vector<TracedEvent> events;
         bool isEventProcessingComplete{false};
+        // Whether this event and the events derived from it are skipped by move sampling.
+        bool isSampledOut{false};
         // A queue to hold dispatch args from being traced until event processing is complete.
         std::vector<WindowDispatchArgs> pendingDispatchArgs;
         // The metadata should not be modified after event processing is complete.
@@ -18,6 +18,8 @@
 
 #include <vector>
 
+#include <ftl/small_vector.h>
+
 #include <input/Input.h>
 #include <input/InputDevice.h>
 #include <input/TouchVideoFrame.h>
@@ -89,9 +91,11 @@ struct NotifyMotionArgs {
     MotionClassification classification;
     int32_t edgeFlags;
 
-    // Vectors 'pointerProperties' and 'pointerCoords' must always have the same number of elements
-    std::vector<PointerProperties> pointerProperties;
-    std::vector<PointerCoords> pointerCoords;
+    // Vectors 'pointerProperties' and 'pointerCoords' must always have the same number of elements.
+    // They hold the pointers of any valid event inline, so that creating the args and copying them
+    // through each stage of the input pipeline does not allocate.
+    ftl::SmallVector<PointerProperties, MAX_POINTERS> pointerProperties;
+    ftl::SmallVector<PointerCoords, MAX_POINTERS> pointerCoords;
     float xPrecision;
     float yPrecision;
     /**
@@ -114,10 +118,12 @@ struct NotifyMotionArgs {
                      uint32_t pointerCount, const PointerProperties* pointerProperties,
                      const PointerCoords* pointerCoords, float xPrecision, float yPrecision,
                      float xCursorPosition, float yCursorPosition, nsecs_t downTime,
-                     const std::vector<TouchVideoFrame>& videoFrames);
+                     std::vector<TouchVideoFrame> videoFrames);
 
     NotifyMotionArgs(const NotifyMotionArgs& other) = default;
+    NotifyMotionArgs(NotifyMotionArgs&& other) = default;
     NotifyMotionArgs& operator=(const android::NotifyMotionArgs&) = default;
+    NotifyMotionArgs& operator=(NotifyMotionArgs&&) = default;
 
     bool operator==(const NotifyMotionArgs& rhs) const;
 
@@ -773,6 +773,21 @@ status_t EventHub::Device::mapLed(int32_t led, int32_t* outScanCode) const {
     return NAME_NOT_FOUND;
 }
 
+void EventHub::Device::ReadStats::onRead(nsecs_t readTime, size_t eventCount) {
+    reads++;
+    events += eventCount;
+    if (windowStart == 0) {
+        windowStart = readTime;
+    }
+    windowEvents += eventCount;
+    const nsecs_t windowDuration = readTime - windowStart;
+    if (windowDuration >= s2ns(1)) {
+        eventsPerSecond = static_cast<float>(windowEvents) * 1e9f / windowDuration;
+        windowStart = readTime;
+        windowEvents = 0;
+    }
+}
+
 void EventHub::Device::trackInputEvent(const struct input_event& event) {
     switch (event.type) {
         case EV_KEY: {
@@ -1995,13 +2010,17 @@ std::vector<RawEvent> EventHub::getEvents(int timeoutMillis) {
                 } else {
                     const int32_t deviceId = device->id == mBuiltInKeyboardId ? 0 : device->id;
 
+                    // All of the events returned by a read were read at the same time.
+                    const nsecs_t readTime = systemTime(SYSTEM_TIME_MONOTONIC);
                     const size_t count = size_t(readSize) / sizeof(struct input_event);
+                    device->readStats.onRead(readTime, count);
+                    events.reserve(events.size() + count);
                     for (size_t i = 0; i < count; i++) {
                         struct input_event& iev = readBuffer[i];
                         device->trackInputEvent(iev);
                         events.push_back({
                                 .when = processEventTimestamp(iev),
-                                .readTime = systemTime(SYSTEM_TIME_MONOTONIC),
+                                .readTime = readTime,
                                 .deviceId = deviceId,
                                 .type = iev.type,
                                 .code = iev.code,
@@ -2908,6 +2927,12 @@ void EventHub::dump(std::string& dump) const {
                 }
                 dump += INDENT3 "AbsState: " + axisValues + "\n";
             }
+            const Device::ReadStats& stats = device->readStats;
+            const double eventsPerRead =
+                    stats.reads ? static_cast<double>(stats.events) / stats.reads : 0.0;
+            dump += StringPrintf(INDENT3 "Reads: %" PRIu64 ", events: %" PRIu64
+                                         " (%.1f per read), recent rate: %.1f events/s\n",
+                                 stats.reads, stats.events, eventsPerRead, stats.eventsPerSecond);
         }
 
         dump += INDENT "Unattached video devices:\n";
@@ -141,6 +141,14 @@ void InputDevice::dump(std::string& dump, const std::string& eventHubDevStr) {
                          inputEventSourceToString(deviceInfo.getSources()).c_str());
     dump += StringPrintf(INDENT2 "KeyboardType: %d\n", deviceInfo.getKeyboardType());
     dump += StringPrintf(INDENT2 "ControllerNum: %d\n", deviceInfo.getControllerNumber());
+    if (mProcessingStats.batches != 0) {
+        const nsecs_t averageTime =
+                mProcessingStats.totalTime / static_cast<nsecs_t>(mProcessingStats.batches);
+        dump += StringPrintf(INDENT2 "Processing: %" PRIu64 " batches, %" PRIu64 " events, ",
+                             mProcessingStats.batches, mProcessingStats.events);
+        dump += StringPrintf("avg=%.3fms max=%.3fms\n", ns2us(averageTime) / 1000.f,
+                             ns2us(mProcessingStats.maxTime) / 1000.f);
+    }
 
     const std::vector<InputDeviceInfo::MotionRange>& ranges = deviceInfo.getMotionRanges();
     if (!ranges.empty()) {
@@ -430,6 +438,13 @@ std::list<NotifyArgs> InputDevice::process(const RawEvent* rawEvents, size_t cou
     return out;
 }
 
+void InputDevice::recordProcessingTime(nsecs_t duration, size_t eventCount) {
+    mProcessingStats.batches++;
+    mProcessingStats.events += eventCount;
+    mProcessingStats.totalTime += duration;
+    mProcessingStats.maxTime = std::max(mProcessingStats.maxTime, duration);
+}
+
 void InputDevice::postProcess(std::list<NotifyArgs>& args) const {
     if (mIsWaking) {
         // Update policy flags to request wake for the `NotifyArgs` that come from waking devices.
@@ -14,6 +14,8 @@
  * limitations under the License.
  */
 
+#define ATRACE_TAG ATRACE_TAG_INPUT
+
 #include "Macros.h"
 
 #include "InputReader.h"
@@ -21,6 +23,7 @@
 #include <android-base/stringprintf.h>
 #include <errno.h>
 #include <input/Keyboard.h>
+#include <input/TraceTools.h>
 #include <input/VirtualKeyMap.h>
 #include <inttypes.h>
 #include <limits.h>
@@ -386,7 +389,12 @@ std::list<NotifyArgs> InputReader::processEventsForDeviceLocked(int32_t eventHub
         return {};
     }
 
-    return device->process(rawEvents, count);
+    ATRACE_NAME_IF(ATRACE_ENABLED(),
+                   StringPrintf("process %zu events for %s", count, device->getName().c_str()));
+    const nsecs_t start = systemTime(SYSTEM_TIME_MONOTONIC);
+    std::list<NotifyArgs> out = device->process(rawEvents, count);
+    device->recordProcessingTime(systemTime(SYSTEM_TIME_MONOTONIC) - start, count);
+    return out;
 }
 
 InputDevice* InputReader::findInputDeviceLocked(int32_t deviceId) const {
@@ -202,10 +202,14 @@ std::optional<TouchVideoFrame> TouchVideoDevice::readFrame() {
               static_cast<long long>(buf.timestamp.tv_sec),
               static_cast<long long>(buf.timestamp.tv_usec));
     }
-    std::vector<int16_t> data(mHeight * mWidth);
+    // The frame has to be copied out of the mapped buffer, because the buffer is handed back to
+    // the driver right away. NUM_BUFFERS is small, so holding on to buffers until the frames are
+    // consumed would stall the stream. This is the only copy of the data: TouchVideoFrame shares
+    // it with every copy of the frame from here on.
     const int16_t* readFrom = mReadLocations[buf.index];
-    std::copy(readFrom, readFrom + mHeight * mWidth, data.begin());
-    TouchVideoFrame frame(mHeight, mWidth, std::move(data), buf.timestamp);
+    TouchVideoFrame frame(mHeight, mWidth,
+                          std::vector<int16_t>(readFrom, readFrom + mHeight * mWidth),
+                          buf.timestamp);
 
     result = ioctl(mFd.get(), VIDIOC_QBUF, &buf);
     if (result == -1) {
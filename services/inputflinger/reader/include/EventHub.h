@@ -692,6 +692,18 @@ private:
         bool currentFrameDropped;
         void trackInputEvent(const struct input_event& event);
         void readDeviceState();
+
+        // How often the device is read and how many events each read returns, for dumpsys.
+        struct ReadStats {
+            uint64_t reads = 0;
+            uint64_t events = 0;
+            // The event rate over the last full second in which the device was read.
+            float eventsPerSecond = 0;
+            nsecs_t windowStart = 0;
+            uint64_t windowEvents = 0;
+
+            void onRead(nsecs_t readTime, size_t eventCount);
+        } readStats;
     };
 
     /**
@@ -93,6 +93,8 @@ public:
                                                   ConfigurationChanges changes);
     [[nodiscard]] std::list<NotifyArgs> reset(nsecs_t when);
     [[nodiscard]] std::list<NotifyArgs> process(const RawEvent* rawEvents, size_t count);
+    // Records how long the mappers took to process a batch of raw events, for dumpsys.
+    void recordProcessingTime(nsecs_t duration, size_t eventCount);
     [[nodiscard]] std::list<NotifyArgs> timeoutExpired(nsecs_t when);
     [[nodiscard]] std::list<NotifyArgs> updateExternalStylusState(const StylusState& state);
 
@@ -210,6 +212,15 @@ private:
     bool mDropUntilNextSync;
     std::optional<bool> mShouldSmoothScroll;
 
+    // How long the mappers of this device take to process the raw events of each batch. All
+    // devices are processed in turn on the reader thread, so a slow device delays the others.
+    struct ProcessingStats {
+        uint64_t batches = 0;
+        uint64_t events = 0;
+        nsecs_t totalTime = 0;
+        nsecs_t maxTime = 0;
+    } mProcessingStats;
+
     typedef int32_t (InputMapper::*GetStateFunc)(uint32_t sourceMask, int32_t code);
     int32_t getState(uint32_t sourceMask, int32_t code, GetStateFunc getStateFunc);
 
@@ -108,6 +108,20 @@ static ui::Size getNaturalDisplaySize(const DisplayViewport& viewport) {
     return rotatedDisplaySize;
 }
 
+// Whether the properties of the viewport that the input transforms, the display bounds and the
+// target display are computed from are different.
+static bool isViewportGeometryChanged(const DisplayViewport& oldViewport,
+                                      const DisplayViewport& newViewport) {
+    return oldViewport.displayId != newViewport.displayId ||
+            oldViewport.orientation != newViewport.orientation ||
+            oldViewport.physicalLeft != newViewport.physicalLeft ||
+            oldViewport.physicalTop != newViewport.physicalTop ||
+            oldViewport.physicalRight != newViewport.physicalRight ||
+            oldViewport.physicalBottom != newViewport.physicalBottom ||
+            oldViewport.deviceWidth != newViewport.deviceWidth ||
+            oldViewport.deviceHeight != newViewport.deviceHeight;
+}
+
 static int32_t filterButtonState(InputReaderConfiguration& config, int32_t buttonState) {
     if (!config.stylusButtonMotionEventsEnabled) {
         buttonState &=
@@ -989,6 +1003,14 @@ void TouchInputMapper::configureInputDevice(nsecs_t when, bool* outResetNeeded)
     }
 
     const bool deviceModeChanged = mDeviceMode != oldDeviceMode;
+    if (viewportChanged && !deviceModeChanged &&
+        !isViewportGeometryChanged(mViewport, newViewport)) {
+        // Only properties that the mapper doesn't use changed, such as the logical frame or the
+        // active state. Keep the viewport up to date without recomputing the transforms or
+        // resetting the ongoing gesture.
+        mViewport = newViewport;
+        return;
+    }
     bool skipViewportUpdate = false;
     if (viewportChanged || deviceModeChanged) {
         const bool viewportOrientationChanged = mViewport.orientation != newViewport.orientation;
@@ -435,33 +435,35 @@ std::list<NotifyArgs> TouchpadInputMapper::process(const RawEvent& rawEvent) {
 }
 
 void TouchpadInputMapper::updatePalmDetectionMetrics() {
-    std::set<int32_t> currentTrackingIds;
+    mCurrentFrameTrackingIds.clear();
     for (size_t i = 0; i < mMotionAccumulator.getSlotCount(); i++) {
         const MultiTouchMotionAccumulator::Slot& slot = mMotionAccumulator.getSlot(i);
         if (!slot.isInUse()) {
             continue;
         }
-        currentTrackingIds.insert(slot.getTrackingId());
+        mCurrentFrameTrackingIds.push_back(slot.getTrackingId());
         if (slot.getToolType() == ToolType::PALM) {
             mPalmTrackingIds.insert(slot.getTrackingId());
         }
     }
-    std::vector<int32_t> liftedTouches;
-    std::set_difference(mLastFrameTrackingIds.begin(), mLastFrameTrackingIds.end(),
-                        currentTrackingIds.begin(), currentTrackingIds.end(),
-                        std::inserter(liftedTouches, liftedTouches.begin()));
-    for (int32_t trackingId : liftedTouches) {
+    std::sort(mCurrentFrameTrackingIds.begin(), mCurrentFrameTrackingIds.end());
+    for (int32_t trackingId : mLastFrameTrackingIds) {
+        if (std::binary_search(mCurrentFrameTrackingIds.begin(), mCurrentFrameTrackingIds.end(),
+                               trackingId)) {
+            continue;
+        }
+        // This touch was lifted.
         if (mPalmTrackingIds.erase(trackingId) > 0) {
             MetricsAccumulator::getInstance().recordPalm(mMetricsId);
         } else {
             MetricsAccumulator::getInstance().recordFinger(mMetricsId);
         }
     }
-    mLastFrameTrackingIds = currentTrackingIds;
+    std::swap(mLastFrameTrackingIds, mCurrentFrameTrackingIds);
 }
 
 std::list<NotifyArgs> TouchpadInputMapper::sendHardwareState(nsecs_t when, nsecs_t readTime,
-                                                             SelfContainedHardwareState schs) {
+                                                             SelfContainedHardwareState& schs) {
     ALOGD_IF(DEBUG_TOUCHPAD_GESTURES, "New hardware state: %s", schs.state.String().c_str());
     mGestureInterpreter->PushHardwareState(&schs.state);
     return processGestures(when, readTime);
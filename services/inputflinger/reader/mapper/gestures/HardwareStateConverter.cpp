@@ -80,7 +80,8 @@ SelfContainedHardwareState HardwareStateConverter::produceHardwareState(nsecs_t
         schs.state.buttons_down |= GESTURES_BUTTON_FORWARD;
     }
 
-    schs.fingers.clear();
+    // Reserve a FingerState for each slot, so that the vector is allocated once per state.
+    schs.fingers.reserve(mMotionAccumulator.getSlotCount());
     size_t numPalms = 0;
     for (size_t i = 0; i < mMotionAccumulator.getSlotCount(); i++) {
         MultiTouchMotionAccumulator::Slot slot = mMotionAccumulator.getSlot(i);
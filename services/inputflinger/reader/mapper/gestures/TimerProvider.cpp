@@ -86,9 +86,18 @@ std::string TimerProvider::dump() {
 
 void TimerProvider::triggerCallbacks(nsecs_t when) {
     while (!mDeadlines.empty() && when >= mDeadlines.begin()->first) {
-        const auto& deadlinePair = mDeadlines.begin();
-        deadlinePair->second.callback(when);
-        mDeadlines.erase(deadlinePair);
+        // Remove the deadline before running its callback, in case the callback modifies the
+        // deadlines.
+        const Deadline deadline = mDeadlines.begin()->second;
+        mDeadlines.erase(mDeadlines.begin());
+
+        const stime_t nextDelay = deadline.callback(nsecsToStime(when), deadline.callbackData);
+        if (nextDelay >= 0.0) {
+            // We're about to call requestTimeout below, so don't request one for each rescheduled
+            // deadline, as it would be for a timeout that has already passed.
+            setDeadlineWithoutRequestingTimeout(deadline.timerId, stimeToNsecs(nextDelay),
+                                                deadline.callback, deadline.callbackData);
+        }
     }
     requestTimeout();
 }
@@ -102,28 +111,19 @@ GesturesTimer* TimerProvider::createTimer() {
 
 void TimerProvider::setDeadline(GesturesTimer* timer, nsecs_t delay, GesturesTimerCallback callback,
                                 void* callbackData) {
-    setDeadlineWithoutRequestingTimeout(timer, delay, callback, callbackData);
+    setDeadlineWithoutRequestingTimeout(timer->id, delay, callback, callbackData);
     requestTimeout();
 }
 
-void TimerProvider::setDeadlineWithoutRequestingTimeout(GesturesTimer* timer, nsecs_t delay,
+void TimerProvider::setDeadlineWithoutRequestingTimeout(int timerId, nsecs_t delay,
                                                         GesturesTimerCallback callback,
                                                         void* callbackData) {
     const nsecs_t now = getCurrentTime();
     const nsecs_t time = now + delay;
-    std::function<void(nsecs_t)> wrappedCallback = [=, this](nsecs_t triggerTime) {
-        stime_t nextDelay = callback(nsecsToStime(triggerTime), callbackData);
-        if (nextDelay >= 0.0) {
-            // When rescheduling a deadline, we know that we're running inside a call to
-            // triggerCallbacks, at the end of which requestTimeout will be called. This means that
-            // we don't want to call the public setDeadline, as that will request a timeout before
-            // triggerCallbacks has removed this current deadline, resulting in a request for a
-            // timeout that has already passed.
-            setDeadlineWithoutRequestingTimeout(timer, stimeToNsecs(nextDelay), callback,
-                                                callbackData);
-        }
-    };
-    mDeadlines.insert({time, Deadline(wrappedCallback, timer->id)});
+    mDeadlines.insert({time,
+                       Deadline{.callback = callback,
+                                .callbackData = callbackData,
+                                .timerId = timerId}});
 }
 
 void TimerProvider::cancelTimer(GesturesTimer* timer) {
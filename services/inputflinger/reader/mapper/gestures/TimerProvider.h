@@ -58,7 +58,7 @@ protected:
     virtual nsecs_t getCurrentTime();
 
 private:
-    void setDeadlineWithoutRequestingTimeout(GesturesTimer* timer, nsecs_t delay,
+    void setDeadlineWithoutRequestingTimeout(int timerId, nsecs_t delay,
                                              GesturesTimerCallback callback, void* callbackData);
     // Requests a timeout from the InputReader for the nearest deadline in mDeadlines. Must be
     // called whenever mDeadlines is modified.
@@ -68,11 +68,12 @@ private:
     int mNextTimerId = 0;
     std::vector<std::unique_ptr<GesturesTimer>> mTimers;
 
+    // The library's callback is stored as is, rather than wrapped in a std::function, so that
+    // setting a deadline doesn't allocate.
     struct Deadline {
-        Deadline(std::function<void(nsecs_t)> callback, int timerId)
-              : callback(callback), timerId(timerId) {}
-        const std::function<void(nsecs_t)> callback;
-        const int timerId;
+        GesturesTimerCallback callback;
+        void* callbackData;
+        int timerId;
     };
 
     std::multimap<nsecs_t /*time*/, Deadline> mDeadlines;
@@ -763,6 +763,75 @@ TEST_F(InputDispatcherTest, SetInputWindowTwice_SingleWindowTouch) {
     window->consumeMotionDown(ui::LogicalDisplayId::DEFAULT);
 }
 
+/**
+ * With incremental window infos updates, a display whose windows didn't change is left as it is,
+ * while the windows of the other displays are updated.
+ */
+TEST_F(InputDispatcherTest, IncrementalWindowInfosUpdate_UpdatesChangedDisplay) {
+    SCOPED_FLAG_OVERRIDE(incremental_window_infos_update, true);
+    std::shared_ptr<FakeApplicationHandle> application = std::make_shared<FakeApplicationHandle>();
+    sp<FakeWindowHandle> window =
+            sp<FakeWindowHandle>::make(application, mDispatcher, "Fake Window",
+                                       ui::LogicalDisplayId::DEFAULT);
+    window->setFrame(Rect(0, 0, 100, 100));
+    sp<FakeWindowHandle> secondWindow =
+            sp<FakeWindowHandle>::make(application, mDispatcher, "Second Display Window",
+                                       SECOND_DISPLAY_ID);
+    secondWindow->setFrame(Rect(0, 0, 100, 100));
+    mDispatcher->onWindowInfosChanged({{*window->getInfo(), *secondWindow->getInfo()}, {}, 0, 0});
+
+    secondWindow->setFrame(Rect(200, 200, 300, 300));
+    mDispatcher->onWindowInfosChanged({{*window->getInfo(), *secondWindow->getInfo()}, {}, 1, 0});
+
+    ASSERT_EQ(InputEventInjectionResult::SUCCEEDED,
+              injectMotionDown(*mDispatcher, AINPUT_SOURCE_TOUCHSCREEN,
+                               ui::LogicalDisplayId::DEFAULT, {50, 50}));
+    window->consumeMotionDown(ui::LogicalDisplayId::DEFAULT);
+
+    ASSERT_EQ(InputEventInjectionResult::SUCCEEDED,
+              injectMotionDown(*mDispatcher, AINPUT_SOURCE_TOUCHSCREEN, SECOND_DISPLAY_ID,
+                               {250, 250}));
+    secondWindow->consumeMotionDown(SECOND_DISPLAY_ID);
+}
+
+/**
+ * With the spatial window index, touches still go to the top window at their location, and the
+ * index follows windows which move.
+ */
+TEST_F(InputDispatcherTest, SpatialWindowIndex_TouchGoesToTopWindowAtLocation) {
+    SCOPED_FLAG_OVERRIDE(spatial_window_index, true);
+    std::shared_ptr<FakeApplicationHandle> application = std::make_shared<FakeApplicationHandle>();
+    sp<FakeWindowHandle> topWindow = sp<FakeWindowHandle>::make(application, mDispatcher, "Top",
+                                                                ui::LogicalDisplayId::DEFAULT);
+    topWindow->setFrame(Rect(0, 0, 100, 100));
+    sp<FakeWindowHandle> bottomWindow =
+            sp<FakeWindowHandle>::make(application, mDispatcher, "Bottom",
+                                       ui::LogicalDisplayId::DEFAULT);
+    bottomWindow->setFrame(Rect(0, 0, 1000, 1000));
+    mDispatcher->onWindowInfosChanged(
+            {{*topWindow->getInfo(), *bottomWindow->getInfo()}, {}, 0, 0});
+
+    ASSERT_EQ(InputEventInjectionResult::SUCCEEDED,
+              injectMotionDown(*mDispatcher, AINPUT_SOURCE_TOUCHSCREEN,
+                               ui::LogicalDisplayId::DEFAULT, {50, 50}));
+    topWindow->consumeMotionDown(ui::LogicalDisplayId::DEFAULT);
+    bottomWindow->assertNoEvents();
+    ASSERT_EQ(InputEventInjectionResult::SUCCEEDED,
+              injectMotionUp(*mDispatcher, AINPUT_SOURCE_TOUCHSCREEN,
+                             ui::LogicalDisplayId::DEFAULT, {50, 50}));
+    topWindow->consumeMotionUp(ui::LogicalDisplayId::DEFAULT);
+
+    topWindow->setFrame(Rect(500, 500, 600, 600));
+    mDispatcher->onWindowInfosChanged(
+            {{*topWindow->getInfo(), *bottomWindow->getInfo()}, {}, 1, 0});
+
+    ASSERT_EQ(InputEventInjectionResult::SUCCEEDED,
+              injectMotionDown(*mDispatcher, AINPUT_SOURCE_TOUCHSCREEN,
+                               ui::LogicalDisplayId::DEFAULT, {50, 50}));
+    bottomWindow->consumeMotionDown(ui::LogicalDisplayId::DEFAULT);
+    topWindow->assertNoEvents();
+}
+
 // The foreground window should receive the first touch down event.
 TEST_F(InputDispatcherTest, SetInputWindow_MultiWindowsTouch) {
     std::shared_ptr<FakeApplicationHandle> application = std::make_shared<FakeApplicationHandle>();
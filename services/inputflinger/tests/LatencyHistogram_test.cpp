@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "../dispatcher/LatencyHistogram.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+
+namespace android::inputdispatcher {
+
+namespace {
+
+using namespace std::chrono_literals;
+
+nsecs_t ns(std::chrono::nanoseconds duration) {
+    return duration.count();
+}
+
+} // namespace
+
+TEST(LatencyHistogramTest, EmptyHistogramReportsZero) {
+    LatencyHistogram histogram;
+    ASSERT_EQ(0u, histogram.count());
+    ASSERT_EQ(0, histogram.percentile(50));
+}
+
+TEST(LatencyHistogramTest, PercentileIsUpperBoundOfBucket) {
+    LatencyHistogram histogram;
+    // 90 events in [8, 16) ms and 10 events in [64, 128) ms.
+    for (int i = 0; i < 90; i++) {
+        histogram.add(ns(10ms));
+    }
+    for (int i = 0; i < 10; i++) {
+        histogram.add(ns(100ms));
+    }
+
+    ASSERT_EQ(100u, histogram.count());
+    ASSERT_EQ(us2ns(16384), histogram.percentile(50));
+    ASSERT_EQ(us2ns(16384), histogram.percentile(90));
+    ASSERT_EQ(us2ns(131072), histogram.percentile(99));
+    ASSERT_EQ(us2ns(131072), histogram.percentile(100));
+}
+
+TEST(LatencyHistogramTest, LargeLatenciesGoToLastBucket) {
+    LatencyHistogram histogram;
+    histogram.add(ns(1h));
+    histogram.add(ns(5s));
+    // The last bucket starts at 2^22 us, and has no upper bound.
+    ASSERT_EQ(us2ns(nsecs_t{1} << 22), histogram.percentile(50));
+    ASSERT_EQ(us2ns(nsecs_t{1} << 22), histogram.percentile(100));
+}
+
+TEST(LatencyHistogramTest, AddMergesAndClearEmpties) {
+    LatencyHistogram first;
+    first.add(ns(1ms));
+    LatencyHistogram second;
+    second.add(ns(2ms));
+    second.add(ns(3ms));
+
+    first.add(second);
+    ASSERT_EQ(3u, first.count());
+
+    first.clear();
+    ASSERT_EQ(0u, first.count());
+    ASSERT_EQ(0, first.percentile(99));
+}
+
+} // namespace android::inputdispatcher
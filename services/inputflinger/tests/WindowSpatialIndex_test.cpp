@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "../dispatcher/WindowSpatialIndex.h"
+
+// atest inputflinger_tests:WindowSpatialIndexTest
+
+using android::gui::WindowInfo;
+using android::gui::WindowInfoHandle;
+
+namespace android::inputdispatcher {
+
+namespace {
+
+sp<WindowInfoHandle> createWindow(const Rect& frame) {
+    WindowInfo info;
+    info.frame = frame;
+    info.touchableRegion = Region(frame);
+    return sp<WindowInfoHandle>::make(info);
+}
+
+} // namespace
+
+TEST(WindowSpatialIndexTest, CandidatesAreFrontToBack) {
+    const std::vector<sp<WindowInfoHandle>> windows{createWindow(Rect(0, 0, 100, 100)),
+                                                    createWindow(Rect(500, 500, 600, 600)),
+                                                    createWindow(Rect(0, 0, 1000, 1000))};
+    WindowSpatialIndex index(windows, ui::Transform());
+
+    EXPECT_EQ(std::vector<uint32_t>({0, 2}), index.getTouchableCandidates(50, 50));
+    EXPECT_EQ(std::vector<uint32_t>({1, 2}), index.getFrameCandidates(550, 550));
+    EXPECT_EQ(std::vector<uint32_t>({2}), index.getTouchableCandidates(900, 100));
+    EXPECT_TRUE(index.getTouchableCandidates(1000, 1000).empty());
+    EXPECT_TRUE(index.getFrameCandidates(-1, 50).empty());
+}
+
+TEST(WindowSpatialIndexTest, TouchableRegionAndFrameAreIndexedSeparately) {
+    sp<WindowInfoHandle> window = createWindow(Rect(0, 0, 1000, 1000));
+    window->editInfo()->touchableRegion = Region(Rect(0, 0, 100, 100));
+    WindowSpatialIndex index({window}, ui::Transform());
+
+    EXPECT_TRUE(index.getTouchableCandidates(500, 500).empty());
+    EXPECT_EQ(std::vector<uint32_t>({0}), index.getFrameCandidates(500, 500));
+}
+
+TEST(WindowSpatialIndexTest, RotatedDisplay) {
+    // The windows and locations are in display space, and are indexed in the rotated logical
+    // display space, as the hit tests are done.
+    const std::vector<sp<WindowInfoHandle>> windows{createWindow(Rect(0, 0, 100, 100)),
+                                                    createWindow(Rect(100, 0, 200, 100))};
+    WindowSpatialIndex index(windows, ui::Transform(ui::Transform::ROT_90, 1000, 2000));
+
+    EXPECT_EQ(std::vector<uint32_t>({0}), index.getTouchableCandidates(50, 50));
+    EXPECT_EQ(std::vector<uint32_t>({1}), index.getTouchableCandidates(150, 50));
+    EXPECT_TRUE(index.getTouchableCandidates(250, 50).empty());
+}
+
+TEST(WindowSpatialIndexTest, EmptyWindowsAreNotIndexed) {
+    const std::vector<sp<WindowInfoHandle>> windows{createWindow(Rect::INVALID_RECT),
+                                                    createWindow(Rect(0, 0, 10, 10))};
+    WindowSpatialIndex index(windows, ui::Transform());
+
+    EXPECT_EQ(std::vector<uint32_t>({1}), index.getTouchableCandidates(0, 0));
+}
+
+} // namespace android::inputdispatcher
@@ -49,8 +49,8 @@ public:
         InputVerifier& verifier = it->second;
         const Result<void> result =
                 verifier.processMovement(args.deviceId, args.source, args.action,
-                                         args.getPointerCount(), args.pointerProperties.data(),
-                                         args.pointerCoords.data(), args.flags);
+                                         args.getPointerCount(), args.pointerProperties.begin(),
+                                         args.pointerCoords.begin(), args.flags);
         if (result.ok()) {
             return args;
         }
@@ -59,6 +59,8 @@ enum EventQueueFlagBitsInternal : uint32_t {
     INTERNAL_WAKE = 1 << 16,
 };
 
+using EventMessageQueue = AidlMessageQueue<Event, SynchronizedReadWrite>;
+
 } // anonymous namespace
 
 class AidlSensorsCallback : public ::aidl::android::hardware::sensors::BnSensorsCallback {
@@ -186,18 +188,22 @@ ssize_t AidlSensorHalWrapper::pollFmq(sensors_event_t *buffer, size_t maxNumEven
         }
     }
 
-    size_t eventsToRead = std::min({availableEvents, maxNumEventsToRead, mEventBuffer.size()});
+    size_t eventsToRead = std::min(availableEvents, maxNumEventsToRead);
     if (eventsToRead > 0) {
-        if (mEventQueue->read(mEventBuffer.data(), eventsToRead)) {
+        // Convert the events in place in the FMQ instead of copying them out first. The slots
+        // stay owned by the reader until commitRead.
+        EventMessageQueue::MemTransaction tx;
+        if (mEventQueue->beginRead(eventsToRead, &tx)) {
+            for (size_t i = 0; i < eventsToRead; i++) {
+                convertToSensorEvent(*tx.getSlot(i), &buffer[i]);
+            }
+            mEventQueue->commitRead(eventsToRead);
+
             // Notify the Sensors HAL that sensor events have been read. This is required to support
             // the use of writeBlocking by the Sensors HAL.
             if (mEventQueueFlag != nullptr) {
                 mEventQueueFlag->wake(asBaseType(ISensors::EVENT_QUEUE_FLAG_BITS_EVENTS_READ));
             }
-
-            for (size_t i = 0; i < eventsToRead; i++) {
-                convertToSensorEvent(mEventBuffer[i], &buffer[i]);
-            }
             eventsRead = eventsToRead;
         } else {
             ALOGW("Failed to read %zu events, currently %zu events available", eventsToRead,
@@ -21,7 +21,6 @@
 
 #include <aidl/android/hardware/sensors/ISensors.h>
 #include <fmq/AidlMessageQueue.h>
-#include <sensor/SensorEventQueue.h>
 
 namespace android {
 
@@ -85,9 +84,6 @@ private:
     ::android::hardware::EventFlag *mEventQueueFlag;
     ::android::hardware::EventFlag *mWakeLockQueueFlag;
     SensorDeviceCallback *mSensorDeviceCallback;
-    std::array<::aidl::android::hardware::sensors::Event,
-               ::android::SensorEventQueue::MAX_RECEIVE_BUFFER_EVENT_COUNT>
-            mEventBuffer;
 
     ndk::ScopedAIBinder_DeathRecipient mDeathRecipient;
 };
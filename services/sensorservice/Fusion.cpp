@@ -487,7 +487,21 @@ void Fusion::predict(const vec3_t& w, float dT) {
     if (x0.w < 0)
         x0 = -x0;
 
-    P = Phi*P*transpose(Phi) + GQGt;
+    // Phi's lower blocks are always | 0 I33 |, so P(k+1) only needs the products
+    // with Phi00 and Phi10 instead of two full 6x6 block products:
+    //
+    //  T0 = Phi00*P00 + Phi10*P01    T1 = Phi00*P10 + Phi10*P11
+    //
+    //  P(k+1) = | T0*Phi00' + T1*Phi10'    T1  | + G*Q(k)*G'
+    //           | P01*Phi00' + P11*Phi10'  P11 |
+    const mat33_t Phi00t(transpose(Phi[0][0]));
+    const mat33_t Phi10t(transpose(Phi[1][0]));
+    const mat33_t T0(Phi[0][0]*P[0][0] + Phi[1][0]*P[0][1]);
+    const mat33_t T1(Phi[0][0]*P[1][0] + Phi[1][0]*P[1][1]);
+    P[0][1] = P[0][1]*Phi00t + P[1][1]*Phi10t + GQGt[0][1];
+    P[0][0] = T0*Phi00t + T1*Phi10t + GQGt[0][0];
+    P[1][0] = T1 + GQGt[1][0];
+    P[1][1] += GQGt[1][1];
 
     checkState();
 }
@@ -40,7 +40,6 @@ RecentEventLogger::RecentEventLogger(int sensorType) :
 }
 
 void RecentEventLogger::addEvent(const sensors_event_t& event) {
-    std::lock_guard<std::mutex> lk(mLock);
     mRecentEvents.emplace(event);
     mIsLastEventCurrent = true;
 }
@@ -50,13 +49,10 @@ bool RecentEventLogger::isEmpty() const {
 }
 
 void RecentEventLogger::setLastEventStale() {
-    std::lock_guard<std::mutex> lk(mLock);
     mIsLastEventCurrent = false;
 }
 
 std::string RecentEventLogger::dump() const {
-    std::lock_guard<std::mutex> lk(mLock);
-
     //TODO: replace String8 with std::string completely in this function
     String8 buffer;
 
@@ -95,8 +91,6 @@ std::string RecentEventLogger::dump() const {
  */
 void RecentEventLogger::dump(util::ProtoOutputStream* proto) const {
     using namespace service::SensorEventsProto;
-    std::lock_guard<std::mutex> lk(mLock);
-
     proto->write(RecentEventsLog::RECENT_EVENTS_COUNT, int(mRecentEvents.size()));
     for (int i = mRecentEvents.size() - 1; i >= 0; --i) {
         const auto& ev = mRecentEvents[i];
@@ -129,8 +123,6 @@ void RecentEventLogger::setFormat(std::string format) {
 }
 
 bool RecentEventLogger::populateLastEventIfCurrent(sensors_event_t *event) const {
-    std::lock_guard<std::mutex> lk(mLock);
-
     if (mIsLastEventCurrent && mRecentEvents.size()) {
         // Index 0 contains the latest event emplace()'ed
         *event = mRecentEvents[0].mEvent;
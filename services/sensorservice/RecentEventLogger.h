@@ -23,8 +23,6 @@
 #include <hardware/sensors.h>
 #include <utils/String8.h>
 
-#include <mutex>
-
 namespace android {
 namespace SensorServiceUtil {
 
@@ -33,6 +31,9 @@ namespace SensorServiceUtil {
 // generated from the sensor are stored in this buffer.  The buffer is NOT cleared when the sensor
 // unregisters and as a result very old data in the dumpsys output can be seen, which is an intended
 // behavior.
+//
+// RecentEventLogger is not thread safe. SensorService only uses its loggers under its own mLock,
+// which also guards the map of loggers, so events are recorded without taking another lock.
 class RecentEventLogger : public Dumpable {
 public:
     explicit RecentEventLogger(int sensorType);
@@ -61,7 +62,6 @@ protected:
     const int mSensorType;
     const size_t mEventSize;
 
-    mutable std::mutex mLock;
     RingBuffer<SensorEventLog> mRecentEvents;
 
     bool mMaskData;
@@ -171,7 +171,10 @@ private:
 
 
 template <class T>
-RingBuffer<T>::RingBuffer(size_t length) : mFrontIdx{0}, mMaxBufferSize{length} {}
+RingBuffer<T>::RingBuffer(size_t length) : mFrontIdx{0}, mMaxBufferSize{length} {
+    // Allocate the storage once, so that filling up the buffer never reallocates.
+    mBuffer.reserve(length);
+}
 
 template <class T>
 RingBuffer<T>::iterator::iterator(T* ptr, size_t size, size_t pos, size_t ctr) :
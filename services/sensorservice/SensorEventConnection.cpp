@@ -296,6 +296,9 @@ status_t SensorService::SensorEventConnection::sendEvents(
 
     int count = 0;
     Mutex::Autolock _l(mConnectionLock);
+    // Checking the access takes the UID policy lock, so do it once for the whole batch rather than
+    // for each event.
+    const bool hasAccess = hasSensorAccess();
     if (scratch) {
         size_t i=0;
         while (i<numEvents) {
@@ -311,12 +314,13 @@ status_t SensorService::SensorEventConnection::sendEvents(
 
             // Check if this connection has registered for this sensor. If not continue to the
             // next sensor_event.
-            if (mSensorInfo.count(sensor_handle) == 0) {
+            const auto sensorInfoIt = mSensorInfo.find(sensor_handle);
+            if (sensorInfoIt == mSensorInfo.end()) {
                 ++i;
                 continue;
             }
 
-            FlushInfo& flushInfo = mSensorInfo[sensor_handle];
+            FlushInfo& flushInfo = sensorInfoIt->second;
             // Check if there is a pending flush_complete event for this sensor on this connection.
             if (buffer[i].type == SENSOR_TYPE_META_DATA && flushInfo.mFirstFlushPending == true &&
                     mapFlushEventsToConnections[i] == this) {
@@ -346,7 +350,7 @@ status_t SensorService::SensorEventConnection::sendEvents(
                 } else {
                     // Regular sensor event, just copy it to the scratch buffer after checking
                     // the AppOp.
-                    if (hasSensorAccess() && noteOpIfRequired(buffer[i])) {
+                    if (hasAccess && noteOpIfRequired(buffer[i])) {
                         scratch[count++] = buffer[i];
                     }
                 }
@@ -357,7 +361,7 @@ status_t SensorService::SensorEventConnection::sendEvents(
                                         buffer[i].meta_data.sensor == sensor_handle)));
         }
     } else {
-        if (hasSensorAccess()) {
+        if (hasAccess) {
             scratch = const_cast<sensors_event_t *>(buffer);
             count = numEvents;
         } else {
@@ -388,7 +392,7 @@ status_t SensorService::SensorEventConnection::sendEvents(
     }
 
     int index_wake_up_event = -1;
-    if (hasSensorAccess()) {
+    if (hasAccess) {
         index_wake_up_event = findWakeUpSensorEventLocked(scratch, count);
         if (index_wake_up_event >= 0) {
             BatteryService::noteWakeupSensorEvent(scratch[index_wake_up_event].timestamp,
@@ -653,6 +653,11 @@ status_t SensorService::dump(int fd, const Vector<String16>& args) {
 
             result.appendFormat("Socket Buffer size = %zd events\n",
                                 mSocketBufferSize/sizeof(sensors_event_t));
+            const PermissionCache::Stats permissionStats = PermissionCache::getStats();
+            result.appendFormat("Permission cache: %" PRIu64 " hits, %" PRIu64 " misses, %zu "
+                                "entries\n",
+                                permissionStats.hits, permissionStats.misses,
+                                permissionStats.entries);
             result.appendFormat("WakeLock Status: %s \n", mWakeLockAcquired ? "acquired" :
                     "not held");
             result.appendFormat("Mode :");
@@ -1184,8 +1189,18 @@ bool SensorService::threadLoop() {
                         fusion.process(event[i]);
                     }
                 }
+                // Look the virtual sensors up once for the batch rather than for each event.
+                for (int handle : mActiveVirtualSensors) {
+                    std::shared_ptr<SensorInterface> si = getSensorInterfaceFromHandle(handle);
+                    if (si == nullptr) {
+                        ALOGE("handle %d is not an valid virtual sensor", handle);
+                        continue;
+                    }
+                    mActiveVirtualSensorInterfaces.push_back(std::move(si));
+                }
                 for (size_t i=0 ; i<size_t(count) && k<minBufferSize ; i++) {
-                    for (int handle : mActiveVirtualSensors) {
+                    for (const std::shared_ptr<SensorInterface>& si :
+                         mActiveVirtualSensorInterfaces) {
                         if (count + k >= minBufferSize) {
                             ALOGE("buffer too small to hold all events: "
                                     "count=%zd, k=%zu, size=%zu",
@@ -1193,18 +1208,13 @@ bool SensorService::threadLoop() {
                             break;
                         }
                         sensors_event_t out;
-                        std::shared_ptr<SensorInterface> si = getSensorInterfaceFromHandle(handle);
-                        if (si == nullptr) {
-                            ALOGE("handle %d is not an valid virtual sensor", handle);
-                            continue;
-                        }
-
                         if (si->process(&out, event[i])) {
                             mSensorEventBuffer[count + k] = out;
                             k++;
                         }
                     }
                 }
+                mActiveVirtualSensorInterfaces.clear();
                 if (k) {
                     // record the last synthesized values
                     recordLastValueLocked(&mSensorEventBuffer[count], k);
@@ -2560,7 +2570,10 @@ void SensorService::UidPolicy::unregisterSelf() {
     am.unregisterUidObserver(this);
 }
 
-void SensorService::UidPolicy::onUidGone(__unused uid_t uid, __unused bool disabled) {
+void SensorService::UidPolicy::onUidGone(uid_t uid, __unused bool disabled) {
+    // The permissions of a uid which is gone may change before it is used again, e.g. when the
+    // app is uninstalled, so don't keep its cached permission checks.
+    PermissionCache::purgeUid(uid);
     onUidIdle(uid, disabled);
 }
 
@@ -0,0 +1,78 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "AllocationCounter.h"
+
+#include <cstdlib>
+#include <new>
+
+namespace android {
+namespace {
+
+struct ThreadState {
+    bool enabled = false;
+    AllocationCounter::Counts counts;
+};
+
+// Trivially constructible, so that operator new can use it on any thread without a TLS guard.
+thread_local constinit ThreadState tThreadState;
+
+} // namespace
+
+void AllocationCounter::setEnabled(bool enabled) {
+    tThreadState.enabled = enabled;
+}
+
+bool AllocationCounter::isEnabled() {
+    return tThreadState.enabled;
+}
+
+AllocationCounter::Counts AllocationCounter::getCounts() {
+    return tThreadState.counts;
+}
+
+void AllocationCounter::recordAllocation(size_t size) {
+    ThreadState& state = tThreadState;
+    if (__builtin_expect(!state.enabled, true)) return;
+
+    state.counts.allocations++;
+    state.counts.bytes += size;
+}
+
+} // namespace android
+
+// The remaining non-aligned forms of operator new, including the array and nothrow ones, call
+// this one in libc++, so they are counted as well.
+void* operator new(size_t size) {
+    android::AllocationCounter::recordAllocation(size);
+
+    if (size == 0) size = 1;
+    void* ptr;
+    while ((ptr = std::malloc(size)) == nullptr) {
+        const std::new_handler handler = std::get_new_handler();
+        if (!handler) std::abort();
+        handler();
+    }
+    return ptr;
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    std::free(ptr);
+}
@@ -0,0 +1,79 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace android {
+
+// AllocationCounter counts the operator new allocations made by a thread. SurfaceFlinger replaces
+// the global operator new with one that checks a thread-local flag, so counting is opt-in per
+// thread and threads that never enable it only pay for that check. Allocations made with malloc
+// directly, e.g. by C libraries, are not counted.
+class AllocationCounter {
+public:
+    struct Counts {
+        uint64_t allocations = 0;
+        uint64_t bytes = 0;
+
+        Counts& operator+=(const Counts& other) {
+            allocations += other.allocations;
+            bytes += other.bytes;
+            return *this;
+        }
+
+        Counts operator-(const Counts& other) const {
+            return {allocations - other.allocations, bytes - other.bytes};
+        }
+
+        bool operator==(const Counts&) const = default;
+    };
+
+    // Enables or disables counting for the calling thread.
+    static void setEnabled(bool enabled);
+    static bool isEnabled();
+
+    // Returns the running totals of the calling thread. The totals only grow while counting is
+    // enabled, so callers take the difference of two calls to attribute allocations to a scope.
+    static Counts getCounts();
+
+    // Called by the operator new replacement.
+    static void recordAllocation(size_t size);
+
+    // Counts the allocations of the calling thread for the lifetime of the scope, then restores
+    // whether counting was enabled before.
+    class Scope {
+    public:
+        Scope() : mWasEnabled(isEnabled()) {
+            setEnabled(true);
+            mStart = getCounts();
+        }
+        ~Scope() { setEnabled(mWasEnabled); }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+        Counts get() const { return getCounts() - mStart; }
+
+    private:
+        const bool mWasEnabled;
+        Counts mStart;
+    };
+};
+
+} // namespace android
@@ -94,9 +94,7 @@ ClientCache::add(const client_cache_t& cacheId, const sp<GraphicBuffer>& buffer)
             }
         }
         auto [itr, success] =
-                mBuffers.emplace(processToken,
-                                 std::make_pair(token,
-                                                std::unordered_map<uint64_t, ClientCacheBuffer>()));
+                mBuffers.emplace(processToken, std::make_pair(token, ProcessBuffers()));
         LOG_ALWAYS_FATAL_IF(!success, "failed to insert new process into client cache");
         it = itr;
     }
@@ -122,6 +120,8 @@ sp<GraphicBuffer> ClientCache::erase(const client_cache_t& cacheId) {
     sp<GraphicBuffer> buffer;
     auto& [processToken, id] = cacheId;
     std::vector<sp<ErasedRecipient>> pendingErase;
+    // Released once mMutex is unlocked, since destroying the texture unmaps it from RenderEngine.
+    std::shared_ptr<renderengine::ExternalTexture> texture;
     {
         std::lock_guard lock(mMutex);
         ClientCacheBuffer* buf = nullptr;
@@ -131,6 +131,7 @@ sp<GraphicBuffer> ClientCache::erase(const client_cache_t& cacheId) {
         }
 
         buffer = buf->buffer->getBuffer();
+        texture = std::move(buf->buffer);
 
         for (auto& recipient : buf->recipients) {
             sp<ErasedRecipient> erasedRecipient = recipient.promote();
@@ -139,7 +140,7 @@ sp<GraphicBuffer> ClientCache::erase(const client_cache_t& cacheId) {
             }
         }
 
-        mBuffers[processToken].second.erase(id);
+        mBuffers.find(processToken)->second.second.erase(id);
     }
 
     for (auto& recipient : pendingErase) {
@@ -188,6 +189,10 @@ void ClientCache::unregisterErasedRecipient(const client_cache_t& cacheId,
 
 void ClientCache::removeProcess(const wp<IBinder>& processToken) {
     std::vector<std::pair<sp<ErasedRecipient>, client_cache_t>> pendingErase;
+    // A dying process may have cached thousands of buffers. Destroy them, and drop the strong
+    // reference to the process, once mMutex is unlocked so that transactions of other processes
+    // do not stall on the eviction.
+    std::pair<sp<IBinder>, ProcessBuffers> process;
     {
         if (processToken == nullptr) {
             ALOGE("failed to remove process, invalid (nullptr) process token");
@@ -209,6 +214,7 @@ void ClientCache::removeProcess(const wp<IBinder>& processToken) {
                 }
             }
         }
+        process = std::move(itr->second);
         mBuffers.erase(itr);
     }
 
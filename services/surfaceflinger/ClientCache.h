@@ -24,11 +24,12 @@
 #include <utils/RefBase.h>
 #include <utils/Singleton.h>
 
-#include <map>
 #include <mutex>
 #include <set>
 #include <unordered_map>
 
+#include "WpHash.h"
+
 // 4096 is based on 64 buffers * 64 layers. Once this limit is reached, the least recently used
 // buffer is uncached before the new buffer is cached.
 #define BUFFER_CACHE_MAX_SIZE 4096
@@ -84,9 +85,10 @@ private:
         std::shared_ptr<renderengine::ExternalTexture> buffer;
         std::set<wp<ErasedRecipient>> recipients;
     };
-    std::map<wp<IBinder> /*caching process*/,
-             std::pair<sp<IBinder> /*strong ref to caching process*/,
-                       std::unordered_map<uint64_t /*cache id*/, ClientCacheBuffer>>>
+    using ProcessBuffers = std::unordered_map<uint64_t /*cache id*/, ClientCacheBuffer>;
+    std::unordered_map<wp<IBinder> /*caching process*/,
+                       std::pair<sp<IBinder> /*strong ref to caching process*/, ProcessBuffers>,
+                       WpHash>
             mBuffers GUARDED_BY(mMutex);
 
     class CacheDeathRecipient : public IBinder::DeathRecipient {
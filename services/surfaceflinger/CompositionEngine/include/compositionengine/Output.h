@@ -274,6 +274,10 @@ public:
     // Make the next call to `present` run asynchronously.
     virtual void offloadPresentNextFrame() = 0;
 
+    // Make the next call to `present` run asynchronously, from composition onwards, so that the
+    // output is composed concurrently with others.
+    virtual void offloadCompositionNextFrame() = 0;
+
     // Enables predicting composition strategy to run client composition earlier
     virtual void setPredictCompositionStrategy(bool) = 0;
 
@@ -19,6 +19,7 @@
 #include <renderengine/ExternalTexture.h>
 #include <ui/Fence.h>
 #include <ui/GraphicTypes.h>
+#include <ui/Region.h>
 #include <ui/Size.h>
 #include <utils/Errors.h>
 #include <utils/StrongPointer.h>
@@ -84,6 +85,15 @@ public:
     virtual std::shared_ptr<renderengine::ExternalTexture> dequeueBuffer(
             base::unique_fd* bufferFence) = 0;
 
+    // Returns the number of frames since the dequeued buffer was last queued,
+    // or 0 if its contents are undefined.
+    virtual int getBufferAge() const = 0;
+
+    // Sets the region of the dequeued buffer which changed since the previous
+    // frame, in buffer coordinates. The damage is reset to the whole buffer
+    // once the buffer is queued.
+    virtual void setBufferDamage(const Region& damage) = 0;
+
     // Queues the drawn buffer for consumption by HWC. readyFence is the fence
     // which will fire when the buffer is ready for consumption.
     virtual void queueBuffer(base::unique_fd readyFence, float hdrSdrRatio) = 0;
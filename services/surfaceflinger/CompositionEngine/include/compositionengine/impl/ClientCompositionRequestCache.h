@@ -18,10 +18,12 @@
 
 #include <cstdint>
 #include <deque>
+#include <optional>
 
 #include <compositionengine/LayerFE.h>
 #include <renderengine/DisplaySettings.h>
 #include <renderengine/LayerSettings.h>
+#include <ui/Region.h>
 
 namespace android {
 
@@ -37,6 +39,10 @@ namespace compositionengine::impl {
 // the composition request. We need to make sure the request, including the order of the
 // layers, do not change from call to call. The snapshot removes strong references to the
 // client buffer id so we don't extend the lifetime of the buffer by storing it in the cache.
+//
+// Along with each request, the cache accumulates what changed on the output since the request
+// was rendered, so that a request which only differs by the content of its layer buffers can be
+// rendered by only redrawing the damaged part of the buffer.
 class ClientCompositionRequestCache {
 public:
     explicit ClientCompositionRequestCache(uint32_t cacheSize) : mMaxCacheSize(cacheSize){};
@@ -47,19 +53,38 @@ public:
              const std::vector<LayerFE::LayerSettings>& layerSettings);
     void remove(uint64_t bufferId);
 
+    // Returns the region of the buffer which needs to be redrawn for its contents to match the
+    // request, in framebuffer space, not including the damage of the current frame. Returns
+    // std::nullopt if the whole buffer needs to be redrawn, which is the case unless both the
+    // buffer and the previously rendered buffer hold the same layers, with the same settings.
+    std::optional<Region> getDamage(uint64_t bufferId, const renderengine::DisplaySettings& display,
+                                    const std::vector<LayerFE::LayerSettings>& layerSettings) const;
+    // Accumulates the output damage of the current frame, in framebuffer space, into every
+    // request which was not rendered this frame.
+    void addDamage(const Region& damage);
+
 private:
     uint32_t mMaxCacheSize;
     struct ClientCompositionRequest {
         renderengine::DisplaySettings display;
         std::vector<LayerFE::LayerSettings> layerSettings;
+        // What changed on the output since the request was rendered.
+        Region damage;
+        bool renderedThisFrame = true;
         ClientCompositionRequest(const renderengine::DisplaySettings& _display,
                                  const std::vector<LayerFE::LayerSettings>& _layerSettings);
         bool equals(const renderengine::DisplaySettings& _display,
                     const std::vector<LayerFE::LayerSettings>& _layerSettings) const;
+        bool equalsIgnoringBuffers(const renderengine::DisplaySettings& _display,
+                                   const std::vector<LayerFE::LayerSettings>& _layerSettings) const;
     };
 
+    const ClientCompositionRequest* get(uint64_t bufferId) const;
+
     // Cache of requests, keyed by corresponding GraphicBuffer ID.
     std::deque<std::pair<uint64_t /* bufferId */, ClientCompositionRequest>> mCache;
+    // Buffer of the request which was added last.
+    uint64_t mLastBufferId = 0;
 };
 
 } // namespace compositionengine::impl
@@ -92,6 +92,18 @@ public:
     //
     uint32_t uncache(uint64_t graphicBufferId);
 
+    //
+    // Counts of lookups that were served from the cache, lookups that had to send the buffer
+    // handle to HWC, and cached buffers that were evicted to make room for a new one. Override
+    // buffers are not counted.
+    //
+    struct Stats {
+        uint32_t hits = 0;
+        uint32_t misses = 0;
+        uint32_t evictions = 0;
+    };
+    const Stats& getStats() const { return mStats; }
+
 private:
     uint32_t cache(const sp<GraphicBuffer>& buffer);
     uint32_t getLeastRecentlyUsedSlot();
@@ -108,6 +120,7 @@ private:
     sp<GraphicBuffer> mLastOverrideBuffer;
     std::stack<uint32_t> mFreeSlots;
     uint64_t mLeastRecentlyUsedCounter;
+    Stats mStats;
 };
 
 } // namespace compositionengine::impl
@@ -83,6 +83,7 @@ public:
     ftl::Future<std::monostate> present(const CompositionRefreshArgs&) override;
     bool supportsOffloadPresent() const override { return false; }
     void offloadPresentNextFrame() override;
+    void offloadCompositionNextFrame() override;
 
     void uncacheBuffers(const std::vector<uint64_t>& bufferIdsToUncache) override;
     void rebuildLayerStacks(const CompositionRefreshArgs&, LayerFESet&) override;
@@ -125,9 +126,19 @@ public:
     virtual void resetCompositionStrategy();
     virtual ftl::Future<std::monostate> presentFrameAndReleaseLayersAsync(
             bool flushEvenWhenDisabled);
+    // Records previousDeviceRequestedChanges as those of the current layer stack.
+    void cacheDeviceRequestedChanges();
+    // Makes the cached changes of the current layer stack, if any, the ones to predict from,
+    // unless previousDeviceRequestedChanges already are. Returns whether they are.
+    bool loadCachedDeviceRequestedChanges();
 
 protected:
     std::unique_ptr<compositionengine::OutputLayer> createOutputLayer(const sp<LayerFE>&) const;
+
+    // The body of present(). Nothing more is sent to the HwcAsyncWorker when it already runs
+    // on that worker.
+    ftl::Future<std::monostate> composeAndPresent(const CompositionRefreshArgs&,
+                                                  bool onHwcWorker);
     std::optional<size_t> findCurrentOutputLayerForLayer(
             const sp<compositionengine::LayerFE>&) const;
     using DeviceRequestedChanges = android::HWComposer::DeviceRequestedChanges;
@@ -166,6 +177,49 @@ protected:
     const std::string& getNamePlusId() const { return mNamePlusId; }
 
 private:
+    // The inputs of the visibility of a layer in the last geometry update, and the coverage of
+    // the output once it was accounted for.
+    struct VisibilityCacheEntry {
+        bool hasSameInputs(bool isIncluded, const LayerFECompositionState*) const;
+        void setInputs(bool isIncluded, const LayerFECompositionState*);
+
+        // Only used to compare against, as the layer may have been destroyed since.
+        const LayerFE* layerFE = nullptr;
+        bool included = false;
+        bool isVisible = false;
+        bool isOpaque = false;
+        bool toInternalDisplay = false;
+        bool isDisplayDecoration = false;
+        ui::Transform geomLayerTransform;
+        FloatRect geomLayerBounds;
+        float shadowLength = 0.f;
+        Region transparentRegionHint;
+
+        Region aboveCoveredLayers;
+        Region aboveOpaqueLayers;
+        std::optional<Region> aboveCoveredLayersExcludingOverlays;
+        bool hasOutputLayer = false;
+    };
+
+    // The visibility of the layers, front to back, as of the last geometry update. The
+    // visibility of a layer only depends on its own state, the state of the output, and on the
+    // coverage of the layers above it.
+    struct VisibilityCache {
+        ui::Transform transform;
+        Rect displayBounds;
+        Rect layerStackContent;
+        bool hasAboveCoveredLayersExcludingOverlays = false;
+        std::vector<VisibilityCacheEntry> layers;
+    };
+
+    // Records the output state the visibility of layers is computed for, and returns whether it
+    // is the one the cache was computed for.
+    bool updateVisibilityCacheOutputState(const compositionengine::Output::CoverageState&);
+    // Restores the coverage and the output layer of a layer from the cache, if neither the layer
+    // nor the output changed since.
+    bool reuseCachedVisibility(const VisibilityCacheEntry&, const sp<LayerFE>&,
+                               compositionengine::Output::CoverageState&);
+
     void dirtyEntireOutput();
     compositionengine::OutputLayer* findLayerRequestingBackgroundComposition() const;
     void finishPrepareFrame();
@@ -186,9 +240,11 @@ private:
     std::unique_ptr<ClientCompositionRequestCache> mClientCompositionRequestCache;
     std::unique_ptr<planner::Planner> mPlanner;
     std::unique_ptr<HwcAsyncWorker> mHwComposerAsyncWorker;
+    VisibilityCache mVisibilityCache;
 
     bool mPredictCompositionStrategy = false;
     bool mOffloadPresent = false;
+    bool mOffloadComposition = false;
 
     // Whether the content must be recomposed this frame.
     bool mMustRecompose = false;
@@ -17,6 +17,8 @@
 #pragma once
 
 #include <cstdint>
+#include <unordered_map>
+#include <vector>
 #include "aidl/android/hardware/graphics/composer3/DimmingStage.h"
 
 #include <math/mat4.h>
@@ -122,6 +124,33 @@ struct OutputCompositionState {
 
     bool previousDeviceRequestedSuccess = false;
 
+    // The outputLayerHash of the layer stack previousDeviceRequestedChanges were requested for.
+    uint64_t previousDeviceRequestedChangesHash = 0;
+
+    // The device requested changes of the most recently composed layer stacks, keyed by
+    // outputLayerHash, most recent first. The composition strategy may be predicted from these
+    // when the output goes back to one of these stacks, in place of the previous frame's.
+    struct CachedDeviceRequestedChanges {
+        using DeviceRequestedChanges = android::HWComposer::DeviceRequestedChanges;
+
+        uint64_t outputLayerHash = 0;
+        // The changes of each layer are keyed by the sequence of its LayerFE, since the
+        // HWC2::Layer they were requested for may be destroyed, and its address reused, while
+        // they are cached.
+        std::unordered_map<int32_t, aidl::android::hardware::graphics::composer3::Composition>
+                changedTypes;
+        DeviceRequestedChanges::DisplayRequests displayRequests;
+        std::unordered_map<int32_t, android::hal::LayerRequest> layerRequests;
+        DeviceRequestedChanges::ClientTargetProperty clientTargetProperty;
+        bool success = false;
+    };
+    static constexpr size_t kMaxCachedDeviceRequestedChanges = 4;
+    std::vector<CachedDeviceRequestedChanges> cachedDeviceRequestedChanges;
+
+    // Lookups of cachedDeviceRequestedChanges, made when the layer stack changed.
+    uint64_t deviceRequestedChangesCacheHits = 0;
+    uint64_t deviceRequestedChangesCacheMisses = 0;
+
     // Optional.
     // The earliest time to send the present command to the HAL
     std::optional<std::chrono::steady_clock::time_point> earliestPresentTime;
@@ -60,6 +60,8 @@ public:
     void prepareFrame(bool usesClientComposition, bool usesDeviceComposition) override;
     std::shared_ptr<renderengine::ExternalTexture> dequeueBuffer(
             base::unique_fd* bufferFence) override;
+    int getBufferAge() const override { return mBufferAge; }
+    void setBufferDamage(const Region& damage) override { mBufferDamage = damage; }
     void queueBuffer(base::unique_fd readyFence, float hdrSdrRatio) override;
     void onPresentDisplayCompleted() override;
     bool supportsCompositionStrategyPrediction() const override;
@@ -73,6 +75,8 @@ public:
     base::unique_fd& mutableBufferReadyForTest();
 
 private:
+    void setSurfaceDamage(uint32_t bufferHeight);
+
     const compositionengine::CompositionEngine& mCompositionEngine;
     const compositionengine::Display& mDisplay;
 
@@ -86,6 +90,8 @@ private:
     ui::Size mSize;
     const size_t mMaxTextureCacheSize;
     bool mProtected{false};
+    int mBufferAge{0};
+    Region mBufferDamage{Region::INVALID_REGION};
 };
 
 std::unique_ptr<compositionengine::RenderSurface> createRenderSurface(
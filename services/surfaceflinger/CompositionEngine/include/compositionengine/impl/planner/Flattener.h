@@ -21,6 +21,7 @@
 #include <compositionengine/impl/planner/LayerState.h>
 
 #include <chrono>
+#include <deque>
 #include <numeric>
 #include <vector>
 
@@ -74,6 +75,8 @@ public:
 
         static const constexpr bool kDefaultEnableHolePunch = true;
 
+        static const constexpr size_t kDefaultMaxKnownLayerStacks = 8;
+
         // Threshold for determing whether a layer is active. A layer whose properties, including
         // the buffer, have not changed in at least this time is considered inactive and is
         // therefore a candidate for flattening.
@@ -85,6 +88,12 @@ public:
 
         // True if the hole punching feature should be enabled.
         const bool mEnableHolePunch;
+
+        // How many of the most recently flattened layer stacks to remember. When the layer stack
+        // changes back to one of them, its layers start out inactive instead of waiting out
+        // mActiveLayerTimeout, so the stack is flattened again within a couple of frames. Layers
+        // that update their buffer are still treated as active. 0 disables this.
+        const size_t mMaxKnownLayerStacks = 0;
     };
 
     // Constants not yet backed by a sysprop
@@ -121,6 +130,10 @@ private:
 
     void resetActivities(NonBufferHash, std::chrono::steady_clock::time_point now);
 
+    // Remembers the current layer stack as one that has been flattened.
+    void rememberCurrentLayerStack();
+    bool isKnownLayerStack(NonBufferHash) const;
+
     NonBufferHash computeLayersHash() const;
 
     bool mergeWithCachedSets(const std::vector<const LayerState*>& layers,
@@ -246,6 +259,10 @@ private:
 
     std::vector<CachedSet> mLayers;
 
+    // Geometry hashes of the layer stacks that were recently flattened, most recent first. Holds
+    // at most mTunables.mMaxKnownLayerStacks entries.
+    std::deque<NonBufferHash> mKnownLayerStacks;
+
     // Statistics
     size_t mUnflattenedDisplayCost = 0;
     size_t mFlattenedDisplayCost = 0;
@@ -253,6 +270,7 @@ private:
     std::unordered_map<size_t, size_t> mFinalLayerCounts;
     size_t mCachedSetCreationCount = 0;
     size_t mCachedSetCreationCost = 0;
+    size_t mKnownLayerStackHits = 0;
     std::unordered_map<size_t, size_t> mInvalidatedCachedSetAges;
 };
 
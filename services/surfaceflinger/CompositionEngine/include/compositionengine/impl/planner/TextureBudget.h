@@ -0,0 +1,60 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <string>
+
+namespace android::compositionengine::impl::planner {
+
+// Limits the memory of the textures allocated by every TexturePool of the process, i.e. the
+// textures of flattened CachedSets and the idle textures kept for them, so that layer caching on
+// several outputs can't add up to more than the limit.
+//
+// The process-wide budget is set with debug.sf.planner_texture_budget_kb, and may be changed at
+// runtime with `dumpsys SurfaceFlinger --planner --texture-budget <kb>`. A limit of 0 means
+// there is no limit.
+class TextureBudget {
+public:
+    explicit TextureBudget(size_t limitBytes = 0) : mLimitBytes(limitBytes) {}
+
+    static TextureBudget& getInstance();
+
+    // Accounts for a new texture of `bytes`. Returns false, accounting for nothing, if the
+    // texture would go over the limit.
+    bool tryReserve(size_t bytes);
+
+    // Accounts for a texture of `bytes` which was freed.
+    void release(size_t bytes);
+
+    // Whether the textures accounted for are over the limit, which happens when the limit is
+    // lowered. Pools don't keep idle textures while this is true.
+    bool isOverLimit() const;
+
+    void setLimit(size_t limitBytes);
+    size_t getLimit() const { return mLimitBytes.load(std::memory_order_relaxed); }
+    size_t getUsage() const { return mUsedBytes.load(std::memory_order_relaxed); }
+
+    void dump(std::string& out) const;
+
+private:
+    std::atomic<size_t> mLimitBytes;
+    std::atomic<size_t> mUsedBytes = 0;
+};
+
+} // namespace android::compositionengine::impl::planner
@@ -19,6 +19,7 @@
 #include <compositionengine/Output.h>
 #include <compositionengine/ProjectionSpace.h>
 #include <compositionengine/impl/planner/LayerState.h>
+#include <compositionengine/impl/planner/TextureBudget.h>
 #include <renderengine/RenderEngine.h>
 
 #include <renderengine/ExternalTexture.h>
@@ -32,7 +33,8 @@ namespace android::compositionengine::impl::planner {
 // memory, it is a simpler implementation to only manage screen-sized textures. The texture pool is
 // unbounded - there are a minimum number of textures preallocated. Under heavy system load, new
 // textures may be allocated, but only a maximum number of retained once those textures are no
-// longer necessary.
+// longer necessary. Every texture is accounted for in a TextureBudget, and no texture is allocated
+// beyond it.
 class TexturePool {
 public:
     // RAII class helping with managing textures from the texture pool
@@ -63,10 +65,11 @@ public:
         sp<Fence> mFence;
     };
 
-    TexturePool(renderengine::RenderEngine& renderEngine)
-          : mRenderEngine(renderEngine), mEnabled(false) {}
+    TexturePool(renderengine::RenderEngine& renderEngine,
+                TextureBudget& budget = TextureBudget::getInstance())
+          : mRenderEngine(renderEngine), mBudget(budget), mEnabled(false) {}
 
-    virtual ~TexturePool() = default;
+    virtual ~TexturePool();
 
     // Sets the display size for the texture pool.
     // This will trigger a reallocation for all remaining textures in the pool.
@@ -74,7 +77,8 @@ public:
     void setDisplaySize(ui::Size size);
 
     // Borrows a new texture from the pool.
-    // If the pool is currently starved of textures, then a new texture is generated.
+    // If the pool is currently starved of textures, then a new texture is generated, unless that
+    // would go over the budget, in which case nullptr is returned.
     // When the AutoTexture object is destroyed, the scratch texture is automatically returned
     // to the pool.
     std::shared_ptr<AutoTexture> borrowTexture();
@@ -102,8 +106,12 @@ private:
     // Returns a previously borrowed texture to the pool.
     void returnTexture(std::shared_ptr<renderengine::ExternalTexture>&& texture,
                        const sp<Fence>& fence);
+    // Drops a texture, giving its memory back to the budget.
+    void freeTexture(std::shared_ptr<renderengine::ExternalTexture>&& texture);
+    void clearPool();
     void allocatePool();
     renderengine::RenderEngine& mRenderEngine;
+    TextureBudget& mBudget;
     ui::Size mSize;
     bool mEnabled;
 };
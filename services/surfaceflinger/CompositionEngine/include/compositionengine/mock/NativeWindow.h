@@ -46,6 +46,7 @@ public:
     MOCK_METHOD1(setBuffersFormat, int(PixelFormat));
     MOCK_METHOD1(setBuffersDataSpace, int(ui::Dataspace));
     MOCK_METHOD1(setUsage, int(uint64_t));
+    MOCK_METHOD2(setSurfaceDamage, int(android_native_rect_t*, size_t));
 };
 
 } // namespace android::compositionengine::mock
@@ -72,6 +72,12 @@ static int forwardPerform(ANativeWindow* window, int operation, ...) {
             result = static_cast<NativeWindow*>(window)->setUsage(usage);
             break;
         }
+        case NATIVE_WINDOW_SET_SURFACE_DAMAGE: {
+            android_native_rect_t* rects = va_arg(args, android_native_rect_t*);
+            size_t numRects = va_arg(args, size_t);
+            result = static_cast<NativeWindow*>(window)->setSurfaceDamage(rects, numRects);
+            break;
+        }
         case NATIVE_WINDOW_API_DISCONNECT: {
             int api = va_arg(args, int);
             result = static_cast<NativeWindow*>(window)->disconnect(api);
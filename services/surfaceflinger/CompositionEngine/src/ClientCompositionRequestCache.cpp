@@ -85,6 +85,27 @@ bool ClientCompositionRequestCache::ClientCompositionRequest::equals(
                        newLayerSettings.end(), layerSettingsAreEqual);
 }
 
+bool ClientCompositionRequestCache::ClientCompositionRequest::equalsIgnoringBuffers(
+        const renderengine::DisplaySettings& newDisplay,
+        const std::vector<LayerFE::LayerSettings>& newLayerSettings) const {
+    return newDisplay == display &&
+            std::equal(layerSettings.begin(), layerSettings.end(), newLayerSettings.begin(),
+                       newLayerSettings.end(),
+                       [](const LayerFE::LayerSettings& lhs, const LayerFE::LayerSettings& rhs) {
+                           return equalIgnoringBuffer(lhs, rhs);
+                       });
+}
+
+const ClientCompositionRequestCache::ClientCompositionRequest* ClientCompositionRequestCache::get(
+        uint64_t bufferId) const {
+    for (const auto& [cachedBufferId, cachedRequest] : mCache) {
+        if (cachedBufferId == bufferId) {
+            return &cachedRequest;
+        }
+    }
+    return nullptr;
+}
+
 bool ClientCompositionRequestCache::exists(
         uint64_t bufferId, const renderengine::DisplaySettings& display,
         const std::vector<LayerFE::LayerSettings>& layerSettings) const {
@@ -100,6 +121,7 @@ void ClientCompositionRequestCache::add(uint64_t bufferId,
                                         const renderengine::DisplaySettings& display,
                                         const std::vector<LayerFE::LayerSettings>& layerSettings) {
     const ClientCompositionRequest request(display, layerSettings);
+    mLastBufferId = bufferId;
     for (auto& [cachedBufferId, cachedRequest] : mCache) {
         if (cachedBufferId == bufferId) {
             cachedRequest = std::move(request);
@@ -123,4 +145,33 @@ void ClientCompositionRequestCache::remove(uint64_t bufferId) {
     }
 }
 
+std::optional<Region> ClientCompositionRequestCache::getDamage(
+        uint64_t bufferId, const renderengine::DisplaySettings& display,
+        const std::vector<LayerFE::LayerSettings>& layerSettings) const {
+    const ClientCompositionRequest* cachedRequest = get(bufferId);
+    if (!cachedRequest || !cachedRequest->equalsIgnoringBuffers(display, layerSettings)) {
+        return std::nullopt;
+    }
+    // The damage is also reported as the change from the previous client target, which is only
+    // covered by the damage of the buffer if both hold the same layers.
+    if (mLastBufferId != bufferId) {
+        const ClientCompositionRequest* lastRequest = get(mLastBufferId);
+        if (!lastRequest || !lastRequest->equalsIgnoringBuffers(display, layerSettings)) {
+            return std::nullopt;
+        }
+    }
+    return cachedRequest->damage;
+}
+
+void ClientCompositionRequestCache::addDamage(const Region& damage) {
+    for (auto& [cachedBufferId, cachedRequest] : mCache) {
+        if (cachedRequest.renderedThisFrame) {
+            cachedRequest.renderedThisFrame = false;
+        } else {
+            // Only the bounds of the damage are redrawn, so keep the region simple.
+            cachedRequest.damage = Region(cachedRequest.damage.orSelf(damage).bounds());
+        }
+    }
+}
+
 } // namespace android::compositionengine::impl
@@ -25,6 +25,8 @@
 
 #include <renderengine/RenderEngine.h>
 
+#include <unordered_set>
+
 // TODO(b/129481165): remove the #pragma below and fix conversion issues
 #pragma clang diagnostic push
 #pragma clang diagnostic ignored "-Wconversion"
@@ -90,7 +92,23 @@ nsecs_t CompositionEngine::getLastFrameRefreshTimestamp() const {
 }
 
 namespace {
-void offloadOutputs(Outputs& outputs) {
+// Outputs may only be composed concurrently if no layer is composed on more than one of them.
+bool haveDisjointLayers(const Outputs& outputs) {
+    std::unordered_set<const LayerFE*> layers;
+    for (const auto& output : outputs) {
+        if (!output->getState().isEnabled) {
+            continue;
+        }
+        for (size_t i = 0; i < output->getOutputLayerCount(); i++) {
+            if (!layers.insert(&output->getOutputLayerOrderedByZByIndex(i)->getLayerFE()).second) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void offloadOutputs(Outputs& outputs, bool canComposeInParallel) {
     if (!FlagManager::getInstance().multithreaded_present() || outputs.size() < 2) {
         return;
     }
@@ -121,8 +139,16 @@ void offloadOutputs(Outputs& outputs) {
     // allow it to run concurrently without an extra thread hop.
     outputsToOffload.pop_back();
 
+    // Beyond presenting, the outputs may also be composed on their HWC threads, while the
+    // remaining outputs are composed on the main thread. Each display's HWC calls still happen
+    // in order on a single thread.
+    const bool offloadComposition = canComposeInParallel && haveDisjointLayers(outputs);
     for (compositionengine::Output* output : outputsToOffload) {
-        output->offloadPresentNextFrame();
+        if (offloadComposition) {
+            output->offloadCompositionNextFrame();
+        } else {
+            output->offloadPresentNextFrame();
+        }
     }
 }
 } // namespace
@@ -147,13 +173,20 @@ void CompositionEngine::present(CompositionRefreshArgs& args) {
     // Offloading the HWC call for `present` allows us to simultaneously call it
     // on multiple displays. This is desirable because these calls block and can
     // be slow.
-    offloadOutputs(args.outputs);
+    // Composing on several threads relies on RenderEngine serializing its work.
+    offloadOutputs(args.outputs,
+                   FlagManager::getInstance().parallel_output_composition() &&
+                           getRenderEngine().isThreaded());
 
     ui::DisplayVector<ftl::Future<std::monostate>> presentFutures;
     for (const auto& output : args.outputs) {
         presentFutures.push_back(output->present(args));
     }
 
+    // The main thread can't move on to the next commit while the last
+    // output is presented on its HWC thread. The snapshots are owned by the LayerFEs until
+    // SurfaceFlinger moves them back after this returns, and onCompositionPresented needs this
+    // frame's present fences for the frame targeters and the scheduler.
     {
         SFTRACE_NAME("Waiting on HWC");
         for (auto& future : presentFutures) {
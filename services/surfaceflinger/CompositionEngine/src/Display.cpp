@@ -94,6 +94,7 @@ void Display::disconnect() {
     if (const auto id = HalDisplayId::tryCast(mId)) {
         getCompositionEngine().getHwComposer().disconnectDisplay(*id);
     }
+    getCompositionEngine().getRenderEngine().onDisplayRemoved(getNamePlusId());
 }
 
 void Display::setColorTransform(const compositionengine::CompositionRefreshArgs& args) {
@@ -32,8 +32,10 @@ HwcSlotAndBuffer HwcBufferCache::getHwcSlotAndBuffer(const sp<GraphicBuffer>& bu
         Cache& cache = i->second;
         // mark this cache slot as more recently used so it won't get evicted anytime soon
         cache.lruCounter = mLeastRecentlyUsedCounter++;
+        mStats.hits++;
         return {cache.slot, nullptr};
     }
+    mStats.misses++;
     return {cache(buffer), buffer};
 }
 
@@ -81,6 +83,7 @@ uint32_t HwcBufferCache::getLeastRecentlyUsedSlot() {
         uint32_t slot = cacheToErase->second.slot;
         mCacheByBufferId.erase(cacheToErase);
         mFreeSlots.push(slot);
+        mStats.evictions++;
     }
     uint32_t slot = mFreeSlots.top();
     mFreeSlots.pop();
@@ -36,8 +36,10 @@
 #include <scheduler/FrameTargeter.h>
 #include <scheduler/Time.h>
 
+#include <algorithm>
 #include <optional>
 #include <thread>
+#include <unordered_set>
 
 #include "renderengine/ExternalTexture.h"
 
@@ -98,6 +100,17 @@ ScaleVector getScale(const Rect& from, const Rect& to) {
             .y = static_cast<float>(to.height()) / from.height()};
 }
 
+Region toFramebufferSpace(const OutputCompositionState& state, const Region& region) {
+    return state.layerStackSpace.getTransform(state.framebufferSpace).transform(region);
+}
+
+// Blurs sample what is drawn below them, so they can't be redrawn in part of the buffer only.
+bool hasBlur(const std::vector<LayerFE::LayerSettings>& layers) {
+    return std::any_of(layers.begin(), layers.end(), [](const auto& layer) {
+        return layer.backgroundBlurRadius > 0 || !layer.blurRegions.empty();
+    });
+}
+
 } // namespace
 
 std::shared_ptr<Output> createOutput(
@@ -433,6 +446,21 @@ void Output::prepare(const compositionengine::CompositionRefreshArgs& refreshArg
 
 ftl::Future<std::monostate> Output::present(
         const compositionengine::CompositionRefreshArgs& refreshArgs) {
+    if (mOffloadComposition) {
+        // As with mOffloadPresent, only offload for this frame. The caller waits on the future
+        // before refreshArgs goes away.
+        mOffloadComposition = false;
+        return ftl::Future<bool>(mHwComposerAsyncWorker->send([this, &refreshArgs]() {
+                   composeAndPresent(refreshArgs, /*onHwcWorker=*/true);
+                   return true;
+               }))
+                .then([](bool) { return std::monostate{}; });
+    }
+    return composeAndPresent(refreshArgs, /*onHwcWorker=*/false);
+}
+
+ftl::Future<std::monostate> Output::composeAndPresent(
+        const compositionengine::CompositionRefreshArgs& refreshArgs, bool onHwcWorker) {
     const auto stringifyExpectedPresentTime = [this, &refreshArgs]() -> std::string {
         return ftl::Optional(getDisplayId())
                 .and_then(PhysicalDisplayId::tryCast)
@@ -469,7 +497,12 @@ ftl::Future<std::monostate> Output::present(
         setHintSessionRequiresRenderEngine(false);
     }
     GpuCompositionResult result;
-    const bool predictCompositionStrategy = canPredictCompositionStrategy(refreshArgs);
+    if (FlagManager::getInstance().composition_strategy_cache()) {
+        loadCachedDeviceRequestedChanges();
+    }
+    // The prediction runs on the HwcAsyncWorker, so can't be waited on from there.
+    const bool predictCompositionStrategy =
+            canPredictCompositionStrategy(refreshArgs) && !onHwcWorker;
     if (predictCompositionStrategy) {
         result = prepareFrameAsync();
     } else {
@@ -480,7 +513,7 @@ ftl::Future<std::monostate> Output::present(
     finishFrame(std::move(result));
     ftl::Future<std::monostate> future;
     const bool flushEvenWhenDisabled = !refreshArgs.bufferIdsToUncache.empty();
-    if (mOffloadPresent) {
+    if (mOffloadPresent && !onHwcWorker) {
         future = presentFrameAndReleaseLayersAsync(flushEvenWhenDisabled);
 
         // Only offload for this frame. The next frame will determine whether it
@@ -501,6 +534,11 @@ void Output::offloadPresentNextFrame() {
     updateHwcAsyncWorker();
 }
 
+void Output::offloadCompositionNextFrame() {
+    mOffloadComposition = true;
+    updateHwcAsyncWorker();
+}
+
 void Output::uncacheBuffers(std::vector<uint64_t> const& bufferIdsToUncache) {
     if (bufferIdsToUncache.empty()) {
         return;
@@ -539,20 +577,144 @@ void Output::rebuildLayerStacks(const compositionengine::CompositionRefreshArgs&
 
 void Output::collectVisibleLayers(const compositionengine::CompositionRefreshArgs& refreshArgs,
                                   compositionengine::Output::CoverageState& coverage) {
+    const bool cacheVisibility = FlagManager::getInstance().cache_layer_visibility();
+    if (!cacheVisibility) {
+        mVisibilityCache.layers.clear();
+    }
+    // Layers above the topmost layer whose visibility inputs changed are covered by the same
+    // layers as in the last geometry update, so their visibility is unchanged.
+    bool reuseVisibility = cacheVisibility && updateVisibilityCacheOutputState(coverage);
+    size_t index = 0;
+
     // Evaluate the layers from front to back to determine what is visible. This
     // also incrementally calculates the coverage information for each layer as
     // well as the entire output.
     for (auto layer : reversed(refreshArgs.layers)) {
-        // Incrementally process the coverage for each layer
-        ensureOutputLayerIfVisible(layer, coverage);
+        reuseVisibility = reuseVisibility && index < mVisibilityCache.layers.size() &&
+                reuseCachedVisibility(mVisibilityCache.layers[index], layer, coverage);
+        if (!reuseVisibility) {
+            // Incrementally process the coverage for each layer
+            ensureOutputLayerIfVisible(layer, coverage);
+        }
+
+        if (cacheVisibility && !reuseVisibility) {
+            if (index == mVisibilityCache.layers.size()) {
+                mVisibilityCache.layers.emplace_back();
+            }
+            auto& entry = mVisibilityCache.layers[index];
+            const auto* layerFEState = layer->getCompositionState();
+            entry.layerFE = layer.get();
+            entry.setInputs(layerFEState && includesLayer(layerFEState->outputFilter),
+                            layerFEState);
+            entry.aboveCoveredLayers = coverage.aboveCoveredLayers;
+            entry.aboveOpaqueLayers = coverage.aboveOpaqueLayers;
+            entry.aboveCoveredLayersExcludingOverlays =
+                    coverage.aboveCoveredLayersExcludingOverlays;
+        }
+        index++;
 
         // TODO(b/121291683): Stop early if the output is completely covered and
         // no more layers could even be visible underneath the ones on top.
     }
+    if (cacheVisibility) {
+        mVisibilityCache.layers.resize(index);
+    }
 
     setReleasedLayers(refreshArgs);
 
     finalizePendingOutputLayers();
+
+    if (cacheVisibility) {
+        std::unordered_set<const LayerFE*> layersWithOutputLayer;
+        for (auto* outputLayer : getOutputLayersOrderedByZ()) {
+            layersWithOutputLayer.insert(&outputLayer->getLayerFE());
+        }
+        for (auto& entry : mVisibilityCache.layers) {
+            entry.hasOutputLayer = layersWithOutputLayer.count(entry.layerFE) > 0;
+        }
+    }
+}
+
+bool Output::VisibilityCacheEntry::hasSameInputs(
+        bool isIncluded, const LayerFECompositionState* layerFEState) const {
+    if (isIncluded != included) {
+        return false;
+    }
+    if (!included) {
+        return true;
+    }
+    // A dirty layer adds all of its visible region to the dirty region of the output.
+    return !layerFEState->contentDirty && layerFEState->isVisible == isVisible &&
+            layerFEState->isOpaque == isOpaque &&
+            layerFEState->outputFilter.toInternalDisplay == toInternalDisplay &&
+            (layerFEState->compositionType == Composition::DISPLAY_DECORATION) ==
+            isDisplayDecoration &&
+            layerFEState->geomLayerTransform == geomLayerTransform &&
+            layerFEState->geomLayerBounds == geomLayerBounds &&
+            layerFEState->shadowSettings.length == shadowLength &&
+            layerFEState->transparentRegionHint.hasSameRects(transparentRegionHint);
+}
+
+void Output::VisibilityCacheEntry::setInputs(bool isIncluded,
+                                             const LayerFECompositionState* layerFEState) {
+    included = isIncluded;
+    if (!included) {
+        return;
+    }
+    isVisible = layerFEState->isVisible;
+    isOpaque = layerFEState->isOpaque;
+    toInternalDisplay = layerFEState->outputFilter.toInternalDisplay;
+    isDisplayDecoration = layerFEState->compositionType == Composition::DISPLAY_DECORATION;
+    geomLayerTransform = layerFEState->geomLayerTransform;
+    geomLayerBounds = layerFEState->geomLayerBounds;
+    shadowLength = layerFEState->shadowSettings.length;
+    transparentRegionHint = layerFEState->transparentRegionHint;
+}
+
+bool Output::updateVisibilityCacheOutputState(
+        const compositionengine::Output::CoverageState& coverage) {
+    const auto& outputState = getState();
+    auto& cache = mVisibilityCache;
+    const Rect displayBounds = outputState.displaySpace.getBoundsAsRect();
+    const Rect layerStackContent = outputState.layerStackSpace.getContent();
+    const bool hasAboveCoveredLayersExcludingOverlays =
+            coverage.aboveCoveredLayersExcludingOverlays.has_value();
+    const bool unchanged = cache.transform == outputState.transform &&
+            cache.displayBounds == displayBounds && cache.layerStackContent == layerStackContent &&
+            cache.hasAboveCoveredLayersExcludingOverlays == hasAboveCoveredLayersExcludingOverlays;
+
+    cache.transform = outputState.transform;
+    cache.displayBounds = displayBounds;
+    cache.layerStackContent = layerStackContent;
+    cache.hasAboveCoveredLayersExcludingOverlays = hasAboveCoveredLayersExcludingOverlays;
+    return unchanged;
+}
+
+bool Output::reuseCachedVisibility(const VisibilityCacheEntry& entry,
+                                   const sp<compositionengine::LayerFE>& layerFE,
+                                   compositionengine::Output::CoverageState& coverage) {
+    if (entry.layerFE != layerFE.get()) {
+        return false;
+    }
+    const auto* layerFEState = layerFE->getCompositionState();
+    if (!entry.hasSameInputs(layerFEState && includesLayer(layerFEState->outputFilter),
+                             layerFEState)) {
+        return false;
+    }
+    // The output layer holds the rest of the visibility of the layer.
+    const auto outputLayerIndex = findCurrentOutputLayerForLayer(layerFE);
+    if (outputLayerIndex.has_value() != entry.hasOutputLayer) {
+        return false;
+    }
+
+    coverage.latchedLayers.insert(layerFE);
+    coverage.aboveCoveredLayers = entry.aboveCoveredLayers;
+    coverage.aboveOpaqueLayers = entry.aboveOpaqueLayers;
+    coverage.aboveCoveredLayersExcludingOverlays = entry.aboveCoveredLayersExcludingOverlays;
+    if (outputLayerIndex) {
+        ensureOutputLayer(outputLayerIndex, layerFE);
+    }
+    return true;
 }
 
 void Output::ensureOutputLayerIfVisible(sp<compositionengine::LayerFE>& layerFE,
@@ -1108,6 +1270,8 @@ void Output::prepareFrame() {
     outputState.strategyPrediction = CompositionStrategyPredictionState::DISABLED;
     outputState.previousDeviceRequestedChanges = changes;
     outputState.previousDeviceRequestedSuccess = success;
+    outputState.previousDeviceRequestedChangesHash = outputState.outputLayerHash;
+    cacheDeviceRequestedChanges();
     if (success) {
         applyCompositionStrategy(changes);
     }
@@ -1172,9 +1336,117 @@ GpuCompositionResult Output::prepareFrameAsync() {
     }
     state.previousDeviceRequestedChanges = std::move(changes);
     state.previousDeviceRequestedSuccess = chooseCompositionSuccess;
+    state.previousDeviceRequestedChangesHash = state.outputLayerHash;
+    cacheDeviceRequestedChanges();
     return compositionResult;
 }
 
+void Output::cacheDeviceRequestedChanges() {
+    if (!FlagManager::getInstance().composition_strategy_cache()) {
+        return;
+    }
+
+    auto& state = editState();
+    auto& cache = state.cachedDeviceRequestedChanges;
+    const auto it = std::find_if(cache.begin(), cache.end(), [&](const auto& entry) {
+        return entry.outputLayerHash == state.outputLayerHash;
+    });
+    if (it != cache.end()) {
+        cache.erase(it);
+    }
+
+    const auto& changes = state.previousDeviceRequestedChanges;
+    if (!changes) {
+        return;
+    }
+
+    const auto layers = getOutputLayersOrderedByZ();
+    const auto getSequence = [&layers](const HWC2::Layer* hwcLayer) -> std::optional<int32_t> {
+        const auto layer =
+                std::find_if(layers.begin(), layers.end(), [hwcLayer](auto* outputLayer) {
+                    return outputLayer->getHwcLayer() == hwcLayer;
+                });
+        if (layer == layers.end()) return std::nullopt;
+        return (*layer)->getLayerFE().getSequence();
+    };
+
+    OutputCompositionState::CachedDeviceRequestedChanges entry{
+            .outputLayerHash = state.outputLayerHash,
+            .displayRequests = changes->displayRequests,
+            .clientTargetProperty = changes->clientTargetProperty,
+            .success = state.previousDeviceRequestedSuccess,
+    };
+    for (const auto& [hwcLayer, type] : changes->changedTypes) {
+        const auto sequence = getSequence(hwcLayer);
+        if (!sequence) return;
+        entry.changedTypes.emplace(*sequence, type);
+    }
+    for (const auto& [hwcLayer, request] : changes->layerRequests) {
+        const auto sequence = getSequence(hwcLayer);
+        if (!sequence) return;
+        entry.layerRequests.emplace(*sequence, request);
+    }
+
+    if (cache.size() == OutputCompositionState::kMaxCachedDeviceRequestedChanges) {
+        cache.pop_back();
+    }
+    cache.insert(cache.begin(), std::move(entry));
+}
+
+bool Output::loadCachedDeviceRequestedChanges() {
+    auto& state = editState();
+    if (state.previousDeviceRequestedChanges &&
+        state.previousDeviceRequestedChangesHash == state.outputLayerHash) {
+        return true;
+    }
+
+    const auto& cache = state.cachedDeviceRequestedChanges;
+    const auto it = std::find_if(cache.begin(), cache.end(), [&](const auto& entry) {
+        return entry.outputLayerHash == state.outputLayerHash;
+    });
+    if (it == cache.end()) {
+        state.deviceRequestedChangesCacheMisses++;
+        return false;
+    }
+
+    // Apply the changes to the HWC layers the output layers have now.
+    const auto layers = getOutputLayersOrderedByZ();
+    const auto getHwcLayer = [&layers](int32_t sequence) -> HWC2::Layer* {
+        const auto layer =
+                std::find_if(layers.begin(), layers.end(), [sequence](auto* outputLayer) {
+                    return outputLayer->getLayerFE().getSequence() == sequence;
+                });
+        return layer == layers.end() ? nullptr : (*layer)->getHwcLayer();
+    };
+
+    android::HWComposer::DeviceRequestedChanges changes{
+            .displayRequests = it->displayRequests,
+            .clientTargetProperty = it->clientTargetProperty,
+    };
+    for (const auto& [sequence, type] : it->changedTypes) {
+        auto* hwcLayer = getHwcLayer(sequence);
+        if (!hwcLayer) {
+            state.deviceRequestedChangesCacheMisses++;
+            return false;
+        }
+        changes.changedTypes.emplace(hwcLayer, type);
+    }
+    for (const auto& [sequence, request] : it->layerRequests) {
+        auto* hwcLayer = getHwcLayer(sequence);
+        if (!hwcLayer) {
+            state.deviceRequestedChangesCacheMisses++;
+            return false;
+        }
+        changes.layerRequests.emplace(hwcLayer, request);
+    }
+
+    state.deviceRequestedChangesCacheHits++;
+    state.previousDeviceRequestedChanges = std::move(changes);
+    state.previousDeviceRequestedSuccess = it->success;
+    state.previousDeviceRequestedChangesHash = state.outputLayerHash;
+    return true;
+}
+
 void Output::devOptRepaintFlash(const compositionengine::CompositionRefreshArgs& refreshArgs) {
     if (CC_LIKELY(!refreshArgs.devOptFlashDirtyRegionsDelay)) {
         return;
@@ -1326,7 +1598,14 @@ std::optional<base::unique_fd> Output::composeSurfaces(
     OutputCompositionState& outputCompositionState = editState();
     // Check if the client composition requests were rendered into the provided graphic buffer. If
     // so, we can reuse the buffer and avoid client composition.
+    std::optional<Region> damage;
     if (mClientCompositionRequestCache) {
+        const bool partialCompositionEnabled =
+                FlagManager::getInstance().partial_client_composition();
+        if (partialCompositionEnabled) {
+            // This may be the second composition of the frame, which redraws everything.
+            mRenderSurface->setBufferDamage(Region::INVALID_REGION);
+        }
         if (mClientCompositionRequestCache->exists(tex->getBuffer()->getId(),
                                                    clientCompositionDisplay,
                                                    clientCompositionLayers)) {
@@ -1337,10 +1616,30 @@ std::optional<base::unique_fd> Output::composeSurfaces(
             return base::unique_fd(std::move(fd));
         }
         SFTRACE_NAME("ClientCompositionCacheMiss");
+        // If the buffer still holds the same layers, only the part of it which changed since it
+        // was rendered needs to be redrawn.
+        if (partialCompositionEnabled && mRenderSurface->getBufferAge() > 0 &&
+            !hasBlur(clientCompositionLayers)) {
+            damage = mClientCompositionRequestCache->getDamage(tex->getBuffer()->getId(),
+                                                               clientCompositionDisplay,
+                                                               clientCompositionLayers);
+        }
         mClientCompositionRequestCache->add(tex->getBuffer()->getId(), clientCompositionDisplay,
                                             clientCompositionLayers);
     }
 
+    if (damage) {
+        SFTRACE_NAME("PartialClientComposition");
+        Rect bounds = damage->orSelf(toFramebufferSpace(outputState, getDirtyRegion())).bounds();
+        if (!bounds.isEmpty()) {
+            // Scaled layers are filtered, which may reach a pixel beyond their damage.
+            bounds = Rect(bounds.left - 1, bounds.top - 1, bounds.right + 1, bounds.bottom + 1);
+            bounds.intersect(clientCompositionDisplay.physicalDisplay, &bounds);
+        }
+        clientCompositionDisplay.damage = bounds;
+        mRenderSurface->setBufferDamage(Region(bounds));
+    }
+
     // We boost GPU frequency here because there will be color spaces conversion
     // or complex GPU shaders and it's expensive. We boost the GPU frequency so that
     // GPU composition can finish in time. We must reset GPU frequency afterwards,
@@ -1596,6 +1895,10 @@ void Output::presentFrameAndReleaseLayers(bool flushEvenWhenDisabled) {
     }
 
     auto& outputState = editState();
+    if (mClientCompositionRequestCache && FlagManager::getInstance().partial_client_composition()) {
+        mClientCompositionRequestCache->addDamage(toFramebufferSpace(outputState,
+                                                                     getDirtyRegion()));
+    }
     outputState.dirtyRegion.clear();
 
     auto frame = presentFrame();
@@ -1690,7 +1993,7 @@ void Output::setPredictCompositionStrategy(bool predict) {
 }
 
 void Output::updateHwcAsyncWorker() {
-    if (mPredictCompositionStrategy || mOffloadPresent) {
+    if (mPredictCompositionStrategy || mOffloadPresent || mOffloadComposition) {
         if (!mHwComposerAsyncWorker) {
             mHwComposerAsyncWorker = std::make_unique<HwcAsyncWorker>();
         }
@@ -1713,6 +2016,12 @@ bool Output::canPredictCompositionStrategy(const CompositionRefreshArgs& refresh
         return false;
     }
 
+    bool sameOutputLayers = lastOutputLayerHash == outputLayerHash;
+    if (!sameOutputLayers && FlagManager::getInstance().composition_strategy_cache()) {
+        // loadCachedDeviceRequestedChanges may have restored the changes of this layer stack.
+        sameOutputLayers = getState().previousDeviceRequestedChangesHash == outputLayerHash;
+    }
+
     if (!getState().previousDeviceRequestedChanges) {
         ALOGV("canPredictCompositionStrategy previous changes not available");
         return false;
@@ -1728,7 +2037,7 @@ bool Output::canPredictCompositionStrategy(const CompositionRefreshArgs& refresh
         return false;
     }
 
-    if (lastOutputLayerHash != outputLayerHash) {
+    if (!sameOutputLayers) {
         ALOGV("canPredictCompositionStrategy output layers changed");
         return false;
     }
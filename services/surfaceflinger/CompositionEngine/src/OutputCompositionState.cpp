@@ -64,6 +64,9 @@ void OutputCompositionState::dump(std::string& out) const {
     out.append("\n   ");
     dumpVal(out, "compositionStrategyPredictionState", ftl::enum_string(strategyPrediction));
     out.append("\n   ");
+    dumpVal(out, "deviceRequestedChangesCacheHits", deviceRequestedChangesCacheHits);
+    dumpVal(out, "deviceRequestedChangesCacheMisses", deviceRequestedChangesCacheMisses);
+    out.append("\n   ");
 
     out.append("\n   ");
     dumpVal(out, "treat170mAsSrgb", treat170mAsSrgb);
@@ -18,6 +18,7 @@
 
 #include <android-base/stringprintf.h>
 #include <android/native_window.h>
+#include <common/FlagManager.h>
 #include <common/trace.h>
 #include <compositionengine/CompositionEngine.h>
 #include <compositionengine/Display.h>
@@ -195,6 +196,13 @@ std::shared_ptr<renderengine::ExternalTexture> RenderSurface::dequeueBuffer(
 
     *bufferFence = base::unique_fd(fd);
 
+    mBufferAge = 0;
+    if (FlagManager::getInstance().partial_client_composition() &&
+        mNativeWindow->query(mNativeWindow.get(), NATIVE_WINDOW_BUFFER_AGE, &mBufferAge) !=
+                NO_ERROR) {
+        mBufferAge = 0;
+    }
+
     return mTexture;
 }
 
@@ -220,6 +228,9 @@ void RenderSurface::queueBuffer(base::unique_fd readyFence, float hdrSdrRatio) {
         if (mTexture == nullptr) {
             ALOGE("No buffer is ready for display [%s]", mDisplay.getName().c_str());
         } else {
+            if (!mBufferDamage.isRect() || mBufferDamage.getBounds() != Rect::INVALID_RECT) {
+                setSurfaceDamage(mTexture->getBuffer()->getHeight());
+            }
             status_t result = mNativeWindow->queueBuffer(mNativeWindow.get(),
                                                          mTexture->getBuffer()->getNativeBuffer(),
                                                          dup(readyFence));
@@ -240,6 +251,7 @@ void RenderSurface::queueBuffer(base::unique_fd readyFence, float hdrSdrRatio) {
             mTexture = nullptr;
         }
     }
+    mBufferDamage = Region::INVALID_REGION;
 
     status_t result = mDisplaySurface->advanceFrame(hdrSdrRatio);
     if (result != NO_ERROR) {
@@ -247,6 +259,17 @@ void RenderSurface::queueBuffer(base::unique_fd readyFence, float hdrSdrRatio) {
     }
 }
 
+void RenderSurface::setSurfaceDamage(uint32_t bufferHeight) {
+    // The native window takes the damage with a bottom-left origin.
+    std::vector<android_native_rect_t> rects;
+    rects.reserve(static_cast<size_t>(mBufferDamage.end() - mBufferDamage.begin()));
+    const int32_t height = static_cast<int32_t>(bufferHeight);
+    for (const Rect& rect : mBufferDamage) {
+        rects.push_back({rect.left, height - rect.top, rect.right, height - rect.bottom});
+    }
+    native_window_set_surface_damage(mNativeWindow.get(), rects.data(), rects.size());
+}
+
 void RenderSurface::onPresentDisplayCompleted() {
     mDisplaySurface->onFrameCommitted();
 }
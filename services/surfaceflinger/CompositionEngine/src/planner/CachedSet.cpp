@@ -263,6 +263,10 @@ void CachedSet::render(renderengine::RenderEngine& renderEngine, TexturePool& te
     }
 
     auto texture = texturePool.borrowTexture();
+    if (!texture) {
+        // Out of texture budget, so leave the layers to be composed on their own.
+        return;
+    }
     LOG_ALWAYS_FATAL_IF(texture->get()->getBuffer()->initCheck() != OK);
 
     base::unique_fd bufferFence;
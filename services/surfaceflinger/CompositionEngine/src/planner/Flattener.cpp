@@ -25,6 +25,8 @@
 #include <compositionengine/impl/planner/Flattener.h>
 #include <compositionengine/impl/planner/LayerState.h>
 
+#include <algorithm>
+
 using time_point = std::chrono::steady_clock::time_point;
 using namespace std::chrono_literals;
 
@@ -199,6 +201,8 @@ void Flattener::dump(std::string& result) const {
     base::StringAppendF(&result, "\n    Cached sets created: %zd\n", mCachedSetCreationCount);
     base::StringAppendF(&result, "    Cost: %.2f\n",
                         static_cast<float>(mCachedSetCreationCost) / displayArea);
+    base::StringAppendF(&result, "    Known layer stacks: %zu, returned to: %zu\n",
+                        mKnownLayerStacks.size(), mKnownLayerStackHits);
 
     const auto lastUpdate =
             std::chrono::duration_cast<std::chrono::milliseconds>(now - mLastGeometryUpdate);
@@ -258,6 +262,25 @@ void Flattener::resetActivities(NonBufferHash hash, time_point now) {
     }
 }
 
+void Flattener::rememberCurrentLayerStack() {
+    if (mTunables.mMaxKnownLayerStacks == 0) {
+        return;
+    }
+    if (const auto it = std::find(mKnownLayerStacks.begin(), mKnownLayerStacks.end(),
+                                  mCurrentGeometry);
+        it != mKnownLayerStacks.end()) {
+        mKnownLayerStacks.erase(it);
+    } else if (mKnownLayerStacks.size() == mTunables.mMaxKnownLayerStacks) {
+        mKnownLayerStacks.pop_back();
+    }
+    mKnownLayerStacks.push_front(mCurrentGeometry);
+}
+
+bool Flattener::isKnownLayerStack(NonBufferHash hash) const {
+    return std::find(mKnownLayerStacks.begin(), mKnownLayerStacks.end(), hash) !=
+            mKnownLayerStacks.end();
+}
+
 NonBufferHash Flattener::computeLayersHash() const{
     size_t hash = 0;
     for (const auto& layer : mLayers) {
@@ -274,9 +297,16 @@ bool Flattener::mergeWithCachedSets(const std::vector<const LayerState*>& layers
     std::vector<CachedSet> merged;
 
     if (mLayers.empty()) {
+        // Layers of a stack that has been flattened before start out inactive. Those that are
+        // still updating are marked active again on the next frame, like any other layer.
+        auto lastUpdate = now;
+        if (isKnownLayerStack(mCurrentGeometry)) {
+            ++mKnownLayerStackHits;
+            lastUpdate -= mTunables.mActiveLayerTimeout + std::chrono::nanoseconds(1);
+        }
         merged.reserve(layers.size());
         for (const LayerState* layer : layers) {
-            merged.emplace_back(layer, now);
+            merged.emplace_back(layer, lastUpdate);
             mFlattenedDisplayCost += merged.back().getDisplayCost();
         }
         mLayers = std::move(merged);
@@ -349,6 +379,7 @@ bool Flattener::mergeWithCachedSets(const std::vector<const LayerState*>& layers
                 priorBlurLayer = mNewCachedSet->getBlurLayer();
                 merged.emplace_back(std::move(*mNewCachedSet));
                 mNewCachedSet = std::nullopt;
+                rememberCurrentLayerStack();
                 continue;
             }
         }
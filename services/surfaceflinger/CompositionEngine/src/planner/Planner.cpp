@@ -25,6 +25,7 @@
 #include <compositionengine/LayerFECompositionState.h>
 #include <compositionengine/impl/OutputLayerCompositionState.h>
 #include <compositionengine/impl/planner/Planner.h>
+#include <compositionengine/impl/planner/TextureBudget.h>
 
 #include <chrono>
 
@@ -61,10 +62,14 @@ Flattener::Tunables buildFlattenerTuneables() {
     const auto enableHolePunch =
             base::GetBoolProperty(std::string("debug.sf.enable_hole_punch_pip"),
                                   Flattener::Tunables::kDefaultEnableHolePunch);
+    const auto maxKnownLayerStacks =
+            base::GetUintProperty<size_t>(std::string("debug.sf.layer_caching_max_known_stacks"),
+                                          Flattener::Tunables::kDefaultMaxKnownLayerStacks);
     return Flattener::Tunables{
             .mActiveLayerTimeout = activeLayerTimeout,
             .mRenderScheduling = buildRenderSchedulingTunables(),
             .mEnableHolePunch = enableHolePunch,
+            .mMaxKnownLayerStacks = maxKnownLayerStacks,
     };
 }
 
@@ -276,6 +281,26 @@ void Planner::dump(const Vector<String16>& args, std::string& result) {
             }
         } else if (command == "--help" || command == "-h") {
             dumpUsage(result);
+        } else if (command == "--texture-budget" || command == "-t") {
+            if (args.size() != 3) {
+                base::StringAppendF(&result,
+                                    "Expected a budget in KiB, e.g. '--planner %s <kb>'\n",
+                                    command.c_str());
+                return;
+            }
+
+            const String8 budgetString(args[2]);
+            size_t budgetKb = 0;
+            const int fieldsRead = sscanf(budgetString.c_str(), "%zu", &budgetKb);
+            if (fieldsRead != 1) {
+                base::StringAppendF(&result, "Failed to parse %s as a size_t\n",
+                                    budgetString.c_str());
+                return;
+            }
+
+            // The budget is shared by the planners of all outputs.
+            TextureBudget::getInstance().setLimit(budgetKb * 1024);
+            TextureBudget::getInstance().dump(result);
         } else if (command == "--similar" || command == "-s") {
             if (args.size() < 3) {
                 base::StringAppendF(&result, "Expected a plan string, e.g. '--planner %s <plan>'\n",
@@ -341,6 +366,10 @@ void Planner::dumpUsage(std::string& result) const {
 
     result.append("[--layers|-l]\n");
     result.append("  Prints the current layers\n");
+
+    result.append("[--texture-budget|-t] <kb>\n");
+    result.append("  Limits the memory of flattened layer textures across all displays, or removes"
+                  " the limit if <kb> is 0\n");
 }
 
 } // namespace android::compositionengine::impl::planner
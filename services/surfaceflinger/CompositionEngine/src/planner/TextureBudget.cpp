@@ -0,0 +1,68 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// #define LOG_NDEBUG 0
+
+#undef LOG_TAG
+#define LOG_TAG "Planner"
+
+#include <android-base/properties.h>
+#include <android-base/stringprintf.h>
+#include <compositionengine/impl/planner/TextureBudget.h>
+
+namespace android::compositionengine::impl::planner {
+
+TextureBudget& TextureBudget::getInstance() {
+    static TextureBudget sInstance(
+            base::GetUintProperty<size_t>(std::string("debug.sf.planner_texture_budget_kb"), 0) *
+            1024);
+    return sInstance;
+}
+
+bool TextureBudget::tryReserve(size_t bytes) {
+    size_t used = mUsedBytes.load(std::memory_order_relaxed);
+    do {
+        const size_t limit = getLimit();
+        if (limit != 0 && used + bytes > limit) {
+            return false;
+        }
+    } while (!mUsedBytes.compare_exchange_weak(used, used + bytes, std::memory_order_relaxed));
+    return true;
+}
+
+void TextureBudget::release(size_t bytes) {
+    mUsedBytes.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+bool TextureBudget::isOverLimit() const {
+    const size_t limit = getLimit();
+    return limit != 0 && getUsage() > limit;
+}
+
+void TextureBudget::setLimit(size_t limitBytes) {
+    mLimitBytes.store(limitBytes, std::memory_order_relaxed);
+}
+
+void TextureBudget::dump(std::string& out) const {
+    if (getLimit() == 0) {
+        base::StringAppendF(&out, "TextureBudget: %zu KiB used, no limit\n", getUsage() / 1024);
+    } else {
+        base::StringAppendF(&out, "TextureBudget: %zu KiB used of %zu KiB\n", getUsage() / 1024,
+                            getLimit() / 1024);
+    }
+}
+
+} // namespace android::compositionengine::impl::planner
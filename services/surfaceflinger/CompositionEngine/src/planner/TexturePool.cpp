@@ -25,13 +25,37 @@
 
 namespace android::compositionengine::impl::planner {
 
+namespace {
+
+// Textures are all RGBA_8888.
+size_t getTextureBytes(uint32_t width, uint32_t height) {
+    return static_cast<size_t>(width) * height * 4;
+}
+
+} // namespace
+
+TexturePool::~TexturePool() {
+    clearPool();
+}
+
+void TexturePool::clearPool() {
+    while (!mPool.empty()) {
+        freeTexture(std::move(mPool.front().texture));
+        mPool.pop_front();
+    }
+}
+
 void TexturePool::allocatePool() {
-    mPool.clear();
+    clearPool();
     if (mEnabled && mSize.isValid()) {
-        mPool.resize(kMinPoolSize);
-        std::generate_n(mPool.begin(), kMinPoolSize, [&]() {
-            return Entry{genTexture(), nullptr};
-        });
+        for (size_t i = 0; i < kMinPoolSize; i++) {
+            auto texture = genTexture();
+            if (!texture) {
+                ALOGD("Preallocated %zu textures for Planner's pool - budget reached", i);
+                break;
+            }
+            mPool.push_back({std::move(texture), nullptr});
+        }
     }
 }
 
@@ -45,7 +69,12 @@ void TexturePool::setDisplaySize(ui::Size size) {
 
 std::shared_ptr<TexturePool::AutoTexture> TexturePool::borrowTexture() {
     if (mPool.empty()) {
-        return std::make_shared<AutoTexture>(*this, genTexture(), nullptr);
+        auto texture = genTexture();
+        if (!texture) {
+            ALOGV("Not allocating texture for Planner's pool - budget reached");
+            return nullptr;
+        }
+        return std::make_shared<AutoTexture>(*this, std::move(texture), nullptr);
     }
 
     const auto entry = mPool.front();
@@ -57,6 +86,7 @@ void TexturePool::returnTexture(std::shared_ptr<renderengine::ExternalTexture>&&
                                 const sp<Fence>& fence) {
     // Drop the texture on the floor if the pool is not enabled
     if (!mEnabled) {
+        freeTexture(std::move(texture));
         return;
     }
 
@@ -67,6 +97,7 @@ void TexturePool::returnTexture(std::shared_ptr<renderengine::ExternalTexture>&&
               "current: (%dx%d))",
               texture->getBuffer()->getWidth(), texture->getBuffer()->getHeight(), mSize.getWidth(),
               mSize.getHeight());
+        freeTexture(std::move(texture));
         return;
     }
 
@@ -74,6 +105,14 @@ void TexturePool::returnTexture(std::shared_ptr<renderengine::ExternalTexture>&&
     if (mPool.size() == kMaxPoolSize) {
         ALOGD("Deallocating texture from Planner's pool - max size [%" PRIu64 "] reached",
               static_cast<uint64_t>(kMaxPoolSize));
+        freeTexture(std::move(texture));
+        return;
+    }
+
+    // Nor keep idle textures once the budget has been lowered below what is in use.
+    if (mBudget.isOverLimit()) {
+        ALOGD("Deallocating texture from Planner's pool - over budget");
+        freeTexture(std::move(texture));
         return;
     }
 
@@ -82,6 +121,10 @@ void TexturePool::returnTexture(std::shared_ptr<renderengine::ExternalTexture>&&
 
 std::shared_ptr<renderengine::ExternalTexture> TexturePool::genTexture() {
     LOG_ALWAYS_FATAL_IF(!mSize.isValid(), "Attempted to generate texture with invalid size");
+    if (!mBudget.tryReserve(getTextureBytes(static_cast<uint32_t>(mSize.getWidth()),
+                                            static_cast<uint32_t>(mSize.getHeight())))) {
+        return nullptr;
+    }
     return std::make_shared<
             renderengine::impl::
                     ExternalTexture>(sp<GraphicBuffer>::
@@ -98,6 +141,12 @@ std::shared_ptr<renderengine::ExternalTexture> TexturePool::genTexture() {
                                              renderengine::impl::ExternalTexture::Usage::WRITEABLE);
 }
 
+void TexturePool::freeTexture(std::shared_ptr<renderengine::ExternalTexture>&& texture) {
+    mBudget.release(getTextureBytes(texture->getBuffer()->getWidth(),
+                                    texture->getBuffer()->getHeight()));
+    texture.reset();
+}
+
 void TexturePool::setEnabled(bool enabled) {
     mEnabled = enabled;
     allocatePool();
@@ -107,6 +156,7 @@ void TexturePool::dump(std::string& out) const {
     base::StringAppendF(&out,
                         "TexturePool (%s) has %zu buffers of size [%" PRId32 ", %" PRId32 "]\n",
                         mEnabled ? "enabled" : "disabled", mPool.size(), mSize.width, mSize.height);
+    mBudget.dump(out);
 }
 
 } // namespace android::compositionengine::impl::planner
\ No newline at end of file
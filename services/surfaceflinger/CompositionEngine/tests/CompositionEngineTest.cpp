@@ -341,6 +341,26 @@ TEST_F(CompositionEngineOffloadTest, basic) {
     mEngine.present(mRefreshArgs);
 }
 
+TEST_F(CompositionEngineOffloadTest, compositionNeedsThreadedRenderEngine) {
+    // The mock RenderEngine isn't threaded, so only present is offloaded.
+    renderengine::mock::RenderEngine renderEngine;
+    mEngine.setRenderEngine(&renderEngine);
+
+    EXPECT_CALL(*mDisplay1, supportsOffloadPresent).WillOnce(Return(true));
+    EXPECT_CALL(*mDisplay2, supportsOffloadPresent).WillOnce(Return(true));
+
+    EXPECT_CALL(*mDisplay1, offloadPresentNextFrame).Times(1);
+    EXPECT_CALL(*mDisplay1, offloadCompositionNextFrame).Times(0);
+    EXPECT_CALL(*mDisplay2, offloadPresentNextFrame).Times(0);
+    EXPECT_CALL(*mDisplay2, offloadCompositionNextFrame).Times(0);
+
+    SET_FLAG_FOR_TEST(flags::multithreaded_present, true);
+    SET_FLAG_FOR_TEST(flags::parallel_output_composition, true);
+    setOutputs({mDisplay1, mDisplay2});
+
+    mEngine.present(mRefreshArgs);
+}
+
 TEST_F(CompositionEngineOffloadTest, dependsOnSupport) {
     EXPECT_CALL(*mDisplay1, supportsOffloadPresent).WillOnce(Return(false));
     EXPECT_CALL(*mDisplay2, supportsOffloadPresent).Times(0);
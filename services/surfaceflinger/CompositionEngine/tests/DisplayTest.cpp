@@ -349,12 +349,15 @@ TEST_F(DisplaySetConfigurationTest, configuresGpuVirtualDisplay) {
 using DisplayDisconnectTest = PartialMockDisplayTestCommon;
 
 TEST_F(DisplayDisconnectTest, disconnectsDisplay) {
-    // The first call to disconnect will disconnect the display with the HWC.
+    // The first call to disconnect will disconnect the display with the HWC, and drop what
+    // RenderEngine keeps for it.
     EXPECT_CALL(mHwComposer, disconnectDisplay(HalDisplayId(DEFAULT_DISPLAY_ID))).Times(1);
+    EXPECT_CALL(mRenderEngine, onDisplayRemoved(mDisplay->getNamePlusId())).Times(1);
     mDisplay->disconnect();
 
     // Subsequent calls will do nothing,
     EXPECT_CALL(mHwComposer, disconnectDisplay(HalDisplayId(DEFAULT_DISPLAY_ID))).Times(0);
+    EXPECT_CALL(mRenderEngine, onDisplayRemoved(_)).Times(0);
     mDisplay->disconnect();
 }
 
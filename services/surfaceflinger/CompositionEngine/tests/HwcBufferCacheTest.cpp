@@ -85,6 +85,25 @@ TEST_F(HwcBufferCacheTest, getHwcSlotAndBuffer_whenSlotsFull_evictsOldestCachedB
     EXPECT_EQ(cache.uncache(graphicBuffers[0]->getId()), UINT32_MAX);
 }
 
+TEST_F(HwcBufferCacheTest, getStats_countsHitsMissesAndEvictions) {
+    HwcBufferCache cache;
+
+    cache.getHwcSlotAndBuffer(mBuffer1);
+    cache.getHwcSlotAndBuffer(mBuffer1);
+    cache.getHwcSlotAndBuffer(mBuffer2);
+    cache.getOverrideHwcSlotAndBuffer(mBuffer1);
+    EXPECT_EQ(cache.getStats().hits, 1u);
+    EXPECT_EQ(cache.getStats().misses, 2u);
+    EXPECT_EQ(cache.getStats().evictions, 0u);
+
+    for (size_t i = 0; i < HwcBufferCache::kOverrideBufferSlot; ++i) {
+        cache.getHwcSlotAndBuffer(
+                sp<GraphicBuffer>::make(1u, 1u, HAL_PIXEL_FORMAT_RGBA_8888, 1u, 0u));
+    }
+    EXPECT_EQ(cache.getStats().misses, 2u + HwcBufferCache::kOverrideBufferSlot);
+    EXPECT_EQ(cache.getStats().evictions, 2u);
+}
+
 TEST_F(HwcBufferCacheTest, uncache_whenCached_returnsSlotNumber) {
     HwcBufferCache cache;
     sp<GraphicBuffer> outBuffer;
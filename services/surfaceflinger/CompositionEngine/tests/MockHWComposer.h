@@ -60,7 +60,7 @@ public:
                  Fps, std::optional<android::HWComposer::DeviceRequestedChanges>*));
     MOCK_METHOD(status_t, setClientTarget,
                 (HalDisplayId, uint32_t, const sp<Fence>&, const sp<GraphicBuffer>&, ui::Dataspace,
-                 float),
+                 float, const Region&),
                 (override));
     MOCK_METHOD2(presentAndGetReleaseFences,
                  status_t(HalDisplayId, std::optional<std::chrono::steady_clock::time_point>));
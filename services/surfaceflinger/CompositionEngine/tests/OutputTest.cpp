@@ -56,6 +56,7 @@ using testing::DoAll;
 using testing::ElementsAre;
 using testing::ElementsAreArray;
 using testing::Eq;
+using testing::Field;
 using testing::InSequence;
 using testing::Invoke;
 using testing::IsEmpty;
@@ -998,6 +999,80 @@ TEST_F(OutputPrepareFrameTest, delegatesToChooseCompositionStrategyAndRenderSurf
     EXPECT_EQ(mOutput.getState().strategyPrediction, CompositionStrategyPredictionState::DISABLED);
 }
 
+TEST_F(OutputPrepareFrameTest, cachesDeviceRequestedChangesPerLayerStack) {
+    SET_FLAG_FOR_TEST(flags::composition_strategy_cache, true);
+    mOutput.editState().isEnabled = true;
+
+    EXPECT_CALL(mOutput, resetCompositionStrategy()).Times(2);
+    EXPECT_CALL(mOutput, getOutputLayerCount()).WillRepeatedly(Return(0u));
+    EXPECT_CALL(*mRenderSurface, prepareFrame(_, _)).Times(2);
+
+    auto changes = std::make_optional<android::HWComposer::DeviceRequestedChanges>({});
+    changes->displayRequests = static_cast<hal::DisplayRequest>(1);
+    mOutput.editState().outputLayerHash = 1;
+    EXPECT_CALL(mOutput, chooseCompositionStrategy(_))
+            .WillOnce(DoAll(SetArgPointee<0>(changes), Return(false)));
+    mOutput.prepareFrame();
+
+    mOutput.editState().outputLayerHash = 2;
+    EXPECT_CALL(mOutput, chooseCompositionStrategy(_)).WillOnce(Return(false));
+    mOutput.prepareFrame();
+    EXPECT_FALSE(mOutput.getState().previousDeviceRequestedChanges);
+
+    // Going back to the first layer stack predicts from its changes.
+    mOutput.editState().outputLayerHash = 1;
+    EXPECT_TRUE(mOutput.loadCachedDeviceRequestedChanges());
+    EXPECT_EQ(changes, mOutput.getState().previousDeviceRequestedChanges);
+
+    mOutput.editState().outputLayerHash = 3;
+    EXPECT_FALSE(mOutput.loadCachedDeviceRequestedChanges());
+    EXPECT_EQ(1u, mOutput.getState().deviceRequestedChangesCacheHits);
+    EXPECT_EQ(1u, mOutput.getState().deviceRequestedChangesCacheMisses);
+}
+
+TEST_F(OutputPrepareFrameTest, cachedDeviceRequestedChangesFollowLayerSequence) {
+    SET_FLAG_FOR_TEST(flags::composition_strategy_cache, true);
+    mOutput.editState().isEnabled = true;
+
+    StrictMock<mock::OutputLayer> outputLayer;
+    sp<StrictMock<mock::LayerFE>> layerFE = sp<StrictMock<mock::LayerFE>>::make();
+    StrictMock<HWC2::mock::Layer> hwcLayer;
+    StrictMock<HWC2::mock::Layer> recreatedHwcLayer;
+    EXPECT_CALL(outputLayer, getLayerFE()).WillRepeatedly(ReturnRef(*layerFE));
+    EXPECT_CALL(*layerFE, getSequence()).WillRepeatedly(Return(42));
+    EXPECT_CALL(mOutput, getOutputLayerCount()).WillRepeatedly(Return(1u));
+    EXPECT_CALL(mOutput, getOutputLayerOrderedByZByIndex(0)).WillRepeatedly(Return(&outputLayer));
+
+    EXPECT_CALL(mOutput, resetCompositionStrategy());
+    EXPECT_CALL(*mRenderSurface, prepareFrame(_, _));
+    EXPECT_CALL(outputLayer, getHwcLayer()).WillRepeatedly(Return(&hwcLayer));
+    auto changes = std::make_optional<android::HWComposer::DeviceRequestedChanges>({});
+    changes->changedTypes[&hwcLayer] =
+            aidl::android::hardware::graphics::composer3::Composition::CLIENT;
+    changes->layerRequests[&hwcLayer] = hal::LayerRequest::CLEAR_CLIENT_TARGET;
+    mOutput.editState().outputLayerHash = 1;
+    EXPECT_CALL(mOutput, chooseCompositionStrategy(_))
+            .WillOnce(DoAll(SetArgPointee<0>(changes), Return(false)));
+    mOutput.prepareFrame();
+
+    // The layer got a new HWC layer since, which the cached changes are applied to.
+    EXPECT_CALL(outputLayer, getHwcLayer()).WillRepeatedly(Return(&recreatedHwcLayer));
+    mOutput.editState().previousDeviceRequestedChanges.reset();
+    EXPECT_TRUE(mOutput.loadCachedDeviceRequestedChanges());
+    const auto& loaded = mOutput.getState().previousDeviceRequestedChanges;
+    ASSERT_TRUE(loaded);
+    EXPECT_EQ(1u, loaded->changedTypes.count(&recreatedHwcLayer));
+    EXPECT_EQ(0u, loaded->changedTypes.count(&hwcLayer));
+    EXPECT_EQ(1u, loaded->layerRequests.count(&recreatedHwcLayer));
+
+    // Changes of a layer which is no longer on the output aren't applied to another one.
+    EXPECT_CALL(*layerFE, getSequence()).WillRepeatedly(Return(43));
+    mOutput.editState().previousDeviceRequestedChanges.reset();
+    EXPECT_FALSE(mOutput.loadCachedDeviceRequestedChanges());
+    EXPECT_EQ(1u, mOutput.getState().deviceRequestedChangesCacheHits);
+    EXPECT_EQ(1u, mOutput.getState().deviceRequestedChangesCacheMisses);
+}
+
 // Note: Use OutputTest and not OutputPrepareFrameTest, so the real
 // base chooseCompositionStrategy() is invoked.
 TEST_F(OutputTest, prepareFrameSetsClientCompositionOnlyByDefault) {
@@ -1413,6 +1488,51 @@ TEST_F(OutputCollectVisibleLayersTest, processesCandidateLayersReversedAndSetsOu
     mOutput.collectVisibleLayers(mRefreshArgs, mCoverageState);
 }
 
+TEST_F(OutputCollectVisibleLayersTest, reusesVisibilityOfLayersAboveTopmostChangedLayer) {
+    SET_FLAG_FOR_TEST(flags::cache_layer_visibility, true);
+
+    const ui::LayerStack layerStack{123u};
+    mOutput.mState.layerFilter = {layerStack, false};
+    for (auto* layer : {&mLayer1, &mLayer2, &mLayer3}) {
+        layer->layerFEState.outputFilter = {layerStack, false};
+        EXPECT_CALL(*layer->layerFE, getCompositionState())
+                .WillRepeatedly(Return(&layer->layerFEState));
+        EXPECT_CALL(layer->outputLayer, getLayerFE()).WillRepeatedly(ReturnRef(*layer->layerFE));
+    }
+    auto coverRect = [](const Rect& rect) {
+        return Invoke([rect](sp<LayerFE>&, Output::CoverageState& coverage) {
+            coverage.aboveOpaqueLayers.orSelf(rect);
+        });
+    };
+
+    EXPECT_CALL(mOutput, ensureOutputLayerIfVisible(Eq(mLayer3.layerFE), _))
+            .WillOnce(coverRect(Rect(0, 0, 10, 10)));
+    EXPECT_CALL(mOutput, ensureOutputLayerIfVisible(Eq(mLayer2.layerFE), _))
+            .WillOnce(coverRect(Rect(10, 0, 20, 10)));
+    EXPECT_CALL(mOutput, ensureOutputLayerIfVisible(Eq(mLayer1.layerFE), _))
+            .WillOnce(coverRect(Rect(20, 0, 30, 10)));
+    EXPECT_CALL(mOutput, setReleasedLayers(Ref(mRefreshArgs))).Times(2);
+    EXPECT_CALL(mOutput, finalizePendingOutputLayers()).Times(2);
+
+    mOutput.collectVisibleLayers(mRefreshArgs, mCoverageState);
+
+    // Moving the middle layer only recomputes it and the layer below it, starting from the
+    // coverage of the top layer.
+    mLayer2.layerFEState.geomLayerBounds = FloatRect{0, 0, 20, 20};
+    EXPECT_CALL(mOutput, ensureOutputLayer(Eq(2u), Eq(mLayer3.layerFE)))
+            .WillOnce(Return(&mLayer3.outputLayer));
+    EXPECT_CALL(mOutput, ensureOutputLayerIfVisible(Eq(mLayer2.layerFE), _))
+            .WillOnce(Invoke([](sp<LayerFE>&, Output::CoverageState& coverage) {
+                EXPECT_EQ(Rect(0, 0, 10, 10), coverage.aboveOpaqueLayers.getBounds());
+            }));
+    EXPECT_CALL(mOutput, ensureOutputLayerIfVisible(Eq(mLayer1.layerFE), _));
+
+    LayerFESet geomSnapshots;
+    Output::CoverageState coverage{geomSnapshots};
+    mOutput.collectVisibleLayers(mRefreshArgs, coverage);
+    EXPECT_EQ(1u, geomSnapshots.count(mLayer3.layerFE));
+}
+
 /*
  * Output::ensureOutputLayerIfVisible()
  */
@@ -2073,6 +2193,28 @@ TEST_F(OutputPresentTest, predictingCompositionStrategyInvokesPrepareFrameAsync)
     mOutput.present(args);
 }
 
+TEST_F(OutputPresentTest, offloadedCompositionDoesNotPredictCompositionStrategy) {
+    CompositionRefreshArgs args;
+
+    InSequence seq;
+    EXPECT_CALL(mOutput, updateColorProfile(Ref(args)));
+    EXPECT_CALL(mOutput, updateCompositionState(Ref(args)));
+    EXPECT_CALL(mOutput, planComposition());
+    EXPECT_CALL(mOutput, writeCompositionState(Ref(args)));
+    EXPECT_CALL(mOutput, setColorTransform(Ref(args)));
+    EXPECT_CALL(mOutput, beginFrame());
+    EXPECT_CALL(mOutput, setHintSessionRequiresRenderEngine(false));
+    EXPECT_CALL(mOutput, canPredictCompositionStrategy(Ref(args))).WillOnce(Return(true));
+    EXPECT_CALL(mOutput, prepareFrame());
+    EXPECT_CALL(mOutput, devOptRepaintFlash(Ref(args)));
+    EXPECT_CALL(mOutput, finishFrame(_));
+    EXPECT_CALL(mOutput, presentFrameAndReleaseLayers(false));
+    EXPECT_CALL(mOutput, renderCachedSets(Ref(args)));
+
+    mOutput.offloadCompositionNextFrame();
+    mOutput.present(args).get();
+}
+
 /*
  * Output::updateColorProfile()
  */
@@ -3949,6 +4091,57 @@ TEST_F(OutputComposeSurfacesTest, clientCompositionIfRequestChanges) {
     EXPECT_FALSE(mOutput.mState.reusedClientComposition);
 }
 
+TEST_F(OutputComposeSurfacesTest, partialClientCompositionIfOnlyLayerBuffersChange) {
+    SET_FLAG_FOR_TEST(flags::partial_client_composition, true);
+    const Rect kOutputBounds{0, 0, 100, 100};
+    mOutput.mState.layerStackSpace.setBounds(kOutputBounds.getSize());
+    mOutput.mState.layerStackSpace.setContent(kOutputBounds);
+    mOutput.mState.framebufferSpace.setBounds(kOutputBounds.getSize());
+    mOutput.mState.framebufferSpace.setContent(kOutputBounds);
+    mOutput.mState.displaySpace.setContent(kOutputBounds);
+
+    LayerFE::LayerSettings r1;
+    r1.geometry.boundaries = FloatRect{1, 2, 3, 4};
+    r1.bufferId = 1;
+    r1.frameNumber = 1;
+    LayerFE::LayerSettings r1Next = r1;
+    r1Next.bufferId = 2;
+    r1Next.frameNumber = 2;
+
+    EXPECT_CALL(mOutput, getSkipColorTransform()).WillRepeatedly(Return(false));
+    EXPECT_CALL(*mDisplayColorProfile, hasWideColorGamut()).WillRepeatedly(Return(true));
+    EXPECT_CALL(mRenderEngine, supportsProtectedContent()).WillRepeatedly(Return(false));
+    EXPECT_CALL(mRenderEngine, isProtected()).WillRepeatedly(Return(false));
+    EXPECT_CALL(mOutput, generateClientCompositionRequests(_, kDefaultOutputDataspace, _))
+            .WillOnce(Return(std::vector<LayerFE::LayerSettings>{r1}))
+            .WillOnce(Return(std::vector<LayerFE::LayerSettings>{r1Next}));
+    EXPECT_CALL(mOutput, appendRegionFlashRequests(RegionEq(kDebugRegion), _))
+            .WillRepeatedly(Return());
+    EXPECT_CALL(*mRenderSurface, dequeueBuffer(_)).WillRepeatedly(Return(mOutputBuffer));
+    EXPECT_CALL(*mRenderSurface, getBufferAge()).WillRepeatedly(Return(1));
+    EXPECT_CALL(mOutput, setHintSessionRequiresRenderEngine(_)).WillRepeatedly(Return());
+
+    // Nothing was rendered into the buffer yet, so all of it is redrawn.
+    EXPECT_CALL(*mRenderSurface, setBufferDamage(RegionEq(Region::INVALID_REGION)));
+    EXPECT_CALL(mRenderEngine,
+                drawLayers(Field(&renderengine::DisplaySettings::damage, Rect::INVALID_RECT),
+                           ElementsAre(r1), _, _))
+            .WillOnce(Return(ByMove(ftl::yield<FenceResult>(Fence::NO_FENCE))));
+    verify().execute().expectAFenceWasReturned();
+
+    // Only the dirty part of the output, and the pixel around it, is redrawn.
+    mOutput.mState.dirtyRegion = Region(Rect(10, 10, 20, 20));
+    const Rect kDamage{9, 9, 21, 21};
+    EXPECT_CALL(*mRenderSurface, setBufferDamage(RegionEq(Region::INVALID_REGION)));
+    EXPECT_CALL(*mRenderSurface, setBufferDamage(RegionEq(Region(kDamage))));
+    EXPECT_CALL(mRenderEngine,
+                drawLayers(Field(&renderengine::DisplaySettings::damage, kDamage),
+                           ElementsAre(r1Next), _, _))
+            .WillOnce(Return(ByMove(ftl::yield<FenceResult>(Fence::NO_FENCE))));
+    verify().execute().expectAFenceWasReturned();
+    EXPECT_FALSE(mOutput.mState.reusedClientComposition);
+}
+
 struct OutputComposeSurfacesTest_UsesExpectedDisplaySettings : public OutputComposeSurfacesTest {
     OutputComposeSurfacesTest_UsesExpectedDisplaySettings() {
         EXPECT_CALL(mRenderEngine, supportsProtectedContent()).WillRepeatedly(Return(false));
@@ -17,6 +17,8 @@
 #include <cstdarg>
 #include <cstdint>
 
+#include <com_android_graphics_surfaceflinger_flags.h>
+#include <common/test/FlagUtils.h>
 #include <compositionengine/RenderSurfaceCreationArgs.h>
 #include <compositionengine/impl/OutputCompositionState.h>
 #include <compositionengine/impl/RenderSurface.h>
@@ -42,12 +44,15 @@ const std::string DEFAULT_DISPLAY_NAME = "Mock Display";
 using testing::_;
 using testing::ByMove;
 using testing::DoAll;
+using testing::Invoke;
 using testing::Ref;
 using testing::Return;
 using testing::ReturnRef;
 using testing::SetArgPointee;
 using testing::StrictMock;
 
+using namespace com::android::graphics::surfaceflinger;
+
 class RenderSurfaceTest : public testing::Test {
 public:
     RenderSurfaceTest() {
@@ -246,6 +251,22 @@ TEST_F(RenderSurfaceTest, dequeueBufferObtainsABuffer) {
     EXPECT_EQ(buffer.get(), mSurface.mutableTextureForTest()->getBuffer().get());
 }
 
+TEST_F(RenderSurfaceTest, dequeueBufferQueriesBufferAge) {
+    SET_FLAG_FOR_TEST(flags::partial_client_composition, true);
+    sp<GraphicBuffer> buffer = sp<GraphicBuffer>::make();
+
+    EXPECT_CALL(*mNativeWindow, dequeueBuffer(_, _))
+            .WillOnce(
+                    DoAll(SetArgPointee<0>(buffer.get()), SetArgPointee<1>(-1), Return(NO_ERROR)));
+    EXPECT_CALL(*mNativeWindow, query(NATIVE_WINDOW_BUFFER_AGE, _))
+            .WillOnce(DoAll(SetArgPointee<1>(2), Return(NO_ERROR)));
+
+    base::unique_fd fence;
+    mSurface.dequeueBuffer(&fence);
+
+    EXPECT_EQ(2, mSurface.getBufferAge());
+}
+
 /*
  * RenderSurface::queueBuffer()
  */
@@ -290,6 +311,39 @@ TEST_F(RenderSurfaceTest, queueBufferHandlesClientComposition) {
     EXPECT_EQ(nullptr, mSurface.mutableTextureForTest().get());
 }
 
+TEST_F(RenderSurfaceTest, queueBufferSetsBufferDamage) {
+    const auto buffer = std::make_shared<renderengine::impl::ExternalTexture>(
+            sp<GraphicBuffer>::make(1u, 100u, PIXEL_FORMAT_RGBA_8888, 1u,
+                                    GRALLOC_USAGE_HW_RENDER | GRALLOC_USAGE_HW_TEXTURE,
+                                    "RenderSurfaceTest"),
+            mRenderEngine, false);
+    mSurface.mutableTextureForTest() = buffer;
+
+    impl::OutputCompositionState state;
+    state.usesClientComposition = true;
+
+    EXPECT_CALL(mDisplay, getState()).WillRepeatedly(ReturnRef(state));
+    // The damage is passed with a bottom-left origin.
+    EXPECT_CALL(*mNativeWindow, setSurfaceDamage(_, 1u))
+            .WillOnce(Invoke([](android_native_rect_t* rects, size_t) {
+                EXPECT_EQ(0, rects[0].left);
+                EXPECT_EQ(90, rects[0].top);
+                EXPECT_EQ(1, rects[0].right);
+                EXPECT_EQ(70, rects[0].bottom);
+                return NO_ERROR;
+            }));
+    EXPECT_CALL(*mNativeWindow, queueBuffer(buffer->getBuffer()->getNativeBuffer(), -1))
+            .WillRepeatedly(Return(NO_ERROR));
+    EXPECT_CALL(*mDisplaySurface, advanceFrame(0.5f)).Times(2);
+
+    mSurface.setBufferDamage(Region(Rect(0, 10, 1, 30)));
+    mSurface.queueBuffer(base::unique_fd(), 0.5f);
+
+    // The damage only applies to one frame.
+    mSurface.mutableTextureForTest() = buffer;
+    mSurface.queueBuffer(base::unique_fd(), 0.5f);
+}
+
 TEST_F(RenderSurfaceTest, queueBufferHandlesFlipClientTargetRequest) {
     const auto buffer =
             std::make_shared<renderengine::impl::ExternalTexture>(sp<GraphicBuffer>::make(),
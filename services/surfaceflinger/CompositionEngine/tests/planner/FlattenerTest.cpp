@@ -1140,6 +1140,83 @@ TEST_F(FlattenerRenderSchedulingTest, flattenLayers_renderCachedSets_defersUpToM
                                  true);
 }
 
+class FlattenerKnownLayerStacksTest : public FlattenerTest {
+public:
+    FlattenerKnownLayerStacksTest()
+          : FlattenerTest(Flattener::Tunables{
+                    .mActiveLayerTimeout = 100ms,
+                    .mRenderScheduling = std::nullopt,
+                    .mEnableHolePunch = true,
+                    .mMaxKnownLayerStacks = 2,
+            }) {}
+};
+
+TEST_F(FlattenerKnownLayerStacksTest, flattenLayers_knownLayerStackIsFlattenedWithoutTimeout) {
+    auto& layerState1 = mTestLayers[0]->layerState;
+    auto& layerState2 = mTestLayers[1]->layerState;
+    auto& layerState3 = mTestLayers[2]->layerState;
+
+    const std::vector<const LayerState*> layers = {
+            layerState1.get(),
+            layerState2.get(),
+            layerState3.get(),
+    };
+    const std::vector<const LayerState*> otherLayers = {
+            layerState1.get(),
+            layerState2.get(),
+    };
+
+    initializeFlattener(layers);
+
+    // make all layers inactive
+    mTime += 200ms;
+    expectAllLayersFlattened(layers);
+
+    // Switch to another layer stack and back, without letting any time pass.
+    initializeOverrideBuffer(otherLayers);
+    EXPECT_EQ(getNonBufferHash(otherLayers),
+              mFlattener->flattenLayers(otherLayers, getNonBufferHash(otherLayers), mTime));
+    initializeFlattener(layers);
+
+    // The layer stack was flattened before, so it is flattened again right away.
+    expectAllLayersFlattened(layers);
+}
+
+TEST_F(FlattenerTest, flattenLayers_knownLayerStacksDisabled) {
+    auto& layerState1 = mTestLayers[0]->layerState;
+    auto& layerState2 = mTestLayers[1]->layerState;
+    auto& layerState3 = mTestLayers[2]->layerState;
+
+    const std::vector<const LayerState*> layers = {
+            layerState1.get(),
+            layerState2.get(),
+            layerState3.get(),
+    };
+    const std::vector<const LayerState*> otherLayers = {
+            layerState1.get(),
+            layerState2.get(),
+    };
+
+    initializeFlattener(layers);
+
+    // make all layers inactive
+    mTime += 200ms;
+    expectAllLayersFlattened(layers);
+
+    initializeOverrideBuffer(otherLayers);
+    EXPECT_EQ(getNonBufferHash(otherLayers),
+              mFlattener->flattenLayers(otherLayers, getNonBufferHash(otherLayers), mTime));
+    initializeFlattener(layers);
+
+    // Without known layer stacks, the layers are active again after the layer stack changed.
+    EXPECT_CALL(mRenderEngine, drawLayers(_, _, _, _)).Times(0);
+    initializeOverrideBuffer(layers);
+    EXPECT_EQ(getNonBufferHash(layers),
+              mFlattener->flattenLayers(layers, getNonBufferHash(layers), mTime));
+    mFlattener->renderCachedSets(mOutputState, std::nullopt, true);
+    EXPECT_EQ(nullptr, layerState1->getOutputLayer()->getState().overrideInfo.buffer);
+}
+
 TEST_F(FlattenerTest, flattenLayers_skipsLayersDisabledFromCaching) {
     auto& layerState1 = mTestLayers[0]->layerState;
     const auto& overrideBuffer1 = layerState1->getOutputLayer()->getState().overrideInfo.buffer;
@@ -30,7 +30,8 @@ const ui::Size kDisplaySizeTwo(2, 2);
 
 class TestableTexturePool : public TexturePool {
 public:
-    TestableTexturePool(renderengine::RenderEngine& renderEngine) : TexturePool(renderEngine) {}
+    TestableTexturePool(renderengine::RenderEngine& renderEngine, TextureBudget& budget)
+          : TexturePool(renderEngine, budget) {}
 
     size_t getMinPoolSize() const { return kMinPoolSize; }
     size_t getMaxPoolSize() const { return kMaxPoolSize; }
@@ -53,7 +54,8 @@ struct TexturePoolTest : public testing::Test {
     }
 
     renderengine::mock::RenderEngine mRenderEngine;
-    TestableTexturePool mTexturePool = TestableTexturePool(mRenderEngine);
+    TextureBudget mBudget;
+    TestableTexturePool mTexturePool = TestableTexturePool(mRenderEngine, mBudget);
 };
 
 TEST_F(TexturePoolTest, preallocatesMinPool) {
@@ -170,5 +172,36 @@ TEST_F(TexturePoolTest, reallocatesWhenReEnabled) {
     EXPECT_EQ(mTexturePool.getPoolSize(), mTexturePool.getMinPoolSize());
 }
 
+TEST_F(TexturePoolTest, doesNotAllocateBeyondBudget) {
+    // Room for one more texture than are preallocated.
+    const size_t textureBytes = mBudget.getUsage() / mTexturePool.getMinPoolSize();
+    mBudget.setLimit(textureBytes * (mTexturePool.getMinPoolSize() + 1));
+
+    std::vector<std::shared_ptr<TexturePool::AutoTexture>> textures;
+    for (size_t i = 0; i < mTexturePool.getMinPoolSize() + 1; i++) {
+        textures.emplace_back(mTexturePool.borrowTexture());
+        EXPECT_NE(nullptr, textures.back());
+    }
+    EXPECT_EQ(nullptr, mTexturePool.borrowTexture());
+
+    textures.clear();
+    EXPECT_EQ(mTexturePool.getMinPoolSize() + 1, mTexturePool.getPoolSize());
+    EXPECT_NE(nullptr, mTexturePool.borrowTexture());
+}
+
+TEST_F(TexturePoolTest, dropsIdleTexturesWhenOverBudget) {
+    auto texture = mTexturePool.borrowTexture();
+    mBudget.setLimit(1);
+
+    texture.reset();
+    EXPECT_EQ(mTexturePool.getMinPoolSize() - 1, mTexturePool.getPoolSize());
+}
+
+TEST_F(TexturePoolTest, givesBackBudgetWhenDisabled) {
+    EXPECT_NE(0u, mBudget.getUsage());
+    mTexturePool.setEnabled(false);
+    EXPECT_EQ(0u, mBudget.getUsage());
+}
+
 } // namespace
 } // namespace android::compositionengine::impl::planner
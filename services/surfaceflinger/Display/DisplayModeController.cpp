@@ -181,8 +181,14 @@ bool DisplayModeController::initiateModeChange(PhysicalDisplayId displayId,
                                                DisplayModeRequest&& desiredMode,
                                                const hal::VsyncPeriodChangeConstraints& constraints,
                                                hal::VsyncPeriodChangeTimeline& outTimeline) {
-    std::lock_guard lock(mDisplayLock);
-    const auto& displayPtr = FTL_EXPECT(mDisplays.get(displayId).ok_or(false)).get();
+    // Displays are only unregistered on the main thread, so the Display outlives this call. Do not
+    // hold mDisplayLock across the HWC call below, which may block for a while, so that threads
+    // querying the active mode or selector are not held up by the mode change.
+    Display* displayPtr = nullptr;
+    {
+        std::lock_guard lock(mDisplayLock);
+        displayPtr = FTL_EXPECT(mDisplays.get(displayId).ok_or(false)).get().get();
+    }
 
     // TODO: b/255635711 - Flow the DisplayModeRequest through the desired/pending/active states.
     // For now, `desiredMode` and `desiredModeOpt` are one and the same, but the latter is not
@@ -64,11 +64,30 @@ namespace Hwc2 = android::Hwc2;
 
 namespace {
 
+// The HWC keeps the state of its layers, so a value it already has isn't sent again.
+template <typename T>
+bool isCached(const std::optional<T>& cached, const T& value) {
+    return cached == value && FlagManager::getInstance().skip_unchanged_layer_commands();
+}
+
 inline bool hasMetadataKey(const std::set<Hwc2::PerFrameMetadataKey>& keys,
                            const Hwc2::PerFrameMetadataKey& key) {
     return keys.find(key) != keys.end();
 }
 
+std::vector<Hwc2::IComposerClient::Rect> convertRegionToHwcRects(const Region& region) {
+    size_t rectCount = 0;
+    Rect const* rectArray = region.getArray(&rectCount);
+
+    std::vector<Hwc2::IComposerClient::Rect> hwcRects;
+    hwcRects.reserve(rectCount);
+    for (size_t rect = 0; rect < rectCount; ++rect) {
+        hwcRects.push_back({rectArray[rect].left, rectArray[rect].top, rectArray[rect].right,
+                            rectArray[rect].bottom});
+    }
+    return hwcRects;
+}
+
 } // namespace anonymous
 
 // Display methods
@@ -79,7 +98,11 @@ namespace impl {
 Display::Display(android::Hwc2::Composer& composer,
                  const std::unordered_set<AidlCapability>& capabilities, HWDisplayId id,
                  DisplayType type)
-      : mComposer(composer), mCapabilities(capabilities), mId(id), mType(type) {
+      : mComposer(composer),
+        mCapabilities(capabilities),
+        mId(id),
+        mType(type),
+        mRecycleLayers(FlagManager::getInstance().recycle_hwc_layers()) {
     ALOGV("Created display %" PRIu64, id);
     if (mType == hal::DisplayType::VIRTUAL) {
         loadDisplayCapabilities();
@@ -87,6 +110,9 @@ Display::Display(android::Hwc2::Composer& composer,
 }
 
 Display::~Display() {
+    mRecycleLayers = false;
+    destroyRecycledLayers();
+
     // Note: The calls to onOwningDisplayDestroyed() are allowed (and expected)
     // to call Display::onLayerDestroyed(). As that call removes entries from
     // mLayers, we do not want to have a for loop directly over it here. Since
@@ -132,6 +158,10 @@ Error Display::acceptChanges()
 }
 
 base::expected<std::shared_ptr<HWC2::Layer>, hal::Error> Display::createLayer() {
+    if (mRecycleLayers) {
+        return std::make_shared<impl::Layer>(mComposer, mCapabilities, *this);
+    }
+
     HWLayerId layerId = 0;
     auto intError = mComposer.createLayer(mId, &layerId);
     auto error = static_cast<Error>(intError);
@@ -148,6 +178,43 @@ void Display::onLayerDestroyed(hal::HWLayerId layerId) {
     mLayers.erase(layerId);
 }
 
+base::expected<HWLayerId, Error> Display::acquireLayerId(std::weak_ptr<impl::Layer> layer,
+                                                         bool* outRecycled) {
+    HWLayerId layerId = 0;
+    *outRecycled = !mRecycledLayerIds.empty();
+    if (*outRecycled) {
+        layerId = mRecycledLayerIds.back();
+        mRecycledLayerIds.pop_back();
+    } else if (auto error = static_cast<Error>(mComposer.createLayer(mId, &layerId));
+               error != Error::NONE) {
+        return base::unexpected(error);
+    }
+
+    mLayers.emplace(layerId, std::move(layer));
+    return layerId;
+}
+
+bool Display::recycleLayerId(HWLayerId layerId) {
+    if (!mRecycleLayers || mRecycledLayerIds.size() >= kMaxRecycledLayers) {
+        return false;
+    }
+    mRecycledLayerIds.push_back(layerId);
+    return true;
+}
+
+void Display::destroyRecycledLayers() {
+    // With layer command batching, these are sent along with the validate or present.
+    for (HWLayerId layerId : mRecycledLayerIds) {
+        auto intError = mComposer.destroyLayer(mId, layerId);
+        auto error = static_cast<Error>(intError);
+        ALOGE_IF(error != Error::NONE,
+                 "destroyLayer(%" PRIu64 ", %" PRIu64 ")"
+                 " failed: %s (%d)",
+                 mId, layerId, to_string(error).c_str(), intError);
+    }
+    mRecycledLayerIds.clear();
+}
+
 bool Display::isVsyncPeriodSwitchSupported() const {
     ALOGV("[%" PRIu64 "] isVsyncPeriodSwitchSupported()", mId);
 
@@ -415,6 +482,8 @@ Error Display::getReleaseFences(std::unordered_map<HWC2::Layer*, sp<Fence>>* out
 
 Error Display::present(sp<Fence>* outPresentFence)
 {
+    destroyRecycledLayers();
+
     int32_t presentFenceFd = -1;
     auto intError = mComposer.presentDisplay(mId, &presentFenceFd);
     auto error = static_cast<Error>(intError);
@@ -468,12 +537,15 @@ Error Display::setActiveConfigWithConstraints(hal::HWConfigId configId,
 
 Error Display::setClientTarget(uint32_t slot, const sp<GraphicBuffer>& target,
                                const sp<Fence>& acquireFence, Dataspace dataspace,
-                               float hdrSdrRatio) {
-    // TODO: Properly encode client target surface damage
+                               float hdrSdrRatio, const Region& damage) {
     int32_t fenceFd = acquireFence->dup();
-    auto intError =
-            mComposer.setClientTarget(mId, slot, target, fenceFd, dataspace,
-                                      std::vector<Hwc2::IComposerClient::Rect>(), hdrSdrRatio);
+    // We encode default full-screen damage as INVALID_RECT upstream, but as 0
+    // rects for HWC
+    const auto hwcRects = damage.isRect() && damage.getBounds() == Rect::INVALID_RECT
+            ? std::vector<Hwc2::IComposerClient::Rect>()
+            : convertRegionToHwcRects(damage);
+    auto intError = mComposer.setClientTarget(mId, slot, target, fenceFd, dataspace, hwcRects,
+                                              hdrSdrRatio);
     return static_cast<Error>(intError);
 }
 
@@ -519,6 +591,8 @@ Error Display::setVsyncEnabled(Vsync enabled)
 
 Error Display::validate(nsecs_t expectedPresentTime, int32_t frameIntervalNs, uint32_t* outNumTypes,
                         uint32_t* outNumRequests) {
+    destroyRecycledLayers();
+
     uint32_t numTypes = 0;
     uint32_t numRequests = 0;
     auto intError = mComposer.validateDisplay(mId, expectedPresentTime, frameIntervalNs, &numTypes,
@@ -536,6 +610,8 @@ Error Display::validate(nsecs_t expectedPresentTime, int32_t frameIntervalNs, ui
 Error Display::presentOrValidate(nsecs_t expectedPresentTime, int32_t frameIntervalNs,
                                  uint32_t* outNumTypes, uint32_t* outNumRequests,
                                  sp<android::Fence>* outPresentFence, uint32_t* state) {
+    destroyRecycledLayers();
+
     uint32_t numTypes = 0;
     uint32_t numRequests = 0;
     int32_t presentFenceFd = -1;
@@ -684,20 +760,6 @@ void Display::setPhysicalSizeInMm(std::optional<ui::Size> size) {
 
 // Layer methods
 
-namespace {
-std::vector<Hwc2::IComposerClient::Rect> convertRegionToHwcRects(const Region& region) {
-    size_t rectCount = 0;
-    Rect const* rectArray = region.getArray(&rectCount);
-
-    std::vector<Hwc2::IComposerClient::Rect> hwcRects;
-    hwcRects.reserve(rectCount);
-    for (size_t rect = 0; rect < rectCount; ++rect) {
-        hwcRects.push_back({rectArray[rect].left, rectArray[rect].top, rectArray[rect].right,
-                            rectArray[rect].bottom});
-    }
-    return hwcRects;
-}
-} // namespace
 
 Layer::~Layer() = default;
 
@@ -714,11 +776,71 @@ Layer::Layer(android::Hwc2::Composer& composer,
     ALOGV("Created layer %" PRIu64 " on display %" PRIu64, layerId, display.getId());
 }
 
+Layer::Layer(android::Hwc2::Composer& composer,
+             const std::unordered_set<AidlCapability>& capabilities, Display& display)
+      : mComposer(composer),
+        mCapabilities(capabilities),
+        mDisplay(&display),
+        mRecyclingDisplay(&display),
+        mId(0),
+        mHasHwcLayer(false),
+        mColorMatrix(android::mat4()) {}
+
 Layer::~Layer()
 {
     onOwningDisplayDestroyed();
 }
 
+Error Layer::ensureHwcLayer() {
+    if (CC_UNLIKELY(!mDisplay)) {
+        return Error::BAD_DISPLAY;
+    }
+    if (CC_LIKELY(mHasHwcLayer)) {
+        return Error::NONE;
+    }
+
+    bool recycled = false;
+    auto layerId = mRecyclingDisplay->acquireLayerId(weak_from_this(), &recycled);
+    if (!layerId) {
+        return layerId.error();
+    }
+    mId = *layerId;
+    mHasHwcLayer = true;
+    if (recycled) {
+        // The HWC layer still has the state of its previous owner, so nothing may be skipped
+        // for matching what a new HWC layer starts out with.
+        mVisibleRegion = Region::INVALID_REGION;
+        mDamageRegion = Region::INVALID_REGION;
+        mBlockingRegion = Region::INVALID_REGION;
+        mDataSpace.reset();
+        mHdrMetadata.reset();
+        mColorMatrix.reset();
+        mBufferSlot.reset();
+    }
+    ALOGV("Created layer %" PRIu64 " on display %" PRIu64, mId, mDisplay->getId());
+    return Error::NONE;
+}
+
+void Layer::clearBufferSlots() {
+    std::vector<uint32_t> slotsToClear;
+    for (uint32_t slot = 0; slot < kMaxTrackedBufferSlots; slot++) {
+        if (mBufferSlotsInUse & (1ull << slot)) {
+            slotsToClear.push_back(slot);
+        }
+    }
+    if (slotsToClear.empty()) {
+        return;
+    }
+
+    auto intError = mComposer.setLayerBufferSlotsToClear(mDisplay->getId(), mId, slotsToClear,
+                                                         mBufferSlot.value_or(0));
+    auto error = static_cast<Error>(intError);
+    ALOGE_IF(error != Error::NONE,
+             "setLayerBufferSlotsToClear(%" PRIu64 ", %" PRIu64 ")"
+             " failed: %s (%d)",
+             mDisplay->getId(), mId, to_string(error).c_str(), intError);
+}
+
 void Layer::onOwningDisplayDestroyed() {
     // Note: onOwningDisplayDestroyed() may be called to perform cleanup by
     // either the Layer dtor or by the Display dtor and must be safe to call
@@ -729,8 +851,19 @@ void Layer::onOwningDisplayDestroyed() {
         return;
     }
 
+    if (!mHasHwcLayer) {
+        mDisplay = nullptr;
+        return;
+    }
+
     mDisplay->onLayerDestroyed(mId);
 
+    if (mRecyclingDisplay && !mHasStickyState && mRecyclingDisplay->recycleLayerId(mId)) {
+        clearBufferSlots();
+        mDisplay = nullptr;
+        return;
+    }
+
     // Note: If the HWC display was actually disconnected, these calls are will
     // return an error. We always make them as there may be other reasons for
     // the HWC2::Display to be destroyed.
@@ -746,8 +879,8 @@ void Layer::onOwningDisplayDestroyed() {
 
 Error Layer::setCursorPosition(int32_t x, int32_t y)
 {
-    if (CC_UNLIKELY(!mDisplay)) {
-        return Error::BAD_DISPLAY;
+    if (auto error = ensureHwcLayer(); CC_UNLIKELY(error != Error::NONE)) {
+        return error;
     }
 
     auto intError = mComposer.setCursorPosition(mDisplay->getId(), mId, x, y);
@@ -757,14 +890,19 @@ Error Layer::setCursorPosition(int32_t x, int32_t y)
 Error Layer::setBuffer(uint32_t slot, const sp<GraphicBuffer>& buffer,
         const sp<Fence>& acquireFence)
 {
-    if (CC_UNLIKELY(!mDisplay)) {
-        return Error::BAD_DISPLAY;
+    if (auto error = ensureHwcLayer(); CC_UNLIKELY(error != Error::NONE)) {
+        return error;
     }
 
     if (buffer == nullptr && mBufferSlot == slot) {
         return Error::NONE;
     }
     mBufferSlot = slot;
+    if (slot < kMaxTrackedBufferSlots) {
+        mBufferSlotsInUse |= 1ull << slot;
+    } else {
+        mHasStickyState = true;
+    }
 
     int32_t fenceFd = acquireFence->dup();
     auto intError = mComposer.setLayerBuffer(mDisplay->getId(), mId, slot, buffer, fenceFd);
@@ -776,15 +914,24 @@ Error Layer::setBufferSlotsToClear(const std::vector<uint32_t>& slotsToClear,
     if (CC_UNLIKELY(!mDisplay)) {
         return Error::BAD_DISPLAY;
     }
+    // A HWC layer that wasn't acquired yet holds no buffers.
+    if (!mHasHwcLayer) {
+        return Error::NONE;
+    }
     auto intError = mComposer.setLayerBufferSlotsToClear(mDisplay->getId(), mId, slotsToClear,
                                                          activeBufferSlot);
+    for (uint32_t slot : slotsToClear) {
+        if (slot < kMaxTrackedBufferSlots && slot != activeBufferSlot) {
+            mBufferSlotsInUse &= ~(1ull << slot);
+        }
+    }
     return static_cast<Error>(intError);
 }
 
 Error Layer::setSurfaceDamage(const Region& damage)
 {
-    if (CC_UNLIKELY(!mDisplay)) {
-        return Error::BAD_DISPLAY;
+    if (auto error = ensureHwcLayer(); CC_UNLIKELY(error != Error::NONE)) {
+        return error;
     }
 
     if (damage.isRect() && mDamageRegion.isRect() &&
@@ -809,17 +956,21 @@ Error Layer::setSurfaceDamage(const Region& damage)
 
 Error Layer::setBlendMode(BlendMode mode)
 {
-    if (CC_UNLIKELY(!mDisplay)) {
-        return Error::BAD_DISPLAY;
+    if (auto error = ensureHwcLayer(); CC_UNLIKELY(error != Error::NONE)) {
+        return error;
     }
 
-    auto intError = mComposer.setLayerBlendMode(mDisplay->getId(), mId, mode);
-    return static_cast<Error>(intError);
+    if (isCached(mBlendMode, mode)) {
+        return Error::NONE;
+    }
+    auto error = static_cast<Error>(mComposer.setLayerBlendMode(mDisplay->getId(), mId, mode));
+    mBlendMode = error == Error::NONE ? std::make_optional(mode) : std::nullopt;
+    return error;
 }
 
 Error Layer::setColor(Color color) {
-    if (CC_UNLIKELY(!mDisplay)) {
-        return Error::BAD_DISPLAY;
+    if (auto error = ensureHwcLayer(); CC_UNLIKELY(error != Error::NONE)) {
+        return error;
     }
 
     auto intError = mComposer.setLayerColor(mDisplay->getId(), mId, color);
@@ -828,8 +979,8 @@ Error Layer::setColor(Color color) {
 
 Error Layer::setCompositionType(Composition type)
 {
-    if (CC_UNLIKELY(!mDisplay)) {
-        return Error::BAD_DISPLAY;
+    if (auto error = ensureHwcLayer(); CC_UNLIKELY(error != Error::NONE)) {
+        return error;
     }
 
     auto intError = mComposer.setLayerCompositionType(mDisplay->getId(), mId, type);
@@ -838,62 +989,63 @@ Error Layer::setCompositionType(Composition type)
 
 Error Layer::setDataspace(Dataspace dataspace)
 {
-    if (CC_UNLIKELY(!mDisplay)) {
-        return Error::BAD_DISPLAY;
+    if (auto error = ensureHwcLayer(); CC_UNLIKELY(error != Error::NONE)) {
+        return error;
     }
 
-    if (dataspace == mDataSpace) {
+    if (mDataSpace == dataspace) {
         return Error::NONE;
     }
     mDataSpace = dataspace;
-    auto intError = mComposer.setLayerDataspace(mDisplay->getId(), mId, mDataSpace);
+    auto intError = mComposer.setLayerDataspace(mDisplay->getId(), mId, dataspace);
     return static_cast<Error>(intError);
 }
 
 Error Layer::setPerFrameMetadata(const int32_t supportedPerFrameMetadata,
         const android::HdrMetadata& metadata)
 {
-    if (CC_UNLIKELY(!mDisplay)) {
-        return Error::BAD_DISPLAY;
+    if (auto error = ensureHwcLayer(); CC_UNLIKELY(error != Error::NONE)) {
+        return error;
     }
 
-    if (metadata == mHdrMetadata) {
+    if (mHdrMetadata && metadata == *mHdrMetadata) {
         return Error::NONE;
     }
 
     mHdrMetadata = metadata;
-    int validTypes = mHdrMetadata.validTypes & supportedPerFrameMetadata;
+    mHasStickyState = true;
+    int validTypes = metadata.validTypes & supportedPerFrameMetadata;
     std::vector<Hwc2::PerFrameMetadata> perFrameMetadatas;
     if (validTypes & HdrMetadata::SMPTE2086) {
         perFrameMetadatas.insert(perFrameMetadatas.end(),
                                  {{Hwc2::PerFrameMetadataKey::DISPLAY_RED_PRIMARY_X,
-                                   mHdrMetadata.smpte2086.displayPrimaryRed.x},
+                                   metadata.smpte2086.displayPrimaryRed.x},
                                   {Hwc2::PerFrameMetadataKey::DISPLAY_RED_PRIMARY_Y,
-                                   mHdrMetadata.smpte2086.displayPrimaryRed.y},
+                                   metadata.smpte2086.displayPrimaryRed.y},
                                   {Hwc2::PerFrameMetadataKey::DISPLAY_GREEN_PRIMARY_X,
-                                   mHdrMetadata.smpte2086.displayPrimaryGreen.x},
+                                   metadata.smpte2086.displayPrimaryGreen.x},
                                   {Hwc2::PerFrameMetadataKey::DISPLAY_GREEN_PRIMARY_Y,
-                                   mHdrMetadata.smpte2086.displayPrimaryGreen.y},
+                                   metadata.smpte2086.displayPrimaryGreen.y},
                                   {Hwc2::PerFrameMetadataKey::DISPLAY_BLUE_PRIMARY_X,
-                                   mHdrMetadata.smpte2086.displayPrimaryBlue.x},
+                                   metadata.smpte2086.displayPrimaryBlue.x},
                                   {Hwc2::PerFrameMetadataKey::DISPLAY_BLUE_PRIMARY_Y,
-                                   mHdrMetadata.smpte2086.displayPrimaryBlue.y},
+                                   metadata.smpte2086.displayPrimaryBlue.y},
                                   {Hwc2::PerFrameMetadataKey::WHITE_POINT_X,
-                                   mHdrMetadata.smpte2086.whitePoint.x},
+                                   metadata.smpte2086.whitePoint.x},
                                   {Hwc2::PerFrameMetadataKey::WHITE_POINT_Y,
-                                   mHdrMetadata.smpte2086.whitePoint.y},
+                                   metadata.smpte2086.whitePoint.y},
                                   {Hwc2::PerFrameMetadataKey::MAX_LUMINANCE,
-                                   mHdrMetadata.smpte2086.maxLuminance},
+                                   metadata.smpte2086.maxLuminance},
                                   {Hwc2::PerFrameMetadataKey::MIN_LUMINANCE,
-                                   mHdrMetadata.smpte2086.minLuminance}});
+                                   metadata.smpte2086.minLuminance}});
     }
 
     if (validTypes & HdrMetadata::CTA861_3) {
         perFrameMetadatas.insert(perFrameMetadatas.end(),
                                  {{Hwc2::PerFrameMetadataKey::MAX_CONTENT_LIGHT_LEVEL,
-                                   mHdrMetadata.cta8613.maxContentLightLevel},
+                                   metadata.cta8613.maxContentLightLevel},
                                   {Hwc2::PerFrameMetadataKey::MAX_FRAME_AVERAGE_LIGHT_LEVEL,
-                                   mHdrMetadata.cta8613.maxFrameAverageLightLevel}});
+                                   metadata.cta8613.maxFrameAverageLightLevel}});
     }
 
     const Error error = static_cast<Error>(
@@ -904,12 +1056,12 @@ Error Layer::setPerFrameMetadata(const int32_t supportedPerFrameMetadata,
 
     std::vector<Hwc2::PerFrameMetadataBlob> perFrameMetadataBlobs;
     if (validTypes & HdrMetadata::HDR10PLUS) {
-        if (CC_UNLIKELY(mHdrMetadata.hdr10plus.size() == 0)) {
+        if (CC_UNLIKELY(metadata.hdr10plus.size() == 0)) {
             return Error::BAD_PARAMETER;
         }
 
         perFrameMetadataBlobs.push_back(
-                {Hwc2::PerFrameMetadataKey::HDR10_PLUS_SEI, mHdrMetadata.hdr10plus});
+                {Hwc2::PerFrameMetadataKey::HDR10_PLUS_SEI, metadata.hdr10plus});
     }
 
     return static_cast<Error>(
@@ -918,30 +1070,39 @@ Error Layer::setPerFrameMetadata(const int32_t supportedPerFrameMetadata,
 
 Error Layer::setDisplayFrame(const Rect& frame)
 {
-    if (CC_UNLIKELY(!mDisplay)) {
-        return Error::BAD_DISPLAY;
+    if (auto error = ensureHwcLayer(); CC_UNLIKELY(error != Error::NONE)) {
+        return error;
     }
 
+    if (isCached(mDisplayFrame, frame)) {
+        return Error::NONE;
+    }
     Hwc2::IComposerClient::Rect hwcRect{frame.left, frame.top,
         frame.right, frame.bottom};
-    auto intError = mComposer.setLayerDisplayFrame(mDisplay->getId(), mId, hwcRect);
-    return static_cast<Error>(intError);
+    auto error =
+            static_cast<Error>(mComposer.setLayerDisplayFrame(mDisplay->getId(), mId, hwcRect));
+    mDisplayFrame = error == Error::NONE ? std::make_optional(frame) : std::nullopt;
+    return error;
 }
 
 Error Layer::setPlaneAlpha(float alpha)
 {
-    if (CC_UNLIKELY(!mDisplay)) {
-        return Error::BAD_DISPLAY;
+    if (auto error = ensureHwcLayer(); CC_UNLIKELY(error != Error::NONE)) {
+        return error;
     }
 
-    auto intError = mComposer.setLayerPlaneAlpha(mDisplay->getId(), mId, alpha);
-    return static_cast<Error>(intError);
+    if (isCached(mPlaneAlpha, alpha)) {
+        return Error::NONE;
+    }
+    auto error = static_cast<Error>(mComposer.setLayerPlaneAlpha(mDisplay->getId(), mId, alpha));
+    mPlaneAlpha = error == Error::NONE ? std::make_optional(alpha) : std::nullopt;
+    return error;
 }
 
 Error Layer::setSidebandStream(const native_handle_t* stream)
 {
-    if (CC_UNLIKELY(!mDisplay)) {
-        return Error::BAD_DISPLAY;
+    if (auto error = ensureHwcLayer(); CC_UNLIKELY(error != Error::NONE)) {
+        return error;
     }
 
     if (mCapabilities.count(AidlCapability::SIDEBAND_STREAM) == 0) {
@@ -949,43 +1110,57 @@ Error Layer::setSidebandStream(const native_handle_t* stream)
                 "device supports sideband streams");
         return Error::UNSUPPORTED;
     }
+    mHasStickyState = true;
     auto intError = mComposer.setLayerSidebandStream(mDisplay->getId(), mId, stream);
     return static_cast<Error>(intError);
 }
 
 Error Layer::setSourceCrop(const FloatRect& crop)
 {
-    if (CC_UNLIKELY(!mDisplay)) {
-        return Error::BAD_DISPLAY;
+    if (auto error = ensureHwcLayer(); CC_UNLIKELY(error != Error::NONE)) {
+        return error;
     }
 
+    if (isCached(mSourceCrop, crop)) {
+        return Error::NONE;
+    }
     Hwc2::IComposerClient::FRect hwcRect{
         crop.left, crop.top, crop.right, crop.bottom};
-    auto intError = mComposer.setLayerSourceCrop(mDisplay->getId(), mId, hwcRect);
-    return static_cast<Error>(intError);
+    auto error = static_cast<Error>(mComposer.setLayerSourceCrop(mDisplay->getId(), mId, hwcRect));
+    mSourceCrop = error == Error::NONE ? std::make_optional(crop) : std::nullopt;
+    return error;
 }
 
 Error Layer::setTransform(Transform transform)
 {
-    if (CC_UNLIKELY(!mDisplay)) {
-        return Error::BAD_DISPLAY;
+    if (auto error = ensureHwcLayer(); CC_UNLIKELY(error != Error::NONE)) {
+        return error;
     }
 
+    if (isCached(mTransform, transform)) {
+        return Error::NONE;
+    }
     auto intTransform = static_cast<Hwc2::Transform>(transform);
-    auto intError = mComposer.setLayerTransform(mDisplay->getId(), mId, intTransform);
-    return static_cast<Error>(intError);
+    auto error =
+            static_cast<Error>(mComposer.setLayerTransform(mDisplay->getId(), mId, intTransform));
+    mTransform = error == Error::NONE ? std::make_optional(transform) : std::nullopt;
+    return error;
 }
 
 Error Layer::setVisibleRegion(const Region& region)
 {
-    if (CC_UNLIKELY(!mDisplay)) {
-        return Error::BAD_DISPLAY;
+    if (auto error = ensureHwcLayer(); CC_UNLIKELY(error != Error::NONE)) {
+        return error;
     }
 
     if (region.isRect() && mVisibleRegion.isRect() &&
         (region.getBounds() == mVisibleRegion.getBounds())) {
         return Error::NONE;
     }
+    if (FlagManager::getInstance().skip_unchanged_layer_commands() &&
+        region.hasSameRects(mVisibleRegion)) {
+        return Error::NONE;
+    }
     mVisibleRegion = region;
     const auto hwcRects = convertRegionToHwcRects(region);
     auto intError = mComposer.setLayerVisibleRegion(mDisplay->getId(), mId, hwcRects);
@@ -994,21 +1169,25 @@ Error Layer::setVisibleRegion(const Region& region)
 
 Error Layer::setZOrder(uint32_t z)
 {
-    if (CC_UNLIKELY(!mDisplay)) {
-        return Error::BAD_DISPLAY;
+    if (auto error = ensureHwcLayer(); CC_UNLIKELY(error != Error::NONE)) {
+        return error;
     }
 
-    auto intError = mComposer.setLayerZOrder(mDisplay->getId(), mId, z);
-    return static_cast<Error>(intError);
+    if (isCached(mZOrder, z)) {
+        return Error::NONE;
+    }
+    auto error = static_cast<Error>(mComposer.setLayerZOrder(mDisplay->getId(), mId, z));
+    mZOrder = error == Error::NONE ? std::make_optional(z) : std::nullopt;
+    return error;
 }
 
 // Composer HAL 2.3
 Error Layer::setColorTransform(const android::mat4& matrix) {
-    if (CC_UNLIKELY(!mDisplay)) {
-        return Error::BAD_DISPLAY;
+    if (auto error = ensureHwcLayer(); CC_UNLIKELY(error != Error::NONE)) {
+        return error;
     }
 
-    if (matrix == mColorMatrix) {
+    if (mColorMatrix && matrix == *mColorMatrix) {
         return Error::NONE;
     }
     auto intError = mComposer.setLayerColorTransform(mDisplay->getId(), mId, matrix.asArray());
@@ -1023,10 +1202,11 @@ Error Layer::setColorTransform(const android::mat4& matrix) {
 // Composer HAL 2.4
 Error Layer::setLayerGenericMetadata(const std::string& name, bool mandatory,
                                      const std::vector<uint8_t>& value) {
-    if (CC_UNLIKELY(!mDisplay)) {
-        return Error::BAD_DISPLAY;
+    if (auto error = ensureHwcLayer(); CC_UNLIKELY(error != Error::NONE)) {
+        return error;
     }
 
+    mHasStickyState = true;
     auto intError =
             mComposer.setLayerGenericMetadata(mDisplay->getId(), mId, name, mandatory, value);
     return static_cast<Error>(intError);
@@ -1034,23 +1214,32 @@ Error Layer::setLayerGenericMetadata(const std::string& name, bool mandatory,
 
 // AIDL HAL
 Error Layer::setBrightness(float brightness) {
-    if (CC_UNLIKELY(!mDisplay)) {
-        return Error::BAD_DISPLAY;
+    if (auto error = ensureHwcLayer(); CC_UNLIKELY(error != Error::NONE)) {
+        return error;
     }
 
-    auto intError = mComposer.setLayerBrightness(mDisplay->getId(), mId, brightness);
-    return static_cast<Error>(intError);
+    if (isCached(mBrightness, brightness)) {
+        return Error::NONE;
+    }
+    auto error =
+            static_cast<Error>(mComposer.setLayerBrightness(mDisplay->getId(), mId, brightness));
+    mBrightness = error == Error::NONE ? std::make_optional(brightness) : std::nullopt;
+    return error;
 }
 
 Error Layer::setBlockingRegion(const Region& region) {
-    if (CC_UNLIKELY(!mDisplay)) {
-        return Error::BAD_DISPLAY;
+    if (auto error = ensureHwcLayer(); CC_UNLIKELY(error != Error::NONE)) {
+        return error;
     }
 
     if (region.isRect() && mBlockingRegion.isRect() &&
         (region.getBounds() == mBlockingRegion.getBounds())) {
         return Error::NONE;
     }
+    if (FlagManager::getInstance().skip_unchanged_layer_commands() &&
+        region.hasSameRects(mBlockingRegion)) {
+        return Error::NONE;
+    }
     mBlockingRegion = region;
     const auto hwcRects = convertRegionToHwcRects(region);
     const auto intError = mComposer.setLayerBlockingRegion(mDisplay->getId(), mId, hwcRects);
@@ -1058,9 +1247,10 @@ Error Layer::setBlockingRegion(const Region& region) {
 }
 
 Error Layer::setLuts(std::vector<Lut>& luts) {
-    if (CC_UNLIKELY(!mDisplay)) {
-        return Error::BAD_DISPLAY;
+    if (auto error = ensureHwcLayer(); CC_UNLIKELY(error != Error::NONE)) {
+        return error;
     }
+    mHasStickyState = true;
     const auto intError = mComposer.setLayerLuts(mDisplay->getId(), mId, luts);
     return static_cast<Error>(intError);
 }
@@ -22,6 +22,7 @@
 #include <ftl/future.h>
 #include <gui/HdrMetadata.h>
 #include <math/mat4.h>
+#include <ui/FloatRect.h>
 #include <ui/HdrCapabilities.h>
 #include <ui/Region.h>
 #include <ui/StaticDisplayInfo.h>
@@ -30,6 +31,8 @@
 #include <utils/Timers.h>
 
 #include <functional>
+#include <memory>
+#include <optional>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
@@ -148,7 +151,7 @@ public:
     [[nodiscard]] virtual hal::Error setClientTarget(
             uint32_t slot, const android::sp<android::GraphicBuffer>& target,
             const android::sp<android::Fence>& acquireFence, hal::Dataspace dataspace,
-            float hdrSdrRatio) = 0;
+            float hdrSdrRatio, const android::Region& damage) = 0;
     [[nodiscard]] virtual hal::Error setColorMode(hal::ColorMode mode,
                                                   hal::RenderIntent renderIntent) = 0;
     [[nodiscard]] virtual hal::Error setColorTransform(const android::mat4& matrix) = 0;
@@ -239,7 +242,8 @@ public:
     hal::Error present(android::sp<android::Fence>* outPresentFence) override;
     hal::Error setClientTarget(uint32_t slot, const android::sp<android::GraphicBuffer>& target,
                                const android::sp<android::Fence>& acquireFence,
-                               hal::Dataspace dataspace, float hdrSdrRatio) override;
+                               hal::Dataspace dataspace, float hdrSdrRatio,
+                               const android::Region& damage) override;
     hal::Error setColorMode(hal::ColorMode, hal::RenderIntent) override;
     hal::Error setColorTransform(const android::mat4& matrix) override;
     hal::Error setOutputBuffer(const android::sp<android::GraphicBuffer>&,
@@ -289,9 +293,21 @@ public:
     void setPhysicalSizeInMm(std::optional<ui::Size> size);
     std::optional<ui::Size> getPhysicalSizeInMm() const override { return mPhysicalSize; }
 
+    // Returns the HWC layer for a layer of this display on its first use. This is a HWC layer
+    // recycled since the last validate or present if there is one, in which case outRecycled is
+    // set, or else a new one.
+    base::expected<hal::HWLayerId, hal::Error> acquireLayerId(std::weak_ptr<impl::Layer>,
+                                                              bool* outRecycled);
+    // Takes over the HWC layer of a destroyed layer, so that a new layer can reuse it. Returns
+    // false if the HWC layer should be destroyed instead.
+    bool recycleLayerId(hal::HWLayerId layerId);
+
 private:
     void loadDisplayCapabilities();
 
+    // Destroys the recycled HWC layers no layer picked up, so that they aren't presented.
+    void destroyRecycledLayers();
+
     // This may fail (and return a null pointer) if no layer with this ID exists
     // on this display
     std::shared_ptr<HWC2::Layer> getLayerById(hal::HWLayerId id) const;
@@ -316,6 +332,14 @@ private:
     using Layers = std::unordered_map<hal::HWLayerId, std::weak_ptr<HWC2::impl::Layer>>;
     Layers mLayers;
 
+    // Layers come and go in bursts during transitions. When enabled, a HWC layer is only picked
+    // for a layer when the first command is sent to it, which is after the layers leaving the
+    // display this frame were destroyed. This lets the new layers reuse their HWC layers instead
+    // of creating and destroying HWC layers on every change.
+    bool mRecycleLayers;
+    static constexpr size_t kMaxRecycledLayers = 16;
+    std::vector<hal::HWLayerId> mRecycledLayerIds;
+
     mutable std::mutex mDisplayCapabilitiesMutex;
     std::once_flag mDisplayCapabilityQueryFlag;
     std::optional<
@@ -376,12 +400,17 @@ namespace impl {
 
 // Convenience C++ class to access per layer functions directly.
 
-class Layer : public HWC2::Layer {
+class Layer : public HWC2::Layer, public std::enable_shared_from_this<Layer> {
 public:
     Layer(android::Hwc2::Composer& composer,
           const std::unordered_set<aidl::android::hardware::graphics::composer3::Capability>&
                   capabilities,
           HWC2::Display& display, hal::HWLayerId layerId);
+    // Creates a layer whose HWC layer is acquired from the display on first use.
+    Layer(android::Hwc2::Composer& composer,
+          const std::unordered_set<aidl::android::hardware::graphics::composer3::Capability>&
+                  capabilities,
+          Display& display);
     ~Layer() override;
 
     void onOwningDisplayDestroyed();
@@ -424,6 +453,11 @@ public:
             std::vector<aidl::android::hardware::graphics::composer3::Lut>& luts) override;
 
 private:
+    // Returns BAD_DISPLAY once the display is gone, or the error acquiring the HWC layer.
+    hal::Error ensureHwcLayer();
+    // Clears the buffer slots the HWC holds for this layer before it's recycled.
+    void clearBufferSlots();
+
     // These are references to data owned by HWComposer, which will outlive
     // this HWC2::Layer, so these references are guaranteed to be valid for
     // the lifetime of this object.
@@ -432,17 +466,38 @@ private:
             mCapabilities;
 
     HWC2::Display* mDisplay;
+    // Set if the HWC layer is acquired from, and recycled through, the display.
+    Display* mRecyclingDisplay = nullptr;
     hal::HWLayerId mId;
+    bool mHasHwcLayer = true;
+
+    // The buffer slots sent to the HWC, as a bit mask. A layer that used other slots isn't
+    // recycled.
+    static constexpr uint32_t kMaxTrackedBufferSlots = 64;
+    uint64_t mBufferSlotsInUse = 0;
+    // Set once state was sent that the next layer using the HWC layer might not overwrite, in
+    // which case the HWC layer isn't recycled.
+    bool mHasStickyState = false;
 
     // Cached HWC2 data, to ensure the same commands aren't sent to the HWC
     // multiple times.
     android::Region mVisibleRegion = android::Region::INVALID_REGION;
     android::Region mDamageRegion = android::Region::INVALID_REGION;
     android::Region mBlockingRegion = android::Region::INVALID_REGION;
-    hal::Dataspace mDataSpace = hal::Dataspace::UNKNOWN;
-    android::HdrMetadata mHdrMetadata;
-    android::mat4 mColorMatrix;
-    uint32_t mBufferSlot;
+    // These start out as the values a new HWC layer has, and are reset if the HWC layer is a
+    // recycled one.
+    std::optional<hal::Dataspace> mDataSpace = hal::Dataspace::UNKNOWN;
+    std::optional<android::HdrMetadata> mHdrMetadata = android::HdrMetadata{};
+    std::optional<android::mat4> mColorMatrix;
+    std::optional<uint32_t> mBufferSlot;
+    // Only set once sent successfully, as the HWC has no default for these.
+    std::optional<hal::BlendMode> mBlendMode;
+    std::optional<android::Rect> mDisplayFrame;
+    std::optional<float> mPlaneAlpha;
+    std::optional<android::FloatRect> mSourceCrop;
+    std::optional<hal::Transform> mTransform;
+    std::optional<uint32_t> mZOrder;
+    std::optional<float> mBrightness;
 };
 
 } // namespace impl
@@ -153,9 +153,11 @@ public:
             nsecs_t expectedPresentTime, Fps frameInterval,
             std::optional<DeviceRequestedChanges>* outChanges) = 0;
 
+    // damage is the region of target which changed since the previous client target, in
+    // buffer coordinates, or INVALID_REGION if the whole buffer may have changed.
     virtual status_t setClientTarget(HalDisplayId, uint32_t slot, const sp<Fence>& acquireFence,
                                      const sp<GraphicBuffer>& target, ui::Dataspace,
-                                     float hdrSdrRatio) = 0;
+                                     float hdrSdrRatio, const Region& damage) = 0;
 
     // Present layers to the display and read releaseFences.
     virtual status_t presentAndGetReleaseFences(
@@ -363,8 +365,8 @@ public:
             std::optional<DeviceRequestedChanges>* outChanges) override;
 
     status_t setClientTarget(HalDisplayId, uint32_t slot, const sp<Fence>& acquireFence,
-                             const sp<GraphicBuffer>& target, ui::Dataspace,
-                             float hdrSdrRatio) override;
+                             const sp<GraphicBuffer>& target, ui::Dataspace, float hdrSdrRatio,
+                             const Region& damage) override;
 
     // Present layers to the display and read releaseFences.
     status_t presentAndGetReleaseFences(
@@ -22,8 +22,10 @@
 #define LOG_TAG "PowerAdvisor"
 
 #include <unistd.h>
+#include <algorithm>
 #include <cinttypes>
 #include <cstdint>
+#include <numeric>
 #include <optional>
 
 #include <android-base/properties.h>
@@ -330,6 +332,19 @@ void PowerAdvisor::reportActualWorkDuration() {
         ALOGV("Failed to send actual work duration, skipping");
         return;
     }
+
+    // Fit the workload model to what this frame actually took
+    if (mWorkloadFeatures.has_value() && mPredictedDuration.has_value()) {
+        if (sTraceHintSessionData) {
+            SFTRACE_INT64("Prediction error",
+                          actualDuration->durationNanos - mPredictedDuration->ns());
+        }
+        mWorkloadModel.train(*mWorkloadFeatures, Duration::fromNs(actualDuration->durationNanos));
+    }
+    mWorkloadFeatures.reset();
+    mPredictedDuration.reset();
+    mLastMeasuredDuration = Duration::fromNs(actualDuration->durationNanos);
+
     actualDuration->durationNanos += sTargetSafetyMargin.ns();
     if (sTraceHintSessionData) {
         SFTRACE_INT64("Measured duration", actualDuration->durationNanos);
@@ -557,6 +572,41 @@ void PowerAdvisor::setTotalFrameTargetWorkDuration(Duration targetDuration) {
     mTotalFrameTargetDuration = targetDuration;
 }
 
+void PowerAdvisor::setCompositionWorkload(size_t layerCount, size_t blurLayerCount) {
+    if (!mBootFinished || !usePowerHintSession()) {
+        return;
+    }
+
+    // Whether the gpu composites this frame isn't decided until composition, so assume the same
+    // as the last frame
+    const bool requiresRenderEngine =
+            std::any_of(mDisplayIds.begin(), mDisplayIds.end(), [this](DisplayId displayId) {
+                const auto it = mDisplayTimingData.find(displayId);
+                return it != mDisplayTimingData.end() && it->second.requiresRenderEngine;
+            });
+
+    mWorkloadFeatures =
+            WorkloadModel::makeFeatures(layerCount, blurLayerCount, requiresRenderEngine);
+    mPredictedDuration = mWorkloadModel.predict(*mWorkloadFeatures);
+    if (sTraceHintSessionData) SFTRACE_INT64("Predicted duration", mPredictedDuration->ns());
+
+    if (!sUsePredictiveLoadUpHints || !mWorkloadModel.isTrained() ||
+        !mLastMeasuredDuration.has_value()) {
+        return;
+    }
+
+    // Boost ahead of a frame forecast to be much more expensive than the last one, rather than
+    // waiting for its actual duration to be reported
+    if (static_cast<float>(mPredictedDuration->ns()) >
+        static_cast<float>(mLastMeasuredDuration->ns()) * kPredictiveLoadUpRatio) {
+        SFTRACE_NAME("Predictive load up");
+        sendHintSessionHint(SessionHint::CPU_LOAD_UP);
+        if (requiresRenderEngine && supportsGpuReporting()) {
+            sendHintSessionHint(SessionHint::GPU_LOAD_UP);
+        }
+    }
+}
+
 std::vector<DisplayId> PowerAdvisor::getOrderedDisplayIds(
         std::optional<TimePoint> DisplayTimingData::*sortBy) {
     std::vector<DisplayId> sortedDisplays;
@@ -753,6 +803,34 @@ const Duration PowerAdvisor::sTargetSafetyMargin = std::chrono::microseconds(
 const bool PowerAdvisor::sUseReportActualDuration =
         base::GetBoolProperty(std::string("debug.adpf.use_report_actual_duration"), true);
 
+const bool PowerAdvisor::sUsePredictiveLoadUpHints =
+        base::GetBoolProperty(std::string("debug.sf.adpf_predictive_load_up"), false);
+
+WorkloadModel::Features WorkloadModel::makeFeatures(size_t layerCount, size_t blurLayerCount,
+                                                    bool requiresRenderEngine) {
+    return {1.f, static_cast<float>(layerCount) / kLayerCountScale,
+            static_cast<float>(blurLayerCount), requiresRenderEngine ? 1.f : 0.f};
+}
+
+Duration WorkloadModel::predict(const Features& features) const {
+    const float prediction =
+            std::inner_product(features.begin(), features.end(), mWeights.begin(), 0.f);
+    return Duration::fromNs(static_cast<nsecs_t>(std::max(prediction, 0.f)));
+}
+
+void WorkloadModel::train(const Features& features, Duration actualDuration) {
+    const float prediction =
+            std::inner_product(features.begin(), features.end(), mWeights.begin(), 0.f);
+    const float error = static_cast<float>(actualDuration.ns()) - prediction;
+    // The constant term keeps the norm at least 1
+    const float norm =
+            std::inner_product(features.begin(), features.end(), features.begin(), 0.f);
+    for (size_t i = 0; i < kFeatureCount; i++) {
+        mWeights[i] += kLearningRate * error * features[i] / norm;
+    }
+    mTrainingFrameCount++;
+}
+
 power::PowerHalController& PowerAdvisor::getPowerHal() {
     static std::once_flag halFlag;
     std::call_once(halFlag, [this] { mPowerHal->init(); });
@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include <array>
 #include <atomic>
 #include <chrono>
 #include <unordered_map>
@@ -101,6 +102,8 @@ public:
     virtual void setDisplays(std::vector<DisplayId>& displayIds) = 0;
     // Sets the target duration for the entire pipeline including the gpu
     virtual void setTotalFrameTargetWorkDuration(Duration targetDuration) = 0;
+    // Reports the workload of the frame about to be composited, before composition starts
+    virtual void setCompositionWorkload(size_t layerCount, size_t blurLayerCount) = 0;
 
     // --- The following methods may run on threads besides SF main ---
     // Send a hint about an upcoming increase in the CPU workload
@@ -111,6 +114,34 @@ public:
 
 namespace impl {
 
+// Online linear model of a frame's work duration from its composition workload, fit with
+// normalized least mean squares after each frame.
+class WorkloadModel {
+public:
+    // A constant term, the layer count, the blur layer count, and whether the gpu composites.
+    static constexpr size_t kFeatureCount = 4;
+    using Features = std::array<float, kFeatureCount>;
+
+    static Features makeFeatures(size_t layerCount, size_t blurLayerCount,
+                                 bool requiresRenderEngine);
+
+    Duration predict(const Features& features) const;
+    void train(const Features& features, Duration actualDuration);
+    // Whether enough frames have been seen for predictions to be meaningful
+    bool isTrained() const { return mTrainingFrameCount >= kMinTrainingFrameCount; }
+
+private:
+    static constexpr float kLearningRate = 0.2f;
+    static constexpr size_t kMinTrainingFrameCount = 30;
+    // Brings the layer count into the range of the other features, which the fit converges
+    // much faster with
+    static constexpr float kLayerCountScale = 16.f;
+
+    // Nanoseconds per unit of each feature
+    Features mWeights = {};
+    size_t mTrainingFrameCount = 0;
+};
+
 // PowerAdvisor is a wrapper around IPower HAL which takes into account the
 // full state of the system when sending out power hints to things like the GPU.
 class PowerAdvisor final : public Hwc2::PowerAdvisor {
@@ -145,6 +176,7 @@ public:
     void setCompositeEnd(TimePoint compositeEndTime) override;
     void setDisplays(std::vector<DisplayId>& displayIds) override;
     void setTotalFrameTargetWorkDuration(Duration targetDuration) override;
+    void setCompositionWorkload(size_t layerCount, size_t blurLayerCount) override;
 
     // --- The following methods may run on threads besides SF main ---
     void notifyCpuLoadUp() override;
@@ -256,6 +288,14 @@ private:
     std::optional<Duration> mTotalFrameTargetDuration;
     // Updated list of display IDs
     std::vector<DisplayId> mDisplayIds;
+    // Forecasts the frame's work duration before composition, so that expensive frames can be
+    // boosted up front instead of a frame late
+    WorkloadModel mWorkloadModel;
+    // Workload and forecast of the frame being composited, if it was reported
+    std::optional<WorkloadModel::Features> mWorkloadFeatures;
+    std::optional<Duration> mPredictedDuration;
+    // Most recent work duration estimated after composition, before the safety margin
+    std::optional<Duration> mLastMeasuredDuration;
 
     // Ensure powerhal connection is initialized
     power::PowerHalController& getPowerHal();
@@ -314,6 +354,11 @@ private:
     // Whether we should send reportActualWorkDuration calls
     static const bool sUseReportActualDuration;
 
+    // Whether to send load up hints for frames forecast to take longer than the last one
+    static const bool sUsePredictiveLoadUpHints;
+    // How much longer than the last frame a frame must be forecast to take to send load up hints
+    static constexpr float kPredictiveLoadUpRatio = 1.2f;
+
     // How long we expect hwc to run after the present call until it waits for the fence
     static constexpr const Duration kFenceWaitStartDelayValidated{150us};
     static constexpr const Duration kFenceWaitStartDelaySkippedValidate{250us};
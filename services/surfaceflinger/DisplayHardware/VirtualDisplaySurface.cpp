@@ -96,6 +96,11 @@ VirtualDisplaySurface::VirtualDisplaySurface(HWComposer& hwc, VirtualDisplayId d
     sink->query(NATIVE_WINDOW_CONSUMER_USAGE_BITS, &sinkUsage);
     mSinkUsage |= (GRALLOC_USAGE_HW_COMPOSER | sinkUsage);
     setOutputUsage(mSinkUsage);
+
+    // The HWC copy only pays off when it spares the video encoder an RGB->YUV conversion. Other
+    // sinks, e.g. screen recording to an ImageReader, consume the GPU output directly.
+    mForceHwcCopy = mForceHwcCopy && (sinkUsage & GRALLOC_USAGE_HW_VIDEO_ENCODER);
+
     if (sinkUsage & (GRALLOC_USAGE_SW_READ_MASK | GRALLOC_USAGE_SW_WRITE_MASK)) {
         int sinkFormat;
         sink->query(NATIVE_WINDOW_FORMAT, &sinkFormat);
@@ -158,7 +163,8 @@ status_t VirtualDisplaySurface::prepareFrame(CompositionType compositionType) {
         // directly to the consumer.
         //
         // On the other hand, when the consumer prefers RGB or can consume RGB
-        // inexpensively, this forces an unnecessary copy.
+        // inexpensively, this forces an unnecessary copy, so it is only done
+        // for sinks that feed a video encoder.
         mCompositionType = CompositionType::Mixed;
     }
 
@@ -236,7 +242,8 @@ status_t VirtualDisplaySurface::advanceFrame(float hdrSdrRatio) {
         }
         // TODO: Correctly propagate the dataspace from GL composition
         result = mHwc.setClientTarget(*halDisplayId, mFbProducerSlot, mFbFence, hwcBuffer,
-                                      ui::Dataspace::UNKNOWN, hdrSdrRatio);
+                                      ui::Dataspace::UNKNOWN, hdrSdrRatio,
+                                      Region::INVALID_REGION);
     }
 
     return result;
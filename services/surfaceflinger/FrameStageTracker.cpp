@@ -0,0 +1,253 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define ATRACE_TAG ATRACE_TAG_GRAPHICS
+
+#include "FrameStageTracker.h"
+
+#include <android-base/stringprintf.h>
+#include <common/trace.h>
+
+#include <algorithm>
+#include <cinttypes>
+
+namespace android {
+
+using base::StringAppendF;
+
+namespace {
+
+constexpr std::array<const char*, FrameStageTracker::kStageCount> kStageCounterNames = {
+        "FrameStage:TransactionFlush", "FrameStage:SnapshotBuild", "FrameStage:InputUpdate",
+        "FrameStage:Composition",      "FrameStage:Release",       "FrameStage:PostComposition",
+};
+
+} // namespace
+
+AllocationCounter::Counts FrameStageTracker::Frame::getTotalAllocations() const {
+    AllocationCounter::Counts total;
+    for (const auto& counts : allocations) {
+        total += counts;
+    }
+    return total;
+}
+
+bool FrameStageTracker::Frame::isSteadyState() const {
+    return durations[static_cast<size_t>(FrameStage::TransactionFlush)] == 0;
+}
+
+const char* FrameStageTracker::stageName(FrameStage stage) {
+    switch (stage) {
+        case FrameStage::TransactionFlush:
+            return "TransactionFlush";
+        case FrameStage::SnapshotBuild:
+            return "SnapshotBuild";
+        case FrameStage::InputUpdate:
+            return "InputUpdate";
+        case FrameStage::Composition:
+            return "Composition";
+        case FrameStage::Release:
+            return "Release";
+        case FrameStage::PostComposition:
+            return "PostComposition";
+    }
+}
+
+void FrameStageTracker::beginFrame(int64_t vsyncId) {
+    mCurrentFrame = Frame{.vsyncId = vsyncId};
+    mFrameStarted = true;
+    AllocationCounter::setEnabled(mAllocationCountingEnabled.load(std::memory_order_relaxed));
+}
+
+void FrameStageTracker::addStageDuration(FrameStage stage, nsecs_t duration) {
+    if (!mFrameStarted) return;
+    mCurrentFrame.durations[static_cast<size_t>(stage)] += duration;
+}
+
+void FrameStageTracker::addStageAllocations(FrameStage stage, AllocationCounter::Counts counts) {
+    if (!mFrameStarted) return;
+    mCurrentFrame.allocations[static_cast<size_t>(stage)] += counts;
+}
+
+void FrameStageTracker::setAllocationCountingEnabled(bool enabled) {
+    mAllocationCountingEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool FrameStageTracker::isAllocationCountingEnabled() const {
+    return mAllocationCountingEnabled.load(std::memory_order_relaxed);
+}
+
+void FrameStageTracker::setAllocationBudget(uint64_t allocations) {
+    mAllocationBudget.store(allocations, std::memory_order_relaxed);
+}
+
+uint64_t FrameStageTracker::getAllocationBudget() const {
+    return mAllocationBudget.load(std::memory_order_relaxed);
+}
+
+void FrameStageTracker::endFrame() {
+    if (!mFrameStarted) return;
+    mFrameStarted = false;
+
+    const size_t index = mFrameCount.load(std::memory_order_relaxed);
+    Slot& slot = mSlots[index % kMaxFrames];
+
+    const uint32_t sequence = slot.sequence.load(std::memory_order_relaxed);
+    slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot.vsyncId.store(mCurrentFrame.vsyncId, std::memory_order_relaxed);
+    for (size_t i = 0; i < kStageCount; i++) {
+        slot.durations[i].store(mCurrentFrame.durations[i], std::memory_order_relaxed);
+        slot.allocations[i].store(mCurrentFrame.allocations[i].allocations,
+                                  std::memory_order_relaxed);
+        slot.allocatedBytes[i].store(mCurrentFrame.allocations[i].bytes,
+                                     std::memory_order_relaxed);
+    }
+
+    slot.sequence.store(sequence + 2, std::memory_order_release);
+    mFrameCount.store(index + 1, std::memory_order_release);
+
+    for (size_t i = 0; i < kStageCount; i++) {
+        SFTRACE_INT64(kStageCounterNames[i], mCurrentFrame.durations[i]);
+    }
+}
+
+std::vector<FrameStageTracker::Frame> FrameStageTracker::getFrames() const {
+    const size_t count = mFrameCount.load(std::memory_order_acquire);
+    const size_t size = std::min(count, kMaxFrames);
+
+    std::vector<Frame> frames;
+    frames.reserve(size);
+
+    for (size_t index = count - size; index < count; index++) {
+        const Slot& slot = mSlots[index % kMaxFrames];
+
+        const uint32_t sequence = slot.sequence.load(std::memory_order_acquire);
+        if (sequence % 2 != 0) continue;
+
+        Frame frame{.vsyncId = slot.vsyncId.load(std::memory_order_relaxed)};
+        for (size_t i = 0; i < kStageCount; i++) {
+            frame.durations[i] = slot.durations[i].load(std::memory_order_relaxed);
+            frame.allocations[i] = {slot.allocations[i].load(std::memory_order_relaxed),
+                                    slot.allocatedBytes[i].load(std::memory_order_relaxed)};
+        }
+
+        // Skip the slot if the main thread lapped this reader while it was being copied.
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != sequence) continue;
+
+        frames.push_back(frame);
+    }
+
+    return frames;
+}
+
+std::vector<FrameStageTracker::Frame> FrameStageTracker::getFramesOverAllocationBudget() const {
+    const uint64_t budget = getAllocationBudget();
+    auto frames = getFrames();
+    std::erase_if(frames, [budget](const Frame& frame) {
+        return !frame.isSteadyState() || frame.getTotalAllocations().allocations <= budget;
+    });
+    return frames;
+}
+
+void FrameStageTracker::dump(std::string& result) const {
+    const auto frames = getFrames();
+    StringAppendF(&result, "Frame stages (%zu frames, ms):\n", frames.size());
+    if (frames.empty()) return;
+
+    std::array<nsecs_t, kStageCount> totals{};
+    std::array<nsecs_t, kStageCount> maxima{};
+    for (const auto& frame : frames) {
+        for (size_t i = 0; i < kStageCount; i++) {
+            totals[i] += frame.durations[i];
+            maxima[i] = std::max(maxima[i], frame.durations[i]);
+        }
+    }
+
+    for (size_t i = 0; i < kStageCount; i++) {
+        StringAppendF(&result, "  %-16s avg=%.3f max=%.3f\n",
+                      stageName(static_cast<FrameStage>(i)),
+                      ns2us(totals[i] / static_cast<nsecs_t>(frames.size())) / 1000.f,
+                      ns2us(maxima[i]) / 1000.f);
+    }
+
+    result.append("\n  vsyncId");
+    for (size_t i = 0; i < kStageCount; i++) {
+        StringAppendF(&result, " %s", stageName(static_cast<FrameStage>(i)));
+    }
+    result.append("\n");
+
+    for (const auto& frame : frames) {
+        StringAppendF(&result, "  %" PRId64, frame.vsyncId);
+        for (const nsecs_t duration : frame.durations) {
+            StringAppendF(&result, " %.3f", ns2us(duration) / 1000.f);
+        }
+        result.append("\n");
+    }
+
+    dumpAllocations(result, frames);
+}
+
+void FrameStageTracker::dumpAllocations(std::string& result,
+                                        const std::vector<Frame>& frames) const {
+    StringAppendF(&result, "\nAllocation counting: %s\n",
+                  isAllocationCountingEnabled() ? "enabled" : "disabled");
+
+    std::array<AllocationCounter::Counts, kStageCount> totals{};
+    std::array<uint64_t, kStageCount> maxima{};
+    std::vector<uint64_t> steadyStateAllocations;
+    for (const auto& frame : frames) {
+        for (size_t i = 0; i < kStageCount; i++) {
+            totals[i] += frame.allocations[i];
+            maxima[i] = std::max(maxima[i], frame.allocations[i].allocations);
+        }
+        if (frame.isSteadyState()) {
+            steadyStateAllocations.push_back(frame.getTotalAllocations().allocations);
+        }
+    }
+
+    if (std::all_of(totals.begin(), totals.end(),
+                    [](const auto& counts) { return counts.allocations == 0; })) {
+        return;
+    }
+
+    const uint64_t frameCount = frames.size();
+    for (size_t i = 0; i < kStageCount; i++) {
+        StringAppendF(&result, "  %-16s avg=%" PRIu64 " (%" PRIu64 " bytes) max=%" PRIu64 "\n",
+                      stageName(static_cast<FrameStage>(i)), totals[i].allocations / frameCount,
+                      totals[i].bytes / frameCount, maxima[i]);
+    }
+
+    const uint64_t budget = getAllocationBudget();
+    const auto overBudget = static_cast<size_t>(
+            std::count_if(steadyStateAllocations.begin(), steadyStateAllocations.end(),
+                          [budget](uint64_t allocations) { return allocations > budget; }));
+    uint64_t median = 0;
+    if (!steadyStateAllocations.empty()) {
+        const auto middle = steadyStateAllocations.begin() +
+                static_cast<std::ptrdiff_t>(steadyStateAllocations.size() / 2);
+        std::nth_element(steadyStateAllocations.begin(), middle, steadyStateAllocations.end());
+        median = *middle;
+    }
+    StringAppendF(&result,
+                  "  Steady state frames: %zu, median allocations=%" PRIu64 ", budget=%" PRIu64
+                  ", over budget: %zu\n",
+                  steadyStateAllocations.size(), median, budget, overBudget);
+}
+
+} // namespace android
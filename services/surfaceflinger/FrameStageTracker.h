@@ -0,0 +1,139 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <utils/Timers.h>
+
+#include "AllocationCounter.h"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace android {
+
+// Main thread stages of a SurfaceFlinger frame, in the order they run.
+enum class FrameStage : size_t {
+    TransactionFlush,
+    SnapshotBuild,
+    InputUpdate,
+    Composition,
+    Release,
+    PostComposition,
+};
+
+// FrameStageTracker records how long each FrameStage of the most recent frames took on the main
+// thread. The main thread is the only writer; dump() may be called from any thread without
+// blocking it. Each frame is written into a slot of a fixed-size ring guarded by a sequence count,
+// so a reader skips a slot that is being overwritten rather than reporting a torn frame.
+//
+// When allocation counting is enabled, the tracker also attributes the main thread's allocations
+// to the stages, and reports how many of the recorded frames exceeded the per-frame allocation
+// budget in steady state, i.e. frames that did not flush any transaction.
+class FrameStageTracker {
+public:
+    static constexpr size_t kStageCount = static_cast<size_t>(FrameStage::PostComposition) + 1;
+    static constexpr size_t kMaxFrames = 128;
+
+    struct Frame {
+        int64_t vsyncId = 0;
+        std::array<nsecs_t, kStageCount> durations{};
+        std::array<AllocationCounter::Counts, kStageCount> allocations{};
+
+        AllocationCounter::Counts getTotalAllocations() const;
+        bool isSteadyState() const;
+    };
+
+    // Measures the enclosing scope and adds it to the given stage of the current frame.
+    class ScopedStage {
+    public:
+        ScopedStage(FrameStageTracker& tracker, FrameStage stage)
+              : mTracker(tracker),
+                mStage(stage),
+                mStart(systemTime()),
+                mStartAllocations(AllocationCounter::getCounts()) {}
+        ~ScopedStage() {
+            mTracker.addStageDuration(mStage, systemTime() - mStart);
+            mTracker.addStageAllocations(mStage,
+                                         AllocationCounter::getCounts() - mStartAllocations);
+        }
+
+        ScopedStage(const ScopedStage&) = delete;
+        ScopedStage& operator=(const ScopedStage&) = delete;
+
+    private:
+        FrameStageTracker& mTracker;
+        const FrameStage mStage;
+        const nsecs_t mStart;
+        const AllocationCounter::Counts mStartAllocations;
+    };
+
+    // Starts a new frame. Durations recorded until the next call to endFrame() are attributed to
+    // it. A frame that was not ended, e.g. because commit bailed out early, is discarded.
+    void beginFrame(int64_t vsyncId);
+
+    void addStageDuration(FrameStage, nsecs_t duration);
+    void addStageAllocations(FrameStage, AllocationCounter::Counts);
+
+    // Counting takes effect for the thread that begins the next frame. May be called from any
+    // thread.
+    void setAllocationCountingEnabled(bool enabled);
+    bool isAllocationCountingEnabled() const;
+
+    // The number of allocations a steady state frame is expected to stay within.
+    void setAllocationBudget(uint64_t allocations);
+    uint64_t getAllocationBudget() const;
+
+    // Publishes the current frame to the ring and emits the per-stage trace counters.
+    void endFrame();
+
+    // Returns the published frames, oldest first.
+    std::vector<Frame> getFrames() const;
+
+    // Returns the steady state frames whose allocations exceeded the budget.
+    std::vector<Frame> getFramesOverAllocationBudget() const;
+
+    void dump(std::string& result) const;
+
+    static const char* stageName(FrameStage);
+
+private:
+    struct Slot {
+        // Odd while the main thread is writing the slot.
+        std::atomic<uint32_t> sequence = 0;
+        std::atomic<int64_t> vsyncId = 0;
+        std::array<std::atomic<nsecs_t>, kStageCount> durations{};
+        std::array<std::atomic<uint64_t>, kStageCount> allocations{};
+        std::array<std::atomic<uint64_t>, kStageCount> allocatedBytes{};
+    };
+
+    void dumpAllocations(std::string& result, const std::vector<Frame>&) const;
+
+    Frame mCurrentFrame;
+    bool mFrameStarted = false;
+
+    std::array<Slot, kMaxFrames> mSlots;
+    std::atomic<size_t> mFrameCount = 0;
+
+    std::atomic<bool> mAllocationCountingEnabled = false;
+    std::atomic<uint64_t> mAllocationBudget = 0;
+};
+
+} // namespace android
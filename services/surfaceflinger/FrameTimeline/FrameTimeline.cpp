@@ -25,11 +25,13 @@
 #include <common/trace.h>
 #include <utils/Log.h>
 
+#include <algorithm>
 #include <chrono>
 #include <cinttypes>
 #include <numeric>
 #include <unordered_set>
 
+#include "../BackgroundExecutor.h"
 #include "../Jank/JankTracker.h"
 
 namespace android::frametimeline {
@@ -335,9 +337,43 @@ int64_t TraceCookieCounter::getCookieForTracing() {
     return ++mTraceCookie;
 }
 
+std::shared_ptr<const std::string> LayerNameInterner::intern(const std::string& name) {
+    std::scoped_lock lock(mMutex);
+    auto& entry = mNames[name];
+    if (auto interned = entry.lock()) {
+        return interned;
+    }
+
+    auto interned = std::make_shared<const std::string>(name);
+    entry = interned;
+
+    if (mNames.size() >= mPurgeThreshold) {
+        purgeUnusedLocked();
+        mPurgeThreshold = std::max(kMinPurgeThreshold, mNames.size() * 2);
+    }
+    return interned;
+}
+
+size_t LayerNameInterner::size() const {
+    std::scoped_lock lock(mMutex);
+    return mNames.size();
+}
+
+void LayerNameInterner::purgeUnusedLocked() {
+    for (auto it = mNames.begin(); it != mNames.end();) {
+        if (it->second.expired()) {
+            it = mNames.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
 SurfaceFrame::SurfaceFrame(const FrameTimelineInfo& frameTimelineInfo, pid_t ownerPid,
-                           uid_t ownerUid, int32_t layerId, std::string layerName,
-                           std::string debugName, PredictionState predictionState,
+                           uid_t ownerUid, int32_t layerId,
+                           std::shared_ptr<const std::string> layerName,
+                           std::shared_ptr<const std::string> debugName,
+                           PredictionState predictionState,
                            frametimeline::TimelineItem&& predictions,
                            std::shared_ptr<TimeStats> timeStats,
                            JankClassificationThresholds thresholds,
@@ -388,7 +424,7 @@ void SurfaceFrame::setPresentState(PresentState presentState, nsecs_t lastLatchT
     LOG_ALWAYS_FATAL_IF(mPresentState != PresentState::Unknown,
                         "setPresentState called on a SurfaceFrame from Layer - %s, that has a "
                         "PresentState - %s set already.",
-                        mDebugName.c_str(), toString(mPresentState).c_str());
+                        mDebugName->c_str(), toString(mPresentState).c_str());
     mPresentState = presentState;
     mLastLatchTime = lastLatchTime;
 }
@@ -485,7 +521,7 @@ void SurfaceFrame::promoteToBuffer() {
     LOG_ALWAYS_FATAL_IF(mIsBuffer == true,
                         "Trying to promote an already promoted BufferSurfaceFrame from layer %s "
                         "with token %" PRId64 "",
-                        mDebugName.c_str(), mToken);
+                        mDebugName->c_str(), mToken);
     mIsBuffer = true;
 }
 
@@ -497,7 +533,7 @@ bool SurfaceFrame::getIsBuffer() const {
 void SurfaceFrame::dump(std::string& result, const std::string& indent, nsecs_t baseTime) const {
     std::scoped_lock lock(mMutex);
     StringAppendF(&result, "%s", indent.c_str());
-    StringAppendF(&result, "Layer - %s", mDebugName.c_str());
+    StringAppendF(&result, "Layer - %s", mDebugName->c_str());
     if (mJankType != JankType::None) {
         // Easily identify a janky Surface Frame in the dump
         StringAppendF(&result, " [*] ");
@@ -548,7 +584,7 @@ void SurfaceFrame::dump(std::string& result, const std::string& indent, nsecs_t
 std::string SurfaceFrame::miniDump() const {
     std::scoped_lock lock(mMutex);
     std::string result;
-    StringAppendF(&result, "Layer - %s\n", mDebugName.c_str());
+    StringAppendF(&result, "Layer - %s\n", mDebugName->c_str());
     StringAppendF(&result, "Token: %" PRId64 "\n", mToken);
     StringAppendF(&result, "Is Buffer?: %d\n", mIsBuffer);
     StringAppendF(&result, "Present State : %s\n", toString(mPresentState).c_str());
@@ -700,7 +736,7 @@ void SurfaceFrame::onPresent(nsecs_t presentTime, int32_t displayFrameJankType,
 
     if (mPredictionState != PredictionState::None) {
         // Only update janky frames if the app used vsync predictions
-        mTimeStats->incrementJankyFrames({refreshRate, mRenderRate, mOwnerUid, mLayerName,
+        mTimeStats->incrementJankyFrames({refreshRate, mRenderRate, mOwnerUid, *mLayerName,
                                           mGameMode, mJankType, displayDeadlineDelta,
                                           displayPresentDelta, deadlineDelta});
 
@@ -766,7 +802,7 @@ void SurfaceFrame::tracePredictions(int64_t displayFrameToken, nsecs_t monoBootO
         expectedSurfaceFrameStartEvent->set_display_frame_token(displayFrameToken);
 
         expectedSurfaceFrameStartEvent->set_pid(mOwnerPid);
-        expectedSurfaceFrameStartEvent->set_layer_name(mDebugName);
+        expectedSurfaceFrameStartEvent->set_layer_name(*mDebugName);
     });
 
     if (traced) {
@@ -827,7 +863,7 @@ void SurfaceFrame::traceActuals(int64_t displayFrameToken, nsecs_t monoBootOffse
         actualSurfaceFrameStartEvent->set_display_frame_token(displayFrameToken);
 
         actualSurfaceFrameStartEvent->set_pid(mOwnerPid);
-        actualSurfaceFrameStartEvent->set_layer_name(mDebugName);
+        actualSurfaceFrameStartEvent->set_layer_name(*mDebugName);
 
         if (mPresentState == PresentState::Dropped) {
             actualSurfaceFrameStartEvent->set_present_type(FrameTimelineEvent::PRESENT_DROPPED);
@@ -907,11 +943,12 @@ std::optional<TimelineItem> TokenManager::getPredictionsForToken(int64_t token)
 
 FrameTimeline::FrameTimeline(std::shared_ptr<TimeStats> timeStats, pid_t surfaceFlingerPid,
                              JankClassificationThresholds thresholds, bool useBootTimeClock,
-                             bool filterFramesBeforeTraceStarts)
+                             bool filterFramesBeforeTraceStarts, bool classifyJankInBackground)
       : mUseBootTimeClock(useBootTimeClock),
         mFilterFramesBeforeTraceStarts(
                 FlagManager::getInstance().filter_frames_before_trace_starts() &&
                 filterFramesBeforeTraceStarts),
+        mClassifyJankInBackground(classifyJankInBackground),
         mMaxDisplayFrames(kDefaultMaxDisplayFrames),
         mTimeStats(std::move(timeStats)),
         mSurfaceFlingerPid(surfaceFlingerPid),
@@ -920,6 +957,13 @@ FrameTimeline::FrameTimeline(std::shared_ptr<TimeStats> timeStats, pid_t surface
             std::make_shared<DisplayFrame>(mTimeStats, thresholds, &mTraceCookieCounter);
 }
 
+FrameTimeline::~FrameTimeline() {
+    if (mClassifyJankInBackground) {
+        // A queued flush refers to this FrameTimeline, so wait for it to run.
+        BackgroundExecutor::getLowPriorityInstance().flushQueue();
+    }
+}
+
 void FrameTimeline::onBootFinished() {
     perfetto::TracingInitArgs args;
     args.backends = perfetto::kSystemBackend;
@@ -935,11 +979,15 @@ void FrameTimeline::registerDataSource() {
 
 std::shared_ptr<SurfaceFrame> FrameTimeline::createSurfaceFrameForToken(
         const FrameTimelineInfo& frameTimelineInfo, pid_t ownerPid, uid_t ownerUid, int32_t layerId,
-        std::string layerName, std::string debugName, bool isBuffer, GameMode gameMode) {
+        const std::string& layerName, const std::string& debugName, bool isBuffer,
+        GameMode gameMode) {
     SFTRACE_CALL();
+    auto internedLayerName = mLayerNames.intern(layerName);
+    auto internedDebugName = mLayerNames.intern(debugName);
+
     if (frameTimelineInfo.vsyncId == FrameTimelineInfo::INVALID_VSYNC_ID) {
         return std::make_shared<SurfaceFrame>(frameTimelineInfo, ownerPid, ownerUid, layerId,
-                                              std::move(layerName), std::move(debugName),
+                                              internedLayerName, internedDebugName,
                                               PredictionState::None, TimelineItem(), mTimeStats,
                                               mJankClassificationThresholds, &mTraceCookieCounter,
                                               isBuffer, gameMode);
@@ -948,13 +996,13 @@ std::shared_ptr<SurfaceFrame> FrameTimeline::createSurfaceFrameForToken(
             mTokenManager.getPredictionsForToken(frameTimelineInfo.vsyncId);
     if (predictions) {
         return std::make_shared<SurfaceFrame>(frameTimelineInfo, ownerPid, ownerUid, layerId,
-                                              std::move(layerName), std::move(debugName),
+                                              internedLayerName, internedDebugName,
                                               PredictionState::Valid, std::move(*predictions),
                                               mTimeStats, mJankClassificationThresholds,
                                               &mTraceCookieCounter, isBuffer, gameMode);
     }
     return std::make_shared<SurfaceFrame>(frameTimelineInfo, ownerPid, ownerUid, layerId,
-                                          std::move(layerName), std::move(debugName),
+                                          internedLayerName, internedDebugName,
                                           PredictionState::Expired, TimelineItem(), mTimeStats,
                                           mJankClassificationThresholds, &mTraceCookieCounter,
                                           isBuffer, gameMode);
@@ -989,12 +1037,47 @@ void FrameTimeline::setSfPresent(nsecs_t sfPresentTime,
                                  const std::shared_ptr<FenceTime>& presentFence,
                                  const std::shared_ptr<FenceTime>& gpuFence) {
     SFTRACE_CALL();
+    std::shared_ptr<DisplayFrame> displayFrame;
+    {
+        std::scoped_lock lock(mMutex);
+        mCurrentDisplayFrame->setActualEndTime(sfPresentTime);
+        mCurrentDisplayFrame->setGpuFence(gpuFence);
+        if (!mClassifyJankInBackground) {
+            mPendingPresentFences.emplace_back(std::make_pair(presentFence, mCurrentDisplayFrame));
+            flushPendingPresentFences();
+            finalizeCurrentDisplayFrame();
+            return;
+        }
+
+        // The display frame is handed to the BackgroundExecutor, and only added to mDisplayFrames
+        // once presented.
+        displayFrame = std::move(mCurrentDisplayFrame);
+        mCurrentDisplayFrame = std::make_shared<DisplayFrame>(mTimeStats,
+                                                              mJankClassificationThresholds,
+                                                              &mTraceCookieCounter);
+    }
+
+    BackgroundExecutor::getLowPriorityInstance().sendCallbacks(
+            {[this, presentFence, displayFrame = std::move(displayFrame)]() mutable {
+                presentInBackground(std::move(presentFence), std::move(displayFrame));
+            }});
+}
+
+void FrameTimeline::presentInBackground(std::shared_ptr<FenceTime> presentFence,
+                                        std::shared_ptr<DisplayFrame> displayFrame) {
+    SFTRACE_CALL();
+    mBackgroundPendingPresentFences.emplace_back(std::move(presentFence), std::move(displayFrame));
+
+    std::vector<std::shared_ptr<DisplayFrame>> presentedFrames;
+    presentSignaledDisplayFrames(mBackgroundPendingPresentFences, &presentedFrames);
+    if (presentedFrames.empty()) {
+        return;
+    }
+
     std::scoped_lock lock(mMutex);
-    mCurrentDisplayFrame->setActualEndTime(sfPresentTime);
-    mCurrentDisplayFrame->setGpuFence(gpuFence);
-    mPendingPresentFences.emplace_back(std::make_pair(presentFence, mCurrentDisplayFrame));
-    flushPendingPresentFences();
-    finalizeCurrentDisplayFrame();
+    for (auto& presentedFrame : presentedFrames) {
+        addDisplayFrame(std::move(presentedFrame));
+    }
 }
 
 void FrameTimeline::onCommitNotComposited() {
@@ -1456,9 +1539,10 @@ float FrameTimeline::computeFps(const std::unordered_set<int32_t>& layerIds) {
             static_cast<float>(totalPresentToPresentWalls);
 }
 
-std::optional<size_t> FrameTimeline::getFirstSignalFenceIndex() const {
-    for (size_t i = 0; i < mPendingPresentFences.size(); i++) {
-        const auto& [fence, _] = mPendingPresentFences[i];
+std::optional<size_t> FrameTimeline::getFirstSignalFenceIndex(
+        const PendingPresentFences& pendingPresentFences) {
+    for (size_t i = 0; i < pendingPresentFences.size(); i++) {
+        const auto& [fence, _] = pendingPresentFences[i];
         if (fence && fence->getSignalTime() != Fence::SIGNAL_TIME_PENDING) {
             return i;
         }
@@ -1468,7 +1552,13 @@ std::optional<size_t> FrameTimeline::getFirstSignalFenceIndex() const {
 }
 
 void FrameTimeline::flushPendingPresentFences() {
-    const auto firstSignaledFence = getFirstSignalFenceIndex();
+    presentSignaledDisplayFrames(mPendingPresentFences);
+}
+
+void FrameTimeline::presentSignaledDisplayFrames(
+        PendingPresentFences& pendingPresentFences,
+        std::vector<std::shared_ptr<DisplayFrame>>* presentedFrames) {
+    const auto firstSignaledFence = getFirstSignalFenceIndex(pendingPresentFences);
     if (!firstSignaledFence.has_value()) {
         return;
     }
@@ -1482,18 +1572,21 @@ void FrameTimeline::flushPendingPresentFences() {
     // Present fences are expected to be signaled in order. Mark all the previous
     // pending fences as errors.
     for (size_t i = 0; i < firstSignaledFence.value(); i++) {
-        const auto& pendingPresentFence = *mPendingPresentFences.begin();
+        const auto& pendingPresentFence = *pendingPresentFences.begin();
         const nsecs_t signalTime = Fence::SIGNAL_TIME_INVALID;
         auto& displayFrame = pendingPresentFence.second;
         displayFrame->onPresent(signalTime, mPreviousActualPresentTime);
         mPreviousPredictionPresentTime =
                 displayFrame->trace(mSurfaceFlingerPid, monoBootOffset,
                                     mPreviousPredictionPresentTime, mFilterFramesBeforeTraceStarts);
-        mPendingPresentFences.erase(mPendingPresentFences.begin());
+        if (presentedFrames) {
+            presentedFrames->push_back(displayFrame);
+        }
+        pendingPresentFences.erase(pendingPresentFences.begin());
     }
 
-    for (size_t i = 0; i < mPendingPresentFences.size(); i++) {
-        const auto& pendingPresentFence = mPendingPresentFences[i];
+    for (size_t i = 0; i < pendingPresentFences.size(); i++) {
+        const auto& pendingPresentFence = pendingPresentFences[i];
         nsecs_t signalTime = Fence::SIGNAL_TIME_INVALID;
         if (pendingPresentFence.first && pendingPresentFence.first->isValid()) {
             signalTime = pendingPresentFence.first->getSignalTime();
@@ -1508,21 +1601,27 @@ void FrameTimeline::flushPendingPresentFences() {
                 displayFrame->trace(mSurfaceFlingerPid, monoBootOffset,
                                     mPreviousPredictionPresentTime, mFilterFramesBeforeTraceStarts);
         mPreviousActualPresentTime = signalTime;
+        if (presentedFrames) {
+            presentedFrames->push_back(displayFrame);
+        }
 
-        mPendingPresentFences.erase(mPendingPresentFences.begin() + static_cast<int>(i));
+        pendingPresentFences.erase(pendingPresentFences.begin() + static_cast<int>(i));
         --i;
     }
 }
 
 void FrameTimeline::finalizeCurrentDisplayFrame() {
+    addDisplayFrame(std::move(mCurrentDisplayFrame));
+    mCurrentDisplayFrame = std::make_shared<DisplayFrame>(mTimeStats, mJankClassificationThresholds,
+                                                          &mTraceCookieCounter);
+}
+
+void FrameTimeline::addDisplayFrame(std::shared_ptr<DisplayFrame> displayFrame) {
     while (mDisplayFrames.size() >= mMaxDisplayFrames) {
         // We maintain only a fixed number of frames' data. Pop older frames
         mDisplayFrames.pop_front();
     }
-    mDisplayFrames.push_back(mCurrentDisplayFrame);
-    mCurrentDisplayFrame.reset();
-    mCurrentDisplayFrame = std::make_shared<DisplayFrame>(mTimeStats, mJankClassificationThresholds,
-                                                          &mTraceCookieCounter);
+    mDisplayFrames.push_back(std::move(displayFrame));
 }
 
 nsecs_t FrameTimeline::DisplayFrame::getBaseTime() const {
@@ -1625,12 +1724,19 @@ void FrameTimeline::parseArgs(const Vector<String16>& args, std::string& result)
 }
 
 void FrameTimeline::setMaxDisplayFrames(uint32_t size) {
-    std::scoped_lock lock(mMutex);
+    {
+        std::scoped_lock lock(mMutex);
 
-    // The size can either increase or decrease, clear everything, to be consistent
-    mDisplayFrames.clear();
-    mPendingPresentFences.clear();
-    mMaxDisplayFrames = size;
+        // The size can either increase or decrease, clear everything, to be consistent
+        mDisplayFrames.clear();
+        mPendingPresentFences.clear();
+        mMaxDisplayFrames = size;
+    }
+
+    if (mClassifyJankInBackground) {
+        BackgroundExecutor::getLowPriorityInstance().sendCallbacks(
+                {[this]() { mBackgroundPendingPresentFences.clear(); }});
+    }
 }
 
 void FrameTimeline::reset() {
@@ -23,6 +23,7 @@
 #include <mutex>
 #include <optional>
 #include <string>
+#include <unordered_map>
 
 #include <gui/ISurfaceComposer.h>
 #include <gui/JankInfo.h>
@@ -148,6 +149,28 @@ private:
     std::atomic<int64_t> mTraceCookie = 0;
 };
 
+/*
+ * Interns the names of the layers that SurfaceFrames are created for. A layer creates a
+ * SurfaceFrame for every buffer and transaction, so sharing one copy of its names between them
+ * avoids two string allocations per frame. Names are dropped once no SurfaceFrame refers to them.
+ */
+class LayerNameInterner {
+public:
+    std::shared_ptr<const std::string> intern(const std::string& name) EXCLUDES(mMutex);
+
+    // Number of names tracked, including the ones that are no longer used but not purged yet.
+    size_t size() const EXCLUDES(mMutex);
+
+private:
+    void purgeUnusedLocked() REQUIRES(mMutex);
+
+    static constexpr size_t kMinPurgeThreshold = 64;
+
+    mutable std::mutex mMutex;
+    std::unordered_map<std::string, std::weak_ptr<const std::string>> mNames GUARDED_BY(mMutex);
+    size_t mPurgeThreshold GUARDED_BY(mMutex) = kMinPurgeThreshold;
+};
+
 class SurfaceFrame {
 public:
     enum class PresentState {
@@ -159,10 +182,11 @@ public:
     // Only FrameTimeline can construct a SurfaceFrame as it provides Predictions(through
     // TokenManager), Thresholds and TimeStats pointer.
     SurfaceFrame(const FrameTimelineInfo& frameTimelineInfo, pid_t ownerPid, uid_t ownerUid,
-                 int32_t layerId, std::string layerName, std::string debugName,
-                 PredictionState predictionState, TimelineItem&& predictions,
-                 std::shared_ptr<TimeStats> timeStats, JankClassificationThresholds thresholds,
-                 TraceCookieCounter* traceCookieCounter, bool isBuffer, GameMode);
+                 int32_t layerId, std::shared_ptr<const std::string> layerName,
+                 std::shared_ptr<const std::string> debugName, PredictionState predictionState,
+                 TimelineItem&& predictions, std::shared_ptr<TimeStats> timeStats,
+                 JankClassificationThresholds thresholds, TraceCookieCounter* traceCookieCounter,
+                 bool isBuffer, GameMode);
     ~SurfaceFrame() = default;
 
     bool isSelfJanky() const;
@@ -246,8 +270,8 @@ private:
     const int32_t mInputEventId;
     const pid_t mOwnerPid;
     const uid_t mOwnerUid;
-    const std::string mLayerName;
-    const std::string mDebugName;
+    const std::shared_ptr<const std::string> mLayerName;
+    const std::shared_ptr<const std::string> mDebugName;
     const int32_t mLayerId;
     PresentState mPresentState GUARDED_BY(mMutex);
     const PredictionState mPredictionState;
@@ -304,8 +328,8 @@ public:
     // Debug name is the human-readable debugging string for dumpsys.
     virtual std::shared_ptr<SurfaceFrame> createSurfaceFrameForToken(
             const FrameTimelineInfo& frameTimelineInfo, pid_t ownerPid, uid_t ownerUid,
-            int32_t layerId, std::string layerName, std::string debugName, bool isBuffer,
-            GameMode) = 0;
+            int32_t layerId, const std::string& layerName, const std::string& debugName,
+            bool isBuffer, GameMode) = 0;
 
     // Adds a new SurfaceFrame to the current DisplayFrame. Frames from multiple layers can be
     // composited into one display frame.
@@ -483,16 +507,19 @@ public:
         TraceCookieCounter& mTraceCookieCounter;
     };
 
+    // If classifyJankInBackground is set, present fences that signaled are processed on the low
+    // priority BackgroundExecutor instead of in setSfPresent, so that jank classification, jank
+    // reporting and tracing of presented frames stay off the main thread.
     FrameTimeline(std::shared_ptr<TimeStats> timeStats, pid_t surfaceFlingerPid,
                   JankClassificationThresholds thresholds = {}, bool useBootTimeClock = true,
-                  bool filterFramesBeforeTraceStarts = true);
-    ~FrameTimeline() = default;
+                  bool filterFramesBeforeTraceStarts = true, bool classifyJankInBackground = false);
+    ~FrameTimeline();
 
     frametimeline::TokenManager* getTokenManager() override { return &mTokenManager; }
     std::shared_ptr<SurfaceFrame> createSurfaceFrameForToken(
             const FrameTimelineInfo& frameTimelineInfo, pid_t ownerPid, uid_t ownerUid,
-            int32_t layerId, std::string layerName, std::string debugName, bool isBuffer,
-            GameMode) override;
+            int32_t layerId, const std::string& layerName, const std::string& debugName,
+            bool isBuffer, GameMode) override;
     void addSurfaceFrame(std::shared_ptr<frametimeline::SurfaceFrame> surfaceFrame) override;
     void setSfWakeUp(int64_t token, nsecs_t wakeupTime, Fps refreshRate, Fps renderRate) override;
     void setSfPresent(nsecs_t sfPresentTime, const std::shared_ptr<FenceTime>& presentFence,
@@ -515,22 +542,40 @@ private:
     // Friend class for testing
     friend class android::frametimeline::FrameTimelineTest;
 
+    using PendingPresentFences =
+            std::vector<std::pair<std::shared_ptr<FenceTime>, std::shared_ptr<DisplayFrame>>>;
+
     void flushPendingPresentFences() REQUIRES(mMutex);
-    std::optional<size_t> getFirstSignalFenceIndex() const REQUIRES(mMutex);
+    // Presents the display frames of the leading signaled fences, and removes them from the list.
+    // The presented display frames are appended to presentedFrames, if set.
+    void presentSignaledDisplayFrames(
+            PendingPresentFences& pendingPresentFences,
+            std::vector<std::shared_ptr<DisplayFrame>>* presentedFrames = nullptr);
+    // Runs on the BackgroundExecutor: presents the display frames whose fences signaled, and only
+    // then adds them to the display frames, so that they are not touched outside mMutex once
+    // others can see them.
+    void presentInBackground(std::shared_ptr<FenceTime> presentFence,
+                             std::shared_ptr<DisplayFrame> displayFrame) EXCLUDES(mMutex);
+    static std::optional<size_t> getFirstSignalFenceIndex(
+            const PendingPresentFences& pendingPresentFences);
     void finalizeCurrentDisplayFrame() REQUIRES(mMutex);
+    void addDisplayFrame(std::shared_ptr<DisplayFrame> displayFrame) REQUIRES(mMutex);
     void dumpAll(std::string& result);
     void dumpJank(std::string& result);
 
     // Sliding window of display frames. TODO(b/168072834): compare perf with fixed size array
     std::deque<std::shared_ptr<DisplayFrame>> mDisplayFrames GUARDED_BY(mMutex);
-    std::vector<std::pair<std::shared_ptr<FenceTime>, std::shared_ptr<DisplayFrame>>>
-            mPendingPresentFences GUARDED_BY(mMutex);
+    PendingPresentFences mPendingPresentFences GUARDED_BY(mMutex);
+    // The pending present fences of classifyJankInBackground. Only used on the BackgroundExecutor.
+    PendingPresentFences mBackgroundPendingPresentFences;
     std::shared_ptr<DisplayFrame> mCurrentDisplayFrame GUARDED_BY(mMutex);
     TokenManager mTokenManager;
     TraceCookieCounter mTraceCookieCounter;
+    LayerNameInterner mLayerNames;
     mutable std::mutex mMutex;
     const bool mUseBootTimeClock;
     const bool mFilterFramesBeforeTraceStarts;
+    const bool mClassifyJankInBackground;
     uint32_t mMaxDisplayFrames;
     std::shared_ptr<TimeStats> mTimeStats;
     const pid_t mSurfaceFlingerPid;
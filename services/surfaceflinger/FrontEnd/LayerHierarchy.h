@@ -18,6 +18,7 @@
 
 #include "FrontEnd/LayerCreationArgs.h"
 #include "FrontEnd/LayerLifecycleManager.h"
+#include "FrontEnd/SlabAllocator.h"
 #include "RequestedLayerState.h"
 #include "ftl/small_vector.h"
 
@@ -133,6 +134,10 @@ public:
         TraversalPath mParentPath;
     };
     LayerHierarchy(RequestedLayerState* layer);
+    static void* operator new(size_t size) { return SlabAllocator<LayerHierarchy>::allocate(size); }
+    static void operator delete(void* ptr, size_t size) {
+        SlabAllocator<LayerHierarchy>::deallocate(ptr, size);
+    }
 
     // Visitor function that provides the hierarchy node and a traversal id which uniquely
     // identifies how was visited. The hierarchy contains a pointer to the RequestedLayerState.
@@ -21,6 +21,7 @@
 #include "DisplayHardware/ComposerHal.h"
 #include "LayerHierarchy.h"
 #include "RequestedLayerState.h"
+#include "SlabAllocator.h"
 #include "Scheduler/LayerInfo.h"
 #include "android-base/stringprintf.h"
 
@@ -47,6 +48,10 @@ struct RoundedCornerState {
 struct LayerSnapshot : public compositionengine::LayerFECompositionState {
     LayerSnapshot() = default;
     LayerSnapshot(const RequestedLayerState&, const LayerHierarchy::TraversalPath&);
+    static void* operator new(size_t size) { return SlabAllocator<LayerSnapshot>::allocate(size); }
+    static void operator delete(void* ptr, size_t size) {
+        SlabAllocator<LayerSnapshot>::deallocate(ptr, size);
+    }
 
     LayerHierarchy::TraversalPath path;
     size_t globalZ = std::numeric_limits<ssize_t>::max();
@@ -55,6 +60,9 @@ struct LayerSnapshot : public compositionengine::LayerFECompositionState {
     bool isHiddenByPolicyFromRelativeParent = false;
     ftl::Flags<RequestedLayerState::Changes> changes;
     uint64_t clientChanges = 0;
+    // Id of the last LayerSnapshotBuilder update that changed this snapshot. Ids increase with
+    // each update, so state derived from the snapshot can be reused while this id stays the same.
+    uint64_t lastChangeId = 0;
     // Some consumers of this snapshot (input, layer traces) rely on each snapshot to be unique.
     // For mirrored layers, snapshots will have the same sequence so this unique id provides
     // an alternative identifier when needed.
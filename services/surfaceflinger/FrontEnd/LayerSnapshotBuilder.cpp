@@ -19,8 +19,13 @@
 #undef LOG_TAG
 #define LOG_TAG "SurfaceFlinger"
 
+#include <condition_variable>
+#include <limits>
 #include <numeric>
 #include <optional>
+#include <thread>
+
+#include <pthread.h>
 
 #include <common/FlagManager.h>
 #include <common/trace.h>
@@ -42,6 +47,28 @@ using namespace ftl::flag_operators;
 
 namespace {
 
+// Changes to a snapshot that have to be applied to the snapshots of its children.
+static constexpr ftl::Flags<RequestedLayerState::Changes> CHANGES_AFFECTING_CHILDREN =
+        RequestedLayerState::Changes::Hierarchy | RequestedLayerState::Changes::Geometry |
+        RequestedLayerState::Changes::Visibility | RequestedLayerState::Changes::Metadata |
+        RequestedLayerState::Changes::AffectsChildren | RequestedLayerState::Changes::Input |
+        RequestedLayerState::Changes::FrameRate | RequestedLayerState::Changes::GameMode;
+
+// Changes which may move a layer to another root, or make it depend on a layer of another root.
+static constexpr ftl::Flags<RequestedLayerState::Changes> CHANGES_AFFECTING_PARALLEL_GROUPS =
+        RequestedLayerState::Changes::Hierarchy | RequestedLayerState::Changes::Parent |
+        RequestedLayerState::Changes::RelativeParent | RequestedLayerState::Changes::Mirror |
+        RequestedLayerState::Changes::Z | RequestedLayerState::Changes::Input;
+
+// Most devices have at most a couple of active displays, so a couple of threads are enough.
+static constexpr size_t kMaxParallelUpdateThreads = 2;
+
+bool hasChangesAffectingChildren(const LayerSnapshot& snapshot) {
+    return snapshot.changes.any(CHANGES_AFFECTING_CHILDREN) ||
+            (snapshot.clientChanges &
+             (layer_state_t::AFFECTS_CHILDREN | layer_state_t::eEdgeExtensionChanged));
+}
+
 FloatRect getMaxDisplayBounds(const DisplayInfos& displays) {
     const ui::Size maxSize = [&displays] {
         if (displays.empty()) return ui::Size{5000, 5000};
@@ -365,11 +392,106 @@ LayerSnapshot LayerSnapshotBuilder::getRootSnapshot() {
     return snapshot;
 }
 
+void LayerSnapshotBuilder::SnapshotTable::resize(size_t size) {
+    isVisible.resize(size);
+    hasSomethingToDraw.resize(size);
+    layerStack.resize(size);
+    alpha.resize(size);
+    transformedBounds.resize(size);
+    geomLayerTransform.resize(size);
+}
+
+void LayerSnapshotBuilder::SnapshotTable::set(size_t z, const LayerSnapshot& snapshot) {
+    isVisible[z] = snapshot.isVisible;
+    hasSomethingToDraw[z] = snapshot.hasSomethingToDraw();
+    layerStack[z] = snapshot.outputFilter.layerStack;
+    alpha[z] = snapshot.alpha;
+    transformedBounds[z] = snapshot.transformedBounds;
+    geomLayerTransform[z] = snapshot.geomLayerTransform;
+}
+
+// Threads which run one task of an update alongside the main thread, at its scheduling priority.
+class LayerSnapshotBuilder::WorkerPool {
+public:
+    explicit WorkerPool(size_t threadCount) {
+        int policy;
+        sched_param param;
+        pthread_getschedparam(pthread_self(), &policy, &param);
+        for (size_t i = 0; i < threadCount; i++) {
+            mThreads.emplace_back([this, index = i + 1, policy, param] {
+                pthread_setschedparam(pthread_self(), policy, &param);
+                run(index);
+            });
+            pthread_setname_np(mThreads.back().native_handle(), "SnapshotWorker");
+        }
+    }
+
+    ~WorkerPool() {
+        {
+            std::scoped_lock lock(mMutex);
+            mDone = true;
+        }
+        mCv.notify_all();
+        for (auto& thread : mThreads) {
+            thread.join();
+        }
+    }
+
+    size_t size() const { return mThreads.size() + 1; }
+
+    // Runs task(i) for each i < size(), task(0) on the calling thread, and waits for all of them.
+    void run(const std::function<void(size_t)>& task) {
+        {
+            std::scoped_lock lock(mMutex);
+            mTask = &task;
+            mPendingTasks = mThreads.size();
+            mGeneration++;
+        }
+        mCv.notify_all();
+        task(0);
+        std::unique_lock lock(mMutex);
+        mDoneCv.wait(lock, [this] { return mPendingTasks == 0; });
+        mTask = nullptr;
+    }
+
+private:
+    void run(size_t index) {
+        uint64_t generation = 0;
+        std::unique_lock lock(mMutex);
+        while (true) {
+            mCv.wait(lock, [&] { return mDone || mGeneration != generation; });
+            if (mDone) {
+                return;
+            }
+            generation = mGeneration;
+            const std::function<void(size_t)>* task = mTask;
+            lock.unlock();
+            (*task)(index);
+            lock.lock();
+            if (--mPendingTasks == 0) {
+                mDoneCv.notify_one();
+            }
+        }
+    }
+
+    std::vector<std::thread> mThreads;
+    std::mutex mMutex;
+    std::condition_variable mCv;
+    std::condition_variable mDoneCv;
+    const std::function<void(size_t)>* mTask = nullptr;
+    size_t mPendingTasks = 0;
+    uint64_t mGeneration = 0;
+    bool mDone = false;
+};
+
 LayerSnapshotBuilder::LayerSnapshotBuilder() {}
 
+LayerSnapshotBuilder::~LayerSnapshotBuilder() = default;
+
 LayerSnapshotBuilder::LayerSnapshotBuilder(Args args) : LayerSnapshotBuilder() {
     args.forceUpdate = ForceUpdateFlags::ALL;
     updateSnapshots(args);
+    updateSnapshotTable();
 }
 
 bool LayerSnapshotBuilder::tryFastUpdate(const Args& args) {
@@ -433,9 +555,16 @@ void LayerSnapshotBuilder::updateSnapshots(const Args& args) {
         rootSnapshot.clientChanges |= layer_state_t::eReparent;
     }
 
-    for (auto& snapshot : mSnapshots) {
-        if (snapshot->reachablilty == LayerSnapshot::Reachablilty::Reachable) {
-            snapshot->reachablilty = LayerSnapshot::Reachablilty::Unreachable;
+    mSkipCleanSubtrees = canSkipCleanSubtrees(args);
+    if (mSkipCleanSubtrees) {
+        // The hierarchy has the same shape, so the reachability of snapshots has not changed.
+        updateDirtyLayers(args);
+    } else {
+        mMirrorLayerIds.clear();
+        for (auto& snapshot : mSnapshots) {
+            if (snapshot->reachablilty == LayerSnapshot::Reachablilty::Reachable) {
+                snapshot->reachablilty = LayerSnapshot::Reachablilty::Unreachable;
+            }
         }
     }
 
@@ -446,11 +575,15 @@ void LayerSnapshotBuilder::updateSnapshots(const Args& args) {
         LayerHierarchy::ScopedAddToTraversalPath addChildToPath(root, args.root.getLayer()->id,
                                                                 LayerHierarchy::Variant::Attached);
         updateSnapshotsInHierarchy(args, args.root, root, rootSnapshot, /*depth=*/0);
+    } else if (canUpdateInParallel(args)) {
+        updateRootsInParallel(args, rootSnapshot);
     } else {
         for (auto& [childHierarchy, variant] : args.root.mChildren) {
-            LayerHierarchy::ScopedAddToTraversalPath addChildToPath(root,
-                                                                    childHierarchy->getLayer()->id,
-                                                                    variant);
+            const uint32_t childId = childHierarchy->getLayer()->id;
+            if (mSkipCleanSubtrees && !mDirtyLayerIds.contains(childId)) {
+                continue;
+            }
+            LayerHierarchy::ScopedAddToTraversalPath addChildToPath(root, childId, variant);
             updateSnapshotsInHierarchy(args, *childHierarchy, root, rootSnapshot, /*depth=*/0);
         }
     }
@@ -503,15 +636,190 @@ void LayerSnapshotBuilder::updateSnapshots(const Args& args) {
     }
 }
 
+bool LayerSnapshotBuilder::canSkipCleanSubtrees(const Args& args) const {
+    if (!FlagManager::getInstance().skip_clean_layer_subtrees()) {
+        return false;
+    }
+    // Screenshots and display changes may change snapshots that do not have any changes of their
+    // own, so update everything.
+    return !mSnapshots.empty() && args.forceUpdate == ForceUpdateFlags::NONE &&
+            !args.displayChanges && !args.parentCrop && args.excludeLayerIds.empty() &&
+            !args.layerLifecycleManager.getGlobalChanges().any(
+                    RequestedLayerState::Changes::Hierarchy | RequestedLayerState::Changes::Mirror);
+}
+
+void LayerSnapshotBuilder::updateDirtyLayers(const Args& args) {
+    SFTRACE_NAME("UpdateDirtyLayers");
+    mDirtyLayerIds.clear();
+    for (const RequestedLayerState* requested : args.layerLifecycleManager.getChangedLayers()) {
+        markDirty(requested->id, args);
+    }
+    // Layers reached through a mirror are not reachable from their requested parents, so always
+    // visit the mirrors.
+    if (!mDirtyLayerIds.empty()) {
+        for (uint32_t mirrorLayerId : mMirrorLayerIds) {
+            markDirty(mirrorLayerId, args);
+        }
+    }
+}
+
+void LayerSnapshotBuilder::markDirty(uint32_t layerId, const Args& args) {
+    while (layerId != UNASSIGNED_LAYER_ID && mDirtyLayerIds.insert(layerId).second) {
+        const RequestedLayerState* requested = args.layerLifecycleManager.getLayerFromId(layerId);
+        if (!requested) {
+            return;
+        }
+        // A layer is visited by both its parent and its relative parent.
+        markDirty(requested->relativeParentId, args);
+        layerId = requested->parentId;
+    }
+}
+
+bool LayerSnapshotBuilder::canUpdateInParallel(const Args& args) {
+    const auto globalChanges = args.layerLifecycleManager.getGlobalChanges();
+    if (globalChanges.any(CHANGES_AFFECTING_PARALLEL_GROUPS)) {
+        mParallelGroupsValid = false;
+    }
+    if (!FlagManager::getInstance().parallel_snapshot_builder()) {
+        return false;
+    }
+    // New snapshots are appended to mSnapshots, so a hierarchy change has to be done in order to
+    // produce the same snapshots as a serial update.
+    if (mSnapshots.empty() || args.forceUpdate != ForceUpdateFlags::NONE ||
+        globalChanges.any(RequestedLayerState::Changes::Hierarchy |
+                          RequestedLayerState::Changes::Mirror)) {
+        return false;
+    }
+    if (!mParallelGroupsValid) {
+        updateParallelGroups(args);
+    }
+    return mParallelGroupCount > 1;
+}
+
+void LayerSnapshotBuilder::updateParallelGroups(const Args& args) {
+    SFTRACE_NAME("UpdateParallelGroups");
+    mParallelGroupsValid = true;
+    mParallelGroupCount = 0;
+    mRootLayerGroups.clear();
+
+    std::vector<ui::LayerStack> layerStacks;
+    for (auto& [childHierarchy, variant] : args.root.mChildren) {
+        const RequestedLayerState* layer = childHierarchy->getLayer();
+        auto it = std::find(layerStacks.begin(), layerStacks.end(), layer->layerStack);
+        if (it == layerStacks.end()) {
+            it = layerStacks.insert(layerStacks.end(), layer->layerStack);
+        }
+        mRootLayerGroups[layer->id] = static_cast<size_t>(it - layerStacks.begin());
+    }
+    if (layerStacks.size() < 2) {
+        return;
+    }
+
+    // Offscreen layers, and layers too deep to be updated, count as a group of their own.
+    constexpr size_t kNoGroup = std::numeric_limits<size_t>::max();
+    auto groupOf = [&](uint32_t layerId) {
+        const RequestedLayerState* layer = args.layerLifecycleManager.getLayerFromId(layerId);
+        for (int depth = 0; layer && depth <= 50; depth++) {
+            if (layer->parentId == UNASSIGNED_LAYER_ID) {
+                auto it = mRootLayerGroups.find(layer->id);
+                return it == mRootLayerGroups.end() ? kNoGroup : it->second;
+            }
+            layer = args.layerLifecycleManager.getLayerFromId(layer->parentId);
+        }
+        return kNoGroup;
+    };
+
+    // Mirrors, relative layers and touch crops read the snapshots of other layers, which have to be
+    // updated on the same thread.
+    for (const auto& layer : args.layerLifecycleManager.getLayers()) {
+        if (!layer->mirrorIds.empty() || layer->layerIdToMirror != UNASSIGNED_LAYER_ID ||
+            layer->layerStackToMirror != ui::INVALID_LAYER_STACK) {
+            mRootLayerGroups.clear();
+            return;
+        }
+        for (uint32_t dependencyId : {layer->relativeParentId, layer->touchCropId}) {
+            if (dependencyId != UNASSIGNED_LAYER_ID && groupOf(dependencyId) != groupOf(layer->id)) {
+                mRootLayerGroups.clear();
+                return;
+            }
+        }
+    }
+    mParallelGroupCount = layerStacks.size();
+}
+
+void LayerSnapshotBuilder::updateRootsInParallel(const Args& args,
+                                                 const LayerSnapshot& rootSnapshot) {
+    SFTRACE_NAME("UpdateRootsInParallel");
+    if (!mWorkerPool) {
+        mWorkerPool = std::make_unique<WorkerPool>(kMaxParallelUpdateThreads - 1);
+    }
+    const size_t taskCount = std::min(mParallelGroupCount, mWorkerPool->size());
+
+    mUpdatingInParallel = true;
+    mWorkerPool->run([&](size_t task) {
+        if (task >= taskCount) {
+            return;
+        }
+        LayerHierarchy::TraversalPath root = LayerHierarchy::TraversalPath::ROOT;
+        for (auto& [childHierarchy, variant] : args.root.mChildren) {
+            const uint32_t childId = childHierarchy->getLayer()->id;
+            auto group = mRootLayerGroups.find(childId);
+            if ((group == mRootLayerGroups.end() ? 0 : group->second) % taskCount != task) {
+                continue;
+            }
+            if (mSkipCleanSubtrees && !mDirtyLayerIds.contains(childId)) {
+                continue;
+            }
+            LayerHierarchy::ScopedAddToTraversalPath addChildToPath(root, childId, variant);
+            updateSnapshotsInHierarchy(args, *childHierarchy, root, rootSnapshot, /*depth=*/0);
+        }
+    });
+    mUpdatingInParallel = false;
+}
+
+std::unique_lock<std::mutex> LayerSnapshotBuilder::lockIfParallel() const {
+    return mUpdatingInParallel ? std::unique_lock(mParallelLock) : std::unique_lock<std::mutex>();
+}
+
 void LayerSnapshotBuilder::update(const Args& args) {
     for (auto& snapshot : mSnapshots) {
         clearChanges(*snapshot);
     }
 
     if (tryFastUpdate(args)) {
-        return;
+        updateSnapshotTable(args);
+    } else {
+        updateSnapshots(args);
+        updateSnapshotTable();
+    }
+
+    mUpdateId++;
+    for (auto& snapshot : mSnapshots) {
+        if (snapshot->changes.any() || snapshot->clientChanges != 0) {
+            snapshot->lastChangeId = mUpdateId;
+        }
+    }
+}
+
+void LayerSnapshotBuilder::updateSnapshotTable() {
+    const size_t size = static_cast<size_t>(mNumInterestingSnapshots);
+    mSnapshotTable.resize(size);
+    for (size_t z = 0; z < size; z++) {
+        mSnapshotTable.set(z, *mSnapshots[z]);
+    }
+}
+
+void LayerSnapshotBuilder::updateSnapshotTable(const Args& args) {
+    // The fast path does not reorder snapshots, so only the changed rows need updating.
+    for (const RequestedLayerState* requested : args.layerLifecycleManager.getChangedLayers()) {
+        auto range = mIdToSnapshots.equal_range(requested->id);
+        for (auto it = range.first; it != range.second; it++) {
+            const LayerSnapshot& snapshot = *it->second;
+            if (snapshot.globalZ < static_cast<size_t>(mNumInterestingSnapshots)) {
+                mSnapshotTable.set(snapshot.globalZ, snapshot);
+            }
+        }
     }
-    updateSnapshots(args);
 }
 
 const LayerSnapshot& LayerSnapshotBuilder::updateSnapshotsInHierarchy(
@@ -527,6 +835,7 @@ const LayerSnapshot& LayerSnapshotBuilder::updateSnapshotsInHierarchy(
     const bool newSnapshot = snapshot == nullptr;
     uint32_t primaryDisplayRotationFlags = getPrimaryDisplayRotationFlags(args.displays);
     if (newSnapshot) {
+        auto lock = lockIfParallel();
         snapshot = createSnapshot(traversalPath, *layer, parentSnapshot);
         snapshot->merge(*layer, /*forceUpdate=*/true, /*displayChanges=*/true, args.forceFullDamage,
                         primaryDisplayRotationFlags);
@@ -543,14 +852,23 @@ const LayerSnapshot& LayerSnapshotBuilder::updateSnapshotsInHierarchy(
         updateSnapshot(*snapshot, args, *layer, parentSnapshot, traversalPath);
     }
 
+    const bool skipCleanChildren = mSkipCleanSubtrees && !hasChangesAffectingChildren(*snapshot);
     bool childHasValidFrameRate = false;
     for (auto& [childHierarchy, variant] : hierarchy.mChildren) {
-        LayerHierarchy::ScopedAddToTraversalPath addChildToPath(traversalPath,
-                                                                childHierarchy->getLayer()->id,
-                                                                variant);
-        const LayerSnapshot& childSnapshot =
-                updateSnapshotsInHierarchy(args, *childHierarchy, traversalPath, *snapshot,
-                                           depth + 1);
+        const uint32_t childId = childHierarchy->getLayer()->id;
+        if (!mSkipCleanSubtrees && LayerHierarchy::isMirror(variant)) {
+            mMirrorLayerIds.insert(layer->id);
+        }
+        LayerHierarchy::ScopedAddToTraversalPath addChildToPath(traversalPath, childId, variant);
+        const LayerSnapshot* cleanChildSnapshot = nullptr;
+        if (skipCleanChildren && !mDirtyLayerIds.contains(childId)) {
+            // Nothing in this subtree or above it has changed, so its snapshots are up to date.
+            cleanChildSnapshot = getSnapshot(traversalPath);
+        }
+        const LayerSnapshot& childSnapshot = cleanChildSnapshot
+                ? *cleanChildSnapshot
+                : updateSnapshotsInHierarchy(args, *childHierarchy, traversalPath, *snapshot,
+                                             depth + 1);
         updateFrameRateFromChildSnapshot(*snapshot, childSnapshot, *childHierarchy->getLayer(),
                                          args, &childHasValidFrameRate);
     }
@@ -567,6 +885,8 @@ LayerSnapshot* LayerSnapshotBuilder::getSnapshot(uint32_t layerId) const {
 }
 
 LayerSnapshot* LayerSnapshotBuilder::getSnapshot(const LayerHierarchy::TraversalPath& id) const {
+    // Another root may be creating a snapshot, which can rehash mPathToSnapshot.
+    auto lock = lockIfParallel();
     auto it = mPathToSnapshot.find(id);
     return it == mPathToSnapshot.end() ? nullptr : it->second;
 }
@@ -715,11 +1035,8 @@ void LayerSnapshotBuilder::updateSnapshot(LayerSnapshot& snapshot, const Args& a
                                           const LayerSnapshot& parentSnapshot,
                                           const LayerHierarchy::TraversalPath& path) {
     // Always update flags and visibility
-    ftl::Flags<RequestedLayerState::Changes> parentChanges = parentSnapshot.changes &
-            (RequestedLayerState::Changes::Hierarchy | RequestedLayerState::Changes::Geometry |
-             RequestedLayerState::Changes::Visibility | RequestedLayerState::Changes::Metadata |
-             RequestedLayerState::Changes::AffectsChildren | RequestedLayerState::Changes::Input |
-             RequestedLayerState::Changes::FrameRate | RequestedLayerState::Changes::GameMode);
+    ftl::Flags<RequestedLayerState::Changes> parentChanges =
+            parentSnapshot.changes & CHANGES_AFFECTING_CHILDREN;
     snapshot.changes |= parentChanges;
     if (args.displayChanges) snapshot.changes |= RequestedLayerState::Changes::Geometry;
     snapshot.reachablilty = LayerSnapshot::Reachablilty::Reachable;
@@ -1051,6 +1368,7 @@ void LayerSnapshotBuilder::updateLayerBounds(LayerSnapshot& snapshot,
     }
     if (transformWasInvalid != snapshot.invalidTransform) {
         // If transform is invalid, the layer will be hidden.
+        auto lock = lockIfParallel();
         mResortSnapshots = true;
     }
     snapshot.geomInverseLayerTransform = snapshot.geomLayerTransform.inverse();
@@ -1176,6 +1494,7 @@ void LayerSnapshotBuilder::updateInput(LayerSnapshot& snapshot,
     }
 
     if (requested.touchCropId != UNASSIGNED_LAYER_ID || path.isClone()) {
+        auto lock = lockIfParallel();
         mNeedsTouchableRegionCrop.insert(path);
     }
     auto cropLayerSnapshot = getSnapshot(requested.touchCropId);
@@ -1210,9 +1529,8 @@ std::vector<std::unique_ptr<LayerSnapshot>>& LayerSnapshotBuilder::getSnapshots(
 
 void LayerSnapshotBuilder::forEachVisibleSnapshot(const ConstVisitor& visitor) const {
     for (int i = 0; i < mNumInterestingSnapshots; i++) {
-        LayerSnapshot& snapshot = *mSnapshots[(size_t)i];
-        if (!snapshot.isVisible) continue;
-        visitor(snapshot);
+        if (!mSnapshotTable.isVisible[(size_t)i]) continue;
+        visitor(*mSnapshots[(size_t)i]);
     }
 }
 
@@ -1232,9 +1550,8 @@ void LayerSnapshotBuilder::forEachVisibleSnapshot(const ConstVisitor& visitor,
 
 void LayerSnapshotBuilder::forEachVisibleSnapshot(const Visitor& visitor) {
     for (int i = 0; i < mNumInterestingSnapshots; i++) {
-        std::unique_ptr<LayerSnapshot>& snapshot = mSnapshots.at((size_t)i);
-        if (!snapshot->isVisible) continue;
-        visitor(snapshot);
+        if (!mSnapshotTable.isVisible[(size_t)i]) continue;
+        visitor(mSnapshots.at((size_t)i));
     }
 }
 
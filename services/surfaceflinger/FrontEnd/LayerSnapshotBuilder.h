@@ -16,6 +16,8 @@
 
 #pragma once
 
+#include <mutex>
+
 #include "FrontEnd/DisplayInfo.h"
 #include "FrontEnd/LayerLifecycleManager.h"
 #include "LayerHierarchy.h"
@@ -60,11 +62,28 @@ public:
         bool skipRoundCornersWhenProtected = false;
         LayerSnapshot rootSnapshot = getRootSnapshot();
     };
+    // Copies of the fields read by per-frame passes over the visible snapshots, stored by
+    // column and indexed by globalZ, so these passes do not need to pull in every snapshot.
+    // Only the first getNumInterestingSnapshots() rows are valid.
+    struct SnapshotTable {
+        std::vector<uint8_t> isVisible;
+        std::vector<uint8_t> hasSomethingToDraw;
+        std::vector<ui::LayerStack> layerStack;
+        std::vector<float> alpha;
+        std::vector<FloatRect> transformedBounds;
+        std::vector<ui::Transform> geomLayerTransform;
+
+        void resize(size_t size);
+        void set(size_t z, const LayerSnapshot& snapshot);
+    };
+
     LayerSnapshotBuilder();
 
     // Rebuild the snapshots from scratch.
     LayerSnapshotBuilder(Args);
 
+    ~LayerSnapshotBuilder();
+
     // Update an existing set of snapshot using change flags in RequestedLayerState
     // and LayerLifecycleManager. This needs to be called before
     // LayerLifecycleManager.commitChanges is called as that function will clear all
@@ -97,6 +116,11 @@ public:
     // Visit each snapshot interesting to input reverse z-order
     void forEachInputSnapshot(const ConstVisitor& visitor) const;
 
+    const SnapshotTable& getSnapshotTable() const { return mSnapshotTable; }
+    size_t getNumInterestingSnapshots() const {
+        return static_cast<size_t>(mNumInterestingSnapshots);
+    }
+
 private:
     friend class LayerSnapshotTest;
 
@@ -106,6 +130,22 @@ private:
 
     void updateSnapshots(const Args& args);
 
+    // Returns true if the hierarchy has not changed shape since the last update, so subtrees
+    // without any changed layers can keep their snapshots as they are.
+    bool canSkipCleanSubtrees(const Args& args) const;
+    // Marks every changed layer, and every layer which can reach it in the hierarchy, as dirty.
+    void updateDirtyLayers(const Args& args);
+    void markDirty(uint32_t layerId, const Args& args);
+
+    // Returns true if the roots of the hierarchy can be updated on several threads. This is
+    // the case when no snapshots will be created, and the roots are on at least two layer
+    // stacks whose layers do not depend on each other.
+    bool canUpdateInParallel(const Args& args);
+    void updateParallelGroups(const Args& args);
+    void updateRootsInParallel(const Args& args, const LayerSnapshot& rootSnapshot);
+    // Locks mParallelLock for state shared by every root, if the update is running in parallel.
+    std::unique_lock<std::mutex> lockIfParallel() const;
+
     const LayerSnapshot& updateSnapshotsInHierarchy(const Args&, const LayerHierarchy& hierarchy,
                                                     LayerHierarchy::TraversalPath& traversalPath,
                                                     const LayerSnapshot& parentSnapshot, int depth);
@@ -137,6 +177,8 @@ private:
                                           const RequestedLayerState& requestedCHildState,
                                           const Args& args, bool* outChildHasValidFrameRate);
     void updateTouchableRegionCrop(const Args& args);
+    void updateSnapshotTable();
+    void updateSnapshotTable(const Args& args);
 
     std::unordered_map<LayerHierarchy::TraversalPath, LayerSnapshot*,
                        LayerHierarchy::TraversalPathHash>
@@ -147,8 +189,31 @@ private:
     std::unordered_set<LayerHierarchy::TraversalPath, LayerHierarchy::TraversalPathHash>
             mNeedsTouchableRegionCrop;
     std::vector<std::unique_ptr<LayerSnapshot>> mSnapshots;
+
+    // Set when the current update only visits subtrees containing a layer in mDirtyLayerIds.
+    bool mSkipCleanSubtrees = false;
+    std::unordered_set<uint32_t> mDirtyLayerIds;
+    // Layers with mirrored children. These are only collected during a full update, which is
+    // required for any change to the mirrored hierarchies.
+    std::unordered_set<uint32_t> mMirrorLayerIds;
+
+    SnapshotTable mSnapshotTable;
+
+    class WorkerPool;
+    std::unique_ptr<WorkerPool> mWorkerPool;
+    // Group of each root layer, by layer stack. Roots in different groups may be updated on
+    // different threads. Only valid if mParallelGroupsValid, and empty if the layer stacks
+    // depend on each other.
+    std::unordered_map<uint32_t, size_t> mRootLayerGroups;
+    size_t mParallelGroupCount = 0;
+    bool mParallelGroupsValid = false;
+    bool mUpdatingInParallel = false;
+    mutable std::mutex mParallelLock;
+
     bool mResortSnapshots = false;
     int mNumInterestingSnapshots = 0;
+    // Id of the current update, see LayerSnapshot::lastChangeId.
+    uint64_t mUpdateId = 0;
 };
 
 } // namespace android::surfaceflinger::frontend
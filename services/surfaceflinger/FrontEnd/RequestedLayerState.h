@@ -23,6 +23,7 @@
 #include "Scheduler/LayerInfo.h"
 
 #include "LayerCreationArgs.h"
+#include "SlabAllocator.h"
 #include "TransactionState.h"
 
 namespace android::surfaceflinger::frontend {
@@ -68,6 +69,12 @@ struct RequestedLayerState : layer_state_t {
             Changes::BufferUsageFlags;
     static Rect reduce(const Rect& win, const Region& exclude);
     RequestedLayerState(const LayerCreationArgs&);
+    static void* operator new(size_t size) {
+        return SlabAllocator<RequestedLayerState>::allocate(size);
+    }
+    static void operator delete(void* ptr, size_t size) {
+        SlabAllocator<RequestedLayerState>::deallocate(ptr, size);
+    }
     void merge(const ResolvedComposerState&);
     void clearChanges();
 
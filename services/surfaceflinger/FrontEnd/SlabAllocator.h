@@ -0,0 +1,109 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace android::surfaceflinger::frontend {
+// Allocates objects of type T out of slabs of kObjectsPerSlab objects, and reuses the memory of
+// destroyed objects for new ones. This keeps the front end objects which are created and destroyed
+// with every layer, as windows animate in and out, away from malloc. Slabs are never freed, so
+// the memory used is that of the most objects alive at any one time.
+//
+// Use it from class specific operator new and operator delete:
+//     static void* operator new(size_t size) { return SlabAllocator<Foo>::allocate(size); }
+//     static void operator delete(void* ptr, size_t size) {
+//         SlabAllocator<Foo>::deallocate(ptr, size);
+//     }
+// Objects may be allocated and freed on any thread.
+template <typename T, size_t kObjectsPerSlab = 64>
+class SlabAllocator {
+public:
+    static void* allocate(size_t size) {
+        // Types deriving from T are not pooled.
+        if (size != sizeof(T)) {
+            return ::operator new(size);
+        }
+        Pool& p = pool();
+        std::scoped_lock lock(p.mutex);
+        if (!p.freeList) {
+            p.slabs.emplace_back(std::make_unique<Slot[]>(kObjectsPerSlab));
+            Slot* slab = p.slabs.back().get();
+            for (size_t i = kObjectsPerSlab; i > 0; i--) {
+                slab[i - 1].next = p.freeList;
+                p.freeList = &slab[i - 1];
+            }
+        }
+        Slot* slot = p.freeList;
+        p.freeList = slot->next;
+        p.allocated++;
+        return slot;
+    }
+
+    static void deallocate(void* ptr, size_t size) {
+        if (!ptr) {
+            return;
+        }
+        if (size != sizeof(T)) {
+            ::operator delete(ptr);
+            return;
+        }
+        Pool& p = pool();
+        std::scoped_lock lock(p.mutex);
+        Slot* slot = static_cast<Slot*>(ptr);
+        slot->next = p.freeList;
+        p.freeList = slot;
+        p.allocated--;
+    }
+
+    // Number of objects currently allocated from the slabs, and the number that fit in them.
+    static size_t allocatedCount() {
+        Pool& p = pool();
+        std::scoped_lock lock(p.mutex);
+        return p.allocated;
+    }
+    static size_t capacity() {
+        Pool& p = pool();
+        std::scoped_lock lock(p.mutex);
+        return p.slabs.size() * kObjectsPerSlab;
+    }
+
+private:
+    union Slot {
+        Slot* next;
+        alignas(T) std::byte storage[sizeof(T)];
+    };
+
+    struct Pool {
+        std::mutex mutex;
+        std::vector<std::unique_ptr<Slot[]>> slabs;
+        Slot* freeList = nullptr;
+        size_t allocated = 0;
+    };
+
+    static Pool& pool() {
+        // Objects may still be destroyed while the process exits.
+        [[clang::no_destroy]] static Pool sPool;
+        return sPool;
+    }
+};
+
+} // namespace android::surfaceflinger::frontend
@@ -19,6 +19,7 @@
 #define LOG_TAG "SurfaceFlinger"
 #define ATRACE_TAG ATRACE_TAG_GRAPHICS
 
+#include <common/FlagManager.h>
 #include <common/trace.h>
 #include <cutils/trace.h>
 #include <utils/Log.h>
@@ -28,6 +29,17 @@
 
 namespace android::surfaceflinger::frontend {
 
+namespace {
+
+// Fields which a layer state replaces outright when applied, so that applying them from an
+// earlier state for the same layer has no effect on the result.
+constexpr uint64_t kCoalescableChanges = layer_state_t::ePositionChanged |
+        layer_state_t::eAlphaChanged | layer_state_t::eMatrixChanged |
+        layer_state_t::eCornerRadiusChanged | layer_state_t::eBackgroundBlurRadiusChanged |
+        layer_state_t::eCropChanged;
+
+} // namespace
+
 void TransactionHandler::queueTransaction(TransactionState&& state) {
     mLocklessTransactionQueue.push(std::move(state));
     mPendingTransactionCount.fetch_add(1);
@@ -56,20 +68,26 @@ std::vector<TransactionState> TransactionHandler::flushTransactions() {
     // the barrier dependent transaction, determine it ineligible to complete
     // and then satisfy in a later inner iteration of flushPendingTransactionQueues.
     // The barrier dependent transaction was eligible to be presented in this frame
-    // but we would have prevented it without case. To fix this we continually
-    // loop through flushPendingTransactionQueues until we perform an iteration
-    // where the number of transactionsPendingBarrier doesn't change. This way
-    // we can continue to resolve dependency chains of barriers as far as possible.
-    int lastTransactionsPendingBarrier = 0;
-    int transactionsPendingBarrier = 0;
-    do {
-        lastTransactionsPendingBarrier = transactionsPendingBarrier;
-        // Collect transactions that are ready to be applied.
-        transactionsPendingBarrier = flushPendingTransactionQueues(transactions, flushState);
-    } while (lastTransactionsPendingBarrier != transactionsPendingBarrier);
+    // but we would have prevented it without case. To fix this we loop through the
+    // queues waiting on a barrier for as long as the previous iteration applied
+    // something. This way we can continue to resolve dependency chains of barriers
+    // as far as possible. Applying a transaction can only satisfy a barrier, so
+    // the other queues do not need to be checked again.
+    std::vector<sp<IBinder>> queuesPendingBarrier =
+            flushPendingTransactionQueues(transactions, flushState);
+    size_t lastTransactionCount = 0;
+    while (!queuesPendingBarrier.empty() && transactions.size() != lastTransactionCount) {
+        lastTransactionCount = transactions.size();
+        queuesPendingBarrier =
+                flushPendingTransactionQueues(transactions, flushState, &queuesPendingBarrier);
+    }
 
     applyUnsignaledBufferTransaction(transactions, flushState);
 
+    if (FlagManager::getInstance().coalesce_transaction_states()) {
+        coalesceTransactions(transactions);
+    }
+
     mPendingTransactionCount.fetch_sub(transactions.size());
     SFTRACE_INT("TransactionQueue", static_cast<int>(mPendingTransactionCount.load()));
     return transactions;
@@ -146,29 +164,34 @@ TransactionHandler::TransactionReadiness TransactionHandler::applyFilters(
     return ready;
 }
 
-int TransactionHandler::flushPendingTransactionQueues(std::vector<TransactionState>& transactions,
-                                                      TransactionFlushState& flushState) {
-    int transactionsPendingBarrier = 0;
+std::vector<sp<IBinder>> TransactionHandler::flushPendingTransactionQueues(
+        std::vector<TransactionState>& transactions, TransactionFlushState& flushState,
+        const std::vector<sp<IBinder>>* applyTokens) {
+    std::vector<sp<IBinder>> queuesPendingBarrier;
+    if (applyTokens) {
+        for (const auto& applyToken : *applyTokens) {
+            auto it = mPendingTransactionQueues.find(applyToken);
+            if (it == mPendingTransactionQueues.end()) {
+                continue;
+            }
+            auto ready = flushPendingTransactionQueue(transactions, flushState, applyToken,
+                                                      it->second);
+            if (ready == TransactionReadiness::NotReadyBarrier) {
+                queuesPendingBarrier.push_back(applyToken);
+            }
+            if (it->second.empty()) {
+                mPendingTransactionQueues.erase(it);
+            }
+        }
+        return queuesPendingBarrier;
+    }
+
     auto it = mPendingTransactionQueues.begin();
     while (it != mPendingTransactionQueues.end()) {
         auto& [applyToken, queue] = *it;
-        while (!queue.empty()) {
-            auto& transaction = queue.front();
-            flushState.transaction = &transaction;
-            auto ready = applyFilters(flushState);
-            if (ready == TransactionReadiness::NotReadyBarrier) {
-                transactionsPendingBarrier++;
-                break;
-            } else if (ready == TransactionReadiness::NotReady) {
-                break;
-            } else if (ready == TransactionReadiness::NotReadyUnsignaled) {
-                // We maybe able to latch this transaction if it's the only transaction
-                // ready to be applied.
-                flushState.queueWithUnsignaledBuffer = applyToken;
-                break;
-            }
-            // ready == TransactionReadiness::Ready
-            popTransactionFromPending(transactions, flushState, queue);
+        auto ready = flushPendingTransactionQueue(transactions, flushState, applyToken, queue);
+        if (ready == TransactionReadiness::NotReadyBarrier) {
+            queuesPendingBarrier.push_back(applyToken);
         }
 
         if (queue.empty()) {
@@ -177,7 +200,55 @@ int TransactionHandler::flushPendingTransactionQueues(std::vector<TransactionSta
             it = std::next(it, 1);
         }
     }
-    return transactionsPendingBarrier;
+    return queuesPendingBarrier;
+}
+
+TransactionHandler::TransactionReadiness TransactionHandler::flushPendingTransactionQueue(
+        std::vector<TransactionState>& transactions, TransactionFlushState& flushState,
+        const sp<IBinder>& applyToken, std::queue<TransactionState>& queue) {
+    while (!queue.empty()) {
+        auto& transaction = queue.front();
+        flushState.transaction = &transaction;
+        auto ready = applyFilters(flushState);
+        if (ready == TransactionReadiness::NotReadyUnsignaled) {
+            // We maybe able to latch this transaction if it's the only transaction
+            // ready to be applied.
+            flushState.queueWithUnsignaledBuffer = applyToken;
+        }
+        if (ready != TransactionReadiness::Ready) {
+            return ready;
+        }
+        popTransactionFromPending(transactions, flushState, queue);
+    }
+    return TransactionReadiness::Ready;
+}
+
+void TransactionHandler::coalesceTransactions(std::vector<TransactionState>& transactions) {
+    if (transactions.size() < 2) {
+        return;
+    }
+    SFTRACE_CALL();
+    // Transactions are applied in order, so walk them backwards collecting the fields set by
+    // later states of each layer. Transactions and states are kept even if nothing is left to
+    // apply, since callbacks, barriers and buffers are tracked by them.
+    std::unordered_map<uint32_t /* layerId */, uint64_t /* what */> laterChanges;
+    int coalesced = 0;
+    for (auto transaction = transactions.rbegin(); transaction != transactions.rend();
+         transaction++) {
+        for (auto state = transaction->states.rbegin(); state != transaction->states.rend();
+             state++) {
+            if (state->layerId == UNASSIGNED_LAYER_ID) {
+                continue;
+            }
+            uint64_t& later = laterChanges[state->layerId];
+            if (const uint64_t redundant = state->state.what & later; redundant != 0) {
+                state->state.what &= ~redundant;
+                coalesced++;
+            }
+            later |= state->state.what & kCoalescableChanges;
+        }
+    }
+    SFTRACE_INT("CoalescedLayerStates", coalesced);
 }
 
 void TransactionHandler::addTransactionReadyFilter(TransactionFilter&& filter) {
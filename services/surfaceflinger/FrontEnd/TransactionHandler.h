@@ -81,11 +81,21 @@ private:
     // For unit tests
     friend class ::android::TestableSurfaceFlinger;
 
-    int flushPendingTransactionQueues(std::vector<TransactionState>&, TransactionFlushState&);
+    // Moves the ready transactions at the front of every pending queue, or only of the queues of
+    // applyTokens if it is set. Returns the apply tokens of the queues left waiting on a barrier.
+    std::vector<sp<IBinder>> flushPendingTransactionQueues(
+            std::vector<TransactionState>&, TransactionFlushState&,
+            const std::vector<sp<IBinder>>* applyTokens = nullptr);
+    TransactionReadiness flushPendingTransactionQueue(std::vector<TransactionState>&,
+                                                      TransactionFlushState&,
+                                                      const sp<IBinder>& applyToken,
+                                                      std::queue<TransactionState>&);
     void applyUnsignaledBufferTransaction(std::vector<TransactionState>&, TransactionFlushState&);
     void popTransactionFromPending(std::vector<TransactionState>&, TransactionFlushState&,
                                    std::queue<TransactionState>&);
     TransactionReadiness applyFilters(TransactionFlushState&);
+    // Clears the fields of layer states which a later transaction in the same flush sets again.
+    void coalesceTransactions(std::vector<TransactionState>&);
     std::unordered_map<sp<IBinder>, std::queue<TransactionState>, IListenerHash>
             mPendingTransactionQueues;
     LocklessQueue<TransactionState> mLocklessTransactionQueue;
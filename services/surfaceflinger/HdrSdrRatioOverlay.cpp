@@ -18,8 +18,6 @@
 
 #include "HdrSdrRatioOverlay.h"
 
-#include <SkSurface.h>
-
 #undef LOG_TAG
 #define LOG_TAG "HdrSdrRatioOverlay"
 
@@ -43,7 +41,8 @@ void HdrSdrRatioOverlay::drawNumber(float number, int left, SkColor color, SkCan
 
 sp<GraphicBuffer> HdrSdrRatioOverlay::draw(float currentHdrSdrRatio, SkColor color,
                                            ui::Transform::RotationFlags rotation,
-                                           sp<GraphicBuffer>& ringBuffer) {
+                                           sp<GraphicBuffer>& ringBuffer,
+                                           sk_sp<SkSurface>& surface) {
     const int32_t bufferWidth = kBufferWidth;
     const int32_t bufferHeight = kBufferWidth;
 
@@ -78,10 +77,13 @@ sp<GraphicBuffer> HdrSdrRatioOverlay::draw(float currentHdrSdrRatio, SkColor col
     LOG_ALWAYS_FATAL_IF(bufferStatus != OK, "HdrSdrRatioOverlay: Buffer failed to allocate: %d",
                         bufferStatus);
 
-    sk_sp<SkSurface> surface =
-            SkSurfaces::Raster(SkImageInfo::MakeN32Premul(bufferWidth, bufferHeight));
+    // The buffer is square whatever the rotation, so one raster surface serves every redraw.
+    if (surface == nullptr) {
+        surface = SkSurfaces::Raster(SkImageInfo::MakeN32Premul(bufferWidth, bufferHeight));
+    }
     SkCanvas* canvas = surface->getCanvas();
     canvas->setMatrix(canvasTransform);
+    canvas->clear(SK_ColorTRANSPARENT);
 
     drawNumber(currentHdrSdrRatio, 0, color, *canvas);
 
@@ -167,7 +169,10 @@ auto HdrSdrRatioOverlay::getOrCreateBuffers(float currentHdrSdrRatio) -> const s
         }
     }();
 
-    createTransaction().setTransform(mSurfaceControl->get(), transform).apply();
+    if (transform != mTransform) {
+        mTransform = transform;
+        createTransaction().setTransform(mSurfaceControl->get(), transform).apply();
+    }
 
     constexpr SkColor kMinRatioColor = SK_ColorBLUE;
     constexpr SkColor kMaxRatioColor = SK_ColorGREEN;
@@ -187,7 +192,7 @@ auto HdrSdrRatioOverlay::getOrCreateBuffers(float currentHdrSdrRatio) -> const s
 
     const SkColor color = colorBase.toSkColor();
 
-    auto buffer = draw(currentHdrSdrRatio, color, transformHint, mRingBuffer[mIndex]);
+    auto buffer = draw(currentHdrSdrRatio, color, transformHint, mRingBuffer[mIndex], mSurface);
     mIndex = (mIndex + 1) % 2;
     return buffer;
 }
@@ -18,6 +18,7 @@
 
 #include "Utils/OverlayUtils.h"
 
+#include <SkSurface.h>
 #include <ui/Size.h>
 #include <utils/StrongPointer.h>
 
@@ -43,7 +44,7 @@ private:
     bool initCheck() const;
 
     static sp<GraphicBuffer> draw(float currentHdrSdrRatio, SkColor, ui::Transform::RotationFlags,
-                                  sp<GraphicBuffer>& ringBufer);
+                                  sp<GraphicBuffer>& ringBufer, sk_sp<SkSurface>& surface);
     static void drawNumber(float number, int left, SkColor, SkCanvas&);
 
     const sp<GraphicBuffer> getOrCreateBuffers(float currentHdrSdrRatio);
@@ -53,6 +54,10 @@ private:
 
     size_t mIndex = 0;
     std::array<sp<GraphicBuffer>, 2> mRingBuffer;
+    // Raster surface the ratio is drawn on before it is copied into the ring buffer.
+    sk_sp<SkSurface> mSurface;
+    // The transform last sent to SurfaceFlinger.
+    std::optional<ui::Transform::RotationFlags> mTransform;
 
     SurfaceComposerClient::Transaction createTransaction() const;
 };
@@ -98,24 +98,53 @@ bool LayerFE::onPreComposition(bool) {
     return mSnapshot->hasReadyFrame;
 }
 
+bool LayerFE::ClientCompositionKey::operator==(const ClientCompositionKey& other) const {
+    return needsFiltering == other.needsFiltering && isSecure == other.isSecure &&
+            isProtected == other.isProtected && viewport == other.viewport &&
+            dataspace == other.dataspace && realContentIsVisible == other.realContentIsVisible &&
+            clearContent == other.clearContent && blurSetting == other.blurSetting &&
+            whitePointNits == other.whitePointNits && treat170mAsSrgb == other.treat170mAsSrgb &&
+            displayRotationFlags == other.displayRotationFlags;
+}
+
 std::optional<compositionengine::LayerFE::LayerSettings> LayerFE::prepareClientComposition(
         compositionengine::LayerFE::ClientCompositionTargetSettings& targetSettings) const {
-    std::optional<compositionengine::LayerFE::LayerSettings> layerSettings =
-            prepareClientCompositionInternal(targetSettings);
-    // Nothing to render.
-    if (!layerSettings) {
-        return {};
+    const ClientCompositionKey key{.needsFiltering = targetSettings.needsFiltering,
+                                   .isSecure = targetSettings.isSecure,
+                                   .isProtected = targetSettings.isProtected,
+                                   .viewport = targetSettings.viewport,
+                                   .dataspace = targetSettings.dataspace,
+                                   .realContentIsVisible = targetSettings.realContentIsVisible,
+                                   .clearContent = targetSettings.clearContent,
+                                   .blurSetting = targetSettings.blurSetting,
+                                   .whitePointNits = targetSettings.whitePointNits,
+                                   .treat170mAsSrgb = targetSettings.treat170mAsSrgb,
+                                   .displayRotationFlags =
+                                           SurfaceFlinger::getActiveDisplayRotationFlags()};
+
+    std::scoped_lock lock(mClientCompositionCacheMutex);
+    if (mClientCompositionCache && mClientCompositionCache->snapshot == mSnapshot.get() &&
+        mClientCompositionCache->snapshotChangeId == mSnapshot->lastChangeId &&
+        mClientCompositionCache->key == key) {
+        return mClientCompositionCache->layerSettings;
     }
 
-    // HWC requests to clear this layer.
-    if (targetSettings.clearContent) {
-        prepareClearClientComposition(*layerSettings, false /* blackout */);
-        return layerSettings;
+    std::optional<compositionengine::LayerFE::LayerSettings> layerSettings =
+            prepareClientCompositionInternal(targetSettings);
+    if (layerSettings) {
+        if (targetSettings.clearContent) {
+            // HWC requests to clear this layer.
+            prepareClearClientComposition(*layerSettings, false /* blackout */);
+        } else {
+            // set the shadow for the layer if needed
+            prepareShadowClientComposition(*layerSettings, targetSettings.viewport);
+        }
     }
 
-    // set the shadow for the layer if needed
-    prepareShadowClientComposition(*layerSettings, targetSettings.viewport);
-
+    mClientCompositionCache = ClientCompositionCache{.snapshot = mSnapshot.get(),
+                                                     .snapshotChangeId = mSnapshot->lastChangeId,
+                                                     .key = key,
+                                                     .layerSettings = layerSettings};
     return layerSettings;
 }
 
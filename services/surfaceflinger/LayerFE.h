@@ -26,6 +26,9 @@
 
 #include <ftl/future.h>
 
+#include <mutex>
+#include <optional>
+
 namespace android {
 
 struct CompositionResult {
@@ -81,6 +84,37 @@ private:
 
     const sp<GraphicBuffer> getBuffer() const;
 
+    // Everything besides the snapshot that the result of prepareClientComposition depends on.
+    struct ClientCompositionKey {
+        bool needsFiltering;
+        bool isSecure;
+        bool isProtected;
+        Rect viewport;
+        ui::Dataspace dataspace;
+        bool realContentIsVisible;
+        bool clearContent;
+        compositionengine::LayerFE::ClientCompositionTargetSettings::BlurSetting blurSetting;
+        float whitePointNits;
+        bool treat170mAsSrgb;
+        uint32_t displayRotationFlags;
+
+        bool operator==(const ClientCompositionKey&) const;
+    };
+
+    // The settings last prepared for client composition. They are returned again while the
+    // snapshot has not changed since, and the target settings are the same.
+    struct ClientCompositionCache {
+        const frontend::LayerSnapshot* snapshot = nullptr;
+        uint64_t snapshotChangeId = 0;
+        ClientCompositionKey key;
+        std::optional<compositionengine::LayerFE::LayerSettings> layerSettings;
+    };
+
+    // Outputs may be composited on separate threads.
+    mutable std::mutex mClientCompositionCacheMutex;
+    mutable std::optional<ClientCompositionCache> mClientCompositionCache
+            GUARDED_BY(mClientCompositionCacheMutex);
+
     CompositionResult mCompositionResult;
     std::string mName;
     std::promise<FenceResult> mReleaseFence;
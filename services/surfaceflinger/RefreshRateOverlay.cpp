@@ -37,23 +37,29 @@ auto RefreshRateOverlay::draw(int refreshRate, int renderFps, bool idle, SkColor
     Buffers buffers;
     buffers.reserve(loopCount);
 
-    for (size_t i = 0; i < loopCount; i++) {
-        // Pre-rotate the buffer before it reaches SurfaceFlinger.
-        SkMatrix canvasTransform = SkMatrix();
-        const auto [bufferWidth, bufferHeight] = [&]() -> std::pair<int, int> {
-            switch (rotation) {
-                case ui::Transform::ROT_90:
-                    canvasTransform.setTranslate(kBufferHeight, 0);
-                    canvasTransform.preRotate(90.f);
-                    return {kBufferHeight, kBufferWidth};
-                case ui::Transform::ROT_270:
-                    canvasTransform.setRotate(270.f, kBufferWidth / 2.f, kBufferWidth / 2.f);
-                    return {kBufferHeight, kBufferWidth};
-                default:
-                    return {kBufferWidth, kBufferHeight};
-            }
-        }();
+    // Pre-rotate the buffer before it reaches SurfaceFlinger.
+    SkMatrix canvasTransform = SkMatrix();
+    const auto [bufferWidth, bufferHeight] = [&]() -> std::pair<int, int> {
+        switch (rotation) {
+            case ui::Transform::ROT_90:
+                canvasTransform.setTranslate(kBufferHeight, 0);
+                canvasTransform.preRotate(90.f);
+                return {kBufferHeight, kBufferWidth};
+            case ui::Transform::ROT_270:
+                canvasTransform.setRotate(270.f, kBufferWidth / 2.f, kBufferWidth / 2.f);
+                return {kBufferHeight, kBufferWidth};
+            default:
+                return {kBufferWidth, kBufferHeight};
+        }
+    }();
+
+    // All frames of the spinner have the same size, so draw them on the same raster surface.
+    sk_sp<SkSurface> surface =
+            SkSurfaces::Raster(SkImageInfo::MakeN32Premul(bufferWidth, bufferHeight));
+    SkCanvas* canvas = surface->getCanvas();
+    canvas->setMatrix(canvasTransform);
 
+    for (size_t i = 0; i < loopCount; i++) {
         const auto kUsageFlags =
                 static_cast<uint64_t>(GRALLOC_USAGE_SW_WRITE_RARELY | GRALLOC_USAGE_HW_COMPOSER |
                                       GRALLOC_USAGE_HW_TEXTURE);
@@ -66,10 +72,7 @@ auto RefreshRateOverlay::draw(int refreshRate, int renderFps, bool idle, SkColor
         LOG_ALWAYS_FATAL_IF(bufferStatus != OK, "RefreshRateOverlay: Buffer failed to allocate: %d",
                             bufferStatus);
 
-        sk_sp<SkSurface> surface = SkSurfaces::Raster(
-                SkImageInfo::MakeN32Premul(bufferWidth, bufferHeight));
-        SkCanvas* canvas = surface->getCanvas();
-        canvas->setMatrix(canvasTransform);
+        canvas->clear(SK_ColorTRANSPARENT);
 
         int left = 0;
         if (idle && !isSetByHwc) {
@@ -213,7 +216,10 @@ auto RefreshRateOverlay::getOrCreateBuffers(Fps refreshRate, Fps renderFps, bool
         }
     }();
 
-    createTransaction().setTransform(mSurfaceControl->get(), transform).apply();
+    if (transform != mTransform) {
+        mTransform = transform;
+        createTransaction().setTransform(mSurfaceControl->get(), transform).apply();
+    }
 
     BufferCache::const_iterator it = mBufferCache.find(
             {refreshRate.getIntValue(), renderFps.getIntValue(), transformHint, idle});
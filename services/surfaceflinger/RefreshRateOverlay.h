@@ -90,6 +90,9 @@ private:
     using BufferCache = ftl::SmallMap<Key, Buffers, 9>;
     BufferCache mBufferCache;
 
+    // The transform last sent to SurfaceFlinger, which animate() would otherwise resend per frame.
+    std::optional<ui::Transform::RotationFlags> mTransform;
+
     std::optional<Fps> mRefreshRate;
     std::optional<Fps> mRenderFps;
     bool mIsVrrIdle = false;
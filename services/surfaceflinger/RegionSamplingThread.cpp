@@ -42,6 +42,7 @@
 #include "DisplayRenderArea.h"
 #include "FrontEnd/LayerCreationArgs.h"
 #include "Layer.h"
+#include "LayerFE.h"
 #include "RenderAreaBuilder.h"
 #include "Scheduler/VsyncController.h"
 #include "SurfaceFlinger.h"
@@ -246,6 +247,49 @@ std::vector<float> RegionSamplingThread::sampleBuffer(
     return lumas;
 }
 
+RegionSamplingThread::SampledState RegionSamplingThread::getSampledState(
+        std::vector<Descriptor> descriptors, uint32_t orientation,
+        const std::vector<sp<LayerFE>>& layerFEs) {
+    SampledState state{.descriptors = std::move(descriptors), .orientation = orientation};
+    state.layers.reserve(layerFEs.size());
+    for (const auto& layerFE : layerFEs) {
+        const auto* compositionState = layerFE->getCompositionState();
+        if (!compositionState) continue;
+        state.layers.push_back({.sequence = layerFE->getSequence(),
+                                .bufferId = compositionState->buffer
+                                        ? compositionState->buffer->getId()
+                                        : 0,
+                                .frameNumber = compositionState->frameNumber,
+                                .transform = compositionState->geomLayerTransform,
+                                .bounds = compositionState->geomLayerBounds,
+                                .alpha = compositionState->alpha,
+                                .color = compositionState->color,
+                                .backgroundBlurRadius = compositionState->backgroundBlurRadius,
+                                .colorTransform = compositionState->colorTransform,
+                                .dataspace = compositionState->dataspace});
+    }
+    return state;
+}
+
+bool RegionSamplingThread::isSameSampledState(const SampledState& lhs, const SampledState& rhs) {
+    const auto isSameDescriptor = [](const Descriptor& lhs, const Descriptor& rhs) {
+        return lhs.area == rhs.area && lhs.stopLayerId == rhs.stopLayerId &&
+                lhs.listener == rhs.listener;
+    };
+    const auto isSameLayer = [](const SampledLayer& lhs, const SampledLayer& rhs) {
+        return lhs.sequence == rhs.sequence && lhs.bufferId == rhs.bufferId &&
+                lhs.frameNumber == rhs.frameNumber && lhs.transform == rhs.transform &&
+                lhs.bounds == rhs.bounds && lhs.alpha == rhs.alpha && lhs.color == rhs.color &&
+                lhs.backgroundBlurRadius == rhs.backgroundBlurRadius &&
+                lhs.colorTransform == rhs.colorTransform && lhs.dataspace == rhs.dataspace;
+    };
+    return lhs.orientation == rhs.orientation &&
+            std::equal(lhs.descriptors.begin(), lhs.descriptors.end(), rhs.descriptors.begin(),
+                       rhs.descriptors.end(), isSameDescriptor) &&
+            std::equal(lhs.layers.begin(), lhs.layers.end(), rhs.layers.begin(),
+                       rhs.layers.end(), isSameLayer);
+}
+
 void RegionSamplingThread::captureSample() {
     SFTRACE_CALL();
     std::lock_guard lock(mSamplingMutex);
@@ -354,11 +398,20 @@ void RegionSamplingThread::captureSample() {
                               RenderArea::Options::CAPTURE_SECURE_LAYERS);
 
     FenceResult fenceResult;
+    std::optional<SampledState> sampledState;
     if (FlagManager::getInstance().single_hop_screenshot() &&
         FlagManager::getInstance().ce_fence_promise() && mFlinger.mRenderEngine->isThreaded()) {
         std::vector<sp<LayerFE>> layerFEs;
         auto displayState = mFlinger.getSnapshotsFromMainThread(renderAreaBuilder,
                                                                 getLayerSnapshotsFn, layerFEs);
+        if (FlagManager::getInstance().skip_unchanged_region_sampling()) {
+            sampledState = getSampledState(descriptors, orientation, layerFEs);
+            if (mLastSampledState && isSameSampledState(*sampledState, *mLastSampledState)) {
+                SFTRACE_NAME("Sampled layers unchanged");
+                SFTRACE_INT(lumaSamplingStepTag, static_cast<int>(samplingStep::noWorkNeeded));
+                return;
+            }
+        }
         fenceResult = mFlinger.captureScreenshot(renderAreaBuilder, buffer, kRegionSampling,
                                                  kGrayscale, kIsProtected, kAttachGainmap, nullptr,
                                                  displayState, layerFEs)
@@ -394,6 +447,7 @@ void RegionSamplingThread::captureSample() {
     }
 
     mCachedBuffer = buffer;
+    mLastSampledState = std::move(sampledState);
     SFTRACE_INT(lumaSamplingStepTag, static_cast<int>(samplingStep::noWorkNeeded));
 }
 
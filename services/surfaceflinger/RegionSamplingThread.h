@@ -20,16 +20,22 @@
 #include <android/gui/IRegionSamplingListener.h>
 #include <binder/IBinder.h>
 #include <renderengine/ExternalTexture.h>
+#include <math/mat4.h>
+#include <ui/FloatRect.h>
 #include <ui/GraphicBuffer.h>
+#include <ui/GraphicTypes.h>
 #include <ui/Rect.h>
+#include <ui/Transform.h>
 #include <utils/StrongPointer.h>
 
 #include <chrono>
 #include <condition_variable>
 #include <cstdint>
 #include <mutex>
+#include <optional>
 #include <thread>
 #include <unordered_map>
+#include <vector>
 
 #include "Scheduler/OneShotTimer.h"
 #include "WpHash.h"
@@ -37,6 +43,7 @@
 namespace android {
 
 class Layer;
+class LayerFE;
 class SurfaceFlinger;
 struct SamplingOffsetCallback;
 
@@ -102,6 +109,29 @@ private:
     void captureSample();
     void threadMain();
 
+    // The inputs of a sample that determine its lumas. A sample with the same inputs as the
+    // last one is skipped, since its listeners already have its lumas.
+    struct SampledLayer {
+        int32_t sequence;
+        uint64_t bufferId;
+        uint64_t frameNumber;
+        ui::Transform transform;
+        FloatRect bounds;
+        float alpha;
+        half4 color;
+        int backgroundBlurRadius;
+        mat4 colorTransform;
+        ui::Dataspace dataspace;
+    };
+    struct SampledState {
+        std::vector<Descriptor> descriptors;
+        uint32_t orientation;
+        std::vector<SampledLayer> layers;
+    };
+    static SampledState getSampledState(std::vector<Descriptor> descriptors, uint32_t orientation,
+                                        const std::vector<sp<LayerFE>>& layerFEs);
+    static bool isSameSampledState(const SampledState& lhs, const SampledState& rhs);
+
     SurfaceFlinger& mFlinger;
     const TimingTunables mTunables;
     scheduler::OneShotTimer mIdleTimer;
@@ -120,6 +150,7 @@ private:
     std::unordered_map<wp<IBinder>, Descriptor, WpHash> mDescriptors GUARDED_BY(mSamplingMutex);
     std::shared_ptr<renderengine::ExternalTexture> mCachedBuffer GUARDED_BY(mSamplingMutex) =
             nullptr;
+    std::optional<SampledState> mLastSampledState GUARDED_BY(mSamplingMutex);
 };
 
 } // namespace android
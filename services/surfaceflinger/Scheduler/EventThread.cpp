@@ -37,6 +37,8 @@
 #include <cutils/compiler.h>
 #include <cutils/sched_policy.h>
 
+#include <ftl/small_map.h>
+
 #include <gui/DisplayEventReceiver.h>
 #include <gui/SchedulingPolicy.h>
 
@@ -63,6 +65,17 @@ using base::StringPrintf;
 
 namespace {
 
+// With coalesce_vsync_wakeups, how late the vsync callback of an EventThread may run so that its
+// wakeup merges with that of a later callback, typically the one of SurfaceFlinger. Apps lose at
+// most this much of their frame budget.
+constexpr std::chrono::nanoseconds kCoalescedWakeupLatenessBudget = 500us;
+
+nsecs_t wakeupLatenessBudget() {
+    return FlagManager::getInstance().coalesce_vsync_wakeups()
+            ? kCoalescedWakeupLatenessBudget.count()
+            : 0;
+}
+
 auto vsyncPeriod(VSyncRequest request) {
     return static_cast<std::underlying_type_t<VSyncRequest>>(request);
 }
@@ -321,7 +334,8 @@ void EventThread::setDuration(std::chrono::nanoseconds workDuration,
     mVsyncRegistration.update({.workDuration = mWorkDuration.get().count(),
                                .readyDuration = mReadyDuration.count(),
                                .lastVsync = mLastVsyncCallbackTime.ns(),
-                               .committedVsyncOpt = mLastCommittedVsyncTime.ns()});
+                               .committedVsyncOpt = mLastCommittedVsyncTime.ns(),
+                               .latenessBudget = wakeupLatenessBudget()});
 }
 
 sp<EventThreadConnection> EventThread::createEventConnection(
@@ -532,7 +546,8 @@ void EventThread::threadMain(std::unique_lock<std::mutex>& lock) {
                     {.workDuration = mWorkDuration.get().count(),
                      .readyDuration = mReadyDuration.count(),
                      .lastVsync = mLastVsyncCallbackTime.ns(),
-                     .committedVsyncOpt = mLastCommittedVsyncTime.ns()});
+                     .committedVsyncOpt = mLastCommittedVsyncTime.ns(),
+                     .latenessBudget = wakeupLatenessBudget()});
             LOG_ALWAYS_FATAL_IF(!scheduleResult, "Error scheduling callback");
         } else {
             mVsyncRegistration.cancel();
@@ -701,14 +716,24 @@ void EventThread::generateFrameTimeline(VsyncEventData& outVsyncEventData, nsecs
 
 void EventThread::dispatchEvent(const DisplayEventReceiver::Event& event,
                                 const DisplayEventConsumers& consumers) {
+    // Consumers with the same frame interval get the same frame timelines. Generate them, along
+    // with their prediction tokens, once per frame interval rather than once per consumer.
+    ftl::SmallMap<nsecs_t, VsyncEventData, 2> vsyncDataByFrameInterval;
+
     for (const auto& consumer : consumers) {
         DisplayEventReceiver::Event copy = event;
         if (event.header.type == DisplayEventReceiver::DISPLAY_EVENT_VSYNC) {
             const Period frameInterval = mCallback.getVsyncPeriod(consumer->mOwnerUid);
-            copy.vsync.vsyncData.frameInterval = frameInterval.ns();
-            generateFrameTimeline(copy.vsync.vsyncData, frameInterval.ns(), copy.header.timestamp,
-                                  event.vsync.vsyncData.preferredExpectedPresentationTime(),
-                                  event.vsync.vsyncData.preferredDeadlineTimestamp());
+            const auto [it, inserted] =
+                    vsyncDataByFrameInterval.try_emplace(frameInterval.ns(), event.vsync.vsyncData);
+            auto& vsyncData = it->second;
+            if (inserted) {
+                vsyncData.frameInterval = frameInterval.ns();
+                generateFrameTimeline(vsyncData, frameInterval.ns(), copy.header.timestamp,
+                                      event.vsync.vsyncData.preferredExpectedPresentationTime(),
+                                      event.vsync.vsyncData.preferredDeadlineTimestamp());
+            }
+            copy.vsync.vsyncData = vsyncData;
         }
         switch (consumer->postEvent(copy)) {
             case NO_ERROR:
@@ -801,7 +826,8 @@ scheduler::VSyncCallbackRegistration EventThread::onNewVsyncScheduleInternal(
         mVsyncRegistration.schedule({.workDuration = mWorkDuration.get().count(),
                                      .readyDuration = mReadyDuration.count(),
                                      .lastVsync = mLastVsyncCallbackTime.ns(),
-                                     .committedVsyncOpt = mLastCommittedVsyncTime.ns()});
+                                     .committedVsyncOpt = mLastCommittedVsyncTime.ns(),
+                                     .latenessBudget = wakeupLatenessBudget()});
     }
     return oldRegistration;
 }
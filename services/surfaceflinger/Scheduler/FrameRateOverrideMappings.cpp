@@ -17,39 +17,44 @@
 #include "FrameRateOverrideMappings.h"
 #include <common/FlagManager.h>
 
+#include <algorithm>
+
 namespace android::scheduler {
 using FrameRateOverride = DisplayEventReceiver::Event::FrameRateOverride;
 
 std::optional<Fps> FrameRateOverrideMappings::getFrameRateOverrideForUid(
         uid_t uid, bool supportsFrameRateOverrideByContent) const {
-    std::lock_guard lock(mFrameRateOverridesLock);
-
-    {
-        const auto iter = mFrameRateOverridesFromBackdoor.find(uid);
-        if (iter != mFrameRateOverridesFromBackdoor.end()) {
-            return iter->second;
-        }
+    const auto table = std::atomic_load(&mResolvedOverrides);
+    const auto& overrides =
+            supportsFrameRateOverrideByContent ? table->withContent : table->withoutContent;
+
+    const auto iter = std::lower_bound(overrides.begin(), overrides.end(), uid,
+                                       [](const auto& entry, uid_t value) {
+                                           return entry.first < value;
+                                       });
+    if (iter != overrides.end() && iter->first == uid) {
+        return iter->second;
     }
 
+    return std::nullopt;
+}
+
+void FrameRateOverrideMappings::updateResolvedOverridesLocked() {
+    // std::map::insert does not replace an existing entry, so inserting the mappings from the
+    // highest priority to the lowest resolves the override of each UID.
+    UidToFrameRateOverride resolved = mFrameRateOverridesFromBackdoor;
     if (!FlagManager::getInstance().game_default_frame_rate()) {
-        const auto iter = mFrameRateOverridesFromGameManager.find(uid);
-        if (iter != mFrameRateOverridesFromGameManager.end()) {
-            return iter->second;
-        }
+        resolved.insert(mFrameRateOverridesFromGameManager.begin(),
+                        mFrameRateOverridesFromGameManager.end());
     }
 
-    if (!supportsFrameRateOverrideByContent) {
-        return std::nullopt;
-    }
+    auto table = std::make_shared<ResolvedOverridesTable>();
+    table->withoutContent.assign(resolved.begin(), resolved.end());
 
-    {
-        const auto iter = mFrameRateOverridesByContent.find(uid);
-        if (iter != mFrameRateOverridesByContent.end()) {
-            return iter->second;
-        }
-    }
+    resolved.insert(mFrameRateOverridesByContent.begin(), mFrameRateOverridesByContent.end());
+    table->withContent.assign(resolved.begin(), resolved.end());
 
-    return std::nullopt;
+    std::atomic_store(&mResolvedOverrides, std::shared_ptr<const ResolvedOverridesTable>(table));
 }
 
 std::vector<FrameRateOverride> FrameRateOverrideMappings::getAllFrameRateOverrides(
@@ -127,6 +132,7 @@ bool FrameRateOverrideMappings::updateFrameRateOverridesByContent(
                         return lhs.first == rhs.first && isApproxEqual(lhs.second, rhs.second);
                     })) {
         mFrameRateOverridesByContent = frameRateOverrides;
+        updateResolvedOverridesLocked();
         return true;
     }
     return false;
@@ -140,6 +146,7 @@ void FrameRateOverrideMappings::setGameModeRefreshRateForUid(FrameRateOverride f
     } else {
         mFrameRateOverridesFromGameManager.erase(frameRateOverride.uid);
     }
+    updateResolvedOverridesLocked();
 }
 
 void FrameRateOverrideMappings::setPreferredRefreshRateForUid(FrameRateOverride frameRateOverride) {
@@ -150,5 +157,6 @@ void FrameRateOverrideMappings::setPreferredRefreshRateForUid(FrameRateOverride
     } else {
         mFrameRateOverridesFromBackdoor.erase(frameRateOverride.uid);
     }
+    updateResolvedOverridesLocked();
 }
 } // namespace android::scheduler
@@ -21,7 +21,10 @@
 #include <scheduler/Fps.h>
 #include <sys/types.h>
 #include <map>
+#include <memory>
 #include <optional>
+#include <utility>
+#include <vector>
 
 #include "Utils/Dumper.h"
 
@@ -55,6 +58,17 @@ private:
 
     void dump(utils::Dumper&, std::string_view name, const UidToFrameRateOverride&) const;
 
+    // The override that applies to each UID after resolving the priority between the mappings,
+    // sorted by UID. Rebuilt whenever a mapping changes, so that the lookups on the vsync dispatch
+    // path are a single binary search that does not contend on mFrameRateOverridesLock.
+    using ResolvedOverrides = std::vector<std::pair<uid_t, Fps>>;
+    struct ResolvedOverridesTable {
+        ResolvedOverrides withContent;
+        ResolvedOverrides withoutContent;
+    };
+
+    void updateResolvedOverridesLocked() REQUIRES(mFrameRateOverridesLock);
+
     // The frame rate override lists need their own mutex as they are being read
     // by SurfaceFlinger, Scheduler and EventThread (as a callback) to prevent deadlocks
     mutable std::mutex mFrameRateOverridesLock;
@@ -64,6 +78,10 @@ private:
     UidToFrameRateOverride mFrameRateOverridesByContent GUARDED_BY(mFrameRateOverridesLock);
     UidToFrameRateOverride mFrameRateOverridesFromBackdoor GUARDED_BY(mFrameRateOverridesLock);
     UidToFrameRateOverride mFrameRateOverridesFromGameManager GUARDED_BY(mFrameRateOverridesLock);
+
+    // Written under mFrameRateOverridesLock, but read without it using std::atomic_load.
+    std::shared_ptr<const ResolvedOverridesTable> mResolvedOverrides =
+            std::make_shared<const ResolvedOverridesTable>();
 };
 
 } // namespace android::scheduler
@@ -190,8 +190,15 @@ void LayerHistory::setLayerProperties(int32_t id, const LayerProps& properties)
 }
 
 auto LayerHistory::summarize(const RefreshRateSelector& selector, nsecs_t now) -> Summary {
-    SFTRACE_CALL();
     Summary summary;
+    summarize(selector, now, summary);
+    return summary;
+}
+
+void LayerHistory::summarize(const RefreshRateSelector& selector, nsecs_t now,
+                             Summary& outSummary) {
+    SFTRACE_CALL();
+    size_t count = 0;
 
     std::lock_guard lock(mLock);
 
@@ -219,14 +226,31 @@ auto LayerHistory::summarize(const RefreshRateSelector& selector, nsecs_t now) -
 
             const float layerArea = transformed.getWidth() * transformed.getHeight();
             float weight = mDisplayArea ? layerArea / mDisplayArea : 0.0f;
-            const std::string categoryString = vote.category == FrameRateCategory::Default
-                    ? ""
-                    : base::StringPrintf("category=%s", ftl::enum_string(vote.category).c_str());
-            SFTRACE_FORMAT_INSTANT("%s %s %s (%.2f)", ftl::enum_string(vote.type).c_str(),
-                                   to_string(vote.fps).c_str(), categoryString.c_str(), weight);
-            summary.push_back({info->getName(), info->getOwnerUid(), vote.type, vote.fps,
-                               vote.seamlessness, vote.category, vote.categorySmoothSwitchOnly,
-                               weight, layerFocused});
+            if (CC_UNLIKELY(SFTRACE_ENABLED())) {
+                const std::string categoryString = vote.category == FrameRateCategory::Default
+                        ? ""
+                        : base::StringPrintf("category=%s",
+                                             ftl::enum_string(vote.category).c_str());
+                SFTRACE_FORMAT_INSTANT("%s %s %s (%.2f)", ftl::enum_string(vote.type).c_str(),
+                                       to_string(vote.fps).c_str(), categoryString.c_str(),
+                                       weight);
+            }
+
+            // Assign each field rather than the whole requirement, so that the name reuses
+            // the capacity of the string it replaces.
+            if (count == outSummary.size()) {
+                outSummary.emplace_back();
+            }
+            auto& requirement = outSummary[count++];
+            requirement.name = info->getName();
+            requirement.ownerUid = info->getOwnerUid();
+            requirement.vote = vote.type;
+            requirement.desiredRefreshRate = vote.fps;
+            requirement.seamlessness = vote.seamlessness;
+            requirement.frameRateCategory = vote.category;
+            requirement.frameRateCategorySmoothSwitchOnly = vote.categorySmoothSwitchOnly;
+            requirement.weight = weight;
+            requirement.focused = layerFocused;
 
             if (CC_UNLIKELY(mTraceEnabled)) {
                 trace(*info, vote.type, vote.fps.getIntValue());
@@ -234,7 +258,7 @@ auto LayerHistory::summarize(const RefreshRateSelector& selector, nsecs_t now) -
         }
     }
 
-    return summary;
+    outSummary.resize(count);
 }
 
 void LayerHistory::partitionLayers(nsecs_t now, bool isVrrDevice) {
@@ -81,6 +81,10 @@ public:
     // Rebuilds sets of active/inactive layers, and accumulates stats for active layers.
     Summary summarize(const RefreshRateSelector&, nsecs_t now);
 
+    // Same as above, but overwrites the given summary in place so that its storage, including
+    // the layer names, is reused rather than reallocated on every frame.
+    void summarize(const RefreshRateSelector&, nsecs_t now, Summary& outSummary);
+
     void clear();
 
     void deregisterLayer(Layer*);
@@ -72,10 +72,8 @@ void LayerInfo::setLastPresentTime(nsecs_t lastPresentTime, nsecs_t now, LayerUp
                                        .queueTime = mLastUpdatedTime,
                                        .pendingModeChange = pendingModeChange,
                                        .isSmallDirty = props.isSmallDirty};
-            mFrameTimes.push_back(frameTime);
-            if (mFrameTimes.size() > HISTORY_SIZE) {
-                mFrameTimes.pop_front();
-            }
+            // Overwrites the oldest frame once the history is full.
+            mFrameTimes.next() = frameTime;
             break;
     }
 }
@@ -157,21 +155,21 @@ LayerInfo::Frequent LayerInfo::isFrequent(nsecs_t now) const {
 
 Fps LayerInfo::getFps(nsecs_t now) const {
     // Find the first active frame
-    auto it = mFrameTimes.begin();
-    for (; it != mFrameTimes.end(); ++it) {
-        if (it->queueTime >= getActiveLayerThreshold(now)) {
+    size_t first = 0;
+    for (; first < mFrameTimes.size(); first++) {
+        if (mFrameTimes[first].queueTime >= getActiveLayerThreshold(now)) {
             break;
         }
     }
 
-    const auto numFrames = std::distance(it, mFrameTimes.end());
+    const size_t numFrames = mFrameTimes.size() - first;
     if (numFrames < kFrequentLayerWindowSize) {
         return Fps();
     }
 
     // Layer is considered frequent if the average frame rate is higher than the threshold
-    const auto totalTime = mFrameTimes.back().queueTime - it->queueTime;
-    return Fps::fromPeriodNsecs(totalTime / (numFrames - 1));
+    const auto totalTime = mFrameTimes.back().queueTime - mFrameTimes[first].queueTime;
+    return Fps::fromPeriodNsecs(totalTime / static_cast<nsecs_t>(numFrames - 1));
 }
 
 bool LayerInfo::isAnimating(nsecs_t now) const {
@@ -202,16 +200,16 @@ bool LayerInfo::hasEnoughDataForHeuristic() const {
 
 std::optional<nsecs_t> LayerInfo::calculateAverageFrameTime() const {
     // Ignore frames captured during a mode change
-    const bool isDuringModeChange =
-            std::any_of(mFrameTimes.begin(), mFrameTimes.end(),
-                        [](const auto& frame) { return frame.pendingModeChange; });
+    bool isDuringModeChange = false;
+    bool isMissingPresentTime = false;
+    for (size_t i = 0; i < mFrameTimes.size(); i++) {
+        isDuringModeChange |= mFrameTimes[i].pendingModeChange;
+        isMissingPresentTime |= mFrameTimes[i].presentTime == 0;
+    }
     if (isDuringModeChange) {
         return std::nullopt;
     }
 
-    const bool isMissingPresentTime =
-            std::any_of(mFrameTimes.begin(), mFrameTimes.end(),
-                        [](auto frame) { return frame.presentTime == 0; });
     if (isMissingPresentTime && !mLastRefreshRate.reported.isValid()) {
         // If there are no presentation timestamps and we haven't calculated
         // one in the past then we can't calculate the refresh rate
@@ -232,9 +230,10 @@ std::optional<nsecs_t> LayerInfo::calculateAverageFrameTime() const {
     nsecs_t totalDeltas = 0;
     int numDeltas = 0;
     int32_t smallDirtyCount = 0;
-    auto prevFrame = mFrameTimes.begin();
-    for (auto it = mFrameTimes.begin() + 1; it != mFrameTimes.end(); ++it) {
-        const auto currDelta = getFrameTime(*it) - getFrameTime(*prevFrame);
+    size_t prevFrame = 0;
+    for (size_t i = 1; i < mFrameTimes.size(); i++) {
+        const FrameTimeData& frame = mFrameTimes[i];
+        const auto currDelta = getFrameTime(frame) - getFrameTime(mFrameTimes[prevFrame]);
         if (currDelta < kMinPeriodBetweenFrames) {
             // Skip this frame, but count the delta into the next frame
             continue;
@@ -242,12 +241,12 @@ std::optional<nsecs_t> LayerInfo::calculateAverageFrameTime() const {
 
         // If this is a small area update, we don't want to consider it for calculating the average
         // frame time. Instead, we let the bigger frame updates to drive the calculation.
-        if (it->isSmallDirty && currDelta < kMinPeriodBetweenSmallDirtyFrames) {
+        if (frame.isSmallDirty && currDelta < kMinPeriodBetweenSmallDirtyFrames) {
             smallDirtyCount++;
             continue;
         }
 
-        prevFrame = it;
+        prevFrame = i;
 
         if (currDelta > kMaxPeriodBetweenFrames) {
             // Skip this frame and the current delta.
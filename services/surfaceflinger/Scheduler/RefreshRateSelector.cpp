@@ -21,6 +21,7 @@
 #pragma clang diagnostic push
 #pragma clang diagnostic ignored "-Wextra"
 
+#include <algorithm>
 #include <chrono>
 #include <cmath>
 #include <deque>
@@ -33,6 +34,7 @@
 #include <ftl/fake_guard.h>
 #include <ftl/match.h>
 #include <ftl/unit.h>
+#include <math/HashCombine.h>
 #include <scheduler/FrameRateMode.h>
 
 #include "RefreshRateSelector.h"
@@ -476,17 +478,43 @@ float RefreshRateSelector::calculateLayerScoreLocked(const LayerRequirement& lay
 auto RefreshRateSelector::getRankedFrameRates(const std::vector<LayerRequirement>& layers,
                                               GlobalSignals signals, Fps pacesetterFps) const
         -> RankedFrameRates {
-    GetRankedFrameRatesCache cache{layers, signals, pacesetterFps};
+    const size_t hash = GetRankedFrameRatesCache::computeHash(layers, signals);
 
     std::lock_guard lock(mLock);
 
-    if (mGetRankedFrameRatesCache && mGetRankedFrameRatesCache->matches(cache)) {
-        return mGetRankedFrameRatesCache->result;
+    // Compare against the cache before copying the layers into it, since the layers rarely change
+    // from one frame to the next.
+    auto& cache = mGetRankedFrameRatesCache;
+    const auto it = std::find_if(cache.begin(), cache.end(), [&](const auto& entry) {
+        return entry.matches(layers, signals, pacesetterFps, hash);
+    });
+    if (it != cache.end()) {
+        std::rotate(cache.begin(), it, it + 1);
+        return cache.front().result;
     }
 
-    cache.result = getRankedFrameRatesLocked(layers, signals, pacesetterFps);
-    mGetRankedFrameRatesCache = std::move(cache);
-    return mGetRankedFrameRatesCache->result;
+    auto result = getRankedFrameRatesLocked(layers, signals, pacesetterFps);
+
+    if (cache.size() == kGetRankedFrameRatesCacheSize) {
+        cache.pop_back();
+    }
+    cache.push_back(GetRankedFrameRatesCache{layers, signals, pacesetterFps, hash, result});
+    std::rotate(cache.begin(), cache.end() - 1, cache.end());
+    return result;
+}
+
+size_t RefreshRateSelector::GetRankedFrameRatesCache::computeHash(
+        const std::vector<LayerRequirement>& layers, GlobalSignals signals) {
+    size_t hash = hashCombine(signals.touch, signals.idle, signals.powerOnImminent);
+    for (const auto& layer : layers) {
+        hashCombineSingle(hash, layer.name);
+        hashCombineSingle(hash, layer.vote);
+        hashCombineSingle(hash, layer.seamlessness);
+        hashCombineSingle(hash, layer.weight);
+        hashCombineSingle(hash, layer.focused);
+        hashCombineSingle(hash, layer.frameRateCategory);
+    }
+    return hash;
 }
 
 auto RefreshRateSelector::getRankedFrameRatesLocked(const std::vector<LayerRequirement>& layers,
@@ -1249,7 +1277,7 @@ void RefreshRateSelector::setActiveMode(DisplayModeId modeId, Fps renderFrameRat
 
     // Invalidate the cached invocation to getRankedFrameRates. This forces
     // the refresh rate to be recomputed on the next call to getRankedFrameRates.
-    mGetRankedFrameRatesCache.reset();
+    mGetRankedFrameRatesCache.clear();
 
     const auto activeModeOpt = mDisplayModes.get(modeId);
     LOG_ALWAYS_FATAL_IF(!activeModeOpt);
@@ -1290,7 +1318,7 @@ void RefreshRateSelector::updateDisplayModes(DisplayModes modes, DisplayModeId a
 
     // Invalidate the cached invocation to getRankedFrameRates. This forces
     // the refresh rate to be recomputed on the next call to getRankedFrameRates.
-    mGetRankedFrameRatesCache.reset();
+    mGetRankedFrameRatesCache.clear();
 
     mDisplayModes = std::move(modes);
     const auto activeModeOpt = mDisplayModes.get(activeModeId);
@@ -1390,7 +1418,7 @@ auto RefreshRateSelector::setPolicy(const PolicyVariant& policy) -> SetPolicyRes
             return SetPolicyResult::Invalid;
         }
 
-        mGetRankedFrameRatesCache.reset();
+        mGetRankedFrameRatesCache.clear();
 
         const auto& idleScreenConfigOpt = getCurrentPolicyLocked()->idleScreenConfigOpt;
         if (idleScreenConfigOpt != oldPolicy.idleScreenConfigOpt) {
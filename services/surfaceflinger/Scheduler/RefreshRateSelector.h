@@ -22,6 +22,7 @@
 
 #include <ftl/concat.h>
 #include <ftl/optional.h>
+#include <ftl/small_vector.h>
 #include <ftl/unit.h>
 #include <gui/DisplayEventReceiver.h>
 
@@ -571,15 +572,27 @@ private:
         std::vector<LayerRequirement> layers;
         GlobalSignals signals;
         Fps pacesetterFps;
+        size_t hash = 0;
 
         RankedFrameRates result;
 
-        bool matches(const GetRankedFrameRatesCache& other) const {
-            return layers == other.layers && signals == other.signals &&
-                    isApproxEqual(pacesetterFps, other.pacesetterFps);
+        // Hashes the fields that LayerRequirement compares exactly, so that the hash of equal
+        // requirements never differs. The approximately compared refresh rates are left out.
+        static size_t computeHash(const std::vector<LayerRequirement>&, GlobalSignals);
+
+        bool matches(const std::vector<LayerRequirement>& otherLayers, GlobalSignals otherSignals,
+                     Fps otherPacesetterFps, size_t otherHash) const {
+            return hash == otherHash && layers == otherLayers && signals == otherSignals &&
+                    isApproxEqual(pacesetterFps, otherPacesetterFps);
         }
     };
-    mutable std::optional<GetRankedFrameRatesCache> mGetRankedFrameRatesCache GUARDED_BY(mLock);
+
+    // Layer votes tend to flip between a few stable states, e.g. during video playback or
+    // scrolling, so a few of the most recent rankings are kept, most recently used first. The
+    // cache is cleared whenever the modes or the policy change, so they are not part of the key.
+    static constexpr size_t kGetRankedFrameRatesCacheSize = 4;
+    mutable ftl::SmallVector<GetRankedFrameRatesCache, kGetRankedFrameRatesCacheSize>
+            mGetRankedFrameRatesCache GUARDED_BY(mLock);
 
     // Declare mIdleTimer last to ensure its thread joins before the mutex/callbacks are destroyed.
     std::mutex mIdleTimerCallbacksMutex;
@@ -709,8 +709,8 @@ void Scheduler::chooseRefreshRateForContent(
 
     SFTRACE_CALL();
 
-    LayerHistory::Summary summary = mLayerHistory.summarize(*selectorPtr, systemTime());
-    applyPolicy(&Policy::contentRequirements, std::move(summary));
+    mLayerHistory.summarize(*selectorPtr, systemTime(), mLayerHistorySummary);
+    applyPolicy(&Policy::contentRequirements, mLayerHistorySummary);
 
     if (updateAttachedChoreographer) {
         LOG_ALWAYS_FATAL_IF(!hierarchy);
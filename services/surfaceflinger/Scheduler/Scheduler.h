@@ -480,6 +480,10 @@ private:
     // Used to choose refresh rate if content detection is enabled.
     LayerHistory mLayerHistory;
 
+    // Reused by chooseRefreshRateForContent on every frame. The policy only copies it when the
+    // content requirements change.
+    LayerHistory::Summary mLayerHistorySummary;
+
     // Timer used to monitor touch events.
     ftl::Optional<OneShotTimer> mTouchTimer;
     // Timer used to monitor display power mode.
@@ -104,10 +104,14 @@ public:
         nsecs_t readyDuration = 0;
         nsecs_t lastVsync = 0;
         std::optional<nsecs_t> committedVsyncOpt;
+        // How late the callback may be dispatched past its wakeup time. A nonzero budget lets the
+        // dispatcher delay the wakeup so that it coalesces with the wakeup of a later callback.
+        nsecs_t latenessBudget = 0;
 
         bool operator==(const ScheduleTiming& other) const {
             return workDuration == other.workDuration && readyDuration == other.readyDuration &&
-                    lastVsync == other.lastVsync && committedVsyncOpt == other.committedVsyncOpt;
+                    lastVsync == other.lastVsync && committedVsyncOpt == other.committedVsyncOpt &&
+                    latenessBudget == other.latenessBudget;
         }
 
         bool operator!=(const ScheduleTiming& other) const { return !(*this == other); }
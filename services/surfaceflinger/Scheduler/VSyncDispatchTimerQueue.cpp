@@ -82,6 +82,13 @@ std::optional<nsecs_t> VSyncDispatchTimerQueueEntry::wakeupTime() const {
     return {mArmedInfo->mActualWakeupTime};
 }
 
+std::optional<nsecs_t> VSyncDispatchTimerQueueEntry::latestWakeupTime() const {
+    if (!mArmedInfo) {
+        return {};
+    }
+    return {mArmedInfo->mActualWakeupTime + mScheduleTiming.latenessBudget};
+}
+
 std::optional<nsecs_t> VSyncDispatchTimerQueueEntry::readyTime() const {
     if (!mArmedInfo) {
         return {};
@@ -267,12 +274,14 @@ void VSyncDispatchTimerQueueEntry::dump(std::string& result) const {
     StringAppendF(&result,
                   "\t\t\tworkDuration: %.2fms readyDuration: %.2fms "
                   "lastVsync: %.2fms relative to now "
-                  "committedVsync: %.2fms relative to now\n",
+                  "committedVsync: %.2fms relative to now "
+                  "latenessBudget: %.2fms\n",
                   mScheduleTiming.workDuration / 1e6f, mScheduleTiming.readyDuration / 1e6f,
                   (mScheduleTiming.lastVsync - systemTime()) / 1e6f,
                   (mScheduleTiming.committedVsyncOpt.value_or(mScheduleTiming.lastVsync) -
                    systemTime()) /
-                          1e6f);
+                          1e6f,
+                  mScheduleTiming.latenessBudget / 1e6f);
 
     if (mLastDispatchTime) {
         StringAppendF(&result, "\t\t\tmLastDispatchTime: %.2fms ago\n",
@@ -302,6 +311,7 @@ VSyncDispatchTimerQueue::~VSyncDispatchTimerQueue() {
 
 void VSyncDispatchTimerQueue::cancelTimer() {
     mIntendedWakeupTime = kInvalidTime;
+    mIntendedLatestWakeupTime = kInvalidTime;
     mTimeKeeper->alarmCancel();
 }
 
@@ -320,6 +330,7 @@ void VSyncDispatchTimerQueue::rearmTimerSkippingUpdateFor(
         nsecs_t now, CallbackMap::const_iterator skipUpdateIt) {
     SFTRACE_CALL();
     std::optional<nsecs_t> min;
+    std::optional<nsecs_t> latest;
     std::optional<nsecs_t> targetVsync;
     std::optional<std::string_view> nextWakeupName;
     for (auto it = mCallbacks.cbegin(); it != mCallbacks.cend(); ++it) {
@@ -340,10 +351,31 @@ void VSyncDispatchTimerQueue::rearmTimerSkippingUpdateFor(
             min = wakeupTime;
             targetVsync = callback->targetVsync();
         }
+        const auto latestWakeupTime = *callback->latestWakeupTime();
+        if (!latest || *latest > latestWakeupTime) {
+            latest = latestWakeupTime;
+        }
+    }
+
+    // The earliest callback is only dispatched late if another callback wakes up within its
+    // lateness budget, in which case the timer is armed for the latest such wakeup so that a
+    // single expiry dispatches both. Otherwise, the timer is armed for the earliest wakeup.
+    std::optional<nsecs_t> target = min;
+    if (min && *latest > *min + mTimerSlack) {
+        for (const auto& [_, callback] : mCallbacks) {
+            const auto wakeupTime = callback->wakeupTime();
+            if (wakeupTime && *wakeupTime > *target && *wakeupTime <= *latest) {
+                target = wakeupTime;
+            }
+        }
+        if (*target <= *min + mTimerSlack) {
+            target = min;
+        }
     }
 
-    if (min && min < mIntendedWakeupTime) {
-        setTimer(*min, now);
+    if (target) {
+        setTimer(*target, now);
+        mIntendedLatestWakeupTime = *latest;
     } else {
         SFTRACE_NAME("cancel timer");
         cancelTimer();
@@ -448,7 +480,14 @@ std::optional<ScheduleResult> VSyncDispatchTimerQueue::scheduleLocked(
 
     const auto result = callback->schedule(scheduleTiming, *mTracker, now);
 
-    if (callback->wakeupTime() < mIntendedWakeupTime - mTimerSlack) {
+    // Rearm if the callback wakes up before the timer, or if it wakes up within the lateness
+    // budget of the timer, in which case the timer may be delayed to dispatch both at once.
+    const auto wakeupTime = callback->wakeupTime();
+    const bool earlier = wakeupTime < mIntendedWakeupTime - mTimerSlack;
+    const bool coalescible = wakeupTime && mIntendedWakeupTime != kInvalidTime &&
+            *wakeupTime > mIntendedWakeupTime + mTimerSlack &&
+            *wakeupTime <= mIntendedLatestWakeupTime;
+    if (earlier || coalescible) {
         rearmTimerSkippingUpdateFor(now, it);
     }
 
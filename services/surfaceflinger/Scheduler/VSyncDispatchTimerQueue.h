@@ -56,6 +56,10 @@ public:
     // It will not update the wakeupTime.
     std::optional<nsecs_t> wakeupTime() const;
 
+    // Returns the wakeup time plus the lateness budget of the callback, i.e. the last time at
+    // which the timer may fire for it. Empty if not armed.
+    std::optional<nsecs_t> latestWakeupTime() const;
+
     std::optional<nsecs_t> readyTime() const;
 
     std::optional<nsecs_t> targetVsync() const;
@@ -166,6 +170,8 @@ private:
 
     CallbackMap mCallbacks GUARDED_BY(mMutex);
     nsecs_t mIntendedWakeupTime GUARDED_BY(mMutex) = kInvalidTime;
+    // The earliest time at which an armed callback must be dispatched, given its lateness budget.
+    nsecs_t mIntendedLatestWakeupTime GUARDED_BY(mMutex) = kInvalidTime;
 
     // For debugging purposes
     nsecs_t mLastTimerCallback GUARDED_BY(mMutex) = kInvalidTime;
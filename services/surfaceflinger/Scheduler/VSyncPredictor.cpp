@@ -26,6 +26,7 @@
 #include <algorithm>
 #include <chrono>
 #include <sstream>
+#include <utility>
 
 #include <android-base/logging.h>
 #include <android-base/stringprintf.h>
@@ -200,9 +201,6 @@ bool VSyncPredictor::addVsyncTimestamp(nsecs_t timestamp) {
     //
     // intercept = mean(Y) - slope * mean(X)
     //
-    std::vector<nsecs_t> vsyncTS(numSamples);
-    std::vector<nsecs_t> ordinals(numSamples);
-
     // Normalizing to the oldest timestamp cuts down on error in calculating the intercept.
     const auto oldestTS = *std::min_element(mTimestamps.begin(), mTimestamps.end());
     auto it = mRateMap.find(idealPeriod());
@@ -212,34 +210,36 @@ bool VSyncPredictor::addVsyncTimestamp(nsecs_t timestamp) {
     // fixed-point arithmetic.
     constexpr int64_t kScalingFactor = 1000;
 
+    // The samples are normalized and snapped on the fly in both passes below, rather than copied
+    // into temporary arrays, since this runs for every HW vsync.
+    const auto sampleAt = [&](size_t i) -> std::pair<nsecs_t, nsecs_t> {
+        const auto timestamp = mTimestamps[i] - oldestTS;
+        const auto ordinal = currentPeriod == 0
+                ? 0
+                : (timestamp + currentPeriod / 2) / currentPeriod * kScalingFactor;
+        return {timestamp, ordinal};
+    };
+
     nsecs_t meanTS = 0;
     nsecs_t meanOrdinal = 0;
 
     for (size_t i = 0; i < numSamples; i++) {
-        const auto timestamp = mTimestamps[i] - oldestTS;
-        vsyncTS[i] = timestamp;
+        const auto [timestamp, ordinal] = sampleAt(i);
         meanTS += timestamp;
-
-        const auto ordinal = currentPeriod == 0
-                ? 0
-                : (vsyncTS[i] + currentPeriod / 2) / currentPeriod * kScalingFactor;
-        ordinals[i] = ordinal;
         meanOrdinal += ordinal;
     }
 
     meanTS /= numSamples;
     meanOrdinal /= numSamples;
 
-    for (size_t i = 0; i < numSamples; i++) {
-        vsyncTS[i] -= meanTS;
-        ordinals[i] -= meanOrdinal;
-    }
-
     nsecs_t top = 0;
     nsecs_t bottom = 0;
     for (size_t i = 0; i < numSamples; i++) {
-        top += vsyncTS[i] * ordinals[i];
-        bottom += ordinals[i] * ordinals[i];
+        auto [timestamp, ordinal] = sampleAt(i);
+        timestamp -= meanTS;
+        ordinal -= meanOrdinal;
+        top += timestamp * ordinal;
+        bottom += ordinal * ordinal;
     }
 
     if (CC_UNLIKELY(bottom == 0)) {
@@ -82,6 +82,7 @@ renderengine::DisplaySettings ScreenCaptureOutput::generateClientCompositionDisp
     auto clientCompositionDisplay =
             compositionengine::impl::Output::generateClientCompositionDisplaySettings(buffer);
     clientCompositionDisplay.clip = mRenderArea.getSourceCrop();
+    clientCompositionDisplay.isScreenshot = true;
 
     auto renderIntent = static_cast<ui::RenderIntent>(clientCompositionDisplay.renderIntent);
     if (mDimInGammaSpaceForEnhancedScreenshots && renderIntent != ui::RenderIntent::COLORIMETRIC &&
@@ -104,6 +105,24 @@ renderengine::DisplaySettings ScreenCaptureOutput::generateClientCompositionDisp
     return clientCompositionDisplay;
 }
 
+float ScreenCaptureOutput::getCaptureScale(const RenderArea& renderArea) {
+    const Rect sourceCrop = renderArea.getSourceCrop();
+    if (sourceCrop.isEmpty()) {
+        return 1.f;
+    }
+
+    // A source crop rotated by 90 or 270 degrees fills the output with its width along the
+    // output's height.
+    ui::Size sourceSize = sourceCrop.getSize();
+    if (renderArea.getTransform().getOrientation() & ui::Transform::ROT_90) {
+        std::swap(sourceSize.width, sourceSize.height);
+    }
+    return std::min(static_cast<float>(renderArea.getReqWidth()) /
+                            static_cast<float>(sourceSize.width),
+                    static_cast<float>(renderArea.getReqHeight()) /
+                            static_cast<float>(sourceSize.height));
+}
+
 std::vector<compositionengine::LayerFE::LayerSettings>
 ScreenCaptureOutput::generateClientCompositionRequests(
         bool supportsProtectedContent, ui::Dataspace outputDataspace,
@@ -117,6 +136,21 @@ ScreenCaptureOutput::generateClientCompositionRequests(
             layer.backgroundBlurRadius = 0;
             layer.blurRegions.clear();
         }
+    } else if (const float scale = getCaptureScale(mRenderArea); scale < 1.f) {
+        // For downscaled captures such as thumbnails, drop the blurs and shadows that would span
+        // less than a pixel of the output. They can't be seen at this size, but they still cost
+        // extra passes in RenderEngine.
+        for (auto& layer : clientCompositionLayers) {
+            if (static_cast<float>(layer.backgroundBlurRadius) * scale < 1.f) {
+                layer.backgroundBlurRadius = 0;
+            }
+            std::erase_if(layer.blurRegions, [scale](const BlurRegion& region) {
+                return static_cast<float>(region.blurRadius) * scale < 1.f;
+            });
+            if (layer.shadow.length * scale < 1.f) {
+                layer.shadow.length = 0.f;
+            }
+        }
     }
 
     if (outputDataspace == ui::Dataspace::BT2020_HLG) {
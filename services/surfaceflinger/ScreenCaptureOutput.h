@@ -59,6 +59,10 @@ public:
             bool supportsProtectedContent, ui::Dataspace outputDataspace,
             std::vector<compositionengine::LayerFE*>& outLayerFEs) override;
 
+    // The ratio of the output size to the size of the captured area, once rotated by the render
+    // area's transform. Less than 1 when the capture is downscaled.
+    static float getCaptureScale(const RenderArea&);
+
 protected:
     bool getSkipColorTransform() const override { return false; }
     renderengine::DisplaySettings generateClientCompositionDisplaySettings(
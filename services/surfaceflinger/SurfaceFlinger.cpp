@@ -136,6 +136,7 @@
 #include "DisplayRenderArea.h"
 #include "Effects/Daltonizer.h"
 #include "FpsReporter.h"
+#include "FrameStageTracker.h"
 #include "FrameTimeline/FrameTimeline.h"
 #include "FrameTracer/FrameTracer.h"
 #include "FrontEnd/LayerCreationArgs.h"
@@ -484,6 +485,9 @@ SurfaceFlinger::SurfaceFlinger(Factory& factory) : SurfaceFlinger(factory, SkipI
 
     mDebugFlashDelay = base::GetUintProperty("debug.sf.showupdates"s, 0u);
 
+    mFrameStageTracker.setAllocationBudget(
+            base::GetUintProperty("debug.sf.frame_allocation_budget"s, uint64_t{0}));
+
     mBackpressureGpuComposition = base::GetBoolProperty("debug.sf.enable_gl_backpressure"s, true);
     ALOGI_IF(mBackpressureGpuComposition, "Enabling backpressure for GPU composition");
 
@@ -2371,6 +2375,7 @@ bool SurfaceFlinger::updateLayerSnapshots(VsyncId vsyncId, nsecs_t frameTimeNs,
     frontend::Update update;
     if (flushTransactions) {
         SFTRACE_NAME("TransactionHandler:flushTransactions");
+        FrameStageTracker::ScopedStage stage(mFrameStageTracker, FrameStage::TransactionFlush);
         // Locking:
         // 1. to prevent onHandleDestroyed from being called while the state lock is held,
         // we must keep a copy of the transactions (specifically the composer
@@ -2420,6 +2425,7 @@ bool SurfaceFlinger::updateLayerSnapshots(VsyncId vsyncId, nsecs_t frameTimeNs,
 
     {
         SFTRACE_NAME("LayerSnapshotBuilder:update");
+        FrameStageTracker::ScopedStage stage(mFrameStageTracker, FrameStage::SnapshotBuild);
         frontend::LayerSnapshotBuilder::Args
                 args{.root = mLayerHierarchyBuilder.getHierarchy(),
                      .layerLifecycleManager = mLayerLifecycleManager,
@@ -2559,6 +2565,8 @@ bool SurfaceFlinger::commit(PhysicalDisplayId pacesetterId,
     const VsyncId vsyncId = pacesetterFrameTarget.vsyncId();
     SFTRACE_NAME(ftl::Concat(__func__, ' ', ftl::to_underlying(vsyncId)).c_str());
 
+    mFrameStageTracker.beginFrame(ftl::to_underlying(vsyncId));
+
     if (pacesetterFrameTarget.didMissFrame()) {
         mTimeStats->incrementMissedFrames();
     }
@@ -2699,7 +2707,11 @@ bool SurfaceFlinger::commit(PhysicalDisplayId pacesetterId,
 
     persistDisplayBrightness(mustComposite);
 
-    return mustComposite && CC_LIKELY(mBootStage != BootStage::BOOTLOADER);
+    const bool shouldComposite = mustComposite && CC_LIKELY(mBootStage != BootStage::BOOTLOADER);
+    if (!shouldComposite) {
+        mFrameStageTracker.endFrame();
+    }
+    return shouldComposite;
 }
 
 CompositeResultsPerDisplay SurfaceFlinger::composite(
@@ -2820,6 +2832,17 @@ CompositeResultsPerDisplay SurfaceFlinger::composite(
         layer->onPreComposition(refreshArgs.refreshStartTime);
     }
 
+    // Let PowerAdvisor forecast the cost of this frame before composing it.
+    if (mPowerHintSessionEnabled) {
+        const auto blurLayerCount = static_cast<size_t>(
+                std::count_if(layers.begin(), layers.end(), [](const auto& layerAndFE) {
+                    const auto& snapshot = layerAndFE.second->mSnapshot;
+                    return snapshot &&
+                            (snapshot->backgroundBlurRadius > 0 || !snapshot->blurRegions.empty());
+                }));
+        mPowerAdvisor->setCompositionWorkload(layers.size(), blurLayerCount);
+    }
+
     if (FlagManager::getInstance().ce_fence_promise()) {
         for (auto& [layer, layerFE] : layers) {
             attachReleaseFenceFutureToLayer(layer, layerFE,
@@ -2843,7 +2866,12 @@ CompositeResultsPerDisplay SurfaceFlinger::composite(
             }
         }
 
-        mCompositionEngine->present(refreshArgs);
+        {
+            FrameStageTracker::ScopedStage stage(mFrameStageTracker, FrameStage::Composition);
+            mCompositionEngine->present(refreshArgs);
+        }
+
+        FrameStageTracker::ScopedStage stage(mFrameStageTracker, FrameStage::Release);
         moveSnapshotsFromCompositionArgs(refreshArgs, layers);
 
         for (auto& [layer, layerFE] : layers) {
@@ -2854,7 +2882,12 @@ CompositeResultsPerDisplay SurfaceFlinger::composite(
         }
 
     } else {
-        mCompositionEngine->present(refreshArgs);
+        {
+            FrameStageTracker::ScopedStage stage(mFrameStageTracker, FrameStage::Composition);
+            mCompositionEngine->present(refreshArgs);
+        }
+
+        FrameStageTracker::ScopedStage stage(mFrameStageTracker, FrameStage::Release);
         moveSnapshotsFromCompositionArgs(refreshArgs, layers);
 
         for (auto [layer, layerFE] : layers) {
@@ -2869,6 +2902,8 @@ CompositeResultsPerDisplay SurfaceFlinger::composite(
     }
 
     SFTRACE_NAME("postComposition");
+    std::optional<FrameStageTracker::ScopedStage> postCompositionStage;
+    postCompositionStage.emplace(mFrameStageTracker, FrameStage::PostComposition);
     mTimeStats->recordFrameDuration(pacesetterTarget.frameBeginTime().ns(), systemTime());
 
     // Send a power hint after presentation is finished.
@@ -2940,6 +2975,7 @@ CompositeResultsPerDisplay SurfaceFlinger::composite(
     mLayersIdsWithQueuedFrames.clear();
     doActiveLayersTracingIfNeeded(true, mVisibleRegionsDirty, pacesetterTarget.frameBeginTime(),
                                   vsyncId);
+    postCompositionStage.reset();
 
     updateInputFlinger(vsyncId, pacesetterTarget.frameBeginTime());
 
@@ -2963,6 +2999,7 @@ CompositeResultsPerDisplay SurfaceFlinger::composite(
         }
     }
 
+    mFrameStageTracker.endFrame();
     return resultsPerDisplay;
 }
 
@@ -3980,6 +4017,7 @@ void SurfaceFlinger::updateInputFlinger(VsyncId vsyncId, TimePoint frameTime) {
         return;
     }
     SFTRACE_CALL();
+    FrameStageTracker::ScopedStage stage(mFrameStageTracker, FrameStage::InputUpdate);
 
     std::vector<WindowInfo> windowInfos;
     std::vector<DisplayInfo> displayInfos;
@@ -3990,26 +4028,27 @@ void SurfaceFlinger::updateInputFlinger(VsyncId vsyncId, TimePoint frameTime) {
         buildWindowInfos(windowInfos, displayInfos);
     }
 
-    std::unordered_set<int32_t> visibleWindowIds;
-    for (WindowInfo& windowInfo : windowInfos) {
-        if (!windowInfo.inputConfig.test(WindowInfo::InputConfig::NOT_VISIBLE)) {
-            visibleWindowIds.insert(windowInfo.id);
-        }
-    }
-    bool visibleWindowsChanged = false;
-    if (visibleWindowIds != mVisibleWindowIds) {
-        visibleWindowsChanged = true;
-        mVisibleWindowIds = std::move(visibleWindowIds);
-    }
-
+    // Everything past copying the windows out of the snapshots is done off the main thread.
     BackgroundExecutor::getInstance().sendCallbacks({[updateWindowInfo,
                                                       windowInfos = std::move(windowInfos),
                                                       displayInfos = std::move(displayInfos),
                                                       inputWindowCommands =
                                                               std::move(mInputWindowCommands),
-                                                      inputFlinger = mInputFlinger, this,
-                                                      visibleWindowsChanged, vsyncId, frameTime]() {
+                                                      inputFlinger = mInputFlinger, this, vsyncId,
+                                                      frameTime]() mutable {
         SFTRACE_NAME("BackgroundExecutor::updateInputFlinger");
+        std::unordered_set<int32_t> visibleWindowIds;
+        for (const WindowInfo& windowInfo : windowInfos) {
+            if (!windowInfo.inputConfig.test(WindowInfo::InputConfig::NOT_VISIBLE)) {
+                visibleWindowIds.insert(windowInfo.id);
+            }
+        }
+        bool visibleWindowsChanged = false;
+        if (visibleWindowIds != mVisibleWindowIds) {
+            visibleWindowsChanged = true;
+            mVisibleWindowIds = std::move(visibleWindowIds);
+        }
+
         if (updateWindowInfo) {
             mWindowInfosListenerInvoker
                     ->windowInfosChanged(gui::WindowInfosUpdate{std::move(windowInfos),
@@ -5518,6 +5557,8 @@ status_t SurfaceFlinger::doDump(int fd, const DumpArgs& args, bool asProto) {
             {"--displays"s, dumper(&SurfaceFlinger::dumpDisplays)},
             {"--edid"s, argsDumper(&SurfaceFlinger::dumpRawDisplayIdentificationData)},
             {"--events"s, dumper(&SurfaceFlinger::dumpEvents)},
+            {"--frame-allocations"s, argsDumper(&SurfaceFlinger::dumpFrameAllocations)},
+            {"--frame-stages"s, dumper(&SurfaceFlinger::dumpFrameStages)},
             {"--frametimeline"s, argsDumper(&SurfaceFlinger::dumpFrameTimeline)},
             {"--frontend"s, mainThreadDumper(&SurfaceFlinger::dumpFrontEnd)},
             {"--hdrinfo"s, dumper(&SurfaceFlinger::dumpHdrInfo)},
@@ -5555,6 +5596,13 @@ status_t SurfaceFlinger::doDump(int fd, const DumpArgs& args, bool asProto) {
                   windowInfosDebug.maxSendDelayDuration);
     StringAppendF(&compositionLayers, "  unsent messages: %zu\n",
                   windowInfosDebug.pendingMessageCount);
+    for (const auto& listener : windowInfosDebug.listeners) {
+        StringAppendF(&compositionLayers,
+                      "  listener %" PRId64 ": coalesced updates: %" PRIu64
+                      ", max ack latency: %" PRId64 " ns, current lag: %" PRId64 " ns\n",
+                      listener.listenerId, listener.coalescedUpdateCount, listener.maxAckLatency,
+                      listener.currentLag);
+    }
     compositionLayers.append("\n");
     dumpAll(args, compositionLayers, result);
     write(fd, result.c_str(), result.size());
@@ -5598,6 +5646,30 @@ void SurfaceFlinger::dumpTimeStats(const DumpArgs& args, bool asProto, std::stri
     mTimeStats->parseArgs(asProto, args, result);
 }
 
+void SurfaceFlinger::dumpFrameStages(std::string& result) const {
+    mFrameStageTracker.dump(result);
+}
+
+void SurfaceFlinger::dumpFrameAllocations(const DumpArgs& args, std::string& result) {
+    // Usage: --frame-allocations [enable|disable] [budget <allocations>]
+    for (size_t i = 1; i < args.size(); i++) {
+        if (args[i] == String16("enable")) {
+            mFrameStageTracker.setAllocationCountingEnabled(true);
+        } else if (args[i] == String16("disable")) {
+            mFrameStageTracker.setAllocationCountingEnabled(false);
+        } else if (args[i] == String16("budget") && i + 1 < args.size()) {
+            uint64_t budget;
+            if (!base::ParseUint(String8(args[++i]).c_str(), &budget)) {
+                result.append("Invalid allocation budget\n");
+                return;
+            }
+            mFrameStageTracker.setAllocationBudget(budget);
+        }
+    }
+
+    mFrameStageTracker.dump(result);
+}
+
 void SurfaceFlinger::dumpFrameTimeline(const DumpArgs& args, std::string& result) const {
     mFrameTimeline->parseArgs(args, result);
 }
@@ -7245,6 +7317,10 @@ void SurfaceFlinger::captureScreenCommon(RenderAreaBuilderVariant renderAreaBuil
                 GRALLOC_USAGE_HW_TEXTURE |
                 (isProtected ? GRALLOC_USAGE_PROTECTED
                              : GRALLOC_USAGE_SW_READ_OFTEN | GRALLOC_USAGE_SW_WRITE_OFTEN);
+        // Unlike RegionSamplingThread, which keeps its buffer because it
+        // never leaves SurfaceFlinger, captures can't be drawn into pooled buffers: the buffer is
+        // handed to the client, and nothing tells us when the client is done with it. Reusing
+        // buffers would need CaptureArgs to carry a client-owned output buffer.
         sp<GraphicBuffer> buffer =
                 getFactory().createGraphicBuffer(bufferSize.getWidth(), bufferSize.getHeight(),
                                                  static_cast<android_pixel_format>(reqPixelFormat),
@@ -8287,39 +8363,47 @@ SurfaceFlinger::getLayerSnapshotsForScreenshots(
         std::function<bool(const frontend::LayerSnapshot&, bool& outStopTraversal)>
                 snapshotFilterFn) {
     return [&, layerStack, uid]() FTL_FAKE_GUARD(kMainThreadContext) {
-        std::vector<std::pair<Layer*, sp<LayerFE>>> layers;
-        bool stopTraversal = false;
-        mLayerSnapshotBuilder.forEachVisibleSnapshot(
-                [&](std::unique_ptr<frontend::LayerSnapshot>& snapshot) FTL_FAKE_GUARD(
-                        kMainThreadContext) {
-                    if (stopTraversal) {
-                        return;
-                    }
-                    if (layerStack && snapshot->outputFilter.layerStack != *layerStack) {
-                        return;
-                    }
-                    if (uid != CaptureArgs::UNSET_UID && snapshot->uid != gui::Uid(uid)) {
-                        return;
-                    }
-                    if (!snapshot->hasSomethingToDraw()) {
-                        return;
-                    }
-                    if (snapshotFilterFn && !snapshotFilterFn(*snapshot, stopTraversal)) {
-                        return;
-                    }
+        return getLayerSnapshotsFromBuilder(mLayerSnapshotBuilder, layerStack, uid,
+                                            snapshotFilterFn);
+    };
+}
 
-                    auto it = mLegacyLayers.find(snapshot->sequence);
-                    LLOG_ALWAYS_FATAL_WITH_TRACE_IF(it == mLegacyLayers.end(),
-                                                    "Couldnt find layer object for %s",
-                                                    snapshot->getDebugString().c_str());
-                    Layer* legacyLayer = (it == mLegacyLayers.end()) ? nullptr : it->second.get();
-                    sp<LayerFE> layerFE = getFactory().createLayerFE(snapshot->name, legacyLayer);
-                    layerFE->mSnapshot = std::make_unique<frontend::LayerSnapshot>(*snapshot);
-                    layers.emplace_back(legacyLayer, std::move(layerFE));
-                });
+std::vector<std::pair<Layer*, sp<LayerFE>>> SurfaceFlinger::getLayerSnapshotsFromBuilder(
+        const frontend::LayerSnapshotBuilder& snapshotBuilder,
+        std::optional<ui::LayerStack> layerStack, uint32_t uid,
+        const std::function<bool(const frontend::LayerSnapshot&, bool& outStopTraversal)>&
+                snapshotFilterFn) {
+    std::vector<std::pair<Layer*, sp<LayerFE>>> layers;
+    bool stopTraversal = false;
+    snapshotBuilder.forEachVisibleSnapshot(
+            [&](const frontend::LayerSnapshot& snapshot) FTL_FAKE_GUARD(kMainThreadContext) {
+                if (stopTraversal) {
+                    return;
+                }
+                if (layerStack && snapshot.outputFilter.layerStack != *layerStack) {
+                    return;
+                }
+                if (uid != CaptureArgs::UNSET_UID && snapshot.uid != gui::Uid(uid)) {
+                    return;
+                }
+                if (!snapshot.hasSomethingToDraw()) {
+                    return;
+                }
+                if (snapshotFilterFn && !snapshotFilterFn(snapshot, stopTraversal)) {
+                    return;
+                }
 
-        return layers;
-    };
+                auto it = mLegacyLayers.find(snapshot.sequence);
+                LLOG_ALWAYS_FATAL_WITH_TRACE_IF(it == mLegacyLayers.end(),
+                                                "Couldnt find layer object for %s",
+                                                snapshot.getDebugString().c_str());
+                Layer* legacyLayer = (it == mLegacyLayers.end()) ? nullptr : it->second.get();
+                sp<LayerFE> layerFE = getFactory().createLayerFE(snapshot.name, legacyLayer);
+                layerFE->mSnapshot = std::make_unique<frontend::LayerSnapshot>(snapshot);
+                layers.emplace_back(legacyLayer, std::move(layerFE));
+            });
+
+    return layers;
 }
 
 std::function<std::vector<std::pair<Layer*, sp<LayerFE>>>()>
@@ -8350,16 +8434,11 @@ SurfaceFlinger::getLayerSnapshotsForScreenshots(std::optional<ui::LayerStack> la
                      .genericLayerMetadataKeyMap = getGenericLayerMetadataKeyMap(),
                      .skipRoundCornersWhenProtected =
                              !getRenderEngine().supportsProtectedContent()};
-        mLayerSnapshotBuilder.update(args);
-
-        auto getLayerSnapshotsFn =
-                getLayerSnapshotsForScreenshots(layerStack, uid, /*snapshotFilterFn=*/nullptr);
-        std::vector<std::pair<Layer*, sp<LayerFE>>> layers = getLayerSnapshotsFn();
-
-        args.excludeLayerIds.clear();
-        mLayerSnapshotBuilder.update(args);
-
-        return layers;
+        // Build the snapshots without the excluded layers separately, so that the snapshots of
+        // the next frame don't need to be rebuilt to bring the excluded layers back.
+        const frontend::LayerSnapshotBuilder snapshotBuilder(std::move(args));
+        return getLayerSnapshotsFromBuilder(snapshotBuilder, layerStack, uid,
+                                            /*snapshotFilterFn=*/nullptr);
     };
 }
 
@@ -8391,16 +8470,11 @@ SurfaceFlinger::getLayerSnapshotsForScreenshots(uint32_t rootLayerId, uint32_t u
         // after. In this case, the hierarchy will be empty so we will not render any layers.
         args.rootSnapshot.isSecure = mLayerLifecycleManager.getLayerFromId(rootLayerId) &&
                 mLayerLifecycleManager.isLayerSecure(rootLayerId);
-        mLayerSnapshotBuilder.update(args);
-
-        auto getLayerSnapshotsFn =
-                getLayerSnapshotsForScreenshots({}, uid, /*snapshotFilterFn=*/nullptr);
-        std::vector<std::pair<Layer*, sp<LayerFE>>> layers = getLayerSnapshotsFn();
-        args.root = mLayerHierarchyBuilder.getHierarchy();
-        args.parentCrop.reset();
-        args.excludeLayerIds.clear();
-        mLayerSnapshotBuilder.update(args);
-        return layers;
+        // Build the snapshots of the partial hierarchy separately, so that the snapshots of the
+        // next frame don't need to be rebuilt from the full hierarchy.
+        const frontend::LayerSnapshotBuilder snapshotBuilder(std::move(args));
+        return getLayerSnapshotsFromBuilder(snapshotBuilder, {}, uid,
+                                            /*snapshotFilterFn=*/nullptr);
     };
 }
 
@@ -8418,6 +8492,9 @@ void SurfaceFlinger::doActiveLayersTracingIfNeeded(bool isCompositionComputed,
         !mLayerTracing.isActiveTracingFlagSet(LayerTracing::Flag::TRACE_BUFFERS)) {
         return;
     }
+    if (!mLayerTracing.shouldTakeActiveSnapshot()) {
+        return;
+    }
     auto snapshot = takeLayersSnapshotProto(mLayerTracing.getActiveTracingFlags(), time, vsyncId,
                                             visibleRegionDirty);
     mLayerTracing.addProtoSnapshotToOstream(std::move(snapshot), LayerTracing::Mode::MODE_ACTIVE);
@@ -73,6 +73,7 @@
 #include "DisplayHardware/PowerAdvisor.h"
 #include "DisplayIdGenerator.h"
 #include "Effects/Daltonizer.h"
+#include "FrameStageTracker.h"
 #include "FrontEnd/DisplayInfo.h"
 #include "FrontEnd/LayerCreationArgs.h"
 #include "FrontEnd/LayerLifecycleManager.h"
@@ -1107,6 +1108,8 @@ private:
     void clearStats(const DumpArgs& args, std::string& result) REQUIRES(kMainThreadContext);
     void dumpTimeStats(const DumpArgs& args, bool asProto, std::string& result) const;
     void dumpFrameTimeline(const DumpArgs& args, std::string& result) const;
+    void dumpFrameStages(std::string& result) const;
+    void dumpFrameAllocations(const DumpArgs& args, std::string& result);
     void logFrameStats(TimePoint now) REQUIRES(kMainThreadContext);
 
     void dumpScheduler(std::string& result) const REQUIRES(mStateLock);
@@ -1302,6 +1305,9 @@ private:
     const std::unique_ptr<FrameTracer> mFrameTracer;
     const std::unique_ptr<frametimeline::FrameTimeline> mFrameTimeline;
 
+    // Written by the main thread in commit and composite, read without locking by dumpsys.
+    FrameStageTracker mFrameStageTracker;
+
     VsyncId mLastCommittedVsyncId;
 
     // If blurs should be enabled on this device.
@@ -1406,6 +1412,13 @@ private:
     std::function<std::vector<std::pair<Layer*, sp<LayerFE>>>()> getLayerSnapshotsForScreenshots(
             uint32_t rootLayerId, uint32_t uid, std::unordered_set<uint32_t> excludeLayerIds,
             bool childrenOnly, const std::optional<FloatRect>& optionalParentCrop);
+    // Creates a LayerFE with a copy of each visible snapshot of the builder that passes the
+    // filters.
+    std::vector<std::pair<Layer*, sp<LayerFE>>> getLayerSnapshotsFromBuilder(
+            const frontend::LayerSnapshotBuilder&, std::optional<ui::LayerStack> layerStack,
+            uint32_t uid,
+            const std::function<bool(const frontend::LayerSnapshot&, bool& outStopTraversal)>&
+                    snapshotFilterFn) REQUIRES(kMainThreadContext);
 
     const sp<WindowInfosListenerInvoker> mWindowInfosListenerInvoker;
 
@@ -1441,8 +1454,9 @@ private:
             GUARDED_BY(kMainThreadContext);
     bool mFrontEndDisplayInfosChanged GUARDED_BY(kMainThreadContext) = false;
 
-    // WindowInfo ids visible during the last commit.
-    std::unordered_set<int32_t> mVisibleWindowIds GUARDED_BY(kMainThreadContext);
+    // WindowInfo ids visible during the last commit. Only accessed on the BackgroundExecutor
+    // thread.
+    std::unordered_set<int32_t> mVisibleWindowIds;
 
     // Mirroring
     // Map of displayid to mirrorRoot
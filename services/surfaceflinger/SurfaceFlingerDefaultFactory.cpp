@@ -95,7 +95,15 @@ std::unique_ptr<FrameTracer> DefaultFactory::createFrameTracer() {
 
 std::unique_ptr<frametimeline::FrameTimeline> DefaultFactory::createFrameTimeline(
         std::shared_ptr<TimeStats> timeStats, pid_t surfaceFlingerPid) {
-    return std::make_unique<frametimeline::impl::FrameTimeline>(timeStats, surfaceFlingerPid);
+    using frametimeline::JankClassificationThresholds;
+    constexpr bool kUseBootTimeClock = true;
+    constexpr bool kFilterFramesBeforeTraceStarts = true;
+    constexpr bool kClassifyJankInBackground = true;
+    return std::make_unique<frametimeline::impl::FrameTimeline>(timeStats, surfaceFlingerPid,
+                                                                JankClassificationThresholds{},
+                                                                kUseBootTimeClock,
+                                                                kFilterFramesBeforeTraceStarts,
+                                                                kClassifyJankInBackground);
 }
 
 } // namespace android::surfaceflinger
@@ -25,6 +25,9 @@
 #include <utils/String8.h>
 #include <utils/Timers.h>
 
+#include <pthread.h>
+#include <sched.h>
+
 #include <algorithm>
 #include <chrono>
 #include <cmath>
@@ -93,6 +96,8 @@ SurfaceflingerStatsLayerInfo_SetFrameRateVote frameRateVoteToProto(
 
 bool TimeStats::populateGlobalAtom(std::vector<uint8_t>* pulledData) {
     std::lock_guard<std::mutex> lock(mMutex);
+    applyPendingUpdatesLocked();
+    std::lock_guard<std::mutex> statsLock(mStatsMutex);
 
     if (mTimeStats.statsStartLegacy == 0) {
         return false;
@@ -146,6 +151,8 @@ bool TimeStats::populateGlobalAtom(std::vector<uint8_t>* pulledData) {
 
 bool TimeStats::populateLayerAtom(std::vector<uint8_t>* pulledData) {
     std::lock_guard<std::mutex> lock(mMutex);
+    applyPendingUpdatesLocked();
+    std::lock_guard<std::mutex> statsLock(mStatsMutex);
 
     std::vector<TimeStatsHelper::TimeStatsLayer*> dumpStats;
     uint32_t numLayers = 0;
@@ -253,6 +260,90 @@ TimeStats::TimeStats(std::optional<size_t> maxPulledLayers,
     if (maxPulledHistogramBuckets) {
         mMaxPulledHistogramBuckets = *maxPulledHistogramBuckets;
     }
+
+    mAggregationThread = std::thread(&TimeStats::runAggregationThread, this);
+    pthread_setname_np(mAggregationThread.native_handle(), "TimeStats");
+}
+
+TimeStats::~TimeStats() {
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStopAggregation = true;
+    }
+    mPendingUpdatesCondition.notify_one();
+    mAggregationThread.join();
+}
+
+void TimeStats::enqueueUpdateLocked(PendingUpdate update) {
+    if (std::holds_alternative<int32_t>(update) && !mPendingUpdates.empty() &&
+        mPendingUpdates.back() == update) {
+        // the layer is already going to be flushed
+        return;
+    }
+
+    // The thread applies every pending update once woken, so only wake it for the first one.
+    const bool wasEmpty = mPendingUpdates.empty();
+    mPendingUpdates.push_back(std::move(update));
+    if (wasEmpty) {
+        mPendingUpdatesCondition.notify_one();
+    }
+}
+
+void TimeStats::takePendingUpdatesLocked(std::vector<StatsUpdate>* outUpdates) {
+    for (PendingUpdate& update : mPendingUpdates) {
+        if (const int32_t* layerId = std::get_if<int32_t>(&update)) {
+            takeReadyFramesLocked(*layerId, outUpdates);
+        } else {
+            outUpdates->push_back(std::move(std::get<JankyFramesInfo>(update)));
+        }
+    }
+    mPendingUpdates.clear();
+}
+
+void TimeStats::applyStatsUpdatesLocked(const std::vector<StatsUpdate>& updates) {
+    for (const StatsUpdate& update : updates) {
+        if (const LayerFrame* frame = std::get_if<LayerFrame>(&update)) {
+            addLayerFrameLocked(*frame);
+        } else {
+            incrementJankyFramesLocked(std::get<JankyFramesInfo>(update));
+        }
+    }
+}
+
+void TimeStats::applyPendingUpdatesLocked() {
+    std::vector<StatsUpdate> updates;
+    takePendingUpdatesLocked(&updates);
+    std::lock_guard<std::mutex> statsLock(mStatsMutex);
+    applyStatsUpdatesLocked(updates);
+}
+
+void TimeStats::runAggregationThread() {
+    // Aggregation is background work, and must not compete with the main thread.
+    struct sched_param param = {0};
+    sched_setscheduler(0, SCHED_NORMAL, &param);
+
+    std::vector<StatsUpdate> updates;
+    std::unique_lock<std::mutex> lock(mMutex);
+    while (true) {
+        mPendingUpdatesCondition.wait(lock, [this] {
+            return mStopAggregation || !mPendingUpdates.empty();
+        });
+        if (mStopAggregation) {
+            return;
+        }
+
+        // Only taking the frames out of the layer records needs mMutex, so the main thread can
+        // record timestamps while they are aggregated. mStatsMutex is taken before mMutex is
+        // released, so that a reader waits for the updates taken out so far.
+        updates.clear();
+        takePendingUpdatesLocked(&updates);
+        {
+            std::lock_guard<std::mutex> statsLock(mStatsMutex);
+            lock.unlock();
+            applyStatsUpdatesLocked(updates);
+        }
+        lock.lock();
+    }
 }
 
 bool TimeStats::onPullAtom(const int atomId, std::vector<uint8_t>* pulledData) {
@@ -308,6 +399,8 @@ std::string TimeStats::miniDump() {
 
     std::string result = "TimeStats miniDump:\n";
     std::lock_guard<std::mutex> lock(mMutex);
+    applyPendingUpdatesLocked();
+    std::lock_guard<std::mutex> statsLock(mStatsMutex);
     android::base::StringAppendF(&result, "Number of layers currently being tracked is %zu\n",
                                  mTimeStatsTracker.size());
     android::base::StringAppendF(&result, "Number of layers in the stats pool is %zu\n",
@@ -441,99 +534,66 @@ static int32_t clampToNearestBucket(Fps fps, size_t bucketWidth) {
     return std::round(fps.getValue() / bucketWidth) * bucketWidth;
 }
 
-void TimeStats::flushAvailableRecordsToStatsLocked(int32_t layerId, Fps displayRefreshRate,
-                                                   std::optional<Fps> renderRate,
-                                                   SetFrameRateVote frameRateVote,
-                                                   GameMode gameMode) {
+void TimeStats::flushAvailableRecordsToStatsLocked(int32_t layerId) {
+    std::vector<StatsUpdate> updates;
+    takeReadyFramesLocked(layerId, &updates);
+    std::lock_guard<std::mutex> statsLock(mStatsMutex);
+    applyStatsUpdatesLocked(updates);
+}
+
+void TimeStats::takeReadyFramesLocked(int32_t layerId, std::vector<StatsUpdate>* outUpdates) {
     SFTRACE_CALL();
-    ALOGV("[%d]-flushAvailableRecordsToStatsLocked", layerId);
+    ALOGV("[%d]-takeReadyFramesLocked", layerId);
 
-    LayerRecord& layerRecord = mTimeStatsTracker[layerId];
+    const auto layerRecordIt = mTimeStatsTracker.find(layerId);
+    if (layerRecordIt == mTimeStatsTracker.end()) return;
+    LayerRecord& layerRecord = layerRecordIt->second;
     TimeRecord& prevTimeRecord = layerRecord.prevTimeRecord;
     std::optional<int32_t>& prevPresentToPresentMs = layerRecord.prevPresentToPresentMs;
     std::deque<TimeRecord>& timeRecords = layerRecord.timeRecords;
-    const int32_t refreshRateBucket =
-            clampToNearestBucket(displayRefreshRate, REFRESH_RATE_BUCKET_WIDTH);
-    const int32_t renderRateBucket =
-            clampToNearestBucket(renderRate ? *renderRate : displayRefreshRate,
-                                 RENDER_RATE_BUCKET_WIDTH);
     while (!timeRecords.empty()) {
         if (!recordReadyLocked(layerId, &timeRecords[0])) break;
         ALOGV("[%d]-[%" PRIu64 "]-presentFenceTime[%" PRId64 "]", layerId,
               timeRecords[0].frameTime.frameNumber, timeRecords[0].frameTime.presentTime);
 
         if (prevTimeRecord.ready) {
-            uid_t uid = layerRecord.uid;
-            const std::string& layerName = layerRecord.layerName;
-            TimeStatsHelper::TimelineStatsKey timelineKey = {refreshRateBucket, renderRateBucket};
-            if (!mTimeStats.stats.count(timelineKey)) {
-                mTimeStats.stats[timelineKey].key = timelineKey;
-            }
-
-            TimeStatsHelper::TimelineStats& displayStats = mTimeStats.stats[timelineKey];
-
-            TimeStatsHelper::LayerStatsKey layerKey = {uid, layerName, gameMode};
-            if (!displayStats.stats.count(layerKey)) {
-                displayStats.stats[layerKey].displayRefreshRateBucket = refreshRateBucket;
-                displayStats.stats[layerKey].renderRateBucket = renderRateBucket;
-                displayStats.stats[layerKey].uid = uid;
-                displayStats.stats[layerKey].layerName = layerName;
-                displayStats.stats[layerKey].gameMode = gameMode;
-            }
-            if (frameRateVote.frameRate > 0.0f) {
-                displayStats.stats[layerKey].setFrameRateVote = frameRateVote;
+            const FrameTime& frameTime = timeRecords[0].frameTime;
+            const Fps displayRefreshRate = timeRecords[0].displayRefreshRate;
+            const std::optional<Fps> renderRate = timeRecords[0].renderRate;
+            LayerFrame frame = {
+                    .timelineKey = {clampToNearestBucket(displayRefreshRate,
+                                                         REFRESH_RATE_BUCKET_WIDTH),
+                                    clampToNearestBucket(renderRate ? *renderRate
+                                                                    : displayRefreshRate,
+                                                         RENDER_RATE_BUCKET_WIDTH)},
+                    .layerKey = {layerRecord.uid, layerRecord.layerName, timeRecords[0].gameMode},
+                    .frameRateVote = timeRecords[0].frameRateVote,
+                    .droppedFrames = layerRecord.droppedFrames,
+                    .lateAcquireFrames = layerRecord.lateAcquireFrames,
+                    .badDesiredPresentFrames = layerRecord.badDesiredPresentFrames,
+                    .postToAcquireMs = msBetween(frameTime.postTime, frameTime.acquireTime),
+                    .postToPresentMs = msBetween(frameTime.postTime, frameTime.presentTime),
+                    .acquireToPresentMs = msBetween(frameTime.acquireTime, frameTime.presentTime),
+                    .latchToPresentMs = msBetween(frameTime.latchTime, frameTime.presentTime),
+                    .desiredToPresentMs = msBetween(frameTime.desiredTime, frameTime.presentTime),
+                    .presentToPresentMs = msBetween(prevTimeRecord.frameTime.presentTime,
+                                                    frameTime.presentTime),
+            };
+            ALOGV("[%d]-[%" PRIu64 "]-post2acquire[%d]-post2present[%d]-acquire2present[%d]"
+                  "-latch2present[%d]-desired2present[%d]-present2present[%d]",
+                  layerId, frameTime.frameNumber, frame.postToAcquireMs, frame.postToPresentMs,
+                  frame.acquireToPresentMs, frame.latchToPresentMs, frame.desiredToPresentMs,
+                  frame.presentToPresentMs);
+            if (prevPresentToPresentMs) {
+                frame.presentToPresentDeltaMs =
+                        std::abs(frame.presentToPresentMs - *prevPresentToPresentMs);
             }
-            TimeStatsHelper::TimeStatsLayer& timeStatsLayer = displayStats.stats[layerKey];
-            timeStatsLayer.totalFrames++;
-            timeStatsLayer.droppedFrames += layerRecord.droppedFrames;
-            timeStatsLayer.lateAcquireFrames += layerRecord.lateAcquireFrames;
-            timeStatsLayer.badDesiredPresentFrames += layerRecord.badDesiredPresentFrames;
+            prevPresentToPresentMs = frame.presentToPresentMs;
 
             layerRecord.droppedFrames = 0;
             layerRecord.lateAcquireFrames = 0;
             layerRecord.badDesiredPresentFrames = 0;
-
-            const int32_t postToAcquireMs = msBetween(timeRecords[0].frameTime.postTime,
-                                                      timeRecords[0].frameTime.acquireTime);
-            ALOGV("[%d]-[%" PRIu64 "]-post2acquire[%d]", layerId,
-                  timeRecords[0].frameTime.frameNumber, postToAcquireMs);
-            timeStatsLayer.deltas["post2acquire"].insert(postToAcquireMs);
-
-            const int32_t postToPresentMs = msBetween(timeRecords[0].frameTime.postTime,
-                                                      timeRecords[0].frameTime.presentTime);
-            ALOGV("[%d]-[%" PRIu64 "]-post2present[%d]", layerId,
-                  timeRecords[0].frameTime.frameNumber, postToPresentMs);
-            timeStatsLayer.deltas["post2present"].insert(postToPresentMs);
-
-            const int32_t acquireToPresentMs = msBetween(timeRecords[0].frameTime.acquireTime,
-                                                         timeRecords[0].frameTime.presentTime);
-            ALOGV("[%d]-[%" PRIu64 "]-acquire2present[%d]", layerId,
-                  timeRecords[0].frameTime.frameNumber, acquireToPresentMs);
-            timeStatsLayer.deltas["acquire2present"].insert(acquireToPresentMs);
-
-            const int32_t latchToPresentMs = msBetween(timeRecords[0].frameTime.latchTime,
-                                                       timeRecords[0].frameTime.presentTime);
-            ALOGV("[%d]-[%" PRIu64 "]-latch2present[%d]", layerId,
-                  timeRecords[0].frameTime.frameNumber, latchToPresentMs);
-            timeStatsLayer.deltas["latch2present"].insert(latchToPresentMs);
-
-            const int32_t desiredToPresentMs = msBetween(timeRecords[0].frameTime.desiredTime,
-                                                         timeRecords[0].frameTime.presentTime);
-            ALOGV("[%d]-[%" PRIu64 "]-desired2present[%d]", layerId,
-                  timeRecords[0].frameTime.frameNumber, desiredToPresentMs);
-            timeStatsLayer.deltas["desired2present"].insert(desiredToPresentMs);
-
-            const int32_t presentToPresentMs = msBetween(prevTimeRecord.frameTime.presentTime,
-                                                         timeRecords[0].frameTime.presentTime);
-            ALOGV("[%d]-[%" PRIu64 "]-present2present[%d]", layerId,
-                  timeRecords[0].frameTime.frameNumber, presentToPresentMs);
-            timeStatsLayer.deltas["present2present"].insert(presentToPresentMs);
-            if (prevPresentToPresentMs) {
-                const int32_t presentToPresentDeltaMs =
-                        std::abs(presentToPresentMs - *prevPresentToPresentMs);
-                timeStatsLayer.deltas["present2presentDelta"].insert(presentToPresentDeltaMs);
-            }
-            prevPresentToPresentMs = presentToPresentMs;
+            outUpdates->push_back(std::move(frame));
         }
         prevTimeRecord = timeRecords[0];
         timeRecords.pop_front();
@@ -541,6 +601,43 @@ void TimeStats::flushAvailableRecordsToStatsLocked(int32_t layerId, Fps displayR
     }
 }
 
+void TimeStats::addLayerFrameLocked(const LayerFrame& frame) {
+    const TimeStatsHelper::TimelineStatsKey& timelineKey = frame.timelineKey;
+    if (!mTimeStats.stats.count(timelineKey)) {
+        mTimeStats.stats[timelineKey].key = timelineKey;
+    }
+
+    TimeStatsHelper::TimelineStats& displayStats = mTimeStats.stats[timelineKey];
+
+    const TimeStatsHelper::LayerStatsKey& layerKey = frame.layerKey;
+    if (!displayStats.stats.count(layerKey)) {
+        displayStats.stats[layerKey].displayRefreshRateBucket =
+                timelineKey.displayRefreshRateBucket;
+        displayStats.stats[layerKey].renderRateBucket = timelineKey.renderRateBucket;
+        displayStats.stats[layerKey].uid = layerKey.uid;
+        displayStats.stats[layerKey].layerName = layerKey.layerName;
+        displayStats.stats[layerKey].gameMode = layerKey.gameMode;
+    }
+    if (frame.frameRateVote.frameRate > 0.0f) {
+        displayStats.stats[layerKey].setFrameRateVote = frame.frameRateVote;
+    }
+    TimeStatsHelper::TimeStatsLayer& timeStatsLayer = displayStats.stats[layerKey];
+    timeStatsLayer.totalFrames++;
+    timeStatsLayer.droppedFrames += frame.droppedFrames;
+    timeStatsLayer.lateAcquireFrames += frame.lateAcquireFrames;
+    timeStatsLayer.badDesiredPresentFrames += frame.badDesiredPresentFrames;
+
+    timeStatsLayer.deltas["post2acquire"].insert(frame.postToAcquireMs);
+    timeStatsLayer.deltas["post2present"].insert(frame.postToPresentMs);
+    timeStatsLayer.deltas["acquire2present"].insert(frame.acquireToPresentMs);
+    timeStatsLayer.deltas["latch2present"].insert(frame.latchToPresentMs);
+    timeStatsLayer.deltas["desired2present"].insert(frame.desiredToPresentMs);
+    timeStatsLayer.deltas["present2present"].insert(frame.presentToPresentMs);
+    if (frame.presentToPresentDeltaMs) {
+        timeStatsLayer.deltas["present2presentDelta"].insert(*frame.presentToPresentDeltaMs);
+    }
+}
+
 static constexpr const char* kPopupWindowPrefix = "PopupWindow";
 static const size_t kMinLenLayerName = std::strlen(kPopupWindowPrefix);
 
@@ -552,6 +649,7 @@ static bool layerNameIsValid(const std::string& layerName) {
 
 bool TimeStats::canAddNewAggregatedStats(uid_t uid, const std::string& layerName,
                                          GameMode gameMode) {
+    std::lock_guard<std::mutex> statsLock(mStatsMutex);
     uint32_t layerRecords = 0;
     for (const auto& record : mTimeStats.stats) {
         if (record.second.stats.count({uid, layerName, gameMode}) > 0) {
@@ -584,6 +682,10 @@ void TimeStats::setPostTime(int32_t layerId, uint64_t frameNumber, const std::st
     }
     if (!mTimeStatsTracker.count(layerId)) return;
     LayerRecord& layerRecord = mTimeStatsTracker[layerId];
+    if (layerRecord.timeRecords.size() == MAX_NUM_TIME_RECORDS) {
+        // the records may only be waiting for the aggregation thread
+        flushAvailableRecordsToStatsLocked(layerId);
+    }
     if (layerRecord.timeRecords.size() == MAX_NUM_TIME_RECORDS) {
         ALOGE("[%d]-[%s]-timeRecords is at its maximum size[%zu]. Ignore this when unittesting.",
               layerId, layerRecord.layerName.c_str(), MAX_NUM_TIME_RECORDS);
@@ -730,12 +832,15 @@ void TimeStats::setPresentTime(int32_t layerId, uint64_t frameNumber, nsecs_t pr
     TimeRecord& timeRecord = layerRecord.timeRecords[layerRecord.waitData];
     if (timeRecord.frameTime.frameNumber == frameNumber) {
         timeRecord.frameTime.presentTime = presentTime;
+        timeRecord.displayRefreshRate = displayRefreshRate;
+        timeRecord.renderRate = renderRate;
+        timeRecord.frameRateVote = frameRateVote;
+        timeRecord.gameMode = gameMode;
         timeRecord.ready = true;
         layerRecord.waitData++;
     }
 
-    flushAvailableRecordsToStatsLocked(layerId, displayRefreshRate, renderRate, frameRateVote,
-                                       gameMode);
+    enqueueUpdateLocked(layerId);
 }
 
 void TimeStats::setPresentFence(int32_t layerId, uint64_t frameNumber,
@@ -757,12 +862,15 @@ void TimeStats::setPresentFence(int32_t layerId, uint64_t frameNumber,
     TimeRecord& timeRecord = layerRecord.timeRecords[layerRecord.waitData];
     if (timeRecord.frameTime.frameNumber == frameNumber) {
         timeRecord.presentFence = presentFence;
+        timeRecord.displayRefreshRate = displayRefreshRate;
+        timeRecord.renderRate = renderRate;
+        timeRecord.frameRateVote = frameRateVote;
+        timeRecord.gameMode = gameMode;
         timeRecord.ready = true;
         layerRecord.waitData++;
     }
 
-    flushAvailableRecordsToStatsLocked(layerId, displayRefreshRate, renderRate, frameRateVote,
-                                       gameMode);
+    enqueueUpdateLocked(layerId);
 }
 
 static const constexpr int32_t kValidJankyReason = JankType::DisplayHAL |
@@ -807,6 +915,11 @@ void TimeStats::incrementJankyFrames(const JankyFramesInfo& info) {
 
     SFTRACE_CALL();
     std::lock_guard<std::mutex> lock(mMutex);
+    enqueueUpdateLocked(info);
+}
+
+void TimeStats::incrementJankyFramesLocked(const JankyFramesInfo& info) {
+    SFTRACE_CALL();
 
     // Only update layer stats if we're already tracking the layer in TimeStats.
     // Otherwise, continue tracking the statistic but use a default layer name instead.
@@ -864,6 +977,8 @@ void TimeStats::onDestroy(int32_t layerId) {
     SFTRACE_CALL();
     ALOGV("[%d]-onDestroy", layerId);
     std::lock_guard<std::mutex> lock(mMutex);
+    // aggregate the frames that were presented, before the layer record goes away
+    flushAvailableRecordsToStatsLocked(layerId);
     mTimeStatsTracker.erase(layerId);
 }
 
@@ -1045,6 +1160,7 @@ void TimeStats::disable() {
 
 void TimeStats::clearAll() {
     std::lock_guard<std::mutex> lock(mMutex);
+    std::lock_guard<std::mutex> statsLock(mStatsMutex);
     mTimeStats.stats.clear();
     clearGlobalLocked();
     clearLayersLocked();
@@ -1081,6 +1197,7 @@ void TimeStats::clearLayersLocked() {
     SFTRACE_CALL();
 
     mTimeStatsTracker.clear();
+    mPendingUpdates.clear();
 
     for (auto& globalRecord : mTimeStats.stats) {
         globalRecord.second.stats.clear();
@@ -1100,6 +1217,8 @@ void TimeStats::dump(bool asProto, std::optional<uint32_t> maxLayers, std::strin
         return;
     }
 
+    applyPendingUpdatesLocked();
+    std::lock_guard<std::mutex> statsLock(mStatsMutex);
     mTimeStats.statsEndLegacy = static_cast<int64_t>(std::time(0));
 
     flushPowerTimeLocked();
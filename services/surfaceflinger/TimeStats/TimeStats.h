@@ -16,12 +16,15 @@
 
 #pragma once
 
+#include <condition_variable>
 #include <cstdint>
 #include <deque>
 #include <mutex>
 #include <optional>
+#include <thread>
 #include <unordered_map>
 #include <variant>
+#include <vector>
 
 #include <android/hardware/graphics/composer/2.4/IComposerClient.h>
 #include <gui/JankInfo.h>
@@ -202,6 +205,11 @@ class TimeStats : public android::TimeStats {
         FrameTime frameTime;
         std::shared_ptr<FenceTime> acquireFence;
         std::shared_ptr<FenceTime> presentFence;
+        // Given along with the present time or fence, and used once the record is aggregated.
+        Fps displayRefreshRate;
+        std::optional<Fps> renderRate;
+        SetFrameRateVote frameRateVote;
+        GameMode gameMode = GameMode::Unsupported;
     };
 
     struct LayerRecord {
@@ -241,6 +249,7 @@ public:
     // For testing only for injecting custom dependencies.
     TimeStats(std::optional<size_t> maxPulledLayers,
               std::optional<size_t> maxPulledHistogramBuckets);
+    ~TimeStats() override;
 
     bool onPullAtom(const int atomId, std::vector<uint8_t>* pulledData) override;
     void parseArgs(bool asProto, const Vector<String16>& args, std::string& result) override;
@@ -292,9 +301,43 @@ private:
     bool populateGlobalAtom(std::vector<uint8_t>* pulledData);
     bool populateLayerAtom(std::vector<uint8_t>* pulledData);
     bool recordReadyLocked(int32_t layerId, TimeRecord* timeRecord);
-    void flushAvailableRecordsToStatsLocked(int32_t layerId, Fps displayRefreshRate,
-                                            std::optional<Fps> renderRate, SetFrameRateVote,
-                                            GameMode);
+
+    // A presented frame of a layer, taken out of its LayerRecord to be added to mTimeStats.
+    struct LayerFrame {
+        TimeStatsHelper::TimelineStatsKey timelineKey;
+        TimeStatsHelper::LayerStatsKey layerKey;
+        SetFrameRateVote frameRateVote;
+        uint32_t droppedFrames = 0;
+        uint32_t lateAcquireFrames = 0;
+        uint32_t badDesiredPresentFrames = 0;
+        int32_t postToAcquireMs = 0;
+        int32_t postToPresentMs = 0;
+        int32_t acquireToPresentMs = 0;
+        int32_t latchToPresentMs = 0;
+        int32_t desiredToPresentMs = 0;
+        int32_t presentToPresentMs = 0;
+        std::optional<int32_t> presentToPresentDeltaMs;
+    };
+    using StatsUpdate = std::variant<LayerFrame, JankyFramesInfo>;
+
+    void flushAvailableRecordsToStatsLocked(int32_t layerId);
+    // Requires mMutex.
+    void takeReadyFramesLocked(int32_t layerId, std::vector<StatsUpdate>* outUpdates);
+    // These require mStatsMutex.
+    void addLayerFrameLocked(const LayerFrame& frame);
+    void incrementJankyFramesLocked(const JankyFramesInfo& info);
+    void applyStatsUpdatesLocked(const std::vector<StatsUpdate>& updates);
+
+    // Aggregating into mTimeStats is left to mAggregationThread, so that the main thread only
+    // records timestamps. An update either flushes the ready records of a layer, or counts a janky
+    // frame. They are applied in order, since jank is attributed to the layer stats that the
+    // flush of an earlier present creates.
+    using PendingUpdate = std::variant<int32_t /* layerId */, JankyFramesInfo>;
+    void enqueueUpdateLocked(PendingUpdate update);
+    void takePendingUpdatesLocked(std::vector<StatsUpdate>* outUpdates);
+    // Called before reading mTimeStats, so that readers see every frame recorded so far.
+    void applyPendingUpdatesLocked();
+    void runAggregationThread();
     void flushPowerTimeLocked();
     void flushAvailableGlobalRecordsToStatsLocked();
     bool canAddNewAggregatedStats(uid_t uid, const std::string& layerName, GameMode);
@@ -308,11 +351,18 @@ private:
 
     std::atomic<bool> mEnabled = false;
     std::mutex mMutex;
+    // Guards mTimeStats.stats, so that mAggregationThread can add to it without holding mMutex.
+    // The rest of mTimeStats is guarded by mMutex. Taken after mMutex when both are needed.
+    std::mutex mStatsMutex;
     TimeStatsHelper::TimeStatsGlobal mTimeStats;
     // Hashmap for LayerRecord with layerId as the hash key
     std::unordered_map<int32_t, LayerRecord> mTimeStatsTracker;
     PowerTime mPowerTime;
     GlobalRecord mGlobalRecord;
+    std::deque<PendingUpdate> mPendingUpdates;
+    std::condition_variable mPendingUpdatesCondition;
+    bool mStopAggregation = false;
+    std::thread mAggregationThread;
 
     static const size_t MAX_NUM_LAYER_RECORDS = 200;
 
@@ -24,6 +24,7 @@
 #include "Tracing/tools/LayerTraceGenerator.h"
 #include "TransactionTracing.h"
 
+#include <android-base/properties.h>
 #include <common/trace.h>
 #include <log/log.h>
 #include <perfetto/tracing.h>
@@ -57,6 +58,9 @@ void LayerTracing::onStart(Mode mode, uint32_t flags) {
     switch (mode) {
         case Mode::MODE_ACTIVE: {
             mActiveTracingFlags.store(flags);
+            mActiveTracingSampleInterval.store(
+                    base::GetUintProperty("debug.sf.layer_tracing_sample_interval", 1u));
+            mActiveSnapshotCandidates.store(0);
             mIsActiveTracingStarted.store(true);
             ALOGV("Starting active tracing (waiting for initial snapshot)");
             // It might take a while before a layers change occurs and a "spontaneous" snapshot is
@@ -154,6 +158,14 @@ bool LayerTracing::isActiveTracingFlagSet(Flag flag) const {
     return (mActiveTracingFlags.load() & flag) != 0;
 }
 
+bool LayerTracing::shouldTakeActiveSnapshot() {
+    const uint32_t interval = mActiveTracingSampleInterval.load();
+    if (interval <= 1) {
+        return true;
+    }
+    return mActiveSnapshotCandidates.fetch_add(1) % interval == 0;
+}
+
 perfetto::protos::LayersTraceFileProto LayerTracing::createTraceFileProto() {
     perfetto::protos::LayersTraceFileProto fileProto;
     fileProto.set_magic_number(
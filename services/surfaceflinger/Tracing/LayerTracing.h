@@ -42,7 +42,9 @@ class TransactionTracing;
  * Tracing can operate in the following modes.
  *
  * ACTIVE mode:
- * A layers snapshot is taken and written to perfetto for each vsyncid commit.
+ * A layers snapshot is taken and written to perfetto for each vsyncid commit. To keep the cost of
+ * leaving active tracing on low, debug.sf.layer_tracing_sample_interval can be set to N before the
+ * session starts, in which case only every Nth of those snapshots is taken.
  *
  * GENERATED mode:
  * Listens to the perfetto 'flush' event (e.g. when a bugreport is taken).
@@ -116,6 +118,9 @@ public:
     bool isActiveTracingStarted() const;
     uint32_t getActiveTracingFlags() const;
     bool isActiveTracingFlagSet(Flag flag) const;
+    // Whether the active mode snapshot of the current commit should be taken, according to the
+    // sample interval of the active tracing session.
+    bool shouldTakeActiveSnapshot();
     static perfetto::protos::LayersTraceFileProto createTraceFileProto();
 
 private:
@@ -129,6 +134,8 @@ private:
     std::atomic<bool> mIsActiveTracingStarted{false};
     std::atomic<uint32_t> mActiveTracingFlags{0};
     std::atomic<std::int64_t> mLastVsyncIdWrittenToPerfetto{-1};
+    std::atomic<uint32_t> mActiveTracingSampleInterval{1};
+    std::atomic<uint32_t> mActiveSnapshotCandidates{0};
     std::optional<std::reference_wrapper<std::ostream>> mOutStream;
 };
 
@@ -24,7 +24,11 @@
 #include <utils/Errors.h>
 #include <utils/Timers.h>
 #include <chrono>
+#include <deque>
 #include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
 
 namespace android {
 
@@ -55,6 +59,14 @@ public:
         }
     }
 
+    // Visits the serialized entries, oldest first, without copying them.
+    template <typename Visitor>
+    void forEachEntry(Visitor&& visitor) const {
+        for (const std::string& entry : mStorage) {
+            visitor(entry);
+        }
+    }
+
     status_t appendToStream(FileProto& fileProto, std::ofstream& out) {
         SFTRACE_CALL();
         writeToProto(fileProto);
@@ -76,11 +88,11 @@ public:
                 return {};
             }
             mUsedInBytes -= static_cast<size_t>(mStorage.front().size());
-            replacedEntries.emplace_back(mStorage.front());
+            replacedEntries.emplace_back(std::move(mStorage.front()));
             mStorage.pop_front();
         }
         mUsedInBytes += protoSize;
-        mStorage.emplace_back(serializedProto);
+        mStorage.emplace_back(std::move(serializedProto));
         return replacedEntries;
     }
 
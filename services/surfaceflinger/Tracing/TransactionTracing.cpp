@@ -86,24 +86,42 @@ void TransactionTracing::onFlush(TransactionTracing::Mode mode) {
 
 void TransactionTracing::writeRingBufferToPerfetto(TransactionTracing::Mode mode) {
     // Write the ring buffer (starting state + following sequence of transactions) to perfetto
-    // tracing sessions with the specified mode.
-    const auto fileProto = writeToProto();
+    // tracing sessions with the specified mode. The entries are already serialized, so they are
+    // streamed from the ring buffer as is rather than through a copy of the whole trace.
+    std::scoped_lock lock(mTraceLock);
+    std::string startingStateBytes;
+    nsecs_t startingStateTimestamp = 0;
+    if (const auto startingStateProto = createStartingStateProtoLocked()) {
+        startingStateProto->SerializeToString(&startingStateBytes);
+        startingStateTimestamp = startingStateProto->elapsed_realtime_nanos();
+    }
 
-    TransactionDataSource::Trace([&](TransactionDataSource::TraceContext context) {
+    TransactionDataSource::Trace([&](TransactionDataSource::TraceContext context)
+                                         REQUIRES(mTraceLock) {
         // Write packets only to tracing sessions with specified mode
         if (context.GetCustomTlsState()->mMode != mode) {
             return;
         }
-        for (const auto& entryProto : fileProto.entry()) {
-            const auto entryBytes = entryProto.SerializeAsString();
 
+        const auto writeEntry = [&context](nsecs_t timestamp, const std::string& entryBytes) {
             auto packet = context.NewTracePacket();
-            packet->set_timestamp(static_cast<uint64_t>(entryProto.elapsed_realtime_nanos()));
+            packet->set_timestamp(static_cast<uint64_t>(timestamp));
             packet->set_timestamp_clock_id(perfetto::protos::pbzero::BUILTIN_CLOCK_MONOTONIC);
 
             auto* transactionsProto = packet->set_surfaceflinger_transactions();
             transactionsProto->AppendRawProtoBytes(entryBytes.data(), entryBytes.size());
+        };
+
+        if (!startingStateBytes.empty()) {
+            writeEntry(startingStateTimestamp, startingStateBytes);
         }
+
+        perfetto::protos::TransactionTraceEntry entryProto;
+        mBuffer.forEachEntry([&](const std::string& entryBytes) {
+            entryProto.ParseFromString(entryBytes);
+            writeEntry(entryProto.elapsed_realtime_nanos(), entryBytes);
+            entryProto.Clear();
+        });
         {
             // TODO (b/162206162): remove empty packet when perfetto bug is fixed.
             //  It is currently needed in order not to lose the last trace entry.
@@ -202,7 +202,7 @@ private:
     std::vector<uint32_t /* layerId */> mPendingDestroyedLayers; // only accessed by main thread
     int64_t mLastUpdatedVsyncId = -1;
 
-    void writeRingBufferToPerfetto(TransactionTracing::Mode mode);
+    void writeRingBufferToPerfetto(TransactionTracing::Mode mode) EXCLUDES(mTraceLock);
     perfetto::protos::TransactionTraceFile createTraceFileProto() const;
     void loop();
     void addEntry(const std::vector<CommittedUpdates>& committedTransactions,
@@ -32,6 +32,9 @@
 #include <common/trace.h>
 #include <utils/RefBase.h>
 
+#include <algorithm>
+#include <vector>
+
 namespace android {
 
 // Returns 0 if they are equal
@@ -165,9 +168,21 @@ void TransactionCallbackInvoker::addPresentFence(sp<Fence> presentFence) {
 }
 
 void TransactionCallbackInvoker::sendCallbacks(bool onCommitOnly) {
-    for (const auto& bufferRelease : mBufferReleases) {
-        bufferRelease.channel->writeReleaseFence(bufferRelease.callbackId, bufferRelease.fence,
-                                                 bufferRelease.currentMaxAcquiredBufferCount);
+    // Write the releases of each channel together, in the order they were added, so that a
+    // channel with several releases in this frame gets them with one system call.
+    std::stable_sort(mBufferReleases.begin(), mBufferReleases.end(),
+                     [](const BufferRelease& lhs, const BufferRelease& rhs) {
+                         return lhs.channel.get() < rhs.channel.get();
+                     });
+    std::vector<gui::BufferReleaseChannel::Message> messages;
+    for (auto it = mBufferReleases.begin(); it != mBufferReleases.end();) {
+        const auto& channel = it->channel;
+        messages.clear();
+        for (; it != mBufferReleases.end() && it->channel == channel; it++) {
+            messages.emplace_back(it->callbackId, it->fence ? it->fence : Fence::NO_FENCE,
+                                  it->currentMaxAcquiredBufferCount);
+        }
+        channel->writeReleaseFences(messages);
     }
     mBufferReleases.clear();
 
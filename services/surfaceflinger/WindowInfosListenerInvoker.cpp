@@ -17,6 +17,7 @@
 #include <android/gui/BnWindowInfosPublisher.h>
 #include <android/gui/IWindowInfosPublisher.h>
 #include <android/gui/WindowInfosListenerInfo.h>
+#include <common/FlagManager.h>
 #include <common/trace.h>
 #include <gui/ISurfaceComposer.h>
 #include <gui/WindowInfosUpdate.h>
@@ -47,6 +48,8 @@ void WindowInfosListenerInvoker::addWindowInfosListener(sp<IWindowInfosListener>
                 asBinder->linkToDeath(sp<DeathRecipient>::fromExisting(this));
                 mWindowInfosListeners.try_emplace(asBinder,
                                                   std::make_pair(listenerId, std::move(listener)));
+                mListenerStates.try_emplace(listenerId);
+                mListenersNeedingFullUpdate.insert(listenerId);
             }});
 }
 
@@ -71,6 +74,12 @@ void WindowInfosListenerInvoker::eraseListenerAndAckMessages(const wp<IBinder>&
     auto it = mWindowInfosListeners.find(binder);
     int64_t listenerId = it->second.first;
     mWindowInfosListeners.erase(binder);
+    mListenerStates.erase(listenerId);
+    mListenersNeedingFullUpdate.erase(listenerId);
+    if (mListenersAwaitingDelayedUpdate.erase(listenerId) &&
+        mListenersAwaitingDelayedUpdate.empty()) {
+        mDelayedUpdate.reset();
+    }
 
     std::vector<int64_t> vsyncIds;
     for (auto& [vsyncId, state] : mUnackedState) {
@@ -95,6 +104,16 @@ void WindowInfosListenerInvoker::windowInfosChanged(
         };
     }
 
+    if (FlagManager::getInstance().window_infos_per_listener_coalescing()) {
+        sendToIdleListeners(std::move(update), std::move(reportedListeners), forceImmediateCall);
+    } else {
+        sendToAllListeners(std::move(update), std::move(reportedListeners), forceImmediateCall);
+    }
+}
+
+void WindowInfosListenerInvoker::sendToAllListeners(
+        gui::WindowInfosUpdate update, WindowInfosReportedListenerSet reportedListeners,
+        bool forceImmediateCall) {
     // If there are unacked messages and this isn't a forced call, then return immediately.
     // If a forced window infos change doesn't happen first, the update will be sent after
     // the WindowInfosReportedListeners are called. If a forced window infos change happens or
@@ -133,13 +152,148 @@ void WindowInfosListenerInvoker::windowInfosChanged(
     mDelayInfo.reset();
     updateMaxSendDelay();
 
+    // Listeners which have the previous update are only sent the windows which changed since.
+    const bool deltaUpdates = FlagManager::getInstance().window_infos_delta_updates();
+    std::optional<gui::WindowInfosUpdate> delta;
+    if (deltaUpdates) {
+        SFTRACE_NAME("makeDelta");
+        delta = update.makeDelta(mLastSentWindowInfos);
+    }
+
     // Call the listeners
     for (auto& pair : mWindowInfosListeners) {
         auto& [listenerId, listener] = pair.second;
-        auto status = listener->onWindowInfosChanged(update);
-        if (!status.isOk()) {
-            ackWindowInfosReceived(update.vsyncId, listenerId);
+        const bool sendDelta = delta && !mListenersNeedingFullUpdate.contains(listenerId);
+        sendUpdate(listenerId, listener, sendDelta ? *delta : update);
+    }
+
+    if (deltaUpdates) {
+        mLastSentWindowInfos = std::move(update.windowInfos);
+    }
+}
+
+void WindowInfosListenerInvoker::sendToIdleListeners(
+        gui::WindowInfosUpdate update, WindowInfosReportedListenerSet reportedListeners,
+        bool forceImmediateCall) {
+    if (CC_UNLIKELY(mWindowInfosListeners.empty())) {
+        mReportedListeners.merge(reportedListeners);
+        mDelayInfo.reset();
+        return;
+    }
+
+    // Listeners which haven't acked a previous message are only sent this update immediately if
+    // this is a forced call. Otherwise, they are sent the latest update once they ack, and the
+    // updates in between are dropped for them. This reduces the amount of binder memory used, and
+    // keeps a slow listener from delaying the others.
+    std::unordered_set<int64_t> listenersAwaitingPreviousUpdate;
+    std::swap(listenersAwaitingPreviousUpdate, mListenersAwaitingDelayedUpdate);
+    ftl::SmallVector<std::pair<int64_t, sp<IWindowInfosListener>>, kStaticCapacity> readyListeners;
+    for (const auto& [binder, pair] : mWindowInfosListeners) {
+        const int64_t listenerId = pair.first;
+        const auto state = mListenerStates.get(listenerId);
+        if (state && listenersAwaitingPreviousUpdate.contains(listenerId)) {
+            state->get().coalescedUpdateCount++;
         }
+        if (forceImmediateCall || !state || state->get().unackedSendTimes.empty()) {
+            readyListeners.push_back(pair);
+        } else {
+            mListenersAwaitingDelayedUpdate.insert(listenerId);
+        }
+    }
+
+    // The reported listeners wait until every listener has acked this update or a later one. A
+    // busy listener does so when it acks the latest update, which it is sent once it acks its
+    // previous one.
+    auto [it, _] = mUnackedState.try_emplace(update.vsyncId);
+    auto& unackedState = it->second;
+    unackedState.reportedListeners.merge(reportedListeners);
+    unackedState.reportedListeners.merge(mReportedListeners);
+    mReportedListeners.clear();
+    for (const auto& [binder, pair] : mWindowInfosListeners) {
+        const int64_t listenerId = pair.first;
+        if (std::find(unackedState.unackedListenerIds.begin(),
+                      unackedState.unackedListenerIds.end(),
+                      listenerId) == unackedState.unackedListenerIds.end()) {
+            unackedState.unackedListenerIds.push_back(listenerId);
+        }
+    }
+
+    // Listeners which have the previous update are only sent the windows which changed since.
+    // Busy listeners miss updates, so they are sent the full delayed update instead.
+    const bool deltaUpdates = FlagManager::getInstance().window_infos_delta_updates();
+
+    // If every listener is busy, the update is held until the first listener acks.
+    if (readyListeners.empty()) {
+        if (deltaUpdates) {
+            mLastSentWindowInfos = update.windowInfos;
+            mListenersNeedingFullUpdate.insert(mListenersAwaitingDelayedUpdate.begin(),
+                                               mListenersAwaitingDelayedUpdate.end());
+        }
+        mDelayedUpdate = std::move(update);
+        return;
+    }
+
+    if (mListenersAwaitingDelayedUpdate.empty()) {
+        mDelayedUpdate.reset();
+    } else {
+        mDelayedUpdate = update;
+    }
+
+    mDelayInfo.reset();
+    updateMaxSendDelay();
+
+    std::optional<gui::WindowInfosUpdate> delta;
+    if (deltaUpdates) {
+        SFTRACE_NAME("makeDelta");
+        delta = update.makeDelta(mLastSentWindowInfos);
+    }
+
+    // Call the listeners. The calls are oneway, so they don't wait for each other.
+    for (const auto& [listenerId, listener] : readyListeners) {
+        const bool sendDelta = delta && !mListenersNeedingFullUpdate.contains(listenerId);
+        sendUpdate(listenerId, listener, sendDelta ? *delta : update);
+    }
+
+    if (deltaUpdates) {
+        mLastSentWindowInfos = std::move(update.windowInfos);
+        mListenersNeedingFullUpdate.insert(mListenersAwaitingDelayedUpdate.begin(),
+                                           mListenersAwaitingDelayedUpdate.end());
+    }
+}
+
+void WindowInfosListenerInvoker::sendUpdate(int64_t listenerId,
+                                            const sp<IWindowInfosListener>& listener,
+                                            const gui::WindowInfosUpdate& update) {
+    auto status = listener->onWindowInfosChanged(update);
+    if (!status.isOk()) {
+        mListenersNeedingFullUpdate.insert(listenerId);
+        ackWindowInfosReceived(update.vsyncId, listenerId);
+        return;
+    }
+
+    mListenersNeedingFullUpdate.erase(listenerId);
+    if (const auto state = mListenerStates.get(listenerId)) {
+        state->get().unackedSendTimes.emplace_or_replace(update.vsyncId, TimePoint::now().ns());
+    }
+}
+
+void WindowInfosListenerInvoker::sendDelayedUpdate(int64_t listenerId) {
+    if (!mDelayedUpdate || !mListenersAwaitingDelayedUpdate.erase(listenerId)) {
+        return;
+    }
+
+    const auto listenerIt =
+            std::find_if(mWindowInfosListeners.begin(), mWindowInfosListeners.end(),
+                         [&](const auto& pair) { return pair.second.first == listenerId; });
+    if (listenerIt != mWindowInfosListeners.end()) {
+        updateMaxSendDelay();
+        mDelayInfo.reset();
+
+        sendUpdate(listenerId, listenerIt->second.second, *mDelayedUpdate);
+    }
+
+    if (mListenersAwaitingDelayedUpdate.empty()) {
+        mDelayedUpdate.reset();
     }
 }
 
@@ -150,6 +304,18 @@ WindowInfosListenerInvoker::DebugInfo WindowInfosListenerInvoker::getDebugInfo()
         updateMaxSendDelay();
         result = mDebugInfo;
         result.pendingMessageCount = mUnackedState.size();
+
+        const nsecs_t now = TimePoint::now().ns();
+        for (const auto& [listenerId, state] : mListenerStates) {
+            nsecs_t oldestSendTime = now;
+            for (const auto& [_, sendTime] : state.unackedSendTimes) {
+                oldestSendTime = std::min(oldestSendTime, sendTime);
+            }
+            result.listeners.push_back({.listenerId = listenerId,
+                                        .coalescedUpdateCount = state.coalescedUpdateCount,
+                                        .maxAckLatency = state.maxAckLatency,
+                                        .currentLag = now - oldestSendTime});
+        }
     }});
     BackgroundExecutor::getInstance().flushQueue();
     return result;
@@ -170,21 +336,59 @@ binder::Status WindowInfosListenerInvoker::ackWindowInfosReceived(int64_t vsyncI
                                                                   int64_t listenerId) {
     BackgroundExecutor::getInstance().sendCallbacks({[this, vsyncId, listenerId]() {
         SFTRACE_NAME("WindowInfosListenerInvoker::ackWindowInfosReceived");
-        auto it = mUnackedState.find(vsyncId);
-        if (it == mUnackedState.end()) {
-            return;
+        bool listenerIsIdle = false;
+        if (const auto state = mListenerStates.get(listenerId)) {
+            auto& listenerState = state->get();
+            if (const auto sendTime = listenerState.unackedSendTimes.get(vsyncId)) {
+                listenerState.maxAckLatency =
+                        std::max(listenerState.maxAckLatency,
+                                 TimePoint::now().ns() - sendTime->get());
+                listenerState.unackedSendTimes.erase(vsyncId);
+            }
+            listenerIsIdle = listenerState.unackedSendTimes.empty();
         }
 
-        auto& state = it->second;
-        state.unackedListenerIds.unstable_erase(std::find(state.unackedListenerIds.begin(),
-                                                          state.unackedListenerIds.end(),
-                                                          listenerId));
-        if (!state.unackedListenerIds.empty()) {
+        if (!FlagManager::getInstance().window_infos_per_listener_coalescing()) {
+            ackUnackedStates(vsyncId, listenerId, /*includeEarlierUpdates=*/false);
+            if (!mDelayedUpdate || !mUnackedState.empty()) {
+                return;
+            }
+            gui::WindowInfosUpdate update{std::move(*mDelayedUpdate)};
+            mDelayedUpdate.reset();
+            windowInfosChanged(std::move(update), {}, false);
             return;
         }
 
-        WindowInfosReportedListenerSet reportedListeners{std::move(state.reportedListeners)};
-        mUnackedState.erase(vsyncId);
+        // The updates dropped for a busy listener are acked by its ack of a later update.
+        ackUnackedStates(vsyncId, listenerId, /*includeEarlierUpdates=*/true);
+        if (listenerIsIdle) {
+            sendDelayedUpdate(listenerId);
+        }
+    }});
+    return binder::Status::ok();
+}
+
+void WindowInfosListenerInvoker::ackUnackedStates(int64_t vsyncId, int64_t listenerId,
+                                                  bool includeEarlierUpdates) {
+    ftl::SmallVector<int64_t, 5> ackedVsyncIds;
+    for (auto& [unackedVsyncId, state] : mUnackedState) {
+        if (unackedVsyncId != vsyncId && !(includeEarlierUpdates && unackedVsyncId < vsyncId)) {
+            continue;
+        }
+        const auto listenerIt = std::find(state.unackedListenerIds.begin(),
+                                          state.unackedListenerIds.end(), listenerId);
+        if (listenerIt != state.unackedListenerIds.end()) {
+            state.unackedListenerIds.unstable_erase(listenerIt);
+        }
+        if (state.unackedListenerIds.empty()) {
+            ackedVsyncIds.push_back(unackedVsyncId);
+        }
+    }
+
+    for (int64_t ackedVsyncId : ackedVsyncIds) {
+        WindowInfosReportedListenerSet reportedListeners{
+                std::move(mUnackedState.get(ackedVsyncId)->get().reportedListeners)};
+        mUnackedState.erase(ackedVsyncId);
 
         for (const auto& reportedListener : reportedListeners) {
             sp<IBinder> asBinder = IInterface::asBinder(reportedListener);
@@ -192,15 +396,7 @@ binder::Status WindowInfosListenerInvoker::ackWindowInfosReceived(int64_t vsyncI
                 reportedListener->onWindowInfosReported();
             }
         }
-
-        if (!mDelayedUpdate || !mUnackedState.empty()) {
-            return;
-        }
-        gui::WindowInfosUpdate update{std::move(*mDelayedUpdate)};
-        mDelayedUpdate.reset();
-        windowInfosChanged(std::move(update), {}, false);
-    }});
-    return binder::Status::ok();
+    }
 }
 
 } // namespace android
@@ -48,10 +48,21 @@ public:
 
     binder::Status ackWindowInfosReceived(int64_t, int64_t) override;
 
+    struct ListenerDebugInfo {
+        int64_t listenerId;
+        // Updates which the listener was not sent because a later one replaced them before it
+        // acked the previous one.
+        uint64_t coalescedUpdateCount;
+        nsecs_t maxAckLatency;
+        // How long the listener's oldest unacked update has been waiting for an ack, or 0.
+        nsecs_t currentLag;
+    };
+
     struct DebugInfo {
         VsyncId maxSendDelayVsyncId;
         nsecs_t maxSendDelayDuration;
         size_t pendingMessageCount;
+        std::vector<ListenerDebugInfo> listeners;
     };
     DebugInfo getDebugInfo();
 
@@ -65,7 +76,32 @@ private:
                   kStaticCapacity>
             mWindowInfosListeners;
 
+    // The latest update, if some listeners were still processing an earlier one when it arrived.
+    // Each of them is sent it once it acks, and the updates in between are dropped for it.
     std::optional<gui::WindowInfosUpdate> mDelayedUpdate;
+    std::unordered_set<int64_t> mListenersAwaitingDelayedUpdate;
+
+    struct ListenerState {
+        // Send times of the updates the listener hasn't acked yet, keyed by vsync id.
+        ftl::SmallMap<int64_t, nsecs_t, 2> unackedSendTimes;
+        uint64_t coalescedUpdateCount = 0;
+        nsecs_t maxAckLatency = 0;
+    };
+    ftl::SmallMap<int64_t /* listenerId */, ListenerState, kStaticCapacity> mListenerStates;
+    // Holds every update while any listener has an unacked one.
+    void sendToAllListeners(gui::WindowInfosUpdate, WindowInfosReportedListenerSet,
+                            bool forceImmediateCall);
+    // Holds updates only for the listeners which have an unacked one.
+    void sendToIdleListeners(gui::WindowInfosUpdate, WindowInfosReportedListenerSet,
+                             bool forceImmediateCall);
+    void sendUpdate(int64_t listenerId, const sp<gui::IWindowInfosListener>&,
+                    const gui::WindowInfosUpdate&);
+    void sendDelayedUpdate(int64_t listenerId);
+
+    // The windows of the last update sent, which deltas are made against, and the listeners
+    // which don't have them and so are sent the full list of windows.
+    std::vector<gui::WindowInfo> mLastSentWindowInfos;
+    std::unordered_set<int64_t> mListenersNeedingFullUpdate;
     WindowInfosReportedListenerSet mReportedListeners;
     void eraseListenerAndAckMessages(const wp<IBinder>&);
 
@@ -74,6 +110,9 @@ private:
         WindowInfosReportedListenerSet reportedListeners;
     };
     ftl::SmallMap<int64_t /* vsyncId */, UnackedState, 5> mUnackedState;
+    // Acks the update with the given vsync id, and optionally all earlier ones, for the listener,
+    // and calls the reported listeners of the updates which every listener has now acked.
+    void ackUnackedStates(int64_t vsyncId, int64_t listenerId, bool includeEarlierUpdates);
 
     DebugInfo mDebugInfo;
     struct DelayInfo {
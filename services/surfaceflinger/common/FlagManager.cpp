@@ -148,15 +148,29 @@ void FlagManager::dump(std::string& result) const {
     DUMP_READ_ONLY_FLAG(deprecate_vsync_sf);
     DUMP_READ_ONLY_FLAG(allow_n_vsyncs_in_targeter);
     DUMP_READ_ONLY_FLAG(detached_mirror);
+    DUMP_READ_ONLY_FLAG(cache_blur_output);
+    DUMP_READ_ONLY_FLAG(cache_layer_visibility);
+    DUMP_READ_ONLY_FLAG(coalesce_transaction_states);
+    DUMP_READ_ONLY_FLAG(coalesce_vsync_wakeups);
     DUMP_READ_ONLY_FLAG(commit_not_composited);
+    DUMP_READ_ONLY_FLAG(composition_strategy_cache);
     DUMP_READ_ONLY_FLAG(correct_dpi_with_display_size);
     DUMP_READ_ONLY_FLAG(local_tonemap_screenshots);
     DUMP_READ_ONLY_FLAG(override_trusted_overlay);
     DUMP_READ_ONLY_FLAG(flush_buffer_slots_to_uncache);
     DUMP_READ_ONLY_FLAG(force_compile_graphite_renderengine);
+    DUMP_READ_ONLY_FLAG(parallel_output_composition);
+    DUMP_READ_ONLY_FLAG(parallel_snapshot_builder);
+    DUMP_READ_ONLY_FLAG(partial_client_composition);
+    DUMP_READ_ONLY_FLAG(recycle_hwc_layers);
     DUMP_READ_ONLY_FLAG(single_hop_screenshot);
+    DUMP_READ_ONLY_FLAG(skip_clean_layer_subtrees);
+    DUMP_READ_ONLY_FLAG(skip_unchanged_layer_commands);
+    DUMP_READ_ONLY_FLAG(skip_unchanged_region_sampling);
     DUMP_READ_ONLY_FLAG(trace_frame_rate_override);
     DUMP_READ_ONLY_FLAG(true_hdr_screenshots);
+    DUMP_READ_ONLY_FLAG(window_infos_delta_updates);
+    DUMP_READ_ONLY_FLAG(window_infos_per_listener_coalescing);
 
 #undef DUMP_READ_ONLY_FLAG
 #undef DUMP_SERVER_FLAG
@@ -254,14 +268,31 @@ FLAG_MANAGER_READ_ONLY_FLAG(latch_unsignaled_with_auto_refresh_changed, "");
 FLAG_MANAGER_READ_ONLY_FLAG(deprecate_vsync_sf, "");
 FLAG_MANAGER_READ_ONLY_FLAG(allow_n_vsyncs_in_targeter, "");
 FLAG_MANAGER_READ_ONLY_FLAG(detached_mirror, "");
+FLAG_MANAGER_READ_ONLY_FLAG(cache_blur_output, "debug.sf.cache_blur_output");
+FLAG_MANAGER_READ_ONLY_FLAG(cache_layer_visibility, "debug.sf.cache_layer_visibility");
+FLAG_MANAGER_READ_ONLY_FLAG(coalesce_transaction_states, "debug.sf.coalesce_transaction_states");
+FLAG_MANAGER_READ_ONLY_FLAG(coalesce_vsync_wakeups, "debug.sf.coalesce_vsync_wakeups");
 FLAG_MANAGER_READ_ONLY_FLAG(commit_not_composited, "");
+FLAG_MANAGER_READ_ONLY_FLAG(composition_strategy_cache, "debug.sf.composition_strategy_cache");
 FLAG_MANAGER_READ_ONLY_FLAG(correct_dpi_with_display_size, "");
 FLAG_MANAGER_READ_ONLY_FLAG(local_tonemap_screenshots, "debug.sf.local_tonemap_screenshots");
 FLAG_MANAGER_READ_ONLY_FLAG(override_trusted_overlay, "");
 FLAG_MANAGER_READ_ONLY_FLAG(flush_buffer_slots_to_uncache, "");
 FLAG_MANAGER_READ_ONLY_FLAG(force_compile_graphite_renderengine, "");
+FLAG_MANAGER_READ_ONLY_FLAG(parallel_output_composition, "debug.sf.parallel_output_composition");
+FLAG_MANAGER_READ_ONLY_FLAG(parallel_snapshot_builder, "debug.sf.parallel_snapshot_builder");
+FLAG_MANAGER_READ_ONLY_FLAG(partial_client_composition, "debug.sf.partial_client_composition");
+FLAG_MANAGER_READ_ONLY_FLAG(recycle_hwc_layers, "debug.sf.recycle_hwc_layers");
 FLAG_MANAGER_READ_ONLY_FLAG(single_hop_screenshot, "");
+FLAG_MANAGER_READ_ONLY_FLAG(skip_clean_layer_subtrees, "debug.sf.skip_clean_layer_subtrees");
+FLAG_MANAGER_READ_ONLY_FLAG(skip_unchanged_layer_commands,
+                            "debug.sf.skip_unchanged_layer_commands");
+FLAG_MANAGER_READ_ONLY_FLAG(skip_unchanged_region_sampling,
+                            "debug.sf.skip_unchanged_region_sampling");
 FLAG_MANAGER_READ_ONLY_FLAG(true_hdr_screenshots, "debug.sf.true_hdr_screenshots");
+FLAG_MANAGER_READ_ONLY_FLAG(window_infos_delta_updates, "debug.sf.window_infos_delta_updates");
+FLAG_MANAGER_READ_ONLY_FLAG(window_infos_per_listener_coalescing,
+                            "debug.sf.window_infos_per_listener_coalescing");
 
 /// Trunk stable server flags ///
 FLAG_MANAGER_SERVER_FLAG(refresh_rate_overlay_on_external_display, "")
@@ -86,15 +86,29 @@ public:
     bool deprecate_vsync_sf() const;
     bool allow_n_vsyncs_in_targeter() const;
     bool detached_mirror() const;
+    bool cache_blur_output() const;
+    bool cache_layer_visibility() const;
+    bool coalesce_transaction_states() const;
+    bool coalesce_vsync_wakeups() const;
     bool commit_not_composited() const;
+    bool composition_strategy_cache() const;
     bool correct_dpi_with_display_size() const;
     bool local_tonemap_screenshots() const;
     bool override_trusted_overlay() const;
     bool flush_buffer_slots_to_uncache() const;
     bool force_compile_graphite_renderengine() const;
+    bool parallel_output_composition() const;
+    bool parallel_snapshot_builder() const;
+    bool partial_client_composition() const;
+    bool recycle_hwc_layers() const;
     bool single_hop_screenshot() const;
+    bool skip_clean_layer_subtrees() const;
+    bool skip_unchanged_layer_commands() const;
+    bool skip_unchanged_region_sampling() const;
     bool trace_frame_rate_override() const;
     bool true_hdr_screenshots() const;
+    bool window_infos_delta_updates() const;
+    bool window_infos_per_listener_coalescing() const;
 
 protected:
     // overridden for unit tests
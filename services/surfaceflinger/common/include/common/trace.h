@@ -41,7 +41,7 @@
 #undef ATRACE_FORMAT
 #undef ATRACE_FORMAT_INSTANT
 
-#define SFTRACE_ENABLED() ::tracing_perfetto::isTagEnabled(ATRACE_TAG)
+#define SFTRACE_ENABLED() ::tracing_perfetto::isTagEnabledFast(ATRACE_TAG)
 #define SFTRACE_BEGIN(name) ::tracing_perfetto::traceBegin(ATRACE_TAG, name)
 #define SFTRACE_END() ::tracing_perfetto::traceEnd(ATRACE_TAG)
 #define SFTRACE_ASYNC_BEGIN(name, cookie) \
@@ -81,10 +81,25 @@ class ScopedTrace {
 public:
     template <typename... Args>
     inline ScopedTrace(const char* fmt, Args&&... args) {
-        ::tracing_perfetto::traceFormatBegin(ATRACE_TAG, fmt, std::forward<Args>(args)...);
+        if (CC_UNLIKELY(SFTRACE_ENABLED())) {
+            ::tracing_perfetto::traceFormatBegin(ATRACE_TAG, fmt, std::forward<Args>(args)...);
+            mStarted = true;
+        }
     }
-    inline ScopedTrace(const char* name) { SFTRACE_BEGIN(name); }
-    inline ~ScopedTrace() { SFTRACE_END(); }
+    inline ScopedTrace(const char* name) {
+        if (CC_UNLIKELY(SFTRACE_ENABLED())) {
+            SFTRACE_BEGIN(name);
+            mStarted = true;
+        }
+    }
+    inline ~ScopedTrace() {
+        if (CC_UNLIKELY(mStarted)) {
+            SFTRACE_END();
+        }
+    }
+
+private:
+    bool mStarted = false;
 };
 
 } // namespace android
@@ -0,0 +1,188 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <common/test/FlagUtils.h>
+#include <FrontEnd/LayerHierarchy.h>
+#include <FrontEnd/LayerLifecycleManager.h>
+#include <FrontEnd/LayerSnapshotBuilder.h>
+#include <LayerLifecycleManagerHelper.h>
+
+#include <com_android_graphics_surfaceflinger_flags.h>
+
+namespace android::surfaceflinger {
+
+namespace {
+
+using namespace android::surfaceflinger::frontend;
+using namespace com::android::graphics::surfaceflinger;
+
+// Builds state.range(0) layers as a set of windows, each a root layer with a few levels of
+// children, as a multi-window device would have. The windows are spread over displayCount
+// displays.
+class LayerSnapshotBuilderFixture {
+public:
+    static constexpr uint32_t kLayersPerWindow = 10;
+
+    explicit LayerSnapshotBuilderFixture(uint32_t layerCount, uint32_t displayCount = 1) {
+        for (uint32_t display = 0; display < displayCount; display++) {
+            mDisplays.emplace_or_replace(ui::LayerStack::fromValue(display), DisplayInfo{});
+        }
+        for (uint32_t window = 0; window < layerCount / kLayersPerWindow; window++) {
+            const uint32_t rootId = window * kLayersPerWindow + 1;
+            mHelper.createRootLayer(rootId);
+            mHelper.setColor(rootId);
+            if (displayCount > 1) {
+                mHelper.setLayerStack(rootId, static_cast<int32_t>(window % displayCount));
+            }
+            for (uint32_t i = 1; i < kLayersPerWindow; i++) {
+                // alternate between siblings and grandchildren
+                const uint32_t parentId = (i % 2 == 0) ? rootId + i - 1 : rootId;
+                mHelper.createLayer(rootId + i, parentId);
+                mHelper.setColor(rootId + i);
+            }
+        }
+        update();
+    }
+
+    void update() {
+        if (mLifecycleManager.getGlobalChanges().test(RequestedLayerState::Changes::Hierarchy)) {
+            mHierarchyBuilder.update(mLifecycleManager);
+        }
+        LayerSnapshotBuilder::Args args{.root = mHierarchyBuilder.getHierarchy(),
+                                        .layerLifecycleManager = mLifecycleManager,
+                                        .displays = mDisplays,
+                                        .globalShadowSettings = mShadowSettings,
+                                        .supportedLayerGenericMetadata = {},
+                                        .genericLayerMetadataKeyMap = {}};
+        mSnapshotBuilder.update(args);
+        mLifecycleManager.commitChanges();
+    }
+
+    LayerLifecycleManager mLifecycleManager;
+    LayerLifecycleManagerHelper mHelper{mLifecycleManager};
+    LayerHierarchyBuilder mHierarchyBuilder;
+    LayerSnapshotBuilder mSnapshotBuilder;
+    DisplayInfos mDisplays;
+    ShadowSettings mShadowSettings;
+};
+
+// Moves a single window, which requires a hierarchy walk but only changes one subtree.
+template <bool skipCleanSubtrees>
+static void updateOneWindowPosition(benchmark::State& state) {
+    SET_FLAG_FOR_TEST(flags::skip_clean_layer_subtrees, skipCleanSubtrees);
+    LayerSnapshotBuilderFixture fixture(static_cast<uint32_t>(state.range(0)));
+    float x = 0;
+    for (auto _ : state) {
+        fixture.mHelper.setPosition(1, x, 0);
+        x = x > 100 ? 0 : x + 1;
+        fixture.update();
+    }
+}
+BENCHMARK(updateOneWindowPosition<false>)->Arg(500)->Arg(1000)->Arg(2000);
+BENCHMARK(updateOneWindowPosition<true>)->Arg(500)->Arg(1000)->Arg(2000);
+
+// Changes the alpha of a leaf layer in every tenth window.
+template <bool skipCleanSubtrees>
+static void updateSomeLeafAlphas(benchmark::State& state) {
+    SET_FLAG_FOR_TEST(flags::skip_clean_layer_subtrees, skipCleanSubtrees);
+    const uint32_t layerCount = static_cast<uint32_t>(state.range(0));
+    LayerSnapshotBuilderFixture fixture(layerCount);
+    float alpha = 0.5f;
+    for (auto _ : state) {
+        for (uint32_t id = LayerSnapshotBuilderFixture::kLayersPerWindow; id <= layerCount;
+             id += 10 * LayerSnapshotBuilderFixture::kLayersPerWindow) {
+            fixture.mHelper.setAlpha(id, alpha);
+        }
+        alpha = alpha > 0.9f ? 0.5f : alpha + 0.01f;
+        fixture.update();
+    }
+}
+BENCHMARK(updateSomeLeafAlphas<false>)->Arg(500)->Arg(1000)->Arg(2000);
+BENCHMARK(updateSomeLeafAlphas<true>)->Arg(500)->Arg(1000)->Arg(2000);
+
+// Moves a window on each of two displays, which updates the roots of each display on its own
+// thread when the snapshots are built in parallel.
+template <bool parallel>
+static void updateWindowPositionsOnTwoDisplays(benchmark::State& state) {
+    SET_FLAG_FOR_TEST(flags::parallel_snapshot_builder, parallel);
+    LayerSnapshotBuilderFixture fixture(static_cast<uint32_t>(state.range(0)), /*displayCount=*/2);
+    const uint32_t secondWindowId = LayerSnapshotBuilderFixture::kLayersPerWindow + 1;
+    float x = 0;
+    for (auto _ : state) {
+        fixture.mHelper.setPosition(1, x, 0);
+        fixture.mHelper.setPosition(secondWindowId, x, 0);
+        x = x > 100 ? 0 : x + 1;
+        fixture.update();
+    }
+}
+BENCHMARK(updateWindowPositionsOnTwoDisplays<false>)->Arg(500)->Arg(1000)->Arg(2000);
+BENCHMARK(updateWindowPositionsOnTwoDisplays<true>)->Arg(500)->Arg(1000)->Arg(2000);
+
+// Creates and destroys a window of layers on top of state.range(0) layers, as an animating app
+// or IME window would.
+static void addAndDestroyWindow(benchmark::State& state) {
+    const uint32_t layerCount = static_cast<uint32_t>(state.range(0));
+    LayerSnapshotBuilderFixture fixture(layerCount);
+    uint32_t rootId = layerCount + 1;
+    for (auto _ : state) {
+        fixture.mHelper.createRootLayer(rootId);
+        for (uint32_t i = 1; i < LayerSnapshotBuilderFixture::kLayersPerWindow; i++) {
+            fixture.mHelper.createLayer(rootId + i, rootId);
+        }
+        fixture.update();
+        for (uint32_t i = 0; i < LayerSnapshotBuilderFixture::kLayersPerWindow; i++) {
+            fixture.mHelper.destroyLayerHandle(rootId + i);
+        }
+        fixture.update();
+        rootId += LayerSnapshotBuilderFixture::kLayersPerWindow;
+    }
+}
+BENCHMARK(addAndDestroyWindow)->Arg(500)->Arg(1000)->Arg(2000);
+
+// Per-frame style pass over the visible snapshots, reading a few fields of each. Run with
+// `simpleperf stat -e cache-misses` to compare reading the snapshots with reading the table.
+static void sumVisibleAreaFromSnapshots(benchmark::State& state) {
+    LayerSnapshotBuilderFixture fixture(static_cast<uint32_t>(state.range(0)));
+    for (auto _ : state) {
+        float area = 0;
+        fixture.mSnapshotBuilder.forEachVisibleSnapshot([&](const LayerSnapshot& snapshot) {
+            area += snapshot.alpha * snapshot.transformedBounds.getWidth() *
+                    snapshot.transformedBounds.getHeight();
+        });
+        benchmark::DoNotOptimize(area);
+    }
+}
+BENCHMARK(sumVisibleAreaFromSnapshots)->Arg(500)->Arg(1000)->Arg(2000);
+
+static void sumVisibleAreaFromSnapshotTable(benchmark::State& state) {
+    LayerSnapshotBuilderFixture fixture(static_cast<uint32_t>(state.range(0)));
+    const auto& table = fixture.mSnapshotBuilder.getSnapshotTable();
+    const size_t size = fixture.mSnapshotBuilder.getNumInterestingSnapshots();
+    for (auto _ : state) {
+        float area = 0;
+        for (size_t z = 0; z < size; z++) {
+            const FloatRect& bounds = table.transformedBounds[z];
+            area += table.isVisible[z] * table.alpha[z] * bounds.getWidth() * bounds.getHeight();
+        }
+        benchmark::DoNotOptimize(area);
+    }
+}
+BENCHMARK(sumVisibleAreaFromSnapshotTable)->Arg(500)->Arg(1000)->Arg(2000);
+
+} // namespace
+} // namespace android::surfaceflinger
@@ -0,0 +1,166 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <FrontEnd/LayerCreationArgs.h>
+#include <FrontEnd/LayerHierarchy.h>
+#include <FrontEnd/LayerLifecycleManager.h>
+#include <FrontEnd/LayerSnapshotBuilder.h>
+#include <FrontEnd/RequestedLayerState.h>
+#include <Tracing/TransactionProtoParser.h>
+#include <Tracing/TransactionTracing.h>
+#include <TransactionState.h>
+
+namespace android::surfaceflinger {
+
+namespace {
+
+using namespace android::surfaceflinger::frontend;
+
+// A committed frame of a transaction trace, parsed ahead of time so that the benchmark measures
+// the front end rather than the proto parser.
+struct ReplayFrame {
+    std::vector<LayerCreationArgs> addedLayers;
+    std::vector<TransactionState> transactions;
+    std::vector<std::pair<uint32_t, std::string>> destroyedHandles;
+    std::optional<DisplayInfos> displays;
+};
+
+// Parses the transaction trace at $SF_TRANSACTION_TRACE, or at the path that SurfaceFlinger writes
+// transaction traces to if it is not set. The continuous trace of a device can be written there
+// with `adb shell su root service call SurfaceFlinger 1042`.
+std::optional<std::vector<ReplayFrame>> parseTransactionTrace() {
+    const char* path = std::getenv("SF_TRANSACTION_TRACE");
+    if (!path) path = TransactionTracing::FILE_PATH;
+
+    std::ifstream input(path, std::ios::in | std::ios::binary);
+    perfetto::protos::TransactionTraceFile traceFile;
+    if (!input || !traceFile.ParseFromIstream(&input)) {
+        return std::nullopt;
+    }
+
+    TransactionProtoParser parser(std::make_unique<TransactionProtoParser::FlingerDataMapper>());
+    std::vector<ReplayFrame> frames;
+    frames.reserve(static_cast<size_t>(traceFile.entry_size()));
+
+    DisplayInfos displays;
+    for (const auto& entry : traceFile.entry()) {
+        ReplayFrame& frame = frames.emplace_back();
+
+        for (const auto& layerProto : entry.added_layers()) {
+            parser.fromProto(layerProto, frame.addedLayers.emplace_back());
+        }
+
+        for (const auto& transactionProto : entry.transactions()) {
+            TransactionState transaction = parser.fromProto(transactionProto);
+            for (auto& resolvedComposerState : transaction.states) {
+                if (resolvedComposerState.state.what & layer_state_t::eInputInfoChanged &&
+                    !resolvedComposerState.state.windowInfoHandle->getInfo()->inputConfig.test(
+                            gui::WindowInfo::InputConfig::NO_INPUT_CHANNEL)) {
+                    // The front end expects input windows to have a valid token.
+                    resolvedComposerState.state.windowInfoHandle->editInfo()->token =
+                            sp<BBinder>::make();
+                }
+            }
+            frame.transactions.emplace_back(std::move(transaction));
+        }
+
+        for (const uint32_t handle : entry.destroyed_layer_handles()) {
+            frame.destroyedHandles.emplace_back(handle, "");
+        }
+
+        if (entry.displays_changed()) {
+            parser.fromProto(entry.displays(), displays);
+            frame.displays = displays;
+        }
+    }
+
+    return frames;
+}
+
+const std::optional<std::vector<ReplayFrame>>& transactionTrace() {
+    static const auto trace = parseTransactionTrace();
+    return trace;
+}
+
+// Replays a recorded transaction trace through the front end, as SurfaceFlinger's commit does for
+// each frame, without composition. Reports the front end time per frame of the trace.
+void replayTransactionTrace(benchmark::State& state) {
+    const auto& trace = transactionTrace();
+    if (!trace || trace->empty()) {
+        state.SkipWithError("Could not read the transaction trace, see SF_TRANSACTION_TRACE");
+        return;
+    }
+
+    const ShadowSettings shadowSettings{.ambientColor = {1, 1, 1, 1}};
+
+    for (auto _ : state) {
+        LayerLifecycleManager lifecycleManager;
+        LayerHierarchyBuilder hierarchyBuilder;
+        LayerSnapshotBuilder snapshotBuilder;
+        DisplayInfos displays;
+
+        for (const ReplayFrame& frame : *trace) {
+            std::vector<std::unique_ptr<RequestedLayerState>> addedLayers;
+            addedLayers.reserve(frame.addedLayers.size());
+            for (const LayerCreationArgs& args : frame.addedLayers) {
+                addedLayers.emplace_back(std::make_unique<RequestedLayerState>(args));
+            }
+            if (frame.displays) {
+                displays = *frame.displays;
+            }
+
+            lifecycleManager.addLayers(std::move(addedLayers));
+            lifecycleManager.applyTransactions(frame.transactions, /*ignoreUnknownLayers=*/true);
+            lifecycleManager.onHandlesDestroyed(frame.destroyedHandles,
+                                                /*ignoreUnknownHandles=*/true);
+
+            if (lifecycleManager.getGlobalChanges().test(RequestedLayerState::Changes::Hierarchy)) {
+                hierarchyBuilder.update(lifecycleManager);
+            }
+            LayerSnapshotBuilder::Args args{.root = hierarchyBuilder.getHierarchy(),
+                                            .layerLifecycleManager = lifecycleManager,
+                                            .displays = displays,
+                                            .displayChanges = frame.displays.has_value(),
+                                            .globalShadowSettings = shadowSettings,
+                                            .supportedLayerGenericMetadata = {},
+                                            .genericLayerMetadataKeyMap = {}};
+            snapshotBuilder.update(args);
+            lifecycleManager.commitChanges();
+        }
+
+        benchmark::DoNotOptimize(snapshotBuilder.getSnapshots().size());
+    }
+
+    state.counters["frames"] = static_cast<double>(trace->size());
+    state.counters["time_per_frame"] =
+            benchmark::Counter(static_cast<double>(trace->size()),
+                               benchmark::Counter::kIsIterationInvariantRate |
+                                       benchmark::Counter::kInvert);
+}
+BENCHMARK(replayTransactionTrace)->Unit(benchmark::kMillisecond);
+
+} // namespace
+} // namespace android::surfaceflinger
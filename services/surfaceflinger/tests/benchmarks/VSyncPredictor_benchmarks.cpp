@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <Scheduler/VSyncPredictor.h>
+#include <mock/DisplayHardware/MockDisplayMode.h>
+
+namespace android::scheduler {
+
+namespace {
+
+constexpr PhysicalDisplayId kDisplayId = PhysicalDisplayId::fromPort(42u);
+
+// Matches the configuration of the predictor that VsyncSchedule creates.
+constexpr size_t kHistorySize = 20;
+constexpr size_t kMinSamplesForPrediction = 6;
+constexpr uint32_t kDiscardOutlierPercent = 20;
+
+class ReplayClock : public Clock {
+public:
+    explicit ReplayClock(const nsecs_t& now) : mNow(now) {}
+    nsecs_t now() const override { return mNow; }
+
+private:
+    const nsecs_t& mNow;
+};
+
+ftl::NonNull<DisplayModePtr> displayMode(Fps refreshRate) {
+    return ftl::as_non_null(mock::createDisplayMode(DisplayModeId(0), refreshRate, /*group=*/0,
+                                                    ui::Size(1080, 2400), kDisplayId));
+}
+
+// Generates the HW vsync timestamps of a panel at the given rate. Each timestamp is delayed by
+// HWC jitter, and occasionally a vsync callback is late by most of a period, as seen on real
+// panels when the HWC thread is preempted.
+std::vector<nsecs_t> generateVsyncTrace(Fps refreshRate, nsecs_t jitterStdDev, size_t count) {
+    std::mt19937 generator(/*seed=*/42);
+    std::normal_distribution<double> jitter(0.0, static_cast<double>(jitterStdDev));
+    std::uniform_int_distribution<int> lateChance(0, 99);
+
+    const nsecs_t period = refreshRate.getPeriodNsecs();
+    std::vector<nsecs_t> trace;
+    trace.reserve(count);
+
+    nsecs_t vsync = 1'000'000'000;
+    for (size_t i = 0; i < count; i++) {
+        vsync += period;
+        nsecs_t delay = std::abs(static_cast<nsecs_t>(jitter(generator)));
+        if (lateChance(generator) == 0) {
+            delay += period * 3 / 4;
+        }
+        trace.push_back(vsync + delay);
+    }
+    return trace;
+}
+
+// Replays a vsync trace through the predictor. Besides the time taken per sample, reports the
+// mean error of predicting each vsync from the one before it.
+void replayVsyncTrace(benchmark::State& state, Fps refreshRate) {
+    const auto trace = generateVsyncTrace(refreshRate, /*jitterStdDev=*/state.range(0), 600);
+
+    nsecs_t now = 0;
+    VSyncPredictor predictor{std::make_unique<ReplayClock>(now), displayMode(refreshRate),
+                             kHistorySize, kMinSamplesForPrediction, kDiscardOutlierPercent};
+
+    double totalError = 0;
+    size_t predictions = 0;
+
+    for (auto _ : state) {
+        predictor.resetModel();
+        for (size_t i = 0; i + 1 < trace.size(); i++) {
+            now = trace[i];
+            benchmark::DoNotOptimize(predictor.addVsyncTimestamp(trace[i]));
+
+            const nsecs_t predicted = predictor.nextAnticipatedVSyncTimeFrom(trace[i] + 1);
+            totalError += static_cast<double>(std::abs(predicted - trace[i + 1]));
+            predictions++;
+        }
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * (trace.size() - 1)));
+    state.counters["mean_error_us"] = predictions ? totalError / predictions / 1e3 : 0;
+}
+
+void replayVsyncTrace_60Hz(benchmark::State& state) {
+    replayVsyncTrace(state, 60_Hz);
+}
+BENCHMARK(replayVsyncTrace_60Hz)->Arg(50'000)->Arg(200'000)->Arg(500'000);
+
+void replayVsyncTrace_120Hz(benchmark::State& state) {
+    replayVsyncTrace(state, 120_Hz);
+}
+BENCHMARK(replayVsyncTrace_120Hz)->Arg(50'000)->Arg(200'000)->Arg(500'000);
+
+} // namespace
+} // namespace android::scheduler
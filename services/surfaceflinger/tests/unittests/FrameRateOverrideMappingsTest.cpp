@@ -100,6 +100,33 @@ TEST_F(FrameRateOverrideMappingsTest, testSetPreferredRefreshRateForUid) {
                       .getFrameRateOverrideForUid(1, /*supportsFrameRateOverrideByContent*/ false));
 }
 
+TEST_F(FrameRateOverrideMappingsTest, testRemovedOverrideFallsBackToLowerPriority) {
+    SET_FLAG_FOR_TEST(flags::game_default_frame_rate, false);
+    mFrameRateOverrideByContent.clear();
+    mFrameRateOverrideByContent.emplace(1, 45.0_Hz);
+    ASSERT_TRUE(mFrameRateOverrideMappings.updateFrameRateOverridesByContent(
+            mFrameRateOverrideByContent));
+    mFrameRateOverrideMappings.setGameModeRefreshRateForUid({1, 30.0f});
+    mFrameRateOverrideMappings.setPreferredRefreshRateForUid({1, 60.0f});
+
+    ASSERT_TRUE(isApproxEqual(60.0_Hz,
+                              *mFrameRateOverrideMappings.getFrameRateOverrideForUid(
+                                      1, /*supportsFrameRateOverrideByContent*/ true)));
+
+    mFrameRateOverrideMappings.setPreferredRefreshRateForUid({1, 0.0f});
+    ASSERT_TRUE(isApproxEqual(30.0_Hz,
+                              *mFrameRateOverrideMappings.getFrameRateOverrideForUid(
+                                      1, /*supportsFrameRateOverrideByContent*/ true)));
+
+    mFrameRateOverrideMappings.setGameModeRefreshRateForUid({1, 0.0f});
+    ASSERT_TRUE(isApproxEqual(45.0_Hz,
+                              *mFrameRateOverrideMappings.getFrameRateOverrideForUid(
+                                      1, /*supportsFrameRateOverrideByContent*/ true)));
+    ASSERT_EQ(std::nullopt,
+              mFrameRateOverrideMappings
+                      .getFrameRateOverrideForUid(1, /*supportsFrameRateOverrideByContent*/ false));
+}
+
 TEST_F(FrameRateOverrideMappingsTest, testGetFrameRateOverrideForUidMixed) {
     SET_FLAG_FOR_TEST(flags::game_default_frame_rate, false);
     mFrameRateOverrideByContent.clear();
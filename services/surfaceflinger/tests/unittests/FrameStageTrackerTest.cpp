@@ -0,0 +1,154 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#undef LOG_TAG
+#define LOG_TAG "FrameStageTrackerTest"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+
+#include "FrameStageTracker.h"
+
+namespace android {
+namespace {
+
+size_t index(FrameStage stage) {
+    return static_cast<size_t>(stage);
+}
+
+TEST(FrameStageTrackerTest, accumulatesStagesOfEndedFrame) {
+    FrameStageTracker tracker;
+    tracker.beginFrame(42);
+    tracker.addStageDuration(FrameStage::InputUpdate, 100);
+    tracker.addStageDuration(FrameStage::Composition, 300);
+    tracker.addStageDuration(FrameStage::InputUpdate, 50);
+    tracker.endFrame();
+
+    const auto frames = tracker.getFrames();
+    ASSERT_EQ(1u, frames.size());
+    EXPECT_EQ(42, frames[0].vsyncId);
+    EXPECT_EQ(150, frames[0].durations[index(FrameStage::InputUpdate)]);
+    EXPECT_EQ(300, frames[0].durations[index(FrameStage::Composition)]);
+    EXPECT_EQ(0, frames[0].durations[index(FrameStage::TransactionFlush)]);
+}
+
+TEST(FrameStageTrackerTest, discardsFrameThatWasNotEnded) {
+    FrameStageTracker tracker;
+    tracker.beginFrame(1);
+    tracker.addStageDuration(FrameStage::SnapshotBuild, 100);
+
+    tracker.beginFrame(2);
+    tracker.addStageDuration(FrameStage::SnapshotBuild, 10);
+    tracker.endFrame();
+
+    // Durations outside of a frame are ignored.
+    tracker.addStageDuration(FrameStage::SnapshotBuild, 1000);
+    tracker.endFrame();
+
+    const auto frames = tracker.getFrames();
+    ASSERT_EQ(1u, frames.size());
+    EXPECT_EQ(2, frames[0].vsyncId);
+    EXPECT_EQ(10, frames[0].durations[index(FrameStage::SnapshotBuild)]);
+}
+
+TEST(FrameStageTrackerTest, keepsMostRecentFrames) {
+    FrameStageTracker tracker;
+    constexpr size_t kFrameCount = FrameStageTracker::kMaxFrames + 10;
+    for (size_t i = 0; i < kFrameCount; i++) {
+        tracker.beginFrame(static_cast<int64_t>(i));
+        tracker.endFrame();
+    }
+
+    const auto frames = tracker.getFrames();
+    ASSERT_EQ(FrameStageTracker::kMaxFrames, frames.size());
+    EXPECT_EQ(10, frames.front().vsyncId);
+    EXPECT_EQ(static_cast<int64_t>(kFrameCount - 1), frames.back().vsyncId);
+}
+
+TEST(FrameStageTrackerTest, dumpListsEveryStage) {
+    FrameStageTracker tracker;
+    tracker.beginFrame(7);
+    tracker.endFrame();
+
+    std::string result;
+    tracker.dump(result);
+    for (size_t i = 0; i < FrameStageTracker::kStageCount; i++) {
+        EXPECT_NE(std::string::npos,
+                  result.find(FrameStageTracker::stageName(static_cast<FrameStage>(i))));
+    }
+}
+
+TEST(FrameStageTrackerTest, countsStageAllocationsWhenEnabled) {
+    FrameStageTracker tracker;
+    tracker.setAllocationCountingEnabled(true);
+    tracker.beginFrame(1);
+    {
+        FrameStageTracker::ScopedStage stage(tracker, FrameStage::SnapshotBuild);
+        auto allocation = std::make_unique<std::array<char, 64>>();
+        EXPECT_NE(nullptr, allocation);
+    }
+    tracker.endFrame();
+
+    tracker.setAllocationCountingEnabled(false);
+    tracker.beginFrame(2);
+    {
+        FrameStageTracker::ScopedStage stage(tracker, FrameStage::SnapshotBuild);
+        auto allocation = std::make_unique<std::array<char, 64>>();
+        EXPECT_NE(nullptr, allocation);
+    }
+    tracker.endFrame();
+
+    const auto frames = tracker.getFrames();
+    ASSERT_EQ(2u, frames.size());
+    EXPECT_EQ(1u, frames[0].allocations[index(FrameStage::SnapshotBuild)].allocations);
+    EXPECT_EQ(64u, frames[0].allocations[index(FrameStage::SnapshotBuild)].bytes);
+    EXPECT_EQ(0u, frames[0].allocations[index(FrameStage::Composition)].allocations);
+    EXPECT_EQ(0u, frames[1].getTotalAllocations().allocations);
+}
+
+TEST(FrameStageTrackerTest, reportsSteadyStateFramesOverAllocationBudget) {
+    FrameStageTracker tracker;
+    tracker.setAllocationBudget(2);
+
+    tracker.beginFrame(1);
+    tracker.addStageAllocations(FrameStage::Composition, {.allocations = 2, .bytes = 32});
+    tracker.endFrame();
+
+    tracker.beginFrame(2);
+    tracker.addStageAllocations(FrameStage::Composition, {.allocations = 2, .bytes = 32});
+    tracker.addStageAllocations(FrameStage::PostComposition, {.allocations = 1, .bytes = 8});
+    tracker.endFrame();
+
+    // Frames that flush transactions are not in steady state, so they may exceed the budget.
+    tracker.beginFrame(3);
+    tracker.addStageDuration(FrameStage::TransactionFlush, 100);
+    tracker.addStageAllocations(FrameStage::TransactionFlush, {.allocations = 10, .bytes = 320});
+    tracker.endFrame();
+
+    const auto frames = tracker.getFramesOverAllocationBudget();
+    ASSERT_EQ(1u, frames.size());
+    EXPECT_EQ(2, frames[0].vsyncId);
+    EXPECT_EQ((AllocationCounter::Counts{.allocations = 3, .bytes = 40}),
+              frames[0].getTotalAllocations());
+
+    std::string result;
+    tracker.dump(result);
+    EXPECT_NE(std::string::npos, result.find("over budget: 1"));
+}
+
+} // namespace
+} // namespace android
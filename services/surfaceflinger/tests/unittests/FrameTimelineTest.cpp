@@ -710,6 +710,85 @@ TEST_F(FrameTimelineTest, presentFenceSignaled_reportsDisplayMiss) {
     EXPECT_EQ(jankData[0].jankType, JankType::DisplayHAL);
 }
 
+TEST_F(FrameTimelineTest, presentFenceSignaled_classifiesJankInBackground) {
+    constexpr bool kUseBootTimeClock = true;
+    constexpr bool kFilterFramesBeforeTraceStarts = false;
+    constexpr bool kClassifyJankInBackground = true;
+    mFrameTimeline = std::make_unique<impl::FrameTimeline>(mTimeStats, kSurfaceFlingerPid,
+                                                           kTestThresholds, !kUseBootTimeClock,
+                                                           kFilterFramesBeforeTraceStarts,
+                                                           kClassifyJankInBackground);
+    mTokenManager = &mFrameTimeline->mTokenManager;
+
+    Fps refreshRate = RR_30;
+    EXPECT_CALL(*mTimeStats,
+                incrementJankyFrames(TimeStats::JankyFramesInfo{refreshRate, std::nullopt, sUidOne,
+                                                                sLayerNameOne, sGameMode,
+                                                                JankType::DisplayHAL, -4, 0, 0}));
+
+    auto presentFence1 = fenceFactory.createFenceTimeForTest(Fence::NO_FENCE);
+    int64_t surfaceFrameToken1 = mTokenManager->generateTokenForPredictions({10, 20, 60});
+    int64_t sfToken1 = mTokenManager->generateTokenForPredictions({52, 60, 60});
+    FrameTimelineInfo ftInfo;
+    ftInfo.vsyncId = surfaceFrameToken1;
+    ftInfo.inputEventId = sInputEventId;
+
+    auto surfaceFrame1 =
+            mFrameTimeline->createSurfaceFrameForToken(ftInfo, sPidOne, sUidOne, sLayerIdOne,
+                                                       sLayerNameOne, sLayerNameOne,
+                                                       /*isBuffer*/ true, sGameMode);
+    mFrameTimeline->setSfWakeUp(sfToken1, 52, refreshRate, refreshRate);
+    surfaceFrame1->setPresentState(SurfaceFrame::PresentState::Presented);
+    surfaceFrame1->setAcquireFenceTime(20);
+    mFrameTimeline->addSurfaceFrame(surfaceFrame1);
+    presentFence1->signalForTest(90);
+    mFrameTimeline->setSfPresent(56, presentFence1);
+
+    // The frame is classified on the BackgroundExecutor, which then queues the jank data.
+    BackgroundExecutor::getLowPriorityInstance().flushQueue();
+    EXPECT_EQ(surfaceFrame1->getJankType(), JankType::DisplayHAL);
+    EXPECT_EQ(surfaceFrame1->getJankSeverityType(), JankSeverityType::Full);
+    EXPECT_EQ(getDisplayFrame(0)->getActuals().presentTime, 90);
+
+    auto jankData = getLayerOneJankData();
+    EXPECT_EQ(jankData.size(), 1u);
+    EXPECT_EQ(jankData[0].jankType, JankType::DisplayHAL);
+}
+
+TEST_F(FrameTimelineTest, presentFenceSignaledLater_classifiesJankInBackground) {
+    constexpr bool kUseBootTimeClock = true;
+    constexpr bool kFilterFramesBeforeTraceStarts = false;
+    constexpr bool kClassifyJankInBackground = true;
+    mFrameTimeline = std::make_unique<impl::FrameTimeline>(mTimeStats, kSurfaceFlingerPid,
+                                                           kTestThresholds, !kUseBootTimeClock,
+                                                           kFilterFramesBeforeTraceStarts,
+                                                           kClassifyJankInBackground);
+    mTokenManager = &mFrameTimeline->mTokenManager;
+
+    auto presentFence1 = fenceFactory.createFenceTimeForTest(Fence::NO_FENCE);
+    int64_t sfToken1 = mTokenManager->generateTokenForPredictions({22, 26, 30});
+    mFrameTimeline->setSfWakeUp(sfToken1, 22, RR_11, RR_11);
+    mFrameTimeline->setSfPresent(27, presentFence1);
+
+    // The display frame is only added once its present fence signaled.
+    BackgroundExecutor::getLowPriorityInstance().flushQueue();
+    EXPECT_EQ(getNumberOfDisplayFrames(), 0u);
+
+    presentFence1->signalForTest(32);
+    auto presentFence2 = fenceFactory.createFenceTimeForTest(Fence::NO_FENCE);
+    presentFence2->signalForTest(62);
+    int64_t sfToken2 = mTokenManager->generateTokenForPredictions({52, 56, 60});
+    mFrameTimeline->setSfWakeUp(sfToken2, 52, RR_11, RR_11);
+    mFrameTimeline->setSfPresent(57, presentFence2);
+
+    BackgroundExecutor::getLowPriorityInstance().flushQueue();
+    ASSERT_EQ(getNumberOfDisplayFrames(), 2u);
+    EXPECT_EQ(compareTimelineItems(getDisplayFrame(0)->getActuals(), TimelineItem(22, 27, 32)),
+              true);
+    EXPECT_EQ(compareTimelineItems(getDisplayFrame(1)->getActuals(), TimelineItem(52, 57, 62)),
+              true);
+}
+
 TEST_F(FrameTimelineTest, presentFenceSignaled_reportsAppMiss) {
     Fps refreshRate = 11_Hz;
     EXPECT_CALL(*mTimeStats,
@@ -2870,4 +2949,22 @@ TEST_F(FrameTimelineTest, surfaceFrameRenderRateUsingAppFrameRate) {
 
     EXPECT_EQ(surfaceFrame->getRenderRate().getPeriodNsecs(), 30);
 }
+
+TEST(LayerNameInternerTest, sharesNamesWhileInUse) {
+    LayerNameInterner interner;
+    const auto first = interner.intern(sLayerNameOne);
+    const auto second = interner.intern(sLayerNameOne);
+    EXPECT_EQ(first.get(), second.get());
+    EXPECT_EQ(sLayerNameOne, *first);
+    EXPECT_NE(first.get(), interner.intern(sLayerNameTwo).get());
+}
+
+TEST(LayerNameInternerTest, purgesUnusedNames) {
+    LayerNameInterner interner;
+    for (int i = 0; i < 1000; i++) {
+        interner.intern("layer" + std::to_string(i));
+    }
+    EXPECT_LT(interner.size(), 1000u);
+}
+
 } // namespace android::frametimeline
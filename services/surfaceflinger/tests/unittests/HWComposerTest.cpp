@@ -598,4 +598,124 @@ TEST_F(HWComposerLayerGenericMetadataTest, forwardsSupportedMetadata) {
     EXPECT_EQ(hal::Error::UNSUPPORTED, result);
 }
 
+struct HWComposerLayerStateTest : public HWComposerLayerTest {
+    HWComposerLayerStateTest() : HWComposerLayerTest({}) {}
+};
+
+TEST_F(HWComposerLayerStateTest, skipsUnchangedState) {
+    SET_FLAG_FOR_TEST(com::android::graphics::surfaceflinger::flags::skip_unchanged_layer_commands,
+                      true);
+
+    EXPECT_CALL(*mHal, setLayerZOrder(kDisplayId, kLayerId, 1u))
+            .WillOnce(Return(V2_4::Error::NONE));
+    EXPECT_EQ(hal::Error::NONE, mLayer.setZOrder(1u));
+    EXPECT_EQ(hal::Error::NONE, mLayer.setZOrder(1u));
+
+    EXPECT_CALL(*mHal, setLayerZOrder(kDisplayId, kLayerId, 2u))
+            .WillOnce(Return(V2_4::Error::NONE));
+    EXPECT_EQ(hal::Error::NONE, mLayer.setZOrder(2u));
+
+    // A value the HWC failed to take is sent again.
+    EXPECT_CALL(*mHal, setLayerPlaneAlpha(kDisplayId, kLayerId, 0.5f))
+            .WillOnce(Return(V2_4::Error::BAD_PARAMETER))
+            .WillOnce(Return(V2_4::Error::NONE));
+    EXPECT_EQ(hal::Error::BAD_PARAMETER, mLayer.setPlaneAlpha(0.5f));
+    EXPECT_EQ(hal::Error::NONE, mLayer.setPlaneAlpha(0.5f));
+    EXPECT_EQ(hal::Error::NONE, mLayer.setPlaneAlpha(0.5f));
+}
+
+struct HWComposerLayerRecyclingTest : public testing::Test {
+    static constexpr hal::HWDisplayId kDisplayId = static_cast<hal::HWDisplayId>(1001);
+    static constexpr hal::HWLayerId kLayerId = static_cast<hal::HWLayerId>(1002);
+
+    std::shared_ptr<HWC2::Layer> createLayer(HWC2::impl::Display& display) {
+        auto layer = display.createLayer();
+        EXPECT_TRUE(layer.has_value());
+        return layer.value_or(nullptr);
+    }
+
+    std::unique_ptr<Hwc2::mock::Composer> mHal{new StrictMock<Hwc2::mock::Composer>()};
+    const std::unordered_set<aidl::Capability> mCapabilities;
+};
+
+TEST_F(HWComposerLayerRecyclingTest, reusesLayerReleasedBeforeFirstUse) {
+    SET_FLAG_FOR_TEST(com::android::graphics::surfaceflinger::flags::recycle_hwc_layers, true);
+    HWC2::impl::Display display(*mHal, mCapabilities, kDisplayId, hal::DisplayType::INVALID);
+
+    // The HWC layer is only created once a command is sent to the layer.
+    auto oldLayer = createLayer(display);
+    EXPECT_CALL(*mHal, createLayer(kDisplayId, _))
+            .WillOnce(DoAll(SetArgPointee<1>(kLayerId), Return(V2_4::Error::NONE)));
+    EXPECT_CALL(*mHal, setLayerZOrder(kDisplayId, kLayerId, 1u))
+            .WillOnce(Return(V2_4::Error::NONE));
+    EXPECT_EQ(hal::Error::NONE, oldLayer->setZOrder(1u));
+
+    // A layer created before the old one is destroyed takes over its HWC layer.
+    auto newLayer = createLayer(display);
+    oldLayer.reset();
+    EXPECT_CALL(*mHal, setLayerZOrder(kDisplayId, kLayerId, 2u))
+            .WillOnce(Return(V2_4::Error::NONE));
+    EXPECT_EQ(hal::Error::NONE, newLayer->setZOrder(2u));
+    EXPECT_EQ(kLayerId, newLayer->getId());
+
+    // The display destroys the HWC layers it still holds.
+    EXPECT_CALL(*mHal, destroyLayer(kDisplayId, kLayerId)).WillOnce(Return(V2_4::Error::NONE));
+}
+
+TEST_F(HWComposerLayerRecyclingTest, sendsDefaultStateToRecycledLayer) {
+    SET_FLAG_FOR_TEST(com::android::graphics::surfaceflinger::flags::recycle_hwc_layers, true);
+    HWC2::impl::Display display(*mHal, mCapabilities, kDisplayId, hal::DisplayType::INVALID);
+
+    auto oldLayer = createLayer(display);
+    EXPECT_CALL(*mHal, createLayer(kDisplayId, _))
+            .WillOnce(DoAll(SetArgPointee<1>(kLayerId), Return(V2_4::Error::NONE)));
+    EXPECT_CALL(*mHal, setLayerDataspace(kDisplayId, kLayerId, hal::Dataspace::SRGB))
+            .WillOnce(Return(V2_4::Error::NONE));
+    EXPECT_CALL(*mHal, setLayerColorTransform(kDisplayId, kLayerId, _))
+            .WillOnce(Return(V2_4::Error::NONE));
+    EXPECT_EQ(hal::Error::NONE, oldLayer->setDataspace(hal::Dataspace::SRGB));
+    EXPECT_EQ(hal::Error::NONE, oldLayer->setColorTransform(mat4::scale(vec4(0.5f))));
+
+    auto newLayer = createLayer(display);
+    oldLayer.reset();
+
+    // The HWC layer still has the old layer's dataspace and color transform, so the defaults are
+    // sent to it.
+    EXPECT_CALL(*mHal, setLayerDataspace(kDisplayId, kLayerId, hal::Dataspace::UNKNOWN))
+            .WillOnce(Return(V2_4::Error::NONE));
+    EXPECT_CALL(*mHal, setLayerColorTransform(kDisplayId, kLayerId, _))
+            .WillOnce(Return(V2_4::Error::NONE));
+    EXPECT_EQ(hal::Error::NONE, newLayer->setDataspace(hal::Dataspace::UNKNOWN));
+    EXPECT_EQ(hal::Error::NONE, newLayer->setColorTransform(mat4()));
+    EXPECT_EQ(kLayerId, newLayer->getId());
+
+    // Once sent, they are cached as usual.
+    EXPECT_EQ(hal::Error::NONE, newLayer->setDataspace(hal::Dataspace::UNKNOWN));
+    EXPECT_EQ(hal::Error::NONE, newLayer->setColorTransform(mat4()));
+
+    EXPECT_CALL(*mHal, destroyLayer(kDisplayId, kLayerId)).WillOnce(Return(V2_4::Error::NONE));
+}
+
+TEST_F(HWComposerLayerRecyclingTest, destroysUnusedLayersBeforePresent) {
+    SET_FLAG_FOR_TEST(com::android::graphics::surfaceflinger::flags::recycle_hwc_layers, true);
+    HWC2::impl::Display display(*mHal, mCapabilities, kDisplayId, hal::DisplayType::INVALID);
+
+    auto layer = createLayer(display);
+    EXPECT_CALL(*mHal, createLayer(kDisplayId, _))
+            .WillOnce(DoAll(SetArgPointee<1>(kLayerId), Return(V2_4::Error::NONE)));
+    EXPECT_CALL(*mHal, setLayerZOrder(kDisplayId, kLayerId, 1u))
+            .WillOnce(Return(V2_4::Error::NONE));
+    EXPECT_EQ(hal::Error::NONE, layer->setZOrder(1u));
+    layer.reset();
+
+    // A layer that never sends a command doesn't take the recycled HWC layer.
+    auto unusedLayer = createLayer(display);
+
+    testing::InSequence seq;
+    EXPECT_CALL(*mHal, destroyLayer(kDisplayId, kLayerId)).WillOnce(Return(V2_4::Error::NONE));
+    EXPECT_CALL(*mHal, presentDisplay(kDisplayId, _)).WillOnce(Return(V2_4::Error::NONE));
+    sp<Fence> presentFence;
+    EXPECT_EQ(hal::Error::NONE, display.present(&presentFence));
+}
+
 } // namespace android
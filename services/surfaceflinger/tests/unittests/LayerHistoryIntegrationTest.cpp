@@ -240,6 +240,22 @@ TEST_F(LayerHistoryIntegrationTest, singleLayerMinVoteDefaultCompatibility) {
     EXPECT_EQ(1u, activeLayerCount());
 }
 
+TEST_F(LayerHistoryIntegrationTest, summarizeInPlaceOverwritesPreviousSummary) {
+    createLegacyAndFrontedEndLayer(1);
+    nsecs_t time = systemTime();
+    setBuffer(1);
+    setDefaultFrameRateCompatibility(1, ANATIVEWINDOW_FRAME_RATE_MIN);
+    updateLayerSnapshotsAndLayerHistory(time);
+
+    LayerHistory::Summary summary(3);
+    summary[0].name = "stale";
+    history().summarize(*mScheduler->refreshRateSelector(), time, summary);
+
+    ASSERT_EQ(1u, summary.size());
+    EXPECT_EQ(summarizeLayerHistory(time)[0], summary[0]);
+    EXPECT_EQ(LayerHistory::LayerVoteType::Min, summary[0].vote);
+}
+
 TEST_F(LayerHistoryIntegrationTest, oneLayer) {
     createLegacyAndFrontedEndLayer(1);
     nsecs_t time = systemTime();
@@ -629,4 +629,28 @@ TEST_F(LayerLifecycleManagerTest, testInputInfoOfRequestedLayerState) {
     EXPECT_TRUE(getRequestedLayerState(mLifecycleManager, 111)->needsInputInfo());
 }
 
+TEST_F(LayerLifecycleManagerTest, destroyedLayersAreReused) {
+    LayerLifecycleManager lifecycleManager;
+    auto churn = [&](uint32_t firstId) {
+        std::vector<std::unique_ptr<RequestedLayerState>> layers;
+        std::vector<std::pair<uint32_t, std::string>> handles;
+        for (uint32_t id = firstId; id < firstId + 100; id++) {
+            layers.emplace_back(rootLayer(id));
+            handles.emplace_back(id, std::to_string(id));
+        }
+        lifecycleManager.addLayers(std::move(layers));
+        lifecycleManager.onHandlesDestroyed(handles);
+        lifecycleManager.commitChanges();
+    };
+
+    churn(1);
+    const size_t allocated = SlabAllocator<RequestedLayerState>::allocatedCount();
+    const size_t capacity = SlabAllocator<RequestedLayerState>::capacity();
+    for (uint32_t i = 1; i < 10; i++) {
+        churn(i * 100 + 1);
+    }
+    EXPECT_EQ(allocated, SlabAllocator<RequestedLayerState>::allocatedCount());
+    EXPECT_EQ(capacity, SlabAllocator<RequestedLayerState>::capacity());
+}
+
 } // namespace android::surfaceflinger::frontend
@@ -20,6 +20,7 @@
 #include <common/test/FlagUtils.h>
 #include <renderengine/mock/FakeExternalTexture.h>
 
+#include "FrameStageTracker.h"
 #include "FrontEnd/LayerHierarchy.h"
 #include "FrontEnd/LayerLifecycleManager.h"
 #include "FrontEnd/LayerSnapshotBuilder.h"
@@ -156,6 +157,32 @@ TEST_F(LayerSnapshotTest, updateSnapshot) {
 }
 
 // update using parent snapshot data
+// The snapshots of an unchanged hierarchy are updated on every frame, so doing so must not
+// allocate.
+TEST_F(LayerSnapshotTest, steadyStateUpdateDoesNotAllocate) {
+    LayerSnapshotBuilder::Args args{.root = mHierarchyBuilder.getHierarchy(),
+                                    .layerLifecycleManager = mLifecycleManager,
+                                    .includeMetadata = false,
+                                    .displays = mFrontEndDisplayInfos,
+                                    .globalShadowSettings = globalShadowSettings,
+                                    .supportsBlur = true,
+                                    .supportedLayerGenericMetadata = {},
+                                    .genericLayerMetadataKeyMap = {}};
+
+    FrameStageTracker tracker;
+    tracker.setAllocationCountingEnabled(true);
+    tracker.setAllocationBudget(0);
+    tracker.beginFrame(1);
+    {
+        FrameStageTracker::ScopedStage stage(tracker, FrameStage::SnapshotBuild);
+        mSnapshotBuilder.update(args);
+    }
+    tracker.endFrame();
+    AllocationCounter::setEnabled(false);
+
+    EXPECT_TRUE(tracker.getFramesOverAllocationBudget().empty());
+}
+
 TEST_F(LayerSnapshotTest, croppedByParent) {
     /// MAKE ALL LAYERS VISIBLE BY DEFAULT
     DisplayInfo info;
@@ -293,6 +320,24 @@ TEST_F(LayerSnapshotTest, FastPathSetsChangeFlagToContent) {
     EXPECT_EQ(getSnapshot(1)->clientChanges, layer_state_t::eColorChanged);
 }
 
+TEST_F(LayerSnapshotTest, LastChangeIdTracksUpdatesThatChangedSnapshot) {
+    setColor(11, {1._hf, 0._hf, 0._hf});
+    UPDATE_AND_VERIFY(mSnapshotBuilder, STARTING_ZORDER);
+    const uint64_t changeId = getSnapshot(11)->lastChangeId;
+    EXPECT_GT(changeId, getSnapshot(1)->lastChangeId);
+
+    // Updates that do not change the snapshot keep its id.
+    setColor(2, {1._hf, 0._hf, 0._hf});
+    UPDATE_AND_VERIFY(mSnapshotBuilder, STARTING_ZORDER);
+    EXPECT_EQ(getSnapshot(11)->lastChangeId, changeId);
+    UPDATE_AND_VERIFY(mSnapshotBuilder, STARTING_ZORDER);
+    EXPECT_EQ(getSnapshot(11)->lastChangeId, changeId);
+
+    setCrop(1, Rect(1, 2, 3, 4));
+    UPDATE_AND_VERIFY(mSnapshotBuilder, STARTING_ZORDER);
+    EXPECT_GT(getSnapshot(11)->lastChangeId, changeId);
+}
+
 TEST_F(LayerSnapshotTest, ChildrenInheritGameMode) {
     setGameMode(1, gui::GameMode::Performance);
     EXPECT_EQ(mLifecycleManager.getGlobalChanges(),
@@ -1935,4 +1980,134 @@ TEST_F(LayerSnapshotTest, shouldUpdateInputWhenNoInputInfo) {
     EXPECT_FALSE(getSnapshot(2)->hasInputInfo());
 }
 
+TEST_F(LayerSnapshotTest, skipsCleanSubtrees) {
+    SET_FLAG_FOR_TEST(flags::skip_clean_layer_subtrees, true);
+    UPDATE_AND_VERIFY(mSnapshotBuilder, STARTING_ZORDER);
+
+    setPosition(12, 10, 20);
+    UPDATE_AND_VERIFY(mSnapshotBuilder, STARTING_ZORDER);
+    EXPECT_EQ(getSnapshot(1221)->geomLayerTransform.tx(), 10);
+    EXPECT_EQ(getSnapshot(1221)->geomLayerTransform.ty(), 20);
+
+    setPosition(12, 30, 40);
+    setAlpha(11, 0.5f);
+    update(mSnapshotBuilder);
+    EXPECT_TRUE(getSnapshot(1221)->changes.test(RequestedLayerState::Changes::Geometry));
+    EXPECT_EQ(getSnapshot(1221)->geomLayerTransform.tx(), 30);
+    EXPECT_EQ(getSnapshot(111)->alpha, 0.5f);
+    // siblings of the changed layers are not visited
+    EXPECT_EQ(getSnapshot(13)->changes.get(), 0u);
+    EXPECT_EQ(getSnapshot(2)->changes.get(), 0u);
+}
+
+TEST_F(LayerSnapshotTest, skipsCleanSubtreesUpdatesRelativeAndMirroredChildren) {
+    SET_FLAG_FOR_TEST(flags::skip_clean_layer_subtrees, true);
+    reparentRelativeLayer(13, 2);
+    mirrorLayer(/*layer*/ 14, /*parent*/ 1, /*layerToMirror*/ 12);
+    UPDATE_AND_VERIFY(mSnapshotBuilder,
+                      ({1, 11, 111, 12, 121, 122, 1221, 14, 12, 121, 122, 1221, 2, 13}));
+
+    hideLayer(2);
+    setPosition(122, 5, 6);
+    UPDATE_AND_VERIFY(mSnapshotBuilder, ({1, 11, 111, 12, 121, 122, 1221, 14, 12, 121, 122, 1221}));
+    EXPECT_TRUE(getSnapshot(13)->isHiddenByPolicy());
+    EXPECT_EQ(getSnapshot(1221)->geomLayerTransform.tx(), 5);
+    EXPECT_EQ(getSnapshot({.id = 1221, .mirrorRootIds = 14u})->geomLayerTransform.tx(), 5);
+}
+
+TEST_F(LayerSnapshotTest, snapshotTableMatchesSnapshots) {
+    auto expectTableMatches = [&]() {
+        const auto& table = mSnapshotBuilder.getSnapshotTable();
+        for (size_t z = 0; z < mSnapshotBuilder.getNumInterestingSnapshots(); z++) {
+            const LayerSnapshot& snapshot = *mSnapshotBuilder.getSnapshots()[z];
+            EXPECT_EQ(table.isVisible[z], snapshot.isVisible) << snapshot.getDebugString();
+            EXPECT_EQ(table.alpha[z], snapshot.alpha) << snapshot.getDebugString();
+            EXPECT_EQ(table.layerStack[z], snapshot.outputFilter.layerStack);
+            EXPECT_EQ(table.transformedBounds[z], snapshot.transformedBounds);
+            EXPECT_EQ(table.geomLayerTransform[z], snapshot.geomLayerTransform);
+        }
+    };
+    expectTableMatches();
+
+    // full update
+    hideLayer(12);
+    setPosition(11, 10, 20);
+    UPDATE_AND_VERIFY(mSnapshotBuilder, ({1, 11, 111, 13, 2}));
+    expectTableMatches();
+
+    // fast path update
+    setColor(111, {1._hf, 0._hf, 0._hf});
+    UPDATE_AND_VERIFY(mSnapshotBuilder, ({1, 11, 111, 13, 2}));
+    EXPECT_EQ(getSnapshot(111)->changes, RequestedLayerState::Changes::Content);
+    expectTableMatches();
+}
+
+TEST_F(LayerSnapshotTest, parallelUpdateMatchesSerialUpdate) {
+    DisplayInfo info;
+    info.info.logicalHeight = 100;
+    info.info.logicalWidth = 200;
+    mFrontEndDisplayInfos.emplace_or_replace(ui::LayerStack::fromValue(1), info);
+    setLayerStack(2, 1);
+    mHierarchyBuilder.update(mLifecycleManager);
+    LayerSnapshotBuilder::Args args{.root = mHierarchyBuilder.getHierarchy(),
+                                    .layerLifecycleManager = mLifecycleManager,
+                                    .includeMetadata = false,
+                                    .displays = mFrontEndDisplayInfos,
+                                    .globalShadowSettings = globalShadowSettings,
+                                    .supportsBlur = true,
+                                    .supportedLayerGenericMetadata = {},
+                                    .genericLayerMetadataKeyMap = {}};
+    LayerSnapshotBuilder serialBuilder(args);
+    LayerSnapshotBuilder parallelBuilder(args);
+    mLifecycleManager.commitChanges();
+
+    auto updateAndCompare = [&]() {
+        if (mLifecycleManager.getGlobalChanges().test(RequestedLayerState::Changes::Hierarchy)) {
+            mHierarchyBuilder.update(mLifecycleManager);
+        }
+        args.root = mHierarchyBuilder.getHierarchy();
+        {
+            SET_FLAG_FOR_TEST(flags::parallel_snapshot_builder, false);
+            serialBuilder.update(args);
+        }
+        {
+            SET_FLAG_FOR_TEST(flags::parallel_snapshot_builder, true);
+            parallelBuilder.update(args);
+        }
+        mLifecycleManager.commitChanges();
+
+        const auto& serialSnapshots = serialBuilder.getSnapshots();
+        const auto& parallelSnapshots = parallelBuilder.getSnapshots();
+        ASSERT_EQ(serialSnapshots.size(), parallelSnapshots.size());
+        for (size_t i = 0; i < serialSnapshots.size(); i++) {
+            const LayerSnapshot& expected = *serialSnapshots[i];
+            const LayerSnapshot& actual = *parallelSnapshots[i];
+            std::stringstream expectedString, actualString;
+            expectedString << expected;
+            actualString << actual;
+            EXPECT_EQ(expected.getDebugString(), actual.getDebugString());
+            EXPECT_EQ(expectedString.str(), actualString.str());
+            EXPECT_EQ(expected.globalZ, actual.globalZ);
+            EXPECT_EQ(expected.alpha, actual.alpha);
+            EXPECT_EQ(expected.transformedBounds, actual.transformedBounds);
+            EXPECT_EQ(expected.geomLayerTransform, actual.geomLayerTransform);
+        }
+    };
+
+    setPosition(1, 10, 20);
+    setPosition(2, 30, 40);
+    updateAndCompare();
+
+    setAlpha(11, 0.5f);
+    setCrop(121, Rect(0, 0, 5, 5));
+    hideLayer(13);
+    updateAndCompare();
+
+    // relative layers across the layer stacks are updated serially
+    reparentRelativeLayer(111, 2);
+    updateAndCompare();
+    setPosition(2, 50, 60);
+    updateAndCompare();
+}
+
 } // namespace android::surfaceflinger::frontend
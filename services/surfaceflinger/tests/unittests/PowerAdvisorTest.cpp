@@ -577,6 +577,35 @@ TEST_F(PowerAdvisorTest, legacyHintSessionCreationStillWorks) {
     ASSERT_TRUE(mPowerAdvisor->startPowerHintSession({1, 2, 3}));
 }
 
+TEST(WorkloadModelTest, learnsCostOfCompositionWorkload) {
+    // 2ms per frame, 100us per layer, 1ms per blur layer, and 1.5ms when the gpu composites
+    const auto frameCost = [](size_t layerCount, size_t blurLayerCount, bool gpu) {
+        return Duration::fromNs(2'000'000 + 100'000 * static_cast<nsecs_t>(layerCount) +
+                                1'000'000 * static_cast<nsecs_t>(blurLayerCount) +
+                                (gpu ? 1'500'000 : 0));
+    };
+
+    WorkloadModel model;
+    for (size_t frame = 0; frame < 600; frame++) {
+        const size_t layerCount = 5 + (frame * 7) % 26;
+        const size_t blurLayerCount = (frame / 3) % 3;
+        const bool gpu = (frame / 5) % 2;
+        if (frame < 30) EXPECT_FALSE(model.isTrained());
+        model.train(WorkloadModel::makeFeatures(layerCount, blurLayerCount, gpu),
+                    frameCost(layerCount, blurLayerCount, gpu));
+    }
+    EXPECT_TRUE(model.isTrained());
+
+    for (const auto& [layerCount, blurLayerCount, gpu] :
+         {std::tuple{10u, 0u, false}, std::tuple{12u, 2u, true}, std::tuple{30u, 1u, false}}) {
+        const Duration expected = frameCost(layerCount, blurLayerCount, gpu);
+        const Duration predicted =
+                model.predict(WorkloadModel::makeFeatures(layerCount, blurLayerCount, gpu));
+        EXPECT_NEAR(static_cast<double>(predicted.ns()), static_cast<double>(expected.ns()),
+                    static_cast<double>(expected.ns()) * 0.05);
+    }
+}
+
 TEST_F(PowerAdvisorTest, setGpuFenceTime_cpuThenGpuFrames) {
     GpuTestConfig config{
             .adpfGpuFlagOn = false,
@@ -3256,19 +3256,22 @@ TEST_P(RefreshRateSelectorTest, getBestFrameRateMode_ReadsCache) {
                                                                   {90_Hz, kMode90}}},
                                                           GlobalSignals{.touch = true}};
 
-    selector.mutableGetRankedRefreshRatesCache() = {.layers = std::vector<LayerRequirement>{},
-                                                    .signals = GlobalSignals{.touch = true,
-                                                                             .idle = true},
-                                                    .result = result};
-
-    const auto& cache = *selector.mutableGetRankedRefreshRatesCache();
-    EXPECT_EQ(result, selector.getRankedFrameRates(cache.layers, cache.signals));
+    const std::vector<LayerRequirement> layers;
+    const GlobalSignals signals{.touch = true, .idle = true};
+    selector.mutableGetRankedRefreshRatesCache().push_back(
+            {.layers = layers,
+             .signals = signals,
+             .hash = TestableRefreshRateSelector::GetRankedFrameRatesCache::computeHash(layers,
+                                                                                      signals),
+             .result = result});
+
+    EXPECT_EQ(result, selector.getRankedFrameRates(layers, signals));
 }
 
 TEST_P(RefreshRateSelectorTest, getBestFrameRateMode_WritesCache) {
     auto selector = createSelector(kModes_30_60_72_90_120, kModeId60);
 
-    EXPECT_FALSE(selector.mutableGetRankedRefreshRatesCache());
+    EXPECT_TRUE(selector.mutableGetRankedRefreshRatesCache().empty());
 
     const std::vector<LayerRequirement> layers = {{.weight = 1.f}, {.weight = 0.5f}};
     const RefreshRateSelector::GlobalSignals globalSignals{.touch = true, .idle = true};
@@ -3277,12 +3280,42 @@ TEST_P(RefreshRateSelectorTest, getBestFrameRateMode_WritesCache) {
     const auto result = selector.getRankedFrameRates(layers, globalSignals, pacesetterFps);
 
     const auto& cache = selector.mutableGetRankedRefreshRatesCache();
-    ASSERT_TRUE(cache);
+    ASSERT_EQ(1u, cache.size());
+
+    EXPECT_EQ(cache.front().layers, layers);
+    EXPECT_EQ(cache.front().signals, globalSignals);
+    EXPECT_EQ(cache.front().pacesetterFps, pacesetterFps);
+    EXPECT_EQ(cache.front().result, result);
+}
+
+TEST_P(RefreshRateSelectorTest, getBestFrameRateMode_KeepsRecentlyUsedCacheEntries) {
+    auto selector = createSelector(kModes_30_60_72_90_120, kModeId60);
+
+    std::vector<LayerRequirement> layers = {{.weight = 1.f}};
+    layers[0].vote = LayerVoteType::ExplicitDefault;
+
+    std::vector<RefreshRateSelector::RankedFrameRates> results;
+    for (const Fps fps : {30_Hz, 60_Hz, 90_Hz, 120_Hz}) {
+        layers[0].desiredRefreshRate = fps;
+        results.push_back(selector.getRankedFrameRates(layers));
+    }
+
+    const auto& cache = selector.mutableGetRankedRefreshRatesCache();
+    ASSERT_EQ(4u, cache.size());
 
-    EXPECT_EQ(cache->layers, layers);
-    EXPECT_EQ(cache->signals, globalSignals);
-    EXPECT_EQ(cache->pacesetterFps, pacesetterFps);
-    EXPECT_EQ(cache->result, result);
+    // A hit moves the entry to the front without evicting any of the others.
+    layers[0].desiredRefreshRate = 30_Hz;
+    EXPECT_EQ(results[0], selector.getRankedFrameRates(layers));
+    ASSERT_EQ(4u, cache.size());
+    EXPECT_TRUE(isApproxEqual(30_Hz, cache.front().layers[0].desiredRefreshRate));
+
+    // A miss evicts the least recently used entry, which is now the 60 Hz one.
+    layers[0].desiredRefreshRate = 72_Hz;
+    selector.getRankedFrameRates(layers);
+    ASSERT_EQ(4u, cache.size());
+    EXPECT_TRUE(std::none_of(cache.begin(), cache.end(), [](const auto& entry) {
+        return isApproxEqual(entry.layers[0].desiredRefreshRate, 60_Hz);
+    }));
 }
 
 TEST_P(RefreshRateSelectorTest, getBestFrameRateMode_ExplicitExactTouchBoost) {
@@ -0,0 +1,67 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#undef LOG_TAG
+#define LOG_TAG "LibSurfaceFlingerUnittests"
+
+#include <gtest/gtest.h>
+
+#include "LayerRenderArea.h"
+#include "ScreenCaptureOutput.h"
+
+namespace android {
+namespace {
+
+LayerRenderArea makeRenderArea(const Rect& crop, ui::Size reqSize,
+                               const ui::Transform& transform = {}) {
+    return LayerRenderArea(nullptr, {}, crop, reqSize, ui::Dataspace::V0_SRGB, transform, crop,
+                           {});
+}
+
+TEST(ScreenCaptureOutputTest, captureScaleOfFullSizeCapture) {
+    EXPECT_EQ(1.f, ScreenCaptureOutput::getCaptureScale(makeRenderArea({0, 0, 1080, 2400},
+                                                                       {1080, 2400})));
+}
+
+TEST(ScreenCaptureOutputTest, captureScaleOfDownscaledCapture) {
+    EXPECT_EQ(0.5f, ScreenCaptureOutput::getCaptureScale(makeRenderArea({0, 0, 1080, 2400},
+                                                                        {540, 1200})));
+    // The smaller ratio wins.
+    EXPECT_EQ(0.25f, ScreenCaptureOutput::getCaptureScale(makeRenderArea({0, 0, 1080, 2400},
+                                                                         {540, 600})));
+}
+
+TEST(ScreenCaptureOutputTest, captureScaleOfRotatedCapture) {
+    // The output is the size of the rotated source crop, so it is not downscaled.
+    const ui::Transform rotate90(ui::Transform::ROT_90, 1080, 2400);
+    EXPECT_EQ(1.f, ScreenCaptureOutput::getCaptureScale(makeRenderArea({0, 0, 1080, 2400},
+                                                                       {2400, 1080}, rotate90)));
+
+    const ui::Transform rotate270(ui::Transform::ROT_270, 1080, 2400);
+    EXPECT_EQ(0.5f, ScreenCaptureOutput::getCaptureScale(makeRenderArea({0, 0, 1080, 2400},
+                                                                        {1200, 540}, rotate270)));
+
+    // Without a rotation, the same output size is a downscale.
+    EXPECT_EQ(0.45f, ScreenCaptureOutput::getCaptureScale(makeRenderArea({0, 0, 1080, 2400},
+                                                                         {2400, 1080})));
+}
+
+TEST(ScreenCaptureOutputTest, captureScaleOfEmptySourceCrop) {
+    EXPECT_EQ(1.f, ScreenCaptureOutput::getCaptureScale(makeRenderArea({}, {540, 1200})));
+}
+
+} // namespace
+} // namespace android
@@ -375,6 +375,22 @@ TEST_F(TimeStatsTest, canIncreaseJankyFramesForLayer) {
     EXPECT_THAT(result, HasSubstr(expectedResult));
 }
 
+TEST_F(TimeStatsTest, attributesJankToLayerPresentedBefore) {
+    // Layer stats are aggregated off the main thread, but jank reported after a present must
+    // still find the stats of the layer rather than fall back to the default layer name.
+    EXPECT_TRUE(inputCommand(InputCommand::ENABLE, FMT_STRING).empty());
+
+    insertTimeRecord(NORMAL_SEQUENCE, LAYER_ID_0, 1, 1000000);
+    insertTimeRecord(NORMAL_SEQUENCE_2, LAYER_ID_0, 2, 2000000);
+    mTimeStats->incrementJankyFrames({kRefreshRate0, kRenderRate0, UID_0, genLayerName(LAYER_ID_0),
+                                      kGameMode, JankType::AppDeadlineMissed, 1, 2, 3});
+
+    const std::string result(inputCommand(InputCommand::DUMP_ALL, FMT_STRING));
+    EXPECT_THAT(result, HasSubstr("layerName = " + genLayerName(LAYER_ID_0)));
+    EXPECT_THAT(result, Not(HasSubstr("layerName = none")));
+    EXPECT_THAT(result, HasSubstr("appUnattributedJankyFrames = 1"));
+}
+
 TEST_F(TimeStatsTest, canCaptureSetFrameRateVote) {
     // this stat is not in the proto so verify by checking the string dump
     EXPECT_TRUE(inputCommand(InputCommand::ENABLE, FMT_STRING).empty());
@@ -966,6 +966,72 @@ TEST(TransactionHandlerTest, QueueTransaction) {
     EXPECT_EQ(transactionsReadyToBeApplied.front().id, 42u);
 }
 
+TEST(TransactionHandlerTest, OnlyQueuesWaitingOnBarrierAreFlushedAgain) {
+    constexpr uint64_t kBarrierId = 1;
+    constexpr uint64_t kReadyId = 2;
+    constexpr uint64_t kNotReadyId = 3;
+    TransactionHandler handler;
+    int notReadyChecks = 0;
+    handler.addTransactionReadyFilter([&](const TransactionHandler::TransactionFlushState& state) {
+        switch (state.transaction->id) {
+            case kBarrierId:
+                // Waits for another transaction to be applied in the same flush.
+                return state.firstTransaction
+                        ? TransactionHandler::TransactionReadiness::NotReadyBarrier
+                        : TransactionHandler::TransactionReadiness::Ready;
+            case kNotReadyId:
+                notReadyChecks++;
+                return TransactionHandler::TransactionReadiness::NotReady;
+            default:
+                return TransactionHandler::TransactionReadiness::Ready;
+        }
+    });
+    for (uint64_t id : {kBarrierId, kReadyId, kNotReadyId}) {
+        TransactionState transaction;
+        transaction.applyToken = sp<BBinder>::make();
+        transaction.id = id;
+        handler.queueTransaction(std::move(transaction));
+    }
+    handler.collectTransactions();
+    std::vector<TransactionState> transactionsReadyToBeApplied = handler.flushTransactions();
+
+    EXPECT_EQ(transactionsReadyToBeApplied.size(), 2u);
+    EXPECT_EQ(notReadyChecks, 1);
+    EXPECT_TRUE(handler.hasPendingTransactions());
+}
+
+TEST(TransactionHandlerTest, CoalescesOverwrittenLayerStates) {
+    SET_FLAG_FOR_TEST(flags::coalesce_transaction_states, true);
+    TransactionHandler handler;
+    const sp<IBinder> applyToken = sp<BBinder>::make();
+    auto queueTransaction = [&](uint64_t id, uint32_t layerId, uint64_t what) {
+        TransactionState transaction;
+        transaction.applyToken = applyToken;
+        transaction.id = id;
+        transaction.states.emplace_back();
+        transaction.states.back().layerId = layerId;
+        transaction.states.back().state.what = what;
+        handler.queueTransaction(std::move(transaction));
+    };
+    queueTransaction(1, 1, layer_state_t::ePositionChanged | layer_state_t::eAlphaChanged);
+    queueTransaction(2, 2, layer_state_t::ePositionChanged);
+    queueTransaction(3, 1, layer_state_t::ePositionChanged | layer_state_t::eLayerChanged);
+    queueTransaction(4, 1, layer_state_t::eLayerChanged);
+    handler.collectTransactions();
+    std::vector<TransactionState> transactions = handler.flushTransactions();
+
+    // Every transaction is still applied, in order.
+    ASSERT_EQ(transactions.size(), 4u);
+    for (uint64_t i = 0; i < 4; i++) {
+        EXPECT_EQ(transactions[i].id, i + 1);
+    }
+    EXPECT_EQ(transactions[0].states[0].state.what, layer_state_t::eAlphaChanged);
+    EXPECT_EQ(transactions[1].states[0].state.what, layer_state_t::ePositionChanged);
+    EXPECT_EQ(transactions[2].states[0].state.what,
+              layer_state_t::ePositionChanged | layer_state_t::eLayerChanged);
+    EXPECT_EQ(transactions[3].states[0].state.what, layer_state_t::eLayerChanged);
+}
+
 TEST(TransactionHandlerTest, TransactionsKeepTrackOfDirectMerges) {
     SurfaceComposerClient::Transaction transaction1, transaction2, transaction3, transaction4;
 
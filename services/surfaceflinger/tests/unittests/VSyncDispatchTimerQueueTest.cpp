@@ -567,6 +567,57 @@ TEST_F(VSyncDispatchTimerQueueTest, modifyIntoGroup) {
     EXPECT_THAT(cb0.mCalls[1], Eq(2000));
 }
 
+TEST_F(VSyncDispatchTimerQueueTest, latenessBudgetCoalescesWakeups) {
+    // cb0 may be up to 150ns late, so its wakeup at 600 is delayed to coincide with cb1's at 750
+    // once cb1 is scheduled.
+    Sequence seq;
+    EXPECT_CALL(mMockClock, alarmAt(_, 600)).InSequence(seq);
+    EXPECT_CALL(mMockClock, alarmAt(_, 750)).InSequence(seq);
+
+    CountingCallback cb0(mDispatch);
+    CountingCallback cb1(mDispatch);
+
+    mDispatch->schedule(cb0,
+                        {.workDuration = 400,
+                         .readyDuration = 0,
+                         .lastVsync = 1000,
+                         .latenessBudget = 150});
+    mDispatch->schedule(cb1, {.workDuration = 250, .readyDuration = 0, .lastVsync = 1000});
+
+    advanceToNextCallback();
+    ASSERT_THAT(cb0.mCalls.size(), Eq(1));
+    EXPECT_THAT(cb0.mCalls[0], Eq(mPeriod));
+    ASSERT_THAT(cb1.mCalls.size(), Eq(1));
+    EXPECT_THAT(cb1.mCalls[0], Eq(mPeriod));
+    EXPECT_THAT(cb0.mWakeupTime[0], Eq(600));
+}
+
+TEST_F(VSyncDispatchTimerQueueTest, latenessBudgetDoesNotDelayLoneWakeup) {
+    // cb1 wakes up after cb0's budget runs out, so nothing coalesces and cb0 runs on time.
+    Sequence seq;
+    EXPECT_CALL(mMockClock, alarmAt(_, 600)).InSequence(seq);
+    EXPECT_CALL(mMockClock, alarmAt(_, 900)).InSequence(seq);
+
+    CountingCallback cb0(mDispatch);
+    CountingCallback cb1(mDispatch);
+
+    mDispatch->schedule(cb0,
+                        {.workDuration = 400,
+                         .readyDuration = 0,
+                         .lastVsync = 1000,
+                         .latenessBudget = 150});
+    mDispatch->schedule(cb1, {.workDuration = 100, .readyDuration = 0, .lastVsync = 1000});
+
+    advanceToNextCallback();
+    ASSERT_THAT(cb0.mCalls.size(), Eq(1));
+    EXPECT_THAT(cb0.mWakeupTime[0], Eq(600));
+    EXPECT_THAT(cb1.mCalls.size(), Eq(0));
+
+    advanceToNextCallback();
+    ASSERT_THAT(cb1.mCalls.size(), Eq(1));
+    EXPECT_THAT(cb1.mWakeupTime[0], Eq(900));
+}
+
 TEST_F(VSyncDispatchTimerQueueTest, rearmsWhenEndingAndDoesntCancel) {
     Sequence seq;
     EXPECT_CALL(mMockClock, alarmAt(_, 900)).InSequence(seq);
@@ -1,4 +1,7 @@
 #include <android/gui/BnWindowInfosListener.h>
+#include <android/gui/BnWindowInfosReportedListener.h>
+#include <com_android_graphics_surfaceflinger_flags.h>
+#include <common/test/FlagUtils.h>
 #include <gtest/gtest.h>
 #include <gui/SurfaceComposerClient.h>
 #include <gui/WindowInfosUpdate.h>
@@ -39,6 +42,19 @@ private:
     WindowInfosUpdateConsumer mConsumer;
 };
 
+class ReportedListener : public gui::BnWindowInfosReportedListener {
+public:
+    ReportedListener(std::function<void()> callback) : mCallback(std::move(callback)) {}
+
+    binder::Status onWindowInfosReported() override {
+        mCallback();
+        return binder::Status::ok();
+    }
+
+private:
+    std::function<void()> mCallback;
+};
+
 // Test that WindowInfosListenerInvoker#windowInfosChanged calls a single window infos listener.
 TEST_F(WindowInfosListenerInvokerTest, callsSingleListener) {
     std::mutex mutex;
@@ -283,4 +299,173 @@ TEST_F(WindowInfosListenerInvokerTest, removeListenerAcks) {
     EXPECT_EQ(callCount, 2);
 }
 
+// Test that a listener which hasn't acked doesn't delay the other listeners, and that the
+// WindowInfosReportedListeners of an update wait until the slow listener acks a later update.
+TEST_F(WindowInfosListenerInvokerTest, slowListenerDoesNotDelayOthers) {
+    SET_FLAG_FOR_TEST(com::android::graphics::surfaceflinger::flags::
+                              window_infos_per_listener_coalescing,
+                      true);
+
+    std::mutex mutex;
+    std::condition_variable cv;
+
+    // Simulate a slow ack by not calling IWindowInfosPublisher.ackWindowInfosReceived
+    std::vector<int64_t> slowUpdateIds;
+    gui::WindowInfosListenerInfo slowListenerInfo;
+    mInvoker->addWindowInfosListener(sp<Listener>::make([&](const gui::WindowInfosUpdate& update) {
+                                         std::scoped_lock lock{mutex};
+                                         slowUpdateIds.push_back(update.vsyncId);
+                                         cv.notify_one();
+                                     }),
+                                     &slowListenerInfo);
+
+    std::vector<int64_t> fastUpdateIds;
+    gui::WindowInfosListenerInfo fastListenerInfo;
+    mInvoker->addWindowInfosListener(sp<Listener>::make([&](const gui::WindowInfosUpdate& update) {
+                                         {
+                                             std::scoped_lock lock{mutex};
+                                             fastUpdateIds.push_back(update.vsyncId);
+                                             cv.notify_one();
+                                         }
+                                         fastListenerInfo.windowInfosPublisher
+                                                 ->ackWindowInfosReceived(update.vsyncId,
+                                                                          fastListenerInfo
+                                                                                  .listenerId);
+                                     }),
+                                     &fastListenerInfo);
+
+    bool reported = false;
+    sp<gui::IWindowInfosReportedListener> reportedListener = sp<ReportedListener>::make([&]() {
+        std::scoped_lock lock{mutex};
+        reported = true;
+        cv.notify_one();
+    });
+
+    BackgroundExecutor::getInstance().sendCallbacks(
+            {[&]() { mInvoker->windowInfosChanged({{}, {}, /* vsyncId= */ 0, 0}, {}, false); }});
+    BackgroundExecutor::getInstance().sendCallbacks({[&]() {
+        mInvoker->windowInfosChanged({{}, {}, /* vsyncId= */ 1, 0}, {reportedListener}, false);
+    }});
+    BackgroundExecutor::getInstance().flushQueue();
+
+    {
+        std::unique_lock lock{mutex};
+        cv.wait(lock, [&]() { return fastUpdateIds.size() == 2; });
+        EXPECT_EQ(fastUpdateIds, (std::vector<int64_t>{0, 1}));
+        EXPECT_EQ(slowUpdateIds, (std::vector<int64_t>{0}));
+        EXPECT_FALSE(reported);
+    }
+
+    // The slow listener is sent the update it missed once it acks, and the reported listener is
+    // called once it acks that one.
+    slowListenerInfo.windowInfosPublisher->ackWindowInfosReceived(0, slowListenerInfo.listenerId);
+    {
+        std::unique_lock lock{mutex};
+        cv.wait(lock, [&]() { return slowUpdateIds.size() == 2; });
+        EXPECT_EQ(slowUpdateIds, (std::vector<int64_t>{0, 1}));
+    }
+    BackgroundExecutor::getInstance().flushQueue();
+    {
+        std::scoped_lock lock{mutex};
+        EXPECT_FALSE(reported);
+    }
+
+    slowListenerInfo.windowInfosPublisher->ackWindowInfosReceived(1, slowListenerInfo.listenerId);
+    std::unique_lock lock{mutex};
+    cv.wait(lock, [&]() { return reported; });
+    EXPECT_TRUE(reported);
+}
+
+// Test that the WindowInfosReportedListeners of an update which a slow listener doesn't get are
+// called once it acks the later update it is sent instead.
+TEST_F(WindowInfosListenerInvokerTest, coalescedUpdateAcksDroppedUpdates) {
+    SET_FLAG_FOR_TEST(com::android::graphics::surfaceflinger::flags::
+                              window_infos_per_listener_coalescing,
+                      true);
+
+    std::mutex mutex;
+    std::condition_variable cv;
+
+    std::vector<int64_t> updateIds;
+    gui::WindowInfosListenerInfo listenerInfo;
+    mInvoker->addWindowInfosListener(sp<Listener>::make([&](const gui::WindowInfosUpdate& update) {
+                                         std::scoped_lock lock{mutex};
+                                         updateIds.push_back(update.vsyncId);
+                                         cv.notify_one();
+                                     }),
+                                     &listenerInfo);
+
+    int reportedCount = 0;
+    auto makeReportedListener = [&]() -> sp<gui::IWindowInfosReportedListener> {
+        return sp<ReportedListener>::make([&]() {
+            std::scoped_lock lock{mutex};
+            reportedCount++;
+            cv.notify_one();
+        });
+    };
+
+    BackgroundExecutor::getInstance().sendCallbacks({[&]() {
+        mInvoker->windowInfosChanged({{}, {}, /* vsyncId= */ 0, 0}, {}, false);
+        mInvoker->windowInfosChanged({{}, {}, /* vsyncId= */ 1, 0}, {makeReportedListener()},
+                                     false);
+        mInvoker->windowInfosChanged({{}, {}, /* vsyncId= */ 2, 0}, {makeReportedListener()},
+                                     false);
+    }});
+
+    listenerInfo.windowInfosPublisher->ackWindowInfosReceived(0, listenerInfo.listenerId);
+    {
+        std::unique_lock lock{mutex};
+        cv.wait(lock, [&]() { return updateIds.size() == 2; });
+        EXPECT_EQ(updateIds, (std::vector<int64_t>{0, 2}));
+        EXPECT_EQ(reportedCount, 0);
+    }
+
+    // Update 1 is never sent, and its reported listener is called by the ack of update 2.
+    listenerInfo.windowInfosPublisher->ackWindowInfosReceived(2, listenerInfo.listenerId);
+    std::unique_lock lock{mutex};
+    cv.wait(lock, [&]() { return reportedCount == 2; });
+    EXPECT_EQ(reportedCount, 2);
+}
+
+// Test that a listener which hasn't acked is only sent the latest update once it acks, and that
+// the dropped updates are reported in the debug info.
+TEST_F(WindowInfosListenerInvokerTest, coalescesUpdatesForSlowListener) {
+    SET_FLAG_FOR_TEST(com::android::graphics::surfaceflinger::flags::
+                              window_infos_per_listener_coalescing,
+                      true);
+
+    std::mutex mutex;
+    std::condition_variable cv;
+
+    std::vector<int64_t> updateIds;
+
+    // Simulate a slow ack by not calling IWindowInfosPublisher.ackWindowInfosReceived
+    gui::WindowInfosListenerInfo listenerInfo;
+    mInvoker->addWindowInfosListener(sp<Listener>::make([&](const gui::WindowInfosUpdate& update) {
+                                         std::scoped_lock lock{mutex};
+                                         updateIds.push_back(update.vsyncId);
+                                         cv.notify_one();
+                                     }),
+                                     &listenerInfo);
+
+    BackgroundExecutor::getInstance().sendCallbacks({[&]() {
+        mInvoker->windowInfosChanged({{}, {}, /* vsyncId= */ 0, 0}, {}, false);
+        mInvoker->windowInfosChanged({{}, {}, /* vsyncId= */ 1, 0}, {}, false);
+        mInvoker->windowInfosChanged({{}, {}, /* vsyncId= */ 2, 0}, {}, false);
+    }});
+
+    listenerInfo.windowInfosPublisher->ackWindowInfosReceived(0, listenerInfo.listenerId);
+
+    {
+        std::unique_lock lock{mutex};
+        cv.wait(lock, [&]() { return updateIds.size() == 2; });
+        EXPECT_EQ(updateIds, (std::vector<int64_t>{0, 2}));
+    }
+
+    const auto debugInfo = mInvoker->getDebugInfo();
+    ASSERT_EQ(debugInfo.listeners.size(), 1u);
+    EXPECT_EQ(debugInfo.listeners[0].listenerId, listenerInfo.listenerId);
+    EXPECT_EQ(debugInfo.listeners[0].coalescedUpdateCount, 1u);
+}
+
 } // namespace android
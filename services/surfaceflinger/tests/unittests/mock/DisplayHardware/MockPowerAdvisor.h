@@ -63,6 +63,8 @@ public:
     MOCK_METHOD(void, setCompositeEnd, (TimePoint compositeEndTime), (override));
     MOCK_METHOD(void, setDisplays, (std::vector<DisplayId> & displayIds), (override));
     MOCK_METHOD(void, setTotalFrameTargetWorkDuration, (Duration targetDuration), (override));
+    MOCK_METHOD(void, setCompositionWorkload, (size_t layerCount, size_t blurLayerCount),
+                (override));
 };
 
 } // namespace android::Hwc2::mock
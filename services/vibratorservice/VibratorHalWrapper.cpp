@@ -19,6 +19,7 @@
 #include <aidl/android/hardware/vibrator/IVibrator.h>
 #include <android/hardware/vibrator/1.3/IVibrator.h>
 #include <hardware/vibrator.h>
+#include <algorithm>
 #include <cmath>
 
 #include <utils/Log.h>
@@ -57,6 +58,18 @@ bool isStaticCastValid(Effect effect) {
     return castEffect >= *iter.begin() && castEffect <= *std::prev(iter.end());
 }
 
+// Converts a result that is not ok to a result of another type, keeping its status.
+template <typename T, typename U>
+HalResult<T> forwardFailure(const HalResult<U>& result) {
+    if (result.isUnsupported()) {
+        return HalResult<T>::unsupported();
+    }
+    if (result.shouldRetry()) {
+        return HalResult<T>::transactionFailed(result.errorMessage());
+    }
+    return HalResult<T>::failed(result.errorMessage());
+}
+
 // -------------------------------------------------------------------------------------------------
 
 Info HalWrapper::getInfo() {
@@ -121,6 +134,65 @@ HalResult<milliseconds> HalWrapper::performComposedEffect(const std::vector<Comp
     return HalResult<milliseconds>::unsupported();
 }
 
+HalResult<PreparedComposition> HalWrapper::prepareComposition(
+        const std::vector<CompositeEffect>& primitives) {
+    auto capabilities = getCapabilities();
+    if (!capabilities.isOk()) {
+        return forwardFailure<PreparedComposition>(capabilities);
+    }
+    if ((capabilities.value() & Capabilities::COMPOSE_EFFECTS) == Capabilities::NONE) {
+        ALOGV("Skipped prepareComposition because Vibrator HAL does not support compositions");
+        return HalResult<PreparedComposition>::unsupported();
+    }
+    auto durations = getPrimitiveDurations();
+    if (!durations.isOk()) {
+        return forwardFailure<PreparedComposition>(durations);
+    }
+
+    std::lock_guard<std::mutex> lock(mInfoMutex);
+    if (mInfoCache.mCompositionSizeMax.isFailed()) {
+        mInfoCache.mCompositionSizeMax = getCompositionSizeMaxInternal();
+    }
+    if (mInfoCache.mPrimitiveDelayMax.isFailed()) {
+        mInfoCache.mPrimitiveDelayMax = getPrimitiveDelayMaxInternal();
+    }
+    const auto& compositionSizeMax = mInfoCache.mCompositionSizeMax;
+    const auto& primitiveDelayMax = mInfoCache.mPrimitiveDelayMax;
+    const auto& supportedPrimitives = mInfoCache.mSupportedPrimitives.value();
+
+    if (compositionSizeMax.isOk() && compositionSizeMax.value() > 0 &&
+        primitives.size() > static_cast<size_t>(compositionSizeMax.value())) {
+        return HalResult<PreparedComposition>::failed("composition exceeds the maximum size");
+    }
+
+    milliseconds duration(0);
+    for (const auto& effect : primitives) {
+        if (std::find(supportedPrimitives.begin(), supportedPrimitives.end(), effect.primitive) ==
+            supportedPrimitives.end()) {
+            return HalResult<PreparedComposition>::failed("composition has unsupported primitive");
+        }
+        if (effect.scale < 0.0f || effect.scale > 1.0f || effect.delayMs < 0) {
+            return HalResult<PreparedComposition>::failed("composition has invalid primitive");
+        }
+        if (primitiveDelayMax.isOk() && milliseconds(effect.delayMs) > primitiveDelayMax.value()) {
+            return HalResult<PreparedComposition>::failed("composition exceeds the maximum delay");
+        }
+        auto primitiveIdx = static_cast<size_t>(effect.primitive);
+        if (primitiveIdx < durations.value().size()) {
+            duration += durations.value()[primitiveIdx];
+        }
+        duration += milliseconds(effect.delayMs);
+    }
+
+    return HalResult<PreparedComposition>::ok(PreparedComposition(primitives, duration));
+}
+
+HalResult<milliseconds> HalWrapper::performPreparedComposition(const PreparedComposition&,
+                                                               const std::function<void()>&) {
+    ALOGV("Skipped performPreparedComposition because it's not available in Vibrator HAL");
+    return HalResult<milliseconds>::unsupported();
+}
+
 HalResult<void> HalWrapper::performPwleEffect(const std::vector<PrimitivePwle>&,
                                               const std::function<void()>&) {
     ALOGV("Skipped performPwleEffect because it's not available in Vibrator HAL");
@@ -342,6 +414,15 @@ HalResult<milliseconds> AidlHalWrapper::performComposedEffect(
     return HalResultFactory::fromStatus<milliseconds>(getHal()->compose(primitives, cb), duration);
 }
 
+HalResult<milliseconds> AidlHalWrapper::performPreparedComposition(
+        const PreparedComposition& composition, const std::function<void()>& completionCallback) {
+    // This method should always support callbacks, so no need to double check.
+    auto cb = ndk::SharedRefBase::make<HalCallbackWrapper>(completionCallback);
+    return HalResultFactory::fromStatus<milliseconds>(getHal()->compose(composition.primitives(),
+                                                                        cb),
+                                                      composition.duration());
+}
+
 HalResult<void> AidlHalWrapper::performPwleEffect(const std::vector<PrimitivePwle>& primitives,
                                                   const std::function<void()>& completionCallback) {
     // This method should always support callbacks, so no need to double check.
@@ -591,4 +591,54 @@ BENCHMARK_WRAPPER(SlowVibratorPrimitivesBench, performComposedEffect, {
     }
 });
 
+BENCHMARK_WRAPPER(SlowVibratorPrimitivesBench, performPreparedComposition, {
+    if (shouldSkipWithMissingCapabilityMessage(vibrator::Capabilities::COMPOSE_EFFECTS, state)) {
+        return;
+    }
+    if (!hasArgs(state)) {
+        state.SkipWithMessage("missing args");
+        return;
+    }
+
+    CompositeEffect effect;
+    effect.primitive = getPrimitive(state);
+    effect.scale = 1.0f;
+    effect.delayMs = static_cast<int32_t>(0);
+
+    std::vector<CompositeEffect> effects = {effect};
+    auto prepareFn = [&](auto hal) { return hal->prepareComposition(effects); };
+    auto prepared = mController.doWithRetry<vibrator::PreparedComposition>(prepareFn,
+                                                                            "prepareComposition");
+    if (shouldSkipWithError(prepared, state)) {
+        return;
+    }
+    if (!prepared.isOk()) {
+        state.SkipWithMessage("prepareComposition unsupported");
+        return;
+    }
+
+    for (auto _ : state) {
+        // Setup
+        state.PauseTiming();
+        auto cb = mCallbacks.next();
+        auto performFn = [&](auto hal) {
+            return hal->performPreparedComposition(prepared.value(), cb.completeFn());
+        };
+        state.ResumeTiming();
+
+        // Test
+        if (shouldSkipWithError<milliseconds>(performFn, "performPreparedComposition", state)) {
+            return;
+        }
+
+        // Cleanup
+        state.PauseTiming();
+        if (shouldSkipWithError(turnVibratorOff(), state)) {
+            return;
+        }
+        cb.waitForComplete();
+        state.ResumeTiming();
+    }
+});
+
 BENCHMARK_MAIN();
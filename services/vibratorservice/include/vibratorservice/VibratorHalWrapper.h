@@ -363,6 +363,25 @@ private:
     friend class HalWrapper;
 };
 
+// Composition of primitives validated against the vibrator info, with its duration resolved ahead
+// of time. It can be performed repeatedly without querying or locking the cached vibrator info.
+class PreparedComposition {
+public:
+    using CompositeEffect = aidl::android::hardware::vibrator::CompositeEffect;
+
+    const std::vector<CompositeEffect>& primitives() const { return mPrimitives; }
+    std::chrono::milliseconds duration() const { return mDuration; }
+
+private:
+    PreparedComposition(std::vector<CompositeEffect> primitives, std::chrono::milliseconds duration)
+          : mPrimitives(std::move(primitives)), mDuration(duration) {}
+
+    std::vector<CompositeEffect> mPrimitives;
+    std::chrono::milliseconds mDuration;
+
+    friend class HalWrapper;
+};
+
 // Wrapper for Vibrator HAL handlers.
 class HalWrapper {
 public:
@@ -409,6 +428,20 @@ public:
             const std::vector<CompositeEffect>& primitives,
             const std::function<void()>& completionCallback);
 
+    /* Validates given primitives against the vibrator info and resolves the composition duration,
+     * loading the info from the HAL if needed. Returns a failed result if any primitive is not
+     * supported or the composition exceeds the HAL limits, so it is never sent to the HAL.
+     */
+    HalResult<PreparedComposition> prepareComposition(
+            const std::vector<CompositeEffect>& primitives);
+
+    /* Performs a prepared composition in a single HAL call, without any other HAL call or lookup
+     * of the vibrator info. Returns the duration resolved by prepareComposition.
+     */
+    virtual HalResult<std::chrono::milliseconds> performPreparedComposition(
+            const PreparedComposition& composition,
+            const std::function<void()>& completionCallback);
+
     virtual HalResult<void> performPwleEffect(const std::vector<PrimitivePwle>& primitives,
                                               const std::function<void()>& completionCallback);
 
@@ -494,6 +527,10 @@ public:
             const std::vector<CompositeEffect>& primitives,
             const std::function<void()>& completionCallback) override final;
 
+    HalResult<std::chrono::milliseconds> performPreparedComposition(
+            const PreparedComposition& composition,
+            const std::function<void()>& completionCallback) override final;
+
     HalResult<void> performPwleEffect(
             const std::vector<PrimitivePwle>& primitives,
             const std::function<void()>& completionCallback) override final;
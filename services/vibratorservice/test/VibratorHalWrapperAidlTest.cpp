@@ -694,6 +694,71 @@ TEST_F(VibratorHalWrapperAidlTest, TestPerformComposedCachesPrimitiveDurationsAn
     ASSERT_EQ(3, *callbackCounter.get());
 }
 
+TEST_F(VibratorHalWrapperAidlTest, TestPrepareAndPerformComposition) {
+    std::vector<CompositePrimitive> supportedPrimitives = {CompositePrimitive::CLICK,
+                                                           CompositePrimitive::SPIN};
+    std::vector<CompositeEffect> validEffects, unsupportedEffects, longDelayEffects, largeEffects;
+    validEffects.push_back(
+            vibrator::TestFactory::createCompositeEffect(CompositePrimitive::CLICK, 10ms, 0.5f));
+    validEffects.push_back(
+            vibrator::TestFactory::createCompositeEffect(CompositePrimitive::SPIN, 0ms, 1.0f));
+    unsupportedEffects.push_back(
+            vibrator::TestFactory::createCompositeEffect(CompositePrimitive::THUD, 0ms, 1.0f));
+    longDelayEffects.push_back(
+            vibrator::TestFactory::createCompositeEffect(CompositePrimitive::CLICK, 1000ms, 1.0f));
+    largeEffects.assign(3, validEffects[0]);
+
+    {
+        InSequence seq;
+        EXPECT_CALL(*mMockHal.get(), getCapabilities(_))
+                .Times(Exactly(1))
+                .WillOnce(DoAll(SetArgPointee<0>(IVibrator::CAP_COMPOSE_EFFECTS),
+                                Return(ndk::ScopedAStatus::ok())));
+        EXPECT_CALL(*mMockHal.get(), getSupportedPrimitives(_))
+                .Times(Exactly(1))
+                .WillOnce(DoAll(SetArgPointee<0>(supportedPrimitives),
+                                Return(ndk::ScopedAStatus::ok())));
+        EXPECT_CALL(*mMockHal.get(), getPrimitiveDuration(Eq(CompositePrimitive::CLICK), _))
+                .Times(Exactly(1))
+                .WillOnce(DoAll(SetArgPointee<1>(1), Return(ndk::ScopedAStatus::ok())));
+        EXPECT_CALL(*mMockHal.get(), getPrimitiveDuration(Eq(CompositePrimitive::SPIN), _))
+                .Times(Exactly(1))
+                .WillOnce(DoAll(SetArgPointee<1>(2), Return(ndk::ScopedAStatus::ok())));
+        EXPECT_CALL(*mMockHal.get(), getCompositionSizeMax(_))
+                .Times(Exactly(1))
+                .WillOnce(DoAll(SetArgPointee<0>(2), Return(ndk::ScopedAStatus::ok())));
+        EXPECT_CALL(*mMockHal.get(), getCompositionDelayMax(_))
+                .Times(Exactly(1))
+                .WillOnce(DoAll(SetArgPointee<0>(100), Return(ndk::ScopedAStatus::ok())));
+
+        // Performing a prepared composition only calls compose.
+        EXPECT_CALL(*mMockHal.get(), compose(Eq(validEffects), _))
+                .Times(Exactly(2))
+                .WillOnce(DoAll(WithArg<1>(vibrator::TriggerCallback()),
+                                Return(ndk::ScopedAStatus::ok())))
+                .WillOnce(DoAll(WithArg<1>(vibrator::TriggerCallback()),
+                                Return(ndk::ScopedAStatus::ok())));
+    }
+
+    auto prepared = mWrapper->prepareComposition(validEffects);
+    ASSERT_TRUE(prepared.isOk());
+    ASSERT_EQ(13ms, prepared.value().duration());
+
+    ASSERT_TRUE(mWrapper->prepareComposition(unsupportedEffects).isFailed());
+    ASSERT_TRUE(mWrapper->prepareComposition(longDelayEffects).isFailed());
+    ASSERT_TRUE(mWrapper->prepareComposition(largeEffects).isFailed());
+
+    std::unique_ptr<int32_t> callbackCounter = std::make_unique<int32_t>();
+    auto callback = vibrator::TestFactory::createCountingCallback(callbackCounter.get());
+
+    for (int i = 1; i <= 2; i++) {
+        auto result = mWrapper->performPreparedComposition(prepared.value(), callback);
+        ASSERT_TRUE(result.isOk());
+        ASSERT_EQ(13ms, result.value());
+        ASSERT_EQ(i, *callbackCounter.get());
+    }
+}
+
 TEST_F(VibratorHalWrapperAidlTest, TestPerformPwleEffect) {
     std::vector<PrimitivePwle> emptyPrimitives, multiplePrimitives;
     multiplePrimitives.push_back(vibrator::TestFactory::createActivePwle(0, 1, 0, 1, 10ms));
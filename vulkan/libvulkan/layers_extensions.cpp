@@ -25,6 +25,7 @@
 #include <sys/prctl.h>
 #include <unistd.h>
 
+#include <atomic>
 #include <mutex>
 #include <string>
 #include <vector>
@@ -341,6 +342,10 @@ void* LayerLibrary::GetGPA(const Layer& layer, const std::string_view gpa_name)
 std::vector<LayerLibrary> g_layer_libraries;
 std::vector<Layer> g_instance_layers;
 
+// Set by DiscoverLayers, cleared once the layer paths have been searched
+std::mutex g_discovery_mutex;
+std::atomic<bool> g_discovery_pending(false);
+
 void AddLayerLibrary(const std::string& path, const std::string& filename) {
     LayerLibrary library(path + "/" + filename, filename);
     if (!library.Open())
@@ -474,19 +479,37 @@ void* GetLayerGetProcAddr(const Layer& layer,
     return library.GetGPA(layer, gpa_name);
 }
 
-}  // anonymous namespace
+// Searches the layer paths if DiscoverLayers has been called since they were
+// last searched. Every way of looking up a layer goes through GetLayerCount or
+// FindLayer, so those call this first.
+void EnsureLayersDiscovered() {
+    if (!g_discovery_pending.load(std::memory_order_acquire))
+        return;
 
-void DiscoverLayers() {
-    ATRACE_CALL();
+    std::lock_guard<std::mutex> lock(g_discovery_mutex);
+    if (!g_discovery_pending.load(std::memory_order_relaxed))
+        return;
 
+    ATRACE_NAME("DiscoverLayers");
     if (android::GraphicsEnv::getInstance().isDebuggable()) {
         DiscoverLayersInPathList(kSystemLayerLibraryDir);
     }
     if (!android::GraphicsEnv::getInstance().getLayerPaths().empty())
         DiscoverLayersInPathList(android::GraphicsEnv::getInstance().getLayerPaths());
+
+    g_discovery_pending.store(false, std::memory_order_release);
+}
+
+}  // anonymous namespace
+
+void DiscoverLayers() {
+    // Opening every layer library to enumerate it is deferred until a layer is
+    // looked up, as most instances are created without enabling any layer.
+    g_discovery_pending.store(true, std::memory_order_release);
 }
 
 uint32_t GetLayerCount() {
+    EnsureLayersDiscovered();
     return static_cast<uint32_t>(g_instance_layers.size());
 }
 
@@ -495,6 +518,7 @@ const Layer& GetLayer(uint32_t index) {
 }
 
 const Layer* FindLayer(const char* name) {
+    EnsureLayersDiscovered();
     auto layer =
         std::find_if(g_instance_layers.cbegin(), g_instance_layers.cend(),
                      [=](const Layer& entry) {
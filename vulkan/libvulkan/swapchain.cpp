@@ -19,6 +19,7 @@
 
 #include <aidl/android/hardware/graphics/common/Dataspace.h>
 #include <aidl/android/hardware/graphics/common/PixelFormat.h>
+#include <android-base/properties.h>
 #include <android/hardware/graphics/common/1.0/types.h>
 #include <android/hardware_buffer.h>
 #include <grallocusage/GrallocUsageConversion.h>
@@ -244,6 +245,9 @@ class TimingInfo {
     int64_t timestamp_render_complete_time_ { NATIVE_WINDOW_TIMESTAMP_PENDING };
     int64_t timestamp_composition_latch_time_
             { NATIVE_WINDOW_TIMESTAMP_PENDING };
+
+    // When the frame was queued, to report its latency to the display.
+    int64_t queue_time_ { 0 };
 };
 
 struct Surface {
@@ -275,6 +279,19 @@ bool IsSharedPresentMode(VkPresentModeKHR mode) {
         mode == VK_PRESENT_MODE_SHARED_CONTINUOUS_REFRESH_KHR;
 }
 
+// Whether a swapchain should pace the presents that the app doesn't give a
+// desired present time to. Pacing relies on the same present timestamps as
+// GOOGLE_display_timing, and only applies to the FIFO present modes.
+bool IsPresentPacingEnabled(VkPresentModeKHR mode) {
+    if (mode != VK_PRESENT_MODE_FIFO_KHR &&
+        mode != VK_PRESENT_MODE_FIFO_RELAXED_KHR)
+        return false;
+    return android::base::GetBoolProperty("service.sf.present_timestamp",
+                                          false) &&
+           android::base::GetBoolProperty(
+               "debug.vulkan.swapchain.present_pacing", false);
+}
+
 struct Swapchain {
     Swapchain(Surface& surface_,
               uint32_t num_images_,
@@ -288,7 +305,9 @@ struct Swapchain {
           frame_timestamps_enabled(false),
           refresh_duration(refresh_duration_),
           acquire_next_image_timeout(-1),
-          shared(IsSharedPresentMode(present_mode)) {
+          shared(IsSharedPresentMode(present_mode)),
+          present_pacing(IsPresentPacingEnabled(present_mode)),
+          paced_present_time(0) {
     }
 
     VkResult get_refresh_duration(uint64_t& outRefreshDuration)
@@ -314,6 +333,9 @@ struct Swapchain {
     int64_t refresh_duration;
     nsecs_t acquire_next_image_timeout;
     bool shared;
+    bool present_pacing;
+    // The desired present time of the last paced present.
+    int64_t paced_present_time;
 
     struct Image {
         Image()
@@ -484,6 +506,11 @@ uint32_t get_num_ready_timings(Swapchain& swapchain) {
             // use those timestamps to calculate the info that should be
             // reported to the user:
             ti.calculate(swapchain.refresh_duration);
+            if (ti.vals_.actualPresentTime && ti.queue_time_) {
+                ATRACE_INT64("PresentToDisplayLatency",
+                             static_cast<int64_t>(ti.vals_.actualPresentTime) -
+                                 ti.queue_time_);
+            }
             num_ready++;
         }
     }
@@ -2426,6 +2453,7 @@ static void SetSwapchainFrameTimestamp(Swapchain &swapchain, const VkPresentTime
     // Add a new timing record with the user's presentID and
     // the nativeFrameId.
     swapchain.timing.emplace_back(pTime, nativeFrameId);
+    swapchain.timing.back().queue_time_ = systemTime();
     if (swapchain.timing.size() > MAX_TIMING_INFOS) {
         swapchain.timing.erase(
             swapchain.timing.begin(),
@@ -2441,6 +2469,39 @@ static void SetSwapchainFrameTimestamp(Swapchain &swapchain, const VkPresentTime
     }
 }
 
+// Present pacing aspect of QueuePresentKHR, for presents without a desired
+// present time. Each present targets its own vsync: the first one that hasn't
+// passed yet and that no earlier present targets. The vsync grid is anchored
+// on the most recent frame known to have been displayed.
+static void SetSwapchainPacedTimestamp(Swapchain &swapchain) {
+    const int64_t period = swapchain.refresh_duration;
+    const int64_t now = systemTime();
+
+    int64_t desired_present_time = now;
+    get_num_ready_timings(swapchain);
+    for (auto it = swapchain.timing.rbegin(); it != swapchain.timing.rend();
+         ++it) {
+        const int64_t displayed =
+            static_cast<int64_t>(it->vals_.actualPresentTime);
+        if (it->ready() && displayed > 0) {
+            if (period > 0 && displayed < now) {
+                desired_present_time =
+                    displayed + (now - displayed + period - 1) / period * period;
+            }
+            break;
+        }
+    }
+    if (period > 0 && swapchain.paced_present_time) {
+        desired_present_time = std::max(desired_present_time,
+                                        swapchain.paced_present_time + period);
+    }
+    swapchain.paced_present_time = desired_present_time;
+
+    const VkPresentTimeGOOGLE time = {
+        0, static_cast<uint64_t>(desired_present_time)};
+    SetSwapchainFrameTimestamp(swapchain, &time);
+}
+
 // EXT_swapchain_maintenance1 present mode change
 static bool SetSwapchainPresentMode(ANativeWindow *window, VkPresentModeKHR mode) {
     // There is no dynamic switching between non-shared present modes.
@@ -2518,6 +2579,8 @@ static VkResult PresentOneSwapchain(
             }
             if (pTime) {
                 SetSwapchainFrameTimestamp(swapchain, pTime);
+            } else if (swapchain.present_pacing) {
+                SetSwapchainPacedTimestamp(swapchain);
             }
             if (pPresentMode) {
                 if (!SetSwapchainPresentMode(window, *pPresentMode))